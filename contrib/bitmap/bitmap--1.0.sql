@@ -0,0 +1,50 @@
+/* contrib/bitmap/bitmap--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION bitmap" to load this file. \quit
+
+CREATE FUNCTION bmhandler(internal)
+RETURNS index_am_handler
+AS 'MODULE_PATHNAME'
+LANGUAGE C;
+
+-- Access method
+CREATE ACCESS METHOD bitmap TYPE INDEX HANDLER bmhandler;
+COMMENT ON ACCESS METHOD bitmap IS 'bitmap index access method';
+
+-- Opclasses
+
+CREATE OPERATOR CLASS bpchar_ops
+DEFAULT FOR TYPE bpchar USING bitmap AS
+	OPERATOR	1	=(bpchar, bpchar),
+	FUNCTION	1	hashbpchar(bpchar);
+
+CREATE OPERATOR CLASS date_ops
+DEFAULT FOR TYPE date USING bitmap AS
+	OPERATOR	1	=(date, date),
+	FUNCTION	1	hashdate(date);
+
+CREATE OPERATOR CLASS int2_ops
+DEFAULT FOR TYPE int2 USING bitmap AS
+	OPERATOR	1	=(int2, int2),
+	FUNCTION	1	hashint2(int2);
+
+CREATE OPERATOR CLASS int4_ops
+DEFAULT FOR TYPE int4 USING bitmap AS
+	OPERATOR	1	=(int4, int4),
+	FUNCTION	1	hashint4(int4);
+
+CREATE OPERATOR CLASS int8_ops
+DEFAULT FOR TYPE int8 USING bitmap AS
+	OPERATOR	1	=(int8, int8),
+	FUNCTION	1	hashint8(int8);
+
+CREATE OPERATOR CLASS numeric_ops
+DEFAULT FOR TYPE numeric USING bitmap AS
+	OPERATOR	1	=(numeric, numeric),
+	FUNCTION	1	hash_numeric(numeric);
+
+CREATE OPERATOR CLASS text_ops
+DEFAULT FOR TYPE text USING bitmap AS
+	OPERATOR	1	=(text, text),
+	FUNCTION	1	hashtext(text);
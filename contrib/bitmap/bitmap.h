@@ -0,0 +1,227 @@
+/*-------------------------------------------------------------------------
+ *
+ * bitmap.h
+ *	  Header for bitmap index.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  contrib/bitmap/bitmap.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef _BITMAP_H_
+#define _BITMAP_H_
+
+#include "access/amapi.h"
+#include "access/generic_xlog.h"
+#include "access/htup_details.h"
+#include "access/itup.h"
+#include "fmgr.h"
+#include "nodes/pathnodes.h"
+#include "nodes/tidbitmap.h"
+
+/* Support procedures numbers */
+#define BITMAP_HASH_PROC		1
+#define BITMAP_NPROC			1
+
+/* Scan strategies */
+#define BITMAP_EQUAL_STRATEGY	1
+#define BITMAP_NSTRATEGIES		1
+
+/*
+ * A bitmap index has a metapage, a chain of directory pages that hold one
+ * entry per distinct key, and for each key a chain of data pages that hold
+ * the set of heap TIDs having that key.
+ *
+ * A TID is numbered as (block * BITMAP_POSITIONS_PER_BLOCK + offset - 1).
+ * Like in a roaring bitmap, the numbers are grouped by their high bits into
+ * containers, here covering BITMAP_CONTAINER_BLOCKS heap blocks each.  A
+ * container holds the low bits of its numbers either as a sorted array of
+ * uint16, or, once that would take more space, as a plain bitmap.  The words
+ * of the bitmap covering one heap block are laid out like the words of a
+ * TIDBitmap page, so that scans can OR them into one directly.
+ */
+#define BITMAP_OFFSET_BITS \
+	(BLCKSZ <= 8192 ? 9 : (BLCKSZ <= 16384 ? 10 : 11))
+#define BITMAP_POSITIONS_PER_BLOCK	(1 << BITMAP_OFFSET_BITS)
+#define BITMAP_WORDS_PER_BLOCK		(BITMAP_POSITIONS_PER_BLOCK / 64)
+#define BITMAP_CONTAINER_BLOCKS		16
+#define BITMAP_BITMAP_WORDS \
+	(BITMAP_CONTAINER_BLOCKS * BITMAP_WORDS_PER_BLOCK)
+#define BITMAP_BITMAP_SIZE			(BITMAP_BITMAP_WORDS * sizeof(uint64))
+#define BITMAP_ARRAY_MAX			(BITMAP_BITMAP_SIZE / sizeof(uint16))
+
+StaticAssertDecl(MaxHeapTuplesPerPage <= BITMAP_POSITIONS_PER_BLOCK,
+				 "heap offsets must fit in a bitmap index block");
+StaticAssertDecl(BITMAP_CONTAINER_BLOCKS * BITMAP_POSITIONS_PER_BLOCK <= PG_UINT16_MAX + 1,
+				 "container positions must fit in uint16");
+
+/* Container kinds */
+#define BITMAP_CONTAINER_ARRAY	0
+#define BITMAP_CONTAINER_BITMAP	1
+
+/*
+ * Containers are packed one after another from the start of the contents of
+ * a data page up to pd_lower.  Their sizes are multiples of 8 bytes, so that
+ * the words of bitmap containers are suitably aligned.
+ */
+typedef struct BitmapContainerData
+{
+	uint32		chunk;			/* heap block / BITMAP_CONTAINER_BLOCKS */
+	uint16		count;			/* number of TIDs in the container */
+	uint8		kind;			/* BITMAP_CONTAINER_ARRAY or _BITMAP */
+	uint8		unused;
+	/* uint16 positions[] or uint64 words[] follow */
+} BitmapContainerData;
+
+typedef BitmapContainerData *BitmapContainer;
+
+#define BitmapContainerPayload(c) \
+	((char *) (c) + sizeof(BitmapContainerData))
+#define BitmapContainerPositions(c) ((uint16 *) BitmapContainerPayload(c))
+#define BitmapContainerWords(c)		((uint64 *) BitmapContainerPayload(c))
+#define BitmapArrayPayloadSize(count) \
+	TYPEALIGN(sizeof(uint64), (count) * sizeof(uint16))
+#define BitmapContainerSize(c) \
+	(sizeof(BitmapContainerData) + \
+	 ((c)->kind == BITMAP_CONTAINER_BITMAP ? BITMAP_BITMAP_SIZE : \
+	  BitmapArrayPayloadSize((c)->count)))
+
+/* Opaque for bitmap index pages */
+typedef struct BitmapPageOpaqueData
+{
+	BlockNumber next;			/* next page of this chain, or
+								 * InvalidBlockNumber */
+	uint16		flags;			/* see bit definitions below */
+	uint16		bitmap_page_id; /* for identification of BITMAP indexes */
+} BitmapPageOpaqueData;
+
+typedef BitmapPageOpaqueData *BitmapPageOpaque;
+
+/* Bitmap page flags */
+#define BITMAP_META			(1<<0)
+#define BITMAP_DIRECTORY	(1<<1)
+#define BITMAP_DATA			(1<<2)
+
+/*
+ * The page ID is for the convenience of pg_filedump and similar utilities,
+ * which otherwise would have a hard time telling pages of different index
+ * types apart.  It should be the last 2 bytes on the page.
+ */
+#define BITMAP_PAGE_ID		0xFF88
+
+#define BitmapPageGetOpaque(page) \
+	((BitmapPageOpaque) PageGetSpecialPointer(page))
+#define BitmapPageIsData(page) \
+	((BitmapPageGetOpaque(page)->flags & BITMAP_DATA) != 0)
+#define BitmapPageGetFreeSpace(page) \
+	(((PageHeader) (page))->pd_upper - ((PageHeader) (page))->pd_lower)
+
+/* Preserved page numbers */
+#define BITMAP_METAPAGE_BLKNO	(0)
+#define BITMAP_DIRHEAD_BLKNO	(1) /* first directory page */
+
+/* Metadata of bitmap index */
+typedef struct BitmapMetaPageData
+{
+	uint32		magickNumber;
+	uint32		nkeys;			/* number of directory entries */
+	BlockNumber dirTail;		/* last directory page */
+} BitmapMetaPageData;
+
+/* Magic number to distinguish bitmap pages from others */
+#define BITMAP_MAGICK_NUMBER (0xB17DA7A0)
+
+#define BitmapPageGetMeta(page) ((BitmapMetaPageData *) PageGetContents(page))
+
+/*
+ * Directory entries are page items made of this header followed by an index
+ * tuple holding the key, which is NULL for the entry of NULL keys.  Entries
+ * are never moved or removed, so their location can be remembered.
+ */
+typedef struct BitmapDirEntryData
+{
+	BlockNumber head;			/* first data page of the key */
+	BlockNumber tail;			/* a data page at or before the end of the
+								 * chain; chains only grow at the end */
+	uint32		hash;			/* hash of the key, 0 for NULL */
+	uint32		unused;
+} BitmapDirEntryData;
+
+typedef BitmapDirEntryData *BitmapDirEntry;
+
+#define BITMAP_DIRENTRY_HDRSZ	MAXALIGN(sizeof(BitmapDirEntryData))
+#define BitmapDirEntryGetTuple(entry) \
+	((IndexTuple) ((char *) (entry) + BITMAP_DIRENTRY_HDRSZ))
+#define BitmapMaxDirEntrySize \
+	MAXALIGN_DOWN(BLCKSZ - SizeOfPageHeaderData - sizeof(ItemIdData) - \
+				  MAXALIGN(sizeof(BitmapPageOpaqueData)))
+
+/* Location of a directory entry */
+typedef struct BitmapKeyLocation
+{
+	BlockNumber dirblkno;		/* directory page holding the entry */
+	OffsetNumber diroffnum;		/* its offset there */
+	BlockNumber head;			/* copy of the entry's head */
+	BlockNumber tail;			/* last known tail of the chain */
+} BitmapKeyLocation;
+
+typedef struct BitmapState
+{
+	FmgrInfo	hashFn;
+	FmgrInfo	equalFn;
+	Oid			collation;
+	TupleDesc	tupdesc;
+} BitmapState;
+
+/* Opaque data structure for bitmap index scan */
+typedef struct BitmapScanOpaqueData
+{
+	BitmapState state;
+	uint32	   *hashes;			/* hash of each equality scan key, if it can
+								 * be compared with the stored hash */
+	bool	   *hashvalid;
+} BitmapScanOpaqueData;
+
+typedef BitmapScanOpaqueData *BitmapScanOpaque;
+
+/* bmutils.c */
+extern void initBitmapState(BitmapState *state, Relation index);
+extern uint32 bitmapHashKey(BitmapState *state, Datum value, bool isnull);
+extern void BitmapInitMetapage(Relation index, ForkNumber forknum);
+extern void BitmapInitPage(Page page, uint16 flags);
+extern Buffer BitmapNewBuffer(Relation index);
+extern bool BitmapPageAddTid(Page page, ItemPointer tid);
+extern bool BitmapPageAddContainer(Page page, uint32 chunk,
+								   const uint16 *positions, int count);
+
+/* bmvalidate.c */
+extern bool bmvalidate(Oid opclassoid);
+
+/* index access method interface functions */
+extern bool bminsert(Relation index, Datum *values, bool *isnull,
+					 ItemPointer ht_ctid, Relation heapRel,
+					 IndexUniqueCheck checkUnique,
+					 bool indexUnchanged,
+					 struct IndexInfo *indexInfo);
+extern IndexScanDesc bmbeginscan(Relation r, int nkeys, int norderbys);
+extern int64 bmgetbitmap(IndexScanDesc scan, TIDBitmap *tbm);
+extern void bmrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
+					 ScanKey orderbys, int norderbys);
+extern void bmendscan(IndexScanDesc scan);
+extern IndexBuildResult *bmbuild(Relation heap, Relation index,
+								 struct IndexInfo *indexInfo);
+extern void bmbuildempty(Relation index);
+extern IndexBulkDeleteResult *bmbulkdelete(IndexVacuumInfo *info,
+										   IndexBulkDeleteResult *stats, IndexBulkDeleteCallback callback,
+										   void *callback_state);
+extern IndexBulkDeleteResult *bmvacuumcleanup(IndexVacuumInfo *info,
+											  IndexBulkDeleteResult *stats);
+extern bytea *bmoptions(Datum reloptions, bool validate);
+extern void bmcostestimate(PlannerInfo *root, IndexPath *path,
+						   double loop_count, Cost *indexStartupCost,
+						   Cost *indexTotalCost, Selectivity *indexSelectivity,
+						   double *indexCorrelation, double *indexPages);
+
+#endif
@@ -0,0 +1,40 @@
+/*-------------------------------------------------------------------------
+ *
+ * bmcost.c
+ *		Cost estimate function for bitmap indexes.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  contrib/bitmap/bmcost.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "bitmap.h"
+#include "utils/selfuncs.h"
+
+/*
+ * Estimate cost of bitmap index scan.
+ */
+void
+bmcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
+			   Cost *indexStartupCost, Cost *indexTotalCost,
+			   Selectivity *indexSelectivity, double *indexCorrelation,
+			   double *indexPages)
+{
+	GenericCosts costs = {0};
+
+	/*
+	 * Only the data pages of the matching keys are read, which is about the
+	 * fraction of the index that the generic estimate assumes.
+	 */
+	genericcostestimate(root, path, loop_count, &costs);
+
+	*indexStartupCost = costs.indexStartupCost;
+	*indexTotalCost = costs.indexTotalCost;
+	*indexSelectivity = costs.indexSelectivity;
+	*indexCorrelation = costs.indexCorrelation;
+	*indexPages = costs.numIndexPages;
+}
@@ -0,0 +1,748 @@
+/*-------------------------------------------------------------------------
+ *
+ * bminsert.c
+ *		Bitmap index build and insert functions.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  contrib/bitmap/bminsert.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/generic_xlog.h"
+#include "access/tableam.h"
+#include "bitmap.h"
+#include "common/int.h"
+#include "lib/qunique.h"
+#include "miscadmin.h"
+#include "nodes/execnodes.h"
+#include "storage/bufmgr.h"
+#include "utils/datum.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+
+PG_MODULE_MAGIC_EXT(
+					.name = "bitmap",
+					.version = PG_VERSION
+);
+
+/*
+ * Number of keys whose location an inserting statement remembers.  Bitmap
+ * indexes are meant for columns with few distinct values, so this is enough
+ * to find the directory entry of almost every row without reading the
+ * directory.
+ */
+#define BITMAP_INSERT_CACHE_SIZE	64
+
+typedef struct BitmapCachedKey
+{
+	Datum		key;
+	bool		isnull;
+	uint32		hash;
+	BitmapKeyLocation loc;
+} BitmapCachedKey;
+
+/* Per-statement insert state, kept in IndexInfo->ii_AmCache */
+typedef struct BitmapInsertCache
+{
+	BitmapState state;
+	int			nkeys;
+	int			next;			/* next slot to replace once full */
+	BitmapCachedKey keys[BITMAP_INSERT_CACHE_SIZE];
+} BitmapInsertCache;
+
+/*
+ * A distinct key seen during index build.  The TIDs of the heap chunk being
+ * scanned are accumulated in positions, and the finished containers in an
+ * in-memory data page that is written out when it is full.
+ */
+typedef struct BitmapBuildKey
+{
+	Datum		key;
+	bool		isnull;
+	BlockNumber head;			/* first data page written, if any */
+	BlockNumber tail;			/* last data page written, if any */
+	Page		page;			/* data page being filled, or NULL */
+	uint32		chunk;			/* heap chunk of positions */
+	int			npositions;
+	int			maxpositions;
+	bool		sorted;			/* positions are in ascending order */
+	uint16	   *positions;
+} BitmapBuildKey;
+
+typedef struct BitmapBuildHashEntry
+{
+	uint32		hash;			/* hash key, must be first */
+	List	   *keys;			/* BitmapBuildKeys with that hash */
+} BitmapBuildHashEntry;
+
+/* State of bitmap index build */
+typedef struct BitmapBuildState
+{
+	BitmapState state;
+	HTAB	   *keys;			/* BitmapBuildHashEntry by key hash */
+	List	   *allkeys;		/* all BitmapBuildKeys, in order of creation */
+	int			npages;			/* number of in-memory pages */
+	int			maxpages;		/* flush all of them beyond this */
+	int64		indtuples;		/* total number of tuples indexed */
+	MemoryContext keyCtx;		/* for keys and pages */
+} BitmapBuildState;
+
+/*
+ * Does the stored key of a directory entry equal the given key?
+ */
+static bool
+bmKeyEquals(BitmapState *state, IndexTuple itup, Datum key, bool isnull)
+{
+	Datum		stored;
+	bool		storednull;
+
+	stored = index_getattr(itup, 1, state->tupdesc, &storednull);
+	if (storednull || isnull)
+		return storednull && isnull;
+
+	return DatumGetBool(FunctionCall2Coll(&state->equalFn, state->collation,
+										  stored, key));
+}
+
+/*
+ * Look for the directory entry of a key.  Returns false if there is none.
+ */
+static bool
+bmSearchDir(Relation index, BitmapState *state, Datum key, bool isnull,
+			uint32 hash, BitmapKeyLocation *loc)
+{
+	BlockNumber blkno = BITMAP_DIRHEAD_BLKNO;
+
+	while (BlockNumberIsValid(blkno))
+	{
+		Buffer		buffer;
+		Page		page;
+		OffsetNumber maxoff;
+
+		buffer = ReadBuffer(index, blkno);
+		LockBuffer(buffer, BUFFER_LOCK_SHARE);
+		page = BufferGetPage(buffer);
+
+		maxoff = PageGetMaxOffsetNumber(page);
+		for (OffsetNumber off = FirstOffsetNumber; off <= maxoff; off++)
+		{
+			BitmapDirEntry entry;
+
+			entry = (BitmapDirEntry) PageGetItem(page, PageGetItemId(page, off));
+			if (entry->hash != hash ||
+				!bmKeyEquals(state, BitmapDirEntryGetTuple(entry), key, isnull))
+				continue;
+
+			loc->dirblkno = blkno;
+			loc->diroffnum = off;
+			loc->head = entry->head;
+			loc->tail = entry->tail;
+			UnlockReleaseBuffer(buffer);
+			return true;
+		}
+
+		blkno = BitmapPageGetOpaque(page)->next;
+		UnlockReleaseBuffer(buffer);
+	}
+
+	return false;
+}
+
+/*
+ * Add the directory entry of a new key to the last directory page, making a
+ * new one if it is full.  The caller must hold an exclusive lock on the
+ * metapage.
+ *
+ * If dataBuffer is valid, it is a new, locked buffer that becomes the only
+ * data page of the key, holding just tid.  Otherwise head and tail give the
+ * data pages the key already has.
+ */
+static void
+bmAddDirEntry(Relation index, BitmapState *state, Buffer metaBuffer,
+			  Datum key, bool isnull, uint32 hash,
+			  BlockNumber head, BlockNumber tail,
+			  Buffer dataBuffer, ItemPointer tid,
+			  BitmapKeyLocation *loc)
+{
+	IndexTuple	itup;
+	BitmapDirEntry entry;
+	Size		size;
+	GenericXLogState *xlogState;
+	Page		metaPage;
+	BitmapMetaPageData *metaData;
+	Buffer		dirBuffer,
+				newDirBuffer = InvalidBuffer;
+	Page		dirPage;
+	OffsetNumber offnum;
+
+	itup = index_form_tuple(state->tupdesc, &key, &isnull);
+	size = BITMAP_DIRENTRY_HDRSZ + IndexTupleSize(itup);
+	if (size > BitmapMaxDirEntrySize)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("index row size %zu exceeds maximum %zu for index \"%s\"",
+						size, (Size) BitmapMaxDirEntrySize,
+						RelationGetRelationName(index))));
+
+	entry = palloc0(size);
+	entry->hash = hash;
+	memcpy(BitmapDirEntryGetTuple(entry), itup, IndexTupleSize(itup));
+
+	xlogState = GenericXLogStart(index);
+	metaPage = GenericXLogRegisterBuffer(xlogState, metaBuffer, 0);
+	metaData = BitmapPageGetMeta(metaPage);
+
+	if (BufferIsValid(dataBuffer))
+	{
+		Page		dataPage;
+
+		dataPage = GenericXLogRegisterBuffer(xlogState, dataBuffer,
+											 GENERIC_XLOG_FULL_IMAGE);
+		BitmapInitPage(dataPage, BITMAP_DATA);
+		if (!BitmapPageAddTid(dataPage, tid))
+			elog(ERROR, "could not add TID to empty bitmap page");
+		head = tail = BufferGetBlockNumber(dataBuffer);
+	}
+	entry->head = head;
+	entry->tail = tail;
+
+	dirBuffer = ReadBuffer(index, metaData->dirTail);
+	LockBuffer(dirBuffer, BUFFER_LOCK_EXCLUSIVE);
+	dirPage = GenericXLogRegisterBuffer(xlogState, dirBuffer, 0);
+
+	if (PageGetFreeSpace(dirPage) < MAXALIGN(size))
+	{
+		Page		newDirPage;
+
+		newDirBuffer = BitmapNewBuffer(index);
+		newDirPage = GenericXLogRegisterBuffer(xlogState, newDirBuffer,
+											   GENERIC_XLOG_FULL_IMAGE);
+		BitmapInitPage(newDirPage, BITMAP_DIRECTORY);
+		BitmapPageGetOpaque(dirPage)->next = BufferGetBlockNumber(newDirBuffer);
+		metaData->dirTail = BufferGetBlockNumber(newDirBuffer);
+		dirPage = newDirPage;
+	}
+
+	offnum = PageAddItem(dirPage, (Item) entry, size, InvalidOffsetNumber,
+						 false, false);
+	if (offnum == InvalidOffsetNumber)
+		elog(ERROR, "failed to add directory entry to index \"%s\"",
+			 RelationGetRelationName(index));
+	metaData->nkeys++;
+	loc->dirblkno = metaData->dirTail;
+
+	GenericXLogFinish(xlogState);
+
+	loc->diroffnum = offnum;
+	loc->head = head;
+	loc->tail = tail;
+
+	if (BufferIsValid(newDirBuffer))
+		UnlockReleaseBuffer(newDirBuffer);
+	UnlockReleaseBuffer(dirBuffer);
+
+	pfree(entry);
+	pfree(itup);
+}
+
+/*
+ * Remember in the directory entry of a key that its chain reaches page tail
+ * now, so that later inserts needn't walk the whole chain.
+ */
+static void
+bmUpdateTailHint(Relation index, BitmapKeyLocation *loc, BlockNumber tail)
+{
+	Buffer		buffer;
+	Page		page;
+	BitmapDirEntry entry;
+	GenericXLogState *xlogState;
+
+	buffer = ReadBuffer(index, loc->dirblkno);
+	LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+
+	xlogState = GenericXLogStart(index);
+	page = GenericXLogRegisterBuffer(xlogState, buffer, 0);
+	entry = (BitmapDirEntry) PageGetItem(page,
+										 PageGetItemId(page, loc->diroffnum));
+
+	/* Pages are allocated in order, so a larger block is further along */
+	if (entry->tail < tail)
+	{
+		entry->tail = tail;
+		GenericXLogFinish(xlogState);
+	}
+	else
+		GenericXLogAbort(xlogState);
+
+	UnlockReleaseBuffer(buffer);
+	loc->tail = tail;
+}
+
+/*
+ * Add a TID to the chain of a key, starting at the tail hint, and extending
+ * the chain if its last page is full.
+ */
+static void
+bmAddTidToChain(Relation index, BitmapKeyLocation *loc, ItemPointer tid)
+{
+	BlockNumber blkno = loc->tail;
+
+	for (;;)
+	{
+		Buffer		buffer;
+		Page		page;
+		BlockNumber next;
+		GenericXLogState *xlogState;
+		Buffer		newBuffer;
+		Page		newPage;
+
+		buffer = ReadBuffer(index, blkno);
+		LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+		page = BufferGetPage(buffer);
+
+		/* Move right until the end of the chain */
+		next = BitmapPageGetOpaque(page)->next;
+		if (BlockNumberIsValid(next))
+		{
+			UnlockReleaseBuffer(buffer);
+			blkno = next;
+			continue;
+		}
+
+		xlogState = GenericXLogStart(index);
+		page = GenericXLogRegisterBuffer(xlogState, buffer, 0);
+		if (BitmapPageAddTid(page, tid))
+		{
+			GenericXLogFinish(xlogState);
+			UnlockReleaseBuffer(buffer);
+			break;
+		}
+
+		/* The last page is full, link a new one */
+		newBuffer = BitmapNewBuffer(index);
+		newPage = GenericXLogRegisterBuffer(xlogState, newBuffer,
+											GENERIC_XLOG_FULL_IMAGE);
+		BitmapInitPage(newPage, BITMAP_DATA);
+		if (!BitmapPageAddTid(newPage, tid))
+			elog(ERROR, "could not add TID to empty bitmap page");
+		blkno = BufferGetBlockNumber(newBuffer);
+		BitmapPageGetOpaque(page)->next = blkno;
+		GenericXLogFinish(xlogState);
+
+		UnlockReleaseBuffer(newBuffer);
+		UnlockReleaseBuffer(buffer);
+		break;
+	}
+
+	if (blkno != loc->tail)
+		bmUpdateTailHint(index, loc, blkno);
+}
+
+/*
+ * Insert new tuple to the bitmap index.
+ *
+ * The location of the directory entry of each key is remembered for the
+ * rest of the statement, so a bulk insert reads the directory once per key
+ * and then goes straight to the end of the key's chain.
+ */
+bool
+bminsert(Relation index, Datum *values, bool *isnull,
+		 ItemPointer ht_ctid, Relation heapRel,
+		 IndexUniqueCheck checkUnique,
+		 bool indexUnchanged,
+		 IndexInfo *indexInfo)
+{
+	BitmapInsertCache *cache = (BitmapInsertCache *) indexInfo->ii_AmCache;
+	BitmapCachedKey *cached = NULL;
+	Datum		key = values[0];
+	uint32		hash;
+	BitmapKeyLocation loc;
+
+	if (cache == NULL)
+	{
+		MemoryContext oldCtx = MemoryContextSwitchTo(indexInfo->ii_Context);
+
+		cache = palloc0(sizeof(BitmapInsertCache));
+		initBitmapState(&cache->state, index);
+		indexInfo->ii_AmCache = cache;
+		MemoryContextSwitchTo(oldCtx);
+	}
+
+	hash = bitmapHashKey(&cache->state, key, isnull[0]);
+
+	for (int i = 0; i < cache->nkeys; i++)
+	{
+		BitmapCachedKey *k = &cache->keys[i];
+
+		if (k->hash != hash || k->isnull != isnull[0])
+			continue;
+		if (k->isnull ||
+			DatumGetBool(FunctionCall2Coll(&cache->state.equalFn,
+										   cache->state.collation,
+										   k->key, key)))
+		{
+			cached = k;
+			break;
+		}
+	}
+
+	if (cached != NULL)
+	{
+		bmAddTidToChain(index, &cached->loc, ht_ctid);
+		return false;
+	}
+
+	if (bmSearchDir(index, &cache->state, key, isnull[0], hash, &loc))
+		bmAddTidToChain(index, &loc, ht_ctid);
+	else
+	{
+		Buffer		metaBuffer;
+
+		/*
+		 * The key is new, unless someone else has just added it.  Adding
+		 * keys is serialized by the metapage lock, so search again while
+		 * holding that.
+		 */
+		metaBuffer = ReadBuffer(index, BITMAP_METAPAGE_BLKNO);
+		LockBuffer(metaBuffer, BUFFER_LOCK_EXCLUSIVE);
+
+		if (bmSearchDir(index, &cache->state, key, isnull[0], hash, &loc))
+		{
+			UnlockReleaseBuffer(metaBuffer);
+			bmAddTidToChain(index, &loc, ht_ctid);
+		}
+		else
+		{
+			Buffer		dataBuffer = BitmapNewBuffer(index);
+
+			bmAddDirEntry(index, &cache->state, metaBuffer, key, isnull[0],
+						  hash, InvalidBlockNumber, InvalidBlockNumber,
+						  dataBuffer, ht_ctid, &loc);
+			UnlockReleaseBuffer(dataBuffer);
+			UnlockReleaseBuffer(metaBuffer);
+		}
+	}
+
+	/* Remember the key for the next rows of the statement */
+	if (cache->nkeys < BITMAP_INSERT_CACHE_SIZE)
+		cached = &cache->keys[cache->nkeys++];
+	else
+	{
+		cached = &cache->keys[cache->next];
+		cache->next = (cache->next + 1) % BITMAP_INSERT_CACHE_SIZE;
+		if (!cached->isnull && !TupleDescAttr(cache->state.tupdesc, 0)->attbyval)
+			pfree(DatumGetPointer(cached->key));
+	}
+
+	cached->isnull = isnull[0];
+	cached->hash = hash;
+	cached->loc = loc;
+	if (isnull[0])
+		cached->key = (Datum) 0;
+	else
+	{
+		Form_pg_attribute att = TupleDescAttr(cache->state.tupdesc, 0);
+		MemoryContext oldCtx = MemoryContextSwitchTo(indexInfo->ii_Context);
+
+		cached->key = datumCopy(key, att->attbyval, att->attlen);
+		MemoryContextSwitchTo(oldCtx);
+	}
+
+	return false;
+}
+
+/*
+ * Write out the in-memory data page of a key, linking it to the end of the
+ * key's chain.
+ */
+static void
+bmBuildFlushPage(Relation index, BitmapBuildState *buildstate,
+				 BitmapBuildKey *bkey)
+{
+	Buffer		buffer = BitmapNewBuffer(index);
+	Buffer		prevBuffer = InvalidBuffer;
+	BlockNumber blkno = BufferGetBlockNumber(buffer);
+	GenericXLogState *xlogState;
+	Page		page;
+
+	xlogState = GenericXLogStart(index);
+	page = GenericXLogRegisterBuffer(xlogState, buffer, GENERIC_XLOG_FULL_IMAGE);
+	memcpy(page, bkey->page, BLCKSZ);
+
+	if (BlockNumberIsValid(bkey->tail))
+	{
+		Page		prevPage;
+
+		prevBuffer = ReadBuffer(index, bkey->tail);
+		LockBuffer(prevBuffer, BUFFER_LOCK_EXCLUSIVE);
+		prevPage = GenericXLogRegisterBuffer(xlogState, prevBuffer, 0);
+		BitmapPageGetOpaque(prevPage)->next = blkno;
+	}
+	else
+		bkey->head = blkno;
+	bkey->tail = blkno;
+
+	GenericXLogFinish(xlogState);
+
+	if (BufferIsValid(prevBuffer))
+		UnlockReleaseBuffer(prevBuffer);
+	UnlockReleaseBuffer(buffer);
+
+	pfree(bkey->page);
+	bkey->page = NULL;
+	buildstate->npages--;
+}
+
+/* qsort comparator for container positions */
+static int
+bmPositionCmp(const void *a, const void *b)
+{
+	return pg_cmp_u16(*(const uint16 *) a, *(const uint16 *) b);
+}
+
+/*
+ * Move the positions accumulated for the current heap chunk of a key into a
+ * container on its in-memory data page.
+ */
+static void
+bmBuildEmitChunk(Relation index, BitmapBuildState *buildstate,
+				 BitmapBuildKey *bkey)
+{
+	if (bkey->npositions == 0)
+		return;
+
+	/* HOT chains are indexed by their root, which may come out of order */
+	if (!bkey->sorted)
+	{
+		qsort(bkey->positions, bkey->npositions, sizeof(uint16),
+			  bmPositionCmp);
+		bkey->npositions = qunique(bkey->positions, bkey->npositions,
+								   sizeof(uint16), bmPositionCmp);
+	}
+
+	if (bkey->page != NULL &&
+		!BitmapPageAddContainer(bkey->page, bkey->chunk, bkey->positions,
+								bkey->npositions))
+		bmBuildFlushPage(index, buildstate, bkey);
+
+	if (bkey->page == NULL)
+	{
+		bkey->page = MemoryContextAlloc(buildstate->keyCtx, BLCKSZ);
+		BitmapInitPage(bkey->page, BITMAP_DATA);
+		buildstate->npages++;
+		if (!BitmapPageAddContainer(bkey->page, bkey->chunk, bkey->positions,
+									bkey->npositions))
+			elog(ERROR, "could not add container to empty bitmap page");
+	}
+
+	bkey->npositions = 0;
+	bkey->sorted = true;
+}
+
+/*
+ * Write out all the in-memory data pages.
+ */
+static void
+bmBuildFlushAll(Relation index, BitmapBuildState *buildstate)
+{
+	ListCell   *lc;
+
+	foreach(lc, buildstate->allkeys)
+	{
+		BitmapBuildKey *bkey = (BitmapBuildKey *) lfirst(lc);
+
+		if (bkey->page != NULL)
+			bmBuildFlushPage(index, buildstate, bkey);
+	}
+}
+
+/*
+ * Find or make the build state of a key.
+ */
+static BitmapBuildKey *
+bmBuildGetKey(BitmapBuildState *buildstate, Datum key, bool isnull)
+{
+	uint32		hash = bitmapHashKey(&buildstate->state, key, isnull);
+	BitmapBuildHashEntry *hentry;
+	BitmapBuildKey *bkey;
+	ListCell   *lc;
+	bool		found;
+	MemoryContext oldCtx;
+
+	hentry = hash_search(buildstate->keys, &hash, HASH_ENTER, &found);
+	if (!found)
+		hentry->keys = NIL;
+
+	foreach(lc, hentry->keys)
+	{
+		bkey = (BitmapBuildKey *) lfirst(lc);
+
+		if (bkey->isnull || isnull)
+		{
+			if (bkey->isnull && isnull)
+				return bkey;
+		}
+		else if (DatumGetBool(FunctionCall2Coll(&buildstate->state.equalFn,
+												buildstate->state.collation,
+												bkey->key, key)))
+			return bkey;
+	}
+
+	oldCtx = MemoryContextSwitchTo(buildstate->keyCtx);
+
+	bkey = palloc0(sizeof(BitmapBuildKey));
+	bkey->isnull = isnull;
+	if (!isnull)
+	{
+		Form_pg_attribute att = TupleDescAttr(buildstate->state.tupdesc, 0);
+
+		bkey->key = datumCopy(key, att->attbyval, att->attlen);
+	}
+	bkey->head = InvalidBlockNumber;
+	bkey->tail = InvalidBlockNumber;
+	bkey->sorted = true;
+	bkey->maxpositions = 16;
+	bkey->positions = palloc(bkey->maxpositions * sizeof(uint16));
+
+	hentry->keys = lappend(hentry->keys, bkey);
+	buildstate->allkeys = lappend(buildstate->allkeys, bkey);
+
+	MemoryContextSwitchTo(oldCtx);
+
+	return bkey;
+}
+
+/*
+ * Per-tuple callback for table_index_build_scan.
+ */
+static void
+bmBuildCallback(Relation index, ItemPointer tid, Datum *values,
+				bool *isnull, bool tupleIsAlive, void *state)
+{
+	BitmapBuildState *buildstate = (BitmapBuildState *) state;
+	BitmapBuildKey *bkey;
+	BlockNumber blkno = ItemPointerGetBlockNumber(tid);
+	uint32		chunk = blkno / BITMAP_CONTAINER_BLOCKS;
+	uint16		pos;
+
+	bkey = bmBuildGetKey(buildstate, values[0], isnull[0]);
+
+	/* The heap is scanned in order, so a chunk is done once we pass it */
+	if (bkey->npositions > 0 && bkey->chunk != chunk)
+		bmBuildEmitChunk(index, buildstate, bkey);
+	bkey->chunk = chunk;
+
+	if (bkey->npositions == bkey->maxpositions)
+	{
+		bkey->maxpositions *= 2;
+		bkey->positions = repalloc(bkey->positions,
+								   bkey->maxpositions * sizeof(uint16));
+	}
+
+	pos = ((blkno % BITMAP_CONTAINER_BLOCKS) << BITMAP_OFFSET_BITS) |
+		(ItemPointerGetOffsetNumber(tid) - 1);
+	if (bkey->npositions > 0 && bkey->positions[bkey->npositions - 1] >= pos)
+		bkey->sorted = false;
+	bkey->positions[bkey->npositions++] = pos;
+
+	buildstate->indtuples += 1;
+
+	if (buildstate->npages > buildstate->maxpages)
+	{
+		bmBuildFlushAll(index, buildstate);
+		CHECK_FOR_INTERRUPTS();
+	}
+}
+
+/*
+ * Build a new bitmap index.
+ *
+ * The TIDs of each key are collected in memory, one page per key, and
+ * written out as whole pages.  When the pages of all keys take more than
+ * maintenance_work_mem, they are all written out and the chains continue
+ * on new pages.
+ */
+IndexBuildResult *
+bmbuild(Relation heap, Relation index, IndexInfo *indexInfo)
+{
+	IndexBuildResult *result;
+	double		reltuples;
+	BitmapBuildState buildstate;
+	HASHCTL		hashCtl;
+	Buffer		metaBuffer;
+	ListCell   *lc;
+
+	if (RelationGetNumberOfBlocks(index) != 0)
+		elog(ERROR, "index \"%s\" already contains data",
+			 RelationGetRelationName(index));
+
+	/* Initialize the meta page */
+	BitmapInitMetapage(index, MAIN_FORKNUM);
+
+	/* Initialize the bitmap build state */
+	memset(&buildstate, 0, sizeof(buildstate));
+	initBitmapState(&buildstate.state, index);
+	buildstate.keyCtx = AllocSetContextCreate(CurrentMemoryContext,
+											  "Bitmap build key context",
+											  ALLOCSET_DEFAULT_SIZES);
+	buildstate.maxpages = Max((int) ((Size) maintenance_work_mem * 1024 / BLCKSZ),
+							  1);
+
+	hashCtl.keysize = sizeof(uint32);
+	hashCtl.entrysize = sizeof(BitmapBuildHashEntry);
+	hashCtl.hcxt = buildstate.keyCtx;
+	buildstate.keys = hash_create("Bitmap build keys", 64, &hashCtl,
+								  HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+	/*
+	 * Do the heap scan.  Synchronized scans are not allowed, so that the
+	 * TIDs come in ascending order.
+	 */
+	reltuples = table_index_build_scan(heap, index, indexInfo, false, true,
+									   bmBuildCallback, &buildstate,
+									   NULL);
+
+	/* Write out everything left, then the directory */
+	foreach(lc, buildstate.allkeys)
+		bmBuildEmitChunk(index, &buildstate,
+						 (BitmapBuildKey *) lfirst(lc));
+	bmBuildFlushAll(index, &buildstate);
+
+	metaBuffer = ReadBuffer(index, BITMAP_METAPAGE_BLKNO);
+	LockBuffer(metaBuffer, BUFFER_LOCK_EXCLUSIVE);
+	foreach(lc, buildstate.allkeys)
+	{
+		BitmapBuildKey *bkey = (BitmapBuildKey *) lfirst(lc);
+		BitmapKeyLocation loc;
+
+		bmAddDirEntry(index, &buildstate.state, metaBuffer,
+					  bkey->key, bkey->isnull,
+					  bitmapHashKey(&buildstate.state, bkey->key, bkey->isnull),
+					  bkey->head, bkey->tail, InvalidBuffer, NULL, &loc);
+	}
+	UnlockReleaseBuffer(metaBuffer);
+
+	MemoryContextDelete(buildstate.keyCtx);
+
+	result = (IndexBuildResult *) palloc(sizeof(IndexBuildResult));
+	result->heap_tuples = reltuples;
+	result->index_tuples = buildstate.indtuples;
+
+	return result;
+}
+
+/*
+ * Build an empty bitmap index in the initialization fork.
+ */
+void
+bmbuildempty(Relation index)
+{
+	/* Initialize the meta page and the directory */
+	BitmapInitMetapage(index, INIT_FORKNUM);
+}
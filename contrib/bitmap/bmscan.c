@@ -0,0 +1,290 @@
+/*-------------------------------------------------------------------------
+ *
+ * bmscan.c
+ *		Bitmap index scan functions.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  contrib/bitmap/bmscan.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/relscan.h"
+#include "bitmap.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "storage/bufmgr.h"
+#include "utils/rel.h"
+
+/*
+ * Begin scan of bitmap index.
+ */
+IndexScanDesc
+bmbeginscan(Relation r, int nkeys, int norderbys)
+{
+	IndexScanDesc scan;
+	BitmapScanOpaque so;
+
+	scan = RelationGetIndexScan(r, nkeys, norderbys);
+
+	so = (BitmapScanOpaque) palloc(sizeof(BitmapScanOpaqueData));
+	initBitmapState(&so->state, scan->indexRelation);
+	so->hashes = NULL;
+	so->hashvalid = NULL;
+
+	scan->opaque = so;
+
+	return scan;
+}
+
+/*
+ * Rescan a bitmap index.
+ */
+void
+bmrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
+		 ScanKey orderbys, int norderbys)
+{
+	BitmapScanOpaque so = (BitmapScanOpaque) scan->opaque;
+
+	if (so->hashes)
+		pfree(so->hashes);
+	so->hashes = NULL;
+	if (so->hashvalid)
+		pfree(so->hashvalid);
+	so->hashvalid = NULL;
+
+	if (scankey && scan->numberOfKeys > 0)
+		memcpy(scan->keyData, scankey, scan->numberOfKeys * sizeof(ScanKeyData));
+}
+
+/*
+ * End scan of bitmap index.
+ */
+void
+bmendscan(IndexScanDesc scan)
+{
+	BitmapScanOpaque so = (BitmapScanOpaque) scan->opaque;
+
+	if (so->hashes)
+		pfree(so->hashes);
+	if (so->hashvalid)
+		pfree(so->hashvalid);
+	pfree(so);
+}
+
+/*
+ * Does a directory entry satisfy all the scan keys?
+ */
+static bool
+bmEntryMatches(IndexScanDesc scan, BitmapDirEntry entry)
+{
+	BitmapScanOpaque so = (BitmapScanOpaque) scan->opaque;
+	IndexTuple	itup = BitmapDirEntryGetTuple(entry);
+	Datum		key;
+	bool		isnull;
+
+	key = index_getattr(itup, 1, so->state.tupdesc, &isnull);
+
+	for (int i = 0; i < scan->numberOfKeys; i++)
+	{
+		ScanKey		skey = &scan->keyData[i];
+
+		if (skey->sk_flags & SK_SEARCHNULL)
+		{
+			if (!isnull)
+				return false;
+			continue;
+		}
+		if (skey->sk_flags & SK_SEARCHNOTNULL)
+		{
+			if (isnull)
+				return false;
+			continue;
+		}
+
+		/* The operators are strict, NULL matches nothing */
+		if (isnull || (skey->sk_flags & SK_ISNULL))
+			return false;
+
+		/* Different hashes are different keys, skip the comparison */
+		if (so->hashvalid[i] && so->hashes[i] != entry->hash)
+			return false;
+
+		if (!DatumGetBool(FunctionCall2Coll(&skey->sk_func,
+											skey->sk_collation,
+											key, skey->sk_argument)))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Add the TIDs of one data page to the bitmap.  Array containers are added
+ * as TIDs, bitmap containers a heap page at a time.
+ */
+static int64
+bmAddDataPage(TIDBitmap *tbm, Page page)
+{
+	char	   *ptr = PageGetContents(page);
+	char	   *end = page + ((PageHeader) page)->pd_lower;
+	int64		ntids = 0;
+
+	while (ptr < end)
+	{
+		BitmapContainer c = (BitmapContainer) ptr;
+		BlockNumber firstblk = c->chunk * BITMAP_CONTAINER_BLOCKS;
+
+		if (c->kind == BITMAP_CONTAINER_BITMAP)
+		{
+			uint64	   *words = BitmapContainerWords(c);
+
+			for (int b = 0; b < BITMAP_CONTAINER_BLOCKS; b++)
+			{
+				uint64	   *blkwords = words + b * BITMAP_WORDS_PER_BLOCK;
+#if BITS_PER_BITMAPWORD == 64
+				const bitmapword *tbmwords = (const bitmapword *) blkwords;
+#else
+				bitmapword	tbmwords[BITMAP_WORDS_PER_BLOCK * 2];
+
+				for (int w = 0; w < BITMAP_WORDS_PER_BLOCK; w++)
+				{
+					tbmwords[2 * w] = (bitmapword) blkwords[w];
+					tbmwords[2 * w + 1] = (bitmapword) (blkwords[w] >> 32);
+				}
+#endif
+
+				tbm_add_page_words(tbm, firstblk + b, tbmwords,
+								   BITMAP_WORDS_PER_BLOCK * 64 / BITS_PER_BITMAPWORD,
+								   false);
+			}
+		}
+		else
+		{
+			uint16	   *positions = BitmapContainerPositions(c);
+			ItemPointerData tids[BITMAP_ARRAY_MAX];
+
+			for (int i = 0; i < c->count; i++)
+				ItemPointerSet(&tids[i],
+							   firstblk + (positions[i] >> BITMAP_OFFSET_BITS),
+							   (positions[i] & (BITMAP_POSITIONS_PER_BLOCK - 1)) + 1);
+			tbm_add_tuples(tbm, tids, c->count, false);
+		}
+
+		ntids += c->count;
+		ptr += BitmapContainerSize(c);
+	}
+
+	return ntids;
+}
+
+/*
+ * Insert all matching tuples into a bitmap.
+ *
+ * The directory is read to find the keys that match, and then the data
+ * pages of each of them.
+ */
+int64
+bmgetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
+{
+	BitmapScanOpaque so = (BitmapScanOpaque) scan->opaque;
+	Relation	index = scan->indexRelation;
+	Oid			opcintype = index->rd_opcintype[0];
+	int64		ntids = 0;
+	BlockNumber blkno;
+	BlockNumber *heads = NULL;
+	int			nheads = 0,
+				maxheads = 0;
+
+	if (so->hashes == NULL)
+	{
+		/*
+		 * New search: hash the arguments of the equality keys, when they are
+		 * of the type that is hashed in the index.
+		 */
+		so->hashes = palloc0(sizeof(uint32) * Max(scan->numberOfKeys, 1));
+		so->hashvalid = palloc0(sizeof(bool) * Max(scan->numberOfKeys, 1));
+
+		for (int i = 0; i < scan->numberOfKeys; i++)
+		{
+			ScanKey		skey = &scan->keyData[i];
+
+			if (skey->sk_flags & (SK_ISNULL | SK_SEARCHNULL | SK_SEARCHNOTNULL))
+				continue;
+			if (OidIsValid(skey->sk_subtype) && skey->sk_subtype != opcintype)
+				continue;
+			so->hashes[i] = bitmapHashKey(&so->state, skey->sk_argument, false);
+			so->hashvalid[i] = true;
+		}
+	}
+
+	pgstat_count_index_scan(index);
+	if (scan->instrument)
+		scan->instrument->nsearches++;
+
+	/* Collect the chains of the matching keys */
+	blkno = BITMAP_DIRHEAD_BLKNO;
+	while (BlockNumberIsValid(blkno))
+	{
+		Buffer		buffer;
+		Page		page;
+		OffsetNumber maxoff;
+
+		buffer = ReadBuffer(index, blkno);
+		LockBuffer(buffer, BUFFER_LOCK_SHARE);
+		page = BufferGetPage(buffer);
+
+		maxoff = PageGetMaxOffsetNumber(page);
+		for (OffsetNumber off = FirstOffsetNumber; off <= maxoff; off++)
+		{
+			BitmapDirEntry entry;
+
+			entry = (BitmapDirEntry) PageGetItem(page, PageGetItemId(page, off));
+			if (!bmEntryMatches(scan, entry))
+				continue;
+
+			if (nheads == maxheads)
+			{
+				maxheads = Max(maxheads * 2, 16);
+				if (heads == NULL)
+					heads = palloc(maxheads * sizeof(BlockNumber));
+				else
+					heads = repalloc(heads, maxheads * sizeof(BlockNumber));
+			}
+			heads[nheads++] = entry->head;
+		}
+
+		blkno = BitmapPageGetOpaque(page)->next;
+		UnlockReleaseBuffer(buffer);
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	/* Read the chains */
+	for (int i = 0; i < nheads; i++)
+	{
+		blkno = heads[i];
+		while (BlockNumberIsValid(blkno))
+		{
+			Buffer		buffer;
+			Page		page;
+
+			buffer = ReadBuffer(index, blkno);
+			LockBuffer(buffer, BUFFER_LOCK_SHARE);
+			page = BufferGetPage(buffer);
+
+			ntids += bmAddDataPage(tbm, page);
+
+			blkno = BitmapPageGetOpaque(page)->next;
+			UnlockReleaseBuffer(buffer);
+			CHECK_FOR_INTERRUPTS();
+		}
+	}
+
+	if (heads)
+		pfree(heads);
+
+	return ntids;
+}
@@ -0,0 +1,392 @@
+/*-------------------------------------------------------------------------
+ *
+ * bmutils.c
+ *		Bitmap index utilities.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  contrib/bitmap/bmutils.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/amapi.h"
+#include "access/generic_xlog.h"
+#include "access/reloptions.h"
+#include "bitmap.h"
+#include "commands/vacuum.h"
+#include "port/pg_bitutils.h"
+#include "storage/bufmgr.h"
+#include "utils/lsyscache.h"
+#include "utils/rel.h"
+
+PG_FUNCTION_INFO_V1(bmhandler);
+
+/* Kind of relation options for bitmap index */
+static relopt_kind bm_relopt_kind;
+
+/*
+ * Module initialize function: bitmap indexes have no options of their own,
+ * but need a kind to reject everything else.
+ */
+void
+_PG_init(void)
+{
+	bm_relopt_kind = add_reloption_kind();
+}
+
+/*
+ * Bitmap handler function: return IndexAmRoutine with access method
+ * parameters and callbacks.
+ */
+Datum
+bmhandler(PG_FUNCTION_ARGS)
+{
+	IndexAmRoutine *amroutine = makeNode(IndexAmRoutine);
+
+	amroutine->amstrategies = BITMAP_NSTRATEGIES;
+	amroutine->amsupport = BITMAP_NPROC;
+	amroutine->amoptsprocnum = 0;
+	amroutine->amcanorder = false;
+	amroutine->amcanorderbyop = false;
+	amroutine->amcanhash = false;
+	amroutine->amconsistentequality = false;
+	amroutine->amconsistentordering = false;
+	amroutine->amcanbackward = false;
+	amroutine->amcanunique = false;
+	amroutine->amcanmulticol = false;
+	amroutine->amoptionalkey = false;
+	amroutine->amsearcharray = false;
+	amroutine->amsearchnulls = true;
+	amroutine->amstorage = false;
+	amroutine->amclusterable = false;
+	amroutine->ampredlocks = false;
+	amroutine->amcanparallel = false;
+	amroutine->amcanbuildparallel = false;
+	amroutine->amcaninclude = false;
+	amroutine->amusemaintenanceworkmem = false;
+	amroutine->amparallelvacuumoptions =
+		VACUUM_OPTION_PARALLEL_BULKDEL | VACUUM_OPTION_PARALLEL_CLEANUP;
+	amroutine->amkeytype = InvalidOid;
+
+	amroutine->ambuild = bmbuild;
+	amroutine->ambuildempty = bmbuildempty;
+	amroutine->aminsert = bminsert;
+	amroutine->aminsertcleanup = NULL;
+	amroutine->ambulkdelete = bmbulkdelete;
+	amroutine->amvacuumcleanup = bmvacuumcleanup;
+	amroutine->amcanreturn = NULL;
+	amroutine->amcostestimate = bmcostestimate;
+	amroutine->amgettreeheight = NULL;
+	amroutine->amoptions = bmoptions;
+	amroutine->amproperty = NULL;
+	amroutine->ambuildphasename = NULL;
+	amroutine->amvalidate = bmvalidate;
+	amroutine->amadjustmembers = NULL;
+	amroutine->ambeginscan = bmbeginscan;
+	amroutine->amrescan = bmrescan;
+	amroutine->amgettuple = NULL;
+	amroutine->amgetbitmap = bmgetbitmap;
+	amroutine->amendscan = bmendscan;
+	amroutine->ammarkpos = NULL;
+	amroutine->amrestrpos = NULL;
+	amroutine->amestimateparallelscan = NULL;
+	amroutine->aminitparallelscan = NULL;
+	amroutine->amparallelrescan = NULL;
+	amroutine->amtranslatestrategy = NULL;
+	amroutine->amtranslatecmptype = NULL;
+
+	PG_RETURN_POINTER(amroutine);
+}
+
+/*
+ * Fill BitmapState structure for particular index.
+ */
+void
+initBitmapState(BitmapState *state, Relation index)
+{
+	Oid			opfamily = index->rd_opfamily[0];
+	Oid			opcintype = index->rd_opcintype[0];
+	Oid			eqop;
+
+	fmgr_info_copy(&state->hashFn,
+				   index_getprocinfo(index, 1, BITMAP_HASH_PROC),
+				   CurrentMemoryContext);
+
+	eqop = get_opfamily_member(opfamily, opcintype, opcintype,
+							   BITMAP_EQUAL_STRATEGY);
+	if (!OidIsValid(eqop))
+		elog(ERROR, "missing operator %d(%u,%u) in opfamily %u",
+			 BITMAP_EQUAL_STRATEGY, opcintype, opcintype, opfamily);
+	fmgr_info(get_opcode(eqop), &state->equalFn);
+
+	state->collation = index->rd_indcollation[0];
+	state->tupdesc = RelationGetDescr(index);
+}
+
+/*
+ * Hash a key for its directory entry.
+ */
+uint32
+bitmapHashKey(BitmapState *state, Datum value, bool isnull)
+{
+	if (isnull)
+		return 0;
+	return DatumGetUInt32(FunctionCall1Coll(&state->hashFn, state->collation,
+											value));
+}
+
+/*
+ * Add a TID to a data page: to the page's container for the TID's heap
+ * blocks if there is one, else to a new one.  Returns false if the page has
+ * no room for it.
+ */
+bool
+BitmapPageAddTid(Page page, ItemPointer tid)
+{
+	BlockNumber blkno = ItemPointerGetBlockNumber(tid);
+	OffsetNumber offnum = ItemPointerGetOffsetNumber(tid);
+	uint32		chunk = blkno / BITMAP_CONTAINER_BLOCKS;
+	uint16		pos;
+	char	   *ptr = PageGetContents(page);
+	char	   *end = page + ((PageHeader) page)->pd_lower;
+	BitmapContainer c;
+
+	Assert(BitmapPageIsData(page));
+	Assert(offnum >= FirstOffsetNumber && offnum <= MaxHeapTuplesPerPage);
+
+	pos = ((blkno % BITMAP_CONTAINER_BLOCKS) << BITMAP_OFFSET_BITS) |
+		(offnum - 1);
+
+	while (ptr < end)
+	{
+		c = (BitmapContainer) ptr;
+		if (c->chunk == chunk)
+			break;
+		ptr += BitmapContainerSize(c);
+	}
+
+	if (ptr >= end)
+	{
+		/* No container for these blocks yet, start an array */
+		if (BitmapPageGetFreeSpace(page) <
+			sizeof(BitmapContainerData) + BitmapArrayPayloadSize(1))
+			return false;
+
+		c = (BitmapContainer) end;
+		memset(c, 0, sizeof(BitmapContainerData) + BitmapArrayPayloadSize(1));
+		c->chunk = chunk;
+		c->count = 1;
+		c->kind = BITMAP_CONTAINER_ARRAY;
+		BitmapContainerPositions(c)[0] = pos;
+		((PageHeader) page)->pd_lower += BitmapContainerSize(c);
+		return true;
+	}
+
+	if (c->kind == BITMAP_CONTAINER_BITMAP)
+	{
+		uint64	   *words = BitmapContainerWords(c);
+		uint64		bit = UINT64CONST(1) << (pos % 64);
+
+		if ((words[pos / 64] & bit) == 0)
+		{
+			words[pos / 64] |= bit;
+			c->count++;
+		}
+		return true;
+	}
+	else
+	{
+		uint16	   *positions = BitmapContainerPositions(c);
+		int			lo = 0,
+					hi = c->count;
+		Size		growth;
+
+		/* Find the insertion point */
+		while (lo < hi)
+		{
+			int			mid = (lo + hi) / 2;
+
+			if (positions[mid] < pos)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo < c->count && positions[lo] == pos)
+			return true;
+
+		if (c->count == BITMAP_ARRAY_MAX)
+		{
+			uint64		words[BITMAP_BITMAP_WORDS];
+
+			/*
+			 * The array is as large as a bitmap now, so switch to that.  This
+			 * doesn't change the size of the container.
+			 */
+			StaticAssertStmt(BitmapArrayPayloadSize(BITMAP_ARRAY_MAX) == BITMAP_BITMAP_SIZE,
+							 "full array container must be as large as a bitmap");
+			memset(words, 0, sizeof(words));
+			for (int i = 0; i < c->count; i++)
+				words[positions[i] / 64] |= UINT64CONST(1) << (positions[i] % 64);
+			words[pos / 64] |= UINT64CONST(1) << (pos % 64);
+			memcpy(BitmapContainerWords(c), words, sizeof(words));
+			c->kind = BITMAP_CONTAINER_BITMAP;
+			c->count++;
+			return true;
+		}
+
+		growth = BitmapArrayPayloadSize(c->count + 1) -
+			BitmapArrayPayloadSize(c->count);
+		if (growth > BitmapPageGetFreeSpace(page))
+			return false;
+
+		if (growth > 0)
+		{
+			char	   *cend = (char *) c + BitmapContainerSize(c);
+
+			memmove(cend + growth, cend, end - cend);
+			memset(cend, 0, growth);
+			((PageHeader) page)->pd_lower += growth;
+		}
+		memmove(positions + lo + 1, positions + lo,
+				(c->count - lo) * sizeof(uint16));
+		positions[lo] = pos;
+		c->count++;
+		return true;
+	}
+}
+
+/*
+ * Append a container for the given heap chunk to a data page.  The TIDs are
+ * given as a sorted array of count positions, which is stored as is unless
+ * a bitmap would be smaller.  Returns false if the page has no room for it.
+ */
+bool
+BitmapPageAddContainer(Page page, uint32 chunk, const uint16 *positions,
+					   int count)
+{
+	BitmapContainer c;
+	Size		size;
+
+	Assert(BitmapPageIsData(page));
+	Assert(count > 0);
+
+	if (count > BITMAP_ARRAY_MAX)
+		size = sizeof(BitmapContainerData) + BITMAP_BITMAP_SIZE;
+	else
+		size = sizeof(BitmapContainerData) + BitmapArrayPayloadSize(count);
+	if (size > BitmapPageGetFreeSpace(page))
+		return false;
+
+	c = (BitmapContainer) (page + ((PageHeader) page)->pd_lower);
+	memset(c, 0, size);
+	c->chunk = chunk;
+	c->count = count;
+	if (count > BITMAP_ARRAY_MAX)
+	{
+		uint64	   *words = BitmapContainerWords(c);
+
+		c->kind = BITMAP_CONTAINER_BITMAP;
+		for (int i = 0; i < count; i++)
+			words[positions[i] / 64] |= UINT64CONST(1) << (positions[i] % 64);
+	}
+	else
+	{
+		c->kind = BITMAP_CONTAINER_ARRAY;
+		memcpy(BitmapContainerPositions(c), positions,
+			   count * sizeof(uint16));
+	}
+	((PageHeader) page)->pd_lower += size;
+
+	return true;
+}
+
+/*
+ * Allocate a new page by extending the index file.  Pages are never
+ * recycled, which keeps the pages of every chain in ascending order.
+ * The returned buffer is already pinned and exclusive-locked.
+ * Caller is responsible for initializing the page by calling BitmapInitPage.
+ */
+Buffer
+BitmapNewBuffer(Relation index)
+{
+	return ExtendBufferedRel(BMR_REL(index), MAIN_FORKNUM, NULL,
+							 EB_LOCK_FIRST);
+}
+
+/*
+ * Initialize any page of a bitmap index.
+ */
+void
+BitmapInitPage(Page page, uint16 flags)
+{
+	BitmapPageOpaque opaque;
+
+	PageInit(page, BLCKSZ, sizeof(BitmapPageOpaqueData));
+
+	opaque = BitmapPageGetOpaque(page);
+	opaque->next = InvalidBlockNumber;
+	opaque->flags = flags;
+	opaque->bitmap_page_id = BITMAP_PAGE_ID;
+}
+
+/*
+ * Initialize the metapage and the first directory page of a bitmap index.
+ */
+void
+BitmapInitMetapage(Relation index, ForkNumber forknum)
+{
+	Buffer		metaBuffer,
+				dirBuffer;
+	Page		metaPage,
+				dirPage;
+	BitmapMetaPageData *metadata;
+	GenericXLogState *state;
+
+	/*
+	 * Make the first two pages.  No need to hold the extension lock because
+	 * there cannot be concurrent inserters yet.
+	 */
+	metaBuffer = ReadBufferExtended(index, forknum, P_NEW, RBM_NORMAL, NULL);
+	LockBuffer(metaBuffer, BUFFER_LOCK_EXCLUSIVE);
+	Assert(BufferGetBlockNumber(metaBuffer) == BITMAP_METAPAGE_BLKNO);
+	dirBuffer = ReadBufferExtended(index, forknum, P_NEW, RBM_NORMAL, NULL);
+	LockBuffer(dirBuffer, BUFFER_LOCK_EXCLUSIVE);
+	Assert(BufferGetBlockNumber(dirBuffer) == BITMAP_DIRHEAD_BLKNO);
+
+	state = GenericXLogStart(index);
+	metaPage = GenericXLogRegisterBuffer(state, metaBuffer,
+										 GENERIC_XLOG_FULL_IMAGE);
+	dirPage = GenericXLogRegisterBuffer(state, dirBuffer,
+										GENERIC_XLOG_FULL_IMAGE);
+
+	BitmapInitPage(metaPage, BITMAP_META);
+	metadata = BitmapPageGetMeta(metaPage);
+	memset(metadata, 0, sizeof(BitmapMetaPageData));
+	metadata->magickNumber = BITMAP_MAGICK_NUMBER;
+	metadata->nkeys = 0;
+	metadata->dirTail = BITMAP_DIRHEAD_BLKNO;
+	((PageHeader) metaPage)->pd_lower += sizeof(BitmapMetaPageData);
+
+	BitmapInitPage(dirPage, BITMAP_DIRECTORY);
+
+	GenericXLogFinish(state);
+
+	UnlockReleaseBuffer(dirBuffer);
+	UnlockReleaseBuffer(metaBuffer);
+}
+
+/*
+ * Parse reloptions for bitmap index.  There are none, so this only rejects
+ * unknown options.
+ */
+bytea *
+bmoptions(Datum reloptions, bool validate)
+{
+	return (bytea *) build_reloptions(reloptions, validate,
+									  bm_relopt_kind,
+									  sizeof(int32),
+									  NULL, 0);
+}
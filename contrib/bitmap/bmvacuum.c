@@ -0,0 +1,219 @@
+/*-------------------------------------------------------------------------
+ *
+ * bmvacuum.c
+ *		Bitmap VACUUM functions.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  contrib/bitmap/bmvacuum.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "bitmap.h"
+#include "commands/vacuum.h"
+#include "port/pg_bitutils.h"
+#include "storage/bufmgr.h"
+
+
+/*
+ * Rewrite the containers of a data page into tmp, leaving out the TIDs the
+ * callback says are dead.  Containers that become small enough turn back
+ * into arrays, and empty ones are dropped.  Returns the number of TIDs
+ * removed, and adds the number kept to *nkept.
+ */
+static int64
+bmVacuumPage(Page page, Page tmp, IndexBulkDeleteCallback callback,
+			 void *callback_state, double *nkept)
+{
+	char	   *ptr = PageGetContents(page);
+	char	   *end = page + ((PageHeader) page)->pd_lower;
+	int64		nremoved = 0;
+	uint16		positions[BITMAP_CONTAINER_BLOCKS * BITMAP_POSITIONS_PER_BLOCK];
+
+	BitmapInitPage(tmp, BITMAP_DATA);
+	BitmapPageGetOpaque(tmp)->next = BitmapPageGetOpaque(page)->next;
+
+	while (ptr < end)
+	{
+		BitmapContainer c = (BitmapContainer) ptr;
+		BlockNumber firstblk = c->chunk * BITMAP_CONTAINER_BLOCKS;
+		int			n = 0;
+		int			npos = 0;
+
+		/* Collect the positions of the container in ascending order */
+		if (c->kind == BITMAP_CONTAINER_BITMAP)
+		{
+			uint64	   *words = BitmapContainerWords(c);
+
+			for (int w = 0; w < BITMAP_BITMAP_WORDS; w++)
+			{
+				uint64		word = words[w];
+
+				while (word != 0)
+				{
+					positions[npos++] = w * 64 + pg_rightmost_one_pos64(word);
+					word &= word - 1;
+				}
+			}
+		}
+		else
+		{
+			npos = c->count;
+			memcpy(positions, BitmapContainerPositions(c),
+				   npos * sizeof(uint16));
+		}
+
+		/* Keep the live ones */
+		for (int i = 0; i < npos; i++)
+		{
+			ItemPointerData tid;
+
+			ItemPointerSet(&tid,
+						   firstblk + (positions[i] >> BITMAP_OFFSET_BITS),
+						   (positions[i] & (BITMAP_POSITIONS_PER_BLOCK - 1)) + 1);
+			if (callback(&tid, callback_state))
+				nremoved++;
+			else
+				positions[n++] = positions[i];
+		}
+
+		/* A container never grows by losing TIDs, so this must fit */
+		if (n > 0 && !BitmapPageAddContainer(tmp, c->chunk, positions, n))
+			elog(ERROR, "could not rewrite bitmap container");
+
+		*nkept += n;
+		ptr += BitmapContainerSize(c);
+	}
+
+	return nremoved;
+}
+
+/*
+ * Bulk deletion of all index entries pointing to a set of heap tuples.
+ * The set of target tuples is specified via a callback routine that tells
+ * whether any given heap tuple (identified by ItemPointer) is being deleted.
+ *
+ * Pages and directory entries that become empty are kept; the index only
+ * shrinks on REINDEX.
+ *
+ * Result: a palloc'd struct containing statistical info for VACUUM displays.
+ */
+IndexBulkDeleteResult *
+bmbulkdelete(IndexVacuumInfo *info, IndexBulkDeleteResult *stats,
+			 IndexBulkDeleteCallback callback, void *callback_state)
+{
+	Relation	index = info->index;
+	BlockNumber blkno,
+				npages;
+	PGAlignedBlock tmp;
+
+	if (stats == NULL)
+		stats = (IndexBulkDeleteResult *) palloc0(sizeof(IndexBulkDeleteResult));
+
+	/*
+	 * Iterate over the pages. We don't care about concurrently added pages,
+	 * they can't contain tuples to delete.
+	 */
+	npages = RelationGetNumberOfBlocks(index);
+	stats->num_index_tuples = 0;
+	for (blkno = BITMAP_DIRHEAD_BLKNO; blkno < npages; blkno++)
+	{
+		Buffer		buffer;
+		Page		page;
+		int64		nremoved;
+
+		vacuum_delay_point(false);
+
+		buffer = ReadBufferExtended(index, MAIN_FORKNUM, blkno,
+									RBM_NORMAL, info->strategy);
+		LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+		page = BufferGetPage(buffer);
+
+		if (PageIsNew(page) || !BitmapPageIsData(page))
+		{
+			UnlockReleaseBuffer(buffer);
+			continue;
+		}
+
+		nremoved = bmVacuumPage(page, tmp.data, callback, callback_state,
+								&stats->num_index_tuples);
+		if (nremoved > 0)
+		{
+			GenericXLogState *gxlogState;
+			Page		newPage;
+
+			gxlogState = GenericXLogStart(index);
+			newPage = GenericXLogRegisterBuffer(gxlogState, buffer, 0);
+			memcpy(newPage, tmp.data, BLCKSZ);
+			GenericXLogFinish(gxlogState);
+
+			stats->tuples_removed += nremoved;
+		}
+
+		UnlockReleaseBuffer(buffer);
+	}
+
+	return stats;
+}
+
+/*
+ * Post-VACUUM cleanup.
+ *
+ * Result: a palloc'd struct containing statistical info for VACUUM displays.
+ */
+IndexBulkDeleteResult *
+bmvacuumcleanup(IndexVacuumInfo *info, IndexBulkDeleteResult *stats)
+{
+	Relation	index = info->index;
+	BlockNumber npages,
+				blkno;
+
+	if (info->analyze_only)
+		return stats;
+
+	npages = RelationGetNumberOfBlocks(index);
+
+	/* bulkdelete has counted the tuples already */
+	if (stats != NULL)
+	{
+		stats->num_pages = npages;
+		return stats;
+	}
+
+	stats = (IndexBulkDeleteResult *) palloc0(sizeof(IndexBulkDeleteResult));
+	stats->num_pages = npages;
+	for (blkno = BITMAP_DIRHEAD_BLKNO; blkno < npages; blkno++)
+	{
+		Buffer		buffer;
+		Page		page;
+
+		vacuum_delay_point(false);
+
+		buffer = ReadBufferExtended(index, MAIN_FORKNUM, blkno,
+									RBM_NORMAL, info->strategy);
+		LockBuffer(buffer, BUFFER_LOCK_SHARE);
+		page = BufferGetPage(buffer);
+
+		if (!PageIsNew(page) && BitmapPageIsData(page))
+		{
+			char	   *ptr = PageGetContents(page);
+			char	   *end = page + ((PageHeader) page)->pd_lower;
+
+			while (ptr < end)
+			{
+				BitmapContainer c = (BitmapContainer) ptr;
+
+				stats->num_index_tuples += c->count;
+				ptr += BitmapContainerSize(c);
+			}
+		}
+
+		UnlockReleaseBuffer(buffer);
+	}
+
+	return stats;
+}
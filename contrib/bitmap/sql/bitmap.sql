@@ -0,0 +1,70 @@
+CREATE EXTENSION bitmap;
+
+CREATE TABLE tst (
+	i	int4,
+	t	text
+);
+
+INSERT INTO tst SELECT i % 10, 'k' || (i % 3) FROM generate_series(1, 20000) i;
+CREATE INDEX bmidxi ON tst USING bitmap (i);
+CREATE INDEX bmidxt ON tst USING bitmap (t);
+
+SET enable_seqscan = off;
+SET enable_indexscan = off;
+
+EXPLAIN (COSTS OFF) SELECT count(*) FROM tst WHERE i = 7;
+EXPLAIN (COSTS OFF) SELECT count(*) FROM tst WHERE t = 'k2';
+
+SELECT count(*) FROM tst WHERE i = 7;
+SELECT count(*) FROM tst WHERE t = 'k2';
+SELECT count(*) FROM tst WHERE i = 7 AND t = 'k2';
+SELECT count(*) FROM tst WHERE i = 7 OR t = 'k2';
+SELECT count(*) FROM tst WHERE i = ANY ('{1, 2, 3}');
+
+-- New keys and NULLs, added by inserts
+INSERT INTO tst SELECT CASE WHEN i % 2 = 0 THEN 42 END, 'new' FROM generate_series(1, 3000) i;
+
+EXPLAIN (COSTS OFF) SELECT count(*) FROM tst WHERE i IS NULL;
+
+SELECT count(*) FROM tst WHERE i = 42;
+SELECT count(*) FROM tst WHERE i IS NULL;
+SELECT count(*) FROM tst WHERE t = 'new';
+SELECT count(*) FROM tst WHERE t = 'new' AND i IS NOT NULL;
+SELECT count(*) FROM tst WHERE i = 7 OR t = 'new';
+
+DELETE FROM tst WHERE i = 42 OR t = 'k1';
+VACUUM tst;
+
+SELECT count(*) FROM tst WHERE i = 7;
+SELECT count(*) FROM tst WHERE i = 42;
+SELECT count(*) FROM tst WHERE t = 'k1';
+SELECT count(*) FROM tst WHERE t = 'new';
+SELECT count(*) FROM tst WHERE i IS NULL;
+
+INSERT INTO tst SELECT 42, 'k1' FROM generate_series(1, 100);
+
+SELECT count(*) FROM tst WHERE i = 42;
+SELECT count(*) FROM tst WHERE t = 'k1';
+
+REINDEX INDEX bmidxt;
+
+SELECT count(*) FROM tst WHERE t = 'new';
+SELECT count(*) FROM tst WHERE t = 'k2';
+
+-- Unsupported index definitions
+CREATE INDEX ON tst USING bitmap (i, t);
+CREATE UNIQUE INDEX ON tst USING bitmap (i);
+CREATE INDEX ON tst USING bitmap (i) WITH (fillfactor = 50);
+
+RESET enable_seqscan;
+RESET enable_indexscan;
+
+DROP TABLE tst;
+
+--
+-- Check opclasses
+--
+SELECT opcname, amvalidate(opc.oid)
+FROM pg_opclass opc JOIN pg_am am ON am.oid = opcmethod
+WHERE amname = 'bitmap'
+ORDER BY 1;
@@ -0,0 +1,88 @@
+/* contrib/columnar/columnar--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION columnar" to load this file. \quit
+
+-- Column segments, keyed by the locator of the storage of the table they
+-- belong to: its tablespace, database and relfilenumber
+CREATE TABLE columnar.segment (
+	spcoid oid NOT NULL,
+	dboid oid NOT NULL,
+	relnumber oid NOT NULL,
+	segment_id int8 NOT NULL,
+	first_row int8 NOT NULL,
+	row_count int4 NOT NULL,
+	data_size int8 NOT NULL,
+	CONSTRAINT segment_pkey PRIMARY KEY (spcoid, dboid, relnumber, segment_id)
+);
+
+CREATE TABLE columnar.chunk (
+	spcoid oid NOT NULL,
+	dboid oid NOT NULL,
+	relnumber oid NOT NULL,
+	segment_id int8 NOT NULL,
+	attnum int2 NOT NULL,
+	null_count int4 NOT NULL,
+	min_value bytea,
+	max_value bytea,
+	data bytea NOT NULL,
+	CONSTRAINT chunk_pkey PRIMARY KEY (spcoid, dboid, relnumber, segment_id, attnum)
+);
+
+-- chunks are compressed already
+ALTER TABLE columnar.chunk ALTER COLUMN data SET STORAGE EXTERNAL;
+
+CREATE TABLE columnar.deleted_row (
+	spcoid oid NOT NULL,
+	dboid oid NOT NULL,
+	relnumber oid NOT NULL,
+	row_number int8 NOT NULL,
+	updated_to tid,
+	CONSTRAINT deleted_row_pkey PRIMARY KEY (spcoid, dboid, relnumber, row_number)
+);
+
+REVOKE ALL ON columnar.segment, columnar.chunk, columnar.deleted_row FROM PUBLIC;
+
+CREATE FUNCTION columnar.columnar_handler(internal)
+RETURNS table_am_handler
+AS 'MODULE_PATHNAME'
+LANGUAGE C;
+
+CREATE ACCESS METHOD columnar TYPE TABLE HANDLER columnar.columnar_handler;
+COMMENT ON ACCESS METHOD columnar IS 'columnar table access method';
+
+CREATE FUNCTION columnar.merge(rel regclass, min_rows int8 DEFAULT 0)
+RETURNS int8
+AS 'MODULE_PATHNAME', 'columnar_merge'
+LANGUAGE C STRICT;
+
+CREATE FUNCTION columnar.cleanup()
+RETURNS int8
+AS 'MODULE_PATHNAME', 'columnar_cleanup'
+LANGUAGE C STRICT;
+
+REVOKE ALL ON FUNCTION columnar.cleanup() FROM PUBLIC;
+
+CREATE FUNCTION columnar.drop_trigger()
+RETURNS event_trigger
+AS 'MODULE_PATHNAME', 'columnar_drop_trigger'
+LANGUAGE C;
+
+CREATE EVENT TRIGGER columnar_drop_trigger ON sql_drop
+	WHEN TAG IN ('DROP TABLE', 'DROP MATERIALIZED VIEW', 'DROP SCHEMA',
+				 'DROP OWNED')
+	EXECUTE FUNCTION columnar.drop_trigger();
+
+-- Segments of the columnar tables of the current database
+CREATE VIEW columnar.segments AS
+	SELECT c.oid::regclass AS relation,
+		   s.segment_id,
+		   s.first_row,
+		   s.row_count,
+		   s.data_size
+	FROM columnar.segment s
+		JOIN pg_class c ON c.oid = pg_filenode_relation(s.spcoid, s.relnumber)
+	WHERE s.dboid = (SELECT oid FROM pg_database
+					 WHERE datname = current_database());
+
+GRANT SELECT ON columnar.segments TO PUBLIC;
@@ -0,0 +1,195 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar.h
+ *	  Header for the columnar table access method.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef COLUMNAR_H
+#define COLUMNAR_H
+
+#include "access/htup_details.h"
+#include "access/relscan.h"
+#include "access/tableam.h"
+#include "fmgr.h"
+#include "nodes/execnodes.h"
+#include "storage/itemptr.h"
+#include "utils/rel.h"
+
+/*
+ * Rows that have been merged into column segments are numbered from 0 in
+ * merge order.  They get TIDs from COLUMNAR_FIRST_SEGMENT_BLOCK upwards, so
+ * that they can't be confused with the TIDs of the rows in the delta store,
+ * which is an ordinary heap in the relation's main fork.  Each virtual block
+ * holds as many rows as a heap page can, so that the TIDs are acceptable
+ * anywhere a heap TID is.
+ */
+#define COLUMNAR_FIRST_SEGMENT_BLOCK	((BlockNumber) 0x80000000)
+#define COLUMNAR_ROWS_PER_BLOCK			MaxHeapTuplesPerPage
+
+#define ColumnarTidIsSegmentRow(tid) \
+	(ItemPointerGetBlockNumberNoCheck(tid) >= COLUMNAR_FIRST_SEGMENT_BLOCK)
+
+static inline void
+columnar_row_to_tid(int64 rownum, ItemPointer tid)
+{
+	ItemPointerSet(tid,
+				   COLUMNAR_FIRST_SEGMENT_BLOCK +
+				   (BlockNumber) (rownum / COLUMNAR_ROWS_PER_BLOCK),
+				   (OffsetNumber) (rownum % COLUMNAR_ROWS_PER_BLOCK) + 1);
+}
+
+static inline int64
+columnar_tid_to_row(ItemPointer tid)
+{
+	return (int64) (ItemPointerGetBlockNumberNoCheck(tid) -
+					COLUMNAR_FIRST_SEGMENT_BLOCK) * COLUMNAR_ROWS_PER_BLOCK +
+		ItemPointerGetOffsetNumberNoCheck(tid) - 1;
+}
+
+/* Compression methods for column chunks */
+typedef enum ColumnarCompression
+{
+	COLUMNAR_COMPRESSION_NONE,
+	COLUMNAR_COMPRESSION_PGLZ,
+	COLUMNAR_COMPRESSION_LZ4,
+} ColumnarCompression;
+
+/* GUC parameters */
+extern PGDLLIMPORT int columnar_segment_row_count;
+extern PGDLLIMPORT int columnar_compression;
+extern PGDLLIMPORT bool columnar_enable_custom_scan;
+
+/* One visible segment, as read from columnar.segment */
+typedef struct ColumnarSegment
+{
+	int64		segment_id;
+	int64		first_row;
+	int32		row_count;
+} ColumnarSegment;
+
+/*
+ * A segment-skipping filter: "column op value", where op is a btree
+ * comparison operator.  The value is computed when the scan starts.
+ */
+typedef struct ColumnarFilter
+{
+	AttrNumber	attnum;
+	int			strategy;		/* BTLessStrategyNumber etc */
+	FmgrInfo	cmpfinfo;		/* btree comparison proc for column, value */
+	Oid			collation;
+	Datum		value;
+	bool		isnull;
+} ColumnarFilter;
+
+/*
+ * A batch of decoded rows: the rows of one segment, with only the columns
+ * the scan asked for filled in.  Rows deleted since the merge are left out
+ * of rows[], the selection vector.
+ */
+typedef struct ColumnarBatch
+{
+	int64		first_row;		/* row number of the segment's first row */
+	int			nrows;			/* rows in the segment */
+	int			nselected;		/* entries in rows[] */
+	int		   *rows;			/* indexes of the visible rows */
+	Datum	  **values;			/* per attribute, NULL if not read */
+	bool	  **isnull;
+} ColumnarBatch;
+
+/* Scan descriptor */
+typedef struct ColumnarScanDescData
+{
+	TableScanDescData rs_base;
+
+	MemoryContext scan_cxt;		/* holds everything below */
+	TableScanDesc delta_scan;	/* scan of the delta store */
+	Bitmapset  *attrs_needed;	/* attribute numbers to decode, or NULL */
+	List	   *filters;		/* ColumnarFilter list */
+
+	bool		segments_loaded;	/* segments and deleted_rows are set */
+	List	   *segments;		/* ColumnarSegment list */
+	int			next_segment;	/* index into segments */
+	bool		segments_done;
+
+	int64	   *deleted_rows;	/* sorted row numbers deleted, visible */
+	int			ndeleted;
+
+	ColumnarBatch batch;		/* current segment */
+	int			batch_pos;		/* next entry of batch.rows to return */
+	MemoryContext batch_cxt;	/* holds the current batch */
+
+	int64		segments_skipped;	/* by the filters */
+} ColumnarScanDescData;
+
+typedef struct ColumnarScanDescData *ColumnarScanDesc;
+
+/* Writing segments */
+typedef struct ColumnarWriteState ColumnarWriteState;
+
+/* columnar_tableam.c */
+extern bool columnar_relation_is_columnar(Relation rel);
+extern ColumnarScanDesc columnar_beginscan_extended(Relation rel,
+													Snapshot snapshot,
+													Bitmapset *attrs_needed,
+													List *filters);
+extern bool columnar_scan_next_batch(ColumnarScanDesc scan,
+									 ColumnarBatch **batch);
+extern bool columnar_scan_next_delta(ColumnarScanDesc scan,
+									 TupleTableSlot *slot);
+
+/* columnar_storage.c */
+extern RelFileLocator columnar_storage_id(Relation rel);
+extern List *columnar_read_segments(RelFileLocator storage, Snapshot snapshot);
+extern int64 *columnar_read_deleted_rows(RelFileLocator storage,
+										 Snapshot snapshot, int *ndeleted);
+extern bool columnar_segment_passes_filters(Relation rel,
+											RelFileLocator storage,
+											ColumnarSegment *segment,
+											List *filters,
+											Snapshot snapshot);
+extern void columnar_read_batch(Relation rel, RelFileLocator storage,
+								ColumnarSegment *segment,
+								Bitmapset *attrs_needed, Snapshot snapshot,
+								ColumnarBatch *batch);
+extern ColumnarSegment *columnar_find_segment(RelFileLocator storage,
+											  int64 rownum,
+											  Snapshot snapshot);
+extern bool columnar_row_updated_to(Relation rel, int64 rownum,
+									Snapshot snapshot, ItemPointer tid);
+extern bool columnar_fetch_row(Relation rel, int64 rownum, Snapshot snapshot,
+							   TupleTableSlot *slot);
+extern bool columnar_row_visible(Relation rel, int64 rownum,
+								 Snapshot snapshot);
+extern void columnar_storage_estimate(RelFileLocator storage,
+									  Snapshot snapshot,
+									  double *rows, double *bytes);
+extern List *columnar_storage_ids(Snapshot snapshot);
+extern void columnar_storage_delete(RelFileLocator storage,
+									Snapshot snapshot);
+extern void columnar_storage_copy(RelFileLocator old_storage,
+								  RelFileLocator new_storage);
+extern TM_Result columnar_row_deleted(Relation rel, int64 rownum,
+									  CommandId cid, TM_FailureData *tmfd);
+extern void columnar_mark_row_deleted(Relation rel, int64 rownum,
+									  ItemPointer new_tid);
+extern ColumnarWriteState *columnar_begin_write(Relation rel,
+												RelFileLocator storage);
+extern void columnar_write_row(ColumnarWriteState *state,
+							   TupleTableSlot *slot);
+extern int64 columnar_end_write(ColumnarWriteState *state);
+
+/* columnar_merge.c */
+extern int64 columnar_merge_relation(Relation rel, int64 min_rows);
+extern void columnar_cleanup_orphans(void);
+extern void columnar_merge_init(void);
+
+/* columnar_customscan.c */
+extern void columnar_customscan_init(void);
+
+#endif							/* COLUMNAR_H */
@@ -0,0 +1,607 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar_customscan.c
+ *	  Custom scan for columnar tables.
+ *
+ * A sequential scan of a columnar table goes through the table access
+ * method's scan_getnextslot callback, which has to decode every column of
+ * every segment and form a heap tuple for each row, because it isn't told
+ * which columns the query needs.  The ColumnarScan custom scan replaces it:
+ * it decodes only the columns referenced by the query, skips the segments
+ * whose minimum and maximum values rule out the quals of the form
+ * "column op constant", and returns the rows of each segment straight from
+ * the decoded column arrays, in a virtual slot.
+ *
+ * Columnar tables don't support parallel scans, so their partial paths are
+ * removed here whether or not the custom scan is enabled.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar_customscan.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/nbtree.h"
+#include "access/sysattr.h"
+#include "access/table.h"
+#include "catalog/pg_am.h"
+#include "columnar.h"
+#include "commands/defrem.h"
+#include "commands/explain_format.h"
+#include "commands/explain_state.h"
+#include "executor/executor.h"
+#include "nodes/extensible.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
+#include "optimizer/cost.h"
+#include "optimizer/optimizer.h"
+#include "optimizer/pathnode.h"
+#include "optimizer/paths.h"
+#include "optimizer/restrictinfo.h"
+#include "utils/builtins.h"
+#include "utils/datum.h"
+#include "utils/lsyscache.h"
+#include "utils/rel.h"
+#include "utils/ruleutils.h"
+#include "utils/typcache.h"
+
+typedef struct ColumnarScanState
+{
+	CustomScanState css;
+
+	List	   *filters;		/* ColumnarFilter list */
+	Bitmapset  *attrs_needed;
+	ColumnarScanDesc scan;
+	ColumnarBatch *batch;		/* current batch, or NULL */
+	TupleTableSlot *delta_slot; /* for rows of the delta store */
+	int			maxattr;		/* highest attribute number needed */
+	int64		segments_skipped;	/* of earlier scans, before a rescan */
+} ColumnarScanState;
+
+static set_rel_pathlist_hook_type prev_set_rel_pathlist_hook = NULL;
+
+static void columnar_set_rel_pathlist(PlannerInfo *root, RelOptInfo *rel,
+									  Index rti, RangeTblEntry *rte);
+static Plan *columnar_plan_custom_path(PlannerInfo *root, RelOptInfo *rel,
+									   CustomPath *best_path, List *tlist,
+									   List *clauses, List *custom_plans);
+static Node *columnar_create_scan_state(CustomScan *cscan);
+static void columnar_begin_custom_scan(CustomScanState *node, EState *estate,
+									   int eflags);
+static TupleTableSlot *columnar_exec_custom_scan(CustomScanState *node);
+static void columnar_end_custom_scan(CustomScanState *node);
+static void columnar_rescan_custom_scan(CustomScanState *node);
+static void columnar_explain_custom_scan(CustomScanState *node,
+										 List *ancestors, ExplainState *es);
+
+static const CustomPathMethods columnar_path_methods = {
+	.CustomName = "ColumnarScan",
+	.PlanCustomPath = columnar_plan_custom_path,
+};
+
+static const CustomScanMethods columnar_scan_methods = {
+	.CustomName = "ColumnarScan",
+	.CreateCustomScanState = columnar_create_scan_state,
+};
+
+static const CustomExecMethods columnar_exec_methods = {
+	.CustomName = "ColumnarScan",
+	.BeginCustomScan = columnar_begin_custom_scan,
+	.ExecCustomScan = columnar_exec_custom_scan,
+	.EndCustomScan = columnar_end_custom_scan,
+	.ReScanCustomScan = columnar_rescan_custom_scan,
+	.ExplainCustomScan = columnar_explain_custom_scan,
+};
+
+
+void
+columnar_customscan_init(void)
+{
+	prev_set_rel_pathlist_hook = set_rel_pathlist_hook;
+	set_rel_pathlist_hook = columnar_set_rel_pathlist;
+
+	RegisterCustomScanMethods(&columnar_scan_methods);
+}
+
+/*
+ * Return the attribute numbers the scan must decode.  Sets *ok to false if
+ * the scan needs system attributes that the custom scan doesn't provide.
+ */
+static Bitmapset *
+columnar_attrs_needed(RelOptInfo *rel, int natts, bool *ok)
+{
+	Bitmapset  *attrs = NULL;
+	Bitmapset  *result = NULL;
+	int			attno = -1;
+
+	pull_varattnos((Node *) rel->reltarget->exprs, rel->relid, &attrs);
+	foreach_node(RestrictInfo, rinfo, rel->baserestrictinfo)
+		pull_varattnos((Node *) rinfo->clause, rel->relid, &attrs);
+
+	*ok = true;
+	while ((attno = bms_next_member(attrs, attno)) >= 0)
+	{
+		AttrNumber	attnum = attno + FirstLowInvalidHeapAttributeNumber;
+
+		/* a whole-row reference needs everything */
+		if (attnum == InvalidAttrNumber)
+		{
+			bms_free(result);
+			result = NULL;
+			for (int i = 1; i <= natts; i++)
+				result = bms_add_member(result, i);
+			break;
+		}
+
+		if (attnum < 0)
+		{
+			if (attnum != SelfItemPointerAttributeNumber &&
+				attnum != TableOidAttributeNumber)
+			{
+				*ok = false;
+				return NULL;
+			}
+			continue;
+		}
+
+		result = bms_add_member(result, attnum);
+	}
+
+	return result;
+}
+
+/*
+ * Add a ColumnarScan path for columnar tables, replacing the sequential scan.
+ */
+static void
+columnar_set_rel_pathlist(PlannerInfo *root, RelOptInfo *rel, Index rti,
+						  RangeTblEntry *rte)
+{
+	Relation	relation;
+	bool		is_columnar;
+	int			natts;
+	Bitmapset  *attrs;
+	bool		ok;
+	CustomPath *cpath;
+	ParamPathInfo *param_info;
+	Cost		cpu_per_tuple;
+	double		fraction;
+	List	   *pathlist = NIL;
+
+	if (prev_set_rel_pathlist_hook)
+		prev_set_rel_pathlist_hook(root, rel, rti, rte);
+
+	if (rel->reloptkind != RELOPT_BASEREL && rel->reloptkind != RELOPT_OTHER_MEMBER_REL)
+		return;
+	if (rte->rtekind != RTE_RELATION || rte->inh || rte->tablesample ||
+		(rte->relkind != RELKIND_RELATION && rte->relkind != RELKIND_MATVIEW))
+		return;
+
+	relation = table_open(rte->relid, NoLock);
+	is_columnar = columnar_relation_is_columnar(relation);
+	natts = RelationGetNumberOfAttributes(relation);
+	table_close(relation, NoLock);
+
+	if (!is_columnar)
+		return;
+
+	/* columnar tables can't be scanned in parallel */
+	rel->partial_pathlist = NIL;
+
+	if (!columnar_enable_custom_scan)
+		return;
+
+	attrs = columnar_attrs_needed(rel, natts, &ok);
+	if (!ok)
+		return;
+
+	param_info = get_baserel_parampathinfo(root, rel, rel->lateral_relids);
+
+	cpath = makeNode(CustomPath);
+	cpath->path.pathtype = T_CustomScan;
+	cpath->path.parent = rel;
+	cpath->path.pathtarget = rel->reltarget;
+	cpath->path.param_info = param_info;
+	cpath->path.parallel_aware = false;
+	cpath->path.parallel_safe = rel->consider_parallel;
+	cpath->path.parallel_workers = 0;
+	cpath->path.pathkeys = NIL;
+	cpath->path.rows = param_info ? param_info->ppi_rows : rel->rows;
+	cpath->flags = 0;
+	cpath->custom_private = list_make1(bms_copy(attrs));
+	cpath->methods = &columnar_path_methods;
+
+	/*
+	 * Charge for reading the columns needed only.  Segment skipping isn't
+	 * accounted for; we can't tell how well the data is clustered.
+	 */
+	fraction = natts > 0 ? (double) Max(bms_num_members(attrs), 1) / natts : 1.0;
+	cpu_per_tuple = cpu_tuple_cost + rel->baserestrictcost.per_tuple;
+	cpath->path.disabled_nodes = 0;
+	cpath->path.startup_cost = rel->baserestrictcost.startup +
+		rel->reltarget->cost.startup;
+	cpath->path.total_cost = cpath->path.startup_cost +
+		seq_page_cost * rel->pages * fraction +
+		cpu_per_tuple * rel->tuples +
+		rel->reltarget->cost.per_tuple * cpath->path.rows;
+
+	/* the custom scan replaces the sequential scan */
+	foreach_ptr(Path, path, rel->pathlist)
+	{
+		if (path->pathtype != T_SeqScan)
+			pathlist = lappend(pathlist, path);
+	}
+	rel->pathlist = pathlist;
+
+	add_path(rel, &cpath->path);
+}
+
+/*
+ * Can clause be used to skip segments?  It can if it's "column op value",
+ * or the commuted form, with op a btree comparison operator of the column's
+ * type and value a pseudo-constant.  If so, append the attribute number and
+ * strategy to *ints, the comparison function and collation to *oids, and set
+ * *constexpr to the value.
+ */
+static bool
+columnar_filter_from_clause(RelOptInfo *rel, Expr *clause, List **ints,
+							List **oids, Expr **constexpr)
+{
+	OpExpr	   *opexpr;
+	Node	   *left;
+	Node	   *right;
+	Oid			opno;
+	Var		   *var;
+	TypeCacheEntry *typentry;
+	int			strategy;
+	Oid			lefttype;
+	Oid			righttype;
+	Oid			cmpproc;
+
+	if (!IsA(clause, OpExpr) || list_length(((OpExpr *) clause)->args) != 2)
+		return false;
+
+	opexpr = (OpExpr *) clause;
+	opno = opexpr->opno;
+	left = linitial(opexpr->args);
+	right = lsecond(opexpr->args);
+
+	if (IsA(right, Var) && !IsA(left, Var))
+	{
+		Node	   *tmp = left;
+
+		opno = get_commutator(opno);
+		if (!OidIsValid(opno))
+			return false;
+		left = right;
+		right = tmp;
+	}
+
+	if (!IsA(left, Var) || !is_pseudo_constant_clause(right))
+		return false;
+
+	var = (Var *) left;
+	if (var->varno != rel->relid || var->varlevelsup != 0 ||
+		var->varattno <= 0)
+		return false;
+
+	/* the ranges are kept in the column's collation */
+	if (OidIsValid(opexpr->inputcollid) &&
+		opexpr->inputcollid != var->varcollid)
+		return false;
+
+	typentry = lookup_type_cache(var->vartype, TYPECACHE_BTREE_OPFAMILY);
+	if (!OidIsValid(typentry->btree_opf) ||
+		!op_in_opfamily(opno, typentry->btree_opf))
+		return false;
+
+	get_op_opfamily_properties(opno, typentry->btree_opf, false,
+							   &strategy, &lefttype, &righttype);
+	if (lefttype != var->vartype)
+		return false;
+
+	cmpproc = get_opfamily_proc(typentry->btree_opf, lefttype, righttype,
+								BTORDER_PROC);
+	if (!OidIsValid(cmpproc))
+		return false;
+
+	*ints = lappend_int(*ints, var->varattno);
+	*ints = lappend_int(*ints, strategy);
+	*oids = lappend_oid(*oids, cmpproc);
+	*oids = lappend_oid(*oids, opexpr->inputcollid);
+	*constexpr = (Expr *) right;
+
+	return true;
+}
+
+static Plan *
+columnar_plan_custom_path(PlannerInfo *root, RelOptInfo *rel,
+						  CustomPath *best_path, List *tlist,
+						  List *clauses, List *custom_plans)
+{
+	CustomScan *cscan = makeNode(CustomScan);
+	Bitmapset  *attrs = linitial(best_path->custom_private);
+	List	   *attnums = NIL;
+	List	   *filter_ints = NIL;
+	List	   *filter_oids = NIL;
+	List	   *filter_exprs = NIL;
+	int			attno = -1;
+
+	while ((attno = bms_next_member(attrs, attno)) >= 0)
+		attnums = lappend_int(attnums, attno);
+
+	foreach_node(RestrictInfo, rinfo, clauses)
+	{
+		Expr	   *constexpr;
+
+		if (rinfo->pseudoconstant)
+			continue;
+		if (columnar_filter_from_clause(rel, rinfo->clause, &filter_ints,
+										&filter_oids, &constexpr))
+			filter_exprs = lappend(filter_exprs, constexpr);
+	}
+
+	cscan->scan.plan.targetlist = tlist;
+	cscan->scan.plan.qual = extract_actual_clauses(clauses, false);
+	cscan->scan.scanrelid = rel->relid;
+	cscan->flags = best_path->flags;
+	cscan->custom_plans = NIL;
+	cscan->custom_exprs = filter_exprs;
+	cscan->custom_private = list_make3(attnums, filter_ints, filter_oids);
+	cscan->custom_scan_tlist = NIL;
+	cscan->methods = &columnar_scan_methods;
+
+	return &cscan->scan.plan;
+}
+
+static Node *
+columnar_create_scan_state(CustomScan *cscan)
+{
+	ColumnarScanState *state = palloc0(sizeof(ColumnarScanState));
+
+	NodeSetTag(state, T_CustomScanState);
+	state->css.methods = &columnar_exec_methods;
+	state->css.slotOps = &TTSOpsVirtual;
+
+	return (Node *) state;
+}
+
+static void
+columnar_begin_custom_scan(CustomScanState *node, EState *estate, int eflags)
+{
+	ColumnarScanState *state = (ColumnarScanState *) node;
+	CustomScan *cscan = (CustomScan *) node->ss.ps.plan;
+	List	   *attnums = linitial(cscan->custom_private);
+	List	   *filter_ints = lsecond(cscan->custom_private);
+	List	   *filter_oids = lthird(cscan->custom_private);
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	int			i = 0;
+
+	foreach_int(attnum, attnums)
+	{
+		state->attrs_needed = bms_add_member(state->attrs_needed, attnum);
+		state->maxattr = Max(state->maxattr, attnum);
+	}
+
+	/* compute the values the segments are compared with */
+	foreach_ptr(Expr, expr, cscan->custom_exprs)
+	{
+		ColumnarFilter *filter = palloc0(sizeof(ColumnarFilter));
+		ExprState  *exprstate;
+
+		filter->attnum = list_nth_int(filter_ints, 2 * i);
+		filter->strategy = list_nth_int(filter_ints, 2 * i + 1);
+		fmgr_info(list_nth_oid(filter_oids, 2 * i), &filter->cmpfinfo);
+		filter->collation = list_nth_oid(filter_oids, 2 * i + 1);
+
+		exprstate = ExecInitExpr(expr, &node->ss.ps);
+		filter->value = ExecEvalExprSwitchContext(exprstate, econtext,
+												  &filter->isnull);
+		if (!filter->isnull)
+		{
+			int16		typlen;
+			bool		typbyval;
+
+			get_typlenbyval(exprType((Node *) expr), &typlen, &typbyval);
+			filter->value = datumCopy(filter->value, typbyval, typlen);
+		}
+
+		state->filters = lappend(state->filters, filter);
+		i++;
+	}
+	ResetExprContext(econtext);
+
+	state->delta_slot = table_slot_create(node->ss.ss_currentRelation, NULL);
+}
+
+/*
+ * Return the next row of the scan, from the current batch or the delta
+ * store, in the scan slot.
+ */
+static TupleTableSlot *
+columnar_scan_next(ScanState *ss)
+{
+	ColumnarScanState *state = (ColumnarScanState *) ss;
+	TupleTableSlot *slot = ss->ss_ScanTupleSlot;
+	Relation	rel = ss->ss_currentRelation;
+	int			natts = slot->tts_tupleDescriptor->natts;
+
+	if (state->scan == NULL)
+		state->scan = columnar_beginscan_extended(rel,
+												  ss->ps.state->es_snapshot,
+												  state->attrs_needed,
+												  state->filters);
+
+	ExecClearTuple(slot);
+
+	for (;;)
+	{
+		ColumnarBatch *batch = state->batch;
+
+		if (batch != NULL && state->scan->batch_pos < batch->nselected)
+		{
+			int			row = batch->rows[state->scan->batch_pos++];
+
+			for (int i = 0; i < natts; i++)
+			{
+				if (batch->values[i] != NULL)
+				{
+					slot->tts_values[i] = batch->values[i][row];
+					slot->tts_isnull[i] = batch->isnull[i][row];
+				}
+				else
+				{
+					slot->tts_values[i] = (Datum) 0;
+					slot->tts_isnull[i] = true;
+				}
+			}
+			ExecStoreVirtualTuple(slot);
+			columnar_row_to_tid(batch->first_row + row, &slot->tts_tid);
+			slot->tts_tableOid = RelationGetRelid(rel);
+			return slot;
+		}
+
+		if (!columnar_scan_next_batch(state->scan, &state->batch))
+		{
+			state->batch = NULL;
+			break;
+		}
+	}
+
+	if (!columnar_scan_next_delta(state->scan, state->delta_slot))
+		return slot;
+
+	/* the values stay valid until the next delta row is fetched */
+	slot_getsomeattrs(state->delta_slot, state->maxattr);
+	for (int i = 0; i < natts; i++)
+	{
+		if (i < state->maxattr)
+		{
+			slot->tts_values[i] = state->delta_slot->tts_values[i];
+			slot->tts_isnull[i] = state->delta_slot->tts_isnull[i];
+		}
+		else
+		{
+			slot->tts_values[i] = (Datum) 0;
+			slot->tts_isnull[i] = true;
+		}
+	}
+	ExecStoreVirtualTuple(slot);
+	slot->tts_tid = state->delta_slot->tts_tid;
+	slot->tts_tableOid = RelationGetRelid(rel);
+
+	return slot;
+}
+
+/*
+ * Rows are returned as they are stored; no recheck is needed.
+ */
+static bool
+columnar_scan_recheck(ScanState *ss, TupleTableSlot *slot)
+{
+	return true;
+}
+
+static TupleTableSlot *
+columnar_exec_custom_scan(CustomScanState *node)
+{
+	return ExecScan(&node->ss,
+					(ExecScanAccessMtd) columnar_scan_next,
+					(ExecScanRecheckMtd) columnar_scan_recheck);
+}
+
+static void
+columnar_end_custom_scan(CustomScanState *node)
+{
+	ColumnarScanState *state = (ColumnarScanState *) node;
+
+	if (state->scan != NULL)
+	{
+		table_endscan((TableScanDesc) state->scan);
+		state->scan = NULL;
+	}
+	ExecDropSingleTupleTableSlot(state->delta_slot);
+}
+
+static void
+columnar_rescan_custom_scan(CustomScanState *node)
+{
+	ColumnarScanState *state = (ColumnarScanState *) node;
+
+	if (state->scan != NULL)
+	{
+		state->segments_skipped += state->scan->segments_skipped;
+		state->scan->segments_skipped = 0;
+		table_rescan((TableScanDesc) state->scan, NULL);
+	}
+	state->batch = NULL;
+
+	ExecScanReScan(&node->ss);
+}
+
+static void
+columnar_explain_custom_scan(CustomScanState *node, List *ancestors,
+							 ExplainState *es)
+{
+	ColumnarScanState *state = (ColumnarScanState *) node;
+	CustomScan *cscan = (CustomScan *) node->ss.ps.plan;
+	TupleDesc	tupdesc = RelationGetDescr(node->ss.ss_currentRelation);
+	List	   *attnums = linitial(cscan->custom_private);
+	List	   *filter_ints = lsecond(cscan->custom_private);
+	StringInfoData buf;
+
+	initStringInfo(&buf);
+	foreach_int(attnum, attnums)
+	{
+		if (buf.len > 0)
+			appendStringInfoString(&buf, ", ");
+		appendStringInfoString(&buf,
+							   quote_identifier(NameStr(TupleDescAttr(tupdesc, attnum - 1)->attname)));
+	}
+	ExplainPropertyText("Columnar Projected Columns",
+						buf.len > 0 ? buf.data : "<none>", es);
+
+	if (cscan->custom_exprs != NIL)
+	{
+		List	   *context;
+		bool		useprefix;
+		List	   *filters = NIL;
+		int			i = 0;
+
+		context = set_deparse_context_plan(es->deparse_cxt, &cscan->scan.plan,
+										   ancestors);
+		useprefix = list_length(es->rtable) > 1 || es->verbose;
+
+		/* show the filters in the form used for skipping: "column op value" */
+		foreach_ptr(Expr, expr, cscan->custom_exprs)
+		{
+			AttrNumber	attnum = list_nth_int(filter_ints, 2 * i);
+			int			strategy = list_nth_int(filter_ints, 2 * i + 1);
+			static const char *const opnames[] = {"", "<", "<=", "=", ">=", ">"};
+
+			resetStringInfo(&buf);
+			appendStringInfo(&buf, "%s %s %s",
+							 quote_identifier(NameStr(TupleDescAttr(tupdesc, attnum - 1)->attname)),
+							 opnames[strategy],
+							 deparse_expression((Node *) expr, context,
+												useprefix, false));
+			filters = lappend(filters, pstrdup(buf.data));
+			i++;
+		}
+		ExplainPropertyList("Columnar Segment Filters", filters, es);
+	}
+
+	if (es->analyze)
+	{
+		int64		skipped = state->segments_skipped;
+
+		if (state->scan != NULL)
+			skipped += state->scan->segments_skipped;
+		ExplainPropertyInteger("Columnar Segments Removed by Filter", NULL,
+							   skipped, es);
+	}
+}
@@ -0,0 +1,526 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar_merge.c
+ *	  Merging the delta store of columnar tables into column segments.
+ *
+ * A merge moves the rows of the delta store that are visible to it into new
+ * segments: each row is deleted from the delta store, as if it had been
+ * moved to another partition, and written to the segment being built.  The
+ * segments and the deletions become visible together when the merging
+ * transaction commits, so other transactions see every row exactly once.
+ * Rows that are locked or being modified by other transactions are left
+ * for the next merge.  A transaction that tries to update or delete a row
+ * after it has been merged gets a serialization failure, as it would if
+ * the row had been moved to another partition.
+ *
+ * Merges are run with the columnar.merge() function, or by a background
+ * worker when the module is loaded with shared_preload_libraries.  The
+ * worker also removes the segments of columnar tables that were dropped;
+ * without it, that is done by an event trigger on DROP, and for temporary
+ * tables, which are also dropped at the end of the session without firing
+ * event triggers, by an object access hook.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar_merge.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/heapam.h"
+#include "access/htup_details.h"
+#include "access/table.h"
+#include "access/xact.h"
+#include "catalog/namespace.h"
+#include "catalog/objectaccess.h"
+#include "catalog/pg_class.h"
+#include "columnar.h"
+#include "commands/defrem.h"
+#include "commands/event_trigger.h"
+#include "commands/extension.h"
+#include "executor/tuptable.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/interrupt.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/lmgr.h"
+#include "tcop/tcopprot.h"
+#include "utils/acl.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/snapmgr.h"
+#include "utils/syscache.h"
+#include "utils/wait_event.h"
+
+PG_FUNCTION_INFO_V1(columnar_merge);
+PG_FUNCTION_INFO_V1(columnar_cleanup);
+PG_FUNCTION_INFO_V1(columnar_drop_trigger);
+
+PGDLLEXPORT pg_noreturn void columnar_merge_worker_main(Datum main_arg);
+
+/* GUC parameters */
+static char *columnar_merge_database = NULL;
+static int	columnar_merge_interval = 60;
+static int	columnar_merge_min_rows = 10000;
+
+static uint32 columnar_merge_wait_event = 0;
+
+static object_access_hook_type prev_object_access_hook = NULL;
+
+static List *columnar_relations(void);
+static List *columnar_live_storages(Snapshot snapshot);
+static void columnar_object_access(ObjectAccessType access, Oid classId,
+								   Oid objectId, int subId, void *arg);
+
+
+/*
+ * Define the merge worker's parameters, and register the worker if we are
+ * being loaded with shared_preload_libraries.
+ */
+void
+columnar_merge_init(void)
+{
+	BackgroundWorker worker;
+
+	DefineCustomStringVariable("columnar.merge_database",
+							   "Sets the database in which columnar tables are merged in the background.",
+							   NULL,
+							   &columnar_merge_database,
+							   "postgres",
+							   PGC_POSTMASTER,
+							   0,
+							   NULL,
+							   NULL,
+							   NULL);
+
+	DefineCustomIntVariable("columnar.merge_interval",
+							"Sets the time between background merges of columnar tables.",
+							"Zero disables background merges.",
+							&columnar_merge_interval,
+							60,
+							0,
+							INT_MAX / 1000,
+							PGC_SIGHUP,
+							GUC_UNIT_S,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("columnar.merge_min_rows",
+							"Sets the number of rows in the delta store of a columnar table above which it is merged in the background.",
+							NULL,
+							&columnar_merge_min_rows,
+							10000,
+							1,
+							INT_MAX,
+							PGC_SIGHUP,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	prev_object_access_hook = object_access_hook;
+	object_access_hook = columnar_object_access;
+
+	if (!process_shared_preload_libraries_in_progress)
+		return;
+
+	memset(&worker, 0, sizeof(worker));
+	worker.bgw_flags = BGWORKER_SHMEM_ACCESS |
+		BGWORKER_BACKEND_DATABASE_CONNECTION;
+	worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
+	worker.bgw_restart_time = 60;
+	strcpy(worker.bgw_library_name, "columnar");
+	strcpy(worker.bgw_function_name, "columnar_merge_worker_main");
+	strcpy(worker.bgw_name, "columnar merge worker");
+	strcpy(worker.bgw_type, "columnar merge worker");
+	RegisterBackgroundWorker(&worker);
+}
+
+/*
+ * Merge the rows of a columnar table's delta store visible to the active
+ * snapshot into new segments, provided there are at least min_rows of them.
+ * The caller must hold ShareUpdateExclusiveLock on the table, which also
+ * keeps other merges out.
+ *
+ * Returns the number of rows merged.
+ */
+int64
+columnar_merge_relation(Relation rel, int64 min_rows)
+{
+	Snapshot	snapshot = GetActiveSnapshot();
+	CommandId	cid = GetCurrentCommandId(true);
+	TableScanDesc scan;
+	TupleTableSlot *slot;
+	ColumnarWriteState *writer;
+	int64		nrows = 0;
+
+	Assert(columnar_relation_is_columnar(rel));
+
+	slot = MakeSingleTupleTableSlot(RelationGetDescr(rel),
+									&TTSOpsBufferHeapTuple);
+
+	if (min_rows > 0)
+	{
+		scan = heap_beginscan(rel, snapshot, 0, NULL, NULL,
+							  SO_TYPE_SEQSCAN | SO_ALLOW_PAGEMODE);
+		while (nrows < min_rows &&
+			   heap_getnextslot(scan, ForwardScanDirection, slot))
+			nrows++;
+		heap_endscan(scan);
+
+		if (nrows < min_rows)
+		{
+			ExecDropSingleTupleTableSlot(slot);
+			return 0;
+		}
+		nrows = 0;
+	}
+
+	scan = heap_beginscan(rel, snapshot, 0, NULL, NULL,
+						  SO_TYPE_SEQSCAN | SO_ALLOW_PAGEMODE);
+	writer = columnar_begin_write(rel, columnar_storage_id(rel));
+
+	while (heap_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		TM_FailureData tmfd;
+		TM_Result	result;
+
+		CHECK_FOR_INTERRUPTS();
+
+		/* leave rows that others are working on for the next merge */
+		result = heap_delete(rel, &slot->tts_tid, cid, InvalidSnapshot,
+							 false, &tmfd, true);
+		if (result != TM_Ok)
+			continue;
+
+		columnar_write_row(writer, slot);
+		nrows++;
+	}
+
+	columnar_end_write(writer);
+	heap_endscan(scan);
+	ExecDropSingleTupleTableSlot(slot);
+
+	return nrows;
+}
+
+/*
+ * Remove the segments of columnar tables that no longer exist.
+ *
+ * The segments of a table are removed when it's truncated or rewritten, but
+ * there is no table access method callback for dropping a table.  Returns
+ * the number of storages removed.
+ *
+ * The tables and the segments are read with the same snapshot.  A table's
+ * storage and its segments come and go in the same transactions, so a
+ * storage that the snapshot sees without its table is one that was really
+ * dropped, while the storages of tables created or rewritten since are
+ * invisible to it and left alone.
+ */
+static int64
+columnar_cleanup_orphans_internal(void)
+{
+	List	   *live;
+	List	   *storages;
+	Snapshot	snapshot;
+	int64		nremoved = 0;
+
+	/* one cleanup at a time */
+	LockRelationOid(get_relname_relid("segment",
+									  get_namespace_oid("columnar", false)),
+					ShareUpdateExclusiveLock);
+
+	snapshot = RegisterSnapshot(GetLatestSnapshot());
+	live = columnar_live_storages(snapshot);
+	storages = columnar_storage_ids(snapshot);
+
+	foreach_ptr(RelFileLocator, storage, storages)
+	{
+		bool		found = false;
+
+		foreach_ptr(RelFileLocator, other, live)
+		{
+			if (RelFileLocatorEquals(*other, *storage))
+			{
+				found = true;
+				break;
+			}
+		}
+		if (found)
+			continue;
+
+		columnar_storage_delete(*storage, snapshot);
+		nremoved++;
+	}
+
+	UnregisterSnapshot(snapshot);
+
+	return nremoved;
+}
+
+void
+columnar_cleanup_orphans(void)
+{
+	(void) columnar_cleanup_orphans_internal();
+}
+
+/*
+ * Return the OIDs of all columnar tables of the current database.
+ */
+static List *
+columnar_relations(void)
+{
+	Oid			amoid = get_table_am_oid("columnar", false);
+	Relation	classrel;
+	TableScanDesc scan;
+	HeapTuple	tuple;
+	List	   *result = NIL;
+
+	classrel = table_open(RelationRelationId, AccessShareLock);
+	scan = table_beginscan_catalog(classrel, 0, NULL);
+	while ((tuple = heap_getnext(scan, ForwardScanDirection)) != NULL)
+	{
+		Form_pg_class classForm = (Form_pg_class) GETSTRUCT(tuple);
+
+		if (classForm->relam == amoid &&
+			(classForm->relkind == RELKIND_RELATION ||
+			 classForm->relkind == RELKIND_MATVIEW))
+			result = lappend_oid(result, classForm->oid);
+	}
+	table_endscan(scan);
+	table_close(classrel, AccessShareLock);
+
+	return result;
+}
+
+/*
+ * Return the storage ids of the columnar tables of the current database
+ * visible to snapshot, as a list of palloc'd RelFileLocators.
+ */
+static List *
+columnar_live_storages(Snapshot snapshot)
+{
+	Oid			amoid = get_table_am_oid("columnar", false);
+	Relation	classrel;
+	TableScanDesc scan;
+	HeapTuple	tuple;
+	List	   *result = NIL;
+
+	classrel = table_open(RelationRelationId, AccessShareLock);
+	scan = table_beginscan(classrel, snapshot, 0, NULL);
+	while ((tuple = heap_getnext(scan, ForwardScanDirection)) != NULL)
+	{
+		Form_pg_class classForm = (Form_pg_class) GETSTRUCT(tuple);
+		RelFileLocator *storage;
+
+		if (classForm->relam != amoid ||
+			(classForm->relkind != RELKIND_RELATION &&
+			 classForm->relkind != RELKIND_MATVIEW))
+			continue;
+
+		/* as RelationInitPhysicalAddr() does it */
+		storage = palloc(sizeof(RelFileLocator));
+		storage->spcOid = OidIsValid(classForm->reltablespace) ?
+			classForm->reltablespace : MyDatabaseTableSpace;
+		storage->dbOid = MyDatabaseId;
+		storage->relNumber = classForm->relfilenode;
+		result = lappend(result, storage);
+	}
+	table_endscan(scan);
+	table_close(classrel, AccessShareLock);
+
+	return result;
+}
+
+/*
+ * Object access hook: remove the segments of temporary columnar tables as
+ * they are dropped.  Those left at the end of a session are dropped without
+ * firing the event trigger, and their segments would otherwise stay until
+ * the next cleanup, or be taken for those of a later table that happens to
+ * get the same relfilenumber.
+ */
+static void
+columnar_object_access(ObjectAccessType access, Oid classId, Oid objectId,
+					   int subId, void *arg)
+{
+	Oid			nspid;
+	Relation	rel;
+
+	if (prev_object_access_hook)
+		prev_object_access_hook(access, classId, objectId, subId, arg);
+
+	if (access != OAT_DROP || classId != RelationRelationId || subId != 0)
+		return;
+	if (get_rel_persistence(objectId) != RELPERSISTENCE_TEMP)
+		return;
+
+	/* nothing to do if the extension is gone, or going */
+	nspid = get_namespace_oid("columnar", true);
+	if (!OidIsValid(nspid) ||
+		!OidIsValid(get_relname_relid("segment", nspid)) ||
+		!OidIsValid(get_relname_relid("chunk", nspid)) ||
+		!OidIsValid(get_relname_relid("deleted_row", nspid)))
+		return;
+
+	/* the relation is locked by the caller */
+	rel = relation_open(objectId, NoLock);
+	if (columnar_relation_is_columnar(rel))
+		columnar_storage_delete(columnar_storage_id(rel), NULL);
+	relation_close(rel, NoLock);
+}
+
+/*
+ * columnar.merge(regclass, min_rows int8) returns int8
+ */
+Datum
+columnar_merge(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	int64		min_rows = PG_GETARG_INT64(1);
+	Relation	rel;
+	int64		nrows;
+
+	rel = table_open(relid, ShareUpdateExclusiveLock);
+
+	if (!columnar_relation_is_columnar(rel))
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("\"%s\" is not a columnar table",
+						RelationGetRelationName(rel))));
+
+	if (!object_ownercheck(RelationRelationId, relid, GetUserId()))
+		aclcheck_error(ACLCHECK_NOT_OWNER,
+					   get_relkind_objtype(rel->rd_rel->relkind),
+					   RelationGetRelationName(rel));
+
+	nrows = columnar_merge_relation(rel, min_rows);
+
+	table_close(rel, NoLock);
+
+	PG_RETURN_INT64(nrows);
+}
+
+/*
+ * columnar.cleanup() returns int8
+ */
+Datum
+columnar_cleanup(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_INT64(columnar_cleanup_orphans_internal());
+}
+
+/*
+ * Event trigger on sql_drop, removing the segments of dropped tables.
+ */
+Datum
+columnar_drop_trigger(PG_FUNCTION_ARGS)
+{
+	if (!CALLED_AS_EVENT_TRIGGER(fcinfo))
+		elog(ERROR, "not fired by event trigger manager");
+
+	columnar_cleanup_orphans();
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * Main entry point of the background merge worker.
+ */
+void
+columnar_merge_worker_main(Datum main_arg)
+{
+	pqsignal(SIGHUP, SignalHandlerForConfigReload);
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	BackgroundWorkerInitializeConnection(columnar_merge_database, NULL, 0);
+
+	columnar_merge_wait_event = WaitEventExtensionNew("ColumnarMergeMain");
+
+	for (;;)
+	{
+		List	   *relations = NIL;
+		bool		installed;
+
+		(void) WaitLatch(MyLatch,
+						 WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+						 columnar_merge_interval > 0 ?
+						 columnar_merge_interval * 1000L : 60 * 1000L,
+						 columnar_merge_wait_event);
+		ResetLatch(MyLatch);
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (ConfigReloadPending)
+		{
+			ConfigReloadPending = false;
+			ProcessConfigFile(PGC_SIGHUP);
+		}
+
+		if (columnar_merge_interval == 0)
+			continue;
+
+		SetCurrentStatementStartTimestamp();
+		StartTransactionCommand();
+		PushActiveSnapshot(GetTransactionSnapshot());
+		pgstat_report_activity(STATE_RUNNING, "columnar merge");
+
+		installed = OidIsValid(get_extension_oid("columnar", true));
+		if (installed)
+		{
+			MemoryContext oldcxt = MemoryContextSwitchTo(TopMemoryContext);
+
+			relations = list_copy(columnar_relations());
+			MemoryContextSwitchTo(oldcxt);
+			columnar_cleanup_orphans();
+		}
+
+		PopActiveSnapshot();
+		CommitTransactionCommand();
+
+		/* each table is merged in a transaction of its own */
+		foreach_oid(relid, relations)
+		{
+			Relation	rel;
+
+			CHECK_FOR_INTERRUPTS();
+
+			SetCurrentStatementStartTimestamp();
+			StartTransactionCommand();
+
+			/* don't queue up behind a merge or DDL running elsewhere */
+			if (ConditionalLockRelationOid(relid, ShareUpdateExclusiveLock))
+			{
+				rel = try_table_open(relid, NoLock);
+				if (rel != NULL && columnar_relation_is_columnar(rel))
+				{
+					int64		nrows;
+
+					PushActiveSnapshot(GetTransactionSnapshot());
+					nrows = columnar_merge_relation(rel, columnar_merge_min_rows);
+					PopActiveSnapshot();
+
+					if (nrows > 0)
+						elog(DEBUG1, "merged %" PRId64 " rows of \"%s\"",
+							 nrows, RelationGetRelationName(rel));
+				}
+				if (rel != NULL)
+					table_close(rel, NoLock);
+			}
+
+			CommitTransactionCommand();
+		}
+
+		list_free(relations);
+		pgstat_report_stat(true);
+		pgstat_report_activity(STATE_IDLE, NULL);
+	}
+}
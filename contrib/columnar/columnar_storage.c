@@ -0,0 +1,1404 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar_storage.c
+ *	  Column segments of columnar tables.
+ *
+ * Rows merged out of a columnar table's delta store are kept in segments of
+ * up to columnar.segment_row_count rows.  Each column of a segment is
+ * stored as one compressed chunk, together with the smallest and largest
+ * value in it, so that a scan reads and decodes only the columns it needs
+ * and can skip segments whose value ranges can't satisfy its quals.
+ *
+ * The segments live in ordinary tables of the extension's schema, keyed by
+ * the locator of the relation's storage (its "storage id": tablespace,
+ * database and relfilenumber), so they follow the table's storage through
+ * TRUNCATE and friends, and are covered by MVCC and WAL like any other
+ * table:
+ *
+ *	columnar.segment		one row per segment
+ *	columnar.chunk			one row per column of each segment
+ *	columnar.deleted_row	rows of segments deleted or updated since
+ *
+ * Segments are immutable.  Deleting a row that lives in a segment inserts
+ * its row number into columnar.deleted_row; updating it does the same and
+ * inserts the new version into the delta store, remembering its TID so
+ * that a concurrent updater can follow the update as it would in a heap.
+ * Concurrent modifications of the same segment row are serialized with a
+ * heavyweight tuple lock, held until the end of the transaction.
+ *
+ * A chunk is a bytea with a ColumnarChunkHeader, followed by the null
+ * bitmap, if any, and the values laid out the way heap_fill_tuple lays out
+ * the attributes of a tuple, all compressed together.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar_storage.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+
+#include "access/genam.h"
+#include "access/heapam.h"
+#include "access/htup_details.h"
+#include "access/table.h"
+#include "access/xact.h"
+#include "catalog/indexing.h"
+#include "catalog/namespace.h"
+#include "columnar.h"
+#include "common/pg_lzcompress.h"
+#include "miscadmin.h"
+#include "storage/lmgr.h"
+#include "storage/proc.h"
+#include "utils/builtins.h"
+#include "utils/datum.h"
+#include "utils/fmgroids.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/snapmgr.h"
+#include "utils/typcache.h"
+
+/* Columns leading every metadata table and its primary key */
+#define Anum_storage_spcoid			1
+#define Anum_storage_dboid			2
+#define Anum_storage_relnumber		3
+#define COLUMNAR_STORAGE_NKEYS		3
+
+/* Columns of columnar.segment */
+#define Anum_segment_segment_id		4
+#define Anum_segment_first_row		5
+#define Anum_segment_row_count		6
+#define Anum_segment_data_size		7
+#define Natts_segment				7
+
+/* Columns of columnar.chunk */
+#define Anum_chunk_segment_id		4
+#define Anum_chunk_attnum			5
+#define Anum_chunk_null_count		6
+#define Anum_chunk_min_value		7
+#define Anum_chunk_max_value		8
+#define Anum_chunk_data				9
+#define Natts_chunk					9
+
+/* Columns of columnar.deleted_row */
+#define Anum_deleted_row_row_number	4
+#define Anum_deleted_row_updated_to	5
+#define Natts_deleted_row			5
+
+/* Buffered data at which a segment is written out early */
+#define COLUMNAR_MAX_SEGMENT_BYTES	((Size) 256 * 1024 * 1024)
+
+typedef struct ColumnarChunkHeader
+{
+	int32		vl_len_;		/* varlena header (do not touch directly!) */
+	int32		nrows;
+	int32		rawsize;		/* size of the data before compression */
+	uint8		compression;	/* ColumnarCompression */
+	bool		hasnulls;
+} ColumnarChunkHeader;
+
+#define COLUMNAR_CHUNK_HDRSZ	MAXALIGN(sizeof(ColumnarChunkHeader))
+
+/* Values of one column waiting to be written */
+typedef struct ColumnarColumnBuffer
+{
+	Datum	   *values;
+	bool	   *isnull;
+	Size		datasize;		/* of the non-null values, aligned */
+} ColumnarColumnBuffer;
+
+struct ColumnarWriteState
+{
+	Relation	rel;
+	RelFileLocator storage;
+	MemoryContext cxt;			/* for the buffered values */
+	ColumnarColumnBuffer *columns;	/* one per attribute */
+	int			max_rows;		/* columnar.segment_row_count at start */
+	int			nrows;
+	Size		nbytes;
+	int64		next_segment_id;
+	int64		next_row;
+	int64		rows_written;
+};
+
+/* The last segment decoded for single-row fetches, with all its columns */
+typedef struct ColumnarFetchCache
+{
+	LocalTransactionId lxid;	/* valid within this transaction only */
+	MemoryContext cxt;
+	RelFileLocator storage;
+	int64		segment_id;
+	ColumnarBatch batch;
+} ColumnarFetchCache;
+
+static ColumnarFetchCache fetch_cache;
+
+static Oid	columnar_metadata_relid(const char *relname);
+static void columnar_storage_scankeys(ScanKey key, RelFileLocator storage);
+static void columnar_storage_values(Datum *values, bool *isnull,
+									RelFileLocator storage);
+static bytea *columnar_encode_chunk(Form_pg_attribute attr,
+									ColumnarColumnBuffer *column, int nrows);
+static void columnar_decode_chunk(Form_pg_attribute attr, bytea *chunk,
+								  int nrows, Datum *values, bool *isnull);
+static bytea *columnar_datum_to_bytea(Form_pg_attribute attr, Datum value);
+static Datum columnar_bytea_to_datum(Form_pg_attribute attr, bytea *bytes);
+static void columnar_flush_segment(ColumnarWriteState *state);
+static void columnar_delete_rows(const char *relname, const char *indexname,
+								 RelFileLocator storage, Snapshot snapshot);
+static void columnar_copy_rows(const char *relname, const char *indexname,
+							   RelFileLocator old_storage,
+							   RelFileLocator new_storage);
+
+
+/*
+ * Look up one of the extension's metadata tables or their indexes.
+ */
+static Oid
+columnar_metadata_relid(const char *relname)
+{
+	Oid			nspid = get_namespace_oid("columnar", false);
+	Oid			relid = get_relname_relid(relname, nspid);
+
+	if (!OidIsValid(relid))
+		elog(ERROR, "cache lookup failed for relation columnar.%s", relname);
+
+	return relid;
+}
+
+/*
+ * Set up scan keys matching the key columns of a storage.
+ */
+static void
+columnar_storage_scankeys(ScanKey key, RelFileLocator storage)
+{
+	ScanKeyInit(&key[0], Anum_storage_spcoid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(storage.spcOid));
+	ScanKeyInit(&key[1], Anum_storage_dboid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(storage.dbOid));
+	ScanKeyInit(&key[2], Anum_storage_relnumber,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(storage.relNumber));
+}
+
+/*
+ * Fill in the key columns of a new metadata row.
+ */
+static void
+columnar_storage_values(Datum *values, bool *isnull, RelFileLocator storage)
+{
+	values[Anum_storage_spcoid - 1] = ObjectIdGetDatum(storage.spcOid);
+	isnull[Anum_storage_spcoid - 1] = false;
+	values[Anum_storage_dboid - 1] = ObjectIdGetDatum(storage.dbOid);
+	isnull[Anum_storage_dboid - 1] = false;
+	values[Anum_storage_relnumber - 1] = ObjectIdGetDatum(storage.relNumber);
+	isnull[Anum_storage_relnumber - 1] = false;
+}
+
+/*
+ * The key of a relation's segments: the locator of its current storage.
+ * Relfilenumbers are only unique within a tablespace.
+ */
+RelFileLocator
+columnar_storage_id(Relation rel)
+{
+	return rel->rd_locator;
+}
+
+/*
+ * Return the segments of a storage visible to snapshot, in row order.
+ */
+List *
+columnar_read_segments(RelFileLocator storage, Snapshot snapshot)
+{
+	Relation	segrel;
+	SysScanDesc scan;
+	ScanKeyData key[COLUMNAR_STORAGE_NKEYS];
+	HeapTuple	tuple;
+	List	   *segments = NIL;
+
+	segrel = table_open(columnar_metadata_relid("segment"), AccessShareLock);
+
+	columnar_storage_scankeys(key, storage);
+	scan = systable_beginscan(segrel, columnar_metadata_relid("segment_pkey"),
+							  true, snapshot, COLUMNAR_STORAGE_NKEYS, key);
+
+	while (HeapTupleIsValid(tuple = systable_getnext(scan)))
+	{
+		ColumnarSegment *segment = palloc(sizeof(ColumnarSegment));
+		Datum		values[Natts_segment];
+		bool		isnull[Natts_segment];
+
+		heap_deform_tuple(tuple, RelationGetDescr(segrel), values, isnull);
+		segment->segment_id = DatumGetInt64(values[Anum_segment_segment_id - 1]);
+		segment->first_row = DatumGetInt64(values[Anum_segment_first_row - 1]);
+		segment->row_count = DatumGetInt32(values[Anum_segment_row_count - 1]);
+		segments = lappend(segments, segment);
+	}
+
+	systable_endscan(scan);
+	table_close(segrel, AccessShareLock);
+
+	return segments;
+}
+
+/*
+ * Return the numbers of the segment rows of a storage whose deletion is
+ * visible to snapshot, in ascending order.
+ */
+int64 *
+columnar_read_deleted_rows(RelFileLocator storage, Snapshot snapshot,
+						   int *ndeleted)
+{
+	Relation	delrel;
+	SysScanDesc scan;
+	ScanKeyData key[COLUMNAR_STORAGE_NKEYS];
+	HeapTuple	tuple;
+	int64	   *rows;
+	int			nrows = 0;
+	int			maxrows = 64;
+
+	delrel = table_open(columnar_metadata_relid("deleted_row"), AccessShareLock);
+
+	columnar_storage_scankeys(key, storage);
+	scan = systable_beginscan(delrel,
+							  columnar_metadata_relid("deleted_row_pkey"),
+							  true, snapshot, COLUMNAR_STORAGE_NKEYS, key);
+
+	rows = palloc(sizeof(int64) * maxrows);
+	while (HeapTupleIsValid(tuple = systable_getnext(scan)))
+	{
+		bool		isnull;
+		Datum		rownum;
+
+		rownum = heap_getattr(tuple, Anum_deleted_row_row_number,
+							  RelationGetDescr(delrel), &isnull);
+		if (nrows == maxrows)
+		{
+			maxrows *= 2;
+			rows = repalloc_huge(rows, sizeof(int64) * maxrows);
+		}
+		rows[nrows++] = DatumGetInt64(rownum);
+	}
+
+	systable_endscan(scan);
+	table_close(delrel, AccessShareLock);
+
+	*ndeleted = nrows;
+	return rows;
+}
+
+/*
+ * Fetch the chunk row of one column of a segment, or NULL if there is none,
+ * because the column was added after the segment was written.
+ */
+static HeapTuple
+columnar_fetch_chunk(Relation chunkrel, RelFileLocator storage,
+					 int64 segment_id, AttrNumber attnum, Snapshot snapshot)
+{
+	SysScanDesc scan;
+	ScanKeyData key[COLUMNAR_STORAGE_NKEYS + 2];
+	HeapTuple	tuple;
+
+	columnar_storage_scankeys(key, storage);
+	ScanKeyInit(&key[COLUMNAR_STORAGE_NKEYS], Anum_chunk_segment_id,
+				BTEqualStrategyNumber, F_INT8EQ, Int64GetDatum(segment_id));
+	ScanKeyInit(&key[COLUMNAR_STORAGE_NKEYS + 1], Anum_chunk_attnum,
+				BTEqualStrategyNumber, F_INT2EQ, Int16GetDatum(attnum));
+	scan = systable_beginscan(chunkrel, columnar_metadata_relid("chunk_pkey"),
+							  true, snapshot, COLUMNAR_STORAGE_NKEYS + 2, key);
+
+	tuple = systable_getnext(scan);
+	if (HeapTupleIsValid(tuple))
+		tuple = heap_copytuple(tuple);
+
+	systable_endscan(scan);
+
+	return tuple;
+}
+
+/*
+ * Could any row of the segment satisfy all the filters?  Answers true when
+ * in doubt.
+ */
+bool
+columnar_segment_passes_filters(Relation rel, RelFileLocator storage,
+								ColumnarSegment *segment, List *filters,
+								Snapshot snapshot)
+{
+	Relation	chunkrel;
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+	bool		result = true;
+
+	if (filters == NIL)
+		return true;
+
+	chunkrel = table_open(columnar_metadata_relid("chunk"), AccessShareLock);
+
+	foreach_ptr(ColumnarFilter, filter, filters)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, filter->attnum - 1);
+		HeapTuple	tuple;
+		Datum		values[Natts_chunk];
+		bool		isnull[Natts_chunk];
+		Datum		minval;
+		Datum		maxval;
+		int32		cmp;
+
+		/* comparisons with NULL never succeed, but leave that to the quals */
+		if (filter->isnull)
+			continue;
+
+		tuple = columnar_fetch_chunk(chunkrel, storage, segment->segment_id,
+									 filter->attnum, snapshot);
+		if (!HeapTupleIsValid(tuple))
+			continue;
+
+		heap_deform_tuple(tuple, RelationGetDescr(chunkrel), values, isnull);
+
+		/* all nulls: no comparison can succeed */
+		if (DatumGetInt32(values[Anum_chunk_null_count - 1]) == segment->row_count)
+		{
+			result = false;
+			break;
+		}
+
+		/* no range was recorded, because the type has no btree opclass */
+		if (isnull[Anum_chunk_min_value - 1] || isnull[Anum_chunk_max_value - 1])
+			continue;
+
+		minval = columnar_bytea_to_datum(attr,
+										 DatumGetByteaPP(values[Anum_chunk_min_value - 1]));
+		maxval = columnar_bytea_to_datum(attr,
+										 DatumGetByteaPP(values[Anum_chunk_max_value - 1]));
+
+		switch (filter->strategy)
+		{
+			case BTLessStrategyNumber:
+				cmp = DatumGetInt32(FunctionCall2Coll(&filter->cmpfinfo,
+													  filter->collation,
+													  minval, filter->value));
+				result = (cmp < 0);
+				break;
+			case BTLessEqualStrategyNumber:
+				cmp = DatumGetInt32(FunctionCall2Coll(&filter->cmpfinfo,
+													  filter->collation,
+													  minval, filter->value));
+				result = (cmp <= 0);
+				break;
+			case BTEqualStrategyNumber:
+				cmp = DatumGetInt32(FunctionCall2Coll(&filter->cmpfinfo,
+													  filter->collation,
+													  minval, filter->value));
+				result = (cmp <= 0);
+				if (result)
+				{
+					cmp = DatumGetInt32(FunctionCall2Coll(&filter->cmpfinfo,
+														  filter->collation,
+														  maxval, filter->value));
+					result = (cmp >= 0);
+				}
+				break;
+			case BTGreaterEqualStrategyNumber:
+				cmp = DatumGetInt32(FunctionCall2Coll(&filter->cmpfinfo,
+													  filter->collation,
+													  maxval, filter->value));
+				result = (cmp >= 0);
+				break;
+			case BTGreaterStrategyNumber:
+				cmp = DatumGetInt32(FunctionCall2Coll(&filter->cmpfinfo,
+													  filter->collation,
+													  maxval, filter->value));
+				result = (cmp > 0);
+				break;
+			default:
+				elog(ERROR, "unrecognized btree strategy number: %d",
+					 filter->strategy);
+		}
+
+		heap_freetuple(tuple);
+		if (!result)
+			break;
+	}
+
+	table_close(chunkrel, AccessShareLock);
+
+	return result;
+}
+
+/*
+ * Decode the columns attrs_needed (all, if NULL) of a segment into batch.
+ * The selection vector is left to the caller.  Everything is allocated in
+ * the current memory context.
+ */
+void
+columnar_read_batch(Relation rel, RelFileLocator storage,
+					ColumnarSegment *segment, Bitmapset *attrs_needed,
+					Snapshot snapshot, ColumnarBatch *batch)
+{
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+	Relation	chunkrel;
+	int			nrows = segment->row_count;
+
+	batch->first_row = segment->first_row;
+	batch->nrows = nrows;
+	batch->values = palloc0(sizeof(Datum *) * tupdesc->natts);
+	batch->isnull = palloc0(sizeof(bool *) * tupdesc->natts);
+
+	chunkrel = table_open(columnar_metadata_relid("chunk"), AccessShareLock);
+
+	for (int i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+		AttrNumber	attnum = i + 1;
+		HeapTuple	tuple;
+		Datum	   *values;
+		bool	   *isnull;
+		Datum		data;
+		bool		data_isnull;
+
+		if (attrs_needed != NULL && !bms_is_member(attnum, attrs_needed))
+			continue;
+
+		values = palloc(sizeof(Datum) * nrows);
+		isnull = palloc(sizeof(bool) * nrows);
+		batch->values[i] = values;
+		batch->isnull[i] = isnull;
+
+		if (attr->attisdropped)
+		{
+			memset(isnull, true, sizeof(bool) * nrows);
+			continue;
+		}
+
+		tuple = columnar_fetch_chunk(chunkrel, storage, segment->segment_id,
+									 attnum, snapshot);
+		if (!HeapTupleIsValid(tuple))
+		{
+			/* added after the segment was written: use the default */
+			bool		missing_isnull;
+			Datum		missing = getmissingattr(tupdesc, attnum,
+												 &missing_isnull);
+
+			for (int j = 0; j < nrows; j++)
+			{
+				values[j] = missing;
+				isnull[j] = missing_isnull;
+			}
+			continue;
+		}
+
+		data = heap_getattr(tuple, Anum_chunk_data,
+							RelationGetDescr(chunkrel), &data_isnull);
+		Assert(!data_isnull);
+		columnar_decode_chunk(attr, DatumGetByteaP(data), nrows,
+							  values, isnull);
+		heap_freetuple(tuple);
+	}
+
+	table_close(chunkrel, AccessShareLock);
+}
+
+/*
+ * Find the segment, visible to snapshot, that holds row number rownum.
+ */
+ColumnarSegment *
+columnar_find_segment(RelFileLocator storage, int64 rownum, Snapshot snapshot)
+{
+	List	   *segments = columnar_read_segments(storage, snapshot);
+
+	foreach_ptr(ColumnarSegment, segment, segments)
+	{
+		if (rownum >= segment->first_row &&
+			rownum < segment->first_row + segment->row_count)
+			return segment;
+	}
+
+	return NULL;
+}
+
+/*
+ * Is the deletion of a segment row visible to snapshot?
+ */
+static bool
+columnar_row_is_deleted(RelFileLocator storage, int64 rownum, Snapshot snapshot)
+{
+	Relation	delrel;
+	SysScanDesc scan;
+	ScanKeyData key[COLUMNAR_STORAGE_NKEYS + 1];
+	bool		found;
+
+	delrel = table_open(columnar_metadata_relid("deleted_row"), AccessShareLock);
+
+	columnar_storage_scankeys(key, storage);
+	ScanKeyInit(&key[COLUMNAR_STORAGE_NKEYS], Anum_deleted_row_row_number,
+				BTEqualStrategyNumber, F_INT8EQ, Int64GetDatum(rownum));
+	scan = systable_beginscan(delrel,
+							  columnar_metadata_relid("deleted_row_pkey"),
+							  true, snapshot, COLUMNAR_STORAGE_NKEYS + 1, key);
+	found = HeapTupleIsValid(systable_getnext(scan));
+	systable_endscan(scan);
+	table_close(delrel, AccessShareLock);
+
+	return found;
+}
+
+/*
+ * If the deletion of a segment row visible to snapshot was an update, set
+ * *tid to the new version's TID in the delta store and return true.
+ */
+bool
+columnar_row_updated_to(Relation rel, int64 rownum, Snapshot snapshot,
+						ItemPointer tid)
+{
+	Relation	delrel;
+	SysScanDesc scan;
+	ScanKeyData key[COLUMNAR_STORAGE_NKEYS + 1];
+	HeapTuple	tuple;
+	bool		result = false;
+
+	delrel = table_open(columnar_metadata_relid("deleted_row"), AccessShareLock);
+
+	columnar_storage_scankeys(key, columnar_storage_id(rel));
+	ScanKeyInit(&key[COLUMNAR_STORAGE_NKEYS], Anum_deleted_row_row_number,
+				BTEqualStrategyNumber, F_INT8EQ, Int64GetDatum(rownum));
+	scan = systable_beginscan(delrel,
+							  columnar_metadata_relid("deleted_row_pkey"),
+							  true, snapshot, COLUMNAR_STORAGE_NKEYS + 1, key);
+
+	tuple = systable_getnext(scan);
+	if (HeapTupleIsValid(tuple))
+	{
+		bool		isnull;
+		Datum		updated_to;
+
+		updated_to = heap_getattr(tuple, Anum_deleted_row_updated_to,
+								  RelationGetDescr(delrel), &isnull);
+		if (!isnull)
+		{
+			ItemPointerCopy(DatumGetItemPointer(updated_to), tid);
+			result = true;
+		}
+	}
+
+	systable_endscan(scan);
+	table_close(delrel, AccessShareLock);
+
+	return result;
+}
+
+/*
+ * Fetch a segment row into slot, if it's visible to snapshot.
+ *
+ * Decoding a segment for a single row is expensive, so the last segment
+ * decoded is kept until the end of the transaction; segments never change.
+ */
+bool
+columnar_fetch_row(Relation rel, int64 rownum, Snapshot snapshot,
+				   TupleTableSlot *slot)
+{
+	RelFileLocator storage = columnar_storage_id(rel);
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+	ColumnarSegment *segment;
+	Datum	   *values;
+	bool	   *isnull;
+	HeapTuple	tuple;
+	int			row;
+
+	segment = columnar_find_segment(storage, rownum, snapshot);
+	if (segment == NULL)
+		return false;
+
+	/* SnapshotAny returns the row whether or not it was deleted */
+	if (snapshot->snapshot_type != SNAPSHOT_ANY &&
+		columnar_row_is_deleted(storage, rownum, snapshot))
+		return false;
+
+	if (fetch_cache.lxid != MyProc->vxid.lxid || fetch_cache.cxt == NULL)
+	{
+		fetch_cache.lxid = MyProc->vxid.lxid;
+		fetch_cache.cxt = AllocSetContextCreate(TopTransactionContext,
+												"columnar fetch cache",
+												ALLOCSET_DEFAULT_SIZES);
+		fetch_cache.segment_id = -1;
+	}
+
+	if (!RelFileLocatorEquals(fetch_cache.storage, storage) ||
+		fetch_cache.segment_id != segment->segment_id)
+	{
+		MemoryContext oldcxt;
+
+		MemoryContextReset(fetch_cache.cxt);
+		fetch_cache.segment_id = -1;
+		oldcxt = MemoryContextSwitchTo(fetch_cache.cxt);
+		columnar_read_batch(rel, storage, segment, NULL, snapshot,
+							&fetch_cache.batch);
+		MemoryContextSwitchTo(oldcxt);
+		fetch_cache.storage = storage;
+		fetch_cache.segment_id = segment->segment_id;
+	}
+
+	row = (int) (rownum - segment->first_row);
+	values = palloc(sizeof(Datum) * tupdesc->natts);
+	isnull = palloc(sizeof(bool) * tupdesc->natts);
+	for (int i = 0; i < tupdesc->natts; i++)
+	{
+		values[i] = fetch_cache.batch.values[i][row];
+		isnull[i] = fetch_cache.batch.isnull[i][row];
+	}
+
+	tuple = heap_form_tuple(tupdesc, values, isnull);
+	columnar_row_to_tid(rownum, &tuple->t_self);
+	tuple->t_tableOid = RelationGetRelid(rel);
+	ExecStoreHeapTuple(tuple, slot, true);
+
+	pfree(values);
+	pfree(isnull);
+
+	return true;
+}
+
+/*
+ * Is a segment row visible to snapshot?
+ */
+bool
+columnar_row_visible(Relation rel, int64 rownum, Snapshot snapshot)
+{
+	RelFileLocator storage = columnar_storage_id(rel);
+
+	return columnar_find_segment(storage, rownum, snapshot) != NULL &&
+		!columnar_row_is_deleted(storage, rownum, snapshot);
+}
+
+/*
+ * Estimate the number of live rows in the segments of a storage, and their
+ * size on disk.
+ */
+void
+columnar_storage_estimate(RelFileLocator storage, Snapshot snapshot,
+						  double *rows, double *bytes)
+{
+	Relation	segrel;
+	SysScanDesc scan;
+	ScanKeyData key[COLUMNAR_STORAGE_NKEYS];
+	HeapTuple	tuple;
+	int			ndeleted;
+
+	*rows = 0;
+	*bytes = 0;
+
+	segrel = table_open(columnar_metadata_relid("segment"), AccessShareLock);
+
+	columnar_storage_scankeys(key, storage);
+	scan = systable_beginscan(segrel, columnar_metadata_relid("segment_pkey"),
+							  true, snapshot, COLUMNAR_STORAGE_NKEYS, key);
+
+	while (HeapTupleIsValid(tuple = systable_getnext(scan)))
+	{
+		Datum		values[Natts_segment];
+		bool		isnull[Natts_segment];
+
+		heap_deform_tuple(tuple, RelationGetDescr(segrel), values, isnull);
+		*rows += DatumGetInt32(values[Anum_segment_row_count - 1]);
+		*bytes += DatumGetInt64(values[Anum_segment_data_size - 1]);
+	}
+
+	systable_endscan(scan);
+	table_close(segrel, AccessShareLock);
+
+	pfree(columnar_read_deleted_rows(storage, snapshot, &ndeleted));
+	*rows = Max(*rows - ndeleted, 0);
+}
+
+/*
+ * Return the storage ids that have segments or deleted rows visible to
+ * snapshot, as a list of palloc'd RelFileLocators.
+ */
+List *
+columnar_storage_ids(Snapshot snapshot)
+{
+	static const char *const relnames[] = {"segment", "deleted_row"};
+	List	   *result = NIL;
+
+	for (int i = 0; i < lengthof(relnames); i++)
+	{
+		Relation	rel;
+		TableScanDesc scan;
+		TupleTableSlot *slot;
+
+		rel = table_open(columnar_metadata_relid(relnames[i]), AccessShareLock);
+		scan = table_beginscan(rel, snapshot, 0, NULL);
+		slot = table_slot_create(rel, NULL);
+		while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
+		{
+			RelFileLocator storage;
+			RelFileLocator *copy;
+			bool		isnull;
+			bool		found = false;
+
+			storage.spcOid =
+				DatumGetObjectId(slot_getattr(slot, Anum_storage_spcoid, &isnull));
+			storage.dbOid =
+				DatumGetObjectId(slot_getattr(slot, Anum_storage_dboid, &isnull));
+			storage.relNumber =
+				DatumGetObjectId(slot_getattr(slot, Anum_storage_relnumber, &isnull));
+
+			foreach_ptr(RelFileLocator, other, result)
+			{
+				if (RelFileLocatorEquals(*other, storage))
+				{
+					found = true;
+					break;
+				}
+			}
+			if (found)
+				continue;
+
+			copy = palloc(sizeof(RelFileLocator));
+			*copy = storage;
+			result = lappend(result, copy);
+		}
+		ExecDropSingleTupleTableSlot(slot);
+		table_endscan(scan);
+		table_close(rel, AccessShareLock);
+	}
+
+	return result;
+}
+
+/*
+ * Delete the rows of a storage visible to snapshot (the catalog snapshot,
+ * if NULL) from one metadata table.
+ */
+static void
+columnar_delete_rows(const char *relname, const char *indexname,
+					 RelFileLocator storage, Snapshot snapshot)
+{
+	Relation	rel;
+	SysScanDesc scan;
+	ScanKeyData key[COLUMNAR_STORAGE_NKEYS];
+	HeapTuple	tuple;
+
+	rel = table_open(columnar_metadata_relid(relname), RowExclusiveLock);
+
+	columnar_storage_scankeys(key, storage);
+	scan = systable_beginscan(rel, columnar_metadata_relid(indexname),
+							  true, snapshot, COLUMNAR_STORAGE_NKEYS, key);
+
+	while (HeapTupleIsValid(tuple = systable_getnext(scan)))
+		CatalogTupleDelete(rel, &tuple->t_self);
+
+	systable_endscan(scan);
+	table_close(rel, RowExclusiveLock);
+}
+
+/*
+ * Forget the segments of a storage visible to snapshot, or to the catalog
+ * snapshot if NULL.  Like everything else here, this is transactional.
+ */
+void
+columnar_storage_delete(RelFileLocator storage, Snapshot snapshot)
+{
+	columnar_delete_rows("segment", "segment_pkey", storage, snapshot);
+	columnar_delete_rows("chunk", "chunk_pkey", storage, snapshot);
+	columnar_delete_rows("deleted_row", "deleted_row_pkey", storage, snapshot);
+	CommandCounterIncrement();
+}
+
+/*
+ * Copy all rows of a storage in one metadata table to another storage.
+ */
+static void
+columnar_copy_rows(const char *relname, const char *indexname,
+				   RelFileLocator old_storage, RelFileLocator new_storage)
+{
+	Relation	rel;
+	SysScanDesc scan;
+	ScanKeyData key[COLUMNAR_STORAGE_NKEYS];
+	HeapTuple	tuple;
+	Datum	   *values;
+	bool	   *isnull;
+	bool	   *replace;
+
+	rel = table_open(columnar_metadata_relid(relname), RowExclusiveLock);
+
+	values = palloc0(sizeof(Datum) * RelationGetDescr(rel)->natts);
+	isnull = palloc0(sizeof(bool) * RelationGetDescr(rel)->natts);
+	replace = palloc0(sizeof(bool) * RelationGetDescr(rel)->natts);
+	columnar_storage_values(values, isnull, new_storage);
+	for (int i = 0; i < COLUMNAR_STORAGE_NKEYS; i++)
+		replace[i] = true;
+
+	columnar_storage_scankeys(key, old_storage);
+	scan = systable_beginscan(rel, columnar_metadata_relid(indexname),
+							  true, NULL, COLUMNAR_STORAGE_NKEYS, key);
+
+	while (HeapTupleIsValid(tuple = systable_getnext(scan)))
+	{
+		HeapTuple	newtuple;
+
+		newtuple = heap_modify_tuple(tuple, RelationGetDescr(rel),
+									 values, isnull, replace);
+		CatalogTupleInsert(rel, newtuple);
+		heap_freetuple(newtuple);
+	}
+
+	systable_endscan(scan);
+	table_close(rel, RowExclusiveLock);
+}
+
+/*
+ * Move the segments of a storage to a new storage id, for when the relation
+ * is moved to a new relfilenumber with its data copied verbatim.
+ */
+void
+columnar_storage_copy(RelFileLocator old_storage, RelFileLocator new_storage)
+{
+	columnar_copy_rows("segment", "segment_pkey", old_storage, new_storage);
+	columnar_copy_rows("chunk", "chunk_pkey", old_storage, new_storage);
+	columnar_copy_rows("deleted_row", "deleted_row_pkey",
+					   old_storage, new_storage);
+	CommandCounterIncrement();
+	columnar_storage_delete(old_storage, NULL);
+}
+
+/*
+ * Check whether a segment row has been deleted or updated by a transaction
+ * that is committed, or by our own, regardless of snapshots.  The caller
+ * holds the row's tuple lock, so no other transaction can be in the middle
+ * of deleting it.
+ *
+ * Returns TM_Ok if not, otherwise fills tmfd like heap_delete would.
+ */
+TM_Result
+columnar_row_deleted(Relation rel, int64 rownum, CommandId cid,
+					 TM_FailureData *tmfd)
+{
+	Relation	delrel;
+	SysScanDesc scan;
+	ScanKeyData key[COLUMNAR_STORAGE_NKEYS + 1];
+	SnapshotData SnapshotDirty;
+	HeapTuple	tuple;
+	TM_Result	result = TM_Ok;
+
+	delrel = table_open(columnar_metadata_relid("deleted_row"), AccessShareLock);
+
+	InitDirtySnapshot(SnapshotDirty);
+	columnar_storage_scankeys(key, columnar_storage_id(rel));
+	ScanKeyInit(&key[COLUMNAR_STORAGE_NKEYS], Anum_deleted_row_row_number,
+				BTEqualStrategyNumber, F_INT8EQ, Int64GetDatum(rownum));
+	scan = systable_beginscan(delrel,
+							  columnar_metadata_relid("deleted_row_pkey"),
+							  true, &SnapshotDirty, COLUMNAR_STORAGE_NKEYS + 1,
+							  key);
+
+	tuple = systable_getnext(scan);
+	if (HeapTupleIsValid(tuple))
+	{
+		TransactionId xmin = HeapTupleHeaderGetXmin(tuple->t_data);
+		bool		isnull;
+		Datum		updated_to;
+
+		updated_to = heap_getattr(tuple, Anum_deleted_row_updated_to,
+								  RelationGetDescr(delrel), &isnull);
+		if (isnull)
+			columnar_row_to_tid(rownum, &tmfd->ctid);
+		else
+			ItemPointerCopy(DatumGetItemPointer(updated_to), &tmfd->ctid);
+		tmfd->xmax = xmin;
+
+		if (TransactionIdIsCurrentTransactionId(xmin))
+		{
+			tmfd->cmax = HeapTupleHeaderGetCmin(tuple->t_data);
+			result = TM_SelfModified;
+		}
+		else if (TransactionIdIsValid(SnapshotDirty.xmin))
+		{
+			/* shouldn't happen while we hold the tuple lock */
+			tmfd->cmax = InvalidCommandId;
+			result = TM_BeingModified;
+		}
+		else
+		{
+			tmfd->cmax = InvalidCommandId;
+			result = isnull ? TM_Deleted : TM_Updated;
+		}
+	}
+
+	systable_endscan(scan);
+	table_close(delrel, AccessShareLock);
+
+	return result;
+}
+
+/*
+ * Record the deletion of a segment row, and where its new version went if
+ * it was updated.
+ */
+void
+columnar_mark_row_deleted(Relation rel, int64 rownum, ItemPointer new_tid)
+{
+	Relation	delrel;
+	Datum		values[Natts_deleted_row];
+	bool		isnull[Natts_deleted_row];
+	HeapTuple	tuple;
+
+	delrel = table_open(columnar_metadata_relid("deleted_row"), RowExclusiveLock);
+
+	columnar_storage_values(values, isnull, columnar_storage_id(rel));
+	values[Anum_deleted_row_row_number - 1] = Int64GetDatum(rownum);
+	isnull[Anum_deleted_row_row_number - 1] = false;
+	if (new_tid != NULL)
+	{
+		values[Anum_deleted_row_updated_to - 1] = ItemPointerGetDatum(new_tid);
+		isnull[Anum_deleted_row_updated_to - 1] = false;
+	}
+	else
+	{
+		values[Anum_deleted_row_updated_to - 1] = (Datum) 0;
+		isnull[Anum_deleted_row_updated_to - 1] = true;
+	}
+
+	tuple = heap_form_tuple(RelationGetDescr(delrel), values, isnull);
+	CatalogTupleInsert(delrel, tuple);
+	heap_freetuple(tuple);
+
+	table_close(delrel, RowExclusiveLock);
+}
+
+/*
+ * Start writing rows to new segments of a storage.
+ */
+ColumnarWriteState *
+columnar_begin_write(Relation rel, RelFileLocator storage)
+{
+	ColumnarWriteState *state = palloc0(sizeof(ColumnarWriteState));
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+	Relation	segrel;
+	SysScanDesc scan;
+	ScanKeyData key[COLUMNAR_STORAGE_NKEYS];
+	HeapTuple	tuple;
+
+	state->rel = rel;
+	state->storage = storage;
+	state->cxt = AllocSetContextCreate(CurrentMemoryContext,
+									   "columnar write",
+									   ALLOCSET_DEFAULT_SIZES);
+	state->max_rows = columnar_segment_row_count;
+	state->columns = palloc0(sizeof(ColumnarColumnBuffer) * tupdesc->natts);
+	for (int i = 0; i < tupdesc->natts; i++)
+	{
+		state->columns[i].values = palloc(sizeof(Datum) * state->max_rows);
+		state->columns[i].isnull = palloc(sizeof(bool) * state->max_rows);
+	}
+
+	/*
+	 * Segment ids and row numbers only have to be unique, so look at every
+	 * segment ever written, including those of transactions that aborted.
+	 * Concurrent writers are kept out by the caller's lock.
+	 */
+	segrel = table_open(columnar_metadata_relid("segment"), AccessShareLock);
+	columnar_storage_scankeys(key, storage);
+	scan = systable_beginscan(segrel, columnar_metadata_relid("segment_pkey"),
+							  true, SnapshotAny, COLUMNAR_STORAGE_NKEYS, key);
+	while (HeapTupleIsValid(tuple = systable_getnext(scan)))
+	{
+		Datum		values[Natts_segment];
+		bool		isnull[Natts_segment];
+		int64		end_row;
+
+		heap_deform_tuple(tuple, RelationGetDescr(segrel), values, isnull);
+		state->next_segment_id = Max(state->next_segment_id,
+									 DatumGetInt64(values[Anum_segment_segment_id - 1]) + 1);
+		end_row = DatumGetInt64(values[Anum_segment_first_row - 1]) +
+			DatumGetInt32(values[Anum_segment_row_count - 1]);
+		state->next_row = Max(state->next_row, end_row);
+	}
+	systable_endscan(scan);
+	table_close(segrel, AccessShareLock);
+
+	return state;
+}
+
+/*
+ * Add the row in slot to the segment being built.
+ */
+void
+columnar_write_row(ColumnarWriteState *state, TupleTableSlot *slot)
+{
+	TupleDesc	tupdesc = RelationGetDescr(state->rel);
+	MemoryContext oldcxt;
+
+	slot_getallattrs(slot);
+
+	oldcxt = MemoryContextSwitchTo(state->cxt);
+	for (int i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+		ColumnarColumnBuffer *column = &state->columns[i];
+		Datum		value = slot->tts_values[i];
+		bool		isnull = slot->tts_isnull[i] || attr->attisdropped;
+
+		if (!isnull)
+		{
+			/* values are stored detoasted, and with a 4-byte header */
+			if (attr->attlen == -1)
+				value = PointerGetDatum(PG_DETOAST_DATUM_COPY(value));
+			else
+				value = datumCopy(value, attr->attbyval, attr->attlen);
+
+			column->datasize = att_align_nominal(column->datasize,
+												 attr->attalign);
+			column->datasize = att_addlength_datum(column->datasize,
+												   attr->attlen, value);
+			state->nbytes += attr->attbyval ? sizeof(Datum) :
+				att_addlength_datum(0, attr->attlen, value);
+		}
+
+		column->values[state->nrows] = isnull ? (Datum) 0 : value;
+		column->isnull[state->nrows] = isnull;
+	}
+	MemoryContextSwitchTo(oldcxt);
+
+	state->nrows++;
+	if (state->nrows >= state->max_rows ||
+		state->nbytes >= COLUMNAR_MAX_SEGMENT_BYTES)
+		columnar_flush_segment(state);
+}
+
+/*
+ * Write out the rows buffered, and return the number of rows written
+ * altogether.
+ */
+int64
+columnar_end_write(ColumnarWriteState *state)
+{
+	int64		rows_written;
+
+	if (state->nrows > 0)
+		columnar_flush_segment(state);
+
+	rows_written = state->rows_written;
+	MemoryContextDelete(state->cxt);
+
+	return rows_written;
+}
+
+/*
+ * Write the rows buffered as a new segment.
+ */
+static void
+columnar_flush_segment(ColumnarWriteState *state)
+{
+	TupleDesc	tupdesc = RelationGetDescr(state->rel);
+	Relation	segrel;
+	Relation	chunkrel;
+	Datum		segvalues[Natts_segment];
+	bool		segnulls[Natts_segment] = {0};
+	int64		data_size = 0;
+	HeapTuple	tuple;
+
+	chunkrel = table_open(columnar_metadata_relid("chunk"), RowExclusiveLock);
+
+	for (int i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+		ColumnarColumnBuffer *column = &state->columns[i];
+		Datum		values[Natts_chunk];
+		bool		isnull[Natts_chunk] = {0};
+		TypeCacheEntry *typentry;
+		int			null_count = 0;
+		int			minidx = -1;
+		int			maxidx = -1;
+		bytea	   *data;
+
+		if (attr->attisdropped)
+			continue;
+
+		/* find the range, if the type can tell */
+		typentry = lookup_type_cache(attr->atttypid, TYPECACHE_CMP_PROC_FINFO);
+		for (int j = 0; j < state->nrows; j++)
+		{
+			if (column->isnull[j])
+			{
+				null_count++;
+				continue;
+			}
+			if (!OidIsValid(typentry->cmp_proc_finfo.fn_oid))
+				continue;
+			if (minidx < 0 ||
+				DatumGetInt32(FunctionCall2Coll(&typentry->cmp_proc_finfo,
+												attr->attcollation,
+												column->values[j],
+												column->values[minidx])) < 0)
+				minidx = j;
+			if (maxidx < 0 ||
+				DatumGetInt32(FunctionCall2Coll(&typentry->cmp_proc_finfo,
+												attr->attcollation,
+												column->values[j],
+												column->values[maxidx])) > 0)
+				maxidx = j;
+		}
+
+		data = columnar_encode_chunk(attr, column, state->nrows);
+		data_size += VARSIZE(data);
+
+		columnar_storage_values(values, isnull, state->storage);
+		values[Anum_chunk_segment_id - 1] = Int64GetDatum(state->next_segment_id);
+		values[Anum_chunk_attnum - 1] = Int16GetDatum(attr->attnum);
+		values[Anum_chunk_null_count - 1] = Int32GetDatum(null_count);
+		if (minidx >= 0)
+		{
+			values[Anum_chunk_min_value - 1] =
+				PointerGetDatum(columnar_datum_to_bytea(attr, column->values[minidx]));
+			values[Anum_chunk_max_value - 1] =
+				PointerGetDatum(columnar_datum_to_bytea(attr, column->values[maxidx]));
+		}
+		else
+		{
+			isnull[Anum_chunk_min_value - 1] = true;
+			isnull[Anum_chunk_max_value - 1] = true;
+		}
+		values[Anum_chunk_data - 1] = PointerGetDatum(data);
+
+		tuple = heap_form_tuple(RelationGetDescr(chunkrel), values, isnull);
+		CatalogTupleInsert(chunkrel, tuple);
+		heap_freetuple(tuple);
+		pfree(data);
+
+		column->datasize = 0;
+	}
+
+	table_close(chunkrel, RowExclusiveLock);
+
+	segrel = table_open(columnar_metadata_relid("segment"), RowExclusiveLock);
+	columnar_storage_values(segvalues, segnulls, state->storage);
+	segvalues[Anum_segment_segment_id - 1] = Int64GetDatum(state->next_segment_id);
+	segvalues[Anum_segment_first_row - 1] = Int64GetDatum(state->next_row);
+	segvalues[Anum_segment_row_count - 1] = Int32GetDatum(state->nrows);
+	segvalues[Anum_segment_data_size - 1] = Int64GetDatum(data_size);
+	tuple = heap_form_tuple(RelationGetDescr(segrel), segvalues, segnulls);
+	CatalogTupleInsert(segrel, tuple);
+	heap_freetuple(tuple);
+	table_close(segrel, RowExclusiveLock);
+
+	state->next_segment_id++;
+	state->next_row += state->nrows;
+	state->rows_written += state->nrows;
+	state->nrows = 0;
+	state->nbytes = 0;
+	MemoryContextReset(state->cxt);
+}
+
+/*
+ * Build the chunk of one column of a segment.
+ */
+static bytea *
+columnar_encode_chunk(Form_pg_attribute attr, ColumnarColumnBuffer *column,
+					  int nrows)
+{
+	ColumnarChunkHeader *chunk;
+	bool		hasnulls = false;
+	Size		bitmaplen;
+	Size		rawsize;
+	char	   *raw;
+	char	   *data;
+	Size		off = 0;
+	int32		compressed_size = -1;
+	ColumnarCompression compression = columnar_compression;
+
+	for (int j = 0; j < nrows; j++)
+	{
+		if (column->isnull[j])
+		{
+			hasnulls = true;
+			break;
+		}
+	}
+
+	bitmaplen = hasnulls ? MAXALIGN(BITMAPLEN(nrows)) : 0;
+	rawsize = bitmaplen + column->datasize;
+	if (rawsize > MaxAllocSize - COLUMNAR_CHUNK_HDRSZ)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("column \"%s\" of a columnar segment is too large",
+						NameStr(attr->attname)),
+				 errhint("Lower \"columnar.segment_row_count\".")));
+
+	raw = palloc0(rawsize);
+	data = raw + bitmaplen;
+	for (int j = 0; j < nrows; j++)
+	{
+		if (column->isnull[j])
+			continue;
+		if (hasnulls)
+			raw[j / 8] |= (1 << (j % 8));
+
+		off = att_align_nominal(off, attr->attalign);
+		if (attr->attbyval)
+			store_att_byval(data + off, column->values[j], attr->attlen);
+		else
+			memcpy(data + off, DatumGetPointer(column->values[j]),
+				   att_addlength_datum(0, attr->attlen, column->values[j]));
+		off = att_addlength_datum(off, attr->attlen, column->values[j]);
+	}
+	Assert(off == column->datasize);
+
+	chunk = palloc(COLUMNAR_CHUNK_HDRSZ + Max(rawsize, PGLZ_MAX_OUTPUT(rawsize)));
+
+	switch (compression)
+	{
+		case COLUMNAR_COMPRESSION_NONE:
+			break;
+		case COLUMNAR_COMPRESSION_PGLZ:
+			compressed_size = pglz_compress(raw, rawsize,
+											(char *) chunk + COLUMNAR_CHUNK_HDRSZ,
+											PGLZ_strategy_default);
+			break;
+		case COLUMNAR_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			chunk = repalloc(chunk, COLUMNAR_CHUNK_HDRSZ +
+							 Max(rawsize, LZ4_compressBound(rawsize)));
+			compressed_size = LZ4_compress_default(raw,
+												   (char *) chunk + COLUMNAR_CHUNK_HDRSZ,
+												   rawsize,
+												   LZ4_compressBound(rawsize));
+			if (compressed_size <= 0 || compressed_size >= rawsize)
+				compressed_size = -1;
+#endif
+			break;
+	}
+
+	if (compressed_size < 0)
+	{
+		compression = COLUMNAR_COMPRESSION_NONE;
+		memcpy((char *) chunk + COLUMNAR_CHUNK_HDRSZ, raw, rawsize);
+		compressed_size = rawsize;
+	}
+
+	SET_VARSIZE(chunk, COLUMNAR_CHUNK_HDRSZ + compressed_size);
+	chunk->nrows = nrows;
+	chunk->rawsize = rawsize;
+	chunk->compression = compression;
+	chunk->hasnulls = hasnulls;
+
+	pfree(raw);
+
+	return (bytea *) chunk;
+}
+
+/*
+ * Decode a chunk into values and isnull.  Pass-by-reference values point
+ * into a buffer allocated in the current memory context.
+ */
+static void
+columnar_decode_chunk(Form_pg_attribute attr, bytea *data, int nrows,
+					  Datum *values, bool *isnull)
+{
+	ColumnarChunkHeader *chunk = (ColumnarChunkHeader *) data;
+	char	   *payload = (char *) chunk + COLUMNAR_CHUNK_HDRSZ;
+	int32		payloadsize = VARSIZE(chunk) - COLUMNAR_CHUNK_HDRSZ;
+	char	   *raw;
+	char	   *ptr;
+	Size		off = 0;
+
+	if (chunk->nrows != nrows)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("columnar chunk has %d rows, expected %d",
+								 chunk->nrows, nrows)));
+
+	raw = palloc(Max(chunk->rawsize, 1));
+	switch (chunk->compression)
+	{
+		case COLUMNAR_COMPRESSION_NONE:
+			if (payloadsize != chunk->rawsize)
+				ereport(ERROR,
+						(errcode(ERRCODE_DATA_CORRUPTED),
+						 errmsg_internal("columnar chunk has wrong size")));
+			memcpy(raw, payload, payloadsize);
+			break;
+		case COLUMNAR_COMPRESSION_PGLZ:
+			if (pglz_decompress(payload, payloadsize, raw, chunk->rawsize,
+								true) != chunk->rawsize)
+				ereport(ERROR,
+						(errcode(ERRCODE_DATA_CORRUPTED),
+						 errmsg_internal("compressed columnar data is corrupt")));
+			break;
+		case COLUMNAR_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			if (LZ4_decompress_safe(payload, raw, payloadsize,
+									chunk->rawsize) != chunk->rawsize)
+				ereport(ERROR,
+						(errcode(ERRCODE_DATA_CORRUPTED),
+						 errmsg_internal("compressed columnar data is corrupt")));
+#else
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("compression method lz4 not supported"),
+					 errdetail("This functionality requires the server to be built with lz4 support.")));
+#endif
+			break;
+		default:
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg_internal("invalid compression method %d in columnar chunk",
+									 chunk->compression)));
+	}
+
+	ptr = chunk->hasnulls ? raw + MAXALIGN(BITMAPLEN(nrows)) : raw;
+	for (int j = 0; j < nrows; j++)
+	{
+		if (chunk->hasnulls && att_isnull(j, (bits8 *) raw))
+		{
+			values[j] = (Datum) 0;
+			isnull[j] = true;
+			continue;
+		}
+
+		off = att_align_nominal(off, attr->attalign);
+		values[j] = fetch_att(ptr + off, attr->attbyval, attr->attlen);
+		isnull[j] = false;
+		off = att_addlength_pointer(off, attr->attlen, ptr + off);
+	}
+}
+
+/*
+ * Serialize a value for the min_value and max_value columns.
+ */
+static bytea *
+columnar_datum_to_bytea(Form_pg_attribute attr, Datum value)
+{
+	Size		len = attr->attbyval ? attr->attlen :
+		att_addlength_datum(0, attr->attlen, value);
+	bytea	   *result = palloc(VARHDRSZ + len);
+
+	SET_VARSIZE(result, VARHDRSZ + len);
+	if (attr->attbyval)
+		store_att_byval(VARDATA(result), value, attr->attlen);
+	else
+		memcpy(VARDATA(result), DatumGetPointer(value), len);
+
+	return result;
+}
+
+/*
+ * Inverse of columnar_datum_to_bytea.
+ */
+static Datum
+columnar_bytea_to_datum(Form_pg_attribute attr, bytea *bytes)
+{
+	Size		len = VARSIZE_ANY_EXHDR(bytes);
+	char	   *copy = palloc(Max(len, sizeof(Datum)));
+
+	memcpy(copy, VARDATA_ANY(bytes), len);
+
+	return fetch_att(copy, attr->attbyval, attr->attlen);
+}
@@ -0,0 +1,895 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar_tableam.c
+ *	  Columnar table access method.
+ *
+ * A columnar table has two parts.  Writes go to the delta store, an
+ * ordinary heap in the relation's main fork, so that inserts, updates and
+ * deletes of new rows cost what they cost in a heap table.  Rows that are
+ * no longer in flux are merged from the delta store into column segments
+ * (see columnar_merge.c and columnar_storage.c), from which analytical
+ * scans read only the columns they need and skip segments whose value
+ * ranges rule them out.
+ *
+ * Most of the callbacks therefore hand delta store rows to heapam, and only
+ * deal with segment rows themselves; the two are told apart by TID.  Scans
+ * return the segment rows first, and then the delta store's.
+ *
+ * Indexes, parallel scans, TABLESAMPLE, TID range scans and backward scans
+ * aren't supported.  ANALYZE only samples the delta store; the row and page
+ * counts the planner uses come from relation_estimate_size and include the
+ * segments.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar_tableam.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/heapam.h"
+#include "access/htup_details.h"
+#include "access/tableam.h"
+#include "access/xact.h"
+#include "catalog/index.h"
+#include "catalog/pg_class.h"
+#include "columnar.h"
+#include "executor/tuptable.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "storage/lmgr.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
+#include "utils/snapmgr.h"
+
+PG_MODULE_MAGIC_EXT(
+					.name = "columnar",
+					.version = PG_VERSION
+);
+
+PG_FUNCTION_INFO_V1(columnar_handler);
+
+/* GUC parameters */
+int			columnar_segment_row_count = 100000;
+int			columnar_compression = COLUMNAR_COMPRESSION_PGLZ;
+bool		columnar_enable_custom_scan = true;
+
+static const struct config_enum_entry columnar_compression_options[] = {
+	{"none", COLUMNAR_COMPRESSION_NONE, false},
+	{"pglz", COLUMNAR_COMPRESSION_PGLZ, false},
+#ifdef USE_LZ4
+	{"lz4", COLUMNAR_COMPRESSION_LZ4, false},
+#endif
+	{NULL, 0, false}
+};
+
+/* Heavyweight tuple locks taken on segment rows, as heapam does */
+static const LOCKMODE columnar_tuple_lock_modes[] = {
+	[LockTupleKeyShare] = AccessShareLock,
+	[LockTupleShare] = RowShareLock,
+	[LockTupleNoKeyExclusive] = ExclusiveLock,
+	[LockTupleExclusive] = AccessExclusiveLock,
+};
+
+static TableAmRoutine columnar_methods;
+static const TableAmRoutine *heap_methods = NULL;
+
+static ColumnarScanDesc columnar_beginscan_internal(Relation rel,
+													Snapshot snapshot,
+													uint32 flags,
+													Bitmapset *attrs_needed,
+													List *filters);
+static bool columnar_lock_segment_row(Relation rel, ItemPointer tid,
+									  LOCKMODE lockmode,
+									  LockWaitPolicy wait_policy);
+
+
+/*
+ * Module load callback
+ */
+void
+_PG_init(void)
+{
+	DefineCustomIntVariable("columnar.segment_row_count",
+							"Sets the maximum number of rows in a column segment.",
+							NULL,
+							&columnar_segment_row_count,
+							100000,
+							1000,
+							10000000,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomEnumVariable("columnar.compression",
+							 "Sets the compression method for column segments.",
+							 NULL,
+							 &columnar_compression,
+							 COLUMNAR_COMPRESSION_PGLZ,
+							 columnar_compression_options,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("columnar.enable_custom_scan",
+							 "Enables the planner's use of columnar scans.",
+							 NULL,
+							 &columnar_enable_custom_scan,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	columnar_merge_init();
+
+	MarkGUCPrefixReserved("columnar");
+
+	columnar_customscan_init();
+}
+
+/*
+ * Is this a columnar table?
+ */
+bool
+columnar_relation_is_columnar(Relation rel)
+{
+	return rel->rd_tableam == &columnar_methods;
+}
+
+/* ------------------------------------------------------------------------
+ * Scans
+ * ------------------------------------------------------------------------
+ */
+
+static ColumnarScanDesc
+columnar_beginscan_internal(Relation rel, Snapshot snapshot, uint32 flags,
+							Bitmapset *attrs_needed, List *filters)
+{
+	ColumnarScanDesc scan;
+	MemoryContext scan_cxt;
+	MemoryContext oldcxt;
+
+	scan_cxt = AllocSetContextCreate(CurrentMemoryContext,
+									 "columnar scan",
+									 ALLOCSET_DEFAULT_SIZES);
+	oldcxt = MemoryContextSwitchTo(scan_cxt);
+
+	scan = palloc0(sizeof(ColumnarScanDescData));
+	scan->rs_base.rs_rd = rel;
+	scan->rs_base.rs_snapshot = snapshot;
+	scan->rs_base.rs_nkeys = 0;
+	scan->rs_base.rs_flags = flags;
+	scan->rs_base.rs_parallel = NULL;
+	scan->scan_cxt = scan_cxt;
+	scan->batch_cxt = AllocSetContextCreate(scan_cxt,
+											"columnar batch",
+											ALLOCSET_DEFAULT_SIZES);
+	scan->attrs_needed = bms_copy(attrs_needed);
+	scan->filters = filters;
+
+	MemoryContextSwitchTo(oldcxt);
+
+	/* the snapshot is ours to release, not the delta scan's */
+	scan->delta_scan = heap_methods->scan_begin(rel, snapshot, 0, NULL, NULL,
+												flags & ~SO_TEMP_SNAPSHOT);
+
+	return scan;
+}
+
+static TableScanDesc
+columnar_beginscan(Relation rel, Snapshot snapshot, int nkeys,
+				   struct ScanKeyData *key, ParallelTableScanDesc pscan,
+				   uint32 flags)
+{
+	if (pscan != NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("parallel scans of columnar tables are not supported")));
+	if (nkeys > 0)
+		elog(ERROR, "scan keys are not supported on columnar tables");
+
+	return (TableScanDesc) columnar_beginscan_internal(rel, snapshot, flags,
+													   NULL, NIL);
+}
+
+/*
+ * Begin a scan that decodes only the columns in attrs_needed and skips the
+ * segments that can't satisfy filters, for the columnar custom scan.
+ */
+ColumnarScanDesc
+columnar_beginscan_extended(Relation rel, Snapshot snapshot,
+							Bitmapset *attrs_needed, List *filters)
+{
+	return columnar_beginscan_internal(rel, snapshot,
+									   SO_TYPE_SEQSCAN | SO_ALLOW_STRAT |
+									   SO_ALLOW_SYNC | SO_ALLOW_PAGEMODE,
+									   attrs_needed, filters);
+}
+
+static void
+columnar_endscan(TableScanDesc sscan)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	heap_methods->scan_end(scan->delta_scan);
+
+	if (scan->rs_base.rs_flags & SO_TEMP_SNAPSHOT)
+		UnregisterSnapshot(scan->rs_base.rs_snapshot);
+
+	MemoryContextDelete(scan->scan_cxt);
+}
+
+static void
+columnar_rescan(TableScanDesc sscan, struct ScanKeyData *key, bool set_params,
+				bool allow_strat, bool allow_sync, bool allow_pagemode)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	heap_methods->scan_rescan(scan->delta_scan, key, set_params, allow_strat,
+							  allow_sync, allow_pagemode);
+
+	scan->next_segment = 0;
+	scan->segments_done = false;
+	scan->batch.nselected = 0;
+	scan->batch_pos = 0;
+}
+
+/*
+ * Decode the next segment that the scan can't skip, and return it as a
+ * batch.  Returns false when there are no more.
+ */
+bool
+columnar_scan_next_batch(ColumnarScanDesc scan, ColumnarBatch **batch)
+{
+	Relation	rel = scan->rs_base.rs_rd;
+	Snapshot	snapshot = scan->rs_base.rs_snapshot;
+	RelFileLocator storage = columnar_storage_id(rel);
+
+	if (scan->segments_done)
+		return false;
+
+	if (!scan->segments_loaded)
+	{
+		MemoryContext oldcxt = MemoryContextSwitchTo(scan->scan_cxt);
+
+		scan->segments = columnar_read_segments(storage, snapshot);
+		scan->deleted_rows = columnar_read_deleted_rows(storage, snapshot,
+														&scan->ndeleted);
+		scan->segments_loaded = true;
+		MemoryContextSwitchTo(oldcxt);
+	}
+
+	while (scan->next_segment < list_length(scan->segments))
+	{
+		ColumnarSegment *segment = list_nth(scan->segments, scan->next_segment);
+		MemoryContext oldcxt;
+		int			lo = 0;
+		int			hi = scan->ndeleted;
+		int			nselected = 0;
+
+		scan->next_segment++;
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (!columnar_segment_passes_filters(rel, storage, segment,
+											 scan->filters, snapshot))
+		{
+			scan->segments_skipped++;
+			continue;
+		}
+
+		MemoryContextReset(scan->batch_cxt);
+		oldcxt = MemoryContextSwitchTo(scan->batch_cxt);
+
+		columnar_read_batch(rel, storage, segment, scan->attrs_needed,
+							snapshot, &scan->batch);
+
+		/* find the first deleted row of the segment, if any */
+		while (lo < hi)
+		{
+			int			mid = lo + (hi - lo) / 2;
+
+			if (scan->deleted_rows[mid] < segment->first_row)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		/* leave the deleted rows out of the selection vector */
+		scan->batch.rows = palloc(sizeof(int) * segment->row_count);
+		for (int i = 0; i < segment->row_count; i++)
+		{
+			if (lo < scan->ndeleted &&
+				scan->deleted_rows[lo] == segment->first_row + i)
+			{
+				lo++;
+				continue;
+			}
+			scan->batch.rows[nselected++] = i;
+		}
+		scan->batch.nselected = nselected;
+		scan->batch_pos = 0;
+
+		MemoryContextSwitchTo(oldcxt);
+
+		if (nselected == 0)
+			continue;
+
+		*batch = &scan->batch;
+		return true;
+	}
+
+	scan->segments_done = true;
+	return false;
+}
+
+/*
+ * Return the next row of the delta store, once the segments are done.
+ */
+bool
+columnar_scan_next_delta(ColumnarScanDesc scan, TupleTableSlot *slot)
+{
+	return heap_methods->scan_getnextslot(scan->delta_scan,
+										  ForwardScanDirection, slot);
+}
+
+static bool
+columnar_getnextslot(TableScanDesc sscan, ScanDirection direction,
+					 TupleTableSlot *slot)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+	Relation	rel = scan->rs_base.rs_rd;
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+
+	if (ScanDirectionIsBackward(direction))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("backward scans of columnar tables are not supported")));
+
+	/* ANALYZE only samples the delta store */
+	if ((scan->rs_base.rs_flags & SO_TYPE_ANALYZE) == 0 &&
+		!scan->segments_done)
+	{
+		ColumnarBatch *batch = &scan->batch;
+
+		while (scan->batch_pos < batch->nselected ||
+			   columnar_scan_next_batch(scan, &batch))
+		{
+			int			row = batch->rows[scan->batch_pos++];
+			Datum	   *values = palloc(sizeof(Datum) * tupdesc->natts);
+			bool	   *isnull = palloc(sizeof(bool) * tupdesc->natts);
+			HeapTuple	tuple;
+
+			for (int i = 0; i < tupdesc->natts; i++)
+			{
+				values[i] = batch->values[i][row];
+				isnull[i] = batch->isnull[i][row];
+			}
+			tuple = heap_form_tuple(tupdesc, values, isnull);
+			columnar_row_to_tid(batch->first_row + row, &tuple->t_self);
+			tuple->t_tableOid = RelationGetRelid(rel);
+			ExecStoreHeapTuple(tuple, slot, true);
+
+			pfree(values);
+			pfree(isnull);
+
+			pgstat_count_heap_getnext(rel);
+			return true;
+		}
+	}
+
+	return heap_methods->scan_getnextslot(scan->delta_scan, direction, slot);
+}
+
+/* ------------------------------------------------------------------------
+ * Index scans: not supported
+ * ------------------------------------------------------------------------
+ */
+
+static pg_noreturn void
+columnar_indexes_not_supported(void)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("indexes are not supported on columnar tables")));
+}
+
+static IndexFetchTableData *
+columnar_index_fetch_begin(Relation rel)
+{
+	columnar_indexes_not_supported();
+}
+
+static void
+columnar_index_fetch_reset(IndexFetchTableData *scan)
+{
+	columnar_indexes_not_supported();
+}
+
+static void
+columnar_index_fetch_end(IndexFetchTableData *scan)
+{
+	columnar_indexes_not_supported();
+}
+
+static bool
+columnar_index_fetch_tuple(struct IndexFetchTableData *scan,
+						   ItemPointer tid, Snapshot snapshot,
+						   TupleTableSlot *slot, bool *call_again,
+						   bool *all_dead)
+{
+	columnar_indexes_not_supported();
+}
+
+static TransactionId
+columnar_index_delete_tuples(Relation rel, TM_IndexDeleteOp *delstate)
+{
+	columnar_indexes_not_supported();
+}
+
+static double
+columnar_index_build_range_scan(Relation table_rel, Relation index_rel,
+								IndexInfo *index_info, bool allow_sync,
+								bool anyvisible, bool progress,
+								BlockNumber start_blockno,
+								BlockNumber numblocks,
+								IndexBuildCallback callback,
+								void *callback_state, TableScanDesc scan)
+{
+	columnar_indexes_not_supported();
+}
+
+static void
+columnar_index_validate_scan(Relation table_rel, Relation index_rel,
+							 IndexInfo *index_info, Snapshot snapshot,
+							 ValidateIndexState *state)
+{
+	columnar_indexes_not_supported();
+}
+
+/* ------------------------------------------------------------------------
+ * Non-modifying operations on individual tuples
+ * ------------------------------------------------------------------------
+ */
+
+static bool
+columnar_fetch_row_version(Relation rel, ItemPointer tid, Snapshot snapshot,
+						   TupleTableSlot *slot)
+{
+	if (!ColumnarTidIsSegmentRow(tid))
+		return heap_methods->tuple_fetch_row_version(rel, tid, snapshot, slot);
+
+	return columnar_fetch_row(rel, columnar_tid_to_row(tid), snapshot, slot);
+}
+
+static bool
+columnar_tuple_tid_valid(TableScanDesc sscan, ItemPointer tid)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	if (!ColumnarTidIsSegmentRow(tid))
+		return heap_methods->tuple_tid_valid(scan->delta_scan, tid);
+
+	return ItemPointerGetOffsetNumberNoCheck(tid) >= FirstOffsetNumber &&
+		ItemPointerGetOffsetNumberNoCheck(tid) <= COLUMNAR_ROWS_PER_BLOCK &&
+		columnar_find_segment(columnar_storage_id(scan->rs_base.rs_rd),
+							  columnar_tid_to_row(tid),
+							  scan->rs_base.rs_snapshot) != NULL;
+}
+
+static void
+columnar_get_latest_tid(TableScanDesc sscan, ItemPointer tid)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	/* the newer version of an updated segment row is in the delta store */
+	if (ColumnarTidIsSegmentRow(tid) &&
+		!columnar_row_updated_to(scan->rs_base.rs_rd, columnar_tid_to_row(tid),
+								 scan->rs_base.rs_snapshot, tid))
+		return;
+
+	heap_methods->tuple_get_latest_tid(scan->delta_scan, tid);
+}
+
+static bool
+columnar_tuple_satisfies_snapshot(Relation rel, TupleTableSlot *slot,
+								  Snapshot snapshot)
+{
+	if (!ColumnarTidIsSegmentRow(&slot->tts_tid))
+		return heap_methods->tuple_satisfies_snapshot(rel, slot, snapshot);
+
+	return columnar_row_visible(rel, columnar_tid_to_row(&slot->tts_tid),
+								snapshot);
+}
+
+/* ------------------------------------------------------------------------
+ * Manipulations of physical tuples
+ * ------------------------------------------------------------------------
+ */
+
+/*
+ * Take the heavyweight lock on a segment row that serializes its
+ * modifications.  It's held until the end of the transaction.  Returns
+ * false if wait_policy says not to wait, and the lock is taken.
+ */
+static bool
+columnar_lock_segment_row(Relation rel, ItemPointer tid, LOCKMODE lockmode,
+						  LockWaitPolicy wait_policy)
+{
+	switch (wait_policy)
+	{
+		case LockWaitBlock:
+			LockTuple(rel, tid, lockmode);
+			break;
+		case LockWaitSkip:
+			if (!ConditionalLockTuple(rel, tid, lockmode, false))
+				return false;
+			break;
+		case LockWaitError:
+			if (!ConditionalLockTuple(rel, tid, lockmode, true))
+				ereport(ERROR,
+						(errcode(ERRCODE_LOCK_NOT_AVAILABLE),
+						 errmsg("could not obtain lock on row in relation \"%s\"",
+								RelationGetRelationName(rel))));
+			break;
+	}
+
+	return true;
+}
+
+static TM_Result
+columnar_tuple_delete(Relation rel, ItemPointer tid, CommandId cid,
+					  Snapshot snapshot, Snapshot crosscheck, bool wait,
+					  TM_FailureData *tmfd, bool changingPart)
+{
+	int64		rownum;
+	TM_Result	result;
+
+	if (!ColumnarTidIsSegmentRow(tid))
+		return heap_methods->tuple_delete(rel, tid, cid, snapshot, crosscheck,
+										  wait, tmfd, changingPart);
+
+	rownum = columnar_tid_to_row(tid);
+	if (!columnar_lock_segment_row(rel, tid,
+								   columnar_tuple_lock_modes[LockTupleExclusive],
+								   wait ? LockWaitBlock : LockWaitSkip))
+	{
+		tmfd->ctid = *tid;
+		tmfd->xmax = InvalidTransactionId;
+		tmfd->cmax = InvalidCommandId;
+		return TM_BeingModified;
+	}
+
+	result = columnar_row_deleted(rel, rownum, cid, tmfd);
+	if (result != TM_Ok)
+		return result;
+
+	columnar_mark_row_deleted(rel, rownum, NULL);
+
+	return TM_Ok;
+}
+
+static TM_Result
+columnar_tuple_update(Relation rel, ItemPointer otid, TupleTableSlot *slot,
+					  CommandId cid, Snapshot snapshot, Snapshot crosscheck,
+					  bool wait, TM_FailureData *tmfd,
+					  LockTupleMode *lockmode, TU_UpdateIndexes *update_indexes)
+{
+	int64		rownum;
+	TM_Result	result;
+
+	if (!ColumnarTidIsSegmentRow(otid))
+		return heap_methods->tuple_update(rel, otid, slot, cid, snapshot,
+										  crosscheck, wait, tmfd, lockmode,
+										  update_indexes);
+
+	*lockmode = LockTupleExclusive;
+	*update_indexes = TU_None;
+
+	rownum = columnar_tid_to_row(otid);
+	if (!columnar_lock_segment_row(rel, otid,
+								   columnar_tuple_lock_modes[LockTupleExclusive],
+								   wait ? LockWaitBlock : LockWaitSkip))
+	{
+		tmfd->ctid = *otid;
+		tmfd->xmax = InvalidTransactionId;
+		tmfd->cmax = InvalidCommandId;
+		return TM_BeingModified;
+	}
+
+	result = columnar_row_deleted(rel, rownum, cid, tmfd);
+	if (result != TM_Ok)
+		return result;
+
+	/* the new version goes to the delta store */
+	heap_methods->tuple_insert(rel, slot, cid, 0, NULL);
+	columnar_mark_row_deleted(rel, rownum, &slot->tts_tid);
+
+	return TM_Ok;
+}
+
+static TM_Result
+columnar_tuple_lock(Relation rel, ItemPointer tid, Snapshot snapshot,
+					TupleTableSlot *slot, CommandId cid, LockTupleMode mode,
+					LockWaitPolicy wait_policy, uint8 flags,
+					TM_FailureData *tmfd)
+{
+	int64		rownum;
+	TM_Result	result;
+
+	if (!ColumnarTidIsSegmentRow(tid))
+		return heap_methods->tuple_lock(rel, tid, snapshot, slot, cid, mode,
+										wait_policy, flags, tmfd);
+
+	tmfd->traversed = false;
+	rownum = columnar_tid_to_row(tid);
+	if (!columnar_lock_segment_row(rel, tid, columnar_tuple_lock_modes[mode],
+								   wait_policy))
+		return TM_WouldBlock;
+
+	result = columnar_row_deleted(rel, rownum, cid, tmfd);
+
+	/* follow an update to the delta store, if asked to */
+	if (result == TM_Updated && (flags & TUPLE_LOCK_FLAG_FIND_LAST_VERSION))
+	{
+		ItemPointerData newtid = tmfd->ctid;
+
+		result = heap_methods->tuple_lock(rel, &newtid, snapshot, slot, cid,
+										  mode, wait_policy, flags, tmfd);
+		tmfd->traversed = true;
+		return result;
+	}
+
+	if (result != TM_Ok)
+		return result;
+
+	if (!columnar_fetch_row(rel, rownum, SnapshotSelf, slot))
+		elog(ERROR, "failed to fetch columnar row (%u,%u) in relation \"%s\"",
+			 ItemPointerGetBlockNumberNoCheck(tid),
+			 ItemPointerGetOffsetNumberNoCheck(tid),
+			 RelationGetRelationName(rel));
+
+	return TM_Ok;
+}
+
+/* ------------------------------------------------------------------------
+ * DDL related callbacks
+ * ------------------------------------------------------------------------
+ */
+
+static void
+columnar_relation_set_new_filelocator(Relation rel,
+									  const RelFileLocator *newrlocator,
+									  char persistence,
+									  TransactionId *freezeXid,
+									  MultiXactId *minmulti)
+{
+	/*
+	 * The segments are kept in logged tables, so they would survive a crash
+	 * that empties the delta store of an unlogged table.
+	 */
+	if (persistence == RELPERSISTENCE_UNLOGGED)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("unlogged columnar tables are not supported")));
+
+	/* on TRUNCATE, forget the old storage's segments */
+	if (!RelFileLocatorEquals(rel->rd_locator, *newrlocator))
+		columnar_storage_delete(columnar_storage_id(rel), NULL);
+
+	heap_methods->relation_set_new_filelocator(rel, newrlocator, persistence,
+											   freezeXid, minmulti);
+}
+
+static void
+columnar_relation_nontransactional_truncate(Relation rel)
+{
+	columnar_storage_delete(columnar_storage_id(rel), NULL);
+	heap_methods->relation_nontransactional_truncate(rel);
+}
+
+static void
+columnar_relation_copy_data(Relation rel, const RelFileLocator *newrlocator)
+{
+	heap_methods->relation_copy_data(rel, newrlocator);
+	columnar_storage_copy(columnar_storage_id(rel), *newrlocator);
+}
+
+/*
+ * VACUUM FULL: write all live rows of the old table, from its segments and
+ * its delta store, to segments of the new one.  That leaves the delta store
+ * empty and drops the rows deleted from segments.
+ */
+static void
+columnar_relation_copy_for_cluster(Relation OldTable, Relation NewTable,
+								   Relation OldIndex, bool use_sort,
+								   TransactionId OldestXmin,
+								   TransactionId *xid_cutoff,
+								   MultiXactId *multi_cutoff,
+								   double *num_tuples,
+								   double *tups_vacuumed,
+								   double *tups_recently_dead)
+{
+	Snapshot	snapshot;
+	TableScanDesc scan;
+	TupleTableSlot *slot;
+	ColumnarWriteState *writer;
+
+	if (OldIndex != NULL || use_sort)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("clustering columnar tables is not supported")));
+
+	*num_tuples = 0;
+	*tups_vacuumed = 0;
+	*tups_recently_dead = 0;
+
+	snapshot = RegisterSnapshot(GetLatestSnapshot());
+	scan = columnar_beginscan(OldTable, snapshot, 0, NULL, NULL,
+							  SO_TYPE_SEQSCAN | SO_ALLOW_PAGEMODE);
+	slot = table_slot_create(OldTable, NULL);
+	writer = columnar_begin_write(NewTable, columnar_storage_id(NewTable));
+
+	while (columnar_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		CHECK_FOR_INTERRUPTS();
+		columnar_write_row(writer, slot);
+		*num_tuples += 1;
+	}
+
+	columnar_end_write(writer);
+	ExecDropSingleTupleTableSlot(slot);
+	columnar_endscan(scan);
+	UnregisterSnapshot(snapshot);
+
+	/* the old storage goes away with the transient table */
+	columnar_storage_delete(columnar_storage_id(OldTable), NULL);
+}
+
+static bool
+columnar_scan_analyze_next_block(TableScanDesc sscan, ReadStream *stream)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	return heap_methods->scan_analyze_next_block(scan->delta_scan, stream);
+}
+
+static bool
+columnar_scan_analyze_next_tuple(TableScanDesc sscan, TransactionId OldestXmin,
+								 double *liverows, double *deadrows,
+								 TupleTableSlot *slot)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	return heap_methods->scan_analyze_next_tuple(scan->delta_scan, OldestXmin,
+												 liverows, deadrows, slot);
+}
+
+/* ------------------------------------------------------------------------
+ * Planner related callbacks
+ * ------------------------------------------------------------------------
+ */
+
+/*
+ * The delta store is estimated like a heap; add the segments' rows, and
+ * their compressed size as pages.
+ */
+static void
+columnar_estimate_rel_size(Relation rel, int32 *attr_widths,
+						   BlockNumber *pages, double *tuples,
+						   double *allvisfrac)
+{
+	Snapshot	snapshot;
+	double		segment_rows;
+	double		segment_bytes;
+
+	heap_methods->relation_estimate_size(rel, attr_widths, pages, tuples,
+										 allvisfrac);
+
+	snapshot = ActiveSnapshotSet() ? GetActiveSnapshot() :
+		GetCatalogSnapshot(RelationGetRelid(rel));
+	columnar_storage_estimate(columnar_storage_id(rel), snapshot,
+							  &segment_rows, &segment_bytes);
+
+	*tuples += segment_rows;
+	*pages += (BlockNumber) ceil(segment_bytes / BLCKSZ);
+}
+
+/* ------------------------------------------------------------------------
+ * Bitmap and sample scans: not supported
+ * ------------------------------------------------------------------------
+ */
+
+static bool
+columnar_scan_bitmap_next_tuple(TableScanDesc scan, TupleTableSlot *slot,
+								bool *recheck, uint64 *lossy_pages,
+								uint64 *exact_pages)
+{
+	columnar_indexes_not_supported();
+}
+
+static bool
+columnar_scan_sample_next_block(TableScanDesc scan,
+								struct SampleScanState *scanstate)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("TABLESAMPLE is not supported on columnar tables")));
+}
+
+static bool
+columnar_scan_sample_next_tuple(TableScanDesc scan,
+								struct SampleScanState *scanstate,
+								TupleTableSlot *slot)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("TABLESAMPLE is not supported on columnar tables")));
+}
+
+/* ------------------------------------------------------------------------
+ * Definition of the columnar table access method.
+ * ------------------------------------------------------------------------
+ */
+
+Datum
+columnar_handler(PG_FUNCTION_ARGS)
+{
+	if (heap_methods == NULL)
+	{
+		heap_methods = GetHeapamTableAmRoutine();
+
+		/* start from heapam's callbacks, which handle the delta store */
+		columnar_methods = *heap_methods;
+
+		columnar_methods.scan_begin = columnar_beginscan;
+		columnar_methods.scan_end = columnar_endscan;
+		columnar_methods.scan_rescan = columnar_rescan;
+		columnar_methods.scan_getnextslot = columnar_getnextslot;
+		columnar_methods.scan_set_tidrange = NULL;
+		columnar_methods.scan_getnextslot_tidrange = NULL;
+
+		columnar_methods.index_fetch_begin = columnar_index_fetch_begin;
+		columnar_methods.index_fetch_reset = columnar_index_fetch_reset;
+		columnar_methods.index_fetch_end = columnar_index_fetch_end;
+		columnar_methods.index_fetch_tuple = columnar_index_fetch_tuple;
+
+		columnar_methods.tuple_fetch_row_version = columnar_fetch_row_version;
+		columnar_methods.tuple_tid_valid = columnar_tuple_tid_valid;
+		columnar_methods.tuple_get_latest_tid = columnar_get_latest_tid;
+		columnar_methods.tuple_satisfies_snapshot = columnar_tuple_satisfies_snapshot;
+		columnar_methods.index_delete_tuples = columnar_index_delete_tuples;
+
+		columnar_methods.tuple_delete = columnar_tuple_delete;
+		columnar_methods.tuple_update = columnar_tuple_update;
+		columnar_methods.tuple_lock = columnar_tuple_lock;
+
+		columnar_methods.relation_set_new_filelocator = columnar_relation_set_new_filelocator;
+		columnar_methods.relation_nontransactional_truncate = columnar_relation_nontransactional_truncate;
+		columnar_methods.relation_copy_data = columnar_relation_copy_data;
+		columnar_methods.relation_copy_for_cluster = columnar_relation_copy_for_cluster;
+		columnar_methods.scan_analyze_next_block = columnar_scan_analyze_next_block;
+		columnar_methods.scan_analyze_next_tuple = columnar_scan_analyze_next_tuple;
+		columnar_methods.index_build_range_scan = columnar_index_build_range_scan;
+		columnar_methods.index_validate_scan = columnar_index_validate_scan;
+
+		columnar_methods.relation_estimate_size = columnar_estimate_rel_size;
+
+		columnar_methods.scan_bitmap_next_tuple = columnar_scan_bitmap_next_tuple;
+		columnar_methods.scan_sample_next_block = columnar_scan_sample_next_block;
+		columnar_methods.scan_sample_next_tuple = columnar_scan_sample_next_tuple;
+	}
+
+	PG_RETURN_POINTER(&columnar_methods);
+}
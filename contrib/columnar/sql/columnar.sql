@@ -0,0 +1,65 @@
+CREATE EXTENSION columnar;
+
+SET columnar.segment_row_count = 1000;
+
+CREATE TABLE col (a int, b text, c int) USING columnar;
+INSERT INTO col SELECT i, 'row ' || i, i % 10 FROM generate_series(1, 2500) i;
+SELECT count(*), sum(a) FROM col;
+
+-- move the delta store to segments
+SELECT columnar.merge('col');
+SELECT segment_id, first_row, row_count FROM columnar.segments
+  WHERE relation = 'col'::regclass ORDER BY segment_id;
+SELECT count(*), sum(a), max(c) FROM col;
+
+-- new rows go to the delta store
+INSERT INTO col VALUES (3000, 'delta', 0);
+SELECT count(*), sum(a), max(a) FROM col;
+SELECT columnar.merge('col', 100);
+
+-- segment skipping
+EXPLAIN (COSTS OFF) SELECT a, b FROM col WHERE a > 2400;
+EXPLAIN (COSTS OFF) SELECT c FROM col WHERE 10 >= a;
+SELECT a, b FROM col WHERE a > 2497 ORDER BY a;
+SELECT a, b FROM col WHERE 3 >= a ORDER BY a;
+
+-- modifying rows in segments
+UPDATE col SET b = 'updated' WHERE a = 10;
+DELETE FROM col WHERE a BETWEEN 11 AND 20;
+SELECT count(*) FROM col;
+SELECT a, b FROM col WHERE a BETWEEN 9 AND 21 ORDER BY a;
+
+-- without the custom scan
+SET columnar.enable_custom_scan = off;
+EXPLAIN (COSTS OFF) SELECT a FROM col;
+SELECT count(*), sum(a) FROM col;
+SELECT a, b FROM col WHERE a BETWEEN 9 AND 21 ORDER BY a;
+RESET columnar.enable_custom_scan;
+
+-- VACUUM FULL rewrites everything into segments
+VACUUM FULL col;
+SELECT count(*), sum(row_count) FROM columnar.segments
+  WHERE relation = 'col'::regclass;
+SELECT count(*), sum(a) FROM col;
+
+-- unsupported
+CREATE INDEX ON col (a);
+SELECT * FROM col TABLESAMPLE SYSTEM (10);
+
+TRUNCATE col;
+SELECT count(*) FROM col;
+SELECT count(*) FROM columnar.segments WHERE relation = 'col'::regclass;
+
+-- dropping the table removes its segments
+INSERT INTO col SELECT i, 'x', 0 FROM generate_series(1, 10) i;
+SELECT columnar.merge('col');
+DROP TABLE col;
+SELECT count(*) FROM columnar.segment;
+SELECT columnar.cleanup();
+
+-- temporary tables dropped other than by DROP TABLE lose their segments too
+CREATE TEMP TABLE col_temp (a int) USING columnar;
+INSERT INTO col_temp SELECT i FROM generate_series(1, 10) i;
+SELECT columnar.merge('col_temp');
+DISCARD TEMP;
+SELECT count(*) FROM columnar.segment;
@@ -0,0 +1,62 @@
+--
+-- Binary I/O of Oracle datatypes, as used by binary COPY and by logical
+-- replication subscriptions with binary = true
+--
+
+-- directory paths are passed to us in environment variables
+\getenv abs_builddir PG_ABS_BUILDDIR
+
+SET NLS_DATE_FORMAT = 'YYYY-MM-DD HH24:MI:SS';
+SET NLS_TIMESTAMP_FORMAT = 'YYYY-MM-DD HH24:MI:SS.FF9';
+SET NLS_TIMESTAMP_TZ_FORMAT = 'YYYY-MM-DD HH24:MI:SS.FF9';
+
+-- dates and intervals use the same binary format as timestamp and interval
+SELECT sys.oradate_send('2000-01-02 00:00:00'::date) AS oradate;
+SELECT sys.yminterval_send(INTERVAL '1-2' YEAR TO MONTH) AS yminterval;
+SELECT sys.dsinterval_send(INTERVAL '1 2:03:04.5' DAY TO SECOND) AS dsinterval;
+
+CREATE TABLE ora_binary_io (
+	id int,
+	c char(5),
+	vc varchar2(10),
+	n number(12,3),
+	bf binary_float,
+	bd binary_double,
+	d date,
+	ts timestamp,
+	tstz timestamp with time zone,
+	tsltz timestamp with local time zone,
+	ym interval year to month,
+	ds interval day to second,
+	r raw(8),
+	cl clob);
+
+INSERT INTO ora_binary_io VALUES
+	(1, 'ab', 'abc', 123456789.125, 1.5, 2.25,
+	 '2024-02-29 12:34:56', '2024-02-29 12:34:56.123456',
+	 '2024-02-29 12:34:56.123456', '2024-02-29 12:34:56.123456',
+	 INTERVAL '12-3' YEAR TO MONTH, INTERVAL '4 5:12:10.222' DAY TO SECOND,
+	 '0102FEFF', 'clob value'),
+	(2, 'xyzzy', 'x', -0.001, -3.5e10, 1e-300,
+	 '1899-12-31 23:59:59', '1850-01-01 00:00:00.000001',
+	 '2099-12-31 23:59:59.999999', '1970-01-01 00:00:00',
+	 INTERVAL '-1-1' YEAR TO MONTH, INTERVAL '-1 2:00:00.5' DAY TO SECOND,
+	 '00', 'x'),
+	(3, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+	 NULL, NULL);
+
+\set filename :abs_builddir '/results/ora_binary_io.data'
+COPY ora_binary_io TO :'filename' WITH (FORMAT binary);
+CREATE TABLE ora_binary_io_copy (LIKE ora_binary_io);
+COPY ora_binary_io_copy FROM :'filename' WITH (FORMAT binary);
+
+-- every value survives the round trip
+SELECT a.id,
+	   a.c = b.c AS c, a.vc = b.vc AS vc, a.n = b.n AS n,
+	   a.bf = b.bf AS bf, a.bd = b.bd AS bd, a.d = b.d AS d,
+	   a.ts = b.ts AS ts, a.tstz = b.tstz AS tstz, a.tsltz = b.tsltz AS tsltz,
+	   a.ym = b.ym AS ym, a.ds = b.ds AS ds, a.r = b.r AS r, a.cl = b.cl AS cl
+FROM ora_binary_io a JOIN ora_binary_io_copy b ON a.id = b.id
+ORDER BY a.id;
+
+DROP TABLE ora_binary_io, ora_binary_io_copy;
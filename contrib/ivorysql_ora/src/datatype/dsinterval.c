@@ -1871,11 +1871,7 @@ dsinterval_recv(PG_FUNCTION_ARGS)
 
 	interval = (Interval *) palloc(sizeof(Interval));
 
-#ifdef HAVE_INT64_TIMESTAMP
 	interval->time = pq_getmsgint64(buf);
-#else
-	interval->time = pq_getmsgfloat8(buf);
-#endif
 	interval->day = pq_getmsgint(buf, sizeof(interval->day));
 	interval->month = pq_getmsgint(buf, sizeof(interval->month));
 
@@ -1895,11 +1891,7 @@ dsinterval_send(PG_FUNCTION_ARGS)
 	StringInfoData buf;
 
 	pq_begintypsend(&buf);
-#ifdef HAVE_INT64_TIMESTAMP
 	pq_sendint64(&buf, interval->time);
-#else
-	pq_sendfloat8(&buf, interval->time);
-#endif
 	pq_sendint(&buf, interval->day, sizeof(interval->day));
 	pq_sendint(&buf, interval->month, sizeof(interval->month));
 	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
@@ -221,8 +221,8 @@ oradate_out(PG_FUNCTION_ARGS)
  * oradate_recv()
  * Convert external binary format to oradate.
  *
- * We make no attempt to provide compatibility
- * between int and float timestamp representations.
+ * The format is the same as for timestamp, so that oradate can be
+ * exchanged in binary with clients and logical replication subscribers.
  */
 Datum
 oradate_recv(PG_FUNCTION_ARGS)
@@ -234,16 +234,7 @@ oradate_recv(PG_FUNCTION_ARGS)
 			   *tm = &tt;
 	fsec_t		fsec;
 
-#ifdef HAVE_INT64_TIMESTAMP
 	timestamp = (Timestamp) pq_getmsgint64(buf);
-#else
-	timestamp = (Timestamp) pq_getmsgfloat8(buf);
-
-	if (isnan(timestamp))
-		ereport(ERROR,
-				(errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
-				 errmsg("date cannot be NaN")));
-#endif
 
 	/* rangecheck: see if timestamp_out would like it */
 	if (TIMESTAMP_NOT_FINITE(timestamp))
@@ -268,11 +259,7 @@ oradate_send(PG_FUNCTION_ARGS)
 	StringInfoData buf;
 
 	pq_begintypsend(&buf);
-#ifdef HAVE_INT64_TIMESTAMP
 	pq_sendint64(&buf, timestamp);
-#else
-	pq_sendfloat8(&buf, timestamp);
-#endif
 	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
 }
 
@@ -0,0 +1,36 @@
+-- predictability
+SET synchronous_commit = on;
+
+-- decoding with WAL read by a background worker
+SET logical_decoding_read_worker = on;
+
+SELECT 'init' FROM pg_create_logical_replication_slot('regression_slot', 'test_decoding');
+
+CREATE TABLE read_worker_tbl (id int PRIMARY KEY, data text);
+
+-- a checkpoint first, so the changes below carry full-page images
+CHECKPOINT;
+INSERT INTO read_worker_tbl VALUES (1, 'one'), (2, 'two');
+UPDATE read_worker_tbl SET data = 'deux' WHERE id = 2;
+DELETE FROM read_worker_tbl WHERE id = 1;
+BEGIN;
+INSERT INTO read_worker_tbl SELECT g, repeat('x', 3000) FROM generate_series(3, 4) g;
+SAVEPOINT s1;
+INSERT INTO read_worker_tbl VALUES (5, 'five');
+ROLLBACK TO SAVEPOINT s1;
+COMMIT;
+
+SELECT regexp_replace(data, 'x{3000}', 'x*3000') AS data
+FROM pg_logical_slot_get_changes('regression_slot', NULL, NULL, 'include-xids', '0', 'skip-empty-xacts', '1');
+
+-- nothing left to decode, peeking from the confirmed position
+SELECT count(*) FROM pg_logical_slot_peek_changes('regression_slot', NULL, NULL, 'include-xids', '0', 'skip-empty-xacts', '1');
+
+-- same output when reading in the decoding backend itself
+INSERT INTO read_worker_tbl VALUES (6, 'six');
+SELECT data FROM pg_logical_slot_peek_changes('regression_slot', NULL, NULL, 'include-xids', '0', 'skip-empty-xacts', '1');
+SET logical_decoding_read_worker = off;
+SELECT data FROM pg_logical_slot_get_changes('regression_slot', NULL, NULL, 'include-xids', '0', 'skip-empty-xacts', '1');
+
+SELECT 'stop' FROM pg_drop_replication_slot('regression_slot');
+DROP TABLE read_worker_tbl;
@@ -174,6 +174,16 @@ SELECT (regexp_split_to_array(data, ':'))[4] COLLATE "C", COUNT(*), (array_agg(d
 FROM pg_logical_slot_get_changes('regression_slot', NULL,NULL) WHERE data ~ 'INSERT'
 GROUP BY 1 ORDER BY 1;
 
+-- spilling with compression; each block is compressed separately
+SET logical_decoding_spill_compression = pglz;
+BEGIN;
+INSERT INTO spill_test SELECT 'serialize-compressed--1:'||g.i FROM generate_series(1, 5000) g(i);
+COMMIT;
+SELECT (regexp_split_to_array(data, ':'))[4] COLLATE "C", COUNT(*), (array_agg(data))[1], (array_agg(data))[count(*)]
+FROM pg_logical_slot_get_changes('regression_slot', NULL,NULL) WHERE data ~ 'INSERT'
+GROUP BY 1 ORDER BY 1;
+RESET logical_decoding_spill_compression;
+
 DROP TABLE spill_test;
 
 SELECT pg_drop_replication_slot('regression_slot');
@@ -60,6 +60,9 @@ mask_page_hint_bits(Page page)
 	 * details.
 	 */
 	PageClearAllVisible(page);
+
+	/* The compression method is a hint as well */
+	PageSetCompression(page, PAGE_COMPRESSION_NONE);
 }
 
 /*
@@ -89,6 +89,19 @@
  * is only used during VACUUM, which uses a ShareUpdateExclusiveLock,
  * so the VACUUM will not be affected by in-flight changes. Changing its
  * value has no effect until the next VACUUM, so no need for stronger lock.
+ *
+ * index_organized can be set at ShareUpdateExclusiveLock because it only
+ * steers where later inserts and rewrites place tuples; tuples already in
+ * the table are not affected.
+ *
+ * page_compression can be set at ShareUpdateExclusiveLock too: it is only
+ * looked at when tuples are added to a page, and pages are readable whether
+ * they were stored compressed or not.
+ *
+ * fast_refresh can be set at ShareUpdateExclusiveLock as well.  Change logs
+ * are only set up or removed by the next REFRESH, which takes a stronger
+ * lock, and the choice between refreshing on demand and at commit is made
+ * as each writing transaction commits.
  */
 
 static relopt_bool boolRelOpts[] =
@@ -120,6 +133,15 @@ static relopt_bool boolRelOpts[] =
 		},
 		false
 	},
+	{
+		{
+			"index_organized",
+			"Keeps the rows of this table in primary key order",
+			RELOPT_KIND_HEAP,
+			ShareUpdateExclusiveLock
+		},
+		false
+	},
 	{
 		{
 			"fastupdate",
@@ -498,6 +520,26 @@ static relopt_enum_elt_def StdRdOptIndexCleanupValues[] =
 	{(const char *) NULL}		/* list terminator */
 };
 
+/* values from PAGE_COMPRESSION_xxx */
+static relopt_enum_elt_def pageCompressionValues[] =
+{
+	{"none", PAGE_COMPRESSION_NONE},
+	{"pglz", PAGE_COMPRESSION_PGLZ},
+#ifdef USE_LZ4
+	{"lz4", PAGE_COMPRESSION_LZ4},
+#endif
+	{(const char *) NULL}		/* list terminator */
+};
+
+/* values from StdRdOptFastRefresh */
+static relopt_enum_elt_def StdRdOptFastRefreshValues[] =
+{
+	{"off", STDRD_OPTION_FAST_REFRESH_OFF},
+	{"demand", STDRD_OPTION_FAST_REFRESH_DEMAND},
+	{"commit", STDRD_OPTION_FAST_REFRESH_COMMIT},
+	{(const char *) NULL}		/* list terminator */
+};
+
 /* values from GistOptBufferingMode */
 static relopt_enum_elt_def gistBufferingOptValues[] =
 {
@@ -529,6 +571,32 @@ static relopt_enum enumRelOpts[] =
 		STDRD_OPTION_VACUUM_INDEX_CLEANUP_AUTO,
 		gettext_noop("Valid values are \"on\", \"off\", and \"auto\".")
 	},
+	{
+		{
+			"page_compression",
+			"Compression method for storing the pages of this table",
+			RELOPT_KIND_HEAP,
+			ShareUpdateExclusiveLock
+		},
+		pageCompressionValues,
+		PAGE_COMPRESSION_NONE,
+#ifdef USE_LZ4
+		gettext_noop("Valid values are \"none\", \"pglz\", and \"lz4\".")
+#else
+		gettext_noop("Valid values are \"none\" and \"pglz\".")
+#endif
+	},
+	{
+		{
+			"fast_refresh",
+			"Controls how a materialized view is refreshed from logged changes",
+			RELOPT_KIND_HEAP,
+			ShareUpdateExclusiveLock
+		},
+		StdRdOptFastRefreshValues,
+		STDRD_OPTION_FAST_REFRESH_OFF,
+		gettext_noop("Valid values are \"off\", \"demand\", and \"commit\".")
+	},
 	{
 		{
 			"buffering",
@@ -1911,6 +1979,12 @@ default_reloptions(Datum reloptions, bool validate, relopt_kind kind)
 		offsetof(StdRdOptions, autovacuum) + offsetof(AutoVacOpts, analyze_scale_factor)},
 		{"user_catalog_table", RELOPT_TYPE_BOOL,
 		offsetof(StdRdOptions, user_catalog_table)},
+		{"index_organized", RELOPT_TYPE_BOOL,
+		offsetof(StdRdOptions, index_organized)},
+		{"page_compression", RELOPT_TYPE_ENUM,
+		offsetof(StdRdOptions, page_compression)},
+		{"fast_refresh", RELOPT_TYPE_ENUM,
+		offsetof(StdRdOptions, fast_refresh)},
 		{"parallel_workers", RELOPT_TYPE_INT,
 		offsetof(StdRdOptions, parallel_workers)},
 		{"vacuum_index_cleanup", RELOPT_TYPE_ENUM,
@@ -2715,9 +2715,11 @@ heap_delete(Relation relation, ItemPointer tid,
 	/*
 	 * Forbid this during a parallel operation, lest it allocate a combo CID.
 	 * Other workers might need that combo CID for visibility checks, and we
-	 * have no provision for broadcasting it to them.
+	 * have no provision for broadcasting it to them.  The leader of a
+	 * parallel UPDATE or DELETE is exempt; the executor only runs one when no
+	 * tuple written by our transaction can be modified (see ExecutePlan).
 	 */
-	if (IsInParallelMode())
+	if (IsInParallelMode() && !IsParallelDMLLeader())
 		ereport(ERROR,
 				(errcode(ERRCODE_INVALID_TRANSACTION_STATE),
 				 errmsg("cannot delete tuples during a parallel operation")));
@@ -3212,9 +3214,11 @@ heap_update(Relation relation, ItemPointer otid, HeapTuple newtup,
 	/*
 	 * Forbid this during a parallel operation, lest it allocate a combo CID.
 	 * Other workers might need that combo CID for visibility checks, and we
-	 * have no provision for broadcasting it to them.
+	 * have no provision for broadcasting it to them.  The leader of a
+	 * parallel UPDATE or DELETE is exempt; the executor only runs one when no
+	 * tuple written by our transaction can be modified (see ExecutePlan).
 	 */
-	if (IsInParallelMode())
+	if (IsInParallelMode() && !IsParallelDMLLeader())
 		ereport(ERROR,
 				(errcode(ERRCODE_INVALID_TRANSACTION_STATE),
 				 errmsg("cannot update tuples during a parallel operation")));
@@ -23,6 +23,7 @@
 #include "access/heapam.h"
 #include "access/heaptoast.h"
 #include "access/multixact.h"
+#include "access/nbtree.h"
 #include "access/rewriteheap.h"
 #include "access/syncscan.h"
 #include "access/tableam.h"
@@ -44,6 +45,7 @@
 #include "storage/procarray.h"
 #include "storage/smgr.h"
 #include "utils/builtins.h"
+#include "utils/lsyscache.h"
 #include "utils/rel.h"
 
 static void reform_and_rewrite_tuple(HeapTuple tuple,
@@ -56,6 +58,9 @@ static bool SampleHeapTupleVisible(TableScanDesc scan, Buffer buffer,
 
 static BlockNumber heapam_scan_get_blocks_done(HeapScanDesc hscan);
 
+static void heapam_set_clustered_target(Relation relation,
+										TupleTableSlot *slot);
+
 static bool BitmapHeapScanNextBlock(TableScanDesc scan,
 									bool *recheck,
 									uint64 *lossy_pages, uint64 *exact_pages);
@@ -240,6 +245,128 @@ heapam_tuple_satisfies_snapshot(Relation rel, TupleTableSlot *slot,
  * ----------------------------------------------------------------------------
  */
 
+/*
+ * What inserts into an index-organized table need to know about its primary
+ * key.  It is kept in rd_amcache, so it is looked up once per relcache entry
+ * rather than on every insert.
+ */
+typedef struct HeapClusteredInsertInfo
+{
+	Oid			pkoid;			/* primary key index, or InvalidOid if there
+								 * is none that can be used */
+	AttrNumber	attnum;			/* its leading column */
+	Oid			collation;		/* and that column's collation */
+	RegProcedure le_proc;		/* "<=" of the column's btree opfamily */
+	RegProcedure gt_proc;		/* ">" of the same */
+} HeapClusteredInsertInfo;
+
+static HeapClusteredInsertInfo *
+heapam_clustered_insert_info(Relation relation)
+{
+	HeapClusteredInsertInfo info = {0};
+	Oid			pkoid;
+
+	if (relation->rd_amcache != NULL)
+		return (HeapClusteredInsertInfo *) relation->rd_amcache;
+
+	pkoid = RelationGetPrimaryKeyIndex(relation, false);
+	if (OidIsValid(pkoid))
+	{
+		Relation	pkrel = index_open(pkoid, AccessShareLock);
+		AttrNumber	attnum = pkrel->rd_index->indkey.values[0];
+
+		if (pkrel->rd_rel->relam == BTREE_AM_OID && attnum != InvalidAttrNumber)
+		{
+			Oid			opfamily = pkrel->rd_opfamily[0];
+			Oid			opcintype = pkrel->rd_opcintype[0];
+			Oid			le_opno;
+			Oid			gt_opno;
+
+			le_opno = get_opfamily_member(opfamily, opcintype, opcintype,
+										  BTLessEqualStrategyNumber);
+			gt_opno = get_opfamily_member(opfamily, opcintype, opcintype,
+										  BTGreaterStrategyNumber);
+			if (!OidIsValid(le_opno) || !OidIsValid(gt_opno))
+				elog(ERROR, "missing operator in opfamily %u for type %u",
+					 opfamily, opcintype);
+
+			info.pkoid = pkoid;
+			info.attnum = attnum;
+			info.collation = pkrel->rd_indcollation[0];
+			info.le_proc = get_opcode(le_opno);
+			info.gt_proc = get_opcode(gt_opno);
+		}
+		index_close(pkrel, AccessShareLock);
+	}
+
+	/*
+	 * Only now install the cache entry, as the lookups above may have
+	 * processed an invalidation that reset rd_amcache.
+	 */
+	relation->rd_amcache = MemoryContextAlloc(CacheMemoryContext,
+											  sizeof(HeapClusteredInsertInfo));
+	memcpy(relation->rd_amcache, &info, sizeof(HeapClusteredInsertInfo));
+
+	return (HeapClusteredInsertInfo *) relation->rd_amcache;
+}
+
+/*
+ * For an index-organized table, point the relation's insert target at the
+ * page holding the tuple's nearest neighbor in primary key order, so that
+ * RelationGetBufferForTuple tries that page first.  Like any other target,
+ * the page is only used if the tuple fits within its fillfactor.
+ *
+ * The neighbor is found by descending the primary key index on its leading
+ * column: the last entry not greater than the new key, or failing that the
+ * first entry greater than it.  Nothing is done if the table has no usable
+ * primary key or is still empty, in which case the usual target is kept.
+ */
+static void
+heapam_set_clustered_target(Relation relation, TupleTableSlot *slot)
+{
+	HeapClusteredInsertInfo *info = heapam_clustered_insert_info(relation);
+	Oid			pkoid = info->pkoid;
+	AttrNumber	attnum = info->attnum;
+	Oid			collation = info->collation;
+	RegProcedure procs[2] = {info->le_proc, info->gt_proc};
+	Relation	pkrel;
+	Datum		value;
+	bool		isnull;
+	ScanKeyData skey;
+	IndexScanDesc scan;
+	ItemPointer tid;
+	BlockNumber neighbor = InvalidBlockNumber;
+
+	/* info may go away with an invalidation, so it was copied above */
+	if (!OidIsValid(pkoid))
+		return;
+
+	value = slot_getattr(slot, attnum, &isnull);
+	Assert(!isnull);
+
+	pkrel = index_open(pkoid, AccessShareLock);
+	scan = index_beginscan(relation, pkrel, SnapshotAny, NULL, 1, 0);
+	for (int i = 0; i < 2 && neighbor == InvalidBlockNumber; i++)
+	{
+		/* look for a predecessor first, then for a successor */
+		ScanKeyEntryInitialize(&skey, 0, 1,
+							   (i == 0) ? BTLessEqualStrategyNumber :
+							   BTGreaterStrategyNumber,
+							   InvalidOid, collation, procs[i], value);
+		index_rescan(scan, &skey, 1, NULL, 0);
+
+		tid = index_getnext_tid(scan, (i == 0) ? BackwardScanDirection :
+								ForwardScanDirection);
+		if (tid != NULL)
+			neighbor = ItemPointerGetBlockNumber(tid);
+	}
+	index_endscan(scan);
+	index_close(pkrel, NoLock);
+
+	if (neighbor != InvalidBlockNumber)
+		RelationSetTargetBlock(relation, neighbor);
+}
+
 static void
 heapam_tuple_insert(Relation relation, TupleTableSlot *slot, CommandId cid,
 					int options, BulkInsertState bistate)
@@ -251,6 +378,10 @@ heapam_tuple_insert(Relation relation, TupleTableSlot *slot, CommandId cid,
 	slot->tts_tableOid = RelationGetRelid(relation);
 	tuple->t_tableOid = slot->tts_tableOid;
 
+	/* Place the tuple next to its primary key neighbor, if asked to */
+	if (bistate == NULL && RelationIsIndexOrganized(relation))
+		heapam_set_clustered_target(relation, slot);
+
 	/* Perform the insertion, and copy the resulting ItemPointer */
 	heap_insert(relation, tuple, cid, options, bistate);
 	ItemPointerCopy(&tuple->t_self, &slot->tts_tid);
@@ -274,6 +405,9 @@ heapam_tuple_insert_speculative(Relation relation, TupleTableSlot *slot,
 	HeapTupleHeaderSetSpeculativeToken(tuple->t_data, specToken);
 	options |= HEAP_INSERT_SPECULATIVE;
 
+	if (bistate == NULL && RelationIsIndexOrganized(relation))
+		heapam_set_clustered_target(relation, slot);
+
 	/* Perform the insertion, and copy the resulting ItemPointer */
 	heap_insert(relation, tuple, cid, options, bistate);
 	ItemPointerCopy(&tuple->t_self, &slot->tts_tid);
@@ -704,6 +704,7 @@ loop:
 		{
 			/* use this page as future insert target, too */
 			RelationSetTargetBlock(relation, targetBlock);
+			PageSetCompression(page, RelationGetPageCompression(relation));
 			return buffer;
 		}
 
@@ -881,5 +882,11 @@ loop:
 	 */
 	RelationSetTargetBlock(relation, targetBlock);
 
+	/*
+	 * Tell the storage manager how to store the page.  The bits are a hint
+	 * that isn't WAL-logged; the caller is about to dirty the page anyway.
+	 */
+	PageSetCompression(page, RelationGetPageCompression(relation));
+
 	return buffer;
 }
@@ -670,6 +670,7 @@ raw_heap_insert(RewriteState state, HeapTuple tup)
 		state->rs_buffer = smgr_bulk_get_buf(state->rs_bulkstate);
 		page = (Page) state->rs_buffer;
 		PageInit(page, BLCKSZ, 0);
+		PageSetCompression(page, RelationGetPageCompression(state->rs_new_rel));
 	}
 
 	/* And now we can insert the tuple into the page */
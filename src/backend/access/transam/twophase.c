@@ -104,6 +104,8 @@
 #include "storage/procarray.h"
 #include "utils/builtins.h"
 #include "utils/memutils.h"
+#include "utils/sharedcatcache.h"
+#include "utils/sharedplancache.h"
 #include "utils/timestamp.h"
 
 /*
@@ -1557,6 +1559,10 @@ FinishPreparedTransaction(const char *gid, bool isCommit)
 	 * callbacks will release the locks the transaction held.
 	 */
 	if (isCommit)
+	{
+		/* the shared cache invalidation below can't attach to the caches */
+		SharedCatCachePrepareInvalidate();
+		SharedPlanCachePrepareInvalidate();
 		RecordTransactionCommitPrepared(xid,
 										hdr->nsubxacts, children,
 										hdr->ncommitrels, commitrels,
@@ -1564,6 +1570,7 @@ FinishPreparedTransaction(const char *gid, bool isCommit)
 										commitstats,
 										hdr->ninvalmsgs, invalmsgs,
 										hdr->initfileinval, gid);
+	}
 	else
 		RecordTransactionAbortPrepared(xid,
 									   hdr->nsubxacts, children,
@@ -1621,6 +1628,8 @@ FinishPreparedTransaction(const char *gid, bool isCommit)
 	{
 		if (hdr->initfileinval)
 			RelationCacheInitFilePreInvalidate();
+		SharedCatCacheInvalidate(invalmsgs, hdr->ninvalmsgs);
+		SharedPlanCacheInvalidate(invalmsgs, hdr->ninvalmsgs);
 		SendSharedInvalidMessages(invalmsgs, hdr->ninvalmsgs);
 		if (hdr->initfileinval)
 			RelationCacheInitFilePostInvalidate();
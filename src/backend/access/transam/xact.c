@@ -36,6 +36,7 @@
 #include "catalog/pg_enum.h"
 #include "catalog/storage.h"
 #include "commands/async.h"
+#include "commands/matview.h"
 #include "commands/tablecmds.h"
 #include "commands/trigger.h"
 #include "common/pg_prng.h"
@@ -65,6 +66,7 @@
 #include "utils/combocid.h"
 #include "utils/guc.h"
 #include "utils/inval.h"
+#include "utils/membroker.h"
 #include "utils/memutils.h"
 #include "utils/relmapper.h"
 #include "utils/snapmgr.h"
@@ -188,7 +190,9 @@ typedef enum TBlockState
  *
  * Note: parallelModeLevel counts the number of unmatched EnterParallelMode
  * calls done at this transaction level.  parallelChildXact is true if any
- * upper transaction level has nonzero parallelModeLevel.
+ * upper transaction level has nonzero parallelModeLevel.  parallelDMLLeader
+ * is true while this transaction level runs a parallel UPDATE or DELETE, in
+ * which the leader may modify tuples although it is in parallel mode.
  */
 typedef struct TransactionStateData
 {
@@ -213,6 +217,7 @@ typedef struct TransactionStateData
 	bool		didLogXid;		/* has xid been included in WAL record? */
 	int			parallelModeLevel;	/* Enter/ExitParallelMode counter */
 	bool		parallelChildXact;	/* is any parent transaction parallel? */
+	bool		parallelDMLLeader;	/* may the leader write in parallel mode? */
 	bool		chain;			/* start a new block after this one */
 	bool		topXidLogged;	/* for a subxact: is top-level XID logged? */
 	struct TransactionStateData *parent;	/* back link to parent */
@@ -1070,6 +1075,43 @@ ExitParallelMode(void)
 		   !ParallelContextActive());
 
 	--s->parallelModeLevel;
+	if (s->parallelModeLevel == 0)
+		s->parallelDMLLeader = false;
+}
+
+/*
+ *	EnterParallelModeForDML
+ *
+ * Like EnterParallelMode, but the leader stays allowed to update and delete
+ * tuples, as needed for a parallel UPDATE or DELETE in which the workers only
+ * scan.  The caller is responsible for making sure the leader can't need to
+ * allocate a combo CID that the workers would have to know about, and must
+ * have assigned the transaction ID beforehand.
+ */
+void
+EnterParallelModeForDML(void)
+{
+	TransactionState s = CurrentTransactionState;
+
+	Assert(s->parallelModeLevel == 0 && !s->parallelChildXact);
+	Assert(FullTransactionIdIsValid(s->fullTransactionId));
+	Assert(!IsParallelWorker());
+
+	EnterParallelMode();
+	s->parallelDMLLeader = true;
+}
+
+/*
+ *	IsParallelDMLLeader
+ *
+ * Is this the leader of a parallel UPDATE or DELETE, at the transaction level
+ * that started it?  Lower-level code that refuses to modify tuples during a
+ * parallel operation makes an exception in that case.
+ */
+bool
+IsParallelDMLLeader(void)
+{
+	return CurrentTransactionState->parallelDMLLeader;
 }
 
 /*
@@ -2261,6 +2303,13 @@ CommitTransaction(void)
 		 */
 		AfterTriggerFireDeferred();
 
+		/*
+		 * Refresh the materialized views with fast_refresh = commit whose
+		 * base tables we changed.
+		 */
+		if (!is_parallel_worker)
+			PreCommit_MatViewRefresh();
+
 		/*
 		 * Close open portals (converting holdable ones into static portals).
 		 * If there weren't any, we are done ... otherwise loop back to check
@@ -2338,6 +2387,9 @@ CommitTransaction(void)
 	if (!is_parallel_worker)
 		PreCommit_CheckForSerializationFailure();
 
+	/* Get ready to send invalidation messages once committed */
+	PreCommit_Inval();
+
 	/* Prevent cancel/die interrupt while cleaning up */
 	HOLD_INTERRUPTS();
 
@@ -2351,6 +2403,7 @@ CommitTransaction(void)
 	s->state = TRANS_COMMIT;
 	s->parallelModeLevel = 0;
 	s->parallelChildXact = false;	/* should be false already */
+	s->parallelDMLLeader = false;
 
 	/* Disable transaction timeout */
 	if (TransactionTimeout > 0)
@@ -2472,6 +2525,7 @@ CommitTransaction(void)
 	AtEOXact_Files(true);
 	AtEOXact_ComboCid();
 	AtEOXact_HashTables(true);
+	AtEOXact_MemoryBroker(true);
 	AtEOXact_PgStat(true, is_parallel_worker);
 	AtEOXact_Snapshot(true, false);
 	AtEOXact_ApplyLauncher(true);
@@ -2625,6 +2679,15 @@ PrepareTransaction(void)
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
 				 errmsg("cannot PREPARE a transaction that has exported snapshots")));
 
+	/*
+	 * Refreshing a materialized view at commit works in a temporary table,
+	 * so it can't be part of a prepared transaction either.
+	 */
+	if (MatViewRefreshPending())
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot PREPARE a transaction that has modified base tables of a materialized view with fast_refresh = commit")));
+
 	/* Prevent cancel/die interrupt while cleaning up */
 	HOLD_INTERRUPTS();
 
@@ -2766,6 +2829,7 @@ PrepareTransaction(void)
 	AtEOXact_Files(true);
 	AtEOXact_ComboCid();
 	AtEOXact_HashTables(true);
+	AtEOXact_MemoryBroker(true);
 	/* don't call AtEOXact_PgStat here; we fixed pgstat state above */
 	AtEOXact_Snapshot(true, true);
 	/* we treat PREPARE as ROLLBACK so far as waking workers goes */
@@ -2911,6 +2975,7 @@ AbortTransaction(void)
 	AtEOXact_Parallel(false);
 	s->parallelModeLevel = 0;
 	s->parallelChildXact = false;	/* should be false already */
+	s->parallelDMLLeader = false;
 
 	/*
 	 * do abort processing
@@ -2990,6 +3055,7 @@ AbortTransaction(void)
 		AtEOXact_Files(false);
 		AtEOXact_ComboCid();
 		AtEOXact_HashTables(false);
+		AtEOXact_MemoryBroker(false);
 		AtEOXact_PgStat(false, is_parallel_worker);
 		AtEOXact_ApplyLauncher(false);
 		AtEOXact_LogicalRepWorkers(false);
@@ -3041,6 +3107,7 @@ CleanupTransaction(void)
 	s->maxChildXids = 0;
 	s->parallelModeLevel = 0;
 	s->parallelChildXact = false;
+	s->parallelDMLLeader = false;
 
 	XactTopFullTransactionId = InvalidFullTransactionId;
 	nParallelCurrentXids = 0;
@@ -5127,6 +5194,7 @@ CommitSubTransaction(void)
 		elog(WARNING, "parallelModeLevel is %d not 0 at end of subtransaction",
 			 s->parallelModeLevel);
 		s->parallelModeLevel = 0;
+		s->parallelDMLLeader = false;
 	}
 
 	/* Do the actual "commit", such as it is */
@@ -5191,6 +5259,7 @@ CommitSubTransaction(void)
 	AtEOSubXact_Files(true, s->subTransactionId,
 					  s->parent->subTransactionId);
 	AtEOSubXact_HashTables(true, s->nestingLevel);
+	AtEOSubXact_MemoryBroker(true, s->nestingLevel);
 	AtEOSubXact_PgStat(true, s->nestingLevel);
 	AtSubCommit_Snapshot(s->nestingLevel);
 
@@ -5308,6 +5377,7 @@ AbortSubTransaction(void)
 	 */
 	AtEOSubXact_Parallel(false, s->subTransactionId);
 	s->parallelModeLevel = 0;
+	s->parallelDMLLeader = false;
 
 	/*
 	 * We can skip all this stuff if the subxact failed before creating a
@@ -5360,6 +5430,7 @@ AbortSubTransaction(void)
 		AtEOSubXact_Files(false, s->subTransactionId,
 						  s->parent->subTransactionId);
 		AtEOSubXact_HashTables(false, s->nestingLevel);
+		AtEOSubXact_MemoryBroker(false, s->nestingLevel);
 		AtEOSubXact_PgStat(false, s->nestingLevel);
 		AtSubAbort_Snapshot(s->nestingLevel);
 	}
@@ -5456,6 +5527,7 @@ PushTransaction(void)
 	s->startedInRecovery = p->startedInRecovery;
 	s->parallelModeLevel = 0;
 	s->parallelChildXact = (p->parallelModeLevel != 0 || p->parallelChildXact);
+	s->parallelDMLLeader = false;
 	s->topXidLogged = false;
 
 	CurrentTransactionState = s;
@@ -28,6 +28,7 @@
 #include "common/compression.h"
 #include "common/file_perm.h"
 #include "common/file_utils.h"
+#include "common/pagecompress.h"
 #include "lib/stringinfo.h"
 #include "miscadmin.h"
 #include "nodes/pg_list.h"
@@ -1996,6 +1997,22 @@ verify_page_checksum(Page page, XLogRecPtr start_lsn, BlockNumber blkno,
 {
 	PageHeader	phdr;
 	uint16		checksum;
+	PGAlignedBlock copy;
+
+	/*
+	 * A page stored compressed is checked as it is in memory; the file is
+	 * sent as it is on disk.  A page that can't be decompressed fails.
+	 */
+	if (page_is_compressed(page))
+	{
+		memcpy(copy.data, page, BLCKSZ);
+		if (!page_decompress(copy.data))
+		{
+			*expected_checksum = 0;
+			return false;
+		}
+		page = copy.data;
+	}
 
 	/*
 	 * Only check pages which have not been modified since the start of the
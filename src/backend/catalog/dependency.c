@@ -1133,25 +1133,11 @@ findDependentObjects(const ObjectAddress *object,
 				}
 				break;
 			case PackageRelationId:
-				{
-					PackageCacheKey pkey;
-					PackageCacheItem *item;
-
-					pkey = objectId;
-
-					if (PackageCacheIsValid(&pkey, false))
-						item = PackageCacheLookup(&pkey);
-					else
-						item = PackageHandle(pkey, false);
-
-					if (item != NULL)
-						item->cachestatus = PACKAGE_SET_SPECIFICATION_UPDATE_FLAG(item->cachestatus);
-				}
+				PackageCacheMarkUpdated(objectId, false);
 				break;
 			case PackageBodyRelationId:
 				{
 					PackageCacheKey pkey;
-					PackageCacheItem *item;
 					HeapTuple	pkgbodyTup;
 					Form_pg_package_body pkgbodyStruct;
 
@@ -1165,13 +1151,7 @@ findDependentObjects(const ObjectAddress *object,
 					pkgbodyStruct = (Form_pg_package_body) GETSTRUCT(pkgbodyTup);
 					pkey = pkgbodyStruct->pkgoid;
 
-					if (PackageCacheIsValid(&pkey, false))
-						item = PackageCacheLookup(&pkey);
-					else
-						item = PackageHandle(pkey, false);
-
-					if (item != NULL)
-						item->cachestatus = PACKAGE_SET_BODY_UPDATE_FLAG(item->cachestatus);
+					PackageCacheMarkUpdated(pkey, true);
 
 					ReleaseSysCache(pkgbodyTup);
 				}
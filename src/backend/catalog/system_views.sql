@@ -424,6 +424,20 @@ CREATE VIEW pg_prepared_xacts AS
 CREATE VIEW pg_prepared_statements AS
     SELECT * FROM pg_prepared_statement() AS P;
 
+CREATE VIEW pg_package_cache_stats AS
+    SELECT
+        S.pkgoid,
+        N.nspname AS schemaname,
+        P.pkgname AS packagename,
+        S.valid,
+        S.invalidations,
+        S.compiles,
+        S.compile_time,
+        S.last_invalidation
+    FROM pg_get_package_cache_stats() AS S
+         LEFT JOIN pg_package P ON (P.oid = S.pkgoid)
+         LEFT JOIN pg_namespace N ON (N.oid = P.pkgnamespace);
+
 CREATE VIEW pg_seclabels AS
 SELECT
     l.objoid, l.classoid, l.objsubid,
@@ -674,6 +688,38 @@ GRANT SELECT ON pg_backend_memory_contexts TO pg_read_all_stats;
 REVOKE EXECUTE ON FUNCTION pg_get_backend_memory_contexts() FROM PUBLIC;
 GRANT EXECUTE ON FUNCTION pg_get_backend_memory_contexts() TO pg_read_all_stats;
 
+CREATE VIEW pg_active_session_history AS
+    SELECT
+            S.sample_time,
+            S.pid,
+            S.backend_type,
+            S.datid,
+            D.datname,
+            S.usesysid,
+            U.rolname AS usename,
+            S.state,
+            S.wait_event_type,
+            S.wait_event,
+            S.on_cpu,
+            S.query_id,
+            S.plan_id
+    FROM pg_get_active_session_history() AS S
+        LEFT JOIN pg_database AS D ON (S.datid = D.oid)
+        LEFT JOIN pg_authid AS U ON (S.usesysid = U.oid);
+
+REVOKE ALL ON pg_active_session_history FROM PUBLIC;
+GRANT SELECT ON pg_active_session_history TO pg_read_all_stats;
+REVOKE EXECUTE ON FUNCTION pg_get_active_session_history() FROM PUBLIC;
+GRANT EXECUTE ON FUNCTION pg_get_active_session_history() TO pg_read_all_stats;
+
+CREATE VIEW pg_memory_grants AS
+    SELECT * FROM pg_get_memory_grants();
+
+REVOKE ALL ON pg_memory_grants FROM PUBLIC;
+GRANT SELECT ON pg_memory_grants TO pg_read_all_stats;
+REVOKE EXECUTE ON FUNCTION pg_get_memory_grants() FROM PUBLIC;
+GRANT EXECUTE ON FUNCTION pg_get_memory_grants() TO pg_read_all_stats;
+
 -- Statistics views
 
 CREATE VIEW pg_stat_all_tables AS
@@ -993,6 +1039,22 @@ CREATE VIEW pg_stat_subscription AS
             LEFT JOIN pg_stat_get_subscription(NULL) st
                       ON (st.subid = su.oid);
 
+CREATE VIEW pg_stat_subscription_copy AS
+    SELECT
+            su.oid AS subid,
+            su.subname,
+            st.relid,
+            st.pid,
+            st.leader_pid,
+            st.range_start,
+            st.range_end,
+            st.ranges_done,
+            st.ranges_total,
+            st.tuples_copied
+    FROM pg_subscription su
+            JOIN pg_stat_get_subscription_copy(NULL) st
+                 ON (st.subid = su.oid);
+
 CREATE VIEW pg_stat_ssl AS
     SELECT
             S.pid,
@@ -1048,6 +1110,8 @@ CREATE VIEW pg_stat_replication_slots AS
             s.spill_txns,
             s.spill_count,
             s.spill_bytes,
+            s.spill_disk_bytes,
+            s.spill_write_time,
             s.stream_txns,
             s.stream_count,
             s.stream_bytes,
@@ -1407,3 +1471,294 @@ REVOKE ALL ON pg_aios FROM PUBLIC;
 GRANT SELECT ON pg_aios TO pg_read_all_stats;
 REVOKE EXECUTE ON FUNCTION pg_get_aios() FROM PUBLIC;
 GRANT EXECUTE ON FUNCTION pg_get_aios() TO pg_read_all_stats;
+
+--
+-- Workload repository
+--
+-- Snapshots of the cumulative statistics are kept in the pg_awr schema, and
+-- the pg_awr.report_* functions return the activity between two of them.
+-- Being a pg_ schema, pg_awr is not dumped.  Like the system catalogs, its
+-- tables use the "C" collation, so that template0 can be cloned with any
+-- other.
+--
+
+CREATE SCHEMA pg_awr;
+GRANT USAGE ON SCHEMA pg_awr TO PUBLIC;
+
+CREATE TABLE pg_awr.snapshots (
+    snap_id int8 GENERATED ALWAYS AS IDENTITY PRIMARY KEY,
+    snap_time timestamptz NOT NULL
+);
+
+CREATE TABLE pg_awr.stat_database (
+    snap_id int8 NOT NULL REFERENCES pg_awr.snapshots ON DELETE CASCADE,
+    datid oid NOT NULL,
+    datname name,
+    xact_commit int8,
+    xact_rollback int8,
+    blks_read int8,
+    blks_hit int8,
+    tup_returned int8,
+    tup_fetched int8,
+    tup_inserted int8,
+    tup_updated int8,
+    tup_deleted int8,
+    temp_bytes int8,
+    deadlocks int8,
+    blk_read_time float8,
+    blk_write_time float8,
+    active_time float8,
+    PRIMARY KEY (snap_id, datid)
+);
+
+CREATE TABLE pg_awr.stat_wal (
+    snap_id int8 PRIMARY KEY REFERENCES pg_awr.snapshots ON DELETE CASCADE,
+    wal_records int8,
+    wal_fpi int8,
+    wal_bytes numeric,
+    wal_buffers_full int8
+);
+
+CREATE TABLE pg_awr.stat_io (
+    snap_id int8 NOT NULL REFERENCES pg_awr.snapshots ON DELETE CASCADE,
+    backend_type text COLLATE "C" NOT NULL,
+    object text COLLATE "C" NOT NULL,
+    context text COLLATE "C" NOT NULL,
+    reads int8,
+    read_bytes numeric,
+    read_time float8,
+    writes int8,
+    write_bytes numeric,
+    write_time float8,
+    writebacks int8,
+    extends int8,
+    extend_bytes numeric,
+    hits int8,
+    evictions int8,
+    reuses int8,
+    fsyncs int8,
+    fsync_time float8
+);
+CREATE INDEX ON pg_awr.stat_io (snap_id);
+
+CREATE TABLE pg_awr.stat_tables (
+    snap_id int8 NOT NULL REFERENCES pg_awr.snapshots ON DELETE CASCADE,
+    relid oid NOT NULL,
+    schemaname name,
+    relname name,
+    seq_scan int8,
+    seq_tup_read int8,
+    idx_scan int8,
+    idx_tup_fetch int8,
+    n_tup_ins int8,
+    n_tup_upd int8,
+    n_tup_del int8,
+    heap_blks_read int8,
+    heap_blks_hit int8,
+    idx_blks_read int8,
+    idx_blks_hit int8,
+    PRIMARY KEY (snap_id, relid)
+);
+
+CREATE TABLE pg_awr.wait_samples (
+    snap_id int8 NOT NULL REFERENCES pg_awr.snapshots ON DELETE CASCADE,
+    wait_event_type text COLLATE "C",
+    wait_event text COLLATE "C",
+    samples int8 NOT NULL
+);
+CREATE INDEX ON pg_awr.wait_samples (snap_id);
+
+CREATE TABLE pg_awr.stat_statements (
+    snap_id int8 NOT NULL REFERENCES pg_awr.snapshots ON DELETE CASCADE,
+    userid oid NOT NULL,
+    dbid oid NOT NULL,
+    queryid int8 NOT NULL,
+    calls int8,
+    total_exec_time float8,
+    rows int8,
+    shared_blks_hit int8,
+    shared_blks_read int8,
+    shared_blks_written int8,
+    temp_blks_read int8,
+    temp_blks_written int8,
+    PRIMARY KEY (snap_id, userid, dbid, queryid)
+);
+
+CREATE TABLE pg_awr.statement_texts (
+    dbid oid NOT NULL,
+    queryid int8 NOT NULL,
+    query text COLLATE "C",
+    PRIMARY KEY (dbid, queryid)
+);
+
+GRANT SELECT ON ALL TABLES IN SCHEMA pg_awr TO pg_read_all_stats;
+
+REVOKE EXECUTE ON FUNCTION pg_awr_create_snapshot() FROM PUBLIC;
+REVOKE EXECUTE ON FUNCTION pg_awr_purge_snapshots(interval) FROM PUBLIC;
+
+-- Change of a counter between two snapshots.  A counter that went down was
+-- reset in between, so all of its value at the end counts.
+CREATE FUNCTION pg_awr.delta(e int8, b int8) RETURNS int8
+LANGUAGE sql IMMUTABLE PARALLEL SAFE
+RETURN CASE WHEN b IS NULL OR e < b THEN e ELSE e - b END;
+
+CREATE FUNCTION pg_awr.delta(e numeric, b numeric) RETURNS numeric
+LANGUAGE sql IMMUTABLE PARALLEL SAFE
+RETURN CASE WHEN b IS NULL OR e < b THEN e ELSE e - b END;
+
+CREATE FUNCTION pg_awr.delta(e float8, b float8) RETURNS float8
+LANGUAGE sql IMMUTABLE PARALLEL SAFE
+RETURN CASE WHEN b IS NULL OR e < b THEN e ELSE e - b END;
+
+CREATE FUNCTION pg_awr.report_database(begin_snap int8, end_snap int8)
+RETURNS TABLE (datid oid, datname name, xact_commit int8,
+    xact_rollback int8, blks_read int8, blks_hit int8, tup_returned int8,
+    tup_fetched int8, tup_inserted int8, tup_updated int8, tup_deleted int8,
+    temp_bytes int8, deadlocks int8, blk_read_time float8,
+    blk_write_time float8, active_time float8)
+LANGUAGE sql STABLE
+BEGIN ATOMIC
+    SELECT e.datid, e.datname,
+           pg_awr.delta(e.xact_commit, b.xact_commit),
+           pg_awr.delta(e.xact_rollback, b.xact_rollback),
+           pg_awr.delta(e.blks_read, b.blks_read),
+           pg_awr.delta(e.blks_hit, b.blks_hit),
+           pg_awr.delta(e.tup_returned, b.tup_returned),
+           pg_awr.delta(e.tup_fetched, b.tup_fetched),
+           pg_awr.delta(e.tup_inserted, b.tup_inserted),
+           pg_awr.delta(e.tup_updated, b.tup_updated),
+           pg_awr.delta(e.tup_deleted, b.tup_deleted),
+           pg_awr.delta(e.temp_bytes, b.temp_bytes),
+           pg_awr.delta(e.deadlocks, b.deadlocks),
+           pg_awr.delta(e.blk_read_time, b.blk_read_time),
+           pg_awr.delta(e.blk_write_time, b.blk_write_time),
+           pg_awr.delta(e.active_time, b.active_time)
+    FROM pg_awr.stat_database e
+         LEFT JOIN pg_awr.stat_database b
+             ON b.snap_id = report_database.begin_snap AND b.datid = e.datid
+    WHERE e.snap_id = report_database.end_snap
+    ORDER BY e.datname;
+END;
+
+CREATE FUNCTION pg_awr.report_wal(begin_snap int8, end_snap int8)
+RETURNS TABLE (wal_records int8, wal_fpi int8, wal_bytes numeric,
+    wal_buffers_full int8)
+LANGUAGE sql STABLE
+BEGIN ATOMIC
+    SELECT pg_awr.delta(e.wal_records, b.wal_records),
+           pg_awr.delta(e.wal_fpi, b.wal_fpi),
+           pg_awr.delta(e.wal_bytes, b.wal_bytes),
+           pg_awr.delta(e.wal_buffers_full, b.wal_buffers_full)
+    FROM pg_awr.stat_wal e
+         LEFT JOIN pg_awr.stat_wal b ON b.snap_id = report_wal.begin_snap
+    WHERE e.snap_id = report_wal.end_snap;
+END;
+
+CREATE FUNCTION pg_awr.report_io(begin_snap int8, end_snap int8)
+RETURNS TABLE (backend_type text, object text, context text, reads int8,
+    read_bytes numeric, read_time float8, writes int8, write_bytes numeric,
+    write_time float8, writebacks int8, extends int8, extend_bytes numeric,
+    hits int8, evictions int8, reuses int8, fsyncs int8, fsync_time float8)
+LANGUAGE sql STABLE
+BEGIN ATOMIC
+    SELECT d.*
+    FROM (SELECT e.backend_type, e.object, e.context,
+                 pg_awr.delta(e.reads, b.reads) AS reads,
+                 pg_awr.delta(e.read_bytes, b.read_bytes) AS read_bytes,
+                 pg_awr.delta(e.read_time, b.read_time) AS read_time,
+                 pg_awr.delta(e.writes, b.writes) AS writes,
+                 pg_awr.delta(e.write_bytes, b.write_bytes) AS write_bytes,
+                 pg_awr.delta(e.write_time, b.write_time) AS write_time,
+                 pg_awr.delta(e.writebacks, b.writebacks) AS writebacks,
+                 pg_awr.delta(e.extends, b.extends) AS extends,
+                 pg_awr.delta(e.extend_bytes, b.extend_bytes) AS extend_bytes,
+                 pg_awr.delta(e.hits, b.hits) AS hits,
+                 pg_awr.delta(e.evictions, b.evictions) AS evictions,
+                 pg_awr.delta(e.reuses, b.reuses) AS reuses,
+                 pg_awr.delta(e.fsyncs, b.fsyncs) AS fsyncs,
+                 pg_awr.delta(e.fsync_time, b.fsync_time) AS fsync_time
+          FROM pg_awr.stat_io e
+               LEFT JOIN pg_awr.stat_io b
+                   ON b.snap_id = report_io.begin_snap AND
+                      b.backend_type = e.backend_type AND
+                      b.object = e.object AND b.context = e.context
+          WHERE e.snap_id = report_io.end_snap) d
+    WHERE COALESCE(d.reads, 0) + COALESCE(d.writes, 0) +
+          COALESCE(d.writebacks, 0) + COALESCE(d.extends, 0) +
+          COALESCE(d.hits, 0) + COALESCE(d.evictions, 0) +
+          COALESCE(d.reuses, 0) + COALESCE(d.fsyncs, 0) > 0
+    ORDER BY d.backend_type, d.object, d.context;
+END;
+
+CREATE FUNCTION pg_awr.report_tables(begin_snap int8, end_snap int8)
+RETURNS TABLE (relid oid, schemaname name, relname name, seq_scan int8,
+    seq_tup_read int8, idx_scan int8, idx_tup_fetch int8, n_tup_ins int8,
+    n_tup_upd int8, n_tup_del int8, heap_blks_read int8, heap_blks_hit int8,
+    idx_blks_read int8, idx_blks_hit int8)
+LANGUAGE sql STABLE
+BEGIN ATOMIC
+    SELECT e.relid, e.schemaname, e.relname,
+           pg_awr.delta(e.seq_scan, b.seq_scan),
+           pg_awr.delta(e.seq_tup_read, b.seq_tup_read),
+           pg_awr.delta(e.idx_scan, b.idx_scan),
+           pg_awr.delta(e.idx_tup_fetch, b.idx_tup_fetch),
+           pg_awr.delta(e.n_tup_ins, b.n_tup_ins),
+           pg_awr.delta(e.n_tup_upd, b.n_tup_upd),
+           pg_awr.delta(e.n_tup_del, b.n_tup_del),
+           pg_awr.delta(e.heap_blks_read, b.heap_blks_read),
+           pg_awr.delta(e.heap_blks_hit, b.heap_blks_hit),
+           pg_awr.delta(e.idx_blks_read, b.idx_blks_read),
+           pg_awr.delta(e.idx_blks_hit, b.idx_blks_hit)
+    FROM pg_awr.stat_tables e
+         LEFT JOIN pg_awr.stat_tables b
+             ON b.snap_id = report_tables.begin_snap AND b.relid = e.relid
+    WHERE e.snap_id = report_tables.end_snap
+    ORDER BY e.schemaname, e.relname;
+END;
+
+CREATE FUNCTION pg_awr.report_sql(begin_snap int8, end_snap int8)
+RETURNS TABLE (queryid int8, dbid oid, userid oid, calls int8,
+    total_exec_time float8, mean_exec_time float8, rows int8,
+    shared_blks_hit int8, shared_blks_read int8, shared_blks_written int8,
+    temp_blks_read int8, temp_blks_written int8, query text)
+LANGUAGE sql STABLE
+BEGIN ATOMIC
+    SELECT d.queryid, d.dbid, d.userid, d.calls, d.total_exec_time,
+           d.total_exec_time / d.calls, d.rows, d.shared_blks_hit,
+           d.shared_blks_read, d.shared_blks_written, d.temp_blks_read,
+           d.temp_blks_written, t.query
+    FROM (SELECT e.queryid, e.dbid, e.userid,
+                 pg_awr.delta(e.calls, b.calls) AS calls,
+                 pg_awr.delta(e.total_exec_time, b.total_exec_time) AS total_exec_time,
+                 pg_awr.delta(e.rows, b.rows) AS rows,
+                 pg_awr.delta(e.shared_blks_hit, b.shared_blks_hit) AS shared_blks_hit,
+                 pg_awr.delta(e.shared_blks_read, b.shared_blks_read) AS shared_blks_read,
+                 pg_awr.delta(e.shared_blks_written, b.shared_blks_written) AS shared_blks_written,
+                 pg_awr.delta(e.temp_blks_read, b.temp_blks_read) AS temp_blks_read,
+                 pg_awr.delta(e.temp_blks_written, b.temp_blks_written) AS temp_blks_written
+          FROM pg_awr.stat_statements e
+               LEFT JOIN pg_awr.stat_statements b
+                   ON b.snap_id = report_sql.begin_snap AND
+                      b.userid = e.userid AND b.dbid = e.dbid AND
+                      b.queryid = e.queryid
+          WHERE e.snap_id = report_sql.end_snap) d
+         LEFT JOIN pg_awr.statement_texts t
+             ON t.dbid = d.dbid AND t.queryid = d.queryid
+    WHERE d.calls > 0
+    ORDER BY d.total_exec_time DESC;
+END;
+
+CREATE FUNCTION pg_awr.report_waits(begin_snap int8, end_snap int8)
+RETURNS TABLE (wait_event_type text, wait_event text, samples int8,
+    percent numeric)
+LANGUAGE sql STABLE
+BEGIN ATOMIC
+    SELECT COALESCE(w.wait_event_type, 'CPU'), w.wait_event,
+           sum(w.samples)::int8,
+           round(100 * sum(w.samples) / sum(sum(w.samples)) OVER (), 2)
+    FROM pg_awr.wait_samples w
+    WHERE w.snap_id > report_waits.begin_snap AND
+          w.snap_id <= report_waits.end_snap
+    GROUP BY w.wait_event_type, w.wait_event
+    ORDER BY sum(w.samples) DESC, 1, 2;
+END;
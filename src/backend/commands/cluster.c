@@ -170,6 +170,10 @@ cluster(ParseState *pstate, ClusterStmt *stmt, bool isTopLevel)
 				indexOid = InvalidOid;
 			}
 
+			/* An index-organized table is clustered on its primary key */
+			if (!OidIsValid(indexOid) && RelationIsIndexOrganized(rel))
+				indexOid = RelationGetPrimaryKeyIndex(rel, false);
+
 			if (!OidIsValid(indexOid))
 				ereport(ERROR,
 						(errcode(ERRCODE_UNDEFINED_OBJECT),
@@ -306,6 +310,7 @@ cluster_multiple_rels(List *rtcs, ClusterParams *params)
  * If indexOid is InvalidOid, the table will be rewritten in physical order
  * instead of index order.  This is the new implementation of VACUUM FULL,
  * and error messages should refer to the operation as VACUUM not CLUSTER.
+ * An index-organized table is rewritten in primary key order even then.
  */
 void
 cluster_rel(Relation OldHeap, Oid indexOid, ClusterParams *params)
@@ -439,6 +444,15 @@ cluster_rel(Relation OldHeap, Oid indexOid, ClusterParams *params)
 		/* also open it */
 		index = index_open(indexOid, NoLock);
 	}
+	else if (RelationIsIndexOrganized(OldHeap) &&
+			 OidIsValid(RelationGetPrimaryKeyIndex(OldHeap, false)))
+	{
+		Oid			pkoid = RelationGetPrimaryKeyIndex(OldHeap, false);
+
+		/* keep an index-organized table in primary key order */
+		check_index_is_clusterable(OldHeap, pkoid, AccessExclusiveLock);
+		index = index_open(pkoid, NoLock);
+	}
 	else
 		index = NULL;
 
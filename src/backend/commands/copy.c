@@ -504,6 +504,8 @@ ProcessCopyOptions(ParseState *pstate,
 	bool		on_error_specified = false;
 	bool		log_verbosity_specified = false;
 	bool		reject_limit_specified = false;
+	bool		compression_specified = false;
+	char	   *compression_detail = NULL;
 	ListCell   *option;
 
 	/* Support external use for option sanity checking */
@@ -677,6 +679,27 @@ ProcessCopyOptions(ParseState *pstate,
 			reject_limit_specified = true;
 			opts_out->reject_limit = defGetCopyRejectLimitOption(defel);
 		}
+		else if (strcmp(defel->defname, "compression") == 0)
+		{
+			char	   *algorithm = defGetString(defel);
+
+			if (compression_specified)
+				errorConflictingDefElem(defel, pstate);
+			compression_specified = true;
+			if (!parse_compress_algorithm(algorithm,
+										  &opts_out->compression.algorithm))
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("unrecognized compression algorithm: \"%s\"",
+								algorithm),
+						 parser_errposition(pstate, defel->location)));
+		}
+		else if (strcmp(defel->defname, "compression_detail") == 0)
+		{
+			if (compression_detail)
+				errorConflictingDefElem(defel, pstate);
+			compression_detail = defGetString(defel);
+		}
 		else
 			ereport(ERROR,
 					(errcode(ERRCODE_SYNTAX_ERROR),
@@ -925,6 +948,38 @@ ProcessCopyOptions(ParseState *pstate,
 		 * ON_ERROR, third is the value of the COPY option, e.g. IGNORE */
 				 errmsg("COPY %s requires %s to be set to %s",
 						"REJECT_LIMIT", "ON_ERROR", "IGNORE")));
+
+	/* Check compression */
+	if (compression_detail &&
+		opts_out->compression.algorithm == PG_COMPRESSION_NONE)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+		/*- translator: first and second %s are the names of COPY options */
+				 errmsg("COPY %s requires %s", "COMPRESSION_DETAIL",
+						"COMPRESSION")));
+
+	if (opts_out->compression.algorithm != PG_COMPRESSION_NONE)
+	{
+		char	   *error_detail;
+
+		if (is_from)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			/*- translator: first %s is the name of a COPY option, e.g. ON_ERROR,
+			 second %s is a COPY with direction, e.g. COPY TO */
+					 errmsg("COPY %s cannot be used with %s", "COMPRESSION",
+							"COPY FROM")));
+
+		parse_compress_specification(opts_out->compression.algorithm,
+									 compression_detail,
+									 &opts_out->compression);
+		error_detail = validate_compress_specification(&opts_out->compression);
+		if (error_detail != NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("invalid compression specification: %s",
+							error_detail)));
+	}
 }
 
 /*
@@ -71,7 +71,9 @@
 #include "mb/pg_wchar.h"
 #include "miscadmin.h"
 #include "pgstat.h"
+#include "port/pg_bitutils.h"
 #include "port/pg_bswap.h"
+#include "port/simd.h"
 #include "utils/builtins.h"
 #include "utils/rel.h"
 
@@ -144,6 +146,10 @@ static bool CopyReadLine(CopyFromState cstate, bool is_csv);
 static bool CopyReadLineText(CopyFromState cstate, bool is_csv);
 static int	CopyReadAttributesText(CopyFromState cstate);
 static int	CopyReadAttributesCSV(CopyFromState cstate);
+#ifndef USE_NO_SIMD
+static inline int CopyScanPlainBytes(const char *s, int len, char c1, char c2,
+									 char c3, char c4);
+#endif
 static Datum CopyReadBinaryAttribute(CopyFromState cstate, FmgrInfo *flinfo,
 									 Oid typioparam, int32 typmod,
 									 bool *isnull);
@@ -1246,6 +1252,10 @@ CopyReadLineText(CopyFromState cstate, bool is_csv)
 	char		quotec = '\0';
 	char		escapec = '\0';
 
+	/* bytes besides newlines that the vectorized scan must stop at */
+	char		lineq1 = '\\';
+	char		lineq2 = '\\';
+
 	if (is_csv)
 	{
 		quotec = cstate->opts.quote[0];
@@ -1253,6 +1263,8 @@ CopyReadLineText(CopyFromState cstate, bool is_csv)
 		/* ignore special escape processing if it's the same as quotec */
 		if (quotec == escapec)
 			escapec = '\0';
+		lineq1 = quotec;
+		lineq2 = escapec != '\0' ? escapec : quotec;
 	}
 
 	/*
@@ -1319,6 +1331,30 @@ CopyReadLineText(CopyFromState cstate, bool is_csv)
 			need_data = false;
 		}
 
+#ifndef USE_NO_SIMD
+
+		/*
+		 * Skip over runs of bytes that can't end the line or change the
+		 * quoting state a vector at a time.  None of them is the escape
+		 * character, so an escape seen before them no longer applies.
+		 */
+		if (copy_buf_len - input_buf_ptr >= (int) sizeof(Vector8))
+		{
+			int			nplain;
+
+			nplain = CopyScanPlainBytes(copy_input_buf + input_buf_ptr,
+										copy_buf_len - input_buf_ptr,
+										'\n', '\r', lineq1, lineq2);
+			if (nplain > 0)
+			{
+				input_buf_ptr += nplain;
+				last_was_esc = false;
+				if (input_buf_ptr >= copy_buf_len)
+					continue;
+			}
+		}
+#endif
+
 		/* OK to fetch a character */
 		prev_raw_ptr = input_buf_ptr;
 		c = copy_input_buf[input_buf_ptr++];
@@ -1529,6 +1565,42 @@ CopyReadLineText(CopyFromState cstate, bool is_csv)
 	return result;
 }
 
+#ifndef USE_NO_SIMD
+/*
+ * Return the offset of the first byte of s[0 .. len - 1] that is one of
+ * c1 .. c4.  Only whole vectors are examined, so if there is no such byte
+ * in them, the offset of the first unexamined byte is returned instead.
+ * Either way, the bytes before the returned offset need no processing.
+ *
+ * Callers that look for fewer than four bytes pass some of them repeatedly.
+ */
+static inline int
+CopyScanPlainBytes(const char *s, int len, char c1, char c2, char c3, char c4)
+{
+	const Vector8 v1 = vector8_broadcast((uint8) c1);
+	const Vector8 v2 = vector8_broadcast((uint8) c2);
+	const Vector8 v3 = vector8_broadcast((uint8) c3);
+	const Vector8 v4 = vector8_broadcast((uint8) c4);
+	int			i;
+
+	for (i = 0; i + (int) sizeof(Vector8) <= len; i += sizeof(Vector8))
+	{
+		Vector8		chunk;
+		uint32		mask;
+
+		vector8_load(&chunk, (const uint8 *) s + i);
+		mask = vector8_highbit_mask(vector8_or(vector8_or(vector8_eq(chunk, v1),
+														  vector8_eq(chunk, v2)),
+											   vector8_or(vector8_eq(chunk, v3),
+														  vector8_eq(chunk, v4))));
+		if (mask != 0)
+			return i + pg_rightmost_one_pos32(mask);
+	}
+
+	return i;
+}
+#endif							/* ! USE_NO_SIMD */
+
 /*
  *	Return decimal value for a hexadecimal digit
  */
@@ -1564,6 +1636,7 @@ static int
 CopyReadAttributesText(CopyFromState cstate)
 {
 	char		delimc = cstate->opts.delim[0];
+	bool		is_gb18030 = (GetDatabaseEncoding() == PG_GB18030);
 	int			fieldno;
 	char	   *output_ptr;
 	char	   *cur_ptr;
@@ -1637,6 +1710,20 @@ CopyReadAttributesText(CopyFromState cstate)
 		{
 			char		c;
 
+#ifndef USE_NO_SIMD
+			/* Copy runs of ordinary bytes a vector at a time */
+			if (!is_gb18030 && line_end_ptr - cur_ptr >= (int) sizeof(Vector8))
+			{
+				int			nplain;
+
+				nplain = CopyScanPlainBytes(cur_ptr, line_end_ptr - cur_ptr,
+											delimc, '\\', '\\', '\\');
+				memcpy(output_ptr, cur_ptr, nplain);
+				output_ptr += nplain;
+				cur_ptr += nplain;
+			}
+#endif
+
 			end_ptr = cur_ptr;
 			if (cur_ptr >= line_end_ptr)
 				break;
@@ -1648,7 +1735,7 @@ CopyReadAttributesText(CopyFromState cstate)
 			* the generic validation logic below would incorrectly flag the character's
 			* second byte as an invalid standalone character.
 			*/
-			if (GetDatabaseEncoding() == PG_GB18030)
+			if (is_gb18030)
 			{
 				if ((byte_count = pg_encoding_mblen(GetDatabaseEncoding(), cur_ptr - 1)) != 1)
 				{
@@ -1854,6 +1941,7 @@ CopyReadAttributesCSV(CopyFromState cstate)
 	char		delimc = cstate->opts.delim[0];
 	char		quotec = cstate->opts.quote[0];
 	char		escapec = cstate->opts.escape[0];
+	bool		is_gb18030 = (GetDatabaseEncoding() == PG_GB18030);
 	int			fieldno;
 	char	   *output_ptr;
 	char	   *cur_ptr;
@@ -1926,6 +2014,20 @@ CopyReadAttributesCSV(CopyFromState cstate)
 			/* Not in quote */
 			for (;;)
 			{
+#ifndef USE_NO_SIMD
+				/* Copy runs of ordinary bytes a vector at a time */
+				if (!is_gb18030 && line_end_ptr - cur_ptr >= (int) sizeof(Vector8))
+				{
+					int			nplain;
+
+					nplain = CopyScanPlainBytes(cur_ptr, line_end_ptr - cur_ptr,
+												delimc, quotec, quotec, quotec);
+					memcpy(output_ptr, cur_ptr, nplain);
+					output_ptr += nplain;
+					cur_ptr += nplain;
+				}
+#endif
+
 				end_ptr = cur_ptr;
 				if (cur_ptr >= line_end_ptr)
 					goto endfield;
@@ -1937,7 +2039,7 @@ CopyReadAttributesCSV(CopyFromState cstate)
 				* the generic validation logic below would incorrectly flag the character's
 				* second byte as an invalid standalone character.
 				*/
-				if (GetDatabaseEncoding() == PG_GB18030)
+				if (is_gb18030)
 				{
 					if ((byte_count = pg_encoding_mblen(GetDatabaseEncoding(), cur_ptr - 1)) != 1)
 					{
@@ -1982,6 +2084,20 @@ CopyReadAttributesCSV(CopyFromState cstate)
 			/* In quote */
 			for (;;)
 			{
+#ifndef USE_NO_SIMD
+				/* Copy runs of ordinary bytes a vector at a time */
+				if (!is_gb18030 && line_end_ptr - cur_ptr >= (int) sizeof(Vector8))
+				{
+					int			nplain;
+
+					nplain = CopyScanPlainBytes(cur_ptr, line_end_ptr - cur_ptr,
+												quotec, escapec, escapec, escapec);
+					memcpy(output_ptr, cur_ptr, nplain);
+					output_ptr += nplain;
+					cur_ptr += nplain;
+				}
+#endif
+
 				end_ptr = cur_ptr;
 				if (cur_ptr >= line_end_ptr)
 					ereport(ERROR,
@@ -1996,7 +2112,7 @@ CopyReadAttributesCSV(CopyFromState cstate)
 				* the generic validation logic below would incorrectly flag the character's
 				* second byte as an invalid standalone character.
 				*/
-				if (GetDatabaseEncoding() == PG_GB18030)
+				if (is_gb18030)
 				{
 					if ((byte_count = pg_encoding_mblen(GetDatabaseEncoding(), cur_ptr - 1)) != 1)
 					{
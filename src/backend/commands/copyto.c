@@ -18,6 +18,16 @@
 #include <unistd.h>
 #include <sys/stat.h>
 
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+#ifdef USE_LZ4
+#include <lz4frame.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
 #include "access/tableam.h"
 #include "commands/copyapi.h"
 #include "commands/progress.h"
@@ -47,6 +57,32 @@ typedef enum CopyDest
 	COPY_CALLBACK,				/* to callback function */
 } CopyDest;
 
+/*
+ * State for compressing the data written to a file or program, used if the
+ * COMPRESSION option was given.  Compressed data is staged in outbuf and
+ * written out whenever it fills up.
+ */
+typedef struct CopyToCompressor
+{
+	pg_compress_algorithm algorithm;
+	char	   *outbuf;			/* compressed data not yet written */
+	size_t		outbuf_size;	/* allocated size of outbuf */
+	size_t		outbuf_len;		/* bytes used in outbuf */
+#ifdef HAVE_LIBZ
+	z_stream	zstream;
+#endif
+#ifdef USE_LZ4
+	LZ4F_compressionContext_t lz4_ctx;
+#endif
+#ifdef USE_ZSTD
+	ZSTD_CCtx  *zstd_ctx;
+#endif
+	MemoryContextCallback cleanup;	/* releases library contexts */
+} CopyToCompressor;
+
+/* Size of the buffer for compressed data */
+#define COPY_COMPRESS_BUFSIZE	(64 * 1024)
+
 /*
  * This struct contains all the state variables used throughout a COPY TO
  * operation.
@@ -70,6 +106,7 @@ typedef struct CopyToStateData
 	/* low-level state data */
 	CopyDest	copy_dest;		/* type of copy source/destination */
 	FILE	   *copy_file;		/* used if copy_dest == COPY_FILE */
+	CopyToCompressor *compressor;	/* compresses copy_file output, or NULL */
 	StringInfo	fe_msgbuf;		/* used for all dests during COPY TO */
 
 	int			file_encoding;	/* file or remote side's character encoding */
@@ -141,6 +178,14 @@ static void CopySendTextLikeEndOfRow(CopyToState cstate);
 static void CopySendInt32(CopyToState cstate, int32 val);
 static void CopySendInt16(CopyToState cstate, int16 val);
 
+/* compression of file and program output */
+static void CopyToFileWrite(CopyToState cstate, const char *data, size_t len);
+static void CopyToCompressBegin(CopyToState cstate);
+static void CopyToCompressData(CopyToState cstate, const char *data,
+							   size_t len);
+static void CopyToCompressEnd(CopyToState cstate);
+static void CopyToCompressCleanup(void *arg);
+
 /*
  * COPY TO routines for built-in formats.
  *
@@ -449,38 +494,10 @@ CopySendEndOfRow(CopyToState cstate)
 	switch (cstate->copy_dest)
 	{
 		case COPY_FILE:
-			if (fwrite(fe_msgbuf->data, fe_msgbuf->len, 1,
-					   cstate->copy_file) != 1 ||
-				ferror(cstate->copy_file))
-			{
-				if (cstate->is_program)
-				{
-					if (errno == EPIPE)
-					{
-						/*
-						 * The pipe will be closed automatically on error at
-						 * the end of transaction, but we might get a better
-						 * error message from the subprocess' exit code than
-						 * just "Broken Pipe"
-						 */
-						ClosePipeToProgram(cstate);
-
-						/*
-						 * If ClosePipeToProgram() didn't throw an error, the
-						 * program terminated normally, but closed the pipe
-						 * first. Restore errno, and throw an error.
-						 */
-						errno = EPIPE;
-					}
-					ereport(ERROR,
-							(errcode_for_file_access(),
-							 errmsg("could not write to COPY program: %m")));
-				}
-				else
-					ereport(ERROR,
-							(errcode_for_file_access(),
-							 errmsg("could not write to COPY file: %m")));
-			}
+			if (cstate->compressor)
+				CopyToCompressData(cstate, fe_msgbuf->data, fe_msgbuf->len);
+			else
+				CopyToFileWrite(cstate, fe_msgbuf->data, fe_msgbuf->len);
 			break;
 		case COPY_FRONTEND:
 			/* Dump the accumulated row as one CopyData message */
@@ -555,6 +572,423 @@ CopySendInt16(CopyToState cstate, int16 val)
 	CopySendData(cstate, &buf, sizeof(buf));
 }
 
+/*
+ * Write data to the file or program of a COPY TO.
+ */
+static void
+CopyToFileWrite(CopyToState cstate, const char *data, size_t len)
+{
+	if (len == 0)
+		return;
+
+	if (fwrite(data, len, 1, cstate->copy_file) != 1 ||
+		ferror(cstate->copy_file))
+	{
+		if (cstate->is_program)
+		{
+			if (errno == EPIPE)
+			{
+				/*
+				 * The pipe will be closed automatically on error at the end
+				 * of transaction, but we might get a better error message
+				 * from the subprocess' exit code than just "Broken Pipe"
+				 */
+				ClosePipeToProgram(cstate);
+
+				/*
+				 * If ClosePipeToProgram() didn't throw an error, the program
+				 * terminated normally, but closed the pipe first. Restore
+				 * errno, and throw an error.
+				 */
+				errno = EPIPE;
+			}
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not write to COPY program: %m")));
+		}
+		else
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not write to COPY file: %m")));
+	}
+}
+
+#ifdef HAVE_LIBZ
+/*
+ * Wrappers to make zlib allocate its memory with palloc, in the COPY's
+ * memory context.
+ */
+static void *
+copy_gzip_palloc(void *opaque, unsigned items, unsigned size)
+{
+	return palloc(items * size);
+}
+
+static void
+copy_gzip_pfree(void *opaque, void *address)
+{
+	pfree(address);
+}
+#endif
+
+/*
+ * Set up compression of the data written to a file or program.
+ *
+ * The library contexts that are not allocated with palloc are released by a
+ * callback on the COPY's memory context, so that they are not leaked if the
+ * COPY fails.
+ */
+static void
+CopyToCompressBegin(CopyToState cstate)
+{
+	pg_compress_specification *spec = &cstate->opts.compression;
+	CopyToCompressor *comp;
+
+	comp = palloc0(sizeof(CopyToCompressor));
+	comp->algorithm = spec->algorithm;
+	comp->outbuf_size = COPY_COMPRESS_BUFSIZE;
+
+	/*
+	 * Register the callback before creating any library context, so that it
+	 * is released even if setting it up fails below.
+	 */
+	comp->cleanup.func = CopyToCompressCleanup;
+	comp->cleanup.arg = comp;
+	MemoryContextRegisterResetCallback(cstate->copycontext, &comp->cleanup);
+
+	switch (spec->algorithm)
+	{
+		case PG_COMPRESSION_GZIP:
+#ifndef HAVE_LIBZ
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("gzip compression is not supported by this build")));
+#else
+			comp->zstream.zalloc = copy_gzip_palloc;
+			comp->zstream.zfree = copy_gzip_pfree;
+
+			/* 15 + 16 window bits request a gzip rather than a zlib header */
+			if (deflateInit2(&comp->zstream, spec->level, Z_DEFLATED,
+							 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+				ereport(ERROR,
+						(errcode(ERRCODE_INTERNAL_ERROR),
+						 errmsg("could not initialize compression library")));
+#endif
+			break;
+
+		case PG_COMPRESSION_LZ4:
+#ifndef USE_LZ4
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("lz4 compression is not supported by this build")));
+#else
+			{
+				LZ4F_errorCode_t ret;
+
+				ret = LZ4F_createCompressionContext(&comp->lz4_ctx,
+													LZ4F_VERSION);
+				if (LZ4F_isError(ret))
+					elog(ERROR, "could not create lz4 compression context: %s",
+						 LZ4F_getErrorName(ret));
+
+				/* Each call to LZ4F_compressUpdate() may add up to a block */
+				comp->outbuf_size = Max(comp->outbuf_size,
+										LZ4F_compressBound(COPY_COMPRESS_BUFSIZE,
+														   NULL));
+			}
+#endif
+			break;
+
+		case PG_COMPRESSION_ZSTD:
+#ifndef USE_ZSTD
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("zstd compression is not supported by this build")));
+#else
+			{
+				size_t		ret;
+
+				comp->zstd_ctx = ZSTD_createCCtx();
+				if (!comp->zstd_ctx)
+					elog(ERROR, "could not create zstd compression context");
+
+				ret = ZSTD_CCtx_setParameter(comp->zstd_ctx,
+											 ZSTD_c_compressionLevel,
+											 spec->level);
+				if (ZSTD_isError(ret))
+					elog(ERROR, "could not set zstd compression level to %d: %s",
+						 spec->level, ZSTD_getErrorName(ret));
+
+				if ((spec->options & PG_COMPRESSION_OPTION_WORKERS) != 0)
+				{
+					ret = ZSTD_CCtx_setParameter(comp->zstd_ctx,
+												 ZSTD_c_nbWorkers,
+												 spec->workers);
+					if (ZSTD_isError(ret))
+						ereport(ERROR,
+								(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+								 errmsg("could not set compression worker count to %d: %s",
+										spec->workers, ZSTD_getErrorName(ret))));
+				}
+
+				if ((spec->options & PG_COMPRESSION_OPTION_LONG_DISTANCE) != 0)
+				{
+					ret = ZSTD_CCtx_setParameter(comp->zstd_ctx,
+												 ZSTD_c_enableLongDistanceMatching,
+												 spec->long_distance);
+					if (ZSTD_isError(ret))
+						ereport(ERROR,
+								(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+								 errmsg("could not enable long-distance mode: %s",
+										ZSTD_getErrorName(ret))));
+				}
+			}
+#endif
+			break;
+
+		default:
+			elog(ERROR, "unrecognized compression algorithm: %d",
+				 (int) spec->algorithm);
+	}
+
+	comp->outbuf = palloc(comp->outbuf_size);
+	cstate->compressor = comp;
+
+#ifdef USE_LZ4
+	if (comp->algorithm == PG_COMPRESSION_LZ4)
+	{
+		LZ4F_preferences_t prefs;
+		size_t		ret;
+
+		memset(&prefs, 0, sizeof(prefs));
+		prefs.compressionLevel = spec->level;
+
+		ret = LZ4F_compressBegin(comp->lz4_ctx, comp->outbuf,
+								 comp->outbuf_size, &prefs);
+		if (LZ4F_isError(ret))
+			elog(ERROR, "could not write lz4 header: %s",
+				 LZ4F_getErrorName(ret));
+		comp->outbuf_len = ret;
+	}
+#endif
+}
+
+/*
+ * Compress data and write out the compressed data as the buffer fills.
+ */
+static void
+CopyToCompressData(CopyToState cstate, const char *data, size_t len)
+{
+	CopyToCompressor *comp = cstate->compressor;
+
+	switch (comp->algorithm)
+	{
+#ifdef HAVE_LIBZ
+		case PG_COMPRESSION_GZIP:
+			{
+				z_stream   *zs = &comp->zstream;
+
+				zs->next_in = (Bytef *) data;
+				zs->avail_in = len;
+
+				while (zs->avail_in > 0)
+				{
+					int			res;
+
+					zs->next_out = (Bytef *) comp->outbuf + comp->outbuf_len;
+					zs->avail_out = comp->outbuf_size - comp->outbuf_len;
+
+					res = deflate(zs, Z_NO_FLUSH);
+					if (res == Z_STREAM_ERROR)
+						elog(ERROR, "could not compress data: %s", zs->msg);
+
+					comp->outbuf_len = comp->outbuf_size - zs->avail_out;
+					if (zs->avail_out == 0)
+					{
+						CopyToFileWrite(cstate, comp->outbuf, comp->outbuf_len);
+						comp->outbuf_len = 0;
+					}
+				}
+			}
+			break;
+#endif
+#ifdef USE_LZ4
+		case PG_COMPRESSION_LZ4:
+			while (len > 0)
+			{
+				size_t		chunk = Min(len, COPY_COMPRESS_BUFSIZE);
+				size_t		ret;
+
+				if (comp->outbuf_size - comp->outbuf_len <
+					LZ4F_compressBound(chunk, NULL))
+				{
+					CopyToFileWrite(cstate, comp->outbuf, comp->outbuf_len);
+					comp->outbuf_len = 0;
+				}
+
+				ret = LZ4F_compressUpdate(comp->lz4_ctx,
+										  comp->outbuf + comp->outbuf_len,
+										  comp->outbuf_size - comp->outbuf_len,
+										  data, chunk, NULL);
+				if (LZ4F_isError(ret))
+					elog(ERROR, "could not compress data: %s",
+						 LZ4F_getErrorName(ret));
+
+				comp->outbuf_len += ret;
+				data += chunk;
+				len -= chunk;
+			}
+			break;
+#endif
+#ifdef USE_ZSTD
+		case PG_COMPRESSION_ZSTD:
+			{
+				ZSTD_inBuffer in = {data, len, 0};
+
+				while (in.pos < in.size)
+				{
+					ZSTD_outBuffer out = {comp->outbuf, comp->outbuf_size,
+					comp->outbuf_len};
+					size_t		ret;
+
+					ret = ZSTD_compressStream2(comp->zstd_ctx, &out, &in,
+											   ZSTD_e_continue);
+					if (ZSTD_isError(ret))
+						elog(ERROR, "could not compress data: %s",
+							 ZSTD_getErrorName(ret));
+
+					comp->outbuf_len = out.pos;
+					if (out.pos == out.size)
+					{
+						CopyToFileWrite(cstate, comp->outbuf, comp->outbuf_len);
+						comp->outbuf_len = 0;
+					}
+				}
+			}
+			break;
+#endif
+		default:
+			elog(ERROR, "unrecognized compression algorithm: %d",
+				 (int) comp->algorithm);
+	}
+}
+
+/*
+ * Finish the compressed stream and write out whatever is left of it.
+ */
+static void
+CopyToCompressEnd(CopyToState cstate)
+{
+	CopyToCompressor *comp = cstate->compressor;
+
+	switch (comp->algorithm)
+	{
+#ifdef HAVE_LIBZ
+		case PG_COMPRESSION_GZIP:
+			{
+				z_stream   *zs = &comp->zstream;
+				int			res;
+
+				zs->next_in = NULL;
+				zs->avail_in = 0;
+				do
+				{
+					zs->next_out = (Bytef *) comp->outbuf + comp->outbuf_len;
+					zs->avail_out = comp->outbuf_size - comp->outbuf_len;
+
+					res = deflate(zs, Z_FINISH);
+					if (res == Z_STREAM_ERROR)
+						elog(ERROR, "could not compress data: %s", zs->msg);
+
+					comp->outbuf_len = comp->outbuf_size - zs->avail_out;
+					CopyToFileWrite(cstate, comp->outbuf, comp->outbuf_len);
+					comp->outbuf_len = 0;
+				} while (res != Z_STREAM_END);
+
+				deflateEnd(zs);
+			}
+			break;
+#endif
+#ifdef USE_LZ4
+		case PG_COMPRESSION_LZ4:
+			{
+				size_t		ret;
+
+				if (comp->outbuf_size - comp->outbuf_len <
+					LZ4F_compressBound(0, NULL))
+				{
+					CopyToFileWrite(cstate, comp->outbuf, comp->outbuf_len);
+					comp->outbuf_len = 0;
+				}
+
+				ret = LZ4F_compressEnd(comp->lz4_ctx,
+									   comp->outbuf + comp->outbuf_len,
+									   comp->outbuf_size - comp->outbuf_len,
+									   NULL);
+				if (LZ4F_isError(ret))
+					elog(ERROR, "could not end lz4 compression: %s",
+						 LZ4F_getErrorName(ret));
+
+				comp->outbuf_len += ret;
+				CopyToFileWrite(cstate, comp->outbuf, comp->outbuf_len);
+				comp->outbuf_len = 0;
+			}
+			break;
+#endif
+#ifdef USE_ZSTD
+		case PG_COMPRESSION_ZSTD:
+			{
+				ZSTD_inBuffer in = {NULL, 0, 0};
+				size_t		yet_to_flush;
+
+				do
+				{
+					ZSTD_outBuffer out = {comp->outbuf, comp->outbuf_size,
+					comp->outbuf_len};
+
+					yet_to_flush = ZSTD_compressStream2(comp->zstd_ctx, &out,
+														&in, ZSTD_e_end);
+					if (ZSTD_isError(yet_to_flush))
+						elog(ERROR, "could not compress data: %s",
+							 ZSTD_getErrorName(yet_to_flush));
+
+					CopyToFileWrite(cstate, comp->outbuf, out.pos);
+					comp->outbuf_len = 0;
+				} while (yet_to_flush > 0);
+			}
+			break;
+#endif
+		default:
+			elog(ERROR, "unrecognized compression algorithm: %d",
+				 (int) comp->algorithm);
+	}
+}
+
+/*
+ * Release the compression library contexts, when the COPY's memory context
+ * goes away.
+ */
+static void
+CopyToCompressCleanup(void *arg)
+{
+	CopyToCompressor *comp pg_attribute_unused() = (CopyToCompressor *) arg;
+
+#ifdef USE_LZ4
+	if (comp->lz4_ctx)
+	{
+		LZ4F_freeCompressionContext(comp->lz4_ctx);
+		comp->lz4_ctx = NULL;
+	}
+#endif
+#ifdef USE_ZSTD
+	if (comp->zstd_ctx)
+	{
+		ZSTD_freeCCtx(comp->zstd_ctx);
+		comp->zstd_ctx = NULL;
+	}
+#endif
+}
+
 /*
  * Closes the pipe to an external program, checking the pclose() return code.
  */
@@ -702,6 +1136,17 @@ BeginCopyTo(ParseState *pstate,
 	/* Extract options from the statement node tree */
 	ProcessCopyOptions(pstate, &cstate->opts, false /* is_from */ , options);
 
+	/* Output is compressed only when we write the file ourselves */
+	if (cstate->opts.compression.algorithm != PG_COMPRESSION_NONE &&
+		filename == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+		/*- translator: first %s is the name of a COPY option, e.g. ON_ERROR,
+		 second %s is a COPY with direction, e.g. COPY TO */
+				 errmsg("COPY %s cannot be used with %s", "COMPRESSION",
+						"COPY TO STDOUT"),
+				 errhint("Use a client-side facility to compress the data.")));
+
 	/* Set format routine */
 	cstate->routine = CopyToGetRoutine(&cstate->opts);
 
@@ -986,6 +1431,9 @@ BeginCopyTo(ParseState *pstate,
 		}
 	}
 
+	if (cstate->opts.compression.algorithm != PG_COMPRESSION_NONE)
+		CopyToCompressBegin(cstate);
+
 	/* initialize progress */
 	pgstat_progress_start_command(PROGRESS_COMMAND_COPY,
 								  cstate->rel ? RelationGetRelid(cstate->rel) : InvalidOid);
@@ -1107,6 +1555,9 @@ DoCopyTo(CopyToState cstate)
 
 	cstate->routine->CopyToEnd(cstate);
 
+	if (cstate->compressor)
+		CopyToCompressEnd(cstate);
+
 	MemoryContextDelete(cstate->rowcontext);
 
 	if (fe_copy)
@@ -746,6 +746,39 @@ ExplainPrintSettings(ExplainState *es)
 	}
 }
 
+/*
+ * ExplainPrintHints -
+ *    Print the optimizer hints given in the query, sorted by whether the
+ *    planner used them.
+ */
+static void
+ExplainPrintHints(ExplainState *es)
+{
+	List	   *used = NIL;
+	List	   *unused = NIL;
+	List	   *invalid = NIL;
+	ListCell   *lc;
+
+	foreach(lc, es->pstmt->hints)
+	{
+		OraHint    *hint = lfirst_node(OraHint, lc);
+
+		if (hint->kind == ORA_HINT_INVALID)
+			invalid = lappend(invalid, hint->text);
+		else if (hint->used)
+			used = lappend(used, hint->text);
+		else
+			unused = lappend(unused, hint->text);
+	}
+
+	if (used != NIL)
+		ExplainPropertyList("Hints Used", used, es);
+	if (unused != NIL)
+		ExplainPropertyList("Hints Not Used", unused, es);
+	if (invalid != NIL)
+		ExplainPropertyList("Invalid Hints", invalid, es);
+}
+
 /*
  * ExplainPrintPlan -
  *	  convert a QueryDesc's plan tree to text and append it to es->str
@@ -808,6 +841,9 @@ ExplainPrintPlan(ExplainState *es, QueryDesc *queryDesc)
 	 */
 	ExplainPrintSettings(es);
 
+	/* Report which optimizer hints, if any, the planner acted on */
+	ExplainPrintHints(es);
+
 	/*
 	 * COMPUTE_QUERY_ID_REGRESS means COMPUTE_QUERY_ID_AUTO, but we don't show
 	 * the queryid in any of the EXPLAIN plans to keep stable the results
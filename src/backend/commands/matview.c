@@ -124,8 +124,14 @@ ExecRefreshMatView(RefreshMatViewStmt *stmt, const char *queryString,
 	Oid			matviewOid;
 	LOCKMODE	lockmode;
 
-	/* Determine strength of lock needed. */
-	lockmode = stmt->concurrent ? ExclusiveLock : AccessExclusiveLock;
+	/*
+	 * Determine strength of lock needed.  A refresh that computes new data
+	 * starts out with ExclusiveLock, which lets a fast refresh run alongside
+	 * readers; RefreshMatViewByOid upgrades it if it has to swap in a new
+	 * heap instead.
+	 */
+	lockmode = (stmt->concurrent || !stmt->skipData) ?
+		ExclusiveLock : AccessExclusiveLock;
 
 	/*
 	 * Get a lock until end of transaction.
@@ -178,6 +184,7 @@ RefreshMatViewByOid(Oid matviewOid, bool is_create, bool skipData,
 	Oid			save_userid;
 	int			save_sec_context;
 	int			save_nestlevel;
+	bool		fresh_logs;
 	ObjectAddress address;
 
 	matviewRel = table_open(matviewOid, NoLock);
@@ -293,6 +300,49 @@ RefreshMatViewByOid(Oid matviewOid, bool is_create, bool skipData,
 					   is_create ? "CREATE MATERIALIZED VIEW" :
 					   "REFRESH MATERIALIZED VIEW");
 
+	/*
+	 * A populated matview with fast_refresh enabled may only need the changes
+	 * recorded in its change logs applied.
+	 */
+	if (!is_create && !concurrent && !skipData &&
+		RelationIsPopulated(matviewRel) &&
+		RelationGetFastRefresh(matviewRel) != STDRD_OPTION_FAST_REFRESH_OFF)
+	{
+		int			old_depth = matview_maintenance_depth;
+		volatile bool done;
+
+		PG_TRY();
+		{
+			OpenMatViewIncrementalMaintenance();
+			done = MatViewFastRefresh(matviewRel, dataQuery, relowner,
+									  save_sec_context, &processed);
+			CloseMatViewIncrementalMaintenance();
+		}
+		PG_CATCH();
+		{
+			matview_maintenance_depth = old_depth;
+			PG_RE_THROW();
+		}
+		PG_END_TRY();
+		Assert(matview_maintenance_depth == old_depth);
+
+		if (done)
+		{
+			table_close(matviewRel, NoLock);
+			AtEOXact_GUC(false, save_nestlevel);
+			SetUserIdAndSecContext(save_userid, save_sec_context);
+			ObjectAddressSet(address, RelationRelationId, matviewOid);
+			if (qc)
+				SetQueryCompletion(qc, CMDTAG_REFRESH_MATERIALIZED_VIEW,
+								   processed);
+			return address;
+		}
+	}
+
+	/* Swapping in a new heap needs the lock ExecRefreshMatView put off */
+	if (!is_create && !concurrent)
+		LockRelationOid(matviewOid, AccessExclusiveLock);
+
 	/*
 	 * Tentatively mark the matview as populated or not (this will roll back
 	 * if we fail later).
@@ -321,14 +371,26 @@ RefreshMatViewByOid(Oid matviewOid, bool is_create, bool skipData,
 							   relpersistence, ExclusiveLock);
 	Assert(CheckRelationOidLockedByMe(OIDNewHeap, AccessExclusiveLock, false));
 
+	/*
+	 * Empty or create the change logs; the new contents cover every change so
+	 * far.  Newly created logs only see changes committed after us, so then
+	 * the data must be computed with a snapshot that sees everything that
+	 * committed before them.
+	 */
+	fresh_logs = MatViewPrepareLogs(matviewRel, dataQuery, skipData);
+
 	/* Generate the data, if wanted. */
 	if (!skipData)
 	{
 		DestReceiver *dest;
 
+		if (fresh_logs)
+			PushActiveSnapshot(GetLatestSnapshot());
 		dest = CreateTransientRelDestReceiver(OIDNewHeap);
 		processed = refresh_matview_datafill(dest, dataQuery, queryString,
 											 is_create);
+		if (fresh_logs)
+			PopActiveSnapshot();
 	}
 
 	/* Make the matview match the newly generated data. */
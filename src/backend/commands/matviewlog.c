@@ -0,0 +1,1820 @@
+/*-------------------------------------------------------------------------
+ *
+ * matviewlog.c
+ *	  fast refresh of materialized views from change logs
+ *
+ * A materialized view with the fast_refresh storage parameter has a change
+ * log for each of its base tables.  Statement-level AFTER triggers with
+ * transition tables append the old and new versions of the rows that each
+ * statement changed to the log, tagged with a sign of -1 or +1, and REFRESH
+ * applies just those changes to the materialized view instead of running
+ * its query again.
+ *
+ * For a view joining base tables R1 ... Rn, the change of the result is the
+ * union over i of the view's query with Ri replaced by its log, the tables
+ * before Ri by their current contents and the tables after Ri by their
+ * contents before the changes (current contents plus the log with inverted
+ * signs).  Each row of that union carries the product of the signs of the
+ * rows it was made of, so rows that were added and removed again cancel
+ * out.  For a view without aggregates the summed signs say how many copies
+ * of each row to add or remove.  For a view with GROUP BY and sum, count,
+ * min or max aggregates they are aggregated per group and merged into the
+ * existing rows; a group that lost rows is recomputed from the base tables
+ * when its aggregates can't be derived from the change alone, that is for
+ * min and max, and for views without count(*).
+ *
+ * Views whose query can't be maintained this way, and logs that are missing
+ * or record a TRUNCATE, make REFRESH recompute the whole view instead.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  src/backend/commands/matviewlog.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/heapam.h"
+#include "access/htup_details.h"
+#include "access/relation.h"
+#include "access/sysattr.h"
+#include "access/table.h"
+#include "access/xact.h"
+#include "catalog/dependency.h"
+#include "catalog/indexing.h"
+#include "catalog/namespace.h"
+#include "catalog/pg_aggregate.h"
+#include "catalog/pg_depend.h"
+#include "catalog/pg_namespace.h"
+#include "catalog/pg_trigger.h"
+#include "catalog/toasting.h"
+#include "commands/matview.h"
+#include "commands/tablecmds.h"
+#include "commands/trigger.h"
+#include "executor/executor.h"
+#include "executor/spi.h"
+#include "miscadmin.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/optimizer.h"
+#include "parser/analyze.h"
+#include "parser/parse_relation.h"
+#include "parser/parser.h"
+#include "rewrite/rewriteHandler.h"
+#include "storage/lmgr.h"
+#include "storage/proc.h"
+#include "tcop/tcopprot.h"
+#include "utils/acl.h"
+#include "utils/builtins.h"
+#include "utils/fmgroids.h"
+#include "utils/fmgrprotos.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/ruleutils.h"
+#include "utils/snapmgr.h"
+#include "utils/syscache.h"
+#include "utils/tuplestore.h"
+#include "utils/typcache.h"
+
+
+/* Name of the sign column of change logs and of the delta queries */
+#define MLOG_SIGN_COLUMN	"mlog$sign"
+
+/* A base table of a materialized view, and its change log */
+typedef struct MLogBase
+{
+	Oid			relid;			/* the base table */
+	Bitmapset  *attrs;			/* columns the view reads, logged in order */
+	Oid			logid;			/* the change log, or InvalidOid */
+	bool		changed;		/* the log has rows to apply */
+} MLogBase;
+
+typedef enum MLogColumnKind
+{
+	MLOG_KEY,					/* GROUP BY key, or column of a view without
+								 * aggregates */
+	MLOG_COUNT_STAR,
+	MLOG_COUNT,
+	MLOG_SUM,
+	MLOG_MIN,
+	MLOG_MAX,
+} MLogColumnKind;
+
+/* How a column of the materialized view is maintained */
+typedef struct MLogColumn
+{
+	MLogColumnKind kind;
+	int			pcol;			/* column of the pre-aggregation query, or -1
+								 * for count(*) */
+	int			countcol;		/* sum: view column counting the same
+								 * argument, or -1 */
+	Oid			eqop;			/* key: equality operator */
+	Oid			type;			/* type of the column */
+	const char *name;			/* quoted column name */
+} MLogColumn;
+
+/* What fast refresh needs to know about the query of a materialized view */
+typedef struct MLogView
+{
+	Query	   *pquery;			/* the query before any aggregation */
+	int			npcols;			/* number of output columns of pquery */
+	int			nkeys;			/* leading pquery columns that are keys */
+	List	   *bases;			/* MLogBase for each distinct base table */
+	bool		grouped;		/* the view has aggregates */
+	bool		recompute;		/* groups that lose rows must be recomputed */
+	int			ncolumns;		/* columns of the materialized view */
+	MLogColumn *columns;
+} MLogView;
+
+/* Materialized views to refresh before the current transaction commits */
+static List *pending_refreshes = NIL;
+static LocalTransactionId pending_lxid = InvalidLocalTransactionId;
+
+static const char *mlog_analyze_query(Relation matviewRel, Query *query,
+									  MLogView *view);
+static const char *mlog_analyze_base(Query *query, RangeTblEntry *rte,
+									 MLogView *view);
+static const char *mlog_analyze_aggref(Aggref *aggref, MLogColumn *col);
+static MLogBase *mlog_get_base(MLogView *view, Oid relid);
+static List *mlog_existing_logs(Oid matviewOid);
+static bool mlog_find_logs(Relation matviewRel, MLogView *view,
+						   List *existing);
+static char *mlog_log_name(Oid matviewOid, Oid relid);
+static void mlog_create_log(Relation matviewRel, MLogBase *base);
+static void mlog_create_trigger(Relation matviewRel, MLogBase *base,
+								int16 event, bool oldtable, bool newtable);
+static void mlog_drop_logs(List *logs);
+static void mlog_write_rows(Relation log, Tuplestorestate *rows,
+							TupleDesc basedesc, Trigger *trigger, int sign,
+							CommandId cid, BulkInsertState bistate);
+static void mlog_execute(const char *sql, Snapshot snapshot, bool read_only,
+						 int expected);
+static char *mlog_delta_term(MLogView *view, int term);
+static void mlog_replace_rte(RangeTblEntry *rte, MLogBase *base,
+							 bool old_state);
+static uint64 mlog_apply(Relation matviewRel, MLogView *view,
+						 Snapshot snapshot, Oid relowner,
+						 int save_sec_context);
+static void mlog_append_keymatch(StringInfo buf, MLogView *view,
+								 const char *left, bool left_is_view,
+								 const char *right);
+static void mlog_append_op(StringInfo buf, const char *left, const char *op,
+						   const char *right);
+static char *mlog_recompute_query(MLogView *view, const char *deltaname,
+								  const char *filter);
+
+
+/*
+ * MatViewFastRefresh
+ *		Bring a populated materialized view up to date from its change logs.
+ *
+ * Returns false, without having changed anything, if the view's query can't
+ * be maintained incrementally or the logs don't cover all changes since the
+ * last refresh; the caller must then recompute the whole view.  On success,
+ * *processed is set to the number of rows of the view that were changed.
+ *
+ * The caller holds ExclusiveLock on the materialized view, runs as its owner
+ * in a security-restricted operation, and allows the view to be modified.
+ */
+bool
+MatViewFastRefresh(Relation matviewRel, Query *query, Oid relowner,
+				   int save_sec_context, uint64 *processed)
+{
+	MLogView	view;
+	Snapshot	snapshot;
+	ListCell   *lc;
+	bool		result = true;
+	bool		changed = false;
+
+	*processed = 0;
+
+	if (mlog_analyze_query(matviewRel, query, &view) != NULL)
+		return false;
+	if (!mlog_find_logs(matviewRel, &view,
+						mlog_existing_logs(RelationGetRelid(matviewRel))))
+		return false;
+
+	foreach(lc, view.bases)
+		LockRelationOid(((MLogBase *) lfirst(lc))->logid, RowExclusiveLock);
+
+	/*
+	 * Everything below reads the base tables and the logs with the same
+	 * snapshot, so exactly the changes visible to it are applied and removed
+	 * from the logs.  Take a fresh one: the view and the logs may have been
+	 * changed by a refresh that committed after our transaction started.
+	 */
+	snapshot = RegisterSnapshot(GetLatestSnapshot());
+
+	SPI_connect();
+
+	/* Find the logs with changes, and give up if one records a TRUNCATE */
+	foreach(lc, view.bases)
+	{
+		MLogBase   *base = (MLogBase *) lfirst(lc);
+		char	   *sql;
+		Datum		truncated;
+		bool		isnull;
+
+		sql = psprintf("SELECT pg_catalog.bool_or(l.\"%s\" OPERATOR(pg_catalog.=) 0) FROM %s l",
+					   MLOG_SIGN_COLUMN,
+					   quote_qualified_identifier(get_namespace_name(get_rel_namespace(base->logid)),
+												  get_rel_name(base->logid)));
+		mlog_execute(sql, snapshot, true, SPI_OK_SELECT);
+		truncated = SPI_getbinval(SPI_tuptable->vals[0],
+								  SPI_tuptable->tupdesc, 1, &isnull);
+		if (!isnull && DatumGetBool(truncated))
+		{
+			result = false;
+			break;
+		}
+		base->changed = !isnull;
+		changed |= base->changed;
+	}
+
+	if (result && changed)
+		*processed = mlog_apply(matviewRel, &view, snapshot, relowner,
+								save_sec_context);
+
+	if (SPI_finish() != SPI_OK_FINISH)
+		elog(ERROR, "SPI_finish failed");
+
+	UnregisterSnapshot(snapshot);
+
+	return result;
+}
+
+/*
+ * MatViewPrepareLogs
+ *		Get the change logs of a materialized view ready for a full refresh.
+ *
+ * A full refresh takes care of all changes made so far, so the logs are
+ * emptied, or created if they are missing.  Logs that are no longer wanted,
+ * because fast_refresh is off, the view is refreshed WITH NO DATA, or its
+ * query can't be maintained incrementally, are dropped.
+ *
+ * Returns true if the logs were just created.  The triggers that fill them
+ * only see changes made after this transaction commits, so the caller must
+ * then compute the view's contents with a snapshot taken after this call
+ * rather than the transaction's snapshot.
+ */
+bool
+MatViewPrepareLogs(Relation matviewRel, Query *query, bool skipData)
+{
+	StdRdOptFastRefresh mode = RelationGetFastRefresh(matviewRel);
+	List	   *existing = mlog_existing_logs(RelationGetRelid(matviewRel));
+	MLogView	view;
+	const char *reason;
+	ListCell   *lc;
+
+	if (mode == STDRD_OPTION_FAST_REFRESH_OFF || skipData)
+	{
+		mlog_drop_logs(existing);
+		return false;
+	}
+
+	reason = mlog_analyze_query(matviewRel, query, &view);
+	if (reason != NULL)
+	{
+		ereport(NOTICE,
+				(errmsg("materialized view \"%s\" cannot be refreshed incrementally",
+						RelationGetRelationName(matviewRel)),
+				 errdetail_internal("%s", reason),
+				 errhint("Each REFRESH will recompute the whole view.")));
+		mlog_drop_logs(existing);
+		return false;
+	}
+
+	if (mlog_find_logs(matviewRel, &view, existing))
+	{
+		SPI_connect();
+		foreach(lc, view.bases)
+		{
+			MLogBase   *base = (MLogBase *) lfirst(lc);
+			char	   *sql;
+
+			sql = psprintf("DELETE FROM %s",
+						   quote_qualified_identifier(get_namespace_name(get_rel_namespace(base->logid)),
+													  get_rel_name(base->logid)));
+			mlog_execute(sql, GetActiveSnapshot(), false, SPI_OK_DELETE);
+		}
+		if (SPI_finish() != SPI_OK_FINISH)
+			elog(ERROR, "SPI_finish failed");
+		return false;
+	}
+
+	/* Some are missing; start over with a fresh set */
+	mlog_drop_logs(existing);
+	foreach(lc, view.bases)
+		mlog_create_log(matviewRel, (MLogBase *) lfirst(lc));
+	CommandCounterIncrement();
+	return true;
+}
+
+/*
+ * PreCommit_MatViewRefresh
+ *		Refresh the materialized views with fast_refresh = commit whose base
+ *		tables the current transaction changed.
+ */
+void
+PreCommit_MatViewRefresh(void)
+{
+	if (pending_lxid != MyProc->vxid.lxid || pending_refreshes == NIL)
+		return;
+
+	/* Make the log rows written by the last statement visible */
+	CommandCounterIncrement();
+	PushActiveSnapshot(GetTransactionSnapshot());
+
+	while (pending_refreshes != NIL)
+	{
+		Oid			matviewOid = linitial_oid(pending_refreshes);
+		Relation	matviewRel;
+		bool		refresh;
+
+		pending_refreshes = list_delete_first(pending_refreshes);
+
+		/* Same lock as REFRESH MATERIALIZED VIEW */
+		LockRelationOid(matviewOid, ExclusiveLock);
+		matviewRel = try_relation_open(matviewOid, NoLock);
+		if (matviewRel == NULL)
+			continue;
+		refresh = matviewRel->rd_rel->relkind == RELKIND_MATVIEW &&
+			RelationIsPopulated(matviewRel) &&
+			RelationGetFastRefresh(matviewRel) == STDRD_OPTION_FAST_REFRESH_COMMIT;
+		relation_close(matviewRel, NoLock);
+
+		if (refresh)
+		{
+			RefreshMatViewByOid(matviewOid, false, false, false,
+								"REFRESH MATERIALIZED VIEW", NULL);
+			CommandCounterIncrement();
+		}
+	}
+
+	PopActiveSnapshot();
+}
+
+/*
+ * MatViewRefreshPending
+ *		Does the current transaction have materialized views to refresh
+ *		before it commits?
+ */
+bool
+MatViewRefreshPending(void)
+{
+	return pending_lxid == MyProc->vxid.lxid && pending_refreshes != NIL;
+}
+
+/*
+ * matview_log_trigger - trigger function that fills a change log.
+ *
+ * Fired AFTER each statement on a base table of a materialized view.  The
+ * arguments are the OIDs of the materialized view and of the log, followed
+ * by the numbers of the base table's columns that are logged.  Rows of the
+ * OLD TABLE are logged with sign -1 and rows of the NEW TABLE with sign +1;
+ * a TRUNCATE logs a single row with sign 0, which makes the next refresh
+ * recompute the view.
+ */
+Datum
+matview_log_trigger(PG_FUNCTION_ARGS)
+{
+	TriggerData *trigdata = (TriggerData *) fcinfo->context;
+	const char *funcname = "matview_log_trigger";
+	Trigger    *trigger;
+	Oid			matviewOid;
+	Relation	log;
+	Relation	matviewRel;
+	CommandId	cid = GetCurrentCommandId(true);
+	BulkInsertState bistate;
+
+	if (!CALLED_AS_TRIGGER(fcinfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_E_R_I_E_TRIGGER_PROTOCOL_VIOLATED),
+				 errmsg("function \"%s\" was not called by trigger manager",
+						funcname)));
+
+	if (!TRIGGER_FIRED_AFTER(trigdata->tg_event) ||
+		!TRIGGER_FIRED_FOR_STATEMENT(trigdata->tg_event))
+		ereport(ERROR,
+				(errcode(ERRCODE_E_R_I_E_TRIGGER_PROTOCOL_VIOLATED),
+				 errmsg("function \"%s\" must be fired AFTER STATEMENT",
+						funcname)));
+
+	trigger = trigdata->tg_trigger;
+	if (trigger->tgnargs < 2)
+		elog(ERROR, "wrong number of arguments for trigger \"%s\"",
+			 trigger->tgname);
+	matviewOid = atooid(trigger->tgargs[0]);
+
+	log = table_open(atooid(trigger->tgargs[1]), RowExclusiveLock);
+	bistate = GetBulkInsertState();
+
+	if (TRIGGER_FIRED_BY_TRUNCATE(trigdata->tg_event))
+	{
+		TupleDesc	logdesc = RelationGetDescr(log);
+		Datum	   *values = palloc0(logdesc->natts * sizeof(Datum));
+		bool	   *nulls = palloc(logdesc->natts * sizeof(bool));
+		HeapTuple	tuple;
+
+		memset(nulls, true, logdesc->natts * sizeof(bool));
+		values[logdesc->natts - 1] = Int32GetDatum(0);
+		nulls[logdesc->natts - 1] = false;
+		tuple = heap_form_tuple(logdesc, values, nulls);
+		heap_insert(log, tuple, cid, 0, bistate);
+		heap_freetuple(tuple);
+	}
+	else
+	{
+		TupleDesc	basedesc = RelationGetDescr(trigdata->tg_relation);
+
+		if (trigdata->tg_oldtable)
+			mlog_write_rows(log, trigdata->tg_oldtable, basedesc, trigger,
+							-1, cid, bistate);
+		if (trigdata->tg_newtable)
+			mlog_write_rows(log, trigdata->tg_newtable, basedesc, trigger,
+							1, cid, bistate);
+	}
+
+	FreeBulkInsertState(bistate);
+	table_close(log, NoLock);
+
+	/* Remember to refresh the view before commit if it asks for that */
+	matviewRel = try_relation_open(matviewOid, AccessShareLock);
+	if (matviewRel != NULL)
+	{
+		if (RelationGetFastRefresh(matviewRel) == STDRD_OPTION_FAST_REFRESH_COMMIT)
+		{
+			MemoryContext oldcxt;
+
+			if (pending_lxid != MyProc->vxid.lxid)
+			{
+				/* The list of an earlier transaction is gone with it */
+				pending_refreshes = NIL;
+				pending_lxid = MyProc->vxid.lxid;
+			}
+			oldcxt = MemoryContextSwitchTo(TopTransactionContext);
+			pending_refreshes = list_append_unique_oid(pending_refreshes,
+													   matviewOid);
+			MemoryContextSwitchTo(oldcxt);
+		}
+		relation_close(matviewRel, NoLock);
+	}
+
+	return PointerGetDatum(NULL);
+}
+
+/*
+ * Append the rows of a transition table to a change log.
+ */
+static void
+mlog_write_rows(Relation log, Tuplestorestate *rows, TupleDesc basedesc,
+				Trigger *trigger, int sign, CommandId cid,
+				BulkInsertState bistate)
+{
+	TupleDesc	logdesc = RelationGetDescr(log);
+	int			natts = trigger->tgnargs - 2;
+	AttrNumber *attnums = palloc(natts * sizeof(AttrNumber));
+	Datum	   *values = palloc(logdesc->natts * sizeof(Datum));
+	bool	   *nulls = palloc(logdesc->natts * sizeof(bool));
+	TupleTableSlot *slot;
+	MemoryContext rowcxt;
+	MemoryContext oldcxt;
+	int			readptr;
+
+	if (natts != logdesc->natts - 1)
+		elog(ERROR, "change log \"%s\" does not match trigger \"%s\"",
+			 RelationGetRelationName(log), trigger->tgname);
+	for (int i = 0; i < natts; i++)
+		attnums[i] = atoi(trigger->tgargs[i + 2]);
+
+	rowcxt = AllocSetContextCreate(CurrentMemoryContext,
+								   "matview log rows",
+								   ALLOCSET_DEFAULT_SIZES);
+	slot = MakeSingleTupleTableSlot(basedesc, &TTSOpsMinimalTuple);
+
+	/* Other triggers may read the same table, so use our own read pointer */
+	readptr = tuplestore_alloc_read_pointer(rows, EXEC_FLAG_REWIND);
+	tuplestore_select_read_pointer(rows, readptr);
+	tuplestore_rescan(rows);
+
+	while (tuplestore_gettupleslot(rows, true, false, slot))
+	{
+		HeapTuple	tuple;
+
+		CHECK_FOR_INTERRUPTS();
+
+		oldcxt = MemoryContextSwitchTo(rowcxt);
+		slot_getallattrs(slot);
+		for (int i = 0; i < natts; i++)
+		{
+			values[i] = slot->tts_values[attnums[i] - 1];
+			nulls[i] = slot->tts_isnull[attnums[i] - 1];
+		}
+		values[natts] = Int32GetDatum(sign);
+		nulls[natts] = false;
+
+		tuple = heap_form_tuple(logdesc, values, nulls);
+		heap_insert(log, tuple, cid, 0, bistate);
+		MemoryContextSwitchTo(oldcxt);
+		MemoryContextReset(rowcxt);
+	}
+
+	ExecDropSingleTupleTableSlot(slot);
+	MemoryContextDelete(rowcxt);
+}
+
+/*
+ * Check whether a materialized view's query can be maintained from change
+ * logs, and work out how.  Returns NULL if so, or else a translated sentence
+ * saying why not.
+ */
+static const char *
+mlog_analyze_query(Relation matviewRel, Query *query, MLogView *view)
+{
+	TupleDesc	tupdesc = RelationGetDescr(matviewRel);
+	Query	   *q = copyObject(query);
+	List	   *pexprs = NIL;
+	bool		has_count_star = false;
+	ListCell   *lc;
+	int			i;
+
+	memset(view, 0, sizeof(MLogView));
+
+	/* Lock the base tables, and look at the current state of their columns */
+	AcquireRewriteLocks(q, true, false);
+
+	if (q->setOperations != NULL)
+		return _("Its query uses UNION, INTERSECT or EXCEPT.");
+	if (q->cteList != NIL)
+		return _("Its query has a WITH clause.");
+	if (q->hasSubLinks)
+		return _("Its query contains a subquery.");
+	if (q->hasWindowFuncs)
+		return _("Its query uses window functions.");
+	if (q->hasTargetSRFs)
+		return _("Its query uses set-returning functions.");
+	if (q->distinctClause != NIL)
+		return _("Its query uses DISTINCT.");
+	if (q->limitCount != NULL || q->limitOffset != NULL)
+		return _("Its query uses LIMIT or OFFSET.");
+	if (q->groupingSets != NIL || q->groupDistinct)
+		return _("Its query uses grouping sets.");
+	if (q->havingQual != NULL)
+		return _("Its query has a HAVING clause.");
+	if (contain_mutable_functions((Node *) q))
+		return _("Its query uses functions that are not immutable.");
+
+	foreach(lc, q->rtable)
+	{
+		RangeTblEntry *rte = lfirst_node(RangeTblEntry, lc);
+		const char *reason;
+
+		switch (rte->rtekind)
+		{
+			case RTE_RELATION:
+				reason = mlog_analyze_base(q, rte, view);
+				if (reason != NULL)
+					return reason;
+				break;
+			case RTE_JOIN:
+				if (rte->jointype != JOIN_INNER)
+					return _("Its query uses an outer join.");
+				/* Base tables must stay visible to the delta queries */
+				if (rte->alias != NULL || rte->join_using_alias != NULL)
+					return _("Its query gives a join an alias.");
+				break;
+			case RTE_GROUP:
+				break;
+			default:
+				return _("Its query reads from something other than plain tables.");
+		}
+	}
+	if (view->bases == NIL)
+		return _("Its query does not read from any table.");
+
+	view->ncolumns = tupdesc->natts;
+	view->columns = palloc0(view->ncolumns * sizeof(MLogColumn));
+	view->grouped = q->hasAggs || q->groupClause != NIL;
+
+	/*
+	 * Work out the output columns of the pre-aggregation query: the columns
+	 * of the view if it has no aggregates, or else the GROUP BY keys followed
+	 * by the arguments of the aggregates.
+	 */
+	if (view->grouped)
+	{
+		foreach(lc, q->groupClause)
+		{
+			SortGroupClause *sgc = lfirst_node(SortGroupClause, lc);
+			TargetEntry *tle = get_sortgroupclause_tle(sgc, q->targetList);
+
+			if (tle->resjunk)
+				return _("Its query groups by an expression that is not in the select list.");
+			pexprs = lappend(pexprs,
+							 flatten_group_exprs(NULL, q, (Node *) tle->expr));
+		}
+		view->nkeys = list_length(pexprs);
+	}
+
+	i = 0;
+	foreach(lc, q->targetList)
+	{
+		TargetEntry *tle = lfirst_node(TargetEntry, lc);
+		MLogColumn *col;
+		Form_pg_attribute attr;
+
+		if (tle->resjunk)
+			continue;
+		if (i >= view->ncolumns)
+			elog(ERROR, "materialized view \"%s\" has fewer columns than its query",
+				 RelationGetRelationName(matviewRel));
+
+		col = &view->columns[i];
+		attr = TupleDescAttr(tupdesc, i);
+		col->name = quote_identifier(NameStr(attr->attname));
+		col->type = attr->atttypid;
+		col->countcol = -1;
+		i++;
+
+		if (!view->grouped)
+		{
+			TypeCacheEntry *typentry;
+
+			typentry = lookup_type_cache(col->type,
+										 TYPECACHE_EQ_OPR | TYPECACHE_LT_OPR |
+										 TYPECACHE_HASH_PROC);
+			if (!OidIsValid(typentry->eq_opr) ||
+				(!OidIsValid(typentry->lt_opr) &&
+				 !OidIsValid(typentry->hash_proc)))
+				return _("The type of one of its columns has no suitable equality operator.");
+
+			col->kind = MLOG_KEY;
+			col->eqop = typentry->eq_opr;
+			col->pcol = list_length(pexprs);
+			pexprs = lappend(pexprs, tle->expr);
+		}
+		else if (tle->ressortgroupref != 0)
+		{
+			ListCell   *lc2;
+			int			k = 0;
+
+			col->kind = MLOG_KEY;
+			col->pcol = -1;
+			foreach(lc2, q->groupClause)
+			{
+				SortGroupClause *sgc = lfirst_node(SortGroupClause, lc2);
+
+				if (sgc->tleSortGroupRef == tle->ressortgroupref)
+				{
+					col->pcol = k;
+					col->eqop = sgc->eqop;
+					break;
+				}
+				k++;
+			}
+			if (col->pcol < 0)
+				return _("One of its columns is neither a GROUP BY key nor an aggregate.");
+		}
+		else if (IsA(tle->expr, Aggref))
+		{
+			Aggref	   *aggref = (Aggref *) tle->expr;
+			const char *reason = mlog_analyze_aggref(aggref, col);
+
+			if (reason != NULL)
+				return reason;
+			if (col->kind == MLOG_COUNT_STAR)
+			{
+				col->pcol = -1;
+				has_count_star = true;
+			}
+			else
+			{
+				TargetEntry *arg = linitial_node(TargetEntry, aggref->args);
+
+				col->pcol = list_length(pexprs);
+				pexprs = lappend(pexprs,
+								 flatten_group_exprs(NULL, q, (Node *) arg->expr));
+			}
+		}
+		else
+			return _("One of its columns is neither a GROUP BY key nor an aggregate.");
+	}
+	if (i != view->ncolumns || i == 0)
+		elog(ERROR, "materialized view \"%s\" does not match its query",
+			 RelationGetRelationName(matviewRel));
+
+	if (view->grouped)
+	{
+		/*
+		 * A sum can only be maintained through deletions together with the
+		 * count of its argument, which says when it becomes NULL.  Groups
+		 * that lose rows are recomputed if that is missing, if there are
+		 * minimums or maximums, or if there is no count(*) to say when a
+		 * group disappears.
+		 */
+		view->recompute = !has_count_star;
+		for (i = 0; i < view->ncolumns; i++)
+		{
+			MLogColumn *col = &view->columns[i];
+
+			if (col->kind == MLOG_MIN || col->kind == MLOG_MAX)
+				view->recompute = true;
+			else if (col->kind == MLOG_SUM)
+			{
+				for (int j = 0; j < view->ncolumns; j++)
+				{
+					MLogColumn *other = &view->columns[j];
+
+					if (other->kind == MLOG_COUNT &&
+						equal(list_nth(pexprs, col->pcol),
+							  list_nth(pexprs, other->pcol)))
+					{
+						col->countcol = j;
+						break;
+					}
+				}
+				if (col->countcol < 0)
+					view->recompute = true;
+			}
+		}
+	}
+	else
+		view->nkeys = list_length(pexprs);
+
+	/* Turn the copy into the pre-aggregation query */
+	q->targetList = NIL;
+	i = 0;
+	foreach(lc, pexprs)
+	{
+		i++;
+		q->targetList = lappend(q->targetList,
+								makeTargetEntry((Expr *) lfirst(lc), i,
+												psprintf("c%d", i), false));
+	}
+	q->groupClause = NIL;
+	q->sortClause = NIL;
+	q->hasAggs = false;
+	if (q->hasGroupRTE)
+	{
+		Assert(llast_node(RangeTblEntry, q->rtable)->rtekind == RTE_GROUP);
+		q->rtable = list_delete_last(q->rtable);
+		q->hasGroupRTE = false;
+	}
+	view->pquery = q;
+	view->npcols = list_length(pexprs);
+
+	return NULL;
+}
+
+/*
+ * Check a base table of a materialized view, and note the columns the view
+ * reads from it.
+ */
+static const char *
+mlog_analyze_base(Query *query, RangeTblEntry *rte, MLogView *view)
+{
+	Relation	rel;
+	RTEPermissionInfo *perminfo;
+	MLogBase   *base;
+	const char *reason = NULL;
+	ListCell   *lc;
+	int			x;
+
+	/* AcquireRewriteLocks has locked it */
+	rel = table_open(rte->relid, NoLock);
+
+	if (rel->rd_rel->relkind != RELKIND_RELATION)
+		reason = _("Its query reads from a view, a foreign table or a partitioned table.");
+	else if (rel->rd_rel->relispartition || rel->rd_rel->relhassubclass)
+		reason = _("Its query reads from a table with inheritance children or parents.");
+	else if (rel->rd_rel->relrowsecurity)
+		reason = _("Its query reads from a table with row-level security.");
+	else if (rte->tablesample != NULL)
+		reason = _("Its query uses TABLESAMPLE.");
+	table_close(rel, NoLock);
+	if (reason != NULL)
+		return reason;
+
+	foreach(lc, rte->eref->colnames)
+	{
+		if (strcmp(strVal(lfirst(lc)), MLOG_SIGN_COLUMN) == 0)
+			return psprintf(_("Its query reads a column named \"%s\"."),
+							MLOG_SIGN_COLUMN);
+	}
+
+	base = mlog_get_base(view, rte->relid);
+	if (base == NULL)
+	{
+		base = palloc0(sizeof(MLogBase));
+		base->relid = rte->relid;
+		view->bases = lappend(view->bases, base);
+	}
+
+	perminfo = getRTEPermissionInfo(query->rteperminfos, rte);
+	x = -1;
+	while ((x = bms_next_member(perminfo->selectedCols, x)) >= 0)
+	{
+		AttrNumber	attnum = x + FirstLowInvalidHeapAttributeNumber;
+
+		if (attnum <= 0)
+			return _("Its query references a system column or a whole row.");
+		base->attrs = bms_add_member(base->attrs, attnum);
+	}
+
+	return NULL;
+}
+
+/*
+ * Check an aggregate in the select list, and set the kind of its column.
+ */
+static const char *
+mlog_analyze_aggref(Aggref *aggref, MLogColumn *col)
+{
+	char	   *name;
+
+	if (aggref->aggdistinct != NIL || aggref->aggorder != NIL ||
+		aggref->aggfilter != NULL || aggref->aggkind != AGGKIND_NORMAL ||
+		aggref->agglevelsup != 0)
+		return _("Its query uses DISTINCT, ORDER BY or FILTER in an aggregate.");
+
+	name = get_func_name(aggref->aggfnoid);
+	if (get_func_namespace(aggref->aggfnoid) != PG_CATALOG_NAMESPACE ||
+		name == NULL)
+		return _("Its query uses aggregates other than sum, count, min and max.");
+
+	if (strcmp(name, "count") == 0)
+		col->kind = aggref->aggstar ? MLOG_COUNT_STAR : MLOG_COUNT;
+	else if (strcmp(name, "sum") == 0)
+		col->kind = MLOG_SUM;
+	else if (strcmp(name, "min") == 0)
+		col->kind = MLOG_MIN;
+	else if (strcmp(name, "max") == 0)
+		col->kind = MLOG_MAX;
+	else
+		return _("Its query uses aggregates other than sum, count, min and max.");
+
+	if (col->kind != MLOG_COUNT_STAR && list_length(aggref->args) != 1)
+		return _("Its query uses aggregates other than sum, count, min and max.");
+
+	return NULL;
+}
+
+static MLogBase *
+mlog_get_base(MLogView *view, Oid relid)
+{
+	ListCell   *lc;
+
+	foreach(lc, view->bases)
+	{
+		MLogBase   *base = (MLogBase *) lfirst(lc);
+
+		if (base->relid == relid)
+			return base;
+	}
+	return NULL;
+}
+
+/*
+ * Returns the OIDs of the change logs of a materialized view, which are the
+ * tables that depend on it automatically.
+ */
+static List *
+mlog_existing_logs(Oid matviewOid)
+{
+	Relation	depRel;
+	ScanKeyData key[2];
+	SysScanDesc scan;
+	HeapTuple	tup;
+	List	   *result = NIL;
+
+	depRel = table_open(DependRelationId, AccessShareLock);
+
+	ScanKeyInit(&key[0],
+				Anum_pg_depend_refclassid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(RelationRelationId));
+	ScanKeyInit(&key[1],
+				Anum_pg_depend_refobjid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(matviewOid));
+
+	scan = systable_beginscan(depRel, DependReferenceIndexId, true,
+							  NULL, 2, key);
+
+	while (HeapTupleIsValid(tup = systable_getnext(scan)))
+	{
+		Form_pg_depend depform = (Form_pg_depend) GETSTRUCT(tup);
+
+		if (depform->classid == RelationRelationId &&
+			depform->objsubid == 0 &&
+			depform->deptype == DEPENDENCY_AUTO &&
+			get_rel_relkind(depform->objid) == RELKIND_RELATION)
+			result = lappend_oid(result, depform->objid);
+	}
+
+	systable_endscan(scan);
+	table_close(depRel, AccessShareLock);
+
+	return result;
+}
+
+/*
+ * Look up the change log of each base table.  Returns true if they all
+ * exist.
+ */
+static bool
+mlog_find_logs(Relation matviewRel, MLogView *view, List *existing)
+{
+	ListCell   *lc;
+	bool		found = true;
+
+	foreach(lc, view->bases)
+	{
+		MLogBase   *base = (MLogBase *) lfirst(lc);
+
+		base->logid = get_relname_relid(mlog_log_name(RelationGetRelid(matviewRel),
+													  base->relid),
+										RelationGetNamespace(matviewRel));
+		if (!list_member_oid(existing, base->logid))
+		{
+			base->logid = InvalidOid;
+			found = false;
+		}
+	}
+
+	return found;
+}
+
+static char *
+mlog_log_name(Oid matviewOid, Oid relid)
+{
+	return psprintf("pg_mlog_%u_%u", matviewOid, relid);
+}
+
+/*
+ * Create the change log of a base table, and the triggers that fill it.
+ *
+ * The log has the base table's columns that the view reads, followed by the
+ * sign column.  It lives in the schema of the materialized view and goes
+ * away with it.
+ */
+static void
+mlog_create_log(Relation matviewRel, MLogBase *base)
+{
+	Relation	rel;
+	TupleDesc	tupdesc;
+	CreateStmt *create = makeNode(CreateStmt);
+	List	   *columns = NIL;
+	ObjectAddress logaddr;
+	ObjectAddress mvaddr;
+	AclResult	aclresult;
+	int			x;
+
+	rel = table_open(base->relid, NoLock);
+	tupdesc = RelationGetDescr(rel);
+
+	aclresult = pg_class_aclcheck(base->relid, GetUserId(), ACL_TRIGGER);
+	if (aclresult != ACLCHECK_OK)
+		aclcheck_error(aclresult, get_relkind_objtype(rel->rd_rel->relkind),
+					   RelationGetRelationName(rel));
+
+	x = -1;
+	while ((x = bms_next_member(base->attrs, x)) >= 0)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, x - 1);
+
+		columns = lappend(columns,
+						  makeColumnDef(NameStr(attr->attname), attr->atttypid,
+										attr->atttypmod, attr->attcollation));
+	}
+	columns = lappend(columns,
+					  makeColumnDef(MLOG_SIGN_COLUMN, INT4OID, -1, InvalidOid));
+
+	create->relation = makeRangeVar(get_namespace_name(RelationGetNamespace(matviewRel)),
+									mlog_log_name(RelationGetRelid(matviewRel),
+												  base->relid),
+									-1);
+	create->relation->relpersistence = rel->rd_rel->relpersistence;
+	create->tableElts = columns;
+	create->oncommit = ONCOMMIT_NOOP;
+	/* The trigger writes heap tuples directly */
+	create->accessMethod = "heap";
+	create->if_not_exists = false;
+
+	logaddr = DefineRelation(create, RELKIND_RELATION, InvalidOid, NULL, NULL);
+	CommandCounterIncrement();
+	NewRelationCreateToastTable(logaddr.objectId, (Datum) 0);
+
+	ObjectAddressSet(mvaddr, RelationRelationId, RelationGetRelid(matviewRel));
+	recordDependencyOn(&logaddr, &mvaddr, DEPENDENCY_AUTO);
+	base->logid = logaddr.objectId;
+
+	/* A trigger with transition tables can only have a single event */
+	mlog_create_trigger(matviewRel, base, TRIGGER_TYPE_INSERT, false, true);
+	mlog_create_trigger(matviewRel, base, TRIGGER_TYPE_DELETE, true, false);
+	mlog_create_trigger(matviewRel, base, TRIGGER_TYPE_UPDATE, true, true);
+	mlog_create_trigger(matviewRel, base, TRIGGER_TYPE_TRUNCATE, false, false);
+
+	table_close(rel, NoLock);
+}
+
+static void
+mlog_create_trigger(Relation matviewRel, MLogBase *base, int16 event,
+					bool oldtable, bool newtable)
+{
+	CreateTrigStmt *trigger = makeNode(CreateTrigStmt);
+	ObjectAddress trigaddr;
+	ObjectAddress logaddr;
+	List	   *args;
+	int			x;
+
+	args = list_make2(makeString(psprintf("%u", RelationGetRelid(matviewRel))),
+					  makeString(psprintf("%u", base->logid)));
+	x = -1;
+	while ((x = bms_next_member(base->attrs, x)) >= 0)
+		args = lappend(args, makeString(psprintf("%d", x)));
+
+	trigger->replace = false;
+	trigger->isconstraint = false;
+	trigger->trigname = "pg_mlog";
+	trigger->relation = NULL;
+	trigger->funcname = SystemFuncName("matview_log_trigger");
+	trigger->args = args;
+	trigger->row = false;
+	trigger->timing = TRIGGER_TYPE_AFTER;
+	trigger->events = event;
+	trigger->columns = NIL;
+	trigger->whenClause = NULL;
+	trigger->transitionRels = NIL;
+	if (oldtable)
+	{
+		TriggerTransition *tt = makeNode(TriggerTransition);
+
+		tt->name = "mlog$old";
+		tt->isNew = false;
+		tt->isTable = true;
+		trigger->transitionRels = lappend(trigger->transitionRels, tt);
+	}
+	if (newtable)
+	{
+		TriggerTransition *tt = makeNode(TriggerTransition);
+
+		tt->name = "mlog$new";
+		tt->isNew = true;
+		tt->isTable = true;
+		trigger->transitionRels = lappend(trigger->transitionRels, tt);
+	}
+	trigger->deferrable = false;
+	trigger->initdeferred = false;
+	trigger->constrrel = NULL;
+
+	/* Fire in replicas too, so changes applied by replication are logged */
+	trigaddr = CreateTriggerFiringOn(trigger, NULL, base->relid, InvalidOid,
+									 InvalidOid, InvalidOid,
+									 F_MATVIEW_LOG_TRIGGER, InvalidOid,
+									 NULL, true, false,
+									 TRIGGER_FIRES_ALWAYS);
+
+	/* The trigger is part of the log, and can't be dropped on its own */
+	ObjectAddressSet(logaddr, RelationRelationId, base->logid);
+	recordDependencyOn(&trigaddr, &logaddr, DEPENDENCY_INTERNAL);
+}
+
+/*
+ * Drop change logs, and with them their triggers.
+ */
+static void
+mlog_drop_logs(List *logs)
+{
+	ObjectAddresses *objects;
+	ListCell   *lc;
+
+	if (logs == NIL)
+		return;
+
+	objects = new_object_addresses();
+	foreach(lc, logs)
+	{
+		ObjectAddress object;
+
+		ObjectAddressSet(object, RelationRelationId, lfirst_oid(lc));
+		add_exact_object_address(&object, objects);
+	}
+	performMultipleDeletions(objects, DROP_RESTRICT, PERFORM_DELETION_INTERNAL);
+	free_object_addresses(objects);
+	CommandCounterIncrement();
+}
+
+/*
+ * Run a query with the given snapshot.
+ */
+static void
+mlog_execute(const char *sql, Snapshot snapshot, bool read_only, int expected)
+{
+	SPIPlanPtr	plan;
+
+	plan = SPI_prepare(sql, 0, NULL);
+	if (plan == NULL)
+		elog(ERROR, "SPI_prepare failed for \"%s\": %s",
+			 sql, SPI_result_code_string(SPI_result));
+	if (SPI_execute_snapshot(plan, NULL, NULL, snapshot, InvalidSnapshot,
+							 read_only, true, 0) != expected)
+		elog(ERROR, "SPI_execute_snapshot failed: %s", sql);
+	SPI_freeplan(plan);
+}
+
+/*
+ * Build one term of the change of the pre-aggregation query: the query with
+ * the base table at range table index "term" replaced by its change log,
+ * and the changed base tables after it by their contents before the
+ * changes.  An extra output column holds the product of the signs.
+ */
+static char *
+mlog_delta_term(MLogView *view, int term)
+{
+	Query	   *q = copyObject(view->pquery);
+	Node	   *sign = NULL;
+	ListCell   *lc;
+	int			rti = 0;
+
+	foreach(lc, q->rtable)
+	{
+		RangeTblEntry *rte = lfirst_node(RangeTblEntry, lc);
+		MLogBase   *base;
+		Var		   *var;
+
+		rti++;
+		if (rte->rtekind != RTE_RELATION)
+			continue;
+
+		base = mlog_get_base(view, rte->relid);
+		if (rti == term)
+			mlog_replace_rte(rte, base, false);
+		else if (rti > term && base->changed)
+			mlog_replace_rte(rte, base, true);
+		else
+			continue;
+
+		var = makeVar(rti, list_length(rte->eref->colnames), INT4OID, -1,
+					  InvalidOid, 0);
+		if (sign == NULL)
+			sign = (Node *) var;
+		else
+			sign = (Node *) makeFuncExpr(F_INT4MUL, INT4OID,
+										 list_make2(sign, var),
+										 InvalidOid, InvalidOid,
+										 COERCE_EXPLICIT_CALL);
+	}
+
+	q->targetList = lappend(q->targetList,
+							makeTargetEntry((Expr *) sign,
+											list_length(q->targetList) + 1,
+											pstrdup(MLOG_SIGN_COLUMN),
+											false));
+
+	return pg_get_querydef(q, false);
+}
+
+/*
+ * Replace a base table in a copy of the pre-aggregation query by a subquery
+ * over its change log, or over its contents before the logged changes.
+ *
+ * The subquery returns the table's columns at their own positions, so the
+ * Vars of the query keep pointing at the right ones; columns the view does
+ * not read are NULL.  Its last column is the sign.
+ */
+static void
+mlog_replace_rte(RangeTblEntry *rte, MLogBase *base, bool old_state)
+{
+	Relation	rel = table_open(base->relid, NoLock);
+	Relation	log = table_open(base->logid, NoLock);
+	TupleDesc	reldesc = RelationGetDescr(rel);
+	TupleDesc	logdesc = RelationGetDescr(log);
+	StringInfoData basecols;
+	StringInfoData logcols;
+	StringInfoData sql;
+	List	   *colnames = NIL;
+	RawStmt    *raw;
+	int			logattnum = 0;
+	AttrNumber	attnum = 0;
+	ListCell   *lc;
+
+	initStringInfo(&basecols);
+	initStringInfo(&logcols);
+
+	foreach(lc, rte->eref->colnames)
+	{
+		char	   *colname = strVal(lfirst(lc));
+		Form_pg_attribute attr = TupleDescAttr(reldesc, attnum);
+		const char *alias;
+
+		attnum++;
+		if (colname[0] == '\0' || attr->attisdropped)
+		{
+			/*
+			 * Keep the position of a dropped column.  It needs a name, since
+			 * the deparsed query lists the columns of the subquery.
+			 */
+			colname = psprintf("mlog$dropped%d", attnum);
+			appendStringInfo(&basecols, "NULL::pg_catalog.int4 AS \"%s\", ",
+							 colname);
+			appendStringInfo(&logcols, "NULL::pg_catalog.int4 AS \"%s\", ",
+							 colname);
+			colnames = lappend(colnames, makeString(colname));
+			continue;
+		}
+
+		alias = quote_identifier(colname);
+		colnames = lappend(colnames, makeString(pstrdup(colname)));
+		if (bms_is_member(attnum, base->attrs))
+		{
+			Form_pg_attribute logattr = TupleDescAttr(logdesc, logattnum++);
+
+			appendStringInfo(&basecols, "b.%s AS %s, ",
+							 quote_identifier(NameStr(attr->attname)), alias);
+			appendStringInfo(&logcols, "l.%s AS %s, ",
+							 quote_identifier(NameStr(logattr->attname)), alias);
+		}
+		else
+		{
+			char	   *type = format_type_extended(attr->atttypid,
+													attr->atttypmod,
+													FORMAT_TYPE_TYPEMOD_GIVEN |
+													FORMAT_TYPE_FORCE_QUALIFY);
+
+			appendStringInfo(&basecols, "NULL::%s AS %s, ", type, alias);
+			appendStringInfo(&logcols, "NULL::%s AS %s, ", type, alias);
+		}
+	}
+
+	initStringInfo(&sql);
+	if (old_state)
+		appendStringInfo(&sql,
+						 "SELECT %s1 AS \"%s\" FROM ONLY %s b UNION ALL "
+						 "SELECT %sOPERATOR(pg_catalog.-) l.\"%s\" FROM %s l",
+						 basecols.data, MLOG_SIGN_COLUMN,
+						 quote_qualified_identifier(get_namespace_name(RelationGetNamespace(rel)),
+													RelationGetRelationName(rel)),
+						 logcols.data, MLOG_SIGN_COLUMN,
+						 quote_qualified_identifier(get_namespace_name(RelationGetNamespace(log)),
+													RelationGetRelationName(log)));
+	else
+		appendStringInfo(&sql,
+						 "SELECT %sl.\"%s\" FROM %s l",
+						 logcols.data, MLOG_SIGN_COLUMN,
+						 quote_qualified_identifier(get_namespace_name(RelationGetNamespace(log)),
+													RelationGetRelationName(log)));
+
+	table_close(log, NoLock);
+	table_close(rel, NoLock);
+
+	raw = linitial_node(RawStmt, pg_parse_query(sql.data));
+
+	rte->rtekind = RTE_SUBQUERY;
+	rte->subquery = parse_analyze_fixedparams(raw, sql.data, NULL, 0, NULL);
+	rte->relid = InvalidOid;
+	rte->relkind = 0;
+	rte->rellockmode = 0;
+	rte->inh = false;
+	rte->perminfoindex = 0;
+	rte->tablesample = NULL;
+	rte->alias = makeAlias(rte->eref->aliasname, NIL);
+	rte->eref = makeAlias(rte->eref->aliasname,
+						  lappend(colnames,
+								  makeString(pstrdup(MLOG_SIGN_COLUMN))));
+}
+
+/*
+ * Compute the change of the view from the logs, apply it, and empty the
+ * logs.  Returns the number of rows of the view that were changed.
+ */
+static uint64
+mlog_apply(Relation matviewRel, MLogView *view, Snapshot snapshot,
+		   Oid relowner, int save_sec_context)
+{
+	StringInfoData buf;
+	StringInfoData terms;
+	char	   *matviewname;
+	char	   *deltaname;
+	char	   *deltarel;
+	uint64		processed = 0;
+	ListCell   *lc;
+	int			rti;
+	int			i;
+
+	matviewname = quote_qualified_identifier(get_namespace_name(RelationGetNamespace(matviewRel)),
+											 RelationGetRelationName(matviewRel));
+	deltarel = psprintf("pg_mlog_delta_%u", RelationGetRelid(matviewRel));
+	deltaname = quote_qualified_identifier("pg_temp", deltarel);
+
+	/*
+	 * Create the table for the change of the view.  Without aggregates it
+	 * holds the distinct rows and how many copies of each to add (or remove,
+	 * if negative).  With aggregates it holds for each group the number of
+	 * rows added and removed, and the aggregates over the arguments of the
+	 * rows added and removed.
+	 */
+	initStringInfo(&buf);
+	appendStringInfo(&buf, "CREATE TEMP TABLE %s (", quote_identifier(deltarel));
+	for (i = 0; i < view->nkeys; i++)
+	{
+		TargetEntry *tle = list_nth_node(TargetEntry, view->pquery->targetList, i);
+		Oid			collid = exprCollation((Node *) tle->expr);
+
+		appendStringInfo(&buf, "c%d %s", i + 1,
+						 format_type_extended(exprType((Node *) tle->expr),
+											  exprTypmod((Node *) tle->expr),
+											  FORMAT_TYPE_TYPEMOD_GIVEN |
+											  FORMAT_TYPE_FORCE_QUALIFY));
+		if (OidIsValid(collid))
+			appendStringInfo(&buf, " COLLATE %s",
+							 generate_collation_name(collid));
+		appendStringInfoString(&buf, ", ");
+	}
+	if (!view->grouped)
+		appendStringInfoString(&buf, "\"mlog$count\" pg_catalog.int8)");
+	else
+	{
+		appendStringInfoString(&buf,
+							   "\"mlog$ins\" pg_catalog.int8, \"mlog$del\" pg_catalog.int8");
+		for (i = 0; i < view->ncolumns; i++)
+		{
+			MLogColumn *col = &view->columns[i];
+			char	   *type = format_type_extended(col->type, -1,
+													FORMAT_TYPE_FORCE_QUALIFY);
+
+			switch (col->kind)
+			{
+				case MLOG_COUNT:
+				case MLOG_SUM:
+					appendStringInfo(&buf, ", i%d %s, d%d %s",
+									 i + 1, type, i + 1, type);
+					break;
+				case MLOG_MIN:
+				case MLOG_MAX:
+					appendStringInfo(&buf, ", i%d %s", i + 1, type);
+					break;
+				default:
+					break;
+			}
+		}
+		appendStringInfoChar(&buf, ')');
+	}
+
+	/* Temp tables can't be created in a security-restricted operation */
+	SetUserIdAndSecContext(relowner,
+						   save_sec_context | SECURITY_LOCAL_USERID_CHANGE);
+	if (SPI_exec(buf.data, 0) != SPI_OK_UTILITY)
+		elog(ERROR, "SPI_exec failed: %s", buf.data);
+	SetUserIdAndSecContext(relowner,
+						   save_sec_context | SECURITY_RESTRICTED_OPERATION);
+
+	/* The change of the pre-aggregation query, one term per changed table */
+	initStringInfo(&terms);
+	rti = 0;
+	foreach(lc, view->pquery->rtable)
+	{
+		RangeTblEntry *rte = lfirst_node(RangeTblEntry, lc);
+
+		rti++;
+		if (rte->rtekind != RTE_RELATION ||
+			!mlog_get_base(view, rte->relid)->changed)
+			continue;
+		if (terms.len > 0)
+			appendStringInfoString(&terms, " UNION ALL ");
+		appendStringInfo(&terms, "(%s)", mlog_delta_term(view, rti));
+	}
+
+	/* Fill the delta table */
+	resetStringInfo(&buf);
+	appendStringInfo(&buf, "INSERT INTO %s SELECT ", deltaname);
+	for (i = 0; i < view->nkeys; i++)
+		appendStringInfo(&buf, "t.c%d, ", i + 1);
+	if (!view->grouped)
+		appendStringInfo(&buf, "pg_catalog.sum(t.\"%s\")", MLOG_SIGN_COLUMN);
+	else
+	{
+		appendStringInfo(&buf,
+						 "pg_catalog.count(*) FILTER (WHERE t.\"%s\" OPERATOR(pg_catalog.>) 0), "
+						 "pg_catalog.count(*) FILTER (WHERE t.\"%s\" OPERATOR(pg_catalog.<) 0)",
+						 MLOG_SIGN_COLUMN, MLOG_SIGN_COLUMN);
+		for (i = 0; i < view->ncolumns; i++)
+		{
+			MLogColumn *col = &view->columns[i];
+			const char *aggname;
+
+			switch (col->kind)
+			{
+				case MLOG_COUNT:
+					aggname = "count";
+					break;
+				case MLOG_SUM:
+					aggname = "sum";
+					break;
+				case MLOG_MIN:
+					aggname = "min";
+					break;
+				case MLOG_MAX:
+					aggname = "max";
+					break;
+				default:
+					continue;
+			}
+			appendStringInfo(&buf,
+							 ", pg_catalog.%s(t.c%d) FILTER (WHERE t.\"%s\" OPERATOR(pg_catalog.>) 0)",
+							 aggname, col->pcol + 1, MLOG_SIGN_COLUMN);
+			if (col->kind == MLOG_COUNT || col->kind == MLOG_SUM)
+				appendStringInfo(&buf,
+								 ", pg_catalog.%s(t.c%d) FILTER (WHERE t.\"%s\" OPERATOR(pg_catalog.<) 0)",
+								 aggname, col->pcol + 1, MLOG_SIGN_COLUMN);
+		}
+	}
+	appendStringInfo(&buf, " FROM (%s) t", terms.data);
+	for (i = 0; i < view->nkeys; i++)
+		appendStringInfo(&buf, "%st.c%d", i == 0 ? " GROUP BY " : ", ", i + 1);
+	if (!view->grouped)
+		appendStringInfo(&buf,
+						 " HAVING pg_catalog.sum(t.\"%s\") OPERATOR(pg_catalog.<>) 0",
+						 MLOG_SIGN_COLUMN);
+	mlog_execute(buf.data, snapshot, false, SPI_OK_INSERT);
+
+	resetStringInfo(&buf);
+	appendStringInfo(&buf, "ANALYZE %s", deltaname);
+	if (SPI_exec(buf.data, 0) != SPI_OK_UTILITY)
+		elog(ERROR, "SPI_exec failed: %s", buf.data);
+
+	if (!view->grouped)
+	{
+		/*
+		 * Remove as many copies of each row as it lost, then add as many as
+		 * it gained.
+		 */
+		resetStringInfo(&buf);
+		appendStringInfo(&buf,
+						 "DELETE FROM %s WHERE ctid OPERATOR(pg_catalog.=) ANY "
+						 "(SELECT x.tid FROM (SELECT mv.ctid AS tid, "
+						 "pg_catalog.row_number() OVER (PARTITION BY d.ctid) AS n, "
+						 "d.\"mlog$count\" AS c FROM %s mv JOIN %s d ON ",
+						 matviewname, matviewname, deltaname);
+		mlog_append_keymatch(&buf, view, "mv", true, "d");
+		appendStringInfoString(&buf,
+							   " WHERE d.\"mlog$count\" OPERATOR(pg_catalog.<) 0) x "
+							   "WHERE (x.n OPERATOR(pg_catalog.+) x.c) OPERATOR(pg_catalog.<=) 0)");
+		mlog_execute(buf.data, snapshot, false, SPI_OK_DELETE);
+		processed += SPI_processed;
+
+		resetStringInfo(&buf);
+		appendStringInfoString(&buf, "INSERT INTO ");
+		appendStringInfoString(&buf, matviewname);
+		appendStringInfoString(&buf, " SELECT ");
+		for (i = 0; i < view->ncolumns; i++)
+			appendStringInfo(&buf, "%sd.c%d", i > 0 ? ", " : "",
+							 view->columns[i].pcol + 1);
+		appendStringInfo(&buf,
+						 " FROM %s d, pg_catalog.generate_series(1, d.\"mlog$count\") "
+						 "WHERE d.\"mlog$count\" OPERATOR(pg_catalog.>) 0",
+						 deltaname);
+		mlog_execute(buf.data, snapshot, false, SPI_OK_INSERT);
+		processed += SPI_processed;
+	}
+	else
+	{
+		StringInfoData cond;
+		StringInfoData sets;
+		StringInfoData vals;
+		bool		recompute_all = false;
+
+		if (view->nkeys == 0 && view->recompute)
+		{
+			/* A view without GROUP BY has one row, so recompute it all */
+			resetStringInfo(&buf);
+			appendStringInfo(&buf,
+							 "SELECT 1 FROM %s d WHERE d.\"mlog$del\" OPERATOR(pg_catalog.>) 0",
+							 deltaname);
+			mlog_execute(buf.data, snapshot, true, SPI_OK_SELECT);
+			recompute_all = SPI_processed > 0;
+		}
+
+		if (recompute_all)
+		{
+			resetStringInfo(&buf);
+			appendStringInfo(&buf, "DELETE FROM %s", matviewname);
+			mlog_execute(buf.data, snapshot, false, SPI_OK_DELETE);
+			processed += SPI_processed;
+
+			resetStringInfo(&buf);
+			appendStringInfo(&buf, "INSERT INTO %s %s", matviewname,
+							 mlog_recompute_query(view, deltaname, NULL));
+			mlog_execute(buf.data, snapshot, false, SPI_OK_INSERT);
+			processed += SPI_processed;
+		}
+		else if (view->recompute && view->nkeys > 0)
+		{
+			/* Recompute the groups that lost rows */
+			resetStringInfo(&buf);
+			appendStringInfo(&buf,
+							 "DELETE FROM %s mv WHERE EXISTS (SELECT 1 FROM %s d "
+							 "WHERE d.\"mlog$del\" OPERATOR(pg_catalog.>) 0 AND ",
+							 matviewname, deltaname);
+			mlog_append_keymatch(&buf, view, "mv", true, "d");
+			appendStringInfoChar(&buf, ')');
+			mlog_execute(buf.data, snapshot, false, SPI_OK_DELETE);
+			processed += SPI_processed;
+
+			resetStringInfo(&buf);
+			appendStringInfo(&buf, "INSERT INTO %s %s", matviewname,
+							 mlog_recompute_query(view, deltaname,
+												  "d.\"mlog$del\" OPERATOR(pg_catalog.>) 0"));
+			mlog_execute(buf.data, snapshot, false, SPI_OK_INSERT);
+			processed += SPI_processed;
+		}
+		else if (!view->recompute && view->nkeys > 0)
+		{
+			int			countstar;
+
+			/* Remove the groups whose last rows were removed */
+			for (countstar = 0; countstar < view->ncolumns; countstar++)
+			{
+				if (view->columns[countstar].kind == MLOG_COUNT_STAR)
+					break;
+			}
+			Assert(countstar < view->ncolumns);
+
+			resetStringInfo(&buf);
+			appendStringInfo(&buf, "DELETE FROM %s mv USING %s d WHERE ",
+							 matviewname, deltaname);
+			mlog_append_keymatch(&buf, view, "mv", true, "d");
+			appendStringInfo(&buf,
+							 " AND ((mv.%s OPERATOR(pg_catalog.+) d.\"mlog$ins\") "
+							 "OPERATOR(pg_catalog.-) d.\"mlog$del\") OPERATOR(pg_catalog.=) 0",
+							 view->columns[countstar].name);
+			mlog_execute(buf.data, snapshot, false, SPI_OK_DELETE);
+			processed += SPI_processed;
+		}
+
+		if (!recompute_all)
+		{
+			/*
+			 * Fold the change into the other existing groups, and add the new
+			 * ones.  Groups recomputed above are left alone.
+			 */
+			initStringInfo(&cond);
+			if (view->recompute)
+				appendStringInfoString(&cond,
+									   "d.\"mlog$del\" OPERATOR(pg_catalog.=) 0");
+
+			initStringInfo(&sets);
+			initStringInfo(&vals);
+			for (i = 0; i < view->ncolumns; i++)
+			{
+				MLogColumn *col = &view->columns[i];
+				char	   *mvcol = psprintf("mv.%s", col->name);
+				char	   *ins = psprintf("d.i%d", i + 1);
+				char	   *del = psprintf("d.d%d", i + 1);
+				StringInfoData expr;
+
+				if (vals.len > 0)
+					appendStringInfoString(&vals, ", ");
+				if (col->kind == MLOG_KEY)
+				{
+					appendStringInfo(&vals, "d.c%d", col->pcol + 1);
+					continue;
+				}
+
+				initStringInfo(&expr);
+				if (sets.len > 0)
+					appendStringInfoString(&sets, ", ");
+				appendStringInfo(&sets, "%s = ", col->name);
+
+				switch (col->kind)
+				{
+					case MLOG_COUNT_STAR:
+						ins = "d.\"mlog$ins\"";
+						del = "d.\"mlog$del\"";
+						/* FALLTHROUGH */
+					case MLOG_COUNT:
+						resetStringInfo(&expr);
+						mlog_append_op(&expr, mvcol, "+", ins);
+						mlog_append_op(&sets, expr.data, "-", del);
+						mlog_append_op(&vals, ins, "-", del);
+						break;
+					case MLOG_SUM:
+						{
+							StringInfoData sum;
+
+							/* NULLs are absent values, not unknown ones */
+							initStringInfo(&sum);
+							appendStringInfoString(&sum, "COALESCE(");
+							mlog_append_op(&sum, mvcol, "+", ins);
+							appendStringInfo(&sum, ", %s, %s)", mvcol, ins);
+
+							if (col->countcol >= 0)
+							{
+								/* NULL again once no values are left */
+								char	   *cins = psprintf("d.i%d", col->countcol + 1);
+								char	   *cdel = psprintf("d.d%d", col->countcol + 1);
+
+								appendStringInfoString(&sets, "CASE WHEN ");
+								resetStringInfo(&expr);
+								mlog_append_op(&expr,
+											   psprintf("mv.%s", view->columns[col->countcol].name),
+											   "+", cins);
+								mlog_append_op(&sets, expr.data, "-", cdel);
+								appendStringInfoString(&sets,
+													   " OPERATOR(pg_catalog.=) 0 THEN NULL ELSE COALESCE(");
+								mlog_append_op(&sets, sum.data, "-", del);
+								appendStringInfo(&sets, ", %s) END", sum.data);
+
+								appendStringInfoString(&vals, "CASE WHEN ");
+								mlog_append_op(&vals, cins, "-", cdel);
+								appendStringInfoString(&vals,
+													   " OPERATOR(pg_catalog.=) 0 THEN NULL ELSE COALESCE(");
+								mlog_append_op(&vals, ins, "-", del);
+								appendStringInfo(&vals, ", %s) END", ins);
+							}
+							else
+							{
+								appendStringInfoString(&sets, sum.data);
+								appendStringInfoString(&vals, ins);
+							}
+						}
+						break;
+					case MLOG_MIN:
+						appendStringInfo(&sets, "LEAST(%s, %s)", mvcol, ins);
+						appendStringInfoString(&vals, ins);
+						break;
+					case MLOG_MAX:
+						appendStringInfo(&sets, "GREATEST(%s, %s)", mvcol, ins);
+						appendStringInfoString(&vals, ins);
+						break;
+					case MLOG_KEY:
+						Assert(false);
+						break;
+				}
+			}
+
+			if (sets.len > 0)
+			{
+				resetStringInfo(&buf);
+				appendStringInfo(&buf, "UPDATE %s mv SET %s FROM %s d WHERE ",
+								 matviewname, sets.data, deltaname);
+				mlog_append_keymatch(&buf, view, "mv", true, "d");
+				if (cond.len > 0)
+					appendStringInfo(&buf, " AND %s", cond.data);
+				mlog_execute(buf.data, snapshot, false, SPI_OK_UPDATE);
+				processed += SPI_processed;
+			}
+
+			if (view->nkeys > 0)
+			{
+				resetStringInfo(&buf);
+				appendStringInfo(&buf,
+								 "INSERT INTO %s SELECT %s FROM %s d WHERE "
+								 "(d.\"mlog$ins\" OPERATOR(pg_catalog.-) d.\"mlog$del\") "
+								 "OPERATOR(pg_catalog.>) 0",
+								 matviewname, vals.data, deltaname);
+				if (cond.len > 0)
+					appendStringInfo(&buf, " AND %s", cond.data);
+				appendStringInfo(&buf, " AND NOT EXISTS (SELECT 1 FROM %s mv WHERE ",
+								 matviewname);
+				mlog_append_keymatch(&buf, view, "mv", true, "d");
+				appendStringInfoChar(&buf, ')');
+				mlog_execute(buf.data, snapshot, false, SPI_OK_INSERT);
+				processed += SPI_processed;
+			}
+		}
+	}
+
+	/* The changes visible to our snapshot are in the view now */
+	foreach(lc, view->bases)
+	{
+		MLogBase   *base = (MLogBase *) lfirst(lc);
+
+		if (!base->changed)
+			continue;
+		resetStringInfo(&buf);
+		appendStringInfo(&buf, "DELETE FROM %s",
+						 quote_qualified_identifier(get_namespace_name(get_rel_namespace(base->logid)),
+													get_rel_name(base->logid)));
+		mlog_execute(buf.data, snapshot, false, SPI_OK_DELETE);
+	}
+
+	resetStringInfo(&buf);
+	appendStringInfo(&buf, "DROP TABLE %s", deltaname);
+	if (SPI_exec(buf.data, 0) != SPI_OK_UTILITY)
+		elog(ERROR, "SPI_exec failed: %s", buf.data);
+
+	return processed;
+}
+
+/*
+ * Append a condition matching the keys of the view, or of the delta table,
+ * to those of the delta table.  NULL keys match each other.
+ */
+static void
+mlog_append_keymatch(StringInfo buf, MLogView *view, const char *left,
+					 bool left_is_view, const char *right)
+{
+	bool		first = true;
+
+	for (int i = 0; i < view->ncolumns; i++)
+	{
+		MLogColumn *col = &view->columns[i];
+		char	   *leftop;
+		char	   *rightop;
+		Oid			type;
+
+		if (col->kind != MLOG_KEY)
+			continue;
+
+		if (left_is_view)
+			leftop = psprintf("%s.%s", left, col->name);
+		else
+			leftop = psprintf("%s.c%d", left, col->pcol + 1);
+		rightop = psprintf("%s.c%d", right, col->pcol + 1);
+		type = exprType((Node *) list_nth_node(TargetEntry,
+											   view->pquery->targetList,
+											   col->pcol)->expr);
+
+		if (!first)
+			appendStringInfoString(buf, " AND ");
+		first = false;
+		appendStringInfoChar(buf, '(');
+		generate_operator_clause(buf, leftop, type, col->eqop, rightop, type);
+		appendStringInfo(buf, " OR (%s IS NULL AND %s IS NULL))",
+						 leftop, rightop);
+	}
+
+	if (first)
+		appendStringInfoString(buf, "true");
+}
+
+/*
+ * Append "(left OPERATOR(pg_catalog.op) right)".
+ */
+static void
+mlog_append_op(StringInfo buf, const char *left, const char *op,
+			   const char *right)
+{
+	appendStringInfo(buf, "(%s OPERATOR(pg_catalog.%s) %s)", left, op, right);
+}
+
+/*
+ * Build a query computing the rows of the view from the base tables, for
+ * the groups of the delta table that satisfy "filter", or for the whole view
+ * if filter is NULL.
+ */
+static char *
+mlog_recompute_query(MLogView *view, const char *deltaname,
+					 const char *filter)
+{
+	StringInfoData buf;
+	int			i;
+
+	initStringInfo(&buf);
+	appendStringInfoString(&buf, "SELECT ");
+	for (i = 0; i < view->ncolumns; i++)
+	{
+		MLogColumn *col = &view->columns[i];
+
+		if (i > 0)
+			appendStringInfoString(&buf, ", ");
+		switch (col->kind)
+		{
+			case MLOG_KEY:
+				appendStringInfo(&buf, "p.c%d", col->pcol + 1);
+				break;
+			case MLOG_COUNT_STAR:
+				appendStringInfoString(&buf, "pg_catalog.count(*)");
+				break;
+			case MLOG_COUNT:
+				appendStringInfo(&buf, "pg_catalog.count(p.c%d)", col->pcol + 1);
+				break;
+			case MLOG_SUM:
+				appendStringInfo(&buf, "pg_catalog.sum(p.c%d)", col->pcol + 1);
+				break;
+			case MLOG_MIN:
+				appendStringInfo(&buf, "pg_catalog.min(p.c%d)", col->pcol + 1);
+				break;
+			case MLOG_MAX:
+				appendStringInfo(&buf, "pg_catalog.max(p.c%d)", col->pcol + 1);
+				break;
+		}
+	}
+	appendStringInfo(&buf, " FROM (%s) p",
+					 pg_get_querydef(copyObject(view->pquery), false));
+	if (filter != NULL)
+	{
+		appendStringInfo(&buf, " WHERE EXISTS (SELECT 1 FROM %s d WHERE %s AND ",
+						 deltaname, filter);
+		mlog_append_keymatch(&buf, view, "p", false, "d");
+		appendStringInfoChar(&buf, ')');
+	}
+	for (i = 0; i < view->nkeys; i++)
+		appendStringInfo(&buf, "%sp.c%d", i == 0 ? " GROUP BY " : ", ", i + 1);
+
+	return buf.data;
+}
@@ -15431,25 +15431,11 @@ ATExecAlterColumnType(AlteredTableInfo *tab, Relation rel,
 				}
 				break;
 			case PackageRelationId:
-				{
-					PackageCacheKey pkey;
-					PackageCacheItem *item;
-
-					/* get package cache */
-					pkey = objectId;
-					if (PackageCacheIsValid(&pkey, false))
-						item = PackageCacheLookup(&pkey);
-					else
-						item = PackageHandle(pkey, false);
-
-					if (item != NULL)
-						item->cachestatus = PACKAGE_SET_SPECIFICATION_UPDATE_FLAG(item->cachestatus);
-				}
+				PackageCacheMarkUpdated(objectId, false);
 				break;
 			case PackageBodyRelationId:
 				{
 					PackageCacheKey pkey;
-					PackageCacheItem *item;
 					HeapTuple pkgbodyTup;
 					Form_pg_package_body pkgbodyStruct;
 
@@ -15463,13 +15449,7 @@ ATExecAlterColumnType(AlteredTableInfo *tab, Relation rel,
 					pkgbodyStruct = (Form_pg_package_body) GETSTRUCT(pkgbodyTup);
 					pkey = pkgbodyStruct->pkgoid;
 
-					if (PackageCacheIsValid(&pkey, false))
-						item = PackageCacheLookup(&pkey);
-					else
-						item = PackageHandle(pkey, false);
-
-					if (item != NULL)
-						item->cachestatus = PACKAGE_SET_BODY_UPDATE_FLAG(item->cachestatus);
+					PackageCacheMarkUpdated(pkey, true);
 
 					ReleaseSysCache(pkgbodyTup);
 				}
@@ -23031,25 +23011,11 @@ check_function_dependency_internal(Relation depRel, SysScanDesc scan)
 				}
 				break;
 			case PackageRelationId:
-				{
-					PackageCacheKey pkey;
-					PackageCacheItem *item;
-
-					/* get package cache */
-					pkey = objectId;
-					if (PackageCacheIsValid(&pkey, false))
-						item = PackageCacheLookup(&pkey);
-					else
-						item = PackageHandle(pkey, false);
-
-					if (item != NULL)
-						item->cachestatus = PACKAGE_SET_SPECIFICATION_UPDATE_FLAG(item->cachestatus);
-				}
+				PackageCacheMarkUpdated(objectId, false);
 				break;
 			case PackageBodyRelationId:
 				{
 					PackageCacheKey pkey;
-					PackageCacheItem *item;
 					HeapTuple pkgbodyTup;
 					Form_pg_package_body pkgbodyStruct;
 
@@ -23064,13 +23030,7 @@ check_function_dependency_internal(Relation depRel, SysScanDesc scan)
 					pkgbodyStruct = (Form_pg_package_body) GETSTRUCT(pkgbodyTup);
 					pkey = pkgbodyStruct->pkgoid;
 
-					if (PackageCacheIsValid(&pkey, false))
-						item = PackageCacheLookup(&pkey);
-					else
-						item = PackageHandle(pkey, false);
-
-					if (item != NULL)
-						item->cachestatus = PACKAGE_SET_BODY_UPDATE_FLAG(item->cachestatus);
+					PackageCacheMarkUpdated(pkey, true);
 
 					ReleaseSysCache(pkgbodyTup);
 				}
@@ -123,6 +123,9 @@ ExecReScan(PlanState *node)
 			UpdateChangedParamSet(innerPlanState(node), node->chgParam);
 	}
 
+	/* ROWNUM numbering starts over */
+	node->ps_rownum = 0;
+
 	/* Call expression callbacks */
 	if (node->ps_ExprContext)
 		ReScanExprContext(node->ps_ExprContext);
@@ -514,6 +514,17 @@ ExecBuildProjectionInfo(List *targetList,
 		}
 	}
 
+	/*
+	 * If the node numbers its rows with ROWNUM, every projected row is an
+	 * emitted row, so count it once all columns have been computed.
+	 */
+	if (parent && ExecPlanUsesRownum(parent->plan))
+	{
+		scratch.opcode = EEOP_ROWNUM_INCREMENT;
+		scratch.d.rownum.counter = &parent->ps_rownum;
+		ExprEvalPushStep(state, &scratch);
+	}
+
 	scratch.opcode = EEOP_DONE_NO_RETURN;
 	ExprEvalPushStep(state, &scratch);
 
@@ -2646,6 +2657,19 @@ ExecInitExprRec(Expr *node, ExprState *state,
 				break;
 			}
 
+		case T_RownumExpr:
+			{
+				/* the counter lives in the plan node emitting the rows */
+				if (state->parent == NULL)
+					elog(ERROR, "ROWNUM found outside a plan node");
+
+				scratch.opcode = EEOP_ROWNUM;
+				scratch.d.rownum.counter = &state->parent->ps_rownum;
+
+				ExprEvalPushStep(state, &scratch);
+				break;
+			}
+
 		case T_ReturningExpr:
 			{
 				ReturningExpr *rexpr = (ReturningExpr *) node;
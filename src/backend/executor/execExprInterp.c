@@ -552,6 +552,8 @@ ExecInterpExpr(ExprState *state, ExprContext *econtext, bool *isnull)
 		&&CASE_EEOP_SQLVALUEFUNCTION,
 		&&CASE_EEOP_CURRENTOFEXPR,
 		&&CASE_EEOP_NEXTVALUEEXPR,
+		&&CASE_EEOP_ROWNUM,
+		&&CASE_EEOP_ROWNUM_INCREMENT,
 		&&CASE_EEOP_RETURNINGEXPR,
 		&&CASE_EEOP_ARRAYEXPR,
 		&&CASE_EEOP_ARRAYCOERCE,
@@ -1593,6 +1595,20 @@ ExecInterpExpr(ExprState *state, ExprContext *econtext, bool *isnull)
 			EEO_NEXT();
 		}
 
+		EEO_CASE(EEOP_ROWNUM)
+		{
+			ExecEvalRownum(state, op);
+
+			EEO_NEXT();
+		}
+
+		EEO_CASE(EEOP_ROWNUM_INCREMENT)
+		{
+			ExecEvalRownumIncrement(state, op);
+
+			EEO_NEXT();
+		}
+
 		EEO_CASE(EEOP_RETURNINGEXPR)
 		{
 			/*
@@ -3322,6 +3338,25 @@ ExecEvalNextValueExpr(ExprState *state, ExprEvalStep *op)
 	*op->resnull = false;
 }
 
+/*
+ * Evaluate ROWNUM: the number the current row will get if it is emitted.
+ */
+void
+ExecEvalRownum(ExprState *state, ExprEvalStep *op)
+{
+	*op->resvalue = Int64GetDatum(*op->d.rownum.counter + 1);
+	*op->resnull = false;
+}
+
+/*
+ * Count a row emitted by a plan node that evaluates ROWNUM.
+ */
+void
+ExecEvalRownumIncrement(ExprState *state, ExprEvalStep *op)
+{
+	(*op->d.rownum.counter)++;
+}
+
 /*
  * Evaluate NullTest / IS NULL for rows.
  */
@@ -1697,9 +1697,34 @@ ExecutePlan(QueryDesc *queryDesc,
 		use_parallel_mode = queryDesc->plannedstmt->parallelModeNeeded;
 	queryDesc->already_executed = true;
 
+	/*
+	 * In a parallel UPDATE or DELETE, the workers only scan and the leader
+	 * performs all the modifications.  That's safe as long as the leader
+	 * can't allocate a combo CID, which is guaranteed if our transaction
+	 * hasn't written anything before this statement: tuples it writes now
+	 * are invisible to the statement's own snapshot.  Otherwise, and under
+	 * SERIALIZABLE, just run the plan without workers.  The transaction ID
+	 * must be assigned before entering parallel mode.
+	 */
+	if (use_parallel_mode && operation != CMD_SELECT)
+	{
+		Assert(operation == CMD_UPDATE || operation == CMD_DELETE);
+
+		if (TransactionIdIsValid(GetTopTransactionIdIfAny()) ||
+			IsolationIsSerializable())
+			use_parallel_mode = false;
+		else
+			(void) GetCurrentTransactionId();
+	}
+
 	estate->es_use_parallel_mode = use_parallel_mode;
 	if (use_parallel_mode)
-		EnterParallelMode();
+	{
+		if (operation != CMD_SELECT)
+			EnterParallelModeForDML();
+		else
+			EnterParallelMode();
+	}
 
 	/*
 	 * Loop until we've processed the proper number of tuples from the plan.
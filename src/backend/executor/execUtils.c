@@ -53,6 +53,7 @@
 #include "jit/jit.h"
 #include "mb/pg_wchar.h"
 #include "miscadmin.h"
+#include "optimizer/optimizer.h"
 #include "parser/parse_relation.h"
 #include "partitioning/partdesc.h"
 #include "storage/lmgr.h"
@@ -603,10 +604,12 @@ void
 ExecConditionalAssignProjectionInfo(PlanState *planstate, TupleDesc inputDesc,
 									int varno)
 {
+	/* A node numbering rows with ROWNUM counts them while projecting */
 	if (tlist_matches_tupdesc(planstate,
 							  planstate->plan->targetlist,
 							  varno,
-							  inputDesc))
+							  inputDesc) &&
+		!ExecPlanUsesRownum(planstate->plan))
 	{
 		planstate->ps_ProjInfo = NULL;
 		planstate->resultopsset = planstate->scanopsset;
@@ -626,6 +629,33 @@ ExecConditionalAssignProjectionInfo(PlanState *planstate, TupleDesc inputDesc,
 	}
 }
 
+/*
+ * ExecPlanUsesRownum
+ *
+ * Does the plan node evaluate ROWNUM in its quals or targetlist?  Such a
+ * node keeps a count of emitted rows in ps_rownum, which its projection
+ * advances.
+ */
+bool
+ExecPlanUsesRownum(Plan *plan)
+{
+	if (plan == NULL)
+		return false;
+	if (contain_rownum((Node *) plan->qual) ||
+		contain_rownum((Node *) plan->targetlist))
+		return true;
+
+	switch (nodeTag(plan))
+	{
+		case T_NestLoop:
+		case T_MergeJoin:
+		case T_HashJoin:
+			return contain_rownum((Node *) ((Join *) plan)->joinqual);
+		default:
+			return false;
+	}
+}
+
 static bool
 tlist_matches_tupdesc(PlanState *ps, List *tlist, int varno, TupleDesc tupdesc)
 {
@@ -269,10 +269,12 @@
 #include "utils/datum.h"
 #include "utils/dynahash.h"
 #include "utils/expandeddatum.h"
+#include "utils/guc.h"
 #include "utils/injection_point.h"
 #include "utils/logtape.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
+#include "utils/membroker.h"
 #include "utils/memutils_memorychunk.h"
 #include "utils/syscache.h"
 #include "utils/tuplesort.h"
@@ -422,6 +424,7 @@ static void agg_fill_hash_table(AggState *aggstate);
 static bool agg_refill_hash_table(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table_in_memory(AggState *aggstate);
+static void hash_agg_apply_grant(AggState *aggstate);
 static void hash_agg_check_limits(AggState *aggstate);
 static void hash_agg_enter_spill_mode(AggState *aggstate);
 static void hash_agg_update_metrics(AggState *aggstate, bool from_tape,
@@ -1856,6 +1859,25 @@ hash_agg_set_limits(double hashentrysize, double input_groups, int used_bits,
 		*ngroups_limit = 1;
 }
 
+/*
+ * Scale the limits set by hash_agg_set_limits from hash_mem to the memory
+ * broker's grant, if we have one.
+ */
+static void
+hash_agg_apply_grant(AggState *aggstate)
+{
+	double		scale;
+
+	if (aggstate->hash_mem_grant == 0)
+		return;
+
+	scale = (double) aggstate->hash_mem_grant * 1024 /
+		(double) get_hash_memory_limit();
+	aggstate->hash_mem_limit = (Size) (aggstate->hash_mem_limit * scale);
+	aggstate->hash_ngroups_limit =
+		Max((uint64) (aggstate->hash_ngroups_limit * scale), 1);
+}
+
 /*
  * hash_agg_check_limits
  *
@@ -2695,6 +2717,7 @@ agg_refill_hash_table(AggState *aggstate)
 	hash_agg_set_limits(aggstate->hashentrysize, batch->input_card,
 						batch->used_bits, &aggstate->hash_mem_limit,
 						&aggstate->hash_ngroups_limit, NULL);
+	hash_agg_apply_grant(aggstate);
 
 	/*
 	 * Each batch only processes one grouping set; set the rest to NULL so
@@ -3719,7 +3742,14 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 
 		/* Skip massive memory allocation if we are just doing EXPLAIN */
 		if (!(eflags & EXEC_FLAG_EXPLAIN_ONLY))
+		{
+			aggstate->hash_mem_grant =
+				MemoryBrokerAcquire((int) Min(get_hash_memory_limit() / 1024,
+											  MAX_KILOBYTES),
+									&aggstate->hash_mem_grant_handle);
+			hash_agg_apply_grant(aggstate);
 			build_hash_tables(aggstate);
+		}
 
 		aggstate->table_filled = false;
 
@@ -4440,6 +4470,9 @@ ExecEndAgg(AggState *node)
 		node->hash_tablecxt = NULL;
 	}
 
+	MemoryBrokerRelease(node->hash_mem_grant_handle);
+	node->hash_mem_grant = 0;
+	node->hash_mem_grant_handle = InvalidMemoryBrokerHandle;
 
 	for (transno = 0; transno < node->numtrans; transno++)
 	{
@@ -37,11 +37,21 @@
 #include "miscadmin.h"
 #include "port/pg_bitutils.h"
 #include "utils/dynahash.h"
+#include "utils/guc.h"
 #include "utils/lsyscache.h"
+#include "utils/membroker.h"
 #include "utils/memutils.h"
 #include "utils/syscache.h"
 #include "utils/wait_event.h"
 
+static void choose_hash_table_size(double ntuples, int tupwidth, bool useskew,
+								   bool try_combined_hash_mem,
+								   int parallel_workers,
+								   size_t hash_mem_limit,
+								   size_t *space_allowed,
+								   int *numbuckets,
+								   int *numbatches,
+								   int *num_skew_mcvs);
 static void ExecHashIncreaseNumBatches(HashJoinTable hashtable);
 static void ExecHashIncreaseNumBuckets(HashJoinTable hashtable);
 static void ExecParallelHashIncreaseNumBatches(HashJoinTable hashtable);
@@ -449,6 +459,9 @@ ExecHashTableCreate(HashState *state)
 	HashJoinTable hashtable;
 	Plan	   *outerNode;
 	size_t		space_allowed;
+	size_t		hash_mem_limit;
+	int			mem_grant = 0;
+	MemoryBrokerHandle mem_grant_handle = InvalidMemoryBrokerHandle;
 	int			nbuckets;
 	int			nbatch;
 	double		rows;
@@ -471,13 +484,29 @@ ExecHashTableCreate(HashState *state)
 	 */
 	rows = node->plan.parallel_aware ? node->rows_total : outerNode->plan_rows;
 
-	ExecChooseHashTableSize(rows, outerNode->plan_width,
-							OidIsValid(node->skewTable),
-							state->parallel_state != NULL,
-							state->parallel_state != NULL ?
-							state->parallel_state->nparticipants - 1 : 0,
-							&space_allowed,
-							&nbuckets, &nbatch, &num_skew_mcvs);
+	/*
+	 * Ask the memory broker how much memory we can use instead of hash_mem.
+	 * A Parallel Hash table is shared by all participants, and sized by each
+	 * of them, so it keeps to hash_mem.
+	 */
+	hash_mem_limit = get_hash_memory_limit();
+	if (state->parallel_state == NULL)
+	{
+		mem_grant = MemoryBrokerAcquire((int) Min(hash_mem_limit / 1024,
+												  MAX_KILOBYTES),
+										&mem_grant_handle);
+		if (mem_grant > 0)
+			hash_mem_limit = (size_t) mem_grant * 1024;
+	}
+
+	choose_hash_table_size(rows, outerNode->plan_width,
+						   OidIsValid(node->skewTable),
+						   state->parallel_state != NULL,
+						   state->parallel_state != NULL ?
+						   state->parallel_state->nparticipants - 1 : 0,
+						   hash_mem_limit,
+						   &space_allowed,
+						   &nbuckets, &nbatch, &num_skew_mcvs);
 
 	/* nbuckets must be a power of 2 */
 	log2_nbuckets = my_log2(nbuckets);
@@ -515,6 +544,8 @@ ExecHashTableCreate(HashState *state)
 	hashtable->spaceUsed = 0;
 	hashtable->spacePeak = 0;
 	hashtable->spaceAllowed = space_allowed;
+	hashtable->mem_grant = mem_grant;
+	hashtable->mem_grant_handle = mem_grant_handle;
 	hashtable->spaceUsedSkew = 0;
 	hashtable->spaceAllowedSkew =
 		hashtable->spaceAllowed * SKEW_HASH_MEM_PERCENT / 100;
@@ -662,6 +693,29 @@ ExecChooseHashTableSize(double ntuples, int tupwidth, bool useskew,
 						int *numbuckets,
 						int *numbatches,
 						int *num_skew_mcvs)
+{
+	choose_hash_table_size(ntuples, tupwidth, useskew,
+						   try_combined_hash_mem, parallel_workers,
+						   get_hash_memory_limit(),
+						   space_allowed,
+						   numbuckets,
+						   numbatches,
+						   num_skew_mcvs);
+}
+
+/*
+ * Workhorse for ExecChooseHashTableSize, with the memory limit of a single
+ * process given by hash_mem_limit instead of hash_mem.
+ */
+static void
+choose_hash_table_size(double ntuples, int tupwidth, bool useskew,
+					   bool try_combined_hash_mem,
+					   int parallel_workers,
+					   size_t hash_mem_limit,
+					   size_t *space_allowed,
+					   int *numbuckets,
+					   int *numbatches,
+					   int *num_skew_mcvs)
 {
 	int			tupsize;
 	double		inner_rel_bytes;
@@ -686,10 +740,7 @@ ExecChooseHashTableSize(double ntuples, int tupwidth, bool useskew,
 		MAXALIGN(tupwidth);
 	inner_rel_bytes = ntuples * tupsize;
 
-	/*
-	 * Compute in-memory hashtable size limit from GUCs.
-	 */
-	hash_table_bytes = get_hash_memory_limit();
+	hash_table_bytes = hash_mem_limit;
 
 	/*
 	 * Parallel Hash tries to use the combined hash_mem of all workers to
@@ -806,12 +857,13 @@ ExecChooseHashTableSize(double ntuples, int tupwidth, bool useskew,
 		 */
 		if (try_combined_hash_mem)
 		{
-			ExecChooseHashTableSize(ntuples, tupwidth, useskew,
-									false, parallel_workers,
-									space_allowed,
-									numbuckets,
-									numbatches,
-									num_skew_mcvs);
+			choose_hash_table_size(ntuples, tupwidth, useskew,
+								   false, parallel_workers,
+								   hash_mem_limit,
+								   space_allowed,
+								   numbuckets,
+								   numbatches,
+								   num_skew_mcvs);
 			return;
 		}
 
@@ -969,6 +1021,7 @@ ExecHashTableDestroy(HashJoinTable hashtable)
 
 	/* Release working memory (batchCxt is a child, so it goes away too) */
 	MemoryContextDelete(hashtable->hashCxt);
+	MemoryBrokerRelease(hashtable->mem_grant_handle);
 
 	/* And drop the control block */
 	pfree(hashtable);
@@ -24,6 +24,7 @@
 #include "executor/executor.h"
 #include "executor/nodeMaterial.h"
 #include "miscadmin.h"
+#include "utils/membroker.h"
 
 /* ----------------------------------------------------------------
  *		ExecMaterial
@@ -61,7 +62,14 @@ ExecMaterial(PlanState *pstate)
 	 */
 	if (tuplestorestate == NULL && node->eflags != 0)
 	{
-		tuplestorestate = tuplestore_begin_heap(true, false, work_mem);
+		/* on rescan, keep the grant we got the first time */
+		if (node->mem_grant == 0)
+			node->mem_grant = MemoryBrokerAcquire(work_mem,
+												  &node->mem_grant_handle);
+
+		tuplestorestate = tuplestore_begin_heap(true, false,
+												MemoryBrokerLimit(node->mem_grant,
+																  work_mem));
 		tuplestore_set_eflags(tuplestorestate, node->eflags);
 		if (node->eflags & EXEC_FLAG_MARK)
 		{
@@ -196,6 +204,8 @@ ExecInitMaterial(Material *node, EState *estate, int eflags)
 
 	matstate->eof_underlying = false;
 	matstate->tuplestorestate = NULL;
+	matstate->mem_grant = 0;
+	matstate->mem_grant_handle = InvalidMemoryBrokerHandle;
 
 	/*
 	 * Miscellaneous initialization
@@ -246,6 +256,10 @@ ExecEndMaterial(MaterialState *node)
 		tuplestore_end(node->tuplestorestate);
 	node->tuplestorestate = NULL;
 
+	MemoryBrokerRelease(node->mem_grant_handle);
+	node->mem_grant = 0;
+	node->mem_grant_handle = InvalidMemoryBrokerHandle;
+
 	/*
 	 * shut down the subplan
 	 */
@@ -109,18 +109,30 @@ ExecResult(PlanState *pstate)
 		if (outerPlan != NULL)
 		{
 			/*
-			 * retrieve tuples from the outer plan until there are no more.
+			 * retrieve tuples from the outer plan until there are no more,
+			 * skipping any that fail our per-row qual.  The planner only
+			 * gives a Result with an outer plan such a qual when it must be
+			 * checked above an Append, as for ROWNUM.
 			 */
-			outerTupleSlot = ExecProcNode(outerPlan);
+			for (;;)
+			{
+				outerTupleSlot = ExecProcNode(outerPlan);
 
-			if (TupIsNull(outerTupleSlot))
-				return NULL;
+				if (TupIsNull(outerTupleSlot))
+					return NULL;
 
-			/*
-			 * prepare to compute projection expressions, which will expect to
-			 * access the input tuples as varno OUTER.
-			 */
-			econtext->ecxt_outertuple = outerTupleSlot;
+				/*
+				 * prepare to compute projection expressions, which will
+				 * expect to access the input tuples as varno OUTER.
+				 */
+				econtext->ecxt_outertuple = outerTupleSlot;
+
+				if (node->ps.qual == NULL || ExecQual(node->ps.qual, econtext))
+					break;
+
+				InstrCountFiltered1(node, 1);
+				ResetExprContext(econtext);
+			}
 		}
 		else
 		{
@@ -19,6 +19,7 @@
 #include "executor/execdebug.h"
 #include "executor/nodeSort.h"
 #include "miscadmin.h"
+#include "utils/membroker.h"
 #include "utils/tuplesort.h"
 
 
@@ -102,12 +103,18 @@ ExecSort(PlanState *pstate)
 		if (node->bounded)
 			tuplesortopts |= TUPLESORT_ALLOWBOUNDED;
 
+		/* on rescan, keep the grant we got the first time */
+		if (node->mem_grant == 0)
+			node->mem_grant = MemoryBrokerAcquire(work_mem,
+												  &node->mem_grant_handle);
+
 		if (node->datumSort)
 			tuplesortstate = tuplesort_begin_datum(TupleDescAttr(tupDesc, 0)->atttypid,
 												   plannode->sortOperators[0],
 												   plannode->collations[0],
 												   plannode->nullsFirst[0],
-												   work_mem,
+												   MemoryBrokerLimit(node->mem_grant,
+																	 work_mem),
 												   NULL,
 												   tuplesortopts);
 		else
@@ -117,7 +124,8 @@ ExecSort(PlanState *pstate)
 												  plannode->sortOperators,
 												  plannode->collations,
 												  plannode->nullsFirst,
-												  work_mem,
+												  MemoryBrokerLimit(node->mem_grant,
+																	work_mem),
 												  NULL,
 												  tuplesortopts);
 		if (node->bounded)
@@ -246,6 +254,8 @@ ExecInitSort(Sort *node, EState *estate, int eflags)
 	sortstate->bounded = false;
 	sortstate->sort_Done = false;
 	sortstate->tuplesortstate = NULL;
+	sortstate->mem_grant = 0;
+	sortstate->mem_grant_handle = InvalidMemoryBrokerHandle;
 
 	/*
 	 * Miscellaneous initialization
@@ -310,6 +320,10 @@ ExecEndSort(SortState *node)
 		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
 	node->tuplesortstate = NULL;
 
+	MemoryBrokerRelease(node->mem_grant_handle);
+	node->mem_grant = 0;
+	node->mem_grant_handle = InvalidMemoryBrokerHandle;
+
 	/*
 	 * shut down the subplan
 	 */
@@ -1723,6 +1723,18 @@ llvm_compile_expr(ExprState *state)
 				LLVMBuildBr(b, opblocks[opno + 1]);
 				break;
 
+			case EEOP_ROWNUM:
+				build_EvalXFunc(b, mod, "ExecEvalRownum",
+								v_state, op);
+				LLVMBuildBr(b, opblocks[opno + 1]);
+				break;
+
+			case EEOP_ROWNUM_INCREMENT:
+				build_EvalXFunc(b, mod, "ExecEvalRownumIncrement",
+								v_state, op);
+				LLVMBuildBr(b, opblocks[opno + 1]);
+				break;
+
 			case EEOP_RETURNINGEXPR:
 				{
 					LLVMBasicBlockRef b_isnull;
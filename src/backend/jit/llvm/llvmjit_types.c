@@ -160,6 +160,8 @@ void	   *referenced_functions[] =
 	ExecEvalParamExtern,
 	ExecEvalParamSet,
 	ExecEvalRow,
+	ExecEvalRownum,
+	ExecEvalRownumIncrement,
 	ExecEvalRowNotNull,
 	ExecEvalRowNull,
 	ExecEvalCoerceViaIOSafe,
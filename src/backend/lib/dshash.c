@@ -165,7 +165,8 @@ struct dshash_table
 
 static void delete_item(dshash_table *hash_table,
 						dshash_table_item *item);
-static void resize(dshash_table *hash_table, size_t new_size_log2);
+static bool resize(dshash_table *hash_table, size_t new_size_log2,
+				   int flags);
 static inline void ensure_valid_bucket_pointers(dshash_table *hash_table);
 static inline dshash_table_item *find_in_bucket(dshash_table *hash_table,
 												const void *key,
@@ -176,7 +177,8 @@ static void insert_item_into_bucket(dshash_table *hash_table,
 									dsa_pointer *bucket);
 static dshash_table_item *insert_into_bucket(dshash_table *hash_table,
 											 const void *key,
-											 dsa_pointer *bucket);
+											 dsa_pointer *bucket,
+											 int flags);
 static bool delete_key_from_bucket(dshash_table *hash_table,
 								   const void *key,
 								   dsa_pointer *bucket_head);
@@ -433,6 +435,20 @@ void *
 dshash_find_or_insert(dshash_table *hash_table,
 					  const void *key,
 					  bool *found)
+{
+	return dshash_find_or_insert_extended(hash_table, key, found, 0);
+}
+
+/*
+ * Like dshash_find_or_insert, but with flags.  If DSHASH_INSERT_NO_OOM is
+ * given and the area has no room for a new entry, NULL is returned instead
+ * of raising an error, and no lock is held.
+ */
+void *
+dshash_find_or_insert_extended(dshash_table *hash_table,
+							   const void *key,
+							   bool *found,
+							   int flags)
 {
 	dshash_hash hash;
 	size_t		partition_index;
@@ -475,14 +491,20 @@ restart:
 			 * reacquire all the locks in the right order to avoid deadlocks.
 			 */
 			LWLockRelease(PARTITION_LOCK(hash_table, partition_index));
-			resize(hash_table, hash_table->size_log2 + 1);
+			if (!resize(hash_table, hash_table->size_log2 + 1, flags))
+				return NULL;
 
 			goto restart;
 		}
 
 		/* Finally we can try to insert the new item. */
 		item = insert_into_bucket(hash_table, key,
-								  &BUCKET_FOR_HASH(hash_table, hash));
+								  &BUCKET_FOR_HASH(hash_table, hash), flags);
+		if (item == NULL)
+		{
+			LWLockRelease(PARTITION_LOCK(hash_table, partition_index));
+			return NULL;
+		}
 		item->hash = hash;
 		/* Adjust per-lock-partition counter for load factor knowledge. */
 		++partition->count;
@@ -852,10 +874,13 @@ delete_item(dshash_table *hash_table, dshash_table_item *item)
  * Grow the hash table if necessary to the requested number of buckets.  The
  * requested size must be double some previously observed size.
  *
+ * Returns false if DSHASH_INSERT_NO_OOM is in flags and the new bucket array
+ * couldn't be allocated.
+ *
  * Must be called without any partition lock held.
  */
-static void
-resize(dshash_table *hash_table, size_t new_size_log2)
+static bool
+resize(dshash_table *hash_table, size_t new_size_log2, int flags)
 {
 	dsa_pointer old_buckets;
 	dsa_pointer new_buckets_shared;
@@ -880,7 +905,7 @@ resize(dshash_table *hash_table, size_t new_size_log2)
 			 * obtaining all the locks and return early.
 			 */
 			LWLockRelease(PARTITION_LOCK(hash_table, 0));
-			return;
+			return true;
 		}
 	}
 
@@ -890,7 +915,15 @@ resize(dshash_table *hash_table, size_t new_size_log2)
 	new_buckets_shared =
 		dsa_allocate_extended(hash_table->area,
 							  sizeof(dsa_pointer) * new_size,
-							  DSA_ALLOC_HUGE | DSA_ALLOC_ZERO);
+							  DSA_ALLOC_HUGE | DSA_ALLOC_ZERO |
+							  ((flags & DSHASH_INSERT_NO_OOM) ?
+							   DSA_ALLOC_NO_OOM : 0));
+	if (!DsaPointerIsValid(new_buckets_shared))
+	{
+		for (i = 0; i < DSHASH_NUM_PARTITIONS; ++i)
+			LWLockRelease(PARTITION_LOCK(hash_table, i));
+		return false;
+	}
 	new_buckets = dsa_get_address(hash_table->area, new_buckets_shared);
 
 	/*
@@ -926,6 +959,8 @@ resize(dshash_table *hash_table, size_t new_size_log2)
 	/* Release all the locks. */
 	for (i = 0; i < DSHASH_NUM_PARTITIONS; ++i)
 		LWLockRelease(PARTITION_LOCK(hash_table, i));
+
+	return true;
 }
 
 /*
@@ -980,19 +1015,25 @@ insert_item_into_bucket(dshash_table *hash_table,
 
 /*
  * Allocate space for an entry with the given key and insert it into the
- * provided bucket.
+ * provided bucket.  Returns NULL if DSHASH_INSERT_NO_OOM is in flags and
+ * there's no space.
  */
 static dshash_table_item *
 insert_into_bucket(dshash_table *hash_table,
 				   const void *key,
-				   dsa_pointer *bucket)
+				   dsa_pointer *bucket,
+				   int flags)
 {
 	dsa_pointer item_pointer;
 	dshash_table_item *item;
 
-	item_pointer = dsa_allocate(hash_table->area,
-								hash_table->params.entry_size +
-								MAXALIGN(sizeof(dshash_table_item)));
+	item_pointer = dsa_allocate_extended(hash_table->area,
+										 hash_table->params.entry_size +
+										 MAXALIGN(sizeof(dshash_table_item)),
+										 (flags & DSHASH_INSERT_NO_OOM) ?
+										 DSA_ALLOC_NO_OOM : 0);
+	if (!DsaPointerIsValid(item_pointer))
+		return NULL;
 	item = dsa_get_address(hash_table->area, item_pointer);
 	copy_key(hash_table, ENTRY_FROM_ITEM(item), key);
 	insert_item_into_bucket(hash_table, item_pointer, item, bucket);
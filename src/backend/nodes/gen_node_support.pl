@@ -1298,6 +1298,7 @@ _jumble${n}(JumbleState *jstate, Node *node)
 " unless $struct_no_query_jumble;
 
 	# print instructions for each field
+	my $any_jumbled = 0;
 	foreach my $f (@{ $node_type_info{$n}->{fields} })
 	{
 		my $t = $node_type_info{$n}->{field_types}{$f};
@@ -1368,11 +1369,15 @@ _jumble${n}(JumbleState *jstate, Node *node)
 			print $jff "\tJUMBLE_FIELD($f);\n"
 			  unless $query_jumble_ignore;
 		}
+
+		$any_jumbled = 1
+		  unless $query_jumble_ignore
+		  or ($t eq 'ParseLoc' and !$query_jumble_location);
 	}
 
-	# Some nodes have no attributes like CheckPointStmt,
-	# so tweak things for empty contents.
-	if (scalar(@{ $node_type_info{$n}->{fields} }) == 0)
+	# Some nodes have no attributes like CheckPointStmt, or only an
+	# unjumbled location like RownumExpr, so tweak things for empty contents.
+	if (!$any_jumbled)
 	{
 		print $jff "\t(void) expr;\n"
 		  unless $struct_no_query_jumble;
@@ -291,6 +291,9 @@ exprType(const Node *expr)
 		case T_NextValueExpr:
 			type = ((const NextValueExpr *) expr)->typeId;
 			break;
+		case T_RownumExpr:
+			type = INT8OID;
+			break;
 		case T_InferenceElem:
 			{
 				const InferenceElem *n = (const InferenceElem *) expr;
@@ -1072,6 +1075,10 @@ exprCollation(const Node *expr)
 			/* NextValueExpr's result is an integer type ... */
 			coll = InvalidOid;	/* ... so it has no collation */
 			break;
+		case T_RownumExpr:
+			/* RownumExpr's result is int8 ... */
+			coll = InvalidOid;	/* ... so it has no collation */
+			break;
 		case T_InferenceElem:
 			coll = exprCollation((Node *) ((const InferenceElem *) expr)->expr);
 			break;
@@ -1329,6 +1336,10 @@ exprSetCollation(Node *expr, Oid collation)
 			/* NextValueExpr's result is an integer type ... */
 			Assert(!OidIsValid(collation)); /* ... so never set a collation */
 			break;
+		case T_RownumExpr:
+			/* RownumExpr's result is int8 ... */
+			Assert(!OidIsValid(collation)); /* ... so never set a collation */
+			break;
 		default:
 			elog(ERROR, "unrecognized node type: %d", (int) nodeTag(expr));
 			break;
@@ -1589,6 +1600,9 @@ exprLocation(const Node *expr)
 			/* function keyword should always be the first thing */
 			loc = ((const SQLValueFunction *) expr)->location;
 			break;
+		case T_RownumExpr:
+			loc = ((const RownumExpr *) expr)->location;
+			break;
 		case T_XmlExpr:
 			{
 				const XmlExpr *xexpr = (const XmlExpr *) expr;
@@ -2164,6 +2178,7 @@ expression_tree_walker_impl(Node *node,
 		case T_SetToDefault:
 		case T_CurrentOfExpr:
 		case T_NextValueExpr:
+		case T_RownumExpr:
 		case T_RangeTblRef:
 		case T_SortGroupClause:
 		case T_CTESearchClause:
@@ -3045,6 +3060,7 @@ expression_tree_mutator_impl(Node *node,
 		case T_SetToDefault:
 		case T_CurrentOfExpr:
 		case T_NextValueExpr:
+		case T_RownumExpr:
 		case T_RangeTblRef:
 		case T_SortGroupClause:
 		case T_CTESearchClause:
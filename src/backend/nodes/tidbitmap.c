@@ -422,6 +422,57 @@ tbm_add_tuples(TIDBitmap *tbm, const ItemPointer tids, int ntids,
 	}
 }
 
+/*
+ * tbm_add_page_words - add a bitmap of tuples on one page to a TIDBitmap
+ *
+ * Bit n of words[] (counting from the low bit of words[0]) stands for offset
+ * number n + 1 on heap page pageno.  This lets index AMs that keep bitmaps of
+ * their own merge a whole page with word-wide ORs, instead of converting it
+ * to ItemPointers for tbm_add_tuples.
+ */
+void
+tbm_add_page_words(TIDBitmap *tbm, BlockNumber pageno,
+				   const bitmapword *words, int nwords, bool recheck)
+{
+	PagetableEntry *page;
+	bool		empty = true;
+	int			wordnum;
+
+	Assert(tbm->iterating == TBM_NOT_ITERATING);
+
+	for (wordnum = 0; wordnum < nwords; wordnum++)
+	{
+		if (words[wordnum] == 0)
+			continue;
+		/* safety check to ensure we don't overrun bit array bounds */
+		if (wordnum >= WORDS_PER_PAGE)
+			elog(ERROR, "tuple offset out of range: %u",
+				 (unsigned int) (wordnum * BITS_PER_BITMAPWORD + 1));
+		empty = false;
+	}
+	if (empty)
+		return;
+
+	if (tbm_page_is_lossy(tbm, pageno))
+		return;					/* whole page is already marked */
+
+	page = tbm_get_pageentry(tbm, pageno);
+	if (page->ischunk)
+	{
+		/* The page is a lossy chunk header, set bit for itself */
+		page->words[0] |= ((bitmapword) 1 << 0);
+	}
+	else
+	{
+		for (wordnum = 0; wordnum < Min(nwords, WORDS_PER_PAGE); wordnum++)
+			page->words[wordnum] |= words[wordnum];
+	}
+	page->recheck |= recheck;
+
+	if (tbm->nentries > tbm->maxentries)
+		tbm_lossify(tbm);
+}
+
 /*
  * tbm_add_page - add a whole page to a TIDBitmap
  *
@@ -36,6 +36,7 @@
 #include "optimizer/cost.h"
 #include "optimizer/geqo.h"
 #include "optimizer/optimizer.h"
+#include "optimizer/ora_hints.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
 #include "optimizer/plancat.h"
@@ -455,6 +456,10 @@ set_rel_size(PlannerInfo *root, RelOptInfo *rel,
 		}
 	}
 
+	/* Optimizer hints may override the size and parallelism estimates */
+	if (root->hints && !IS_DUMMY_REL(rel))
+		ora_hints_adjust_rel_size(root, rel);
+
 	/*
 	 * We insist that all non-dummy rels have a nonzero rowcount estimate.
 	 */
@@ -3624,8 +3629,9 @@ subquery_is_pushdown_safe(Query *subquery, Query *topquery,
 {
 	SetOperationStmt *topop;
 
-	/* Check point 1 */
-	if (subquery->limitOffset != NULL || subquery->limitCount != NULL)
+	/* Check point 1; ROWNUM acts like a LIMIT for this purpose */
+	if (subquery->limitOffset != NULL || subquery->limitCount != NULL ||
+		subquery->hasRownum)
 		return false;
 
 	/* Check point 6 */
@@ -3890,6 +3896,9 @@ targetIsInAllPartitionLists(TargetEntry *tle, Query *query)
  *
  * 5. rinfo's clause must not refer to any subquery output columns that were
  * found to be unsafe to reference by subquery_is_pushdown_safe().
+ *
+ * 6. rinfo's clause must not contain ROWNUM, which numbers the rows this
+ * query reads from the subquery rather than the subquery's own rows.
  */
 static pushdown_safe_type
 qual_is_pushdown_safe(Query *subquery, Index rti, RestrictInfo *rinfo,
@@ -3904,6 +3913,10 @@ qual_is_pushdown_safe(Query *subquery, Index rti, RestrictInfo *rinfo,
 	if (contain_subplans(qual))
 		return PUSHDOWN_UNSAFE;
 
+	/* Refuse ROWNUM (point 6) */
+	if (contain_rownum(qual))
+		return PUSHDOWN_UNSAFE;
+
 	/* Refuse volatile quals if we found they'd be unsafe (point 2) */
 	if (safetyInfo->unsafeVolatile &&
 		contain_volatile_functions((Node *) rinfo))
@@ -98,6 +98,7 @@
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/optimizer.h"
+#include "optimizer/ora_hints.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
 #include "optimizer/placeholder.h"
@@ -159,6 +160,7 @@ bool		enable_gathermerge = true;
 bool		enable_partitionwise_join = false;
 bool		enable_partitionwise_aggregate = false;
 bool		enable_parallel_append = true;
+bool		enable_parallel_dml = false;
 bool		enable_parallel_hash = true;
 bool		enable_partition_pruning = true;
 bool		enable_presorted_aggregate = true;
@@ -355,6 +357,8 @@ cost_seqscan(Path *path, PlannerInfo *root,
 	}
 
 	path->disabled_nodes = enable_seqscan ? 0 : 1;
+	if (root->hints)
+		path->disabled_nodes += ora_hints_seqscan_disabled(root, baserel);
 	path->startup_cost = startup_cost;
 	path->total_cost = startup_cost + cpu_run_cost + disk_run_cost;
 }
@@ -616,6 +620,9 @@ cost_index(IndexPath *path, PlannerInfo *root, double loop_count,
 
 	/* we don't need to check enable_indexonlyscan; indxpath.c does that */
 	path->path.disabled_nodes = enable_indexscan ? 0 : 1;
+	if (root->hints)
+		path->path.disabled_nodes +=
+			ora_hints_indexscan_disabled(root, baserel, index);
 
 	/*
 	 * Call index-access-method-specific code to estimate the processing cost
@@ -1110,6 +1117,9 @@ cost_bitmap_heap_scan(Path *path, PlannerInfo *root, RelOptInfo *baserel,
 	run_cost += path->pathtarget->cost.per_tuple * path->rows;
 
 	path->disabled_nodes = enable_bitmapscan ? 0 : 1;
+	if (root->hints)
+		path->disabled_nodes += ora_hints_indexscan_disabled(root, baserel,
+															 NULL);
 	path->startup_cost = startup_cost;
 	path->total_cost = startup_cost + run_cost;
 }
@@ -3280,6 +3290,8 @@ initial_cost_nestloop(PlannerInfo *root, JoinCostWorkspace *workspace,
 
 	/* Count up disabled nodes. */
 	disabled_nodes = enable_nestloop ? 0 : 1;
+	if (extra->hint_disabled & ORA_HINT_DISABLE_NESTLOOP)
+		disabled_nodes++;
 	disabled_nodes += inner_path->disabled_nodes;
 	disabled_nodes += outer_path->disabled_nodes;
 
@@ -3680,6 +3692,8 @@ initial_cost_mergejoin(PlannerInfo *root, JoinCostWorkspace *workspace,
 	Assert(innerstartsel <= innerendsel);
 
 	disabled_nodes = enable_mergejoin ? 0 : 1;
+	if (extra->hint_disabled & ORA_HINT_DISABLE_MERGEJOIN)
+		disabled_nodes++;
 
 	/* cost of source data */
 
@@ -4178,6 +4192,8 @@ initial_cost_hashjoin(PlannerInfo *root, JoinCostWorkspace *workspace,
 
 	/* Count up disabled nodes. */
 	disabled_nodes = enable_hashjoin ? 0 : 1;
+	if (extra->hint_disabled & ORA_HINT_DISABLE_HASHJOIN)
+		disabled_nodes++;
 	disabled_nodes += inner_path->disabled_nodes;
 	disabled_nodes += outer_path->disabled_nodes;
 
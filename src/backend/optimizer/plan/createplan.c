@@ -28,6 +28,7 @@
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/optimizer.h"
+#include "optimizer/ora_hints.h"
 #include "optimizer/paramassign.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
@@ -88,6 +89,8 @@ static Plan *create_append_plan(PlannerInfo *root, AppendPath *best_path,
 								int flags);
 static Plan *create_merge_append_plan(PlannerInfo *root, MergeAppendPath *best_path,
 									  int flags);
+static Plan *create_rownum_filter_plan(PlannerInfo *root, RelOptInfo *rel,
+									   Plan *subplan);
 static Result *create_group_result_plan(PlannerInfo *root,
 										GroupResultPath *best_path);
 static ProjectSet *create_project_set_plan(PlannerInfo *root, ProjectSetPath *best_path);
@@ -371,6 +374,10 @@ create_plan(PlannerInfo *root, Path *best_path)
 	if (root->curOuterParams != NIL)
 		elog(ERROR, "failed to assign all NestLoopParams to plan nodes");
 
+	/* Now we can tell which optimizer hints the plan follows */
+	if (root->hints != NIL)
+		ora_hints_check_plan(root, plan);
+
 	/*
 	 * Reset plan_params to ensure param IDs used for nestloop params are not
 	 * re-used later
@@ -1216,6 +1223,7 @@ static Plan *
 create_append_plan(PlannerInfo *root, AppendPath *best_path, int flags)
 {
 	Append	   *plan;
+	Plan	   *result;
 	List	   *tlist = build_path_tlist(root, &best_path->path);
 	int			orig_tlist_length = list_length(tlist);
 	bool		tlist_was_changed = false;
@@ -1411,6 +1419,8 @@ create_append_plan(PlannerInfo *root, AppendPath *best_path, int flags)
 
 	copy_generic_path_info(&plan->plan, (Path *) best_path);
 
+	result = create_rownum_filter_plan(root, rel, (Plan *) plan);
+
 	/*
 	 * If prepare_sort_from_pathkeys added sort columns, but we were told to
 	 * produce either the exact tlist or a narrow tlist, we should get rid of
@@ -1419,11 +1429,11 @@ create_append_plan(PlannerInfo *root, AppendPath *best_path, int flags)
 	if (tlist_was_changed && (flags & (CP_EXACT_TLIST | CP_SMALL_TLIST)))
 	{
 		tlist = list_copy_head(plan->plan.targetlist, orig_tlist_length);
-		return inject_projection_plan((Plan *) plan, tlist,
+		return inject_projection_plan(result, tlist,
 									  plan->plan.parallel_safe);
 	}
 	else
-		return (Plan *) plan;
+		return result;
 }
 
 /*
@@ -1439,6 +1449,7 @@ create_merge_append_plan(PlannerInfo *root, MergeAppendPath *best_path,
 {
 	MergeAppend *node = makeNode(MergeAppend);
 	Plan	   *plan = &node->plan;
+	Plan	   *result;
 	List	   *tlist = build_path_tlist(root, &best_path->path);
 	int			orig_tlist_length = list_length(tlist);
 	bool		tlist_was_changed;
@@ -1563,6 +1574,8 @@ create_merge_append_plan(PlannerInfo *root, MergeAppendPath *best_path,
 
 	node->mergeplans = subplans;
 
+	result = create_rownum_filter_plan(root, rel, plan);
+
 	/*
 	 * If prepare_sort_from_pathkeys added sort columns, but we were told to
 	 * produce either the exact tlist or a narrow tlist, we should get rid of
@@ -1571,10 +1584,49 @@ create_merge_append_plan(PlannerInfo *root, MergeAppendPath *best_path,
 	if (tlist_was_changed && (flags & (CP_EXACT_TLIST | CP_SMALL_TLIST)))
 	{
 		tlist = list_copy_head(plan->targetlist, orig_tlist_length);
-		return inject_projection_plan(plan, tlist, plan->parallel_safe);
+		return inject_projection_plan(result, tlist, plan->parallel_safe);
 	}
 	else
-		return plan;
+		return result;
+}
+
+/*
+ * create_rownum_filter_plan
+ *	  Put a Result node checking the ROWNUM quals of appendrel 'rel' on top
+ *	  of 'subplan', the Append or MergeAppend of its children.
+ *
+ * ROWNUM numbers the rows of the whole relation, so such quals aren't given
+ * to the child scans (see apply_child_basequals).  Returns 'subplan'
+ * unchanged if there are none.
+ */
+static Plan *
+create_rownum_filter_plan(PlannerInfo *root, RelOptInfo *rel, Plan *subplan)
+{
+	List	   *rownumquals = NIL;
+	Plan	   *plan;
+	ListCell   *lc;
+
+	if (!root->parse->hasRownum || rel->reloptkind != RELOPT_BASEREL)
+		return subplan;
+
+	foreach(lc, rel->baserestrictinfo)
+	{
+		RestrictInfo *rinfo = lfirst_node(RestrictInfo, lc);
+
+		if (contain_rownum((Node *) rinfo->clause))
+			rownumquals = lappend(rownumquals, rinfo);
+	}
+	if (rownumquals == NIL)
+		return subplan;
+
+	rownumquals = order_qual_clauses(root, rownumquals);
+
+	plan = (Plan *) make_result(list_copy(subplan->targetlist), NULL, subplan);
+	plan->qual = extract_actual_clauses(rownumquals, false);
+	copy_plan_costsize(plan, subplan);
+	plan->parallel_safe = false;
+
+	return plan;
 }
 
 /*
@@ -2610,6 +2610,35 @@ distribute_qual_to_rels(PlannerInfo *root, Node *clause,
 	if (ojscope && !bms_is_subset(relids, ojscope))
 		elog(ERROR, "JOIN qualification cannot refer to other relations");
 
+	/*
+	 * ROWNUM numbers the rows produced by the whole FROM clause, so a qual
+	 * using it has to be evaluated at its syntactic level, not pushed down to
+	 * the relations whose Vars it happens to mention.
+	 */
+	if (root->parse->hasRownum && contain_rownum(clause))
+	{
+		int			relid;
+
+		relids = bms_union(relids, qualscope);
+
+		/*
+		 * On an inheritance parent the qual is checked above the Append of
+		 * its children rather than in each child scan, so the Append has to
+		 * emit the Vars it uses.
+		 */
+		if (bms_get_singleton_member(relids, &relid) &&
+			root->simple_rte_array[relid]->inh)
+		{
+			List	   *vars = pull_var_clause(clause,
+											   PVC_RECURSE_AGGREGATES |
+											   PVC_RECURSE_WINDOWFUNCS |
+											   PVC_INCLUDE_PLACEHOLDERS);
+
+			add_vars_to_targetlist(root, vars, bms_make_singleton(0));
+			list_free(vars);
+		}
+	}
+
 	/*
 	 * If the clause is variable-free, our normal heuristic for pushing it
 	 * down to just the mentioned rels doesn't work, because there are none.
@@ -19,11 +19,13 @@
 #include <math.h>
 
 #include "access/genam.h"
+#include "access/nbtree.h"
 #include "access/parallel.h"
 #include "access/sysattr.h"
 #include "access/table.h"
 #include "catalog/pg_aggregate.h"
 #include "catalog/pg_inherits.h"
+#include "catalog/pg_opfamily.h"
 #include "catalog/pg_proc.h"
 #include "catalog/pg_type.h"
 #include "executor/executor.h"
@@ -42,6 +44,7 @@
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/optimizer.h"
+#include "optimizer/ora_hints.h"
 #include "optimizer/paramassign.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
@@ -54,6 +57,7 @@
 #include "parser/analyze.h"
 #include "parser/parse_agg.h"
 #include "parser/parse_clause.h"
+#include "parser/parse_coerce.h"
 #include "parser/parse_relation.h"
 #include "parser/parsetree.h"
 #include "partitioning/partdesc.h"
@@ -136,6 +140,8 @@ static grouping_sets_data *preprocess_grouping_sets(PlannerInfo *root);
 static List *remap_to_groupclause_idx(List *groupClause, List *gsets,
 									  int *tleref_to_colnum_map);
 static void preprocess_rowmarks(PlannerInfo *root);
+static void preprocess_rownum(PlannerInfo *root);
+static Node *rownum_limit_count(Node *clause);
 static double preprocess_limit(PlannerInfo *root,
 							   double tuple_fraction,
 							   int64 *offset_est, int64 *count_est);
@@ -336,6 +342,7 @@ standard_planner(Query *parse, const char *query_string, int cursorOptions,
 	glob->relationOids = NIL;
 	glob->invalItems = NIL;
 	glob->paramExecTypes = NIL;
+	glob->hints = NIL;
 	glob->lastPHId = 0;
 	glob->lastRowMarkId = 0;
 	glob->lastPlanNodeId = 0;
@@ -359,6 +366,13 @@ standard_planner(Query *parse, const char *query_string, int cursorOptions,
 	 * we want to allow parallel inserts in general; updates and deletes have
 	 * additional problems especially around combo CIDs.)
 	 *
+	 * If enable_parallel_dml is set, UPDATE and DELETE may use parallel plans
+	 * too, but only to scan: the rows to be modified are passed up through a
+	 * Gather, and the leader performs all the modifications itself.  The
+	 * executor falls back to running without workers when that could need a
+	 * combo CID (see ExecutePlan), and modify_target_parallel_hazard checks
+	 * what the leader evaluates per row on behalf of the target.
+	 *
 	 * For now, we don't try to use parallel mode if we're running inside a
 	 * parallel worker.  We might eventually be able to relax this
 	 * restriction, but for now it seems best not to have parallel workers
@@ -366,13 +380,33 @@ standard_planner(Query *parse, const char *query_string, int cursorOptions,
 	 */
 	if ((cursorOptions & CURSOR_OPT_PARALLEL_OK) != 0 &&
 		IsUnderPostmaster &&
-		parse->commandType == CMD_SELECT &&
+		(parse->commandType == CMD_SELECT ||
+		 (enable_parallel_dml &&
+		  (parse->commandType == CMD_UPDATE ||
+		   parse->commandType == CMD_DELETE))) &&
 		!parse->hasModifyingCTE &&
 		max_parallel_workers_per_gather > 0 &&
 		!IsParallelWorker())
 	{
 		/* all the cheap tests pass, so scan the query tree */
 		glob->maxParallelHazard = max_parallel_hazard(parse);
+
+		/*
+		 * For UPDATE and DELETE, also check the target relation.  Anything
+		 * there that's merely parallel-restricted runs in the leader only,
+		 * so it doesn't affect the rest of the query.
+		 */
+		if (parse->commandType != CMD_SELECT &&
+			glob->maxParallelHazard != PROPARALLEL_UNSAFE)
+		{
+			RangeTblEntry *rte = rt_fetch(parse->resultRelation,
+										  parse->rtable);
+
+			if (modify_target_parallel_hazard(rte->relid,
+											  &glob->relationOids) ==
+				PROPARALLEL_UNSAFE)
+				glob->maxParallelHazard = PROPARALLEL_UNSAFE;
+		}
 		glob->parallelModeOK = (glob->maxParallelHazard != PROPARALLEL_UNSAFE);
 	}
 	else
@@ -577,6 +611,7 @@ standard_planner(Query *parse, const char *query_string, int cursorOptions,
 	result->relationOids = glob->relationOids;
 	result->invalItems = glob->invalItems;
 	result->paramExecTypes = glob->paramExecTypes;
+	result->hints = glob->hints;
 	/* utilityStmt should be null, but we might as well copy it */
 	result->utilityStmt = parse->utilityStmt;
 	result->stmt_location = parse->stmt_location;
@@ -700,6 +735,7 @@ subquery_planner(PlannerGlobal *glob, Query *parse, PlannerInfo *parent_root,
 		root->wt_param_id = -1;
 	root->non_recursive_path = NULL;
 	root->partColsUpdated = false;
+	root->hints = parse->hints ? ora_hints_parse(parse->hints) : NIL;
 
 	/*
 	 * Create the top-level join domain.  This won't have valid contents until
@@ -726,6 +762,13 @@ subquery_planner(PlannerGlobal *glob, Query *parse, PlannerInfo *parent_root,
 	 */
 	replace_empty_jointree(parse);
 
+	/*
+	 * If the WHERE clause caps ROWNUM, try to turn that into a LIMIT.  This
+	 * must happen before subquery pull-up looks at hasRownum.
+	 */
+	if (parse->hasRownum)
+		preprocess_rownum(root);
+
 	/*
 	 * Look for ANY and EXISTS SubLinks in WHERE and JOIN/ON clauses, and try
 	 * to transform them into joins.  Note that this step does not descend
@@ -766,6 +809,13 @@ subquery_planner(PlannerGlobal *glob, Query *parse, PlannerInfo *parent_root,
 	if (parse->setOperations)
 		flatten_simple_union_all(root);
 
+	/*
+	 * Now that hints of flattened subqueries have been merged into ours,
+	 * record them for EXPLAIN.
+	 */
+	if (root->hints)
+		ora_hints_register(root);
+
 	/*
 	 * Survey the rangetable to see what kinds of entries are present.  We can
 	 * skip some later processing if relevant SQL features are not used; for
@@ -2503,6 +2553,170 @@ select_rowmark_type(RangeTblEntry *rte, LockClauseStrength strength)
 	}
 }
 
+/*
+ * preprocess_rownum - convert a ROWNUM cap in WHERE into a LIMIT
+ *
+ * ROWNUM numbers the rows that pass the WHERE clause, so a top-level
+ * "ROWNUM <= n" conjunct just stops the query after n rows.  As long as
+ * nothing between the scan/join and the final output reorders or combines
+ * rows, that is exactly what LIMIT n does, and LIMIT lets the planner use a
+ * fast-start plan (and a bounded sort in a subquery below) instead of
+ * evaluating the qual against every row.
+ *
+ * We only handle the case where exactly one conjunct mentions ROWNUM and
+ * it is a recognizable cap; anything else is left for the executor.
+ */
+static void
+preprocess_rownum(PlannerInfo *root)
+{
+	Query	   *parse = root->parse;
+	List	   *quals;
+	Node	   *count = NULL;
+	Node	   *match = NULL;
+	ListCell   *lc;
+
+	if (parse->commandType != CMD_SELECT ||
+		parse->setOperations ||
+		parse->sortClause ||
+		parse->groupClause ||
+		parse->groupingSets ||
+		parse->hasAggs ||
+		parse->havingQual ||
+		parse->distinctClause ||
+		parse->hasWindowFuncs ||
+		parse->hasTargetSRFs ||
+		parse->limitCount ||
+		parse->limitOffset)
+		return;
+
+	quals = make_ands_implicit((Expr *) parse->jointree->quals);
+	foreach(lc, quals)
+	{
+		Node	   *qual = (Node *) lfirst(lc);
+		Node	   *bound;
+
+		if (!contain_rownum(qual))
+			continue;
+		bound = rownum_limit_count(qual);
+		if (bound == NULL || count != NULL)
+			return;
+		count = bound;
+		match = qual;
+	}
+	if (count == NULL)
+		return;
+
+	quals = list_delete_ptr(quals, match);
+	parse->jointree->quals = quals ? (Node *) make_ands_explicit(quals) : NULL;
+	parse->limitCount = count;
+	parse->limitOption = LIMIT_OPTION_COUNT;
+	parse->hasRownum = contain_rownum((Node *) parse->targetList);
+}
+
+/*
+ * rownum_limit_count - get the LIMIT equivalent to a ROWNUM comparison
+ *
+ * Returns an int8 expression for the row count, or NULL if the clause is
+ * not of the form "ROWNUM op bound" (or its commutation) with op one of
+ * <, <=, = and the bound a constant or an external parameter.
+ */
+static Node *
+rownum_limit_count(Node *clause)
+{
+	OpExpr	   *opexpr;
+	Node	   *other;
+	int			strategy;
+
+	if (!is_opclause(clause))
+		return NULL;
+	opexpr = (OpExpr *) clause;
+	if (list_length(opexpr->args) != 2)
+		return NULL;
+	strategy = get_op_opfamily_strategy(opexpr->opno, INTEGER_BTREE_FAM_OID);
+	if (strategy == 0)
+		return NULL;
+
+	if (IsA(linitial(opexpr->args), RownumExpr))
+		other = (Node *) lsecond(opexpr->args);
+	else if (IsA(lsecond(opexpr->args), RownumExpr))
+	{
+		other = (Node *) linitial(opexpr->args);
+		strategy = BTCommuteStrategyNumber(strategy);
+	}
+	else
+		return NULL;
+
+	if (IsA(other, Const))
+	{
+		Const	   *con = (Const *) other;
+		int64		bound;
+
+		/* ROWNUM op NULL is never true */
+		if (con->constisnull)
+			bound = 0;
+		else if (con->consttype == INT8OID)
+			bound = DatumGetInt64(con->constvalue);
+		else if (con->consttype == INT4OID)
+			bound = DatumGetInt32(con->constvalue);
+		else if (con->consttype == INT2OID)
+			bound = DatumGetInt16(con->constvalue);
+		else
+			return NULL;
+
+		switch (strategy)
+		{
+			case BTLessStrategyNumber:
+				bound = (bound > 0) ? bound - 1 : 0;
+				break;
+			case BTLessEqualStrategyNumber:
+				bound = Max(bound, 0);
+				break;
+			case BTEqualStrategyNumber:
+				/* only the first row can ever satisfy ROWNUM = k */
+				bound = (bound == 1) ? 1 : 0;
+				break;
+			default:
+				return NULL;
+		}
+		return (Node *) makeConst(INT8OID, -1, InvalidOid, sizeof(int64),
+								  Int64GetDatum(bound), false,
+								  FLOAT8PASSBYVAL);
+	}
+
+	if (IsA(other, Param) &&
+		((Param *) other)->paramkind == PARAM_EXTERN &&
+		strategy == BTLessEqualStrategyNumber)
+	{
+		MinMaxExpr *minmax;
+
+		other = coerce_to_target_type(NULL, other, exprType(other),
+									  INT8OID, -1,
+									  COERCION_IMPLICIT,
+									  COERCE_IMPLICIT_CAST,
+									  -1);
+		if (other == NULL)
+			return NULL;
+
+		/*
+		 * LIMIT rejects negative counts and treats NULL as no limit, while
+		 * the qual is simply false; GREATEST(n, 0) maps both to zero rows.
+		 */
+		minmax = makeNode(MinMaxExpr);
+		minmax->minmaxtype = INT8OID;
+		minmax->minmaxcollid = InvalidOid;
+		minmax->inputcollid = InvalidOid;
+		minmax->op = IS_GREATEST;
+		minmax->args = list_make2(other,
+								  makeConst(INT8OID, -1, InvalidOid,
+											sizeof(int64), Int64GetDatum(0),
+											false, FLOAT8PASSBYVAL));
+		minmax->location = -1;
+		return (Node *) minmax;
+	}
+
+	return NULL;
+}
+
 /*
  * preprocess_limit - do pre-estimation for LIMIT and/or OFFSET clauses
  *
@@ -3811,10 +4025,12 @@ create_grouping_paths(PlannerInfo *root,
 		/*
 		 * Determine whether partitionwise aggregation is in theory possible.
 		 * It can be disabled by the user, and for now, we don't try to
-		 * support grouping sets.  create_ordinary_grouping_paths() will check
+		 * support grouping sets, nor ROWNUM, which would be restarted in
+		 * each partition.  create_ordinary_grouping_paths() will check
 		 * additional conditions, such as whether input_rel is partitioned.
 		 */
-		if (enable_partitionwise_aggregate && !parse->groupingSets)
+		if (enable_partitionwise_aggregate && !parse->groupingSets &&
+			!parse->hasRownum)
 			extra.patype = PARTITIONWISE_AGGREGATE_FULL;
 		else
 			extra.patype = PARTITIONWISE_AGGREGATE_NONE;
@@ -6406,6 +6622,10 @@ make_sort_input_target(PlannerInfo *root,
 				col_is_srf[i] = true;
 				have_srf = true;
 			}
+			else if (parse->hasRownum && contain_rownum((Node *) expr))
+			{
+				/* ROWNUM is numbered before sorting, never postpone it */
+			}
 			else if (contain_volatile_functions((Node *) expr))
 			{
 				/* Unconditionally postpone */
@@ -7752,6 +7972,15 @@ apply_scanjoin_target_to_paths(PlannerInfo *root,
 	/* This recurses, so be paranoid. */
 	check_stack_depth();
 
+	/*
+	 * ROWNUM numbers the rows of the whole relation, so a target using it
+	 * must be computed above the partitioning Append, not in each partition.
+	 */
+	if (rel_is_partitioned && root->parse->hasRownum &&
+		contain_rownum((Node *) llast_node(PathTarget,
+										   scanjoin_targets)->exprs))
+		rel_is_partitioned = false;
+
 	/*
 	 * If the rel is partitioned, we want to drop its existing paths and
 	 * generate new ones.  This function would still be correct if we kept the
@@ -35,6 +35,7 @@
 #include "nodes/nodeFuncs.h"
 #include "optimizer/clauses.h"
 #include "optimizer/optimizer.h"
+#include "optimizer/ora_hints.h"
 #include "optimizer/placeholder.h"
 #include "optimizer/prep.h"
 #include "optimizer/subselect.h"
@@ -1328,6 +1329,7 @@ pull_up_simple_subquery(PlannerInfo *root, Node *jtnode, RangeTblEntry *rte,
 	subroot->hasRecursion = false;
 	subroot->wt_param_id = -1;
 	subroot->non_recursive_path = NULL;
+	subroot->hints = subquery->hints ? ora_hints_parse(subquery->hints) : NIL;
 	/* We don't currently need a top JoinDomain for the subroot */
 
 	/* No CTEs to worry about */
@@ -1554,6 +1556,12 @@ pull_up_simple_subquery(PlannerInfo *root, Node *jtnode, RangeTblEntry *rte,
 	root->append_rel_list = list_concat(root->append_rel_list,
 										subroot->append_rel_list);
 
+	/*
+	 * Optimizer hints written inside the subquery now apply to our query
+	 * level; they refer to tables by alias, so no adjustment is needed.
+	 */
+	root->hints = list_concat(root->hints, subroot->hints);
+
 	/*
 	 * We don't have to do the equivalent bookkeeping for outer-join info,
 	 * because that hasn't been set up yet.  placeholder_list likewise.
@@ -1846,6 +1854,13 @@ is_simple_subquery(PlannerInfo *root, Query *subquery, RangeTblEntry *rte,
 		subquery->cteList)
 		return false;
 
+	/*
+	 * ROWNUM is numbered by the subquery's own scan/join; pulling it up would
+	 * let the upper query's quals and joins change the numbering.
+	 */
+	if (subquery->hasRownum)
+		return false;
+
 	/*
 	 * Don't pull up if the RTE represents a security-barrier view; we
 	 * couldn't prevent information leakage once the RTE's Vars are scattered
@@ -1854,6 +1869,14 @@ is_simple_subquery(PlannerInfo *root, Query *subquery, RangeTblEntry *rte,
 	if (rte->security_barrier)
 		return false;
 
+	/*
+	 * Don't pull up if a NO_MERGE optimizer hint asks us to keep the subquery
+	 * separate.
+	 */
+	if ((root->hints || subquery->hints) &&
+		ora_hints_block_pullup(root, subquery, rte))
+		return false;
+
 	/*
 	 * If the subquery is LATERAL, check for pullup restrictions from that.
 	 */
@@ -21,9 +21,13 @@
 #include "postgres.h"
 
 #include "access/htup_details.h"
+#include "access/table.h"
+#include "catalog/pg_class.h"
+#include "catalog/pg_inherits.h"
 #include "catalog/pg_language.h"
 #include "catalog/pg_operator.h"
 #include "catalog/pg_proc.h"
+#include "catalog/pg_trigger.h"
 #include "catalog/pg_type.h"
 #include "executor/executor.h"
 #include "executor/functions.h"
@@ -57,6 +61,7 @@
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/ora_compatible.h"
+#include "utils/rel.h"
 #include "utils/syscache.h"
 #include "utils/typcache.h"
 #include "commands/proclang.h"
@@ -106,10 +111,13 @@ static bool contain_subplans_walker(Node *node, void *context);
 static bool contain_mutable_functions_walker(Node *node, void *context);
 static bool contain_volatile_functions_walker(Node *node, void *context);
 static bool contain_volatile_functions_not_nextval_walker(Node *node, void *context);
+static bool max_parallel_hazard_test(char proparallel,
+									 max_parallel_hazard_context *context);
 static bool max_parallel_hazard_walker(Node *node,
 									   max_parallel_hazard_context *context);
 static bool contain_nonstrict_functions_walker(Node *node, void *context);
 static bool contain_exec_param_walker(Node *node, List *param_ids);
+static bool contain_rownum_walker(Node *node, void *context);
 static bool contain_context_dependent_node(Node *clause);
 static bool contain_context_dependent_node_walker(Node *node, int *flags);
 static bool contain_leaked_vars_walker(Node *node, void *context);
@@ -461,6 +469,12 @@ contain_mutable_functions_walker(Node *node, void *context)
 		return true;
 	}
 
+	if (IsA(node, RownumExpr))
+	{
+		/* ROWNUM changes on every row */
+		return true;
+	}
+
 	/*
 	 * It should be safe to treat MinMaxExpr as immutable, because it will
 	 * depend on a non-cross-type btree comparison function, and those should
@@ -586,6 +600,12 @@ contain_volatile_functions_walker(Node *node, void *context)
 		return true;
 	}
 
+	if (IsA(node, RownumExpr))
+	{
+		/* ROWNUM changes on every row */
+		return true;
+	}
+
 	if (IsA(node, RestrictInfo))
 	{
 		RestrictInfo *rinfo = (RestrictInfo *) node;
@@ -722,8 +742,10 @@ contain_volatile_functions_not_nextval_walker(Node *node, void *context)
 	 * MinMaxExpr, XmlExpr, and CoerceToDomain as immutable, while
 	 * SQLValueFunction is stable.  Hence, none of them are of interest here.
 	 * Also, since we're intentionally ignoring nextval(), presumably we
-	 * should ignore NextValueExpr.
+	 * should ignore NextValueExpr.  ROWNUM is a different matter.
 	 */
+	if (IsA(node, RownumExpr))
+		return true;
 
 	/* Recurse to check arguments */
 	if (IsA(node, Query))
@@ -813,6 +835,96 @@ is_parallel_safe(PlannerInfo *root, Node *node)
 	return !max_parallel_hazard_walker(node, &context);
 }
 
+/*
+ * modify_target_parallel_hazard
+ *		Find the worst parallel-hazard level among the things the executor
+ *		evaluates per row on behalf of the target of an UPDATE or DELETE
+ *
+ * In a parallel UPDATE or DELETE the workers only produce the rows to modify;
+ * the leader applies the changes itself while still in parallel mode.  So
+ * BEFORE and INSTEAD OF trigger functions, CHECK constraints and default or
+ * generation expressions of the target must not be parallel-unsafe.  AFTER
+ * triggers, including those enforcing foreign keys, fire after the executor
+ * has left parallel mode and need no check.  Only plain and partitioned
+ * tables can take part, and not temporary ones.
+ *
+ * For a partitioned target all partitions are examined, because tuple routing
+ * may reach partitions that are pruned from the plan.  The OIDs of the
+ * relations examined are appended to *relationOids, so that the caller can
+ * make the plan depend on them.
+ */
+char
+modify_target_parallel_hazard(Oid relid, List **relationOids)
+{
+	max_parallel_hazard_context context;
+	List	   *relids;
+	ListCell   *lc;
+
+	context.max_hazard = PROPARALLEL_SAFE;
+	context.max_interesting = PROPARALLEL_UNSAFE;
+	context.safe_param_ids = NIL;
+
+	/* The target is already locked; this locks the partitions too */
+	relids = find_all_inheritors(relid, RowExclusiveLock, NULL);
+
+	foreach(lc, relids)
+	{
+		Relation	rel = table_open(lfirst_oid(lc), NoLock);
+		TupleConstr *constr = RelationGetDescr(rel)->constr;
+
+		*relationOids = lappend_oid(*relationOids, RelationGetRelid(rel));
+
+		if (rel->rd_rel->relpersistence == RELPERSISTENCE_TEMP ||
+			(rel->rd_rel->relkind != RELKIND_RELATION &&
+			 rel->rd_rel->relkind != RELKIND_PARTITIONED_TABLE))
+			(void) max_parallel_hazard_test(PROPARALLEL_UNSAFE, &context);
+
+		if (context.max_hazard != PROPARALLEL_UNSAFE && rel->trigdesc)
+		{
+			for (int i = 0; i < rel->trigdesc->numtriggers; i++)
+			{
+				Trigger    *trigger = &rel->trigdesc->triggers[i];
+
+				if (!TRIGGER_FOR_BEFORE(trigger->tgtype) &&
+					!TRIGGER_FOR_INSTEAD(trigger->tgtype))
+					continue;
+				if (max_parallel_hazard_test(func_parallel(trigger->tgfoid),
+											 &context))
+					break;
+			}
+		}
+
+		if (context.max_hazard != PROPARALLEL_UNSAFE && constr)
+		{
+			for (int i = 0; i < constr->num_check; i++)
+			{
+				if (max_parallel_hazard_walker(stringToNode(constr->check[i].ccbin),
+											   &context))
+					break;
+			}
+		}
+
+		if (context.max_hazard != PROPARALLEL_UNSAFE && constr)
+		{
+			for (int i = 0; i < constr->num_defval; i++)
+			{
+				if (max_parallel_hazard_walker(stringToNode(constr->defval[i].adbin),
+											   &context))
+					break;
+			}
+		}
+
+		table_close(rel, NoLock);
+
+		if (context.max_hazard == PROPARALLEL_UNSAFE)
+			break;
+	}
+
+	list_free(relids);
+
+	return context.max_hazard;
+}
+
 /* core logic for all parallel-hazard checks */
 static bool
 max_parallel_hazard_test(char proparallel, max_parallel_hazard_context *context)
@@ -883,6 +995,16 @@ max_parallel_hazard_walker(Node *node, max_parallel_hazard_context *context)
 			return true;
 	}
 
+	/*
+	 * ROWNUM is numbered by the plan node that evaluates it, so each worker
+	 * would number its own rows; it must run in the leader.
+	 */
+	else if (IsA(node, RownumExpr))
+	{
+		if (max_parallel_hazard_test(PROPARALLEL_RESTRICTED, context))
+			return true;
+	}
+
 	/*
 	 * Treat window functions as parallel-restricted because we aren't sure
 	 * whether the input row ordering is fully deterministic, and the output
@@ -1179,6 +1301,33 @@ contain_exec_param_walker(Node *node, List *param_ids)
 	return expression_tree_walker(node, contain_exec_param_walker, param_ids);
 }
 
+/*****************************************************************************
+ *		Check clauses for ROWNUM
+ *****************************************************************************/
+
+/*
+ * contain_rownum
+ *	  Recursively search for ROWNUM pseudo-columns within a clause.
+ *
+ * Does not descend into subqueries, since a ROWNUM there is numbered by
+ * the subquery's own plan.
+ */
+bool
+contain_rownum(Node *clause)
+{
+	return contain_rownum_walker(clause, NULL);
+}
+
+static bool
+contain_rownum_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, RownumExpr))
+		return true;
+	return expression_tree_walker(node, contain_rownum_walker, context);
+}
+
 /*****************************************************************************
  *		Check clauses for context-dependent nodes
  *****************************************************************************/
@@ -1320,6 +1469,7 @@ contain_leaked_vars_walker(Node *node, void *context)
 		case T_NullTest:
 		case T_BooleanTest:
 		case T_NextValueExpr:
+		case T_RownumExpr:
 		case T_ReturningExpr:
 		case T_List:
 
@@ -865,6 +865,15 @@ apply_child_basequals(PlannerInfo *root, RelOptInfo *parentrel,
 		ListCell   *lc2;
 
 		Assert(IsA(rinfo, RestrictInfo));
+
+		/*
+		 * ROWNUM numbers the rows of the whole appendrel, so a qual on it
+		 * can't be checked per child; it's applied above the Append instead
+		 * (see create_append_plan).
+		 */
+		if (contain_rownum((Node *) rinfo->clause))
+			continue;
+
 		childqual = adjust_appendrel_attrs(root,
 										   (Node *) rinfo->clause,
 										   1, &appinfo);
@@ -0,0 +1,1025 @@
+/*-------------------------------------------------------------------------
+ *
+ * ora_hints.c
+ *	  Oracle-style optimizer hints
+ *
+ * The Oracle-compatible parser keeps the text of a hint comment placed
+ * right after the leading keyword of a SELECT, INSERT, UPDATE, DELETE or
+ * MERGE in Query.hints.  The routines here split that text into OraHint
+ * nodes and are consulted by the planner while it builds paths.
+ *
+ * Hints never cause a query to fail.  A hint that cannot be parsed is
+ * reported as invalid by EXPLAIN and otherwise ignored.  Access-path and
+ * join-method hints work like the enable_* GUCs: the paths they rule out
+ * are counted as disabled nodes rather than removed, so the planner still
+ * produces a plan when no path satisfying the hint exists.  Whether such a
+ * hint was honored is therefore only known once the plan is finished, and
+ * ora_hints_check_plan() decides it by looking at the plan.
+ *
+ * Tables are named by their alias in the query block the hint belongs to.
+ * The supported hints are
+ *
+ *	FULL(t)					avoid index scans on t
+ *	INDEX(t [index ...])	avoid a sequential scan on t; if indexes are
+ *							listed, avoid all other indexes and bitmap scans
+ *	NO_INDEX(t [index ...])	avoid the listed indexes, or all of them
+ *	USE_NL(t ...)			join t to the rest of the query by nested loop
+ *	USE_HASH(t ...)			... by hash join
+ *	USE_MERGE(t ...)		... by merge join
+ *	LEADING(t1 t2 ...)		join the listed tables first, in that order,
+ *							each one being the inner side of its join
+ *	PARALLEL([t] n)			scan t (or every table) with n workers
+ *	NO_PARALLEL[(t)]		don't scan t (or any table) in parallel
+ *	CARDINALITY(t n)		assume t returns n rows
+ *	NO_MERGE[(v)]			don't merge subquery v (or the query block
+ *							containing the hint) into its parent
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  src/backend/optimizer/util/ora_hints.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <ctype.h>
+
+#include "nodes/plannodes.h"
+#include "optimizer/optimizer.h"
+#include "optimizer/ora_hints.h"
+#include "parser/parsetree.h"
+#include "parser/scansup.h"
+#include "utils/lsyscache.h"
+
+typedef struct OraHintKeyword
+{
+	const char *name;
+	OraHintKind kind;
+	int			min_args;
+	int			max_args;		/* -1 means no limit */
+} OraHintKeyword;
+
+/*
+ * Working state of ora_hints_check_plan().  For each hint of the query level,
+ * in list order, we note whether the plan has a node the hint applies to,
+ * and whether any such node goes against it.
+ */
+typedef struct HintPlanCheck
+{
+	PlannerInfo *root;
+	bool	   *seen;
+	bool	   *violated;
+} HintPlanCheck;
+
+static const OraHintKeyword hint_keywords[] = {
+	{"cardinality", ORA_HINT_CARDINALITY, 2, 2},
+	{"full", ORA_HINT_FULL, 1, 1},
+	{"index", ORA_HINT_INDEX, 1, -1},
+	{"leading", ORA_HINT_LEADING, 1, -1},
+	{"no_index", ORA_HINT_NO_INDEX, 1, -1},
+	{"no_merge", ORA_HINT_NO_MERGE, 0, 1},
+	{"no_parallel", ORA_HINT_NO_PARALLEL, 0, 1},
+	{"parallel", ORA_HINT_PARALLEL, 1, 2},
+	{"use_hash", ORA_HINT_USE_HASH, 1, -1},
+	{"use_merge", ORA_HINT_USE_MERGE, 1, -1},
+	{"use_nl", ORA_HINT_USE_NL, 1, -1},
+};
+
+static bool hint_is_ident_char(char c);
+static const char *hint_skip_separators(const char *p);
+static OraHintKind hint_check(const char *name, List *args);
+static bool hint_arg_is_count(const char *arg);
+static const char *hint_rel_alias(PlannerInfo *root, RelOptInfo *rel);
+static bool hint_names_rel(PlannerInfo *root, OraHint *hint,
+						   RelOptInfo *rel);
+static bool hint_lists_index(OraHint *hint, Oid indexoid);
+static Index hint_find_rel(PlannerInfo *root, const char *alias);
+static Relids hint_base_relids(PlannerInfo *root, RelOptInfo *rel);
+static Relids hint_leading_relids(PlannerInfo *root, OraHint *hint);
+static bool hint_leading_violated(PlannerInfo *root, OraHint *hint,
+								  Relids outer_relids, Relids inner_relids);
+static Relids hint_check_plan_walker(HintPlanCheck *check, Plan *plan);
+static void hint_check_scan(HintPlanCheck *check, Plan *plan, Index scanrelid,
+							bool indexscan, Oid indexoid);
+static void hint_check_join(HintPlanCheck *check, NodeTag jointag,
+							Relids outer_relids, Relids inner_relids);
+static Relids hint_plan_relids(PlannerInfo *root, Relids relids);
+
+
+/*
+ * ora_hints_parse
+ *		Split the text of a hint comment into a list of OraHint nodes.
+ *
+ * Hints are separated by white space or commas.  Each one is a name,
+ * optionally followed by a parenthesized list of arguments, which are
+ * likewise separated by white space or commas.  Anything we can't make
+ * sense of becomes an ORA_HINT_INVALID entry.
+ */
+List *
+ora_hints_parse(const char *str)
+{
+	List	   *result = NIL;
+	const char *p = str;
+
+	for (;;)
+	{
+		const char *start;
+		char	   *name;
+		List	   *args = NIL;
+		bool		ok = true;
+		OraHint    *hint;
+
+		p = hint_skip_separators(p);
+		if (*p == '\0')
+			break;
+
+		start = p;
+		while (hint_is_ident_char(*p))
+			p++;
+		if (p == start)
+		{
+			/* not a hint name; swallow the offending word */
+			while (*p != '\0' && !scanner_isspace(*p) && *p != ',')
+				p++;
+			ok = false;
+		}
+		name = downcase_identifier(start, p - start, false, false);
+
+		while (scanner_isspace(*p))
+			p++;
+		if (ok && *p == '(')
+		{
+			p++;
+			for (;;)
+			{
+				const char *argstart;
+
+				p = hint_skip_separators(p);
+				if (*p == ')')
+				{
+					p++;
+					break;
+				}
+
+				argstart = p;
+				if (*p == '"')
+				{
+					StringInfoData buf;
+
+					initStringInfo(&buf);
+					for (p++; *p != '\0'; p++)
+					{
+						if (*p == '"')
+						{
+							if (p[1] != '"')
+								break;
+							p++;
+						}
+						appendStringInfoChar(&buf, *p);
+					}
+					if (*p != '"' || buf.len == 0)
+						ok = false;
+					else
+					{
+						p++;
+						args = lappend(args, makeString(buf.data));
+					}
+				}
+				else
+				{
+					while (hint_is_ident_char(*p) || *p == '.')
+						p++;
+					if (p == argstart)
+						ok = false;
+					else
+						args = lappend(args,
+									   makeString(downcase_identifier(argstart,
+																	  p - argstart,
+																	  false,
+																	  false)));
+				}
+
+				if (!ok)
+				{
+					/* skip to the end of the argument list */
+					while (*p != '\0' && *p != ')')
+						p++;
+					if (*p == ')')
+						p++;
+					break;
+				}
+			}
+		}
+
+		/* drop trailing white space from the text we'll display */
+		while (p > start && scanner_isspace(p[-1]))
+			p--;
+
+		hint = makeNode(OraHint);
+		hint->kind = ok ? hint_check(name, args) : ORA_HINT_INVALID;
+		hint->text = pnstrdup(start, p - start);
+		hint->args = args;
+		hint->used = false;
+		result = lappend(result, hint);
+	}
+
+	return result;
+}
+
+/*
+ * ora_hints_register
+ *		Make the hints of a query level visible to EXPLAIN.
+ *
+ * This is called once pull_up_subqueries() has merged the hints of any
+ * flattened subqueries into root->hints.
+ */
+void
+ora_hints_register(PlannerInfo *root)
+{
+	ListCell   *lc;
+
+	foreach(lc, root->hints)
+	{
+		OraHint    *hint = lfirst_node(OraHint, lc);
+
+		/*
+		 * A bare NO_MERGE is honored simply by our planning this query level
+		 * separately from its parent.
+		 */
+		if (hint->kind == ORA_HINT_NO_MERGE && hint->args == NIL &&
+			root->parent_root != NULL)
+			hint->used = true;
+	}
+
+	root->glob->hints = list_concat(root->glob->hints, root->hints);
+}
+
+/*
+ * ora_hints_block_pullup
+ *		Should a NO_MERGE hint keep subquery 'rte' from being pulled up?
+ */
+bool
+ora_hints_block_pullup(PlannerInfo *root, Query *subquery, RangeTblEntry *rte)
+{
+	ListCell   *lc;
+
+	foreach(lc, root->hints)
+	{
+		OraHint    *hint = lfirst_node(OraHint, lc);
+
+		if (hint->kind == ORA_HINT_NO_MERGE && hint->args != NIL &&
+			pg_strcasecmp(strVal(linitial(hint->args)),
+						  rte->eref->aliasname) == 0)
+		{
+			hint->used = true;
+			return true;
+		}
+	}
+
+	/* The subquery's own hints haven't been split up yet */
+	if (subquery->hints)
+	{
+		foreach(lc, ora_hints_parse(subquery->hints))
+		{
+			OraHint    *hint = lfirst_node(OraHint, lc);
+
+			if (hint->kind == ORA_HINT_NO_MERGE && hint->args == NIL)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * ora_hints_adjust_rel_size
+ *		Apply PARALLEL, NO_PARALLEL and CARDINALITY hints to a base relation
+ *		or appendrel member whose size has just been estimated.
+ */
+void
+ora_hints_adjust_rel_size(PlannerInfo *root, RelOptInfo *rel)
+{
+	OraHint    *parallel_hint = NULL;
+	OraHint    *stmt_parallel_hint = NULL;
+	ListCell   *lc;
+
+	foreach(lc, root->hints)
+	{
+		OraHint    *hint = lfirst_node(OraHint, lc);
+		int			nargs = list_length(hint->args);
+
+		switch (hint->kind)
+		{
+			case ORA_HINT_PARALLEL:
+			case ORA_HINT_NO_PARALLEL:
+				if (rel->rtekind != RTE_RELATION)
+					break;
+				if ((hint->kind == ORA_HINT_PARALLEL && nargs == 1) ||
+					(hint->kind == ORA_HINT_NO_PARALLEL && nargs == 0))
+					stmt_parallel_hint = hint;
+				else if (hint_names_rel(root, hint, rel))
+					parallel_hint = hint;
+				break;
+
+			case ORA_HINT_CARDINALITY:
+				if (rel->reloptkind == RELOPT_BASEREL &&
+					hint_names_rel(root, hint, rel))
+				{
+					rel->rows = clamp_row_est(strtod(strVal(lsecond(hint->args)),
+													 NULL));
+					hint->used = true;
+				}
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	/* A hint naming the table takes precedence over a statement-wide one */
+	if (parallel_hint == NULL)
+		parallel_hint = stmt_parallel_hint;
+	if (parallel_hint != NULL)
+	{
+		if (parallel_hint->kind == ORA_HINT_NO_PARALLEL)
+			rel->rel_parallel_workers = 0;
+		else
+			rel->rel_parallel_workers =
+				atoi(strVal(llast(parallel_hint->args)));
+	}
+}
+
+/*
+ * ora_hints_seqscan_disabled
+ *		Count a sequential scan of 'rel' as disabled if an INDEX hint
+ *		applies to it.
+ */
+int
+ora_hints_seqscan_disabled(PlannerInfo *root, RelOptInfo *rel)
+{
+	int			disabled = 0;
+	ListCell   *lc;
+
+	foreach(lc, root->hints)
+	{
+		OraHint    *hint = lfirst_node(OraHint, lc);
+
+		if (hint->kind == ORA_HINT_INDEX && hint_names_rel(root, hint, rel))
+			disabled = 1;
+	}
+
+	return disabled;
+}
+
+/*
+ * ora_hints_indexscan_disabled
+ *		Count a scan of 'rel' using 'index' as disabled if FULL, INDEX or
+ *		NO_INDEX hints rule it out.  'index' is NULL for a bitmap scan.
+ */
+int
+ora_hints_indexscan_disabled(PlannerInfo *root, RelOptInfo *rel,
+							 IndexOptInfo *index)
+{
+	int			disabled = 0;
+	ListCell   *lc;
+
+	foreach(lc, root->hints)
+	{
+		OraHint    *hint = lfirst_node(OraHint, lc);
+		bool		has_list = list_length(hint->args) > 1;
+
+		if (hint->kind != ORA_HINT_FULL &&
+			hint->kind != ORA_HINT_INDEX &&
+			hint->kind != ORA_HINT_NO_INDEX)
+			continue;
+		if (!hint_names_rel(root, hint, rel))
+			continue;
+
+		switch (hint->kind)
+		{
+			case ORA_HINT_FULL:
+				disabled = 1;
+				break;
+			case ORA_HINT_INDEX:
+				if (has_list &&
+					(index == NULL || !hint_lists_index(hint, index->indexoid)))
+					disabled = 1;
+				break;
+			case ORA_HINT_NO_INDEX:
+				if (!has_list ||
+					(index != NULL && hint_lists_index(hint, index->indexoid)))
+					disabled = 1;
+				break;
+			default:
+				break;
+		}
+	}
+
+	return disabled;
+}
+
+/*
+ * ora_hints_join_disabled
+ *		Determine which join methods hints rule out for joining 'outerrel'
+ *		to 'innerrel'.  Returns a mask of ORA_HINT_DISABLE_* flags.
+ */
+int
+ora_hints_join_disabled(PlannerInfo *root, RelOptInfo *outerrel,
+						RelOptInfo *innerrel)
+{
+	Relids		outer_relids = hint_base_relids(root, outerrel);
+	Relids		inner_relids = hint_base_relids(root, innerrel);
+	int			disabled = 0;
+	ListCell   *lc;
+
+	foreach(lc, root->hints)
+	{
+		OraHint    *hint = lfirst_node(OraHint, lc);
+		int			allowed;
+		ListCell   *lc2;
+
+		switch (hint->kind)
+		{
+			case ORA_HINT_USE_NL:
+				allowed = ORA_HINT_DISABLE_NESTLOOP;
+				break;
+			case ORA_HINT_USE_MERGE:
+				allowed = ORA_HINT_DISABLE_MERGEJOIN;
+				break;
+			case ORA_HINT_USE_HASH:
+				allowed = ORA_HINT_DISABLE_HASHJOIN;
+				break;
+			case ORA_HINT_LEADING:
+				if (hint_leading_violated(root, hint,
+										  outer_relids, inner_relids))
+					disabled |= ORA_HINT_DISABLE_ALL_JOINS;
+				continue;
+			default:
+				continue;
+		}
+
+		/*
+		 * The hint applies to the join that brings one of the named tables
+		 * into the join tree, whichever side it ends up on.
+		 */
+		foreach(lc2, hint->args)
+		{
+			Index		rti = hint_find_rel(root, strVal(lfirst(lc2)));
+			int			relid;
+
+			if (rti == 0)
+				continue;
+			if ((bms_get_singleton_member(outer_relids, &relid) &&
+				 relid == rti) ||
+				(bms_get_singleton_member(inner_relids, &relid) &&
+				 relid == rti))
+				disabled |= ORA_HINT_DISABLE_ALL_JOINS & ~allowed;
+		}
+	}
+
+	return disabled;
+}
+
+/*
+ * ora_hints_check_plan
+ *		Mark the hints of a query level that its finished plan honors.
+ *
+ * Access-path, join and parallelism hints only discourage the paths they
+ * rule out, so a hint naming a table of the query can still end up ignored.
+ * We therefore decide whether such a hint was used by looking at the plan:
+ * it was if the plan has at least one node the hint applies to, and all
+ * such nodes agree with it.  CARDINALITY and NO_MERGE hints always take
+ * effect once they apply, and are marked where they're applied.
+ */
+void
+ora_hints_check_plan(PlannerInfo *root, Plan *plan)
+{
+	HintPlanCheck check;
+	ListCell   *lc;
+
+	check.root = root;
+	check.seen = palloc0_array(bool, list_length(root->hints));
+	check.violated = palloc0_array(bool, list_length(root->hints));
+
+	(void) hint_check_plan_walker(&check, plan);
+
+	foreach(lc, root->hints)
+	{
+		OraHint    *hint = lfirst_node(OraHint, lc);
+		int			i = foreach_current_index(lc);
+
+		switch (hint->kind)
+		{
+			case ORA_HINT_FULL:
+			case ORA_HINT_INDEX:
+			case ORA_HINT_NO_INDEX:
+			case ORA_HINT_USE_NL:
+			case ORA_HINT_USE_HASH:
+			case ORA_HINT_USE_MERGE:
+			case ORA_HINT_LEADING:
+			case ORA_HINT_PARALLEL:
+			case ORA_HINT_NO_PARALLEL:
+				if (check.seen[i] && !check.violated[i])
+					hint->used = true;
+				break;
+			default:
+				break;
+		}
+	}
+
+	pfree(check.seen);
+	pfree(check.violated);
+}
+
+
+/*
+ * Is c allowed in a hint name or unquoted argument?
+ */
+static bool
+hint_is_ident_char(char c)
+{
+	return isalnum((unsigned char) c) || c == '_' || c == '$' || c == '#' ||
+		IS_HIGHBIT_SET(c);
+}
+
+static const char *
+hint_skip_separators(const char *p)
+{
+	while (scanner_isspace(*p) || *p == ',')
+		p++;
+	return p;
+}
+
+/*
+ * Identify a hint by name, and check that its arguments make sense.
+ */
+static OraHintKind
+hint_check(const char *name, List *args)
+{
+	int			nargs = list_length(args);
+
+	for (int i = 0; i < lengthof(hint_keywords); i++)
+	{
+		const OraHintKeyword *kw = &hint_keywords[i];
+
+		if (strcmp(name, kw->name) != 0)
+			continue;
+
+		if (nargs < kw->min_args ||
+			(kw->max_args >= 0 && nargs > kw->max_args))
+			return ORA_HINT_INVALID;
+
+		switch (kw->kind)
+		{
+			case ORA_HINT_CARDINALITY:
+				if (!hint_arg_is_count(strVal(lsecond(args))))
+					return ORA_HINT_INVALID;
+				break;
+			case ORA_HINT_PARALLEL:
+				if (!hint_arg_is_count(strVal(llast(args))) ||
+					atoi(strVal(llast(args))) <= 0)
+					return ORA_HINT_INVALID;
+				break;
+			default:
+				break;
+		}
+		return kw->kind;
+	}
+
+	return ORA_HINT_INVALID;
+}
+
+/*
+ * Is arg a plain non-negative integer of sane magnitude?
+ */
+static bool
+hint_arg_is_count(const char *arg)
+{
+	size_t		len = strlen(arg);
+
+	return len > 0 && len <= 9 && strspn(arg, "0123456789") == len;
+}
+
+/*
+ * Return the alias by which hints refer to 'rel'.  Appendrel members are
+ * known by the alias of their topmost parent.
+ */
+static const char *
+hint_rel_alias(PlannerInfo *root, RelOptInfo *rel)
+{
+	Relids		relids;
+	int			relid;
+
+	relids = rel->top_parent_relids ? rel->top_parent_relids : rel->relids;
+	if (!bms_get_singleton_member(relids, &relid))
+		return NULL;
+
+	return planner_rt_fetch(relid, root)->eref->aliasname;
+}
+
+/*
+ * Does the first argument of 'hint' name 'rel'?
+ */
+static bool
+hint_names_rel(PlannerInfo *root, OraHint *hint, RelOptInfo *rel)
+{
+	const char *alias;
+
+	if (hint->args == NIL)
+		return false;
+
+	alias = hint_rel_alias(root, rel);
+	return alias != NULL &&
+		pg_strcasecmp(strVal(linitial(hint->args)), alias) == 0;
+}
+
+/*
+ * Is 'index' among the indexes listed after the table in 'hint'?
+ */
+static bool
+hint_lists_index(OraHint *hint, Oid indexoid)
+{
+	char	   *indexname = get_rel_name(indexoid);
+	ListCell   *lc;
+
+	if (indexname == NULL)
+		return false;
+
+	for_each_from(lc, hint->args, 1)
+	{
+		if (pg_strcasecmp(strVal(lfirst(lc)), indexname) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Find the base relation known by 'alias', returning 0 if there is none.
+ */
+static Index
+hint_find_rel(PlannerInfo *root, const char *alias)
+{
+	for (int rti = 1; rti < root->simple_rel_array_size; rti++)
+	{
+		RelOptInfo *rel = root->simple_rel_array[rti];
+
+		if (rel == NULL || rel->reloptkind != RELOPT_BASEREL)
+			continue;
+		if (pg_strcasecmp(root->simple_rte_array[rti]->eref->aliasname,
+						  alias) == 0)
+			return rti;
+	}
+
+	return 0;
+}
+
+/*
+ * Return the base relations making up 'rel', translating child relations
+ * to their topmost parents and leaving out outer-join relids.
+ */
+static Relids
+hint_base_relids(PlannerInfo *root, RelOptInfo *rel)
+{
+	Relids		relids;
+
+	relids = rel->top_parent_relids ? rel->top_parent_relids : rel->relids;
+	return bms_difference(relids, root->outer_join_rels);
+}
+
+/*
+ * Return the base relations named by a LEADING hint, or NULL if any of them
+ * can't be found or one is named twice, in which case the hint is ignored.
+ */
+static Relids
+hint_leading_relids(PlannerInfo *root, OraHint *hint)
+{
+	Relids		leading = NULL;
+	ListCell   *lc;
+
+	foreach(lc, hint->args)
+	{
+		Index		rti = hint_find_rel(root, strVal(lfirst(lc)));
+
+		if (rti == 0 || bms_is_member(rti, leading))
+			return NULL;
+		leading = bms_add_member(leading, rti);
+	}
+
+	return leading;
+}
+
+/*
+ * Would joining 'outer_relids' to 'inner_relids' go against the join order
+ * requested by a LEADING hint?
+ *
+ * The hinted tables must be joined to each other before anything else is
+ * joined to them, the first one being the outermost, and each following one
+ * in turn joined as the inner side of the tables before it.  The hint is
+ * ignored altogether if any of its tables can't be found.
+ */
+static bool
+hint_leading_violated(PlannerInfo *root, OraHint *hint,
+					  Relids outer_relids, Relids inner_relids)
+{
+	Relids		leading = hint_leading_relids(root, hint);
+	Relids		prefix = NULL;
+	Relids		joined;
+	Relids		covered;
+	int			ncovered;
+	int			last = 0;
+	ListCell   *lc;
+
+	if (leading == NULL)
+		return false;
+
+	joined = bms_union(outer_relids, inner_relids);
+	covered = bms_intersect(joined, leading);
+	ncovered = bms_num_members(covered);
+	if (ncovered == 0)
+		return false;
+
+	/* The hinted tables present must be a leading prefix of the list */
+	foreach(lc, hint->args)
+	{
+		if (foreach_current_index(lc) >= ncovered)
+			break;
+		last = hint_find_rel(root, strVal(lfirst(lc)));
+		prefix = bms_add_member(prefix, last);
+	}
+	if (!bms_equal(covered, prefix))
+		return true;
+
+	/* Other tables may only join the hinted ones once they're all joined */
+	if (ncovered < bms_num_members(leading) && !bms_is_subset(joined, leading))
+		return true;
+
+	/* When both sides hold hinted tables, the last one must be inner */
+	if (bms_overlap(outer_relids, leading) &&
+		bms_overlap(inner_relids, leading))
+	{
+		Relids		inner_leading = bms_intersect(inner_relids, leading);
+		int			relid;
+
+		if (!bms_get_singleton_member(inner_leading, &relid) || relid != last)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Check the scans and joins of a plan tree against the hints, returning the
+ * base relations the tree scans.  We don't descend into the plans of other
+ * query levels, such as the subquery of a SubqueryScan; they are checked
+ * when they're created.
+ */
+static Relids
+hint_check_plan_walker(HintPlanCheck *check, Plan *plan)
+{
+	PlannerInfo *root = check->root;
+	Relids		relids = NULL;
+	ListCell   *lc;
+
+	if (plan == NULL)
+		return NULL;
+
+	switch (nodeTag(plan))
+	{
+		case T_SeqScan:
+		case T_SampleScan:
+		case T_TidScan:
+		case T_TidRangeScan:
+			hint_check_scan(check, plan, ((Scan *) plan)->scanrelid,
+							false, InvalidOid);
+			break;
+		case T_IndexScan:
+			hint_check_scan(check, plan, ((Scan *) plan)->scanrelid,
+							true, ((IndexScan *) plan)->indexid);
+			break;
+		case T_IndexOnlyScan:
+			hint_check_scan(check, plan, ((Scan *) plan)->scanrelid,
+							true, ((IndexOnlyScan *) plan)->indexid);
+			break;
+		case T_BitmapHeapScan:
+			/* the bitmap index scans below it scan the same relation */
+			hint_check_scan(check, plan, ((Scan *) plan)->scanrelid,
+							true, InvalidOid);
+			break;
+		case T_SubqueryScan:
+		case T_FunctionScan:
+		case T_TableFuncScan:
+		case T_ValuesScan:
+		case T_CteScan:
+		case T_NamedTuplestoreScan:
+		case T_WorkTableScan:
+			break;
+		case T_ForeignScan:
+			return hint_plan_relids(root, ((ForeignScan *) plan)->fs_base_relids);
+		case T_CustomScan:
+			return hint_plan_relids(root, ((CustomScan *) plan)->custom_relids);
+		case T_NestLoop:
+		case T_MergeJoin:
+		case T_HashJoin:
+			{
+				Relids		outer_relids;
+				Relids		inner_relids;
+
+				outer_relids = hint_check_plan_walker(check, plan->lefttree);
+				inner_relids = hint_check_plan_walker(check, plan->righttree);
+				hint_check_join(check, nodeTag(plan),
+								outer_relids, inner_relids);
+				return bms_union(outer_relids, inner_relids);
+			}
+		case T_Append:
+			foreach(lc, ((Append *) plan)->appendplans)
+				relids = bms_add_members(relids,
+										 hint_check_plan_walker(check,
+																lfirst(lc)));
+			return relids;
+		case T_MergeAppend:
+			foreach(lc, ((MergeAppend *) plan)->mergeplans)
+				relids = bms_add_members(relids,
+										 hint_check_plan_walker(check,
+																lfirst(lc)));
+			return relids;
+		default:
+			relids = hint_check_plan_walker(check, plan->lefttree);
+			return bms_add_members(relids,
+								   hint_check_plan_walker(check,
+														  plan->righttree));
+	}
+
+	/* we get here for scans of a single relation */
+	return hint_plan_relids(root,
+							bms_make_singleton(((Scan *) plan)->scanrelid));
+}
+
+/*
+ * Check a scan of the relation with RT index 'scanrelid' against the
+ * access-path and parallelism hints.  'indexscan' is true for index and
+ * bitmap scans, and 'indexoid' is the index used, or InvalidOid for a bitmap
+ * scan.
+ */
+static void
+hint_check_scan(HintPlanCheck *check, Plan *plan, Index scanrelid,
+				bool indexscan, Oid indexoid)
+{
+	PlannerInfo *root = check->root;
+	RelOptInfo *rel;
+	int			parallel_hint = -1;
+	int			stmt_parallel_hint = -1;
+	ListCell   *lc;
+
+	if (scanrelid == 0 || scanrelid >= root->simple_rel_array_size ||
+		(rel = root->simple_rel_array[scanrelid]) == NULL)
+		return;
+
+	foreach(lc, root->hints)
+	{
+		OraHint    *hint = lfirst_node(OraHint, lc);
+		int			i = foreach_current_index(lc);
+		bool		has_list = list_length(hint->args) > 1;
+		int			nargs = list_length(hint->args);
+
+		switch (hint->kind)
+		{
+			case ORA_HINT_FULL:
+			case ORA_HINT_INDEX:
+			case ORA_HINT_NO_INDEX:
+				if (!hint_names_rel(root, hint, rel))
+					break;
+				check->seen[i] = true;
+				if (hint->kind == ORA_HINT_FULL)
+					check->violated[i] |= indexscan;
+				else if (hint->kind == ORA_HINT_INDEX)
+					check->violated[i] |= !indexscan ||
+						(has_list && (!OidIsValid(indexoid) ||
+									  !hint_lists_index(hint, indexoid)));
+				else
+					check->violated[i] |= indexscan &&
+						(!has_list || (OidIsValid(indexoid) &&
+									   hint_lists_index(hint, indexoid)));
+				break;
+
+			case ORA_HINT_PARALLEL:
+			case ORA_HINT_NO_PARALLEL:
+				/* choose the hint as ora_hints_adjust_rel_size() does */
+				if (rel->rtekind != RTE_RELATION)
+					break;
+				if ((hint->kind == ORA_HINT_PARALLEL && nargs == 1) ||
+					(hint->kind == ORA_HINT_NO_PARALLEL && nargs == 0))
+					stmt_parallel_hint = i;
+				else if (hint_names_rel(root, hint, rel))
+					parallel_hint = i;
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	if (parallel_hint < 0)
+		parallel_hint = stmt_parallel_hint;
+	if (parallel_hint >= 0)
+	{
+		OraHint    *hint = list_nth_node(OraHint, root->hints, parallel_hint);
+
+		check->seen[parallel_hint] = true;
+		check->violated[parallel_hint] |=
+			(hint->kind == ORA_HINT_PARALLEL) != plan->parallel_aware;
+	}
+}
+
+/*
+ * Check a join of 'outer_relids' to 'inner_relids', done by a plan node of
+ * type 'jointag', against the join method and join order hints.
+ */
+static void
+hint_check_join(HintPlanCheck *check, NodeTag jointag,
+				Relids outer_relids, Relids inner_relids)
+{
+	PlannerInfo *root = check->root;
+	ListCell   *lc;
+
+	foreach(lc, root->hints)
+	{
+		OraHint    *hint = lfirst_node(OraHint, lc);
+		int			i = foreach_current_index(lc);
+		NodeTag		wanted;
+		ListCell   *lc2;
+
+		switch (hint->kind)
+		{
+			case ORA_HINT_USE_NL:
+				wanted = T_NestLoop;
+				break;
+			case ORA_HINT_USE_MERGE:
+				wanted = T_MergeJoin;
+				break;
+			case ORA_HINT_USE_HASH:
+				wanted = T_HashJoin;
+				break;
+			case ORA_HINT_LEADING:
+				{
+					Relids		leading = hint_leading_relids(root, hint);
+
+					if (leading == NULL ||
+						(!bms_overlap(outer_relids, leading) &&
+						 !bms_overlap(inner_relids, leading)))
+						continue;
+					check->seen[i] = true;
+					check->violated[i] |=
+						hint_leading_violated(root, hint,
+											  outer_relids, inner_relids);
+					continue;
+				}
+			default:
+				continue;
+		}
+
+		/* as in ora_hints_join_disabled(), look for a join adding a table */
+		foreach(lc2, hint->args)
+		{
+			Index		rti = hint_find_rel(root, strVal(lfirst(lc2)));
+			int			relid;
+
+			if (rti == 0)
+				continue;
+			if ((bms_get_singleton_member(outer_relids, &relid) &&
+				 relid == rti) ||
+				(bms_get_singleton_member(inner_relids, &relid) &&
+				 relid == rti))
+			{
+				check->seen[i] = true;
+				check->violated[i] |= (jointag != wanted);
+			}
+		}
+	}
+}
+
+/*
+ * Translate the RT indexes scanned by a plan node to those of the base
+ * relations hints refer to, as hint_base_relids() does for paths.
+ */
+static Relids
+hint_plan_relids(PlannerInfo *root, Relids relids)
+{
+	Relids		result = NULL;
+	int			relid = -1;
+
+	while ((relid = bms_next_member(relids, relid)) >= 0)
+	{
+		RelOptInfo *rel = NULL;
+
+		if (relid < root->simple_rel_array_size)
+			rel = root->simple_rel_array[relid];
+		if (rel != NULL && rel->top_parent_relids != NULL)
+			result = bms_add_members(result, rel->top_parent_relids);
+		else
+			result = bms_add_member(result, relid);
+	}
+
+	return bms_difference(result, root->outer_join_rels);
+}
@@ -131,6 +131,9 @@ oracle_raw_parser(const char *str, RawParseMode mode)
 	yyscanner = ora_scanner_init(str, &yyextra.core_yy_extra,
 							 &OraScanKeywords, OraScanKeywordTokens);
 
+	/* collect optimizer hint comments for the grammar */
+	yyextra.core_yy_extra.capture_hints = true;
+
 	yyextra.max_pushbacks = MAX_PUSHBACKS;
 	yyextra.pushback_token = palloc(sizeof(int)* MAX_PUSHBACKS);
 	yyextra.pushback_auxdata = palloc(sizeof(TokenAuxData)* MAX_PUSHBACKS);
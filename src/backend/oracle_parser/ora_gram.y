@@ -172,6 +172,7 @@ static RoleSpec *makeRoleSpec(RoleSpecType type, int location);
 static void check_qualified_name(List *names, ora_core_yyscan_t yyscanner);
 static List *check_func_name(List *names, ora_core_yyscan_t yyscanner);
 static List *check_indirection(List *indirection, ora_core_yyscan_t yyscanner);
+static char *hint_comment_for(int keyword_location, ora_core_yyscan_t yyscanner);
 static List *extractArgTypes(List *parameters);
 static List *extractAggrArgTypes(List *aggrargs);
 static List *makeOrderedSetArgs(List *directargs, List *orderedargs,
@@ -420,7 +421,7 @@ static void determineLanguage(List *options);
 				OptTableElementList TableElementList OptInherit definition
 				OptTypedTableElementList TypedTableElementList
 				reloptions opt_reloptions
-				OptWith opt_definition func_args func_args_list
+				OptWith OptOrganization opt_definition func_args func_args_list
 				func_args_with_defaults func_args_with_defaults_list
 				aggr_args aggr_args_list
 				func_as createfunc_opt_list opt_createfunc_opt_list alterfunc_opt_list
@@ -776,7 +777,7 @@ static void determineLanguage(List *options);
 	NULLS_P NUMBER_P NUMERIC NVL NVL2
 
 	OBJECT_P OBJECTS_P OF OFF OFFSET OIDS OLD OMIT ON ONLY OPERATOR OPTION OPTIONS OR
-	ORDER ORDINALITY OTHERS OUT_P OUTER_P
+	ORDER ORDINALITY ORGANIZATION OTHERS OUT_P OUTER_P
 	OVER OVERLAPS OVERLAY OVERRIDING OWNED OWNER PACKAGES 
 
 	PARALLEL PARAMETER PARSER PARTIAL PARTITION PASSING PASSWORD PATH
@@ -3928,8 +3929,8 @@ copy_generic_opt_arg_list_item:
  *****************************************************************************/
 
 CreateStmt:	CREATE OptTemp TABLE qualified_name '(' OptTableElementList ')'
-			OptInherit OptPartitionSpec table_access_method_clause OptWith
-			OnCommitOption OptTableSpace
+			OptInherit OptPartitionSpec table_access_method_clause OptOrganization
+			OptWith OnCommitOption OptTableSpace
 				{
 					CreateStmt *n = makeNode(CreateStmt);
 
@@ -3941,15 +3942,15 @@ CreateStmt:	CREATE OptTemp TABLE qualified_name '(' OptTableElementList ')'
 					n->ofTypename = NULL;
 					n->constraints = NIL;
 					n->accessMethod = $10;
-					n->options = $11;
-					n->oncommit = $12;
-					n->tablespacename = $13;
+					n->options = list_concat($11, $12);
+					n->oncommit = $13;
+					n->tablespacename = $14;
 					n->if_not_exists = false;
 					$$ = (Node *) n;
 				}
 		| CREATE OptTemp TABLE IF_P NOT EXISTS qualified_name '('
 			OptTableElementList ')' OptInherit OptPartitionSpec table_access_method_clause
-			OptWith OnCommitOption OptTableSpace
+			OptOrganization OptWith OnCommitOption OptTableSpace
 				{
 					CreateStmt *n = makeNode(CreateStmt);
 
@@ -3961,9 +3962,9 @@ CreateStmt:	CREATE OptTemp TABLE qualified_name '(' OptTableElementList ')'
 					n->ofTypename = NULL;
 					n->constraints = NIL;
 					n->accessMethod = $13;
-					n->options = $14;
-					n->oncommit = $15;
-					n->tablespacename = $16;
+					n->options = list_concat($14, $15);
+					n->oncommit = $16;
+					n->tablespacename = $17;
 					n->if_not_exists = true;
 					$$ = (Node *) n;
 				}
@@ -4970,6 +4971,28 @@ table_access_method_clause:
 			| /*EMPTY*/							{ $$ = NULL; }
 		;
 
+/*
+ * Oracle's ORGANIZATION clause.  An index-organized table is a heap table
+ * whose rows are kept in primary key order, see the index_organized
+ * storage parameter.
+ */
+OptOrganization:
+			ORGANIZATION ColId
+				{
+					if (strcmp($2, "index") == 0)
+						$$ = list_make1(makeDefElem("index_organized",
+													(Node *) makeString("true"), @1));
+					else if (strcmp($2, "heap") == 0)
+						$$ = NIL;
+					else
+						ereport(ERROR,
+								(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+								 errmsg("unsupported table organization \"%s\"", $2),
+								 parser_errposition(@2)));
+				}
+			| /*EMPTY*/							{ $$ = NIL; }
+		;
+
 /* WITHOUT OIDS is legacy only */
 OptWith:
 			WITH reloptions				{ $$ = $2; }
@@ -13474,6 +13497,7 @@ InsertStmt:
 					$5->onConflictClause = $6;
 					$5->returningClause = $7;
 					$5->withClause = $1;
+					$5->hints = hint_comment_for(@2, yyscanner);
 					$$ = (Node *) $5;
 				}
 		;
@@ -13664,6 +13688,7 @@ DeleteStmt: opt_with_clause DELETE_P FROM relation_expr_opt_alias
 					n->whereClause = $6;
 					n->returningClause = $7;
 					n->withClause = $1;
+					n->hints = hint_comment_for(@2, yyscanner);
 					$$ = (Node *) n;
 				}
 		;
@@ -13738,6 +13763,7 @@ UpdateStmt: opt_with_clause UPDATE relation_expr_opt_alias
 					n->whereClause = $7;
 					n->returningClause = $8;
 					n->withClause = $1;
+					n->hints = hint_comment_for(@2, yyscanner);
 					$$ = (Node *) n;
 				}
 		;
@@ -13815,6 +13841,7 @@ MergeStmt:
 					m->joinCondition = $8;
 					m->mergeWhenClauses = $9;
 					m->returningClause = $11;
+					m->hints = hint_comment_for(@2, yyscanner);
 
 					$$ = (Node *)m;
 				}
@@ -14136,6 +14163,7 @@ simple_select:
 					n->groupDistinct = ($7)->distinct;
 					n->havingClause = $8;
 					n->windowClause = $9;
+					n->hints = hint_comment_for(@1, yyscanner);
 					$$ = (Node *) n;
 				}
 			| SELECT distinct_clause target_list
@@ -14153,6 +14181,7 @@ simple_select:
 					n->groupDistinct = ($7)->distinct;
 					n->havingClause = $8;
 					n->windowClause = $9;
+					n->hints = hint_comment_for(@1, yyscanner);
 					$$ = (Node *) n;
 				}
 			| values_clause							{ $$ = $1; }
@@ -20321,6 +20350,7 @@ unreserved_keyword:
 			| OPTION
 			| OPTIONS
 			| ORDINALITY
+			| ORGANIZATION
 			| OTHERS
 			| OVER
 			| OVERRIDING
@@ -21028,6 +21058,7 @@ bare_label_keyword:
 			| OPTIONS
 			| OR
 			| ORDINALITY
+			| ORGANIZATION
 			| OTHERS
 			| OUT_P
 			| OUTER_P
@@ -21686,6 +21717,36 @@ insertSelectOptions(SelectStmt *stmt,
 	}
 }
 
+/*
+ * hint_comment_for
+ *		Return the text of the optimizer hint comment that directly follows
+ *		the keyword at the given location, or NULL if there is none
+ *
+ * The scanner collects such comments; see hint_keyword_location() in
+ * ora_scan.l.  Should there be several, they are concatenated.
+ */
+static char *
+hint_comment_for(int keyword_location, ora_core_yyscan_t yyscanner)
+{
+	ora_base_yy_extra_type *yyextra = pg_yyget_extra(yyscanner);
+	char	   *result = NULL;
+	ListCell   *lc;
+
+	foreach(lc, yyextra->core_yy_extra.hint_comments)
+	{
+		OraHintComment *hint = (OraHintComment *) lfirst(lc);
+
+		if (hint->keyword_location != keyword_location)
+			continue;
+		if (result == NULL)
+			result = hint->text;
+		else
+			result = psprintf("%s %s", result, hint->text);
+	}
+
+	return result;
+}
+
 static Node *
 makeSetOp(SetOperation op, bool all, Node *larg, Node *rarg)
 {
@@ -81,6 +81,7 @@ static Node *transformXmlSerialize(ParseState *pstate, XmlSerialize *xs);
 static Node *transformBooleanTest(ParseState *pstate, BooleanTest *b);
 static Node *transformCurrentOfExpr(ParseState *pstate, CurrentOfExpr *cexpr);
 static Node *transformColumnRef(ParseState *pstate, ColumnRef *cref);
+static Node *transformRownum(ParseState *pstate, int location);
 static Node *transformWholeRowRef(ParseState *pstate,
 								  ParseNamespaceItem *nsitem,
 								  int sublevels_up, int location);
@@ -543,6 +544,38 @@ transformIndirection(ParseState *pstate, A_Indirection *ind)
 	return result;
 }
 
+/*
+ * Transform a reference to the Oracle ROWNUM pseudo-column.
+ */
+static Node *
+transformRownum(ParseState *pstate, int location)
+{
+	RownumExpr *rownum;
+
+	switch (pstate->p_expr_kind)
+	{
+		case EXPR_KIND_WHERE:
+		case EXPR_KIND_SELECT_TARGET:
+		case EXPR_KIND_ORDER_BY:
+		case EXPR_KIND_UPDATE_SOURCE:
+			/* okay */
+			break;
+		default:
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			/* translator: %s is name of a SQL construct, eg WHERE */
+					 errmsg("ROWNUM is not allowed in %s",
+							ParseExprKindName(pstate->p_expr_kind)),
+					 parser_errposition(pstate, location)));
+	}
+
+	rownum = makeNode(RownumExpr);
+	rownum->location = location;
+	pstate->p_hasRownum = true;
+
+	return (Node *) rownum;
+}
+
 /*
  * Transform a ColumnRef.
  *
@@ -954,6 +987,14 @@ transformColumnRefInternal(ParseState *pstate, ColumnRef *cref, bool missing_ok)
 					 parser_errposition(pstate, cref->location)));
 	}
 
+	/*
+	 * In Oracle mode, a bare ROWNUM that isn't the name of anything else is
+	 * the row-numbering pseudo-column.
+	 */
+	if (node == NULL && compatible_db == ORA_PARSER &&
+		list_length(cref->fields) == 1 && strcmp(colname, "rownum") == 0)
+		node = transformRownum(pstate, cref->location);
+
 	/*
 	 * Throw error if no translation found.
 	 */
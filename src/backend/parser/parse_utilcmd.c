@@ -459,6 +459,43 @@ transformCreateStmt(CreateStmt *stmt, const char *queryString)
 	 */
 	transformIndexConstraints(&cxt);
 
+	/*
+	 * An index-organized table places its rows by primary key, so it must
+	 * have one (unless a LIKE clause may still supply it).  Unless told
+	 * otherwise, leave a tenth of each page free, as Oracle's default PCTFREE
+	 * does, so that rows inserted later between existing keys fit next to
+	 * their neighbors.
+	 */
+	if (!cxt.isforeign)
+	{
+		bool		index_organized = false;
+		bool		has_fillfactor = false;
+
+		foreach_node(DefElem, def, stmt->options)
+		{
+			if (def->defnamespace != NULL)
+				continue;
+			if (strcmp(def->defname, "index_organized") == 0)
+				index_organized = defGetBoolean(def);
+			else if (strcmp(def->defname, "fillfactor") == 0)
+				has_fillfactor = true;
+		}
+
+		if (index_organized)
+		{
+			if (cxt.pkey == NULL && !like_found)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_TABLE_DEFINITION),
+						 errmsg("index-organized table \"%s\" must have a primary key",
+								cxt.relation->relname)));
+			if (!has_fillfactor)
+				stmt->options = lappend(stmt->options,
+										makeDefElem("fillfactor",
+													(Node *) makeInteger(90),
+													-1));
+		}
+	}
+
 	/*
 	 * Re-consideration of LIKE clauses should happen after creation of
 	 * indexes, but before creation of foreign keys.  This order is critical
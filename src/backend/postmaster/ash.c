@@ -0,0 +1,394 @@
+/*-------------------------------------------------------------------------
+ *
+ * ash.c
+ *	  Active session history sampler
+ *
+ * pg_stat_activity only shows what sessions are doing right now.  To make
+ * it possible to look back at what they were doing, e.g. during a stall
+ * that is over by the time anyone looks, the active session history
+ * sampler, a background worker, periodically records the state of every
+ * active backend in a ring buffer in shared memory.  The samples are shown
+ * by the pg_active_session_history view.
+ *
+ * A sample consists of the fixed-size fields of the backend's
+ * PgBackendStatus entry and the wait event published in its PGPROC, both
+ * read without taking any lock, so sampling doesn't slow down the sampled
+ * backends.  Only sessions running a query and auxiliary processes that
+ * are not idle in their main loop are sampled.
+ *
+ * The buffer has room for active_session_history_size worth of samples;
+ * when it is full, the oldest samples are overwritten.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  src/backend/postmaster/ash.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "postmaster/ash.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/interrupt.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/lwlock.h"
+#include "storage/proc.h"
+#include "storage/shmem.h"
+#include "tcop/tcopprot.h"
+#include "utils/backend_status.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/timestamp.h"
+#include "utils/wait_event.h"
+
+#define UINT32_ACCESS_ONCE(var)		 ((uint32)(*((volatile uint32 *)&(var))))
+
+/* GUC parameters */
+int			active_session_history_size = 0;
+int			active_session_history_interval = 1000;
+
+/* One sampled backend */
+typedef struct AshSample
+{
+	TimestampTz sample_time;
+	int			pid;
+	BackendType backend_type;
+	BackendState state;
+	Oid			datid;
+	Oid			userid;
+	uint32		wait_event_info;
+	int64		query_id;
+	int64		plan_id;
+} AshSample;
+
+typedef struct AshSharedState
+{
+	LWLock		lock;			/* protects the fields below */
+	uint64		nsamples;		/* number of samples ever written */
+	int			capacity;		/* number of slots in samples[] */
+	AshSample	samples[FLEXIBLE_ARRAY_MEMBER];
+} AshSharedState;
+
+static AshSharedState *AshState = NULL;
+
+static int	ash_capacity(void);
+static int	ash_take_samples_into(AshSample *batch, TimestampTz now);
+static void ash_take_samples(AshSample *batch);
+
+
+/*
+ * Number of samples that fit in active_session_history_size.
+ */
+static int
+ash_capacity(void)
+{
+	Size		bytes;
+
+	if (active_session_history_size <= 0)
+		return 0;
+
+	bytes = mul_size((Size) active_session_history_size, 1024);
+	return (int) Min(bytes / sizeof(AshSample), (Size) INT_MAX);
+}
+
+/*
+ * Report shared memory space needed by AshShmemInit
+ */
+Size
+AshShmemSize(void)
+{
+	int			capacity = ash_capacity();
+
+	if (capacity == 0)
+		return 0;
+
+	return add_size(offsetof(AshSharedState, samples),
+					mul_size(capacity, sizeof(AshSample)));
+}
+
+/*
+ * Allocate and initialize the sample buffer, if enabled
+ */
+void
+AshShmemInit(void)
+{
+	bool		found;
+
+	if (ash_capacity() == 0)
+		return;
+
+	AshState = (AshSharedState *)
+		ShmemInitStruct("Active Session History", AshShmemSize(), &found);
+
+	if (!found)
+	{
+		LWLockInitialize(&AshState->lock, LWTRANCHE_ACTIVE_SESSION_HISTORY);
+		AshState->nsamples = 0;
+		AshState->capacity = ash_capacity();
+	}
+}
+
+/*
+ * Register the sampler process, if enabled
+ */
+void
+AshRegister(void)
+{
+	BackgroundWorker bgw;
+
+	if (ash_capacity() == 0)
+		return;
+
+	memset(&bgw, 0, sizeof(bgw));
+	bgw.bgw_flags = BGWORKER_SHMEM_ACCESS;
+	bgw.bgw_start_time = BgWorkerStart_PostmasterStart;
+	snprintf(bgw.bgw_library_name, MAXPGPATH, "postgres");
+	snprintf(bgw.bgw_function_name, BGW_MAXLEN, "AshSamplerMain");
+	snprintf(bgw.bgw_name, BGW_MAXLEN, "active session history sampler");
+	snprintf(bgw.bgw_type, BGW_MAXLEN, "active session history sampler");
+	bgw.bgw_restart_time = 5;
+	bgw.bgw_notify_pid = 0;
+	bgw.bgw_main_arg = (Datum) 0;
+
+	RegisterBackgroundWorker(&bgw);
+}
+
+/*
+ * Record the current state of all active backends in batch, and return
+ * the number of samples taken.
+ */
+static int
+ash_take_samples_into(AshSample *batch, TimestampTz now)
+{
+	PgBackendStatus status;
+	int			nbatch = 0;
+
+	for (int i = 0; i < ProcGlobal->allProcCount; i++)
+	{
+		PGPROC	   *proc;
+		uint32		wait_event_info;
+
+		if (i == MyProcNumber)
+			continue;
+		if (!pgstat_read_backend_status(i, &status))
+			continue;
+
+		proc = GetPGProcByNumber(i);
+		wait_event_info = UINT32_ACCESS_ONCE(proc->wait_event_info);
+
+		if (status.st_state != STATE_UNDEFINED)
+		{
+			/* a session: sample it while it's running something */
+			if (status.st_state != STATE_RUNNING &&
+				status.st_state != STATE_FASTPATH)
+				continue;
+		}
+		else
+		{
+			/* an auxiliary process: skip it while it idles in its main loop */
+			if ((wait_event_info & WAIT_EVENT_CLASS_MASK) == PG_WAIT_ACTIVITY)
+				continue;
+		}
+
+		batch[nbatch].sample_time = now;
+		batch[nbatch].pid = status.st_procpid;
+		batch[nbatch].backend_type = status.st_backendType;
+		batch[nbatch].state = status.st_state;
+		batch[nbatch].datid = status.st_databaseid;
+		batch[nbatch].userid = status.st_userid;
+		batch[nbatch].wait_event_info = wait_event_info;
+		batch[nbatch].query_id = status.st_query_id;
+		batch[nbatch].plan_id = status.st_plan_id;
+		nbatch++;
+	}
+
+	return nbatch;
+}
+
+/*
+ * Take one round of samples and append them to the ring buffer.
+ *
+ * The samples are collected into batch, a local array with room for every
+ * process, first, so that the lock is held only for copying them.
+ */
+static void
+ash_take_samples(AshSample *batch)
+{
+	int			nbatch;
+	int			capacity = AshState->capacity;
+
+	nbatch = ash_take_samples_into(batch, GetCurrentTimestamp());
+	if (nbatch == 0)
+		return;
+
+	LWLockAcquire(&AshState->lock, LW_EXCLUSIVE);
+	for (int i = 0; i < nbatch; i++)
+	{
+		int			slot = (int) (AshState->nsamples % capacity);
+
+		AshState->samples[slot] = batch[i];
+		AshState->nsamples++;
+	}
+	LWLockRelease(&AshState->lock);
+}
+
+/*
+ * Main entry point of the sampler process
+ */
+void
+AshSamplerMain(Datum main_arg)
+{
+	AshSample  *batch;
+	TimestampTz next_sample;
+
+	/* Establish signal handlers. */
+	pqsignal(SIGHUP, SignalHandlerForConfigReload);
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	Assert(AshState != NULL);
+
+	batch = palloc(sizeof(AshSample) * ProcGlobal->allProcCount);
+
+	ereport(DEBUG1,
+			(errmsg_internal("active session history sampler started")));
+
+	next_sample = GetCurrentTimestamp();
+	for (;;)
+	{
+		TimestampTz now;
+		long		delay;
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (ConfigReloadPending)
+		{
+			ConfigReloadPending = false;
+			ProcessConfigFile(PGC_SIGHUP);
+		}
+
+		now = GetCurrentTimestamp();
+		if (now >= next_sample)
+		{
+			ash_take_samples(batch);
+
+			/*
+			 * Keep to the configured rhythm, but don't try to catch up on
+			 * rounds we missed.
+			 */
+			next_sample = TimestampTzPlusMilliseconds(next_sample,
+													  active_session_history_interval);
+			if (next_sample <= now)
+				next_sample = TimestampTzPlusMilliseconds(now,
+														  active_session_history_interval);
+		}
+
+		delay = TimestampDifferenceMilliseconds(now, next_sample);
+		(void) WaitLatch(MyLatch,
+						 WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+						 delay,
+						 WAIT_EVENT_ACTIVE_SESSION_HISTORY_MAIN);
+		ResetLatch(MyLatch);
+	}
+}
+
+/*
+ * Returns the samples in the active session history buffer, oldest first
+ */
+Datum
+pg_get_active_session_history(PG_FUNCTION_ARGS)
+{
+#define PG_GET_ACTIVE_SESSION_HISTORY_COLS	11
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	AshSample  *samples;
+	uint64		first;
+	uint64		last;
+	int			nsamples;
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	if (AshState == NULL)
+		return (Datum) 0;
+
+	/* Copy the buffer, so we don't hold the lock while building tuples */
+	LWLockAcquire(&AshState->lock, LW_SHARED);
+	last = AshState->nsamples;
+	first = (last > (uint64) AshState->capacity) ?
+		last - AshState->capacity : 0;
+	nsamples = (int) (last - first);
+	samples = palloc(sizeof(AshSample) * Max(nsamples, 1));
+	for (int i = 0; i < nsamples; i++)
+		samples[i] = AshState->samples[(first + i) % AshState->capacity];
+	LWLockRelease(&AshState->lock);
+
+	for (int i = 0; i < nsamples; i++)
+	{
+		AshSample  *sample = &samples[i];
+		Datum		values[PG_GET_ACTIVE_SESSION_HISTORY_COLS] = {0};
+		bool		nulls[PG_GET_ACTIVE_SESSION_HISTORY_COLS] = {0};
+		const char *wait_event_type;
+		const char *wait_event;
+
+		values[0] = TimestampTzGetDatum(sample->sample_time);
+		values[1] = Int32GetDatum(sample->pid);
+		values[2] = CStringGetTextDatum(GetBackendTypeDesc(sample->backend_type));
+
+		if (OidIsValid(sample->datid))
+			values[3] = ObjectIdGetDatum(sample->datid);
+		else
+			nulls[3] = true;
+		if (OidIsValid(sample->userid))
+			values[4] = ObjectIdGetDatum(sample->userid);
+		else
+			nulls[4] = true;
+
+		switch (sample->state)
+		{
+			case STATE_RUNNING:
+				values[5] = CStringGetTextDatum("active");
+				break;
+			case STATE_FASTPATH:
+				values[5] = CStringGetTextDatum("fastpath function call");
+				break;
+			default:
+				nulls[5] = true;
+				break;
+		}
+
+		wait_event_type = pgstat_get_wait_event_type(sample->wait_event_info);
+		wait_event = pgstat_get_wait_event(sample->wait_event_info);
+		if (wait_event_type)
+			values[6] = CStringGetTextDatum(wait_event_type);
+		else
+			nulls[6] = true;
+		if (wait_event)
+			values[7] = CStringGetTextDatum(wait_event);
+		else
+			nulls[7] = true;
+
+		/* a sample without a wait event means the process was on CPU */
+		values[8] = BoolGetDatum(sample->wait_event_info == 0);
+
+		/* Like pg_stat_activity, show zero identifiers as null */
+		if (sample->query_id != 0)
+			values[9] = Int64GetDatum(sample->query_id);
+		else
+			nulls[9] = true;
+		if (sample->plan_id != 0)
+			values[10] = Int64GetDatum(sample->plan_id);
+		else
+			nulls[10] = true;
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc,
+							 values, nulls);
+	}
+
+	pfree(samples);
+
+	return (Datum) 0;
+}
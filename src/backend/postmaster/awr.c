@@ -0,0 +1,372 @@
+/*-------------------------------------------------------------------------
+ *
+ * awr.c
+ *	  Workload repository
+ *
+ * The cumulative statistics are counters since the last reset, so by
+ * themselves they cannot tell how busy the server was between 14:00 and
+ * 15:00 last Tuesday.  The workload repository keeps periodic snapshots of
+ * them in the tables of the pg_awr schema, created by initdb, and the
+ * pg_awr.report_* functions compute the activity between any two snapshots.
+ *
+ * A snapshot records pg_stat_database, pg_stat_wal, pg_stat_io, the user
+ * tables of the current database other than its own, the active session
+ * history samples taken since the previous snapshot, summarized by wait
+ * event, and, if pg_stat_statements is installed and loaded, its counters
+ * aggregated by query.  The rows of a snapshot reference it with ON DELETE CASCADE, so
+ * purging old snapshots is a single DELETE.
+ *
+ * Snapshots are taken by pg_awr_create_snapshot() and, if
+ * workload_repository_database is set, every workload_repository_interval
+ * by the workload repository worker, which also purges snapshots older
+ * than workload_repository_retention.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  src/backend/postmaster/awr.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/xact.h"
+#include "catalog/pg_type.h"
+#include "commands/extension.h"
+#include "datatype/timestamp.h"
+#include "executor/spi.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "postmaster/awr.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/interrupt.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "tcop/tcopprot.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/lsyscache.h"
+#include "utils/snapmgr.h"
+#include "utils/timestamp.h"
+#include "utils/wait_event.h"
+
+/* GUC parameters */
+char	   *workload_repository_database = NULL;
+int			workload_repository_interval = 60;
+int			workload_repository_retention = 8 * 24 * 60;
+
+/*
+ * Statements filling in a snapshot, whose snap_id is $1, from the
+ * cumulative statistics views.
+ */
+static const char *const awr_snapshot_queries[] = {
+	"INSERT INTO pg_awr.stat_database "
+	"SELECT $1, datid, datname, xact_commit, xact_rollback, blks_read, "
+	"blks_hit, tup_returned, tup_fetched, tup_inserted, tup_updated, "
+	"tup_deleted, temp_bytes, deadlocks, blk_read_time, blk_write_time, "
+	"active_time "
+	"FROM pg_catalog.pg_stat_database",
+
+	"INSERT INTO pg_awr.stat_wal "
+	"SELECT $1, wal_records, wal_fpi, wal_bytes, wal_buffers_full "
+	"FROM pg_catalog.pg_stat_wal",
+
+	"INSERT INTO pg_awr.stat_io "
+	"SELECT $1, backend_type, object, context, reads, read_bytes, "
+	"read_time, writes, write_bytes, write_time, writebacks, extends, "
+	"extend_bytes, hits, evictions, reuses, fsyncs, fsync_time "
+	"FROM pg_catalog.pg_stat_io",
+
+	"INSERT INTO pg_awr.stat_tables "
+	"SELECT $1, s.relid, s.schemaname, s.relname, s.seq_scan, "
+	"s.seq_tup_read, s.idx_scan, s.idx_tup_fetch, s.n_tup_ins, s.n_tup_upd, "
+	"s.n_tup_del, io.heap_blks_read, io.heap_blks_hit, io.idx_blks_read, "
+	"io.idx_blks_hit "
+	"FROM pg_catalog.pg_stat_user_tables s "
+	"JOIN pg_catalog.pg_statio_user_tables io ON io.relid = s.relid "
+	"WHERE s.schemaname <> 'pg_awr'",
+
+	/* the samples taken since the previous snapshot */
+	"INSERT INTO pg_awr.wait_samples "
+	"SELECT s.snap_id, h.wait_event_type, h.wait_event, count(*) "
+	"FROM pg_awr.snapshots s, pg_catalog.pg_active_session_history h "
+	"WHERE s.snap_id = $1 AND h.sample_time <= s.snap_time "
+	"AND h.sample_time > COALESCE((SELECT max(p.snap_time) "
+	"FROM pg_awr.snapshots p WHERE p.snap_id < $1), '-infinity') "
+	"GROUP BY s.snap_id, h.wait_event_type, h.wait_event"
+};
+
+static void awr_execute(const char *query, int nargs, Oid *argtypes,
+						Datum *values, int expected);
+static void awr_snapshot_statements(int64 snap_id);
+static int64 awr_create_snapshot(void);
+static int64 awr_purge_snapshots(Interval *retention);
+static TimestampTz awr_next_snapshot_time(TimestampTz now);
+
+
+/*
+ * Register the workload repository worker, if enabled
+ */
+void
+AwrRegister(void)
+{
+	BackgroundWorker bgw;
+
+	if (workload_repository_database == NULL ||
+		workload_repository_database[0] == '\0')
+		return;
+
+	memset(&bgw, 0, sizeof(bgw));
+	bgw.bgw_flags = BGWORKER_SHMEM_ACCESS |
+		BGWORKER_BACKEND_DATABASE_CONNECTION;
+	bgw.bgw_start_time = BgWorkerStart_RecoveryFinished;
+	snprintf(bgw.bgw_library_name, MAXPGPATH, "postgres");
+	snprintf(bgw.bgw_function_name, BGW_MAXLEN, "AwrWorkerMain");
+	snprintf(bgw.bgw_name, BGW_MAXLEN, "workload repository worker");
+	snprintf(bgw.bgw_type, BGW_MAXLEN, "workload repository worker");
+	bgw.bgw_restart_time = 60;
+	bgw.bgw_notify_pid = 0;
+	bgw.bgw_main_arg = (Datum) 0;
+
+	RegisterBackgroundWorker(&bgw);
+}
+
+/*
+ * Run a statement through SPI, and complain if it doesn't return the
+ * expected result code.
+ */
+static void
+awr_execute(const char *query, int nargs, Oid *argtypes, Datum *values,
+			int expected)
+{
+	int			ret;
+
+	ret = SPI_execute_with_args(query, nargs, argtypes, values, NULL,
+								false, 0);
+	if (ret != expected)
+		elog(ERROR, "SPI_execute_with_args returned %s while executing query \"%s\"",
+			 SPI_result_code_string(ret), query);
+}
+
+/*
+ * Add the pg_stat_statements counters to a snapshot, if it's available.
+ *
+ * The counters are summed over top-level and nested execution, and the
+ * query texts are kept once per query in pg_awr.statement_texts.
+ */
+static void
+awr_snapshot_statements(int64 snap_id)
+{
+	Oid			extoid;
+	char	   *nspname;
+	char	   *query;
+	Oid			argtypes[1] = {INT8OID};
+	Datum		values[1];
+
+	/* calling pg_stat_statements() fails if the library isn't loaded */
+	extoid = get_extension_oid("pg_stat_statements", true);
+	if (!OidIsValid(extoid) ||
+		GetConfigOption("pg_stat_statements.max", true, false) == NULL)
+		return;
+
+	nspname = get_namespace_name(get_extension_schema(extoid));
+	if (nspname == NULL)
+		return;
+
+	values[0] = Int64GetDatum(snap_id);
+	query = psprintf("INSERT INTO pg_awr.stat_statements "
+					 "SELECT $1, userid, dbid, queryid, sum(calls), "
+					 "sum(total_exec_time), sum(rows), sum(shared_blks_hit), "
+					 "sum(shared_blks_read), sum(shared_blks_written), "
+					 "sum(temp_blks_read), sum(temp_blks_written) "
+					 "FROM %s.pg_stat_statements(false) "
+					 "WHERE queryid IS NOT NULL "
+					 "GROUP BY userid, dbid, queryid",
+					 quote_identifier(nspname));
+	awr_execute(query, 1, argtypes, values, SPI_OK_INSERT);
+	pfree(query);
+
+	query = psprintf("INSERT INTO pg_awr.statement_texts "
+					 "SELECT DISTINCT ON (s.dbid, s.queryid) "
+					 "s.dbid, s.queryid, s.query "
+					 "FROM %s.pg_stat_statements(true) s "
+					 "WHERE s.queryid IS NOT NULL AND NOT EXISTS "
+					 "(SELECT 1 FROM pg_awr.statement_texts t "
+					 "WHERE t.dbid = s.dbid AND t.queryid = s.queryid) "
+					 "ON CONFLICT DO NOTHING",
+					 quote_identifier(nspname));
+	awr_execute(query, 0, NULL, NULL, SPI_OK_INSERT);
+	pfree(query);
+}
+
+/*
+ * Take a snapshot, and return its snap_id.  The caller must be in a
+ * transaction with an active snapshot.
+ */
+static int64
+awr_create_snapshot(void)
+{
+	Oid			argtypes[1] = {INT8OID};
+	Datum		values[1];
+	bool		isnull;
+	int64		snap_id;
+
+	SPI_connect();
+
+	awr_execute("INSERT INTO pg_awr.snapshots (snap_time) VALUES (now()) "
+				"RETURNING snap_id",
+				0, NULL, NULL, SPI_OK_INSERT_RETURNING);
+	snap_id = DatumGetInt64(SPI_getbinval(SPI_tuptable->vals[0],
+										  SPI_tuptable->tupdesc,
+										  1, &isnull));
+	Assert(!isnull);
+
+	values[0] = Int64GetDatum(snap_id);
+	for (int i = 0; i < lengthof(awr_snapshot_queries); i++)
+		awr_execute(awr_snapshot_queries[i], 1, argtypes, values,
+					SPI_OK_INSERT);
+
+	awr_snapshot_statements(snap_id);
+
+	SPI_finish();
+
+	return snap_id;
+}
+
+/*
+ * Delete the snapshots taken more than retention ago, and the query texts
+ * no longer referenced by any snapshot.  Returns the number of snapshots
+ * deleted.
+ */
+static int64
+awr_purge_snapshots(Interval *retention)
+{
+	Oid			argtypes[1] = {INTERVALOID};
+	Datum		values[1];
+	int64		ndeleted;
+
+	SPI_connect();
+
+	values[0] = IntervalPGetDatum(retention);
+	awr_execute("DELETE FROM pg_awr.snapshots WHERE snap_time < now() - $1",
+				1, argtypes, values, SPI_OK_DELETE);
+	ndeleted = (int64) SPI_processed;
+
+	if (ndeleted > 0)
+		awr_execute("DELETE FROM pg_awr.statement_texts t WHERE NOT EXISTS "
+					"(SELECT 1 FROM pg_awr.stat_statements s "
+					"WHERE s.dbid = t.dbid AND s.queryid = t.queryid)",
+					0, NULL, NULL, SPI_OK_DELETE);
+
+	SPI_finish();
+
+	return ndeleted;
+}
+
+/*
+ * Time of the next scheduled snapshot after now.  Snapshots are aligned to
+ * multiples of workload_repository_interval, so that with an interval of an
+ * hour they are taken on the hour and line up from one day to the next.
+ */
+static TimestampTz
+awr_next_snapshot_time(TimestampTz now)
+{
+	int64		interval = (int64) workload_repository_interval * USECS_PER_MINUTE;
+
+	return (now / interval + 1) * interval;
+}
+
+/*
+ * Main entry point of the workload repository worker
+ */
+void
+AwrWorkerMain(Datum main_arg)
+{
+	TimestampTz next_snapshot;
+
+	/* Establish signal handlers. */
+	pqsignal(SIGHUP, SignalHandlerForConfigReload);
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	BackgroundWorkerInitializeConnection(workload_repository_database,
+										 NULL, 0);
+
+	ereport(DEBUG1,
+			(errmsg_internal("workload repository worker started")));
+
+	next_snapshot = awr_next_snapshot_time(GetCurrentTimestamp());
+	for (;;)
+	{
+		TimestampTz now;
+		long		delay;
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (ConfigReloadPending)
+		{
+			ConfigReloadPending = false;
+			ProcessConfigFile(PGC_SIGHUP);
+			next_snapshot = awr_next_snapshot_time(GetCurrentTimestamp());
+		}
+
+		now = GetCurrentTimestamp();
+		if (now >= next_snapshot)
+		{
+			SetCurrentStatementStartTimestamp();
+			StartTransactionCommand();
+			PushActiveSnapshot(GetTransactionSnapshot());
+			pgstat_report_activity(STATE_RUNNING,
+								   "taking workload repository snapshot");
+
+			(void) awr_create_snapshot();
+
+			if (workload_repository_retention > 0)
+			{
+				Interval	retention;
+
+				retention.month = 0;
+				retention.day = 0;
+				retention.time = (int64) workload_repository_retention *
+					USECS_PER_MINUTE;
+				(void) awr_purge_snapshots(&retention);
+			}
+
+			PopActiveSnapshot();
+			CommitTransactionCommand();
+			pgstat_report_stat(true);
+			pgstat_report_activity(STATE_IDLE, NULL);
+
+			now = GetCurrentTimestamp();
+			next_snapshot = awr_next_snapshot_time(now);
+		}
+
+		delay = TimestampDifferenceMilliseconds(now, next_snapshot);
+		(void) WaitLatch(MyLatch,
+						 WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+						 delay,
+						 WAIT_EVENT_WORKLOAD_REPOSITORY_MAIN);
+		ResetLatch(MyLatch);
+	}
+}
+
+/*
+ * Take a workload repository snapshot, and return its snap_id
+ */
+Datum
+pg_awr_create_snapshot(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_INT64(awr_create_snapshot());
+}
+
+/*
+ * Delete the workload repository snapshots older than the given interval,
+ * and return the number of snapshots deleted
+ */
+Datum
+pg_awr_purge_snapshots(PG_FUNCTION_ARGS)
+{
+	Interval   *retention = PG_GETARG_INTERVAL_P(0);
+
+	PG_RETURN_INT64(awr_purge_snapshots(retention));
+}
@@ -17,9 +17,12 @@
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "port/atomics.h"
+#include "postmaster/ash.h"
+#include "postmaster/awr.h"
 #include "postmaster/bgworker_internals.h"
 #include "postmaster/postmaster.h"
 #include "replication/logicallauncher.h"
+#include "replication/logicalreadworker.h"
 #include "replication/logicalworker.h"
 #include "storage/ipc.h"
 #include "storage/latch.h"
@@ -132,6 +135,18 @@ static const struct
 	},
 	{
 		"TablesyncWorkerMain", TablesyncWorkerMain
+	},
+	{
+		"TableCopyWorkerMain", TableCopyWorkerMain
+	},
+	{
+		"LogicalReadWorkerMain", LogicalReadWorkerMain
+	},
+	{
+		"AshSamplerMain", AshSamplerMain
+	},
+	{
+		"AwrWorkerMain", AwrWorkerMain
 	}
 };
 
@@ -55,6 +55,7 @@
 
 #ifdef EXEC_BACKEND
 #include "nodes/queryjumble.h"
+#include "portability/instr_time.h"
 #include "storage/pg_shmem.h"
 #include "storage/spin.h"
 #endif
@@ -117,6 +118,8 @@ typedef struct
 	bool		IsBinaryUpgrade;
 	bool		query_id_enabled;
 	int			max_safe_fds;
+	bool		instr_use_tsc;
+	double		instr_ns_per_tick;
 	int			MaxBackends;
 	int			num_pmchild_slots;
 #ifdef WIN32
@@ -778,6 +781,8 @@ save_backend_variables(BackendParameters *param,
 	param->IsBinaryUpgrade = IsBinaryUpgrade;
 	param->query_id_enabled = query_id_enabled;
 	param->max_safe_fds = max_safe_fds;
+	param->instr_use_tsc = pg_instr_use_tsc;
+	param->instr_ns_per_tick = pg_instr_ns_per_tick;
 
 	param->MaxBackends = MaxBackends;
 	param->num_pmchild_slots = num_pmchild_slots;
@@ -1038,6 +1043,8 @@ restore_backend_variables(BackendParameters *param)
 	IsBinaryUpgrade = param->IsBinaryUpgrade;
 	query_id_enabled = param->query_id_enabled;
 	max_safe_fds = param->max_safe_fds;
+	pg_instr_use_tsc = param->instr_use_tsc;
+	pg_instr_ns_per_tick = param->instr_ns_per_tick;
 
 	MaxBackends = param->MaxBackends;
 	num_pmchild_slots = param->num_pmchild_slots;
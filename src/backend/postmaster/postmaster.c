@@ -102,6 +102,9 @@
 #include "pgstat.h"
 #include "parser/scansup.h"
 #include "port/pg_bswap.h"
+#include "portability/instr_time.h"
+#include "postmaster/ash.h"
+#include "postmaster/awr.h"
 #include "postmaster/autovacuum.h"
 #include "postmaster/bgworker_internals.h"
 #include "postmaster/pgarch.h"
@@ -936,12 +939,27 @@ PostmasterMain(int argc, char *argv[])
 	 */
 	LocalProcessControlFile(false);
 
+	/*
+	 * Choose the clock for instr_time, which takes a few milliseconds if the
+	 * TSC has to be calibrated.  Only the postmaster does that; its children
+	 * inherit the result, and with EXEC_BACKEND it's passed down in the
+	 * backend parameters.  Other modes, like single-user mode, keep to
+	 * clock_gettime().
+	 */
+	pg_initialize_timing();
+
 	/*
 	 * Register the apply launcher.  It's probably a good idea to call this
 	 * before any modules had a chance to take the background worker slots.
 	 */
 	ApplyLauncherRegister();
 
+	/* Likewise the active session history sampler, if enabled */
+	AshRegister();
+
+	/* ... and the workload repository worker */
+	AwrRegister();
+
 	/*
 	 * process any libraries that should be preloaded at postmaster start
 	 */
@@ -50,6 +50,8 @@
 int			max_logical_replication_workers = 4;
 int			max_sync_workers_per_subscription = 2;
 int			max_parallel_apply_workers_per_subscription = 2;
+int			max_parallel_copy_workers_per_table = 0;
+int			min_parallel_copy_table_size = (1024 * 1024 * 1024) / BLCKSZ;
 
 LogicalRepWorker *MyLogicalRepWorker = NULL;
 
@@ -241,7 +243,8 @@ WaitForReplicationWorkerAttach(LogicalRepWorker *worker,
  * Walks the workers array and searches for one that matches given
  * subscription id and relid.
  *
- * We are only interested in the leader apply worker or table sync worker.
+ * We are only interested in the leader apply worker or table sync worker,
+ * not in the table copy workers helping the latter.
  */
 LogicalRepWorker *
 logicalrep_worker_find(Oid subid, Oid relid, bool only_running)
@@ -256,8 +259,8 @@ logicalrep_worker_find(Oid subid, Oid relid, bool only_running)
 	{
 		LogicalRepWorker *w = &LogicalRepCtx->workers[i];
 
-		/* Skip parallel apply workers. */
-		if (isParallelApplyWorker(w))
+		/* Skip parallel apply and table copy workers. */
+		if (isParallelApplyWorker(w) || isTableCopyWorker(w))
 			continue;
 
 		if (w->in_use && w->subid == subid && w->relid == relid &&
@@ -322,16 +325,18 @@ logicalrep_worker_launch(LogicalRepWorkerType wtype,
 	TimestampTz now;
 	bool		is_tablesync_worker = (wtype == WORKERTYPE_TABLESYNC);
 	bool		is_parallel_apply_worker = (wtype == WORKERTYPE_PARALLEL_APPLY);
+	bool		is_table_copy_worker = (wtype == WORKERTYPE_TABLESYNC_COPY);
 
 	/*----------
 	 * Sanity checks:
 	 * - must be valid worker type
-	 * - tablesync workers are only ones to have relid
-	 * - parallel apply worker is the only kind of subworker
+	 * - tablesync and table copy workers are only ones to have relid
+	 * - parallel apply and table copy workers are the only kinds of subworker
 	 */
 	Assert(wtype != WORKERTYPE_UNKNOWN);
-	Assert(is_tablesync_worker == OidIsValid(relid));
-	Assert(is_parallel_apply_worker == (subworker_dsm != DSM_HANDLE_INVALID));
+	Assert((is_tablesync_worker || is_table_copy_worker) == OidIsValid(relid));
+	Assert((is_parallel_apply_worker || is_table_copy_worker) ==
+		   (subworker_dsm != DSM_HANDLE_INVALID));
 
 	ereport(DEBUG1,
 			(errmsg_internal("starting logical replication worker for subscription \"%s\"",
@@ -404,9 +409,11 @@ retry:
 	/*
 	 * We don't allow to invoke more sync workers once we have reached the
 	 * sync worker limit per subscription. So, just return silently as we
-	 * might get here because of an otherwise harmless race condition.
+	 * might get here because of an otherwise harmless race condition.  Table
+	 * copy workers count against the same limit.
 	 */
-	if (is_tablesync_worker && nsyncworkers >= max_sync_workers_per_subscription)
+	if ((is_tablesync_worker || is_table_copy_worker) &&
+		nsyncworkers >= max_sync_workers_per_subscription)
 	{
 		LWLockRelease(LogicalRepWorkerLock);
 		return false;
@@ -451,8 +458,14 @@ retry:
 	worker->relid = relid;
 	worker->relstate = SUBREL_STATE_UNKNOWN;
 	worker->relstate_lsn = InvalidXLogRecPtr;
+	worker->copy_range_start = InvalidBlockNumber;
+	worker->copy_range_end = InvalidBlockNumber;
+	worker->copy_ranges_done = 0;
+	worker->copy_ranges_total = 0;
+	worker->copy_tuples = 0;
 	worker->stream_fileset = NULL;
-	worker->leader_pid = is_parallel_apply_worker ? MyProcPid : InvalidPid;
+	worker->leader_pid = (is_parallel_apply_worker || is_table_copy_worker) ?
+		MyProcPid : InvalidPid;
 	worker->parallel_apply = is_parallel_apply_worker;
 	worker->last_lsn = InvalidXLogRecPtr;
 	TIMESTAMP_NOBEGIN(worker->last_send_time);
@@ -501,6 +514,17 @@ retry:
 			snprintf(bgw.bgw_type, BGW_MAXLEN, "logical replication tablesync worker");
 			break;
 
+		case WORKERTYPE_TABLESYNC_COPY:
+			snprintf(bgw.bgw_function_name, BGW_MAXLEN, "TableCopyWorkerMain");
+			snprintf(bgw.bgw_name, BGW_MAXLEN,
+					 "logical replication table copy worker for subscription %u sync %u",
+					 subid,
+					 relid);
+			snprintf(bgw.bgw_type, BGW_MAXLEN, "logical replication table copy worker");
+
+			memcpy(bgw.bgw_extra, &subworker_dsm, sizeof(dsm_handle));
+			break;
+
 		case WORKERTYPE_UNKNOWN:
 			/* Should never happen. */
 			elog(ERROR, "unknown worker type");
@@ -852,7 +876,7 @@ logicalrep_worker_onexit(int code, Datum arg)
 
 /*
  * Count the number of registered (not necessarily running) sync workers
- * for a subscription.
+ * for a subscription, including the table copy workers helping them.
  */
 int
 logicalrep_sync_worker_count(Oid subid)
@@ -867,7 +891,8 @@ logicalrep_sync_worker_count(Oid subid)
 	{
 		LogicalRepWorker *w = &LogicalRepCtx->workers[i];
 
-		if (isTablesyncWorker(w) && w->subid == subid)
+		if ((isTablesyncWorker(w) || isTableCopyWorker(w)) &&
+			w->subid == subid)
 			res++;
 	}
 
@@ -1329,13 +1354,13 @@ pg_stat_get_subscription(PG_FUNCTION_ARGS)
 		worker_pid = worker.proc->pid;
 
 		values[0] = ObjectIdGetDatum(worker.subid);
-		if (isTablesyncWorker(&worker))
+		if (isTablesyncWorker(&worker) || isTableCopyWorker(&worker))
 			values[1] = ObjectIdGetDatum(worker.relid);
 		else
 			nulls[1] = true;
 		values[2] = Int32GetDatum(worker_pid);
 
-		if (isParallelApplyWorker(&worker))
+		if (isParallelApplyWorker(&worker) || isTableCopyWorker(&worker))
 			values[3] = Int32GetDatum(worker.leader_pid);
 		else
 			nulls[3] = true;
@@ -1372,6 +1397,9 @@ pg_stat_get_subscription(PG_FUNCTION_ARGS)
 			case WORKERTYPE_TABLESYNC:
 				values[9] = CStringGetTextDatum("table synchronization");
 				break;
+			case WORKERTYPE_TABLESYNC_COPY:
+				values[9] = CStringGetTextDatum("table copy");
+				break;
 			case WORKERTYPE_UNKNOWN:
 				/* Should never happen. */
 				elog(ERROR, "unknown worker type");
@@ -1392,3 +1420,81 @@ pg_stat_get_subscription(PG_FUNCTION_ARGS)
 
 	return (Datum) 0;
 }
+
+/*
+ * Returns the progress of the table copies split between several workers.
+ *
+ * There is a row for each worker taking part in such a copy, showing the
+ * block range it is copying.
+ */
+Datum
+pg_stat_get_subscription_copy(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_SUBSCRIPTION_COPY_COLS	9
+	Oid			subid = PG_ARGISNULL(0) ? InvalidOid : PG_GETARG_OID(0);
+	int			i;
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	LWLockAcquire(LogicalRepWorkerLock, LW_SHARED);
+
+	for (i = 0; i < max_logical_replication_workers; i++)
+	{
+		Datum		values[PG_STAT_GET_SUBSCRIPTION_COPY_COLS] = {0};
+		bool		nulls[PG_STAT_GET_SUBSCRIPTION_COPY_COLS] = {0};
+		LogicalRepWorker *w = &LogicalRepCtx->workers[i];
+		BlockNumber range_start;
+		BlockNumber range_end;
+		int			ranges_done;
+		int			ranges_total;
+		uint64		tuples;
+		int			worker_pid;
+
+		if (!isTablesyncWorker(w) && !isTableCopyWorker(w))
+			continue;
+		if (!w->proc || !IsBackendPid(w->proc->pid))
+			continue;
+		if (OidIsValid(subid) && w->subid != subid)
+			continue;
+
+		SpinLockAcquire(&w->relmutex);
+		range_start = w->copy_range_start;
+		range_end = w->copy_range_end;
+		ranges_done = w->copy_ranges_done;
+		ranges_total = w->copy_ranges_total;
+		tuples = w->copy_tuples;
+		SpinLockRelease(&w->relmutex);
+
+		if (ranges_total == 0)
+			continue;
+
+		worker_pid = w->proc->pid;
+
+		values[0] = ObjectIdGetDatum(w->subid);
+		values[1] = ObjectIdGetDatum(w->relid);
+		values[2] = Int32GetDatum(worker_pid);
+		if (isTableCopyWorker(w))
+			values[3] = Int32GetDatum(w->leader_pid);
+		else
+			nulls[3] = true;
+		if (range_start == InvalidBlockNumber)
+			nulls[4] = true;
+		else
+			values[4] = Int64GetDatum((int64) range_start);
+		if (range_start == InvalidBlockNumber || range_end == InvalidBlockNumber)
+			nulls[5] = true;
+		else
+			values[5] = Int64GetDatum((int64) range_end);
+		values[6] = Int32GetDatum(ranges_done);
+		values[7] = Int32GetDatum(ranges_total);
+		values[8] = Int64GetDatum((int64) tuples);
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc,
+							 values, nulls);
+	}
+
+	LWLockRelease(LogicalRepWorkerLock);
+
+	return (Datum) 0;
+}
@@ -27,6 +27,7 @@
 #include "nodes/makefuncs.h"
 #include "replication/decode.h"
 #include "replication/logical.h"
+#include "replication/logicalreadworker.h"
 #include "replication/message.h"
 #include "utils/array.h"
 #include "utils/builtins.h"
@@ -244,6 +245,7 @@ pg_logical_slot_get_changes_guts(FunctionCallInfo fcinfo, bool confirm, bool bin
 		 * accumulated into reorder buffers.
 		 */
 		XLogBeginRead(ctx->reader, MyReplicationSlot->data.restart_lsn);
+		LogicalReadWorkerStart(ctx, NULL);
 
 		/* invalidate non-timetravel entries */
 		InvalidateSystemCaches();
@@ -254,7 +256,7 @@ pg_logical_slot_get_changes_guts(FunctionCallInfo fcinfo, bool confirm, bool bin
 			XLogRecord *record;
 			char	   *errm = NULL;
 
-			record = XLogReadRecord(ctx->reader, &errm);
+			record = LogicalDecodingReadRecord(ctx, &errm);
 			if (errm)
 				elog(ERROR, "could not find record for logical decoding: %s", errm);
 
@@ -0,0 +1,735 @@
+/*-------------------------------------------------------------------------
+ *
+ * logicalreadworker.c
+ *	  Reading WAL for logical decoding in a background worker
+ *
+ * With logical_decoding_read_worker enabled, a process decoding a logical
+ * replication slot hands reading the WAL off to a background worker, so that
+ * reading WAL pages, reassembling records that cross page boundaries,
+ * verifying their CRCs and decoding their block references overlap with
+ * decoding the changes.  The worker sends each DecodedXLogRecord through a
+ * shm_mq in WAL order, and the decoding process installs it in its own
+ * XLogReaderState as if it had read the record itself, so transactions are
+ * still reassembled and handed to the output plugin in commit order.
+ *
+ * Full-page images are never looked at by logical decoding, so the worker
+ * leaves them out.  Records of built-in resource managers that have no
+ * decode routine matter only for the transaction IDs in their header, so
+ * for those the worker sends just the fixed part of the decoded record.
+ *
+ * The worker waits for WAL to be flushed (or replayed, on a standby) before
+ * reading it, telling the decoding process which position it waits for.
+ * The decoding process waits for that position in its own way, using a
+ * callback such as WalSndWaitForWal() so that a walsender keeps serving its
+ * client meanwhile, and wakes up the worker.  The callback is also called
+ * for each record before it is returned, so that the decoding process can
+ * hold back records as it would when reading WAL itself, for example until
+ * the standbys listed in synchronized_standby_slots have caught up.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  src/backend/replication/logical/logicalreadworker.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/rmgr.h"
+#include "access/xlog_internal.h"
+#include "access/xlogrecovery.h"
+#include "access/xlogutils.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/interrupt.h"
+#include "replication/logicalreadworker.h"
+#include "storage/dsm.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/proc.h"
+#include "storage/shm_mq.h"
+#include "storage/shm_toc.h"
+#include "tcop/tcopprot.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
+
+#define PG_LOGICAL_READ_SHM_MAGIC		0x6c726477
+
+/* DSM keys for the read worker */
+#define LOGICAL_READ_KEY_SHARED			1
+#define LOGICAL_READ_KEY_MQ				2
+
+/* Size of the queue between the read worker and the decoding process */
+#define LOGICAL_READ_QUEUE_SIZE			(16 * 1024 * 1024)
+
+/* GUC variable */
+bool		logical_decoding_read_worker = false;
+
+/* Information shared with the read worker */
+typedef struct LogicalReadWorkerShared
+{
+	XLogRecPtr	startpoint;		/* where to start reading */
+} LogicalReadWorkerShared;
+
+/*
+ * Messages sent by the read worker.  Each consists of this header, followed
+ * by:
+ *
+ * LOGICAL_READ_MSG_RECORD: the fixed part of a DecodedXLogRecord with
+ * nblocks entries in its blocks array, then the main data and each block's
+ * data and, if with_images, its image.
+ *
+ * LOGICAL_READ_MSG_INVALID: the message returned by XLogReadRecord().
+ *
+ * LOGICAL_READ_MSG_ERROR: the message of an error raised in the worker.
+ *
+ * LOGICAL_READ_MSG_WAIT: nothing; the worker waits for WAL up to wait_lsn.
+ */
+typedef enum LogicalReadMsgType
+{
+	LOGICAL_READ_MSG_RECORD,
+	LOGICAL_READ_MSG_INVALID,
+	LOGICAL_READ_MSG_ERROR,
+	LOGICAL_READ_MSG_WAIT,
+} LogicalReadMsgType;
+
+typedef struct LogicalReadMsg
+{
+	LogicalReadMsgType type;
+	int			sqlerrcode;		/* for LOGICAL_READ_MSG_ERROR */
+	XLogRecPtr	wait_lsn;		/* for LOGICAL_READ_MSG_WAIT */
+	int			nblocks;		/* block references included */
+	bool		with_data;		/* main and block data included? */
+	bool		with_images;	/* full-page images included? */
+} LogicalReadMsg;
+
+/* State of the decoding process */
+typedef struct LogicalReadWorker
+{
+	dsm_segment *seg;
+	shm_mq_handle *mqh;
+	LogicalReadWorkerWaitCB wait_for_wal;
+
+	/* WAL position the worker waits for, if it said so */
+	XLogRecPtr	wait_lsn;
+
+	/* Record received but not yet returned, and space for it */
+	DecodedXLogRecord *decoded;
+	Size		decoded_size;
+	bool		pending;
+} LogicalReadWorker;
+
+/* State of the read worker */
+static shm_mq_handle *read_worker_mqh = NULL;
+static XLogRecPtr read_worker_read_upto = InvalidXLogRecPtr;
+
+static void logical_read_worker_detach(dsm_segment *seg, Datum arg);
+static XLogRecPtr logical_read_worker_wait_local(XLogRecPtr loc);
+static bool logical_read_worker_unpack(LogicalReadWorker *rw,
+									   const char *data, Size nbytes,
+									   char **errormsg);
+static int	logical_read_worker_page_read(XLogReaderState *state,
+										  XLogRecPtr targetPagePtr,
+										  int reqLen,
+										  XLogRecPtr targetRecPtr,
+										  char *cur_page);
+static bool logical_read_worker_send(shm_mq_handle *mqh, LogicalReadMsg *msg,
+									 const char *data, Size len, bool flush);
+static bool logical_read_worker_send_record(shm_mq_handle *mqh,
+											DecodedXLogRecord *decoded,
+											bool flush);
+
+/*
+ * Start a background worker reading WAL for the given decoding context,
+ * beginning where its reader was positioned by XLogBeginRead().
+ *
+ * If no worker can be started, we silently keep reading WAL ourselves.
+ */
+void
+LogicalReadWorkerStart(LogicalDecodingContext *ctx,
+					   LogicalReadWorkerWaitCB wait_for_wal)
+{
+	shm_toc_estimator e;
+	Size		segsize;
+	dsm_segment *seg;
+	dsm_handle	seghandle;
+	shm_toc    *toc;
+	LogicalReadWorkerShared *shared;
+	shm_mq	   *mq;
+	BackgroundWorker bgw;
+	BackgroundWorkerHandle *handle;
+	LogicalReadWorker *rw;
+	MemoryContext oldcontext;
+
+	Assert(ctx->read_worker == NULL);
+
+	if (!logical_decoding_read_worker)
+		return;
+
+	shm_toc_initialize_estimator(&e);
+	shm_toc_estimate_chunk(&e, sizeof(LogicalReadWorkerShared));
+	shm_toc_estimate_chunk(&e, LOGICAL_READ_QUEUE_SIZE);
+	shm_toc_estimate_keys(&e, 2);
+	segsize = shm_toc_estimate(&e);
+
+	seg = dsm_create(segsize, DSM_CREATE_NULL_IF_MAXSEGMENTS);
+	if (seg == NULL)
+		return;
+
+	toc = shm_toc_create(PG_LOGICAL_READ_SHM_MAGIC, dsm_segment_address(seg),
+						 segsize);
+
+	shared = shm_toc_allocate(toc, sizeof(LogicalReadWorkerShared));
+	shared->startpoint = ctx->reader->EndRecPtr;
+	shm_toc_insert(toc, LOGICAL_READ_KEY_SHARED, shared);
+
+	mq = shm_mq_create(shm_toc_allocate(toc, LOGICAL_READ_QUEUE_SIZE),
+					   LOGICAL_READ_QUEUE_SIZE);
+	shm_toc_insert(toc, LOGICAL_READ_KEY_MQ, mq);
+	shm_mq_set_receiver(mq, MyProc);
+
+	memset(&bgw, 0, sizeof(bgw));
+	bgw.bgw_flags = BGWORKER_SHMEM_ACCESS;
+	bgw.bgw_start_time = BgWorkerStart_ConsistentState;
+	snprintf(bgw.bgw_library_name, MAXPGPATH, "postgres");
+	snprintf(bgw.bgw_function_name, BGW_MAXLEN, "LogicalReadWorkerMain");
+	snprintf(bgw.bgw_name, BGW_MAXLEN,
+			 "logical decoding read worker for PID %d", MyProcPid);
+	snprintf(bgw.bgw_type, BGW_MAXLEN, "logical decoding read worker");
+	bgw.bgw_restart_time = BGW_NEVER_RESTART;
+	bgw.bgw_notify_pid = MyProcPid;
+	bgw.bgw_main_arg = (Datum) 0;
+	seghandle = dsm_segment_handle(seg);
+	memcpy(bgw.bgw_extra, &seghandle, sizeof(dsm_handle));
+
+	/*
+	 * The handle must outlive the decoding context, because it's needed to
+	 * stop the worker if we error out before LogicalReadWorkerStop().
+	 */
+	oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+	if (!RegisterDynamicBackgroundWorker(&bgw, &handle))
+	{
+		MemoryContextSwitchTo(oldcontext);
+		dsm_detach(seg);
+		ereport(DEBUG1,
+				(errmsg_internal("could not start logical decoding read worker, reading WAL in this process")));
+		return;
+	}
+	MemoryContextSwitchTo(oldcontext);
+
+	on_dsm_detach(seg, logical_read_worker_detach, PointerGetDatum(handle));
+
+	rw = MemoryContextAllocZero(ctx->context, sizeof(LogicalReadWorker));
+	rw->seg = seg;
+	rw->mqh = shm_mq_attach(mq, seg, handle);
+	rw->wait_for_wal = wait_for_wal;
+	rw->wait_lsn = InvalidXLogRecPtr;
+	ctx->read_worker = rw;
+}
+
+/*
+ * Stop the read worker of the given decoding context, if any.
+ */
+void
+LogicalReadWorkerStop(LogicalDecodingContext *ctx)
+{
+	LogicalReadWorker *rw = ctx->read_worker;
+
+	if (rw == NULL)
+		return;
+
+	ctx->read_worker = NULL;
+
+	/* terminates the worker, see logical_read_worker_detach() */
+	shm_mq_detach(rw->mqh);
+	dsm_detach(rw->seg);
+
+	if (rw->decoded != NULL)
+		pfree(rw->decoded);
+	pfree(rw);
+}
+
+/*
+ * on_dsm_detach callback of the decoding process, making sure the worker
+ * goes away with the queue.
+ */
+static void
+logical_read_worker_detach(dsm_segment *seg, Datum arg)
+{
+	BackgroundWorkerHandle *handle = (BackgroundWorkerHandle *) DatumGetPointer(arg);
+
+	TerminateBackgroundWorker(handle);
+	pfree(handle);
+}
+
+/*
+ * Read the next record for logical decoding, like XLogReadRecord() does.
+ *
+ * If there is a read worker, the record is received from it and installed
+ * in ctx->reader.  Otherwise, we just call XLogReadRecord().
+ */
+XLogRecord *
+LogicalDecodingReadRecord(LogicalDecodingContext *ctx, char **errormsg)
+{
+	LogicalReadWorker *rw = ctx->read_worker;
+	XLogReaderState *reader = ctx->reader;
+
+	if (rw == NULL)
+		return XLogReadRecord(reader, errormsg);
+
+	*errormsg = NULL;
+
+	while (!rw->pending)
+	{
+		shm_mq_result res;
+		Size		nbytes;
+		void	   *data;
+
+		res = shm_mq_receive(rw->mqh, &nbytes, &data, true);
+
+		if (res == SHM_MQ_WOULD_BLOCK)
+		{
+			PGPROC	   *sender = shm_mq_get_sender(shm_mq_get_queue(rw->mqh));
+			XLogRecPtr	target = Max(reader->EndRecPtr + 1, rw->wait_lsn);
+
+			/*
+			 * Wait for the WAL the worker needs, or for any new WAL if it
+			 * didn't tell us.  This returns right away if the WAL is there,
+			 * and the worker just hasn't caught up yet.
+			 */
+			if (rw->wait_for_wal != NULL)
+			{
+				if (rw->wait_for_wal(target) < target)
+					return NULL;
+			}
+			else
+				(void) logical_read_worker_wait_local(target);
+
+			/* wake up the worker, in case it sleeps */
+			if (sender != NULL)
+				SetLatch(&sender->procLatch);
+
+			res = shm_mq_receive(rw->mqh, &nbytes, &data, false);
+		}
+
+		if (res != SHM_MQ_SUCCESS)
+			ereport(ERROR,
+					(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+					 errmsg("logical decoding read worker exited unexpectedly")));
+
+		if (!logical_read_worker_unpack(rw, data, nbytes, errormsg))
+			return NULL;
+	}
+
+	/* hold the record back until the caller may decode it */
+	if (rw->wait_for_wal != NULL &&
+		rw->wait_for_wal(rw->decoded->next_lsn) < rw->decoded->next_lsn)
+		return NULL;
+
+	rw->pending = false;
+
+	reader->record = rw->decoded;
+	reader->ReadRecPtr = rw->decoded->lsn;
+	reader->EndRecPtr = rw->decoded->next_lsn;
+	reader->NextRecPtr = rw->decoded->next_lsn;
+
+	return &rw->decoded->header;
+}
+
+/*
+ * Wait for WAL to be flushed, or replayed on a standby, up to loc, the way
+ * read_local_xlog_page() does.
+ */
+static XLogRecPtr
+logical_read_worker_wait_local(XLogRecPtr loc)
+{
+	for (;;)
+	{
+		XLogRecPtr	read_upto;
+
+		if (RecoveryInProgress())
+			read_upto = GetXLogReplayRecPtr(NULL);
+		else
+			read_upto = GetFlushRecPtr(NULL);
+
+		if (loc <= read_upto)
+			return read_upto;
+
+		CHECK_FOR_INTERRUPTS();
+		pg_usleep(1000L);
+	}
+}
+
+/*
+ * Process a message sent by the worker.  A record is rebuilt in
+ * rw->decoded and marked pending.
+ *
+ * Returns false if the worker reported invalid WAL, with *errormsg set.
+ */
+static bool
+logical_read_worker_unpack(LogicalReadWorker *rw, const char *data,
+						   Size nbytes, char **errormsg)
+{
+	LogicalReadMsg msg;
+	const char *ptr;
+	const char *end = data + nbytes;
+	DecodedXLogRecord *decoded;
+	Size		fixedlen;
+	Size		needed;
+	char	   *out;
+
+	Assert(nbytes >= sizeof(LogicalReadMsg));
+	memcpy(&msg, data, sizeof(LogicalReadMsg));
+	ptr = data + sizeof(LogicalReadMsg);
+
+	switch (msg.type)
+	{
+		case LOGICAL_READ_MSG_RECORD:
+			rw->wait_lsn = InvalidXLogRecPtr;
+			break;
+
+		case LOGICAL_READ_MSG_WAIT:
+			rw->wait_lsn = msg.wait_lsn;
+			return true;
+
+		case LOGICAL_READ_MSG_INVALID:
+			*errormsg = pnstrdup(ptr, end - ptr);
+			return false;
+
+		case LOGICAL_READ_MSG_ERROR:
+			ereport(ERROR,
+					(errcode(msg.sqlerrcode),
+					 errmsg_internal("%.*s", (int) (end - ptr), ptr),
+					 errcontext("logical decoding read worker")));
+			break;
+	}
+
+	Assert(msg.nblocks >= 0 && msg.nblocks <= XLR_MAX_BLOCK_ID + 1);
+	fixedlen = offsetof(DecodedXLogRecord, blocks) +
+		msg.nblocks * sizeof(DecodedBkpBlock);
+	Assert(end - ptr >= fixedlen);
+
+	/*
+	 * Work out the space needed from the lengths in the fixed part, leaving
+	 * room to MAXALIGN each piece of data as DecodeXLogRecord() does.
+	 */
+	needed = MAXALIGN(fixedlen) + (end - ptr - fixedlen) +
+		(2 * msg.nblocks + 1) * (MAXIMUM_ALIGNOF - 1);
+	if (rw->decoded_size < needed)
+	{
+		if (rw->decoded != NULL)
+			pfree(rw->decoded);
+		rw->decoded_size = Max(needed, 2 * rw->decoded_size);
+		rw->decoded = MemoryContextAlloc(GetMemoryChunkContext(rw),
+										 rw->decoded_size);
+	}
+
+	decoded = rw->decoded;
+	memcpy(decoded, ptr, fixedlen);
+	ptr += fixedlen;
+	out = (char *) decoded + MAXALIGN(fixedlen);
+
+	decoded->next = NULL;
+	decoded->oversized = false;
+	decoded->max_block_id = msg.nblocks - 1;
+
+	if (msg.with_data && decoded->main_data_len > 0)
+	{
+		decoded->main_data = out;
+		memcpy(out, ptr, decoded->main_data_len);
+		ptr += decoded->main_data_len;
+		out += MAXALIGN(decoded->main_data_len);
+	}
+	else
+	{
+		decoded->main_data = NULL;
+		decoded->main_data_len = 0;
+	}
+
+	for (int block_id = 0; block_id < msg.nblocks; block_id++)
+	{
+		DecodedBkpBlock *blk = &decoded->blocks[block_id];
+
+		blk->prefetch_buffer = InvalidBuffer;
+
+		if (!blk->in_use)
+			continue;
+
+		if (blk->has_data)
+		{
+			blk->data = out;
+			blk->data_bufsz = blk->data_len;
+			memcpy(out, ptr, blk->data_len);
+			ptr += blk->data_len;
+			out += MAXALIGN(blk->data_len);
+		}
+		else
+			blk->data = NULL;
+
+		if (blk->has_image && msg.with_images)
+		{
+			blk->bkp_image = out;
+			memcpy(out, ptr, blk->bimg_len);
+			ptr += blk->bimg_len;
+			out += MAXALIGN(blk->bimg_len);
+		}
+		else
+		{
+			blk->has_image = false;
+			blk->apply_image = false;
+			blk->bkp_image = NULL;
+		}
+	}
+
+	Assert(ptr == end);
+	decoded->size = out - (char *) decoded;
+	rw->pending = true;
+
+	return true;
+}
+
+/*
+ * Main entry point of the read worker.
+ */
+void
+LogicalReadWorkerMain(Datum main_arg)
+{
+	dsm_handle	handle;
+	dsm_segment *seg;
+	shm_toc    *toc;
+	LogicalReadWorkerShared *shared;
+	shm_mq	   *mq;
+	shm_mq_handle *mqh;
+	XLogReaderState *reader;
+
+	pqsignal(SIGHUP, SignalHandlerForConfigReload);
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	memcpy(&handle, MyBgworkerEntry->bgw_extra, sizeof(dsm_handle));
+	seg = dsm_attach(handle);
+	if (!seg)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map dynamic shared memory segment")));
+
+	toc = shm_toc_attach(PG_LOGICAL_READ_SHM_MAGIC, dsm_segment_address(seg));
+	if (!toc)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("invalid magic number in dynamic shared memory segment")));
+
+	shared = shm_toc_lookup(toc, LOGICAL_READ_KEY_SHARED, false);
+	mq = shm_toc_lookup(toc, LOGICAL_READ_KEY_MQ, false);
+	shm_mq_set_sender(mq, MyProc);
+	mqh = shm_mq_attach(mq, seg, NULL);
+	read_worker_mqh = mqh;
+
+	reader = XLogReaderAllocate(wal_segment_size, NULL,
+								XL_ROUTINE(.page_read = logical_read_worker_page_read,
+										   .segment_open = wal_segment_open,
+										   .segment_close = wal_segment_close),
+								NULL);
+	if (!reader)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory"),
+				 errdetail("Failed while allocating a WAL reading processor.")));
+
+	XLogBeginRead(reader, shared->startpoint);
+
+	PG_TRY();
+	{
+		for (;;)
+		{
+			XLogRecord *record;
+			char	   *errm = NULL;
+			bool		flush;
+
+			CHECK_FOR_INTERRUPTS();
+
+			if (ConfigReloadPending)
+			{
+				ConfigReloadPending = false;
+				ProcessConfigFile(PGC_SIGHUP);
+			}
+
+			record = XLogReadRecord(reader, &errm);
+			if (record == NULL)
+			{
+				LogicalReadMsg msg = {.type = LOGICAL_READ_MSG_INVALID};
+
+				if (errm == NULL)
+					errm = "unexpected end of WAL";
+				logical_read_worker_send(mqh, &msg, errm, strlen(errm), true);
+				break;
+			}
+
+			/*
+			 * Make the record visible to the decoding process right away if
+			 * we are likely to wait for more WAL next.
+			 */
+			flush = reader->EndRecPtr >= read_worker_read_upto;
+
+			if (!logical_read_worker_send_record(mqh, reader->record, flush))
+				break;
+		}
+	}
+	PG_CATCH();
+	{
+		MemoryContext ecxt = MemoryContextSwitchTo(TopMemoryContext);
+		ErrorData  *edata = CopyErrorData();
+		LogicalReadMsg msg = {.type = LOGICAL_READ_MSG_ERROR};
+
+		MemoryContextSwitchTo(ecxt);
+
+		/* let the decoding process report the error as its own */
+		msg.sqlerrcode = edata->sqlerrcode;
+		logical_read_worker_send(mqh, &msg, edata->message,
+								 strlen(edata->message), true);
+
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	XLogReaderFree(reader);
+	shm_mq_detach(mqh);
+	dsm_detach(seg);
+}
+
+/*
+ * page_read callback of the read worker: wait for the WAL to be flushed,
+ * or replayed on a standby, then read it like read_local_xlog_page().
+ */
+static int
+logical_read_worker_page_read(XLogReaderState *state, XLogRecPtr targetPagePtr,
+							  int reqLen, XLogRecPtr targetRecPtr,
+							  char *cur_page)
+{
+	XLogRecPtr	loc = targetPagePtr + reqLen;
+	bool		told = false;
+
+	while (loc > read_worker_read_upto)
+	{
+		if (RecoveryInProgress())
+			read_worker_read_upto = GetXLogReplayRecPtr(NULL);
+		else
+			read_worker_read_upto = GetFlushRecPtr(NULL);
+
+		if (loc <= read_worker_read_upto)
+			break;
+
+		/*
+		 * Hand over what we have, and tell the decoding process what we are
+		 * waiting for, before we go to sleep.
+		 */
+		if (!told)
+		{
+			LogicalReadMsg msg = {.type = LOGICAL_READ_MSG_WAIT};
+
+			msg.wait_lsn = loc;
+			if (!logical_read_worker_send(read_worker_mqh, &msg, NULL, 0, true))
+				proc_exit(0);
+			told = true;
+		}
+
+		/* the decoding process wakes us up when the WAL shows up */
+		(void) WaitLatch(MyLatch,
+						 WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+						 1000L,
+						 WAIT_EVENT_LOGICAL_DECODING_READ_WORKER_MAIN);
+		ResetLatch(MyLatch);
+
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	return read_local_xlog_page(state, targetPagePtr, reqLen, targetRecPtr,
+								cur_page);
+}
+
+/*
+ * Send a message with the given payload to the decoding process.
+ *
+ * Returns false if it has gone away.
+ */
+static bool
+logical_read_worker_send(shm_mq_handle *mqh, LogicalReadMsg *msg,
+						 const char *data, Size len, bool flush)
+{
+	shm_mq_iovec iov[2];
+
+	iov[0].data = (const char *) msg;
+	iov[0].len = sizeof(LogicalReadMsg);
+	iov[1].data = data;
+	iov[1].len = len;
+
+	return shm_mq_sendv(mqh, iov, 2, false, flush) == SHM_MQ_SUCCESS;
+}
+
+/*
+ * Send a decoded record to the decoding process, leaving out what logical
+ * decoding doesn't look at.
+ *
+ * Returns false if the decoding process has gone away.
+ */
+static bool
+logical_read_worker_send_record(shm_mq_handle *mqh, DecodedXLogRecord *decoded,
+								bool flush)
+{
+	shm_mq_iovec iov[2 + 2 * (XLR_MAX_BLOCK_ID + 1) + 1];
+	int			iovcnt = 0;
+	LogicalReadMsg msg = {.type = LOGICAL_READ_MSG_RECORD};
+	RmgrId		rmid = decoded->header.xl_rmid;
+
+	if (RmgrIdIsBuiltin(rmid) && GetRmgr(rmid).rm_decode == NULL)
+	{
+		/* only the XIDs matter, see LogicalDecodingProcessRecord() */
+		msg.nblocks = 0;
+		msg.with_data = false;
+		msg.with_images = false;
+	}
+	else
+	{
+		msg.nblocks = decoded->max_block_id + 1;
+		msg.with_data = true;
+		/* custom resource managers might want to see the images */
+		msg.with_images = !RmgrIdIsBuiltin(rmid);
+	}
+
+	iov[iovcnt].data = (const char *) &msg;
+	iov[iovcnt++].len = sizeof(LogicalReadMsg);
+	iov[iovcnt].data = (const char *) decoded;
+	iov[iovcnt++].len = offsetof(DecodedXLogRecord, blocks) +
+		msg.nblocks * sizeof(DecodedBkpBlock);
+
+	if (msg.with_data && decoded->main_data_len > 0)
+	{
+		iov[iovcnt].data = decoded->main_data;
+		iov[iovcnt++].len = decoded->main_data_len;
+	}
+
+	for (int block_id = 0; block_id < msg.nblocks; block_id++)
+	{
+		DecodedBkpBlock *blk = &decoded->blocks[block_id];
+
+		if (!blk->in_use)
+			continue;
+
+		if (blk->has_data)
+		{
+			iov[iovcnt].data = blk->data;
+			iov[iovcnt++].len = blk->data_len;
+		}
+
+		if (blk->has_image && msg.with_images)
+		{
+			iov[iovcnt].data = blk->bkp_image;
+			iov[iovcnt++].len = blk->bimg_len;
+		}
+	}
+
+	Assert(iovcnt <= lengthof(iov));
+
+	return shm_mq_sendv(mqh, iov, iovcnt, false, flush) == SHM_MQ_SUCCESS;
+}
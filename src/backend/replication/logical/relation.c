@@ -22,6 +22,7 @@
 #include "access/table.h"
 #include "catalog/namespace.h"
 #include "catalog/pg_subscription_rel.h"
+#include "catalog/pg_type.h"
 #include "executor/executor.h"
 #include "nodes/makefuncs.h"
 #include "replication/logicalrelation.h"
@@ -56,6 +57,9 @@ typedef struct LogicalRepPartMapEntry
 
 static Oid	FindLogicalRepLocalIndex(Relation localrel, LogicalRepRelation *remoterel,
 									 AttrMap *attrMap);
+static void logicalrep_rel_load_attrio(LogicalRepRelMapEntry *entry,
+									   MemoryContext parent);
+static void logicalrep_rel_free_attrio(LogicalRepRelMapEntry *entry);
 
 /*
  * Relcache invalidation callback for our relation map cache.
@@ -152,6 +156,7 @@ logicalrep_relmap_free_entry(LogicalRepRelMapEntry *entry)
 
 	if (entry->attrmap)
 		free_attrmap(entry->attrmap);
+	logicalrep_rel_free_attrio(entry);
 }
 
 /*
@@ -410,6 +415,7 @@ logicalrep_rel_open(LogicalRepRelId remoteid, LOCKMODE lockmode)
 			free_attrmap(entry->attrmap);
 			entry->attrmap = NULL;
 		}
+		logicalrep_rel_free_attrio(entry);
 
 		/* Try to find and lock the relation by name. */
 		relid = RangeVarGetRelid(makeRangeVar(remoterel->nspname,
@@ -471,6 +477,8 @@ logicalrep_rel_open(LogicalRepRelId remoteid, LOCKMODE lockmode)
 		bms_free(generatedattrs);
 		bms_free(missingatts);
 
+		logicalrep_rel_load_attrio(entry, LogicalRepRelMapContext);
+
 		/*
 		 * Set if the table's replica identity is enough to apply
 		 * update/delete.
@@ -681,6 +689,7 @@ logicalrep_partition_open(LogicalRepRelMapEntry *root,
 		free_attrmap(entry->attrmap);
 		entry->attrmap = NULL;
 	}
+	logicalrep_rel_free_attrio(entry);
 
 	if (!entry->remoterel.remoteid)
 	{
@@ -746,6 +755,8 @@ logicalrep_partition_open(LogicalRepRelMapEntry *root,
 	/* state and statelsn are left set to 0. */
 	MemoryContextSwitchTo(oldctx);
 
+	logicalrep_rel_load_attrio(entry, LogicalRepPartMapContext);
+
 	/*
 	 * Finding a usable index is an infrequent task. It occurs when an
 	 * operation is first performed on the relation, or after invalidation of
@@ -763,6 +774,66 @@ logicalrep_partition_open(LogicalRepRelMapEntry *root,
 	return entry;
 }
 
+/*
+ * Look up the input and receive functions of the replicated local attributes
+ * of entry->localrel, so that the apply worker needn't do so for every value.
+ *
+ * Everything, including any state the functions cache in fn_extra, lives in
+ * a context of its own so that it can be released when the entry is rebuilt.
+ */
+static void
+logicalrep_rel_load_attrio(LogicalRepRelMapEntry *entry, MemoryContext parent)
+{
+	TupleDesc	desc = RelationGetDescr(entry->localrel);
+	MemoryContext cxt;
+	int			i;
+
+	Assert(entry->attrio == NULL);
+	Assert(entry->attrmap->maplen == desc->natts);
+
+	cxt = AllocSetContextCreate(parent,
+								"logical replication attribute I/O",
+								ALLOCSET_SMALL_SIZES);
+	entry->attrio = (LogicalRepAttrIO *)
+		MemoryContextAllocZero(cxt, desc->natts * sizeof(LogicalRepAttrIO));
+
+	for (i = 0; i < desc->natts; i++)
+	{
+		Form_pg_attribute att = TupleDescAttr(desc, i);
+		LogicalRepAttrIO *io = &entry->attrio[i];
+		HeapTuple	typtup;
+		Form_pg_type typform;
+
+		if (att->attisdropped || entry->attrmap->attnums[i] < 0)
+			continue;
+
+		typtup = SearchSysCache1(TYPEOID, ObjectIdGetDatum(att->atttypid));
+		if (!HeapTupleIsValid(typtup))
+			elog(ERROR, "cache lookup failed for type %u", att->atttypid);
+		typform = (Form_pg_type) GETSTRUCT(typtup);
+
+		io->typioparam = getTypeIOParam(typtup);
+		fmgr_info_cxt(typform->typinput, &io->input, cxt);
+		if (OidIsValid(typform->typreceive))
+			fmgr_info_cxt(typform->typreceive, &io->receive, cxt);
+
+		ReleaseSysCache(typtup);
+	}
+}
+
+/*
+ * Release the attribute input functions of the entry, if any.
+ */
+static void
+logicalrep_rel_free_attrio(LogicalRepRelMapEntry *entry)
+{
+	if (entry->attrio)
+	{
+		MemoryContextDelete(GetMemoryChunkContext(entry->attrio));
+		entry->attrio = NULL;
+	}
+}
+
 /*
  * Returns the oid of an index that can be used by the apply worker to scan
  * the relation.
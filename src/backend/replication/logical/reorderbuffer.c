@@ -88,6 +88,12 @@
 
 #include <unistd.h>
 #include <sys/stat.h>
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
 
 #include "access/detoast.h"
 #include "access/heapam.h"
@@ -97,6 +103,7 @@
 #include "access/xlog_internal.h"
 #include "catalog/catalog.h"
 #include "common/int.h"
+#include "common/pg_lzcompress.h"
 #include "lib/binaryheap.h"
 #include "miscadmin.h"
 #include "pgstat.h"
@@ -153,6 +160,10 @@ typedef struct TXNEntryFile
 	File		vfd;			/* -1 when the file is closed */
 	off_t		curOffset;		/* offset for next write or read. Reset to 0
 								 * when vfd is opened. */
+	char	   *block;			/* current block read from the file */
+	Size		blocksize;		/* allocated size of block */
+	Size		blocklen;		/* amount of valid data in block */
+	Size		blockpos;		/* offset of next change in block */
 } TXNEntryFile;
 
 /* k-way in-order change iteration support structures */
@@ -194,6 +205,25 @@ typedef struct ReorderBufferDiskChange
 	/* data follows */
 } ReorderBufferDiskChange;
 
+/*
+ * Spill files consist of blocks of ReorderBufferDiskChange records, each
+ * block preceded by this header.  A block is compressed as a whole according
+ * to logical_decoding_spill_compression, in which case size is its
+ * compressed length and rawsize the length of the records it holds.
+ */
+typedef struct ReorderBufferDiskBlock
+{
+	Size		size;			/* length of the data following the header */
+	Size		rawsize;		/* length of the data once decompressed */
+	uint8		method;			/* a ReorderBufferSpillCompression */
+} ReorderBufferDiskBlock;
+
+/*
+ * Changes are collected into blocks of up to this size before being written
+ * out.  A single change that does not fit is written as a block of its own.
+ */
+#define REORDER_BUFFER_SPILL_BLOCK_SIZE		(64 * 1024)
+
 #define IsSpecInsert(action) \
 ( \
 	((action) == REORDER_BUFFER_CHANGE_INTERNAL_SPEC_INSERT) \
@@ -225,8 +255,9 @@ typedef struct ReorderBufferDiskChange
 int			logical_decoding_work_mem;
 static const Size max_changes_in_memory = 4096; /* XXX for restore only */
 
-/* GUC variable */
+/* GUC variables */
 int			debug_logical_replication_streaming = DEBUG_LOGICAL_REP_STREAMING_BUFFERED;
+int			logical_decoding_spill_compression = REORDER_BUFFER_SPILL_COMPRESSION_NONE;
 
 /* ---------------------------------------
  * primary reorderbuffer support routines
@@ -264,6 +295,14 @@ static void ReorderBufferExecuteInvalidations(uint32 nmsgs, SharedInvalidationMe
  */
 static void ReorderBufferCheckMemoryLimit(ReorderBuffer *rb);
 static void ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn);
+static void ReorderBufferSpillChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
+									 int fd, char *data, Size len);
+static void ReorderBufferFlushSpillBlock(ReorderBuffer *rb, ReorderBufferTXN *txn,
+										 int fd);
+static void ReorderBufferWriteSpillBlock(ReorderBuffer *rb, ReorderBufferTXN *txn,
+										 int fd, char *data, Size len,
+										 bool compress);
+static bool ReorderBufferReadSpillBlock(ReorderBuffer *rb, TXNEntryFile *file);
 static void ReorderBufferSerializeChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
 										 int fd, ReorderBufferChange *change);
 static Size ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
@@ -379,6 +418,9 @@ ReorderBufferAllocate(void)
 
 	buffer->outbuf = NULL;
 	buffer->outbufsize = 0;
+	buffer->spillbuf = NULL;
+	buffer->spilllen = 0;
+	buffer->compressbuf = NULL;
 	buffer->size = 0;
 
 	/* txn_heap is ordered by transaction size */
@@ -387,6 +429,8 @@ ReorderBufferAllocate(void)
 	buffer->spillTxns = 0;
 	buffer->spillCount = 0;
 	buffer->spillBytes = 0;
+	buffer->spillDiskBytes = 0;
+	buffer->spillWriteTime = 0;
 	buffer->streamTxns = 0;
 	buffer->streamCount = 0;
 	buffer->streamBytes = 0;
@@ -1509,6 +1553,8 @@ ReorderBufferIterTXNFinish(ReorderBuffer *rb,
 	{
 		if (state->entries[off].file.vfd != -1)
 			FileClose(state->entries[off].file.vfd);
+		if (state->entries[off].file.block != NULL)
+			pfree(state->entries[off].file.block);
 	}
 
 	/* free memory we might have "leaked" in the last *Next call */
@@ -3998,7 +4044,10 @@ ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 			char		path[MAXPGPATH];
 
 			if (fd != -1)
+			{
+				ReorderBufferFlushSpillBlock(rb, txn, fd);
 				CloseTransientFile(fd);
+			}
 
 			XLByteToSeg(change->lsn, curOpenSegNo, wal_segment_size);
 
@@ -4026,6 +4075,9 @@ ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 		spilled++;
 	}
 
+	if (fd != -1)
+		ReorderBufferFlushSpillBlock(rb, txn, fd);
+
 	/* Update the memory counter */
 	ReorderBufferChangeMemoryUpdate(rb, NULL, txn, false, size);
 
@@ -4237,9 +4289,141 @@ ReorderBufferSerializeChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
 
 	ondisk->size = sz;
 
+	ReorderBufferSpillChange(rb, txn, fd, rb->outbuf, sz);
+
+	/*
+	 * Keep the transaction's final_lsn up to date with each change we send to
+	 * disk, so that ReorderBufferRestoreCleanup works correctly.  (We used to
+	 * only do this on commit and abort records, but that doesn't work if a
+	 * system crash leaves a transaction without its abort record).
+	 *
+	 * Make sure not to move it backwards.
+	 */
+	if (txn->final_lsn < change->lsn)
+		txn->final_lsn = change->lsn;
+
+	Assert(ondisk->change.action == change->action);
+}
+
+/*
+ * Queue a serialized change for writing to the spill file fd.
+ *
+ * Changes are collected in rb->spillbuf and written out a block at a time by
+ * ReorderBufferFlushSpillBlock(), which the caller has to call before
+ * closing fd.
+ */
+static void
+ReorderBufferSpillChange(ReorderBuffer *rb, ReorderBufferTXN *txn, int fd,
+						 char *data, Size len)
+{
+	if (rb->spilllen > 0 &&
+		rb->spilllen + len > REORDER_BUFFER_SPILL_BLOCK_SIZE)
+		ReorderBufferFlushSpillBlock(rb, txn, fd);
+
+	/* a change too large for a block is written out on its own */
+	if (len >= REORDER_BUFFER_SPILL_BLOCK_SIZE)
+	{
+		ReorderBufferWriteSpillBlock(rb, txn, fd, data, len, false);
+		return;
+	}
+
+	if (rb->spillbuf == NULL)
+		rb->spillbuf = MemoryContextAlloc(rb->context,
+										  REORDER_BUFFER_SPILL_BLOCK_SIZE);
+
+	memcpy(rb->spillbuf + rb->spilllen, data, len);
+	rb->spilllen += len;
+}
+
+/*
+ * Write out the changes collected in rb->spillbuf, if any.
+ */
+static void
+ReorderBufferFlushSpillBlock(ReorderBuffer *rb, ReorderBufferTXN *txn, int fd)
+{
+	Size		len = rb->spilllen;
+
+	if (len == 0)
+		return;
+
+	/* reset first, so that a failed write doesn't leave the data behind */
+	rb->spilllen = 0;
+	ReorderBufferWriteSpillBlock(rb, txn, fd, rb->spillbuf, len, true);
+}
+
+/*
+ * Compress a block of changes into rb->compressbuf.
+ *
+ * Returns the compressed length, or -1 if the data could not be compressed
+ * into less than its original size.
+ */
+static int32
+ReorderBufferCompressSpillBlock(ReorderBuffer *rb, int method,
+								char *data, Size len)
+{
+	int32		clen = -1;
+
+	Assert(len <= REORDER_BUFFER_SPILL_BLOCK_SIZE);
+
+	/* the buffer is large enough for pglz; others are told to stop short */
+	if (rb->compressbuf == NULL)
+		rb->compressbuf =
+			MemoryContextAlloc(rb->context,
+							   PGLZ_MAX_OUTPUT(REORDER_BUFFER_SPILL_BLOCK_SIZE));
+
+	switch ((ReorderBufferSpillCompression) method)
+	{
+		case REORDER_BUFFER_SPILL_COMPRESSION_PGLZ:
+			clen = pglz_compress(data, len, rb->compressbuf,
+								 PGLZ_strategy_default);
+			break;
+
+		case REORDER_BUFFER_SPILL_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			clen = LZ4_compress_default(data, rb->compressbuf, len, len - 1);
+			if (clen <= 0)
+				clen = -1;		/* failure */
+#else
+			elog(ERROR, "LZ4 is not supported by this build");
+#endif
+			break;
+
+		case REORDER_BUFFER_SPILL_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+			{
+				size_t		zlen;
+
+				zlen = ZSTD_compress(rb->compressbuf, len - 1, data, len,
+									 ZSTD_CLEVEL_DEFAULT);
+				clen = ZSTD_isError(zlen) ? -1 : (int32) zlen;
+			}
+#else
+			elog(ERROR, "zstd is not supported by this build");
+#endif
+			break;
+
+		case REORDER_BUFFER_SPILL_COMPRESSION_NONE:
+			Assert(false);		/* cannot happen */
+			break;
+			/* no default case, so that compiler will warn */
+	}
+
+	if (clen >= (int32) len)
+		clen = -1;
+
+	return clen;
+}
+
+/*
+ * Write data to the spill file, accounting for it in the statistics.
+ */
+static void
+ReorderBufferSpillWrite(ReorderBuffer *rb, ReorderBufferTXN *txn, int fd,
+						const void *data, Size len)
+{
 	errno = 0;
 	pgstat_report_wait_start(WAIT_EVENT_REORDER_BUFFER_WRITE);
-	if (write(fd, rb->outbuf, ondisk->size) != ondisk->size)
+	if (write(fd, data, len) != len)
 	{
 		int			save_errno = errno;
 
@@ -4254,18 +4438,54 @@ ReorderBufferSerializeChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
 	}
 	pgstat_report_wait_end();
 
-	/*
-	 * Keep the transaction's final_lsn up to date with each change we send to
-	 * disk, so that ReorderBufferRestoreCleanup works correctly.  (We used to
-	 * only do this on commit and abort records, but that doesn't work if a
-	 * system crash leaves a transaction without its abort record).
-	 *
-	 * Make sure not to move it backwards.
-	 */
-	if (txn->final_lsn < change->lsn)
-		txn->final_lsn = change->lsn;
+	rb->spillDiskBytes += len;
+}
 
-	Assert(ondisk->change.action == change->action);
+/*
+ * Write a block of serialized changes to the spill file, compressing it
+ * first if requested and logical_decoding_spill_compression is set.
+ */
+static void
+ReorderBufferWriteSpillBlock(ReorderBuffer *rb, ReorderBufferTXN *txn, int fd,
+							 char *data, Size len, bool compress)
+{
+	ReorderBufferDiskBlock hdr;
+	char	   *payload = data;
+	int			method = logical_decoding_spill_compression;
+	instr_time	start;
+
+	hdr.size = len;
+	hdr.rawsize = len;
+	hdr.method = REORDER_BUFFER_SPILL_COMPRESSION_NONE;
+
+	if (compress && method != REORDER_BUFFER_SPILL_COMPRESSION_NONE)
+	{
+		int32		clen = ReorderBufferCompressSpillBlock(rb, method, data, len);
+
+		if (clen > 0)
+		{
+			hdr.size = clen;
+			hdr.method = method;
+			payload = rb->compressbuf;
+		}
+	}
+
+	if (track_io_timing)
+		INSTR_TIME_SET_CURRENT(start);
+	else
+		INSTR_TIME_SET_ZERO(start);
+
+	ReorderBufferSpillWrite(rb, txn, fd, &hdr, sizeof(hdr));
+	ReorderBufferSpillWrite(rb, txn, fd, payload, hdr.size);
+
+	if (track_io_timing)
+	{
+		instr_time	end;
+
+		INSTR_TIME_SET_CURRENT(end);
+		INSTR_TIME_SUBTRACT(end, start);
+		rb->spillWriteTime += INSTR_TIME_GET_MICROSEC(end);
+	}
 }
 
 /* Returns true, if the output plugin supports streaming, false, otherwise. */
@@ -4503,6 +4723,125 @@ ReorderBufferChangeSize(ReorderBufferChange *change)
 }
 
 
+/*
+ * Read the next block of changes from a spill file into file->block,
+ * decompressing it if needed.
+ *
+ * Returns false if we're at the end of the file.
+ */
+static bool
+ReorderBufferReadSpillBlock(ReorderBuffer *rb, TXNEntryFile *file)
+{
+	ReorderBufferDiskBlock hdr;
+	char	   *dest;
+	int			readBytes;
+	bool		ok = true;
+
+	readBytes = FileRead(file->vfd, &hdr, sizeof(hdr),
+						 file->curOffset, WAIT_EVENT_REORDER_BUFFER_READ);
+
+	/* eof */
+	if (readBytes == 0)
+		return false;
+	else if (readBytes < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from reorderbuffer spill file: %m")));
+	else if (readBytes != sizeof(hdr))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from reorderbuffer spill file: read %d instead of %u bytes",
+						readBytes, (uint32) sizeof(hdr))));
+
+	file->curOffset += readBytes;
+
+	if (hdr.size == 0 || hdr.rawsize == 0 || hdr.size > MaxAllocSize ||
+		!AllocSizeIsValid(hdr.rawsize) ||
+		hdr.method > REORDER_BUFFER_SPILL_COMPRESSION_ZSTD ||
+		(hdr.method == REORDER_BUFFER_SPILL_COMPRESSION_NONE &&
+		 hdr.size != hdr.rawsize))
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid block header in reorderbuffer spill file")));
+
+	if (file->blocksize < hdr.rawsize)
+	{
+		if (file->block != NULL)
+			pfree(file->block);
+		file->blocksize = Max(hdr.rawsize, REORDER_BUFFER_SPILL_BLOCK_SIZE);
+		file->block = MemoryContextAlloc(rb->context, file->blocksize);
+	}
+
+	/* compressed data is read into rb->outbuf, and decompressed from there */
+	if (hdr.method == REORDER_BUFFER_SPILL_COMPRESSION_NONE)
+		dest = file->block;
+	else
+	{
+		ReorderBufferSerializeReserve(rb, hdr.size);
+		dest = rb->outbuf;
+	}
+
+	readBytes = FileRead(file->vfd, dest, hdr.size, file->curOffset,
+						 WAIT_EVENT_REORDER_BUFFER_READ);
+
+	if (readBytes < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from reorderbuffer spill file: %m")));
+	else if (readBytes != hdr.size)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from reorderbuffer spill file: read %d instead of %u bytes",
+						readBytes, (uint32) hdr.size)));
+
+	file->curOffset += readBytes;
+
+	switch ((ReorderBufferSpillCompression) hdr.method)
+	{
+		case REORDER_BUFFER_SPILL_COMPRESSION_NONE:
+			break;
+
+		case REORDER_BUFFER_SPILL_COMPRESSION_PGLZ:
+			ok = pglz_decompress(dest, hdr.size, file->block, hdr.rawsize,
+								 true) == hdr.rawsize;
+			break;
+
+		case REORDER_BUFFER_SPILL_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			ok = LZ4_decompress_safe(dest, file->block, hdr.size,
+									 hdr.rawsize) == hdr.rawsize;
+#else
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("could not decompress reorderbuffer spill file"),
+					 errdetail("LZ4 is not supported by this build.")));
+#endif
+			break;
+
+		case REORDER_BUFFER_SPILL_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+			ok = ZSTD_decompress(file->block, hdr.rawsize,
+								 dest, hdr.size) == hdr.rawsize;
+#else
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("could not decompress reorderbuffer spill file"),
+					 errdetail("zstd is not supported by this build.")));
+#endif
+			break;
+	}
+
+	if (!ok)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("could not decompress reorderbuffer spill file")));
+
+	file->blocklen = hdr.rawsize;
+	file->blockpos = 0;
+
+	return true;
+}
+
 /*
  * Restore a number of changes spilled to disk back into memory.
  */
@@ -4534,8 +4873,7 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 
 	while (restored < max_changes_in_memory && *segno <= last_segno)
 	{
-		int			readBytes;
-		ReorderBufferDiskChange *ondisk;
+		Size		size = 0;
 
 		CHECK_FOR_INTERRUPTS();
 
@@ -4560,6 +4898,8 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 
 			/* No harm in resetting the offset even in case of failure */
 			file->curOffset = 0;
+			file->blocklen = 0;
+			file->blockpos = 0;
 
 			if (*fd < 0 && errno == ENOENT)
 			{
@@ -4575,60 +4915,34 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 		}
 
 		/*
-		 * Read the statically sized part of a change which has information
-		 * about the total size. If we couldn't read a record, we're at the
-		 * end of this file.
+		 * Load the next block once the current one has been used up.  If
+		 * there is none, we're at the end of this file.
 		 */
-		ReorderBufferSerializeReserve(rb, sizeof(ReorderBufferDiskChange));
-		readBytes = FileRead(file->vfd, rb->outbuf,
-							 sizeof(ReorderBufferDiskChange),
-							 file->curOffset, WAIT_EVENT_REORDER_BUFFER_READ);
-
-		/* eof */
-		if (readBytes == 0)
+		if (file->blockpos >= file->blocklen &&
+			!ReorderBufferReadSpillBlock(rb, file))
 		{
 			FileClose(*fd);
 			*fd = -1;
 			(*segno)++;
 			continue;
 		}
-		else if (readBytes < 0)
-			ereport(ERROR,
-					(errcode_for_file_access(),
-					 errmsg("could not read from reorderbuffer spill file: %m")));
-		else if (readBytes != sizeof(ReorderBufferDiskChange))
-			ereport(ERROR,
-					(errcode_for_file_access(),
-					 errmsg("could not read from reorderbuffer spill file: read %d instead of %u bytes",
-							readBytes,
-							(uint32) sizeof(ReorderBufferDiskChange))));
 
-		file->curOffset += readBytes;
-
-		ondisk = (ReorderBufferDiskChange *) rb->outbuf;
-
-		ReorderBufferSerializeReserve(rb,
-									  sizeof(ReorderBufferDiskChange) + ondisk->size);
-		ondisk = (ReorderBufferDiskChange *) rb->outbuf;
-
-		readBytes = FileRead(file->vfd,
-							 rb->outbuf + sizeof(ReorderBufferDiskChange),
-							 ondisk->size - sizeof(ReorderBufferDiskChange),
-							 file->curOffset,
-							 WAIT_EVENT_REORDER_BUFFER_READ);
-
-		if (readBytes < 0)
-			ereport(ERROR,
-					(errcode_for_file_access(),
-					 errmsg("could not read from reorderbuffer spill file: %m")));
-		else if (readBytes != ondisk->size - sizeof(ReorderBufferDiskChange))
+		/*
+		 * Copy the change out of the block, so that it's suitably aligned for
+		 * ReorderBufferRestoreChange.
+		 */
+		if (file->blocklen - file->blockpos >= sizeof(ReorderBufferDiskChange))
+			memcpy(&size, file->block + file->blockpos, sizeof(Size));
+		if (file->blocklen - file->blockpos < sizeof(ReorderBufferDiskChange) ||
+			size < sizeof(ReorderBufferDiskChange) ||
+			size > file->blocklen - file->blockpos)
 			ereport(ERROR,
-					(errcode_for_file_access(),
-					 errmsg("could not read from reorderbuffer spill file: read %d instead of %u bytes",
-							readBytes,
-							(uint32) (ondisk->size - sizeof(ReorderBufferDiskChange)))));
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg("invalid change in reorderbuffer spill file")));
 
-		file->curOffset += readBytes;
+		ReorderBufferSerializeReserve(rb, size);
+		memcpy(rb->outbuf, file->block + file->blockpos, size);
+		file->blockpos += size;
 
 		/*
 		 * ok, read a full change from disk, now restore it into proper
@@ -54,6 +54,13 @@
  *	  So the state progression is always: INIT -> DATASYNC -> FINISHEDCOPY
  *	  -> SYNCWAIT -> CATCHUP -> SYNCDONE -> READY.
  *
+ *	  A large table may instead be copied by the tablesync worker together
+ *	  with table copy workers, each copying block ranges of it as of the
+ *	  same snapshot of the publisher (see copy_table_parallel()).  The state
+ *	  is then PARALLELCOPY rather than DATASYNC; as the table copy workers
+ *	  commit separately, a worker restarting in that state truncates the
+ *	  table before copying it again.
+ *
  *	  The catalog pg_subscription_rel is used to keep information about
  *	  subscribed tables and their state.  The catalog holds all states
  *	  except SYNCWAIT and CATCHUP which are only in shared memory.
@@ -96,14 +103,17 @@
 
 #include "access/table.h"
 #include "access/xact.h"
+#include "catalog/heap.h"
 #include "catalog/indexing.h"
 #include "catalog/pg_subscription_rel.h"
 #include "catalog/pg_type.h"
 #include "commands/copy.h"
+#include "commands/tablecmds.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
 #include "parser/parse_relation.h"
 #include "pgstat.h"
+#include "postmaster/bgworker.h"
 #include "replication/logicallauncher.h"
 #include "replication/logicalrelation.h"
 #include "replication/logicalworker.h"
@@ -111,8 +121,12 @@
 #include "replication/slot.h"
 #include "replication/walreceiver.h"
 #include "replication/worker_internal.h"
+#include "storage/bufmgr.h"
+#include "storage/condition_variable.h"
+#include "storage/dsm.h"
 #include "storage/ipc.h"
 #include "storage/lmgr.h"
+#include "storage/spin.h"
 #include "utils/acl.h"
 #include "utils/array.h"
 #include "utils/builtins.h"
@@ -136,6 +150,37 @@ static bool FetchTableStates(bool *started_tx);
 
 static StringInfo copybuf = NULL;
 
+/* Number of block ranges per process taking part in a parallel copy */
+#define TABLE_COPY_RANGES_PER_PROCESS	4
+
+/*
+ * State of a table copy split between the tablesync worker and table copy
+ * workers, kept in a DSM segment created by the former.
+ */
+typedef struct TableCopyShared
+{
+	slock_t		mutex;			/* protects the fields below */
+	ConditionVariable cv;		/* signaled when any of them changes */
+
+	char		snapshot[NAMEDATALEN];	/* publisher snapshot to import */
+	BlockNumber nblocks;		/* publisher table size at start */
+	int			nranges;		/* number of block ranges */
+	int			next_range;		/* next block range to copy */
+
+	int			nattached;		/* table copy workers that joined */
+	int			ncopied;		/* ... that are done copying */
+	int			ncommitted;		/* ... that committed */
+	int			nfailed;		/* ... that failed */
+
+	bool		closed;			/* no table copy worker may join anymore */
+	bool		commit;			/* table copy workers may commit */
+	bool		leader_gone;	/* tablesync worker has detached */
+} TableCopyShared;
+
+/* State of a table copy worker; see table_copy_worker_shutdown() */
+static bool table_copy_copied = false;
+static bool table_copy_committed = false;
+
 /*
  * Exit routine for synchronization worker.
  */
@@ -689,6 +734,7 @@ process_syncing_tables(XLogRecPtr current_lsn)
 			process_syncing_tables_for_apply(current_lsn);
 			break;
 
+		case WORKERTYPE_TABLESYNC_COPY:
 		case WORKERTYPE_UNKNOWN:
 			/* Should never happen. */
 			elog(ERROR, "Unknown worker type");
@@ -1111,47 +1157,37 @@ fetch_remote_table_info(char *nspname, char *relname, LogicalRepRelation *lrel,
 }
 
 /*
- * Copy existing data of a table from publisher.
+ * Copy the published data of a table, or of the given block range of it, from
+ * publisher.  range_start is InvalidBlockNumber to copy the whole table, and
+ * range_end is InvalidBlockNumber for a range extending to the end of it.
  *
- * Caller is responsible for locking the local relation.
+ * Returns the number of rows copied.
  */
-static void
-copy_table(Relation rel)
+static uint64
+copy_table_data(Relation rel, LogicalRepRelMapEntry *relmapentry,
+				LogicalRepRelation *lrel, List *qual, bool gencol_published,
+				BlockNumber range_start, BlockNumber range_end)
 {
-	LogicalRepRelMapEntry *relmapentry;
-	LogicalRepRelation lrel;
-	List	   *qual = NIL;
 	WalRcvExecResult *res;
 	StringInfoData cmd;
 	CopyFromState cstate;
 	List	   *attnamelist;
 	ParseState *pstate;
 	List	   *options = NIL;
-	bool		gencol_published = false;
-
-	/* Get the publisher relation info. */
-	fetch_remote_table_info(get_namespace_name(RelationGetNamespace(rel)),
-							RelationGetRelationName(rel), &lrel, &qual,
-							&gencol_published);
-
-	/* Put the relation into relmap. */
-	logicalrep_relmap_update(&lrel);
-
-	/* Map the publisher relation to local one. */
-	relmapentry = logicalrep_rel_open(lrel.remoteid, NoLock);
-	Assert(rel == relmapentry->localrel);
+	uint64		processed;
 
 	/* Start copy on the publisher. */
 	initStringInfo(&cmd);
 
 	/* Regular table with no row filter or generated columns */
-	if (lrel.relkind == RELKIND_RELATION && qual == NIL && !gencol_published)
+	if (lrel->relkind == RELKIND_RELATION && qual == NIL && !gencol_published &&
+		range_start == InvalidBlockNumber)
 	{
 		appendStringInfo(&cmd, "COPY %s",
-						 quote_qualified_identifier(lrel.nspname, lrel.relname));
+						 quote_qualified_identifier(lrel->nspname, lrel->relname));
 
 		/* If the table has columns, then specify the columns */
-		if (lrel.natts)
+		if (lrel->natts)
 		{
 			appendStringInfoString(&cmd, " (");
 
@@ -1159,12 +1195,12 @@ copy_table(Relation rel)
 			 * XXX Do we need to list the columns in all cases? Maybe we're
 			 * replicating all columns?
 			 */
-			for (int i = 0; i < lrel.natts; i++)
+			for (int i = 0; i < lrel->natts; i++)
 			{
 				if (i > 0)
 					appendStringInfoString(&cmd, ", ");
 
-				appendStringInfoString(&cmd, quote_identifier(lrel.attnames[i]));
+				appendStringInfoString(&cmd, quote_identifier(lrel->attnames[i]));
 			}
 
 			appendStringInfoChar(&cmd, ')');
@@ -1183,13 +1219,14 @@ copy_table(Relation rel)
 		 *
 		 * We also need to use this same COPY (SELECT ...) syntax when
 		 * generated columns are published, because copy of generated columns
-		 * is not supported by the normal COPY.
+		 * is not supported by the normal COPY, and when copying a block range
+		 * of the table.
 		 */
 		appendStringInfoString(&cmd, "COPY (SELECT ");
-		for (int i = 0; i < lrel.natts; i++)
+		for (int i = 0; i < lrel->natts; i++)
 		{
-			appendStringInfoString(&cmd, quote_identifier(lrel.attnames[i]));
-			if (i < lrel.natts - 1)
+			appendStringInfoString(&cmd, quote_identifier(lrel->attnames[i]));
+			if (i < lrel->natts - 1)
 				appendStringInfoString(&cmd, ", ");
 		}
 
@@ -1199,23 +1236,38 @@ copy_table(Relation rel)
 		 * For regular tables, make sure we don't copy data from a child that
 		 * inherits the named table as those will be copied separately.
 		 */
-		if (lrel.relkind == RELKIND_RELATION)
+		if (lrel->relkind == RELKIND_RELATION)
 			appendStringInfoString(&cmd, "ONLY ");
 
-		appendStringInfoString(&cmd, quote_qualified_identifier(lrel.nspname, lrel.relname));
+		appendStringInfoString(&cmd, quote_qualified_identifier(lrel->nspname, lrel->relname));
+
+		/* block range, which the publisher reads with a TID range scan */
+		if (range_start != InvalidBlockNumber)
+		{
+			appendStringInfo(&cmd, " WHERE ctid >= '(%u,0)'::pg_catalog.tid",
+							 range_start);
+			if (range_end != InvalidBlockNumber)
+				appendStringInfo(&cmd, " AND ctid < '(%u,0)'::pg_catalog.tid",
+								 range_end);
+		}
+
 		/* list of OR'ed filters */
 		if (qual != NIL)
 		{
 			ListCell   *lc;
 			char	   *q = strVal(linitial(qual));
 
-			appendStringInfo(&cmd, " WHERE %s", q);
+			if (range_start != InvalidBlockNumber)
+				appendStringInfo(&cmd, " AND (%s", q);
+			else
+				appendStringInfo(&cmd, " WHERE %s", q);
 			for_each_from(lc, qual, 1)
 			{
 				q = strVal(lfirst(lc));
 				appendStringInfo(&cmd, " OR %s", q);
 			}
-			list_free_deep(qual);
+			if (range_start != InvalidBlockNumber)
+				appendStringInfoChar(&cmd, ')');
 		}
 
 		appendStringInfoString(&cmd, ") TO STDOUT");
@@ -1239,7 +1291,7 @@ copy_table(Relation rel)
 		ereport(ERROR,
 				(errcode(ERRCODE_CONNECTION_FAILURE),
 				 errmsg("could not start initial contents copy for table \"%s.%s\": %s",
-						lrel.nspname, lrel.relname, res->err)));
+						lrel->nspname, lrel->relname, res->err)));
 	walrcv_clear_result(res);
 
 	copybuf = makeStringInfo();
@@ -1251,12 +1303,439 @@ copy_table(Relation rel)
 	attnamelist = make_copy_attnamelist(relmapentry);
 	cstate = BeginCopyFrom(pstate, rel, NULL, NULL, false, copy_read_data, attnamelist, options);
 
-	/* Do the copy */
-	(void) CopyFrom(cstate);
+	/* Do the copy; this inserts the rows in batches where possible */
+	processed = CopyFrom(cstate);
+
+	EndCopyFrom(cstate);
+	free_parsestate(pstate);
+
+	return processed;
+}
+
+/*
+ * Copy the block ranges of a table handed out by the shared copy state, until
+ * none is left.  This is done by the tablesync worker as well as by the table
+ * copy workers helping it.
+ */
+static void
+copy_table_ranges(TableCopyShared *shared, Relation rel,
+				  LogicalRepRelMapEntry *relmapentry, LogicalRepRelation *lrel,
+				  List *qual, bool gencol_published)
+{
+	SpinLockAcquire(&MyLogicalRepWorker->relmutex);
+	MyLogicalRepWorker->copy_ranges_total = shared->nranges;
+	SpinLockRelease(&MyLogicalRepWorker->relmutex);
+
+	for (;;)
+	{
+		int			range;
+		bool		leader_gone;
+		BlockNumber range_start;
+		BlockNumber range_end;
+		uint64		ntuples;
+
+		CHECK_FOR_INTERRUPTS();
+
+		SpinLockAcquire(&shared->mutex);
+		leader_gone = shared->leader_gone;
+		range = shared->next_range < shared->nranges ? shared->next_range++ : -1;
+		SpinLockRelease(&shared->mutex);
+
+		/* no point in copying more if the rows are going to be discarded */
+		if (leader_gone)
+			ereport(ERROR,
+					(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+					 errmsg("logical replication table synchronization worker for subscription \"%s\", table \"%s\" exited before the copy was finished",
+							MySubscription->name,
+							RelationGetRelationName(rel))));
+
+		if (range < 0)
+			break;
+
+		/* The ranges split the blocks evenly; the last one is open-ended. */
+		range_start = (BlockNumber) (((uint64) shared->nblocks * range) /
+									 shared->nranges);
+		if (range == shared->nranges - 1)
+			range_end = InvalidBlockNumber;
+		else
+			range_end = (BlockNumber) (((uint64) shared->nblocks * (range + 1)) /
+									   shared->nranges);
+
+		SpinLockAcquire(&MyLogicalRepWorker->relmutex);
+		MyLogicalRepWorker->copy_range_start = range_start;
+		MyLogicalRepWorker->copy_range_end = range_end;
+		SpinLockRelease(&MyLogicalRepWorker->relmutex);
+
+		elog(DEBUG1, "copying blocks %u to %u of table \"%s.%s\"",
+			 range_start, range_end, lrel->nspname, lrel->relname);
+
+		ntuples = copy_table_data(rel, relmapentry, lrel, qual,
+								  gencol_published, range_start, range_end);
+
+		SpinLockAcquire(&MyLogicalRepWorker->relmutex);
+		MyLogicalRepWorker->copy_ranges_done++;
+		MyLogicalRepWorker->copy_tuples += ntuples;
+		SpinLockRelease(&MyLogicalRepWorker->relmutex);
+	}
+
+	SpinLockAcquire(&MyLogicalRepWorker->relmutex);
+	MyLogicalRepWorker->copy_range_start = InvalidBlockNumber;
+	MyLogicalRepWorker->copy_range_end = InvalidBlockNumber;
+	SpinLockRelease(&MyLogicalRepWorker->relmutex);
+}
+
+/*
+ * on_dsm_detach callback of the tablesync worker, telling the table copy
+ * workers that it is gone.
+ */
+static void
+table_copy_leader_detach(dsm_segment *seg, Datum arg)
+{
+	TableCopyShared *shared = (TableCopyShared *) DatumGetPointer(arg);
+
+	SpinLockAcquire(&shared->mutex);
+	shared->leader_gone = true;
+	SpinLockRelease(&shared->mutex);
+
+	ConditionVariableBroadcast(&shared->cv);
+}
+
+/*
+ * Wait until all the table copy workers have reached the given count, or
+ * until one of them has failed.
+ */
+static void
+wait_for_table_copy_workers(TableCopyShared *shared, int *counter)
+{
+	for (;;)
+	{
+		int			nattached;
+		int			ndone;
+		int			nfailed;
+
+		SpinLockAcquire(&shared->mutex);
+		nattached = shared->nattached;
+		ndone = *counter;
+		nfailed = shared->nfailed;
+		SpinLockRelease(&shared->mutex);
+
+		if (nfailed > 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+					 errmsg("logical replication table copy worker for subscription \"%s\", table \"%s\" failed",
+							MySubscription->name,
+							get_rel_name(MyLogicalRepWorker->relid))));
+
+		if (ndone == nattached)
+			break;
+
+		ConditionVariableSleep(&shared->cv, WAIT_EVENT_LOGICAL_TABLE_COPY);
+	}
+
+	ConditionVariableCancelSleep();
+}
+
+/*
+ * Copy a table split into block ranges, together with table copy workers.
+ *
+ * We export the snapshot of our remote transaction, and launch up to
+ * max_parallel_copy_workers_per_table table copy workers, which import it in
+ * their own remote transaction so that all of us see the same data.  Then we
+ * all take block ranges in turn until none is left.  Each table copy worker
+ * inserts its rows in a local transaction of its own, which it commits only
+ * once we have told it that everyone succeeded, right before we commit ours.
+ * Should we or any of them fail after that, the table keeps part of the data
+ * and the state SUBREL_STATE_PARALLELCOPY, and the next attempt truncates it.
+ *
+ * Table copy workers count against max_sync_workers_per_subscription; we make
+ * do with those we can get, copying the table all alone in the worst case.
+ */
+static void
+copy_table_parallel(Relation rel, LogicalRepRelMapEntry *relmapentry,
+					LogicalRepRelation *lrel, List *qual, bool gencol_published)
+{
+	WalRcvExecResult *res;
+	char	   *cmd;
+	TupleTableSlot *slot;
+	Oid			snapRow[] = {TEXTOID, INT8OID};
+	bool		isnull;
+	char	   *snapshot;
+	int64		nblocks;
+	int			nranges;
+	int			nworkers;
+	dsm_segment *seg;
+	TableCopyShared *shared;
+
+	/* Export our snapshot, and see how much there is to copy. */
+	cmd = psprintf("SELECT pg_catalog.pg_export_snapshot(),"
+				   " pg_catalog.pg_relation_size(%u::pg_catalog.oid) /"
+				   " pg_catalog.current_setting('block_size')::pg_catalog.int8",
+				   lrel->remoteid);
+	res = walrcv_exec(LogRepWorkerWalRcvConn, cmd, lengthof(snapRow), snapRow);
+	pfree(cmd);
+	if (res->status != WALRCV_OK_TUPLES)
+		ereport(ERROR,
+				(errcode(ERRCODE_CONNECTION_FAILURE),
+				 errmsg("could not export snapshot for the copy of table \"%s.%s\" from publisher: %s",
+						lrel->nspname, lrel->relname, res->err)));
+
+	slot = MakeSingleTupleTableSlot(res->tupledesc, &TTSOpsMinimalTuple);
+	if (!tuplestore_gettupleslot(res->tuplestore, true, false, slot))
+		elog(ERROR, "unexpected empty result exporting snapshot from publisher");
+
+	snapshot = TextDatumGetCString(slot_getattr(slot, 1, &isnull));
+	Assert(!isnull);
+	nblocks = DatumGetInt64(slot_getattr(slot, 2, &isnull));
+	if (isnull)
+		nblocks = 0;
+
+	ExecDropSingleTupleTableSlot(slot);
+	walrcv_clear_result(res);
+
+	/*
+	 * Hand out several ranges per process, so that a process copying denser
+	 * or slower blocks does not hold up everyone else too much.  Rows added
+	 * beyond the size we just saw are copied with the last range.
+	 */
+	nworkers = max_parallel_copy_workers_per_table;
+	nranges = (nworkers + 1) * TABLE_COPY_RANGES_PER_PROCESS;
+	if (nranges > nblocks)
+		nranges = Max(nblocks, 1);
+	nworkers = Min(nworkers, nranges - 1);
+
+	seg = dsm_create(sizeof(TableCopyShared), 0);
+	dsm_pin_mapping(seg);
+
+	shared = (TableCopyShared *) dsm_segment_address(seg);
+	memset(shared, 0, sizeof(TableCopyShared));
+	SpinLockInit(&shared->mutex);
+	ConditionVariableInit(&shared->cv);
+	strlcpy(shared->snapshot, snapshot, sizeof(shared->snapshot));
+	shared->nblocks = (BlockNumber) nblocks;
+	shared->nranges = nranges;
+
+	on_dsm_detach(seg, table_copy_leader_detach, PointerGetDatum(shared));
+
+	for (int i = 0; i < nworkers; i++)
+	{
+		if (!logicalrep_worker_launch(WORKERTYPE_TABLESYNC_COPY,
+									  MyLogicalRepWorker->dbid,
+									  MySubscription->oid,
+									  MySubscription->name,
+									  MyLogicalRepWorker->userid,
+									  MyLogicalRepWorker->relid,
+									  dsm_segment_handle(seg)))
+			break;
+	}
+
+	copy_table_ranges(shared, rel, relmapentry, lrel, qual, gencol_published);
+
+	/*
+	 * No more table copy workers may join from now on; a late one would not
+	 * find anything left to copy anyway.
+	 */
+	SpinLockAcquire(&shared->mutex);
+	shared->closed = true;
+	SpinLockRelease(&shared->mutex);
+
+	wait_for_table_copy_workers(shared, &shared->ncopied);
+
+	elog(DEBUG1, "table \"%s.%s\" copied in %d ranges by %d table copy workers and us",
+		 lrel->nspname, lrel->relname, nranges, shared->nattached);
+
+	/* Everyone has succeeded, so let the table copy workers commit. */
+	SpinLockAcquire(&shared->mutex);
+	shared->commit = true;
+	SpinLockRelease(&shared->mutex);
+
+	ConditionVariableBroadcast(&shared->cv);
+
+	wait_for_table_copy_workers(shared, &shared->ncommitted);
+
+	dsm_detach(seg);
+
+	SpinLockAcquire(&MyLogicalRepWorker->relmutex);
+	MyLogicalRepWorker->copy_ranges_total = 0;
+	SpinLockRelease(&MyLogicalRepWorker->relmutex);
+}
+
+/*
+ * Copy existing data of a table from publisher.
+ *
+ * Caller is responsible for locking the local relation.
+ */
+static void
+copy_table(Relation rel)
+{
+	LogicalRepRelMapEntry *relmapentry;
+	LogicalRepRelation lrel;
+	List	   *qual = NIL;
+	bool		gencol_published = false;
+
+	/* Get the publisher relation info. */
+	fetch_remote_table_info(get_namespace_name(RelationGetNamespace(rel)),
+							RelationGetRelationName(rel), &lrel, &qual,
+							&gencol_published);
+
+	/* Put the relation into relmap. */
+	logicalrep_relmap_update(&lrel);
+
+	/* Map the publisher relation to local one. */
+	relmapentry = logicalrep_rel_open(lrel.remoteid, NoLock);
+	Assert(rel == relmapentry->localrel);
+
+	if (MyLogicalRepWorker->relstate == SUBREL_STATE_PARALLELCOPY &&
+		lrel.relkind == RELKIND_RELATION)
+		copy_table_parallel(rel, relmapentry, &lrel, qual, gencol_published);
+	else
+		(void) copy_table_data(rel, relmapentry, &lrel, qual, gencol_published,
+							   InvalidBlockNumber, InvalidBlockNumber);
+
+	list_free_deep(qual);
 
 	logicalrep_rel_close(relmapentry, NoLock);
 }
 
+/*
+ * Check that we have permission to copy data into the target table.
+ */
+static void
+check_table_copy_permissions(Relation rel)
+{
+	AclResult	aclresult;
+
+	/*
+	 * Check that our table sync worker has permission to insert into the
+	 * target table.
+	 */
+	aclresult = pg_class_aclcheck(RelationGetRelid(rel), GetUserId(),
+								  ACL_INSERT);
+	if (aclresult != ACLCHECK_OK)
+		aclcheck_error(aclresult,
+					   get_relkind_objtype(rel->rd_rel->relkind),
+					   RelationGetRelationName(rel));
+
+	/*
+	 * COPY FROM does not honor RLS policies.  That is not a problem for
+	 * subscriptions owned by roles with BYPASSRLS privilege (or superuser,
+	 * who has it implicitly), but other roles should not be able to
+	 * circumvent RLS.  Disallow logical replication into RLS enabled
+	 * relations for such roles.
+	 */
+	if (check_enable_rls(RelationGetRelid(rel), InvalidOid, false) == RLS_ENABLED)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("user \"%s\" cannot replicate into relation with row-level security enabled: \"%s\"",
+						GetUserNameFromId(GetUserId(), true),
+						RelationGetRelationName(rel))));
+}
+
+/*
+ * Decide whether the initial copy of a table is split between several
+ * workers, see copy_table_parallel().
+ *
+ * This is only worth it for large regular tables, and the publisher must be
+ * able to read a block range of a table without scanning all of it, which
+ * needs TID range scans.  Since the table copy workers commit separately from
+ * us, a failed attempt leaves part of the data behind, which the next attempt
+ * gets rid of by truncating the table; so the local table must also be empty
+ * and not referenced by foreign keys.
+ */
+static bool
+use_parallel_copy(Relation rel)
+{
+	WalRcvExecResult *res;
+	StringInfoData cmd;
+	TupleTableSlot *slot;
+	Oid			tableRow[] = {CHAROID, INT8OID};
+	bool		isnull;
+	char		relkind;
+	int64		relsize;
+
+	if (max_parallel_copy_workers_per_table == 0 ||
+		max_sync_workers_per_subscription < 2)
+		return false;
+
+	if (walrcv_server_version(LogRepWorkerWalRcvConn) < 140000)
+		return false;
+
+	if (rel->rd_rel->relkind != RELKIND_RELATION ||
+		RelationGetNumberOfBlocks(rel) != 0 ||
+		heap_truncate_find_FKs(list_make1_oid(RelationGetRelid(rel))) != NIL)
+		return false;
+
+	initStringInfo(&cmd);
+	appendStringInfo(&cmd, "SELECT c.relkind, pg_catalog.pg_relation_size(c.oid)"
+					 "  FROM pg_catalog.pg_class c"
+					 "  INNER JOIN pg_catalog.pg_namespace n"
+					 "        ON (c.relnamespace = n.oid)"
+					 " WHERE n.nspname = %s"
+					 "   AND c.relname = %s",
+					 quote_literal_cstr(get_namespace_name(RelationGetNamespace(rel))),
+					 quote_literal_cstr(RelationGetRelationName(rel)));
+	res = walrcv_exec(LogRepWorkerWalRcvConn, cmd.data,
+					  lengthof(tableRow), tableRow);
+	pfree(cmd.data);
+
+	if (res->status != WALRCV_OK_TUPLES)
+		ereport(ERROR,
+				(errcode(ERRCODE_CONNECTION_FAILURE),
+				 errmsg("could not fetch table info for table \"%s.%s\" from publisher: %s",
+						get_namespace_name(RelationGetNamespace(rel)),
+						RelationGetRelationName(rel), res->err)));
+
+	/* fetch_remote_table_info() complains later if the table is missing */
+	slot = MakeSingleTupleTableSlot(res->tupledesc, &TTSOpsMinimalTuple);
+	if (!tuplestore_gettupleslot(res->tuplestore, true, false, slot))
+	{
+		ExecDropSingleTupleTableSlot(slot);
+		walrcv_clear_result(res);
+		return false;
+	}
+
+	relkind = DatumGetChar(slot_getattr(slot, 1, &isnull));
+	Assert(!isnull);
+	relsize = DatumGetInt64(slot_getattr(slot, 2, &isnull));
+	if (isnull)
+		relsize = 0;
+
+	ExecDropSingleTupleTableSlot(slot);
+	walrcv_clear_result(res);
+
+	return relkind == RELKIND_RELATION &&
+		relsize / BLCKSZ >= min_parallel_copy_table_size;
+}
+
+/*
+ * Truncate the table, to get rid of the rows a failed parallel copy of it left
+ * behind.  The table was empty when that copy started, see use_parallel_copy().
+ */
+static void
+truncate_parallel_copy(void)
+{
+	Relation	rel;
+	List	   *relids_logged = NIL;
+
+	rel = table_open(MyLogicalRepWorker->relid, AccessExclusiveLock);
+
+	if (RelationIsLogicallyLogged(rel))
+		relids_logged = list_make1_oid(RelationGetRelid(rel));
+
+	/* See apply_handle_truncate() about the last argument. */
+	PushActiveSnapshot(GetTransactionSnapshot());
+	ExecuteTruncateGuts(list_make1(rel),
+						list_make1_oid(RelationGetRelid(rel)),
+						relids_logged,
+						DROP_RESTRICT,
+						false,
+						!MySubscription->runasowner);
+	PopActiveSnapshot();
+
+	table_close(rel, NoLock);
+
+	CommandCounterIncrement();
+}
+
 /*
  * Determine the tablesync slot name.
  *
@@ -1296,9 +1775,9 @@ LogicalRepSyncTableStart(XLogRecPtr *origin_startpos)
 	char	   *slotname;
 	char	   *err;
 	char		relstate;
+	char		newstate;
 	XLogRecPtr	relstate_lsn;
 	Relation	rel;
-	AclResult	aclresult;
 	WalRcvExecResult *res;
 	char		originname[NAMEDATALEN];
 	RepOriginId originid;
@@ -1358,6 +1837,7 @@ LogicalRepSyncTableStart(XLogRecPtr *origin_startpos)
 
 	Assert(MyLogicalRepWorker->relstate == SUBREL_STATE_INIT ||
 		   MyLogicalRepWorker->relstate == SUBREL_STATE_DATASYNC ||
+		   MyLogicalRepWorker->relstate == SUBREL_STATE_PARALLELCOPY ||
 		   MyLogicalRepWorker->relstate == SUBREL_STATE_FINISHEDCOPY);
 
 	/* Assign the origin tracking record name. */
@@ -1366,7 +1846,8 @@ LogicalRepSyncTableStart(XLogRecPtr *origin_startpos)
 									   originname,
 									   sizeof(originname));
 
-	if (MyLogicalRepWorker->relstate == SUBREL_STATE_DATASYNC)
+	if (MyLogicalRepWorker->relstate == SUBREL_STATE_DATASYNC ||
+		MyLogicalRepWorker->relstate == SUBREL_STATE_PARALLELCOPY)
 	{
 		/*
 		 * We have previously errored out before finishing the copy so the
@@ -1403,13 +1884,27 @@ LogicalRepSyncTableStart(XLogRecPtr *origin_startpos)
 		goto copy_table_done;
 	}
 
+	StartTransactionCommand();
+
+	/*
+	 * Get rid of the rows of a previous parallel copy of the table, and
+	 * decide whether to copy it in parallel this time.  The state must say so
+	 * before any table copy worker commits.
+	 */
+	if (MyLogicalRepWorker->relstate == SUBREL_STATE_PARALLELCOPY)
+		truncate_parallel_copy();
+
+	rel = table_open(MyLogicalRepWorker->relid, RowExclusiveLock);
+	newstate = use_parallel_copy(rel) ? SUBREL_STATE_PARALLELCOPY :
+		SUBREL_STATE_DATASYNC;
+	table_close(rel, NoLock);
+
 	SpinLockAcquire(&MyLogicalRepWorker->relmutex);
-	MyLogicalRepWorker->relstate = SUBREL_STATE_DATASYNC;
+	MyLogicalRepWorker->relstate = newstate;
 	MyLogicalRepWorker->relstate_lsn = InvalidXLogRecPtr;
 	SpinLockRelease(&MyLogicalRepWorker->relmutex);
 
 	/* Update the state and make it visible to others. */
-	StartTransactionCommand();
 	UpdateSubscriptionRelState(MyLogicalRepWorker->subid,
 							   MyLogicalRepWorker->relid,
 							   MyLogicalRepWorker->relstate,
@@ -1493,30 +1988,7 @@ LogicalRepSyncTableStart(XLogRecPtr *origin_startpos)
 	if (!run_as_owner)
 		SwitchToUntrustedUser(rel->rd_rel->relowner, &ucxt);
 
-	/*
-	 * Check that our table sync worker has permission to insert into the
-	 * target table.
-	 */
-	aclresult = pg_class_aclcheck(RelationGetRelid(rel), GetUserId(),
-								  ACL_INSERT);
-	if (aclresult != ACLCHECK_OK)
-		aclcheck_error(aclresult,
-					   get_relkind_objtype(rel->rd_rel->relkind),
-					   RelationGetRelationName(rel));
-
-	/*
-	 * COPY FROM does not honor RLS policies.  That is not a problem for
-	 * subscriptions owned by roles with BYPASSRLS privilege (or superuser,
-	 * who has it implicitly), but other roles should not be able to
-	 * circumvent RLS.  Disallow logical replication into RLS enabled
-	 * relations for such roles.
-	 */
-	if (check_enable_rls(RelationGetRelid(rel), InvalidOid, false) == RLS_ENABLED)
-		ereport(ERROR,
-				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
-				 errmsg("user \"%s\" cannot replicate into relation with row-level security enabled: \"%s\"",
-						GetUserNameFromId(GetUserId(), true),
-						RelationGetRelationName(rel))));
+	check_table_copy_permissions(rel);
 
 	/* Now do the initial data copy */
 	PushActiveSnapshot(GetTransactionSnapshot());
@@ -1731,6 +2203,214 @@ TablesyncWorkerMain(Datum main_arg)
 	finish_sync_worker();
 }
 
+/*
+ * before_shmem_exit callback of a table copy worker, telling the tablesync
+ * worker that we failed unless we have committed.
+ */
+static void
+table_copy_worker_shutdown(int code, Datum arg)
+{
+	TableCopyShared *shared = (TableCopyShared *) DatumGetPointer(arg);
+
+	if (table_copy_committed)
+		return;
+
+	SpinLockAcquire(&shared->mutex);
+	if (table_copy_copied)
+		shared->ncopied--;
+	shared->nfailed++;
+	SpinLockRelease(&shared->mutex);
+
+	ConditionVariableBroadcast(&shared->cv);
+}
+
+/*
+ * Copy block ranges of the table along with the tablesync worker, see
+ * copy_table_parallel().
+ */
+static void
+run_table_copy_worker(TableCopyShared *shared)
+{
+	char	   *err;
+	char		appname[NAMEDATALEN];
+	char	   *cmd;
+	WalRcvExecResult *res;
+	Relation	rel;
+	LogicalRepRelMapEntry *relmapentry;
+	LogicalRepRelation lrel;
+	List	   *qual = NIL;
+	bool		gencol_published = false;
+	UserContext ucxt;
+	bool		must_use_password;
+	bool		run_as_owner;
+
+	/* Is the use of a password mandatory? */
+	must_use_password = MySubscription->passwordrequired &&
+		!MySubscription->ownersuperuser;
+
+	snprintf(appname, sizeof(appname), "pg_%u_copy_%u_%d",
+			 MySubscription->oid, MyLogicalRepWorker->relid, MyProcPid);
+
+	LogRepWorkerWalRcvConn =
+		walrcv_connect(MySubscription->conninfo, true, true,
+					   must_use_password,
+					   appname, &err);
+	if (LogRepWorkerWalRcvConn == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_CONNECTION_FAILURE),
+				 errmsg("table copy worker for subscription \"%s\" could not connect to the publisher: %s",
+						MySubscription->name, err)));
+
+	/* Read the data as of the tablesync worker's snapshot. */
+	res = walrcv_exec(LogRepWorkerWalRcvConn,
+					  "BEGIN READ ONLY ISOLATION LEVEL REPEATABLE READ",
+					  0, NULL);
+	if (res->status != WALRCV_OK_COMMAND)
+		ereport(ERROR,
+				(errcode(ERRCODE_CONNECTION_FAILURE),
+				 errmsg("table copy could not start transaction on publisher: %s",
+						res->err)));
+	walrcv_clear_result(res);
+
+	cmd = psprintf("SET TRANSACTION SNAPSHOT %s",
+				   quote_literal_cstr(shared->snapshot));
+	res = walrcv_exec(LogRepWorkerWalRcvConn, cmd, 0, NULL);
+	pfree(cmd);
+	if (res->status != WALRCV_OK_COMMAND)
+		ereport(ERROR,
+				(errcode(ERRCODE_CONNECTION_FAILURE),
+				 errmsg("table copy could not import snapshot on publisher: %s",
+						res->err)));
+	walrcv_clear_result(res);
+
+	StartTransactionCommand();
+
+	/* Same lock and checks as the tablesync worker, see there. */
+	rel = table_open(MyLogicalRepWorker->relid, RowExclusiveLock);
+
+	run_as_owner = MySubscription->runasowner;
+	if (!run_as_owner)
+		SwitchToUntrustedUser(rel->rd_rel->relowner, &ucxt);
+
+	check_table_copy_permissions(rel);
+
+	PushActiveSnapshot(GetTransactionSnapshot());
+
+	fetch_remote_table_info(get_namespace_name(RelationGetNamespace(rel)),
+							RelationGetRelationName(rel), &lrel, &qual,
+							&gencol_published);
+	logicalrep_relmap_update(&lrel);
+	relmapentry = logicalrep_rel_open(lrel.remoteid, NoLock);
+	Assert(rel == relmapentry->localrel);
+
+	copy_table_ranges(shared, rel, relmapentry, &lrel, qual, gencol_published);
+
+	list_free_deep(qual);
+	logicalrep_rel_close(relmapentry, NoLock);
+
+	PopActiveSnapshot();
+
+	res = walrcv_exec(LogRepWorkerWalRcvConn, "COMMIT", 0, NULL);
+	if (res->status != WALRCV_OK_COMMAND)
+		ereport(ERROR,
+				(errcode(ERRCODE_CONNECTION_FAILURE),
+				 errmsg("table copy could not finish transaction on publisher: %s",
+						res->err)));
+	walrcv_clear_result(res);
+
+	if (!run_as_owner)
+		RestoreUserContext(&ucxt);
+
+	table_close(rel, NoLock);
+
+	/* Wait until the tablesync worker tells us to commit. */
+	SpinLockAcquire(&shared->mutex);
+	shared->ncopied++;
+	table_copy_copied = true;
+	SpinLockRelease(&shared->mutex);
+
+	ConditionVariableBroadcast(&shared->cv);
+
+	for (;;)
+	{
+		bool		commit;
+		bool		leader_gone;
+
+		SpinLockAcquire(&shared->mutex);
+		commit = shared->commit;
+		leader_gone = shared->leader_gone;
+		SpinLockRelease(&shared->mutex);
+
+		if (commit)
+			break;
+
+		if (leader_gone)
+			ereport(ERROR,
+					(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+					 errmsg("logical replication table synchronization worker for subscription \"%s\", table \"%s\" exited before the copy was finished",
+							MySubscription->name,
+							get_rel_name(MyLogicalRepWorker->relid))));
+
+		ConditionVariableSleep(&shared->cv, WAIT_EVENT_LOGICAL_TABLE_COPY);
+	}
+
+	ConditionVariableCancelSleep();
+
+	CommitTransactionCommand();
+
+	SpinLockAcquire(&shared->mutex);
+	shared->ncommitted++;
+	table_copy_committed = true;
+	SpinLockRelease(&shared->mutex);
+
+	ConditionVariableBroadcast(&shared->cv);
+}
+
+/* Logical Replication table copy worker entry point */
+void
+TableCopyWorkerMain(Datum main_arg)
+{
+	int			worker_slot = DatumGetInt32(main_arg);
+	dsm_handle	handle;
+	dsm_segment *seg;
+	TableCopyShared *shared;
+	bool		closed;
+
+	/*
+	 * Attach to the tablesync worker's shared state before attaching to our
+	 * worker slot: once we are attached to the latter, the tablesync worker
+	 * counts on us to tell it how our part of the copy went.
+	 *
+	 * Like parallel query, we don't need resource owner by this time.
+	 */
+	memcpy(&handle, MyBgworkerEntry->bgw_extra, sizeof(dsm_handle));
+	seg = dsm_attach(handle);
+	if (!seg)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map dynamic shared memory segment")));
+
+	shared = (TableCopyShared *) dsm_segment_address(seg);
+
+	SpinLockAcquire(&shared->mutex);
+	closed = shared->closed;
+	if (!closed)
+		shared->nattached++;
+	SpinLockRelease(&shared->mutex);
+
+	/* Too late, everything has been copied. */
+	if (closed)
+		proc_exit(0);
+
+	before_shmem_exit(table_copy_worker_shutdown, PointerGetDatum(shared));
+
+	SetupApplyOrSyncWorker(worker_slot);
+
+	run_table_copy_worker(shared);
+
+	proc_exit(0);
+}
+
 /*
  * If the subscription has no tables then return false.
  *
@@ -174,6 +174,7 @@
 #include "storage/lmgr.h"
 #include "tcop/tcopprot.h"
 #include "utils/acl.h"
+#include "utils/builtins.h"
 #include "utils/dynahash.h"
 #include "utils/guc.h"
 #include "utils/inval.h"
@@ -482,6 +483,7 @@ should_apply_changes_for_rel(LogicalRepRelMapEntry *rel)
 					(rel->state == SUBREL_STATE_SYNCDONE &&
 					 rel->statelsn <= remote_final_lsn));
 
+		case WORKERTYPE_TABLESYNC_COPY:
 		case WORKERTYPE_UNKNOWN:
 			/* Should never happen. */
 			elog(ERROR, "Unknown worker type");
@@ -814,19 +816,22 @@ slot_store_data(TupleTableSlot *slot, LogicalRepRelMapEntry *rel,
 
 			if (tupleData->colstatus[remoteattnum] == LOGICALREP_COLUMN_TEXT)
 			{
-				Oid			typinput;
-				Oid			typioparam;
+				LogicalRepAttrIO *io = &rel->attrio[i];
 
-				getTypeInputInfo(att->atttypid, &typinput, &typioparam);
 				slot->tts_values[i] =
-					OidInputFunctionCall(typinput, colvalue->data,
-										 typioparam, att->atttypmod);
+					InputFunctionCall(&io->input, colvalue->data,
+									  io->typioparam, att->atttypmod);
 				slot->tts_isnull[i] = false;
 			}
 			else if (tupleData->colstatus[remoteattnum] == LOGICALREP_COLUMN_BINARY)
 			{
-				Oid			typreceive;
-				Oid			typioparam;
+				LogicalRepAttrIO *io = &rel->attrio[i];
+
+				if (!OidIsValid(io->receive.fn_oid))
+					ereport(ERROR,
+							(errcode(ERRCODE_UNDEFINED_FUNCTION),
+							 errmsg("no binary input function available for type %s",
+									format_type_be(att->atttypid))));
 
 				/*
 				 * In some code paths we may be asked to re-parse the same
@@ -834,10 +839,9 @@ slot_store_data(TupleTableSlot *slot, LogicalRepRelMapEntry *rel,
 				 */
 				colvalue->cursor = 0;
 
-				getTypeBinaryInputInfo(att->atttypid, &typreceive, &typioparam);
 				slot->tts_values[i] =
-					OidReceiveFunctionCall(typreceive, colvalue,
-										   typioparam, att->atttypmod);
+					ReceiveFunctionCall(&io->receive, colvalue,
+										io->typioparam, att->atttypmod);
 
 				/* Trouble if it didn't eat the whole buffer */
 				if (colvalue->cursor != colvalue->len)
@@ -929,19 +933,22 @@ slot_modify_data(TupleTableSlot *slot, TupleTableSlot *srcslot,
 
 			if (tupleData->colstatus[remoteattnum] == LOGICALREP_COLUMN_TEXT)
 			{
-				Oid			typinput;
-				Oid			typioparam;
+				LogicalRepAttrIO *io = &rel->attrio[i];
 
-				getTypeInputInfo(att->atttypid, &typinput, &typioparam);
 				slot->tts_values[i] =
-					OidInputFunctionCall(typinput, colvalue->data,
-										 typioparam, att->atttypmod);
+					InputFunctionCall(&io->input, colvalue->data,
+									  io->typioparam, att->atttypmod);
 				slot->tts_isnull[i] = false;
 			}
 			else if (tupleData->colstatus[remoteattnum] == LOGICALREP_COLUMN_BINARY)
 			{
-				Oid			typreceive;
-				Oid			typioparam;
+				LogicalRepAttrIO *io = &rel->attrio[i];
+
+				if (!OidIsValid(io->receive.fn_oid))
+					ereport(ERROR,
+							(errcode(ERRCODE_UNDEFINED_FUNCTION),
+							 errmsg("no binary input function available for type %s",
+									format_type_be(att->atttypid))));
 
 				/*
 				 * In some code paths we may be asked to re-parse the same
@@ -949,10 +956,9 @@ slot_modify_data(TupleTableSlot *slot, TupleTableSlot *srcslot,
 				 */
 				colvalue->cursor = 0;
 
-				getTypeBinaryInputInfo(att->atttypid, &typreceive, &typioparam);
 				slot->tts_values[i] =
-					OidReceiveFunctionCall(typreceive, colvalue,
-										   typioparam, att->atttypmod);
+					ReceiveFunctionCall(&io->receive, colvalue,
+										io->typioparam, att->atttypmod);
 
 				/* Trouble if it didn't eat the whole buffer */
 				if (colvalue->cursor != colvalue->len)
@@ -4649,8 +4655,8 @@ run_apply_worker()
 }
 
 /*
- * Common initialization for leader apply worker, parallel apply worker and
- * tablesync worker.
+ * Common initialization for leader apply worker, parallel apply worker,
+ * tablesync worker and table copy worker.
  *
  * Initialize the database connection, in-memory subscription and necessary
  * config options.
@@ -4729,6 +4735,11 @@ InitializeLogRepWorker(void)
 				(errmsg("logical replication table synchronization worker for subscription \"%s\", table \"%s\" has started",
 						MySubscription->name,
 						get_rel_name(MyLogicalRepWorker->relid))));
+	else if (am_table_copy_worker())
+		ereport(LOG,
+				(errmsg("logical replication table copy worker for subscription \"%s\", table \"%s\" has started",
+						MySubscription->name,
+						get_rel_name(MyLogicalRepWorker->relid))));
 	else
 		ereport(LOG,
 				(errmsg("logical replication apply worker for subscription \"%s\" has started",
@@ -4748,14 +4759,15 @@ replorigin_reset(int code, Datum arg)
 	replorigin_session_origin_timestamp = 0;
 }
 
-/* Common function to setup the leader apply or tablesync worker. */
+/* Common function to setup the leader apply, tablesync or table copy worker. */
 void
 SetupApplyOrSyncWorker(int worker_slot)
 {
 	/* Attach to slot */
 	logicalrep_worker_attach(worker_slot);
 
-	Assert(am_tablesync_worker() || am_leader_apply_worker());
+	Assert(am_tablesync_worker() || am_table_copy_worker() ||
+		   am_leader_apply_worker());
 
 	/* Setup signal handling */
 	pqsignal(SIGHUP, SignalHandlerForConfigReload);
@@ -71,6 +71,7 @@
 #include "postmaster/interrupt.h"
 #include "replication/decode.h"
 #include "replication/logical.h"
+#include "replication/logicalreadworker.h"
 #include "replication/slotsync.h"
 #include "replication/slot.h"
 #include "replication/snapbuild.h"
@@ -1482,6 +1483,7 @@ StartLogicalReplication(StartReplicationCmd *cmd)
 	/* Start reading WAL from the oldest required WAL. */
 	XLogBeginRead(logical_decoding_ctx->reader,
 				  MyReplicationSlot->data.restart_lsn);
+	LogicalReadWorkerStart(logical_decoding_ctx, WalSndWaitForWal);
 
 	/*
 	 * Report the location after which we'll send out further commits as the
@@ -3423,7 +3425,7 @@ XLogSendLogical(void)
 	 */
 	WalSndCaughtUp = false;
 
-	record = XLogReadRecord(logical_decoding_ctx->reader, &errm);
+	record = LogicalDecodingReadRecord(logical_decoding_ctx, &errm);
 
 	/* xlog record was invalid */
 	if (errm != NULL)
@@ -46,6 +46,7 @@
 #endif
 #include "catalog/storage.h"
 #include "catalog/storage_xlog.h"
+#include "common/pagecompress.h"
 #include "executor/instrument.h"
 #include "lib/binaryheap.h"
 #include "miscadmin.h"
@@ -7090,6 +7091,13 @@ buffer_readv_complete_one(PgAioTargetData *td, uint8 buf_off, Buffer buffer,
 			VALGRIND_MAKE_MEM_DEFINED(bufdata, BLCKSZ);
 #endif
 
+		/*
+		 * Expand a page that was stored compressed.  A damaged image is left
+		 * alone, for PageIsVerified() to reject.
+		 */
+		if (page_is_compressed(bufdata))
+			(void) page_decompress(bufdata);
+
 		if (!PageIsVerified((Page) bufdata, tag.blockNum, piv_flags,
 							failed_checksum))
 		{
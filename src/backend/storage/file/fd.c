@@ -2460,6 +2460,49 @@ retry:
 	return FileZero(file, offset, amount, wait_event_info);
 }
 
+/*
+ * Deallocate the file space of a range, keeping the file size.  The range
+ * reads as zeroes afterwards.  Only file systems that support hole punching
+ * can do this; elsewhere this fails with EOPNOTSUPP.
+ *
+ * Returns 0 on success, -1 otherwise. In the latter case errno is set to the
+ * appropriate error.
+ */
+int
+FilePunchHole(File file, off_t offset, off_t amount, uint32 wait_event_info)
+{
+#if defined(FALLOC_FL_PUNCH_HOLE) && defined(FALLOC_FL_KEEP_SIZE)
+	int			returnCode;
+
+	Assert(FileIsValid(file));
+
+	DO_DB(elog(LOG, "FilePunchHole: %d (%s) " INT64_FORMAT " " INT64_FORMAT,
+			   file, VfdCache[file].fileName,
+			   (int64) offset, (int64) amount));
+
+	returnCode = FileAccess(file);
+	if (returnCode < 0)
+		return -1;
+
+retry:
+	pgstat_report_wait_start(wait_event_info);
+	returnCode = fallocate(VfdCache[file].fd,
+						   FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+						   offset, amount);
+	pgstat_report_wait_end();
+
+	if (returnCode == 0)
+		return 0;
+	else if (errno == EINTR)
+		goto retry;
+
+	return -1;
+#else
+	errno = EOPNOTSUPP;
+	return -1;
+#endif
+}
+
 off_t
 FileSize(File file)
 {
@@ -27,6 +27,7 @@
 #include "commands/async.h"
 #include "miscadmin.h"
 #include "pgstat.h"
+#include "postmaster/ash.h"
 #include "postmaster/autovacuum.h"
 #include "postmaster/bgworker_internals.h"
 #include "postmaster/bgwriter.h"
@@ -51,6 +52,10 @@
 #include "storage/sinvaladt.h"
 #include "utils/guc.h"
 #include "utils/injection_point.h"
+#include "utils/membroker.h"
+#include "utils/sharedcatcache.h"
+#include "utils/sharedplancache.h"
+#include "utils/sharedtsdict.h"
 
 /* GUCs */
 int			shared_memory_type = DEFAULT_SHARED_MEMORY_TYPE;
@@ -146,6 +151,11 @@ CalculateShmemSize(int *num_semaphores)
 	size = add_size(size, SyncScanShmemSize());
 	size = add_size(size, AsyncShmemSize());
 	size = add_size(size, StatsShmemSize());
+	size = add_size(size, SharedPlanCacheShmemSize());
+	size = add_size(size, SharedCatCacheShmemSize());
+	size = add_size(size, SharedTSDictShmemSize());
+	size = add_size(size, AshShmemSize());
+	size = add_size(size, MemoryBrokerShmemSize());
 	size = add_size(size, WaitEventCustomShmemSize());
 	size = add_size(size, InjectionPointShmemSize());
 	size = add_size(size, SlotSyncShmemSize());
@@ -340,6 +350,11 @@ CreateOrAttachShmemStructs(void)
 	SyncScanShmemInit();
 	AsyncShmemInit();
 	StatsShmemInit();
+	SharedPlanCacheShmemInit();
+	SharedCatCacheShmemInit();
+	SharedTSDictShmemInit();
+	AshShmemInit();
+	MemoryBrokerShmemInit();
 	WaitEventCustomShmemInit();
 	InjectionPointShmemInit();
 	AioShmemInit();
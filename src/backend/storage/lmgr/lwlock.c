@@ -179,6 +179,13 @@ static const char *const BuiltinTrancheNames[] = {
 	[LWTRANCHE_XACT_SLRU] = "XactSLRU",
 	[LWTRANCHE_PARALLEL_VACUUM_DSA] = "ParallelVacuumDSA",
 	[LWTRANCHE_AIO_URING_COMPLETION] = "AioUringCompletion",
+	[LWTRANCHE_SHARED_PLAN_CACHE_DSA] = "SharedPlanCacheDSA",
+	[LWTRANCHE_SHARED_PLAN_CACHE_HASH] = "SharedPlanCacheHash",
+	[LWTRANCHE_SHARED_CATALOG_CACHE_DSA] = "SharedCatalogCacheDSA",
+	[LWTRANCHE_SHARED_CATALOG_CACHE_HASH] = "SharedCatalogCacheHash",
+	[LWTRANCHE_SHARED_TS_DICTIONARY_DSA] = "SharedTSDictionaryDSA",
+	[LWTRANCHE_SHARED_TS_DICTIONARY] = "SharedTSDictionary",
+	[LWTRANCHE_ACTIVE_SESSION_HISTORY] = "ActiveSessionHistory",
 };
 
 StaticAssertDecl(lengthof(BuiltinTrancheNames) ==
@@ -29,6 +29,7 @@
 #include "access/xlogutils.h"
 #include "commands/tablespace.h"
 #include "common/file_utils.h"
+#include "common/pagecompress.h"
 #include "miscadmin.h"
 #include "pg_trace.h"
 #include "pgstat.h"
@@ -87,6 +88,12 @@ typedef struct _MdfdVec
 
 static MemoryContext MdCxt;		/* context for all MdfdVec objects */
 
+/*
+ * Cleared when the file system turns out not to support hole punching, after
+ * which pages are no longer stored compressed, as that would save nothing.
+ */
+static bool md_punch_hole_supported = true;
+
 
 /* Populate a file tag describing an md.c segment file. */
 #define INIT_MD_FILETAG(a,xx_rlocator,xx_forknum,xx_segno) \
@@ -151,6 +158,8 @@ static MdfdVec *_mdfd_openseg(SMgrRelation reln, ForkNumber forknum,
 							  BlockNumber segno, int oflags);
 static MdfdVec *_mdfd_getseg(SMgrRelation reln, ForkNumber forknum,
 							 BlockNumber blkno, bool skipFsync, int behavior);
+static bool mdwritecompressed(MdfdVec *v, BlockNumber blocknum,
+							  const void *buffer, bool extend);
 static BlockNumber _mdnblocks(SMgrRelation reln, ForkNumber forknum,
 							  MdfdVec *seg);
 
@@ -510,7 +519,10 @@ mdextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 
 	Assert(seekpos < (off_t) BLCKSZ * RELSEG_SIZE);
 
-	if ((nbytes = FileWrite(v->mdfd_vfd, buffer, BLCKSZ, seekpos, WAIT_EVENT_DATA_FILE_EXTEND)) != BLCKSZ)
+	if (PageGetCompression(buffer) != PAGE_COMPRESSION_NONE &&
+		mdwritecompressed(v, blocknum, buffer, true))
+		nbytes = BLCKSZ;
+	else if ((nbytes = FileWrite(v->mdfd_vfd, buffer, BLCKSZ, seekpos, WAIT_EVENT_DATA_FILE_EXTEND)) != BLCKSZ)
 	{
 		if (nbytes < 0)
 			ereport(ERROR,
@@ -963,6 +975,16 @@ mdreadv(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 			iovcnt = compute_remaining_iovec(iov, iov, iovcnt, nbytes);
 		}
 
+		/* Expand the pages that were stored compressed */
+		for (BlockNumber i = 0; i < nblocks_this_segment; i++)
+		{
+			if (page_is_compressed(buffers[i]) && !page_decompress(buffers[i]))
+				ereport(ERROR,
+						(errcode(ERRCODE_DATA_CORRUPTED),
+						 errmsg("could not decompress block %u in file \"%s\"",
+								blocknum + i, FilePathName(v->mdfd_vfd))));
+		}
+
 		nblocks -= nblocks_this_segment;
 		buffers += nblocks_this_segment;
 		blocknum += nblocks_this_segment;
@@ -1081,6 +1103,31 @@ mdwritev(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 		if (nblocks_this_segment != nblocks)
 			elog(ERROR, "write crosses segment boundary");
 
+		/*
+		 * Pages to be stored compressed are written one at a time, the others
+		 * in runs between them.
+		 */
+		if (PageGetCompression(buffers[0]) != PAGE_COMPRESSION_NONE &&
+			mdwritecompressed(v, blocknum, buffers[0], false))
+		{
+			if (!skipFsync && !SmgrIsTemp(reln))
+				register_dirty_segment(reln, forknum, v);
+
+			nblocks--;
+			buffers++;
+			blocknum++;
+			continue;
+		}
+		for (BlockNumber i = 1; i < nblocks_this_segment; i++)
+		{
+			if (PageGetCompression(buffers[i]) != PAGE_COMPRESSION_NONE &&
+				md_punch_hole_supported)
+			{
+				nblocks_this_segment = i;
+				break;
+			}
+		}
+
 		iovcnt = buffers_to_iovec(iov, (void **) buffers, nblocks_this_segment);
 		size_this_segment = nblocks_this_segment * BLCKSZ;
 		transferred_this_segment = 0;
@@ -1145,6 +1192,88 @@ mdwritev(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 }
 
 
+/*
+ * mdwritecompressed() -- Write a block as a compressed image.
+ *
+ * The image is written at the start of the block's slot, and the rest of the
+ * slot is deallocated, so the file keeps its size and layout but takes less
+ * space.  When extending the file, the whole slot is written first.
+ *
+ * Returns false, having written nothing, if the page doesn't compress well
+ * enough to save space; the caller must write it as is then.
+ */
+static bool
+mdwritecompressed(MdfdVec *v, BlockNumber blocknum, const void *buffer,
+				  bool extend)
+{
+	PGIOAlignedBlock image;
+	off_t		seekpos;
+	int			size;
+	int			len;
+	int			nbytes;
+
+	if (!md_punch_hole_supported)
+		return false;
+
+	size = page_compress(buffer, PageGetCompression(buffer), image.data);
+	if (size == 0)
+		return false;
+
+	seekpos = (off_t) BLCKSZ * (blocknum % ((BlockNumber) RELSEG_SIZE));
+
+	len = size;
+	if (extend)
+	{
+		memset(image.data + size, 0, BLCKSZ - size);
+		len = BLCKSZ;
+	}
+
+	nbytes = FileWrite(v->mdfd_vfd, image.data, len, seekpos,
+					   extend ? WAIT_EVENT_DATA_FILE_EXTEND : WAIT_EVENT_DATA_FILE_WRITE);
+	if (nbytes != len)
+	{
+		if (nbytes < 0)
+		{
+			bool		enospc = errno == ENOSPC;
+
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not write block %u in file \"%s\": %m",
+							blocknum, FilePathName(v->mdfd_vfd)),
+					 enospc ? errhint("Check free disk space.") : 0));
+		}
+		/* short write: complain appropriately */
+		ereport(ERROR,
+				(errcode(ERRCODE_DISK_FULL),
+				 errmsg("could not write block %u in file \"%s\": wrote only %d of %d bytes",
+						blocknum, FilePathName(v->mdfd_vfd), nbytes, len),
+				 errhint("Check free disk space.")));
+	}
+
+	/*
+	 * The image is complete on its own, so failing to deallocate the rest of
+	 * the slot only wastes space.
+	 */
+	if (FilePunchHole(v->mdfd_vfd, seekpos + size, BLCKSZ - size,
+					  WAIT_EVENT_DATA_FILE_WRITE) < 0)
+	{
+		if (errno == EOPNOTSUPP)
+		{
+			md_punch_hole_supported = false;
+			ereport(DEBUG1,
+					(errmsg_internal("file system of \"%s\" does not support hole punching, not compressing pages",
+									 FilePathName(v->mdfd_vfd))));
+		}
+		else
+			ereport(LOG,
+					(errcode_for_file_access(),
+					 errmsg("could not deallocate space in file \"%s\": %m",
+							FilePathName(v->mdfd_vfd))));
+	}
+
+	return true;
+}
+
 /*
  * mdwriteback() -- Tell the kernel to write pages back to storage.
  *
@@ -19,6 +19,7 @@
 #include "tsearch/ts_public.h"
 #include "utils/fmgrprotos.h"
 #include "utils/formatting.h"
+#include "utils/sharedtsdict.h"
 
 
 typedef struct
@@ -147,3 +148,43 @@ dispell_lexize(PG_FUNCTION_ARGS)
 
 	PG_RETURN_POINTER(res);
 }
+
+/*
+ * Copy a loaded dictionary into shared memory, see ts_cache.c
+ */
+void *
+dispell_copy_shared(void *dictData, SharedTSDictArena *arena)
+{
+	DictISpell *d = (DictISpell *) dictData;
+	DictISpell *copy;
+
+	copy = (DictISpell *) SharedTSDictAlloc(arena, sizeof(DictISpell));
+
+	copy->stoplist.len = d->stoplist.len;
+	if (d->stoplist.len > 0)
+	{
+		copy->stoplist.stop = (char **)
+			SharedTSDictAlloc(arena, sizeof(char *) * d->stoplist.len);
+		for (int i = 0; i < d->stoplist.len; i++)
+			copy->stoplist.stop[i] = SharedTSDictStrdup(arena,
+														d->stoplist.stop[i]);
+	}
+
+	NICopyShared(&(copy->obj), &(d->obj), arena);
+
+	return copy;
+}
+
+/*
+ * Set up the use of a dictionary copied by dispell_copy_shared
+ */
+void *
+dispell_attach_shared(void *image)
+{
+	DictISpell *d = (DictISpell *) palloc(sizeof(DictISpell));
+
+	memcpy(d, image, sizeof(DictISpell));
+	NIAttachShared(&(d->obj));
+
+	return d;
+}
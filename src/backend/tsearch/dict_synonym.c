@@ -19,6 +19,7 @@
 #include "tsearch/ts_public.h"
 #include "utils/fmgrprotos.h"
 #include "utils/formatting.h"
+#include "utils/sharedtsdict.h"
 
 typedef struct
 {
@@ -241,3 +242,40 @@ dsynonym_lexize(PG_FUNCTION_ARGS)
 
 	PG_RETURN_POINTER(res);
 }
+
+/*
+ * Copy a loaded dictionary into shared memory, see ts_cache.c
+ */
+void *
+dsynonym_copy_shared(void *dictData, SharedTSDictArena *arena)
+{
+	DictSyn    *d = (DictSyn *) dictData;
+	DictSyn    *copy;
+
+	copy = (DictSyn *) SharedTSDictAlloc(arena, sizeof(DictSyn));
+	copy->len = d->len;
+	copy->case_sensitive = d->case_sensitive;
+
+	if (d->len > 0)
+	{
+		copy->syn = (Syn *) SharedTSDictAlloc(arena, sizeof(Syn) * d->len);
+		for (int i = 0; i < d->len; i++)
+		{
+			copy->syn[i] = d->syn[i];
+			copy->syn[i].in = SharedTSDictStrdup(arena, d->syn[i].in);
+			copy->syn[i].out = SharedTSDictStrdup(arena, d->syn[i].out);
+		}
+	}
+
+	return copy;
+}
+
+/*
+ * Set up the use of a dictionary copied by dsynonym_copy_shared
+ */
+void *
+dsynonym_attach_shared(void *image)
+{
+	/* lexize only reads the dictionary, so the copy is used as it is */
+	return image;
+}
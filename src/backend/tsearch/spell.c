@@ -657,6 +657,53 @@ FindWord(IspellDict *Conf, const char *word, const char *affixflag, int flag)
 	return 0;
 }
 
+/*
+ * Compiles the mask of an affix that regis can't handle.
+ *
+ * The regex and all internal state created by pg_regcomp are allocated in
+ * CurrentMemoryContext, which is the dictionary's memory context, and will be
+ * freed automatically when it is destroyed.
+ */
+static regex_t *
+compileAffixRegex(const char *mask, int type)
+{
+	int			masklen;
+	int			wmasklen;
+	int			err;
+	pg_wchar   *wmask;
+	char	   *tmask;
+	regex_t    *regex;
+
+	tmask = (char *) palloc(strlen(mask) + 3);
+	if (type == FF_SUFFIX)
+		sprintf(tmask, "%s$", mask);
+	else
+		sprintf(tmask, "^%s", mask);
+
+	masklen = strlen(tmask);
+	wmask = (pg_wchar *) palloc((masklen + 1) * sizeof(pg_wchar));
+	wmasklen = pg_mb2wchar_with_len(tmask, wmask, masklen);
+
+	regex = palloc(sizeof(regex_t));
+	err = pg_regcomp(regex, wmask, wmasklen,
+					 REG_ADVANCED | REG_NOSUB,
+					 DEFAULT_COLLATION_OID);
+	if (err)
+	{
+		char		errstr[100];
+
+		pg_regerror(err, regex, errstr, sizeof(errstr));
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_REGULAR_EXPRESSION),
+				 errmsg("invalid regular expression: %s", errstr)));
+	}
+
+	pfree(wmask);
+	pfree(tmask);
+
+	return regex;
+}
+
 /*
  * Adds a new affix rule to the Affix field.
  *
@@ -714,42 +761,10 @@ NIAddAffix(IspellDict *Conf, const char *flag, char flagflags, const char *mask,
 	/* This affix rule will use regex_t to search word ending */
 	else
 	{
-		int			masklen;
-		int			wmasklen;
-		int			err;
-		pg_wchar   *wmask;
-		char	   *tmask;
-
 		Affix->issimple = 0;
 		Affix->isregis = 0;
-		tmask = (char *) tmpalloc(strlen(mask) + 3);
-		if (type == FF_SUFFIX)
-			sprintf(tmask, "%s$", mask);
-		else
-			sprintf(tmask, "^%s", mask);
-
-		masklen = strlen(tmask);
-		wmask = (pg_wchar *) tmpalloc((masklen + 1) * sizeof(pg_wchar));
-		wmasklen = pg_mb2wchar_with_len(tmask, wmask, masklen);
-
-		/*
-		 * The regex and all internal state created by pg_regcomp are
-		 * allocated in the dictionary's memory context, and will be freed
-		 * automatically when it is destroyed.
-		 */
-		Affix->reg.pregex = palloc(sizeof(regex_t));
-		err = pg_regcomp(Affix->reg.pregex, wmask, wmasklen,
-						 REG_ADVANCED | REG_NOSUB,
-						 DEFAULT_COLLATION_OID);
-		if (err)
-		{
-			char		errstr[100];
-
-			pg_regerror(err, Affix->reg.pregex, errstr, sizeof(errstr));
-			ereport(ERROR,
-					(errcode(ERRCODE_INVALID_REGULAR_EXPRESSION),
-					 errmsg("invalid regular expression: %s", errstr)));
-		}
+		Affix->reg.regex.pregex = compileAffixRegex(mask, type);
+		Affix->reg.regex.mask = cpstrdup(Conf, mask);
 	}
 
 	Affix->flagflags = flagflags;
@@ -2073,7 +2088,8 @@ FindAffixes(AffixNode *node, const char *word, int wrdlen, int *level, int type)
 }
 
 static char *
-CheckAffix(const char *word, size_t len, AFFIX *Affix, int flagflags, char *newword, int *baselen)
+CheckAffix(IspellDict *Conf, const char *word, size_t len, AFFIX *Affix,
+		   int flagflags, char *newword, int *baselen)
 {
 	/*
 	 * Check compound allow flags
@@ -2141,16 +2157,21 @@ CheckAffix(const char *word, size_t len, AFFIX *Affix, int flagflags, char *neww
 	}
 	else
 	{
+		regex_t    *regex = Affix->reg.regex.pregex;
 		pg_wchar   *data;
 		size_t		data_len;
 		int			newword_len;
 
+		/* a shared dictionary's regexes are compiled by each backend */
+		if (regex == NULL)
+			regex = Conf->AffixRegex[Affix - Conf->Affix];
+
 		/* Convert data string to wide characters */
 		newword_len = strlen(newword);
 		data = (pg_wchar *) palloc((newword_len + 1) * sizeof(pg_wchar));
 		data_len = pg_mb2wchar_with_len(newword, data, newword_len);
 
-		if (pg_regexec(Affix->reg.pregex, data, data_len,
+		if (pg_regexec(regex, data, data_len,
 					   0, NULL, 0, NULL, 0) == REG_OKAY)
 		{
 			pfree(data);
@@ -2219,7 +2240,7 @@ NormalizeSubWord(IspellDict *Conf, const char *word, int flag)
 			break;
 		for (j = 0; j < prefix->naff; j++)
 		{
-			if (CheckAffix(word, wrdlen, prefix->aff[j], flag, newword, NULL))
+			if (CheckAffix(Conf, word, wrdlen, prefix->aff[j], flag, newword, NULL))
 			{
 				/* prefix success */
 				if (FindWord(Conf, newword, prefix->aff[j]->flag, flag))
@@ -2244,7 +2265,7 @@ NormalizeSubWord(IspellDict *Conf, const char *word, int flag)
 		/* foreach suffix check affix */
 		for (i = 0; i < suffix->naff; i++)
 		{
-			if (CheckAffix(word, wrdlen, suffix->aff[i], flag, newword, &baselen))
+			if (CheckAffix(Conf, word, wrdlen, suffix->aff[i], flag, newword, &baselen))
 			{
 				/* suffix success */
 				if (FindWord(Conf, newword, suffix->aff[i]->flag, flag))
@@ -2261,7 +2282,7 @@ NormalizeSubWord(IspellDict *Conf, const char *word, int flag)
 						break;
 					for (j = 0; j < prefix->naff; j++)
 					{
-						if (CheckAffix(newword, swrdlen, prefix->aff[j], flag, pnewword, &baselen))
+						if (CheckAffix(Conf, newword, swrdlen, prefix->aff[j], flag, pnewword, &baselen))
 						{
 							/* prefix success */
 							const char *ff = (prefix->aff[j]->flagflags & suffix->aff[i]->flagflags & FF_CROSSPRODUCT) ?
@@ -2609,3 +2630,177 @@ NINormalizeWord(IspellDict *Conf, const char *word)
 
 	return lres;
 }
+
+/*
+ * Copying a dictionary into shared memory.
+ *
+ * The finished dictionary is copied into the arena with all the pointers
+ * adjusted, except that regexes can't be copied: only their masks are, and
+ * NIAttachShared compiles them again in each backend using the copy.
+ */
+
+static SPNode *
+copySPNode(SPNode *node, SharedTSDictArena *arena)
+{
+	SPNode	   *res;
+	Size		size;
+
+	check_stack_depth();
+
+	if (node == NULL)
+		return NULL;
+
+	size = SPNHDRSZ + node->length * sizeof(SPNodeData);
+	res = (SPNode *) SharedTSDictAlloc(arena, size);
+	memcpy(res, node, size);
+
+	for (uint32 i = 0; i < node->length; i++)
+		res->data[i].node = copySPNode(node->data[i].node, arena);
+
+	return res;
+}
+
+static AffixNode *
+copyAffixNode(const IspellDict *src, AFFIX *Affix, AffixNode *node,
+			  SharedTSDictArena *arena)
+{
+	AffixNode  *res;
+	Size		size;
+
+	check_stack_depth();
+
+	if (node == NULL)
+		return NULL;
+
+	size = ANHRDSZ + node->length * sizeof(AffixNodeData);
+	res = (AffixNode *) SharedTSDictAlloc(arena, size);
+	memcpy(res, node, size);
+
+	for (uint32 i = 0; i < node->length; i++)
+	{
+		AffixNodeData *data = &res->data[i];
+
+		if (data->naff > 0)
+		{
+			/* point to the copies of the affixes */
+			data->aff = (AFFIX **) SharedTSDictAlloc(arena,
+													 sizeof(AFFIX *) * data->naff);
+			for (uint32 j = 0; j < data->naff; j++)
+				data->aff[j] = Affix + (node->data[i].aff[j] - src->Affix);
+		}
+		data->node = copyAffixNode(src, Affix, node->data[i].node, arena);
+	}
+
+	return res;
+}
+
+static void
+copyAffix(AFFIX *dst, const AFFIX *src, SharedTSDictArena *arena)
+{
+	*dst = *src;
+	dst->flag = SharedTSDictStrdup(arena, src->flag);
+	dst->find = SharedTSDictStrdup(arena, src->find);
+	dst->repl = SharedTSDictStrdup(arena, src->repl);
+
+	if (src->issimple)
+		return;
+	else if (src->isregis)
+	{
+		RegisNode  *node;
+		RegisNode **link = &dst->reg.regis.node;
+
+		for (node = src->reg.regis.node; node; node = node->next)
+		{
+			RegisNode  *copy;
+
+			copy = (RegisNode *) SharedTSDictAlloc(arena,
+												   RNHDRSZ + node->len + 1);
+			memcpy(copy, node, RNHDRSZ + node->len);
+			copy->next = NULL;
+			*link = copy;
+			link = &copy->next;
+		}
+	}
+	else
+	{
+		dst->reg.regex.pregex = NULL;
+		dst->reg.regex.mask = SharedTSDictStrdup(arena, src->reg.regex.mask);
+	}
+}
+
+/*
+ * Copy the finished dictionary "src" into the arena, filling in "dst".
+ */
+void
+NICopyShared(IspellDict *dst, const IspellDict *src, SharedTSDictArena *arena)
+{
+	int			ncmpd;
+
+	Assert(src->buildCxt == NULL);
+
+	*dst = *src;
+
+	dst->Affix = (AFFIX *) SharedTSDictAlloc(arena,
+											 sizeof(AFFIX) * Max(src->naffixes, 1));
+	dst->maffixes = src->naffixes;
+	for (int i = 0; i < src->naffixes; i++)
+		copyAffix(&dst->Affix[i], &src->Affix[i], arena);
+	dst->AffixRegex = NULL;
+
+	dst->Suffix = copyAffixNode(src, dst->Affix, src->Suffix, arena);
+	dst->Prefix = copyAffixNode(src, dst->Affix, src->Prefix, arena);
+	dst->Dictionary = copySPNode(src->Dictionary, arena);
+
+	dst->AffixData = (const char **)
+		SharedTSDictAlloc(arena, sizeof(char *) * (src->nAffixData + 1));
+	dst->lenAffixData = src->nAffixData + 1;
+	for (int i = 0; i < src->nAffixData; i++)
+	{
+		if (src->AffixData[i])
+			dst->AffixData[i] = SharedTSDictStrdup(arena, src->AffixData[i]);
+	}
+
+	if (src->CompoundAffix)
+	{
+		for (ncmpd = 0; src->CompoundAffix[ncmpd].affix; ncmpd++)
+			;
+		dst->CompoundAffix = (CMPDAffix *)
+			SharedTSDictAlloc(arena, sizeof(CMPDAffix) * (ncmpd + 1));
+		for (int i = 0; i < ncmpd; i++)
+		{
+			dst->CompoundAffix[i] = src->CompoundAffix[i];
+			dst->CompoundAffix[i].affix =
+				SharedTSDictStrdup(arena, src->CompoundAffix[i].affix);
+		}
+		dst->CompoundAffix[ncmpd].affix = NULL;
+	}
+
+	/* construction-only fields have been reset by NIFinishBuild */
+	dst->CompoundAffixFlags = NULL;
+	dst->nCompoundAffixFlag = 0;
+	dst->mCompoundAffixFlag = 0;
+}
+
+/*
+ * Prepare a private copy of the IspellDict struct of a dictionary in shared
+ * memory for use by this backend, by compiling the regexes of its affixes.
+ */
+void
+NIAttachShared(IspellDict *Conf)
+{
+	Conf->AffixRegex = NULL;
+
+	for (int i = 0; i < Conf->naffixes; i++)
+	{
+		AFFIX	   *Affix = &Conf->Affix[i];
+
+		if (Affix->issimple || Affix->isregis)
+			continue;
+
+		if (Conf->AffixRegex == NULL)
+			Conf->AffixRegex = (regex_t **)
+				palloc0(sizeof(regex_t *) * Conf->naffixes);
+		Conf->AffixRegex[i] = compileAffixRegex(Affix->reg.regex.mask,
+												Affix->type);
+	}
+}
@@ -1189,6 +1189,51 @@ pgstat_get_backend_type_by_proc_number(ProcNumber procNumber)
 	return status->st_backendType;
 }
 
+/* ----------
+ * pgstat_read_backend_status() -
+ *
+ *	Copy the fixed-size part of one backend's entry, without the strings its
+ *	pointer fields refer to.  This is much cheaper than taking a local
+ *	snapshot of the whole array, for callers that must look at every
+ *	backend frequently, such as the active session history sampler.
+ *
+ *	Returns false if the slot is not in use.
+ * ----------
+ */
+bool
+pgstat_read_backend_status(ProcNumber procNumber, PgBackendStatus *result)
+{
+	volatile PgBackendStatus *beentry;
+
+	if (procNumber < 0 || procNumber >= NumBackendStatSlots)
+		return false;
+
+	beentry = &BackendStatusArray[procNumber];
+	for (;;)
+	{
+		int			before_changecount;
+		int			after_changecount;
+
+		pgstat_begin_read_activity(beentry, before_changecount);
+
+		result->st_procpid = beentry->st_procpid;
+		if (result->st_procpid > 0)
+			memcpy(result, unvolatize(PgBackendStatus *, beentry),
+				   sizeof(PgBackendStatus));
+
+		pgstat_end_read_activity(beentry, after_changecount);
+
+		if (pgstat_read_activity_complete(before_changecount,
+										  after_changecount))
+			break;
+
+		/* Make sure we can break out of loop if stuck... */
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	return result->st_procpid > 0;
+}
+
 /* ----------
  * cmp_lbestatus
  *
@@ -372,6 +372,40 @@ jsonb_put_escaped_value(StringInfo out, JsonbValue *scalarVal)
 	}
 }
 
+/*
+ * Most numbers in JSON documents are small integers.  Converting those
+ * directly is much cheaper than going through numeric_in, and gives the same
+ * result.  The lexer has already checked the token's syntax, so it's an
+ * integer if it has nothing but digits after an optional minus sign; we
+ * accept up to 18 digits so that the value can't overflow.
+ */
+static inline bool
+jsonb_in_integer(const char *token, int64 *result)
+{
+	const char *p = token;
+	bool		neg = false;
+	int64		val = 0;
+
+	if (*p == '-')
+	{
+		neg = true;
+		p++;
+	}
+
+	for (; *p >= '0' && *p <= '9'; p++)
+	{
+		if (p - token >= 18 + neg)
+			return false;
+		val = val * 10 + (*p - '0');
+	}
+
+	if (*p != '\0')
+		return false;
+
+	*result = neg ? -val : val;
+	return true;
+}
+
 /*
  * For jsonb we always want the de-escaped value - that's what's in token
  */
@@ -381,6 +415,7 @@ jsonb_in_scalar(void *pstate, char *token, JsonTokenType tokentype)
 	JsonbInState *_state = (JsonbInState *) pstate;
 	JsonbValue	v;
 	Datum		numd;
+	int64		intval;
 
 	switch (tokentype)
 	{
@@ -401,6 +436,11 @@ jsonb_in_scalar(void *pstate, char *token, JsonTokenType tokentype)
 			 */
 			Assert(token != NULL);
 			v.type = jbvNumeric;
+			if (jsonb_in_integer(token, &intval))
+			{
+				v.val.numeric = int64_to_numeric(intval);
+				break;
+			}
 			if (!DirectInputFunctionCallSafe(numeric_in, token,
 											 InvalidOid, -1,
 											 _state->escontext,
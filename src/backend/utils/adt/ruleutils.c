@@ -435,6 +435,7 @@ static void get_delete_query_def(Query *query, deparse_context *context);
 static void get_merge_query_def(Query *query, deparse_context *context);
 static void get_utility_query_def(Query *query, deparse_context *context);
 static void get_basic_select_query(Query *query, deparse_context *context);
+static void get_hints_def(Query *query, deparse_context *context);
 static void get_target_list(List *targetList, deparse_context *context);
 static void get_returning_clause(Query *query, deparse_context *context);
 static void get_setop_query(Node *setOp, Query *query,
@@ -6602,7 +6603,10 @@ get_basic_select_query(Query *query, deparse_context *context)
 	if (query->isReturn)
 		appendStringInfoString(buf, "RETURN");
 	else
+	{
 		appendStringInfoString(buf, "SELECT");
+		get_hints_def(query, context);
+	}
 
 	/* Add the DISTINCT clause if given */
 	if (query->distinctClause != NIL)
@@ -6695,6 +6699,21 @@ get_basic_select_query(Query *query, deparse_context *context)
 		get_rule_windowclause(query, context);
 }
 
+/* ----------
+ * get_hints_def			- Parse back an optimizer hint comment
+ *
+ * The hint text is reproduced verbatim right after the statement keyword.
+ * ----------
+ */
+static void
+get_hints_def(Query *query, deparse_context *context)
+{
+	if (query->hints == NULL)
+		return;
+
+	appendStringInfo(context->buf, " /*+%s*/", query->hints);
+}
+
 /* ----------
  * get_target_list			- Parse back a SELECT target list
  *
@@ -7451,7 +7470,9 @@ get_insert_query_def(Query *query, deparse_context *context)
 		context->indentLevel += PRETTYINDENT_STD;
 		appendStringInfoChar(buf, ' ');
 	}
-	appendStringInfo(buf, "INSERT INTO %s",
+	appendStringInfoString(buf, "INSERT");
+	get_hints_def(query, context);
+	appendStringInfo(buf, " INTO %s",
 					 generate_relation_name(rte->relid, NIL));
 
 	/* Print the relation alias, if needed; INSERT requires explicit AS */
@@ -7632,7 +7653,9 @@ get_update_query_def(Query *query, deparse_context *context)
 		appendStringInfoChar(buf, ' ');
 		context->indentLevel += PRETTYINDENT_STD;
 	}
-	appendStringInfo(buf, "UPDATE %s%s",
+	appendStringInfoString(buf, "UPDATE");
+	get_hints_def(query, context);
+	appendStringInfo(buf, " %s%s",
 					 only_marker(rte),
 					 generate_relation_name(rte->relid, NIL));
 
@@ -7836,7 +7859,9 @@ get_delete_query_def(Query *query, deparse_context *context)
 		appendStringInfoChar(buf, ' ');
 		context->indentLevel += PRETTYINDENT_STD;
 	}
-	appendStringInfo(buf, "DELETE FROM %s%s",
+	appendStringInfoString(buf, "DELETE");
+	get_hints_def(query, context);
+	appendStringInfo(buf, " FROM %s%s",
 					 only_marker(rte),
 					 generate_relation_name(rte->relid, NIL));
 
@@ -7885,7 +7910,9 @@ get_merge_query_def(Query *query, deparse_context *context)
 		appendStringInfoChar(buf, ' ');
 		context->indentLevel += PRETTYINDENT_STD;
 	}
-	appendStringInfo(buf, "MERGE INTO %s%s",
+	appendStringInfoString(buf, "MERGE");
+	get_hints_def(query, context);
+	appendStringInfo(buf, " INTO %s%s",
 					 only_marker(rte),
 					 generate_relation_name(rte->relid, NIL));
 
@@ -9337,6 +9364,7 @@ isSimpleNode(Node *node, Node *parentNode, int prettyFlags)
 		case T_SQLValueFunction:
 		case T_XmlExpr:
 		case T_NextValueExpr:
+		case T_RownumExpr:
 		case T_NullIfExpr:
 		case T_Aggref:
 		case T_GroupingFunc:
@@ -10837,6 +10865,10 @@ get_rule_expr(Node *node, deparse_context *context,
 			}
 			break;
 
+		case T_RownumExpr:
+			appendStringInfoString(buf, "ROWNUM");
+			break;
+
 		case T_InferenceElem:
 			{
 				InferenceElem *iexpr = (InferenceElem *) node;
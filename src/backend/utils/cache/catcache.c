@@ -19,6 +19,7 @@
 #include "access/relscan.h"
 #include "access/table.h"
 #include "access/xact.h"
+#include "access/xlog.h"
 #include "catalog/catalog.h"
 #include "catalog/pg_collation.h"
 #include "catalog/pg_type.h"
@@ -26,9 +27,7 @@
 #include "common/pg_prng.h"
 #include "miscadmin.h"
 #include "port/pg_bitutils.h"
-#ifdef CATCACHE_STATS
-#include "storage/ipc.h"		/* for on_proc_exit */
-#endif
+#include "storage/ipc.h"
 #include "storage/lmgr.h"
 #include "utils/builtins.h"
 #include "utils/catcache.h"
@@ -39,6 +38,8 @@
 #include "utils/memutils.h"
 #include "utils/rel.h"
 #include "utils/resowner.h"
+#include "utils/sharedcatcache.h"
+#include "utils/snapmgr.h"
 #include "utils/syscache.h"
 
 /*
@@ -114,6 +115,15 @@ static void CatalogCacheInitializeCache(CatCache *cache);
 static CatCTup *CatalogCacheCreateEntry(CatCache *cache, HeapTuple ntp,
 										Datum *arguments,
 										uint32 hashValue, Index hashIndex);
+static bool CatCacheUseShared(CatCache *cache);
+static bool CatCacheSharedMatch(HeapTuple tuple, void *arg);
+static CatCTup *CatalogCacheCreateSharedEntry(CatCache *cache, Oid dbId,
+											  Datum *arguments,
+											  uint32 hashValue,
+											  Index hashIndex);
+static void CatalogCachePublishEntry(CatCache *cache, CatCTup *ct, Oid dbId,
+									 Datum *arguments, uint64 generation);
+static void CatCacheReleaseSharedRefs(int code, Datum arg);
 
 static void ReleaseCatCacheWithOwner(HeapTuple tuple, ResourceOwner resowner);
 static void ReleaseCatCacheListWithOwner(CatCList *list, ResourceOwner resowner);
@@ -553,6 +563,9 @@ CatCacheRemoveCTup(CatCache *cache, CatCTup *ct)
 		CatCacheFreeKeys(cache->cc_tupdesc, cache->cc_nkeys,
 						 cache->cc_keyno, ct->keys);
 
+	if (ct->shared_ref)
+		SharedCatCacheRelease(ct->shared_ref);
+
 	pfree(ct);
 
 	--cache->cc_ntup;
@@ -1512,6 +1525,9 @@ SearchCatCacheMiss(CatCache *cache,
 	CatCTup    *ct;
 	bool		stale;
 	Datum		arguments[CATCACHE_MAXKEYS];
+	bool		use_shared;
+	Oid			dbId = InvalidOid;
+	uint64		generation = 0;
 
 	/* Initialize local parameter array */
 	arguments[0] = v1;
@@ -1519,6 +1535,33 @@ SearchCatCacheMiss(CatCache *cache,
 	arguments[2] = v3;
 	arguments[3] = v4;
 
+	/*
+	 * Before reading the catalog, see if another backend has already
+	 * published the tuple in the shared catalog cache.  The generation has
+	 * to be read first, so that we notice if what we read from the catalog
+	 * is invalidated before we get to publish it.
+	 */
+	use_shared = CatCacheUseShared(cache);
+	if (use_shared)
+	{
+		dbId = cache->cc_relisshared ? InvalidOid : MyDatabaseId;
+		generation = SharedCatCacheGeneration(hashValue);
+
+		ct = CatalogCacheCreateSharedEntry(cache, dbId, arguments,
+										   hashValue, hashIndex);
+		if (ct != NULL)
+		{
+			ResourceOwnerEnlarge(CurrentResourceOwner);
+			ct->refcount++;
+			ResourceOwnerRememberCatCacheRef(CurrentResourceOwner, &ct->tuple);
+
+			CACHE_elog(DEBUG2, "SearchCatCache(%s): found in shared cache",
+					   cache->cc_relname);
+
+			return &ct->tuple;
+		}
+	}
+
 	/*
 	 * Tuple was not found in cache, so we have to try to retrieve it directly
 	 * from the relation.  If found, we will add it to the cache; if not
@@ -1584,6 +1627,9 @@ SearchCatCacheMiss(CatCache *cache,
 		systable_endscan(scandesc);
 	} while (stale);
 
+	if (ct != NULL && use_shared)
+		CatalogCachePublishEntry(cache, ct, dbId, arguments, generation);
+
 	table_close(relation, AccessShareLock);
 
 	/*
@@ -1632,6 +1678,179 @@ SearchCatCacheMiss(CatCache *cache,
 	return &ct->tuple;
 }
 
+/*
+ * Can SearchCatCacheMiss use the shared catalog cache?
+ *
+ * Only committed catalog state is kept there, so a backend that might have
+ * modified the catalogs in its current transaction, or one reading them as
+ * of the past for logical decoding, must bypass it.  So must a standby,
+ * whose catalogs change by WAL replay.
+ */
+static bool
+CatCacheUseShared(CatCache *cache)
+{
+	if (!SharedCatCacheEnabled() || !IsUnderPostmaster ||
+		IsBootstrapProcessingMode() || RecoveryInProgress())
+		return false;
+	if (HistoricSnapshotActive() ||
+		TransactionIdIsValid(GetTopTransactionIdIfAny()))
+		return false;
+	if (!cache->cc_relisshared && !OidIsValid(MyDatabaseId))
+		return false;
+	return true;
+}
+
+typedef struct CatCacheSharedMatchArg
+{
+	CatCache   *cache;
+	Datum	   *arguments;
+} CatCacheSharedMatchArg;
+
+/* SharedCatCacheMatchFn comparing a shared tuple's keys to search keys */
+static bool
+CatCacheSharedMatch(HeapTuple tuple, void *arg)
+{
+	CatCacheSharedMatchArg *marg = (CatCacheSharedMatchArg *) arg;
+	CatCache   *cache = marg->cache;
+	Datum		keys[CATCACHE_MAXKEYS];
+
+	for (int i = 0; i < cache->cc_nkeys; i++)
+	{
+		bool		isnull;
+
+		keys[i] = heap_getattr(tuple, cache->cc_keyno[i],
+							   cache->cc_tupdesc, &isnull);
+		Assert(!isnull);
+	}
+
+	return CatalogCacheCompareTuple(cache, cache->cc_nkeys, keys,
+									marg->arguments);
+}
+
+/*
+ * CatalogCacheCreateSharedEntry
+ *		Create a cache entry for a tuple found in the shared catalog cache.
+ *
+ * The entry's tuple points into shared memory, which stays valid until the
+ * entry is removed.  Returns NULL if the shared cache has no such tuple.
+ */
+static CatCTup *
+CatalogCacheCreateSharedEntry(CatCache *cache, Oid dbId, Datum *arguments,
+							  uint32 hashValue, Index hashIndex)
+{
+	CatCacheSharedMatchArg marg;
+	CatCTup    *ct;
+	static bool release_registered = false;
+
+	/* allocate first, so that we can't fail while holding a shared ref */
+	ct = (CatCTup *) MemoryContextAlloc(CacheMemoryContext, sizeof(CatCTup));
+
+	if (!release_registered)
+	{
+		before_shmem_exit(CatCacheReleaseSharedRefs, (Datum) 0);
+		release_registered = true;
+	}
+
+	marg.cache = cache;
+	marg.arguments = arguments;
+	ct->shared_ref = SharedCatCacheLookup(cache->id, dbId, hashValue,
+										  CatCacheSharedMatch, &marg,
+										  &ct->tuple);
+	if (ct->shared_ref == NULL)
+	{
+		pfree(ct);
+		return NULL;
+	}
+
+	/* extract keys - they'll point into the shared tuple if not by-value */
+	for (int i = 0; i < cache->cc_nkeys; i++)
+	{
+		bool		isnull;
+
+		ct->keys[i] = heap_getattr(&ct->tuple, cache->cc_keyno[i],
+								   cache->cc_tupdesc, &isnull);
+		Assert(!isnull);
+	}
+
+	ct->ct_magic = CT_MAGIC;
+	ct->my_cache = cache;
+	ct->c_list = NULL;
+	ct->refcount = 0;
+	ct->dead = false;
+	ct->negative = false;
+	ct->hash_value = hashValue;
+
+	dlist_push_head(&cache->cc_bucket[hashIndex], &ct->cache_elem);
+
+	cache->cc_ntup++;
+	CacheHdr->ch_ntup++;
+
+	if (cache->cc_ntup > cache->cc_nbuckets * 2)
+		RehashCatCache(cache);
+
+	return ct;
+}
+
+/*
+ * CatalogCachePublishEntry
+ *		Offer a tuple just read from the catalog to the shared catalog cache.
+ *
+ * Tuples with an updater or deleter other than a mere locker are left out:
+ * once that transaction commits, other backends must not find them.
+ */
+static void
+CatalogCachePublishEntry(CatCache *cache, CatCTup *ct, Oid dbId,
+						 Datum *arguments, uint64 generation)
+{
+	HeapTupleHeader tup = ct->tuple.t_data;
+	CatCacheSharedMatchArg marg;
+
+	if (ct->dead)
+		return;
+	if (TransactionIdIsValid(HeapTupleHeaderGetRawXmax(tup)) &&
+		!(tup->t_infomask & HEAP_XMAX_INVALID) &&
+		!HEAP_XMAX_IS_LOCKED_ONLY(tup->t_infomask))
+		return;
+
+	marg.cache = cache;
+	marg.arguments = arguments;
+	SharedCatCacheInsert(cache->id, cache->cc_reloid, dbId, ct->hash_value,
+						 &ct->tuple, CatCacheSharedMatch, &marg, generation);
+}
+
+/*
+ * Drop all references into the shared catalog cache at backend exit
+ */
+static void
+CatCacheReleaseSharedRefs(int code, Datum arg)
+{
+	slist_iter	iter;
+
+	if (CacheHdr == NULL)
+		return;
+
+	slist_foreach(iter, &CacheHdr->ch_caches)
+	{
+		CatCache   *cache = slist_container(CatCache, cc_next, iter.cur);
+
+		for (int i = 0; i < cache->cc_nbuckets; i++)
+		{
+			dlist_iter	citer;
+
+			dlist_foreach(citer, &cache->cc_bucket[i])
+			{
+				CatCTup    *ct = dlist_container(CatCTup, cache_elem, citer.cur);
+
+				if (ct->shared_ref)
+				{
+					SharedCatCacheRelease(ct->shared_ref);
+					ct->shared_ref = NULL;
+				}
+			}
+		}
+	}
+}
+
 /*
  *	ReleaseCatCache
  *
@@ -2254,6 +2473,7 @@ CatalogCacheCreateEntry(CatCache *cache, HeapTuple ntp, Datum *arguments,
 	ct->ct_magic = CT_MAGIC;
 	ct->my_cache = cache;
 	ct->c_list = NULL;
+	ct->shared_ref = NULL;
 	ct->refcount = 0;			/* for the moment */
 	ct->dead = false;
 	ct->negative = (ntp == NULL);
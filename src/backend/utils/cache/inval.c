@@ -130,6 +130,8 @@
 #include "utils/memutils.h"
 #include "utils/rel.h"
 #include "utils/relmapper.h"
+#include "utils/sharedcatcache.h"
+#include "utils/sharedplancache.h"
 #include "utils/snapmgr.h"
 #include "utils/syscache.h"
 
@@ -1123,6 +1125,22 @@ inplaceGetInvalidationMessages(SharedInvalidationMessage **msgs,
 	return nmsgs;
 }
 
+/*
+ * SendCommittedInvalidMessages
+ *		Send out the messages of a committed transaction or inplace update.
+ *
+ * Tuples and plans they make stale are removed from the shared catalog and
+ * plan caches first, so that no backend can pick them up after processing
+ * the messages.
+ */
+static void
+SendCommittedInvalidMessages(const SharedInvalidationMessage *msgs, int n)
+{
+	SharedCatCacheInvalidate(msgs, n);
+	SharedPlanCacheInvalidate(msgs, n);
+	SendSharedInvalidMessages(msgs, n);
+}
+
 /*
  * ProcessCommittedInvalidationMessages is executed by xact_redo_commit() or
  * standby_redo() to process invalidation messages. Currently that happens
@@ -1165,12 +1183,36 @@ ProcessCommittedInvalidationMessages(SharedInvalidationMessage *msgs,
 		}
 	}
 
+	/*
+	 * Nothing is published in the shared catalog cache during recovery, but
+	 * hot standby sessions may share plans.
+	 */
+	SharedPlanCachePrepareInvalidate();
+	SharedPlanCacheInvalidate(msgs, nmsgs);
 	SendSharedInvalidMessages(msgs, nmsgs);
 
 	if (RelcacheInitFileInval)
 		RelationCacheInitFilePostInvalidate();
 }
 
+/*
+ * PreCommit_Inval
+ *		Get ready to send the invalidation messages of the transaction.
+ *
+ * AtEOXact_Inval runs once the transaction has committed, where failing is
+ * no longer an option, so whatever can fail is done here instead.  Currently
+ * this just attaches to the shared catalog and plan caches.
+ */
+void
+PreCommit_Inval(void)
+{
+	if (transInvalInfo != NULL)
+	{
+		SharedCatCachePrepareInvalidate();
+		SharedPlanCachePrepareInvalidate();
+	}
+}
+
 /*
  * AtEOXact_Inval
  *		Process queued-up invalidation messages at end of main transaction.
@@ -1223,7 +1265,7 @@ AtEOXact_Inval(bool isCommit)
 								   &transInvalInfo->ii.CurrentCmdInvalidMsgs);
 
 		ProcessInvalidationMessagesMulti(&transInvalInfo->PriorCmdInvalidMsgs,
-										 SendSharedInvalidMessages);
+										 SendCommittedInvalidMessages);
 
 		if (transInvalInfo->ii.RelcacheInitFileInval)
 			RelationCacheInitFilePostInvalidate();
@@ -1253,6 +1295,10 @@ PreInplace_Inval(void)
 
 	if (inplaceInvalInfo && inplaceInvalInfo->RelcacheInitFileInval)
 		RelationCacheInitFilePreInvalidate();
+
+	/* AtInplace_Inval can't attach to the shared catalog and plan caches */
+	SharedCatCachePrepareInvalidate();
+	SharedPlanCachePrepareInvalidate();
 }
 
 /*
@@ -1268,7 +1314,7 @@ AtInplace_Inval(void)
 		return;
 
 	ProcessInvalidationMessagesMulti(&inplaceInvalInfo->CurrentCmdInvalidMsgs,
-									 SendSharedInvalidMessages);
+									 SendCommittedInvalidMessages);
 
 	if (inplaceInvalInfo->RelcacheInitFileInval)
 		RelationCacheInitFilePostInvalidate();
@@ -53,14 +53,57 @@
 #include "commands/packagecmds.h"
 #include "commands/extension.h"
 #include "parser/parse_func.h"
+#include "portability/instr_time.h"
+#include "utils/timestamp.h"
 
 
 static HTAB *PackageCache = NULL;
 MemoryContext PackageCacheContext = NULL;
 
+/*
+ * Index of the cached packages by catcache hash value, so that an
+ * invalidation message finds the packages it concerns without looking at
+ * every other one.  Hash values may collide, so each entry keeps a list.
+ */
+typedef struct PackageHashIndexKey
+{
+	int			cacheid;		/* PKGOID or PKGBODYOID */
+	uint32		hashvalue;
+} PackageHashIndexKey;
+
+typedef struct PackageHashIndexEntry
+{
+	PackageHashIndexKey key;
+	List	   *pkeys;			/* list of PackageCacheKey (Oid) */
+} PackageHashIndexEntry;
+
+static HTAB *PackageHashIndex = NULL;
+
+/*
+ * Per-package invalidation and compile statistics of this session.  They
+ * are kept apart from the cache items, which are thrown away on every
+ * recompile.
+ */
+typedef struct PackageCacheStatsEntry
+{
+	Oid			pkgoid;
+	int64		invalidations;
+	int64		compiles;
+	double		compile_time;	/* in msec */
+	TimestampTz last_invalidation;
+} PackageCacheStatsEntry;
+
+static HTAB *PackageCacheStats = NULL;
+
 static void BuildPackageCache(void);
 static void InvalidatePackageCacheCallback(Datum arg,
 						  int cacheid, uint32 hashvalue);
+static void PackageHashIndexAdd(int cacheid, uint32 hashvalue,
+								PackageCacheKey pkey);
+static void PackageHashIndexRemove(int cacheid, uint32 hashvalue,
+								   PackageCacheKey pkey);
+static bool PackageSetUpdateFlag(PackageCacheItem *item, bool is_body);
+static PackageCacheStatsEntry *PackageCacheStatsGet(Oid pkgoid);
 static Oid get_plisql_validator(void);
 
 
@@ -186,6 +229,11 @@ PackageCacheDelete(PackageCacheKey *key)
 	 if (entry != NULL)
 	 {
 		 elog(DEBUG1, "PackCache Delete %u", entry->item->pkey);
+		 PackageHashIndexRemove(PKGOID, entry->item->package_hash_value,
+								entry->item->pkey);
+		 if (entry->item->body_hash_value != 0)
+			 PackageHashIndexRemove(PKGBODYOID, entry->item->body_hash_value,
+									entry->item->pkey);
 		 setPlanCacheInvalidForPackage(*key);
 		 return entry->item;
 	 }
@@ -219,10 +267,75 @@ PackageCacheInsert(PackageCacheKey *key, PackageCacheItem *item)
 	entry->key = *key;
 	item->intable = true;
 
+	PackageHashIndexAdd(PKGOID, item->package_hash_value, item->pkey);
+	if (item->body_hash_value != 0)
+		PackageHashIndexAdd(PKGBODYOID, item->body_hash_value, item->pkey);
+
 	return;
 }
 
 
+/*
+ * Remember the package body a cached package has been compiled with.
+ *
+ * The body is compiled into an item that may already be in the cache, so
+ * keep the hash value index in step.
+ */
+void
+PackageCacheSetBodyHash(PackageCacheItem *item, Oid bodyoid)
+{
+	PackageCacheEntry *entry = NULL;
+	bool		indexed;
+
+	if (PackageCache != NULL)
+		entry = hash_search(PackageCache, &item->pkey, HASH_FIND, NULL);
+	indexed = (entry != NULL && entry->item == item);
+
+	if (indexed && item->body_hash_value != 0)
+		PackageHashIndexRemove(PKGBODYOID, item->body_hash_value, item->pkey);
+
+	item->body_hash_value = GetSysCacheHashValue1(PKGBODYOID,
+												  ObjectIdGetDatum(bodyoid));
+
+	if (indexed)
+		PackageHashIndexAdd(PKGBODYOID, item->body_hash_value, item->pkey);
+}
+
+
+/*
+ * Mark a cached package as needing a recompile of its specification or of
+ * its body, because an object it depends on has changed.
+ *
+ * A package that isn't cached needs nothing: it will be compiled against
+ * the current catalogs when it is next used.
+ */
+void
+PackageCacheMarkUpdated(Oid pkgoid, bool is_body)
+{
+	PackageCacheItem *item;
+
+	if (PackageCache == NULL)
+		return;
+
+	item = PackageCacheLookup(&pkgoid);
+	if (item != NULL)
+		PackageSetUpdateFlag(item, is_body);
+}
+
+
+/*
+ * Account for a (re)compile of a package's specification or body.
+ */
+void
+PackageCacheReportCompile(Oid pkgoid, double elapsed_ms)
+{
+	PackageCacheStatsEntry *stats = PackageCacheStatsGet(pkgoid);
+
+	stats->compiles++;
+	stats->compile_time += elapsed_ms;
+}
+
+
 /*
 * release all package cache in this session
 *
@@ -235,6 +348,7 @@ ResetPackageCaches(void)
 {
 	HASH_SEQ_STATUS status;
 	PackageCacheEntry *entry;
+	PackageHashIndexEntry *ientry;
 	List *pkglist = NIL;
 
 	if (PackageCache == NULL)
@@ -249,6 +363,14 @@ ResetPackageCaches(void)
 		/* Now we can remove the hash table entry */
 		hash_search(PackageCache, (void *) &entry->key, HASH_REMOVE, NULL);
 	}
+
+	/* nothing is left to index */
+	hash_seq_init(&status, PackageHashIndex);
+	while ((ientry = (PackageHashIndexEntry *) hash_seq_search(&status)) != NULL)
+	{
+		list_free(ientry->pkeys);
+		hash_search(PackageHashIndex, (void *) &ientry->key, HASH_REMOVE, NULL);
+	}
 	plisql_internel_funcs_init();
 	plisql_internal_funcs.package_free_list(pkglist);
 
@@ -293,6 +415,20 @@ BuildPackageCache(void)
 	ctl.hcxt = PackageCacheContext;
 	cache = hash_create("Package Cache", 32, &ctl,
 					 HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+	MemSet(&ctl, 0, sizeof(ctl));
+	ctl.keysize = sizeof(PackageHashIndexKey);
+	ctl.entrysize = sizeof(PackageHashIndexEntry);
+	ctl.hcxt = PackageCacheContext;
+	PackageHashIndex = hash_create("Package Cache Hash Index", 64, &ctl,
+								   HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+	MemSet(&ctl, 0, sizeof(ctl));
+	ctl.keysize = sizeof(Oid);
+	ctl.entrysize = sizeof(PackageCacheStatsEntry);
+	ctl.hcxt = PackageCacheContext;
+	PackageCacheStats = hash_create("Package Cache Statistics", 32, &ctl,
+									HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
 	/* Restore previous memory context. */
 	MemoryContextSwitchTo(oldcontext);
 
@@ -305,40 +441,189 @@ BuildPackageCache(void)
 /*
 * when ora_package or ora_package_body update or delete
 * we should remove package'cache
+*
+* Packages depending on the changed one needn't be marked here: PL/iSQL
+* keeps the list of its dependents in each compiled package and throws
+* those away when the package itself gets recompiled.
 */
 static void
 InvalidatePackageCacheCallback(Datum arg,
 						  int cacheid, uint32 hashvalue)
 {
-	HASH_SEQ_STATUS status;
-	PackageCacheEntry *entry;
-	bool	 invalid = false;
+	bool		is_body = (cacheid == PKGBODYOID);
 
-	hash_seq_init(&status, PackageCache);
-	while ((entry = (PackageCacheEntry *) hash_seq_search(&status)) != NULL)
+	if (hashvalue == 0)
 	{
-		invalid = false;
+		HASH_SEQ_STATUS status;
+		PackageCacheEntry *entry;
 
-		if (hashvalue == 0)
-			invalid = true;
-		else if (cacheid == PKGOID && entry->item->package_hash_value == hashvalue)
-			invalid = true;
-		else if (cacheid == PKGBODYOID && entry->item->body_hash_value == hashvalue)
-			invalid = true;
+		hash_seq_init(&status, PackageCache);
+		while ((entry = (PackageCacheEntry *) hash_seq_search(&status)) != NULL)
+			PackageSetUpdateFlag(entry->item, is_body);
+	}
+	else
+	{
+		PackageHashIndexKey ikey;
+		PackageHashIndexEntry *ientry;
+		ListCell   *lc;
 
-		if (invalid)
+		ikey.cacheid = cacheid;
+		ikey.hashvalue = hashvalue;
+		ientry = hash_search(PackageHashIndex, &ikey, HASH_FIND, NULL);
+		if (ientry == NULL)
+			return;
+
+		foreach(lc, ientry->pkeys)
 		{
-			if (cacheid == PKGOID)
-				entry->item->cachestatus =
-					PACKAGE_SET_SPECIFICATION_UPDATE_FLAG(entry->item->cachestatus);
-			else
-				entry->item->cachestatus = PACKAGE_SET_BODY_UPDATE_FLAG(entry->item->cachestatus);
-		 }
+			PackageCacheKey pkey = lfirst_oid(lc);
+			PackageCacheEntry *entry;
+
+			entry = hash_search(PackageCache, &pkey, HASH_FIND, NULL);
+			if (entry != NULL)
+				PackageSetUpdateFlag(entry->item, is_body);
+		}
 	}
 	return;
 }
 
 
+/*
+ * Set the flag telling that a package's specification or body must be
+ * recompiled.  Returns true if it wasn't set already.
+ */
+static bool
+PackageSetUpdateFlag(PackageCacheItem *item, bool is_body)
+{
+	PackageCacheStatsEntry *stats;
+
+	if (is_body)
+	{
+		if (PACKAGE_BODY_IS_UPDATED(item->cachestatus))
+			return false;
+		item->cachestatus = PACKAGE_SET_BODY_UPDATE_FLAG(item->cachestatus);
+	}
+	else
+	{
+		if (PACKAGE_SPECIFICATION_IS_UPDATED(item->cachestatus))
+			return false;
+		item->cachestatus =
+			PACKAGE_SET_SPECIFICATION_UPDATE_FLAG(item->cachestatus);
+	}
+
+	stats = PackageCacheStatsGet(item->pkey);
+	stats->invalidations++;
+	stats->last_invalidation = GetCurrentTimestamp();
+
+	return true;
+}
+
+
+static void
+PackageHashIndexAdd(int cacheid, uint32 hashvalue, PackageCacheKey pkey)
+{
+	PackageHashIndexKey ikey;
+	PackageHashIndexEntry *ientry;
+	MemoryContext oldcontext;
+	bool		found;
+
+	ikey.cacheid = cacheid;
+	ikey.hashvalue = hashvalue;
+	ientry = hash_search(PackageHashIndex, &ikey, HASH_ENTER, &found);
+	if (!found)
+		ientry->pkeys = NIL;
+
+	oldcontext = MemoryContextSwitchTo(PackageCacheContext);
+	ientry->pkeys = list_append_unique_oid(ientry->pkeys, pkey);
+	MemoryContextSwitchTo(oldcontext);
+}
+
+
+static void
+PackageHashIndexRemove(int cacheid, uint32 hashvalue, PackageCacheKey pkey)
+{
+	PackageHashIndexKey ikey;
+	PackageHashIndexEntry *ientry;
+
+	ikey.cacheid = cacheid;
+	ikey.hashvalue = hashvalue;
+	ientry = hash_search(PackageHashIndex, &ikey, HASH_FIND, NULL);
+	if (ientry == NULL)
+		return;
+
+	ientry->pkeys = list_delete_oid(ientry->pkeys, pkey);
+	if (ientry->pkeys == NIL)
+		hash_search(PackageHashIndex, &ikey, HASH_REMOVE, NULL);
+}
+
+
+static PackageCacheStatsEntry *
+PackageCacheStatsGet(Oid pkgoid)
+{
+	PackageCacheStatsEntry *stats;
+	bool		found;
+
+	if (PackageCache == NULL)
+		BuildPackageCache();
+
+	stats = hash_search(PackageCacheStats, &pkgoid, HASH_ENTER, &found);
+	if (!found)
+	{
+		stats->invalidations = 0;
+		stats->compiles = 0;
+		stats->compile_time = 0;
+		stats->last_invalidation = 0;
+	}
+	return stats;
+}
+
+
+/*
+ * report this session's package cache activity
+ */
+Datum
+pg_get_package_cache_stats(PG_FUNCTION_ARGS)
+{
+#define PG_GET_PACKAGE_CACHE_STATS_COLS	6
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	HASH_SEQ_STATUS status;
+	PackageCacheStatsEntry *stats;
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	if (PackageCacheStats == NULL)
+		return (Datum) 0;
+
+	hash_seq_init(&status, PackageCacheStats);
+	while ((stats = (PackageCacheStatsEntry *) hash_seq_search(&status)) != NULL)
+	{
+		Datum		values[PG_GET_PACKAGE_CACHE_STATS_COLS] = {0};
+		bool		nulls[PG_GET_PACKAGE_CACHE_STATS_COLS] = {0};
+		PackageCacheEntry *entry;
+		bool		valid = false;
+
+		entry = hash_search(PackageCache, &stats->pkgoid, HASH_FIND, NULL);
+		if (entry != NULL)
+			valid = !PACKAGE_SPECIFICATION_IS_UPDATED(entry->item->cachestatus) &&
+				!PACKAGE_BODY_IS_UPDATED(entry->item->cachestatus);
+
+		values[0] = ObjectIdGetDatum(stats->pkgoid);
+		values[1] = BoolGetDatum(valid);
+		values[2] = Int64GetDatum(stats->invalidations);
+		values[3] = Int64GetDatum(stats->compiles);
+		values[4] = Float8GetDatum(stats->compile_time);
+		if (stats->last_invalidation != 0)
+			values[5] = TimestampTzGetDatum(stats->last_invalidation);
+		else
+			nulls[5] = true;
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc,
+							 values, nulls);
+	}
+
+	return (Datum) 0;
+}
+
+
 /*
  * get plisq language validator
  */
@@ -66,12 +66,14 @@
 #include "parser/analyze.h"
 #include "rewrite/rewriteHandler.h"
 #include "storage/lmgr.h"
+#include "storage/sinval.h"
 #include "tcop/pquery.h"
 #include "tcop/utility.h"
 #include "utils/inval.h"
 #include "utils/memutils.h"
 #include "utils/resowner.h"
 #include "utils/rls.h"
+#include "utils/sharedplancache.h"
 #include "utils/snapmgr.h"
 #include "utils/syscache.h"
 
@@ -1033,9 +1035,11 @@ BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 				ParamListInfo boundParams, QueryEnvironment *queryEnv)
 {
 	CachedPlan *plan;
-	List	   *plist;
+	List	   *plist = NIL;
 	bool		snapshot_set;
 	bool		is_transient;
+	bool		use_shared;
+	uint64		shared_generation = 0;
 	MemoryContext plan_context;
 	MemoryContext oldcxt = CurrentMemoryContext;
 	ListCell   *lc;
@@ -1057,39 +1061,73 @@ BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 		qlist = RevalidateCachedQuery(plansource, queryEnv);
 
 	/*
-	 * If we don't already have a copy of the querytree list that can be
-	 * scribbled on by the planner, make one.  For a one-shot plan, we assume
-	 * it's okay to scribble on the original query_list.
+	 * A generic plan may have been built by another backend already; see
+	 * sharedplancache.c.  The planner would have locked every relation the
+	 * plan touches, so do that here instead.  If that let in any
+	 * invalidation, the published plan could be stale by now; drop it and
+	 * plan for ourselves.
 	 */
-	if (qlist == NIL)
+	use_shared = (boundParams == NULL && queryEnv == NULL &&
+				  SharedPlanCacheUsable(plansource));
+	if (use_shared)
 	{
-		if (!plansource->is_oneshot)
-			qlist = copyObject(plansource->query_list);
-		else
-			qlist = plansource->query_list;
+		uint64		inval_count = SharedInvalidMessageCounter;
+
+		plist = SharedPlanCacheLookup(plansource);
+		if (plist != NIL)
+		{
+			AcquireExecutorLocks(plist, true);
+			if (inval_count != SharedInvalidMessageCounter)
+			{
+				AcquireExecutorLocks(plist, false);
+				plist = NIL;
+			}
+		}
+		if (plist == NIL)
+			shared_generation = SharedPlanCacheGeneration();
 	}
 
-	/*
-	 * If a snapshot is already set (the normal case), we can just use that
-	 * for planning.  But if it isn't, and we need one, install one.
-	 */
-	snapshot_set = false;
-	if (!ActiveSnapshotSet() &&
-		BuildingPlanRequiresSnapshot(plansource))
+	if (plist == NIL)
 	{
-		PushActiveSnapshot(GetTransactionSnapshot());
-		snapshot_set = true;
-	}
+		/*
+		 * If we don't already have a copy of the querytree list that can be
+		 * scribbled on by the planner, make one.  For a one-shot plan, we
+		 * assume it's okay to scribble on the original query_list.
+		 */
+		if (qlist == NIL)
+		{
+			if (!plansource->is_oneshot)
+				qlist = copyObject(plansource->query_list);
+			else
+				qlist = plansource->query_list;
+		}
 
-	/*
-	 * Generate the plan.
-	 */
-	plist = pg_plan_queries(qlist, plansource->query_string,
-							plansource->cursor_options, boundParams);
+		/*
+		 * If a snapshot is already set (the normal case), we can just use
+		 * that for planning.  But if it isn't, and we need one, install one.
+		 */
+		snapshot_set = false;
+		if (!ActiveSnapshotSet() &&
+			BuildingPlanRequiresSnapshot(plansource))
+		{
+			PushActiveSnapshot(GetTransactionSnapshot());
+			snapshot_set = true;
+		}
 
-	/* Release snapshot if we got one */
-	if (snapshot_set)
-		PopActiveSnapshot();
+		/*
+		 * Generate the plan.
+		 */
+		plist = pg_plan_queries(qlist, plansource->query_string,
+								plansource->cursor_options, boundParams);
+
+		/* Release snapshot if we got one */
+		if (snapshot_set)
+			PopActiveSnapshot();
+
+		/* Offer the new generic plan to other backends */
+		if (use_shared)
+			SharedPlanCacheInsert(plansource, plist, shared_generation);
+	}
 
 	/*
 	 * Normally we make a dedicated memory context for the CachedPlan and its
@@ -2137,6 +2175,9 @@ PlanCacheRelCallback(Datum arg, Oid relid)
 {
 	dlist_iter	iter;
 
+	/* Plans published by any backend may depend on the rel, too */
+	SharedPlanCacheInvalidateRelation(relid);
+
 	dlist_foreach(iter, &saved_plan_list)
 	{
 		CachedPlanSource *plansource = dlist_container(CachedPlanSource,
@@ -2221,6 +2262,8 @@ PlanCacheObjectCallback(Datum arg, int cacheid, uint32 hashvalue)
 {
 	dlist_iter	iter;
 
+	SharedPlanCacheInvalidateObject(cacheid, hashvalue);
+
 	dlist_foreach(iter, &saved_plan_list)
 	{
 		CachedPlanSource *plansource = dlist_container(CachedPlanSource,
@@ -2328,6 +2371,7 @@ PlanCacheObjectCallback(Datum arg, int cacheid, uint32 hashvalue)
 static void
 PlanCacheSysCallback(Datum arg, int cacheid, uint32 hashvalue)
 {
+	SharedPlanCacheReset();
 	ResetPlanCache();
 }
 
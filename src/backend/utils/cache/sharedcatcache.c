@@ -0,0 +1,578 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedcatcache.c
+ *	  Cross-backend cache of catalog tuples.
+ *
+ * Every backend's catcache holds its own copy of each catalog tuple it has
+ * looked up, so with many sessions and large catalogs most of the memory
+ * used by the caches holds identical data.  When shared_catalog_cache_size
+ * is set, the first backend to read a catalog tuple for a syscache lookup
+ * also publishes it in a hash table in shared memory.  Other backends that
+ * miss in their own catcache take the published tuple instead of scanning
+ * the catalog, and their catcache entries point to the shared copy rather
+ * than to a private one.  Shared tuples are immutable and reference counted:
+ * a removed tuple is freed only after the last catcache entry pointing to it
+ * is gone.
+ *
+ * Only committed catalog state is published.  A backend whose transaction
+ * has an XID may have changed the catalogs, so it neither reads nor
+ * publishes shared tuples; neither does one using a historic snapshot.
+ * Tuples that have been updated or deleted by a transaction that may have
+ * committed (any xmax that isn't just a locker) are not published either,
+ * since the reader's catalog snapshot may predate the change.  The cache is
+ * not used at all during recovery: on a standby the catalogs change by WAL
+ * replay, which doesn't remove stale tuples the way a committing backend
+ * does.
+ *
+ * Stale tuples are removed by the backend that makes them stale, as it sends
+ * the invalidation messages for its committed transaction (or inplace
+ * update), before it releases its locks.  So any backend that would have to
+ * process those messages before seeing the new catalog state also won't see
+ * the old tuples in the shared cache.  Removing them on the sending side
+ * also covers databases that no backend is connected to at the moment.  The
+ * backend attaches to the shared area before committing, as nothing may fail
+ * once the transaction has committed.  To keep a tuple that was read before
+ * a removal from being published after it, removals first bump a generation
+ * counter for the hash value, and a tuple is only published if the counter
+ * didn't move since before the catalog scan.
+ *
+ * The shared memory is a fixed-size DSA area created in place in the main
+ * shared memory segment, so it never grows beyond shared_catalog_cache_size
+ * and pointers into it are valid in every backend.  When it is full, new
+ * tuples are simply not published.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/cache/sharedcatcache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "funcapi.h"
+#include "lib/dshash.h"
+#include "miscadmin.h"
+#include "storage/ipc.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/builtins.h"
+#include "utils/memutils.h"
+#include "utils/sharedcatcache.h"
+
+
+/* GUC parameter: size of the shared area in kB, 0 disables the cache */
+int			shared_catalog_cache_size = 0;
+
+/* smallest area we bother to create; it must hold the dshash buckets */
+#define SHARED_CATCACHE_MIN_SIZE	(1024 * 1024)
+
+/* number of generation counters, hash values are spread over them */
+#define SHARED_CATCACHE_GENERATIONS	256
+
+typedef struct SharedCatCacheKey
+{
+	Oid			dbId;			/* database, or InvalidOid if shared catalog */
+	int			cacheId;
+	uint32		hashValue;
+} SharedCatCacheKey;
+
+/* all published tuples of one cache with the same hash value */
+typedef struct SharedCatCacheBucket
+{
+	SharedCatCacheKey key;		/* hash key, must be first */
+	Oid			reloid;			/* catalog the cache is on */
+	dsa_pointer head;			/* first SharedCatCTup */
+} SharedCatCacheBucket;
+
+/*
+ * A published tuple.  "refcount" counts the catcache entries pointing to the
+ * tuple; SCC_DEAD is set in it once the tuple has been unlinked, and
+ * whoever leaves it at exactly SCC_DEAD frees the tuple.
+ */
+typedef struct SharedCatCTup
+{
+	dsa_pointer self;
+	dsa_pointer next;			/* next tuple in the bucket */
+	pg_atomic_uint32 refcount;
+	uint32		t_len;
+	ItemPointerData t_self;
+	Oid			t_tableOid;
+	/* MAXALIGNed tuple data follows */
+} SharedCatCTup;
+
+#define SCC_DEAD	0x80000000
+
+#define SCC_TUPLE_DATA(sct) \
+	((HeapTupleHeader) ((char *) (sct) + MAXALIGN(sizeof(SharedCatCTup))))
+
+typedef struct SharedCatCacheCtl
+{
+	void	   *raw_dsa_area;
+	dshash_table_handle hash_handle;
+	pg_atomic_uint32 nentries;
+	pg_atomic_uint64 hits;
+	pg_atomic_uint64 misses;
+	pg_atomic_uint64 inserts;
+	pg_atomic_uint64 removals;
+	/* bumped before removing tuples with a matching hash value */
+	pg_atomic_uint64 generations[SHARED_CATCACHE_GENERATIONS];
+} SharedCatCacheCtl;
+
+static const dshash_parameters scc_params = {
+	sizeof(SharedCatCacheKey),
+	sizeof(SharedCatCacheBucket),
+	dshash_memcmp,
+	dshash_memhash,
+	dshash_memcpy,
+	LWTRANCHE_SHARED_CATALOG_CACHE_HASH
+};
+
+static SharedCatCacheCtl *SharedCatCache = NULL;
+
+/* this backend's attachment, set up on first use */
+static dsa_area *scc_area = NULL;
+static dshash_table *scc_hash = NULL;
+
+static Size shared_catalog_cache_area_size(void);
+static void scc_attach(void);
+static void scc_detach(int code, Datum arg);
+static void scc_make_key(SharedCatCacheKey *key, int cacheId, Oid dbId,
+						 uint32 hashValue);
+static void scc_make_tuple(SharedCatCTup *sct, HeapTuple tuple);
+static void scc_unlink_chain(dsa_pointer dp);
+static void scc_remove(int cacheId, Oid dbId, uint32 hashValue);
+static void scc_remove_catalog(Oid dbId, Oid catId);
+
+
+static Size
+shared_catalog_cache_area_size(void)
+{
+	Size		sz;
+
+	sz = mul_size((Size) shared_catalog_cache_size, 1024);
+	sz = Max(sz, SHARED_CATCACHE_MIN_SIZE);
+	return MAXALIGN(sz);
+}
+
+/*
+ * Report shared memory space needed by SharedCatCacheShmemInit
+ */
+Size
+SharedCatCacheShmemSize(void)
+{
+	Size		sz;
+
+	if (shared_catalog_cache_size <= 0)
+		return 0;
+
+	sz = MAXALIGN(sizeof(SharedCatCacheCtl));
+	sz = add_size(sz, shared_catalog_cache_area_size());
+	return sz;
+}
+
+/*
+ * Allocate and initialize the shared catalog cache, if enabled
+ */
+void
+SharedCatCacheShmemInit(void)
+{
+	bool		found;
+
+	if (shared_catalog_cache_size <= 0)
+		return;
+
+	SharedCatCache = (SharedCatCacheCtl *)
+		ShmemInitStruct("Shared Catalog Cache", SharedCatCacheShmemSize(),
+						&found);
+
+	if (!IsUnderPostmaster)
+	{
+		SharedCatCacheCtl *ctl = SharedCatCache;
+		dsa_area   *dsa;
+		dshash_table *dsh;
+
+		Assert(!found);
+
+		ctl->raw_dsa_area = (char *) ctl + MAXALIGN(sizeof(SharedCatCacheCtl));
+		dsa = dsa_create_in_place(ctl->raw_dsa_area,
+								  shared_catalog_cache_area_size(),
+								  LWTRANCHE_SHARED_CATALOG_CACHE_DSA, NULL);
+		dsa_pin(dsa);
+
+		/* never grow into dynamic shared memory segments */
+		dsa_set_size_limit(dsa, shared_catalog_cache_area_size());
+
+		dsh = dshash_create(dsa, &scc_params, NULL);
+		ctl->hash_handle = dshash_get_hash_table_handle(dsh);
+
+		/* postmaster will never access these again */
+		dshash_detach(dsh);
+		dsa_detach(dsa);
+
+		pg_atomic_init_u32(&ctl->nentries, 0);
+		pg_atomic_init_u64(&ctl->hits, 0);
+		pg_atomic_init_u64(&ctl->misses, 0);
+		pg_atomic_init_u64(&ctl->inserts, 0);
+		pg_atomic_init_u64(&ctl->removals, 0);
+		for (int i = 0; i < SHARED_CATCACHE_GENERATIONS; i++)
+			pg_atomic_init_u64(&ctl->generations[i], 0);
+	}
+	else
+		Assert(found);
+}
+
+static void
+scc_attach(void)
+{
+	MemoryContext oldcontext;
+
+	if (scc_hash != NULL)
+		return;
+
+	oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+
+	scc_area = dsa_attach_in_place(SharedCatCache->raw_dsa_area, NULL);
+	dsa_pin_mapping(scc_area);
+	scc_hash = dshash_attach(scc_area, &scc_params,
+							 SharedCatCache->hash_handle, NULL);
+
+	MemoryContextSwitchTo(oldcontext);
+
+	before_shmem_exit(scc_detach, (Datum) 0);
+}
+
+static void
+scc_detach(int code, Datum arg)
+{
+	dshash_detach(scc_hash);
+	scc_hash = NULL;
+	dsa_detach(scc_area);
+	scc_area = NULL;
+
+	/* dsa_detach() doesn't drop the reference of an in-place area */
+	dsa_release_in_place(SharedCatCache->raw_dsa_area);
+}
+
+/*
+ * Is the shared catalog cache configured?
+ */
+bool
+SharedCatCacheEnabled(void)
+{
+	return SharedCatCache != NULL;
+}
+
+/*
+ * Generation counter to pass to SharedCatCacheInsert; read it before
+ * scanning the catalog.
+ */
+uint64
+SharedCatCacheGeneration(uint32 hashValue)
+{
+	return pg_atomic_read_membarrier_u64(&SharedCatCache->generations[hashValue % SHARED_CATCACHE_GENERATIONS]);
+}
+
+static void
+scc_make_key(SharedCatCacheKey *key, int cacheId, Oid dbId, uint32 hashValue)
+{
+	memset(key, 0, sizeof(SharedCatCacheKey));
+	key->dbId = dbId;
+	key->cacheId = cacheId;
+	key->hashValue = hashValue;
+}
+
+/* Point a HeapTupleData at a published tuple */
+static void
+scc_make_tuple(SharedCatCTup *sct, HeapTuple tuple)
+{
+	tuple->t_len = sct->t_len;
+	tuple->t_self = sct->t_self;
+	tuple->t_tableOid = sct->t_tableOid;
+	tuple->t_data = SCC_TUPLE_DATA(sct);
+}
+
+/*
+ * Look for a published tuple for which match() returns true.
+ *
+ * On success, *tuple is set to point to the shared copy, which must not be
+ * modified, and an opaque reference is returned that keeps the copy alive
+ * until it is passed to SharedCatCacheRelease.  Returns NULL if there is no
+ * such tuple.
+ */
+void *
+SharedCatCacheLookup(int cacheId, Oid dbId, uint32 hashValue,
+					 SharedCatCacheMatchFn match, void *arg, HeapTuple tuple)
+{
+	SharedCatCacheKey key;
+	SharedCatCacheBucket *bucket;
+	SharedCatCTup *result = NULL;
+
+	scc_attach();
+	scc_make_key(&key, cacheId, dbId, hashValue);
+
+	bucket = dshash_find(scc_hash, &key, false);
+	if (bucket != NULL)
+	{
+		dsa_pointer dp;
+
+		for (dp = bucket->head; DsaPointerIsValid(dp);)
+		{
+			SharedCatCTup *sct = dsa_get_address(scc_area, dp);
+
+			scc_make_tuple(sct, tuple);
+			if (match(tuple, arg))
+			{
+				/* can't be dead while linked, we hold the bucket lock */
+				pg_atomic_fetch_add_u32(&sct->refcount, 1);
+				result = sct;
+				break;
+			}
+			dp = sct->next;
+		}
+		dshash_release_lock(scc_hash, bucket);
+	}
+
+	if (result == NULL)
+		pg_atomic_fetch_add_u64(&SharedCatCache->misses, 1);
+	else
+		pg_atomic_fetch_add_u64(&SharedCatCache->hits, 1);
+
+	return result;
+}
+
+/*
+ * Publish a catalog tuple just read by this backend.
+ *
+ * "generation" is the value SharedCatCacheGeneration() returned before the
+ * catalog scan started.  match() identifies tuples with the same keys, so
+ * that a tuple published concurrently by another backend isn't duplicated.
+ */
+void
+SharedCatCacheInsert(int cacheId, Oid reloid, Oid dbId, uint32 hashValue,
+					 HeapTuple tuple, SharedCatCacheMatchFn match, void *arg,
+					 uint64 generation)
+{
+	SharedCatCacheKey key;
+	SharedCatCacheBucket *bucket;
+	SharedCatCTup *sct;
+	dsa_pointer dp;
+	bool		found;
+	bool		publish = true;
+
+	scc_attach();
+
+	dp = dsa_allocate_extended(scc_area,
+							   MAXALIGN(sizeof(SharedCatCTup)) + tuple->t_len,
+							   DSA_ALLOC_NO_OOM);
+	if (!DsaPointerIsValid(dp))
+		return;					/* the cache is full */
+
+	sct = dsa_get_address(scc_area, dp);
+	sct->self = dp;
+	sct->next = InvalidDsaPointer;
+	pg_atomic_init_u32(&sct->refcount, 0);
+	sct->t_len = tuple->t_len;
+	sct->t_self = tuple->t_self;
+	sct->t_tableOid = tuple->t_tableOid;
+	memcpy(SCC_TUPLE_DATA(sct), tuple->t_data, tuple->t_len);
+
+	scc_make_key(&key, cacheId, dbId, hashValue);
+	bucket = dshash_find_or_insert_extended(scc_hash, &key, &found,
+											DSHASH_INSERT_NO_OOM);
+	if (bucket == NULL)
+	{
+		/* no room for a new bucket */
+		dsa_free(scc_area, dp);
+		return;
+	}
+	if (!found)
+	{
+		bucket->reloid = reloid;
+		bucket->head = InvalidDsaPointer;
+	}
+
+	/*
+	 * If the tuple's hash value was invalidated since we started reading
+	 * it, the tuple may be stale, and the backend that removed the stale
+	 * tuples won't have seen ours.  Checking while holding the bucket lock
+	 * is enough, as removals bump the counter before locking the bucket.
+	 */
+	if (SharedCatCacheGeneration(hashValue) != generation)
+		publish = false;
+	else
+	{
+		for (dsa_pointer cur = bucket->head; DsaPointerIsValid(cur);)
+		{
+			SharedCatCTup *other = dsa_get_address(scc_area, cur);
+			HeapTupleData otup;
+
+			scc_make_tuple(other, &otup);
+			if (match(&otup, arg))
+			{
+				/* someone else published it first */
+				publish = false;
+				break;
+			}
+			cur = other->next;
+		}
+	}
+
+	if (publish)
+	{
+		sct->next = bucket->head;
+		bucket->head = dp;
+		dshash_release_lock(scc_hash, bucket);
+
+		pg_atomic_fetch_add_u32(&SharedCatCache->nentries, 1);
+		pg_atomic_fetch_add_u64(&SharedCatCache->inserts, 1);
+	}
+	else
+	{
+		if (!DsaPointerIsValid(bucket->head))
+			dshash_delete_entry(scc_hash, bucket);
+		else
+			dshash_release_lock(scc_hash, bucket);
+		dsa_free(scc_area, dp);
+	}
+}
+
+/*
+ * Drop a reference returned by SharedCatCacheLookup.
+ */
+void
+SharedCatCacheRelease(void *ref)
+{
+	SharedCatCTup *sct = (SharedCatCTup *) ref;
+
+	if (pg_atomic_fetch_sub_u32(&sct->refcount, 1) == (SCC_DEAD | 1))
+		dsa_free(scc_area, sct->self);
+}
+
+/*
+ * Mark all tuples of a bucket's chain as removed, freeing those that aren't
+ * referenced.  Caller holds the bucket lock exclusively and deletes the
+ * bucket afterwards.
+ */
+static void
+scc_unlink_chain(dsa_pointer dp)
+{
+	while (DsaPointerIsValid(dp))
+	{
+		SharedCatCTup *sct = dsa_get_address(scc_area, dp);
+		dsa_pointer next = sct->next;
+
+		if (pg_atomic_fetch_or_u32(&sct->refcount, SCC_DEAD) == 0)
+			dsa_free(scc_area, dp);
+
+		pg_atomic_fetch_sub_u32(&SharedCatCache->nentries, 1);
+		pg_atomic_fetch_add_u64(&SharedCatCache->removals, 1);
+		dp = next;
+	}
+}
+
+static void
+scc_remove(int cacheId, Oid dbId, uint32 hashValue)
+{
+	SharedCatCacheKey key;
+	SharedCatCacheBucket *bucket;
+
+	/* must come before looking at the bucket, see SharedCatCacheInsert */
+	pg_atomic_fetch_add_u64(&SharedCatCache->generations[hashValue % SHARED_CATCACHE_GENERATIONS], 1);
+
+	scc_make_key(&key, cacheId, dbId, hashValue);
+	bucket = dshash_find(scc_hash, &key, true);
+	if (bucket == NULL)
+		return;
+
+	scc_unlink_chain(bucket->head);
+	dshash_delete_entry(scc_hash, bucket);
+}
+
+static void
+scc_remove_catalog(Oid dbId, Oid catId)
+{
+	dshash_seq_status status;
+	SharedCatCacheBucket *bucket;
+
+	for (int i = 0; i < SHARED_CATCACHE_GENERATIONS; i++)
+		pg_atomic_fetch_add_u64(&SharedCatCache->generations[i], 1);
+
+	dshash_seq_init(&status, scc_hash, true);
+	while ((bucket = dshash_seq_next(&status)) != NULL)
+	{
+		if (bucket->key.dbId != dbId || bucket->reloid != catId)
+			continue;
+		scc_unlink_chain(bucket->head);
+		dshash_delete_current(&status);
+	}
+	dshash_seq_term(&status);
+}
+
+/*
+ * Attach to the shared area ahead of SharedCatCacheInvalidate, which runs
+ * after commit or in a critical section and so must not allocate memory.
+ */
+void
+SharedCatCachePrepareInvalidate(void)
+{
+	if (SharedCatCache != NULL)
+		scc_attach();
+}
+
+/*
+ * Remove the tuples made stale by invalidation messages about to be sent.
+ *
+ * This doesn't allocate memory, so it can run after commit or in a critical
+ * section; SharedCatCachePrepareInvalidate must have been called first.
+ */
+void
+SharedCatCacheInvalidate(const SharedInvalidationMessage *msgs, int n)
+{
+	if (SharedCatCache == NULL)
+		return;
+
+	Assert(scc_hash != NULL);
+
+	for (int i = 0; i < n; i++)
+	{
+		const SharedInvalidationMessage *msg = &msgs[i];
+
+		if (msg->id >= 0)
+			scc_remove(msg->cc.id, msg->cc.dbId, msg->cc.hashValue);
+		else if (msg->id == SHAREDINVALCATALOG_ID)
+			scc_remove_catalog(msg->cat.dbId, msg->cat.catId);
+	}
+}
+
+/*
+ * SQL-callable function reporting the cache's activity
+ */
+Datum
+pg_shared_catalog_cache_stats(PG_FUNCTION_ARGS)
+{
+#define PG_SHARED_CATALOG_CACHE_STATS_COLS	5
+	TupleDesc	tupdesc;
+	Datum		values[PG_SHARED_CATALOG_CACHE_STATS_COLS] = {0};
+	bool		nulls[PG_SHARED_CATALOG_CACHE_STATS_COLS] = {0};
+
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	if (SharedCatCache == NULL)
+	{
+		for (int i = 0; i < PG_SHARED_CATALOG_CACHE_STATS_COLS; i++)
+			values[i] = Int64GetDatum(0);
+	}
+	else
+	{
+		values[0] = Int64GetDatum((int64) pg_atomic_read_u32(&SharedCatCache->nentries));
+		values[1] = Int64GetDatum((int64) pg_atomic_read_u64(&SharedCatCache->hits));
+		values[2] = Int64GetDatum((int64) pg_atomic_read_u64(&SharedCatCache->misses));
+		values[3] = Int64GetDatum((int64) pg_atomic_read_u64(&SharedCatCache->inserts));
+		values[4] = Int64GetDatum((int64) pg_atomic_read_u64(&SharedCatCache->removals));
+	}
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
@@ -0,0 +1,1061 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedplancache.c
+ *	  Cross-backend cache of generic plans.
+ *
+ * Every backend that prepares a statement builds its own generic plan for
+ * it, so a fleet of sessions running the same application plans the same
+ * statements over and over.  When shared_plan_cache_size is set, the first
+ * backend to build a generic plan publishes it, serialized with
+ * nodeToString(), in a hash table in shared memory; other backends preparing
+ * the identical statement in the identical environment then deserialize the
+ * published plan instead of running the planner.
+ *
+ * The hash key covers everything apart from catalog contents that can change
+ * a generic plan: the text of the statement itself (not of the whole source
+ * string, which several statements may share) and the parser mode, the
+ * parameter types and cursor options, the database and role, the settings
+ * that affect parsing (spc_key_settings), and the planner-related settings
+ * (those marked GUC_EXPLAIN).
+ *
+ * Catalog changes are handled when their invalidation messages are sent: the
+ * committing backend removes the plans depending on the changed objects
+ * before any other backend can see the messages (SharedPlanCacheInvalidate),
+ * so a session that has seen a change, including one started after it, never
+ * finds a plan built before it.  A second hash table indexes the published
+ * plans by the relations and objects they depend on, so that takes one
+ * lookup per object.  To keep a plan that was built before an invalidation
+ * from being published after the removal, the removal bumps a generation
+ * counter, and a plan is withdrawn again if the counter moved while it was
+ * being built.
+ *
+ * The plan cache's invalidation callbacks, which every backend runs for
+ * every message, bump the counter as well, and remember the invalidated
+ * objects so that their dependents are removed again the next time the
+ * backend looks up or publishes a plan.  That catches a plan published by a
+ * backend that built it from catalog entries it hadn't invalidated yet.
+ *
+ * The shared memory is a fixed-size DSA area created in place in the main
+ * shared memory segment, so it never grows beyond shared_plan_cache_size.
+ * When it is full, new plans are simply not published.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/cache/sharedplancache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "catalog/namespace.h"
+#include "commands/trigger.h"
+#include "common/hashfn.h"
+#include "funcapi.h"
+#include "lib/dshash.h"
+#include "miscadmin.h"
+#include "nodes/plannodes.h"
+#include "nodes/queryjumble.h"
+#include "storage/ipc.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/guc_tables.h"
+#include "utils/memutils.h"
+#include "utils/rls.h"
+#include "utils/sharedplancache.h"
+#include "utils/syscache.h"
+
+
+/* GUC parameter: size of the shared area in kB, 0 disables the cache */
+int			shared_plan_cache_size = 0;
+
+/* smallest area we bother to create; it must hold the dshash buckets */
+#define SHARED_PLAN_CACHE_MIN_SIZE	(1024 * 1024)
+
+/* invalidated objects remembered before we reset the whole cache instead */
+#define SPC_MAX_PENDING		64
+
+/* cacheid of a dependency on a relation, rather than on a catcache entry */
+#define SPC_DEP_RELATION	(-1)
+
+/*
+ * Settings, apart from the GUC_EXPLAIN ones, that change how a statement
+ * is parsed and analyzed.
+ */
+static const char *const spc_key_settings[] = {
+	"DateStyle",
+	"IntervalStyle",
+	"TimeZone",
+	"standard_conforming_strings",
+	"search_path",
+	"ivorysql.enable_case_switch",
+	"ivorysql.identifier_case_switch",
+	"ivorysql.enable_emptystring_to_NULL",
+	"nls_date_format",
+	"nls_timestamp_format",
+	"nls_timestamp_tz_format",
+	"nls_length_semantics",
+};
+
+typedef struct SharedPlanKey
+{
+	Oid			dbid;
+	Oid			userid;
+	uint64		hash;			/* hash of statement text and environment */
+} SharedPlanKey;
+
+/* an object plans depend on: a relation, or a PlanInvalItem */
+typedef struct SharedPlanDepKey
+{
+	int			cacheid;		/* SPC_DEP_RELATION for a relation */
+	uint32		value;			/* relation OID or catcache hash value */
+} SharedPlanDepKey;
+
+/*
+ * A published plan.  "data" points to a single DSA chunk holding, in order,
+ * the objects the plan depends on, the statement text (to guard against hash
+ * collisions) and the serialized plan.
+ */
+typedef struct SharedPlanEntry
+{
+	SharedPlanKey key;			/* hash key, must be first */
+	dsa_pointer data;
+	int			ndeps;
+	Size		query_len;
+	Size		plan_len;
+	pg_atomic_uint64 hits;
+} SharedPlanEntry;
+
+/*
+ * The published plans depending on an object.  "plans" is an array of
+ * SharedPlanKey; it may name plans that are gone already.
+ */
+typedef struct SharedPlanDepEntry
+{
+	SharedPlanDepKey key;		/* hash key, must be first */
+	dsa_pointer plans;
+	int			nplans;
+	int			maxplans;
+} SharedPlanDepEntry;
+
+typedef struct SharedPlanCacheCtl
+{
+	void	   *raw_dsa_area;
+	dshash_table_handle hash_handle;
+	dshash_table_handle dep_hash_handle;
+	pg_atomic_uint64 generation;	/* bumped on every invalidation */
+	pg_atomic_uint32 nentries;
+	pg_atomic_uint64 hits;
+	pg_atomic_uint64 misses;
+	pg_atomic_uint64 inserts;
+	pg_atomic_uint64 removals;
+} SharedPlanCacheCtl;
+
+#define SPC_QUERY_OFFSET(ndeps) \
+	((ndeps) * sizeof(SharedPlanDepKey))
+#define SPC_PLAN_OFFSET(ndeps, query_len) \
+	(SPC_QUERY_OFFSET(ndeps) + (query_len) + 1)
+
+static const dshash_parameters spc_params = {
+	sizeof(SharedPlanKey),
+	sizeof(SharedPlanEntry),
+	dshash_memcmp,
+	dshash_memhash,
+	dshash_memcpy,
+	LWTRANCHE_SHARED_PLAN_CACHE_HASH
+};
+
+static const dshash_parameters spc_dep_params = {
+	sizeof(SharedPlanDepKey),
+	sizeof(SharedPlanDepEntry),
+	dshash_memcmp,
+	dshash_memhash,
+	dshash_memcpy,
+	LWTRANCHE_SHARED_PLAN_CACHE_HASH
+};
+
+static SharedPlanCacheCtl *SharedPlanCache = NULL;
+
+/* this backend's attachment, set up on first use */
+static dsa_area *spc_area = NULL;
+static dshash_table *spc_hash = NULL;
+static dshash_table *spc_dep_hash = NULL;
+
+/* invalidations this backend has yet to apply to the shared entries */
+static SharedPlanDepKey spc_pending[SPC_MAX_PENDING];
+static int	spc_npending = 0;
+static bool spc_pending_all = false;
+
+static bool spc_exit_registered = false;
+
+static Size shared_plan_cache_area_size(void);
+static void spc_register_exit(void);
+static void spc_attach(void);
+static void spc_shmem_exit(int code, Datum arg);
+static const char *spc_statement_text(CachedPlanSource *plansource,
+									  int *len);
+static void spc_compute_key(CachedPlanSource *plansource, SharedPlanKey *key);
+static void spc_queue_removal(int cacheid, uint32 value, bool all);
+static void spc_process_pending(void);
+static bool spc_link_dep(SharedPlanDepKey *dep, SharedPlanKey *key);
+static void spc_unlink_dep(SharedPlanDepKey *dep, SharedPlanKey *key);
+static void spc_remove_plan(SharedPlanKey *key, dsa_pointer expected);
+static void spc_remove_dependents(SharedPlanDepKey *dep);
+static void spc_remove_all(void);
+
+
+static Size
+shared_plan_cache_area_size(void)
+{
+	Size		sz;
+
+	sz = mul_size((Size) shared_plan_cache_size, 1024);
+	sz = Max(sz, SHARED_PLAN_CACHE_MIN_SIZE);
+	return MAXALIGN(sz);
+}
+
+/*
+ * Report shared memory space needed by SharedPlanCacheShmemInit
+ */
+Size
+SharedPlanCacheShmemSize(void)
+{
+	Size		sz;
+
+	if (shared_plan_cache_size <= 0)
+		return 0;
+
+	sz = MAXALIGN(sizeof(SharedPlanCacheCtl));
+	sz = add_size(sz, shared_plan_cache_area_size());
+	return sz;
+}
+
+/*
+ * Allocate and initialize the shared plan cache, if enabled
+ */
+void
+SharedPlanCacheShmemInit(void)
+{
+	bool		found;
+
+	if (shared_plan_cache_size <= 0)
+		return;
+
+	SharedPlanCache = (SharedPlanCacheCtl *)
+		ShmemInitStruct("Shared Plan Cache", SharedPlanCacheShmemSize(),
+						&found);
+
+	if (!IsUnderPostmaster)
+	{
+		SharedPlanCacheCtl *ctl = SharedPlanCache;
+		dsa_area   *dsa;
+		dshash_table *dsh;
+
+		Assert(!found);
+
+		ctl->raw_dsa_area = (char *) ctl + MAXALIGN(sizeof(SharedPlanCacheCtl));
+		dsa = dsa_create_in_place(ctl->raw_dsa_area,
+								  shared_plan_cache_area_size(),
+								  LWTRANCHE_SHARED_PLAN_CACHE_DSA, NULL);
+		dsa_pin(dsa);
+
+		/* never grow into dynamic shared memory segments */
+		dsa_set_size_limit(dsa, shared_plan_cache_area_size());
+
+		dsh = dshash_create(dsa, &spc_params, NULL);
+		ctl->hash_handle = dshash_get_hash_table_handle(dsh);
+		dshash_detach(dsh);
+
+		dsh = dshash_create(dsa, &spc_dep_params, NULL);
+		ctl->dep_hash_handle = dshash_get_hash_table_handle(dsh);
+		dshash_detach(dsh);
+
+		/* postmaster will never access the area again */
+		dsa_detach(dsa);
+
+		pg_atomic_init_u64(&ctl->generation, 0);
+		pg_atomic_init_u32(&ctl->nentries, 0);
+		pg_atomic_init_u64(&ctl->hits, 0);
+		pg_atomic_init_u64(&ctl->misses, 0);
+		pg_atomic_init_u64(&ctl->inserts, 0);
+		pg_atomic_init_u64(&ctl->removals, 0);
+	}
+	else
+		Assert(found);
+}
+
+static void
+spc_register_exit(void)
+{
+	if (spc_exit_registered)
+		return;
+	before_shmem_exit(spc_shmem_exit, (Datum) 0);
+	spc_exit_registered = true;
+}
+
+static void
+spc_attach(void)
+{
+	MemoryContext oldcontext;
+
+	if (spc_hash != NULL)
+		return;
+
+	spc_register_exit();
+
+	oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+
+	spc_area = dsa_attach_in_place(SharedPlanCache->raw_dsa_area, NULL);
+	dsa_pin_mapping(spc_area);
+	spc_hash = dshash_attach(spc_area, &spc_params,
+							 SharedPlanCache->hash_handle, NULL);
+	spc_dep_hash = dshash_attach(spc_area, &spc_dep_params,
+								 SharedPlanCache->dep_hash_handle, NULL);
+
+	MemoryContextSwitchTo(oldcontext);
+}
+
+/*
+ * Apply any invalidations we still hold, since the backends that may look up
+ * the affected plans later could have started after the invalidation was
+ * sent, and then detach.
+ */
+static void
+spc_shmem_exit(int code, Datum arg)
+{
+	spc_process_pending();
+
+	if (spc_hash == NULL)
+		return;
+
+	dshash_detach(spc_dep_hash);
+	spc_dep_hash = NULL;
+	dshash_detach(spc_hash);
+	spc_hash = NULL;
+	dsa_detach(spc_area);
+	spc_area = NULL;
+
+	/* dsa_detach() doesn't drop the reference of an in-place area */
+	dsa_release_in_place(SharedPlanCache->raw_dsa_area);
+}
+
+/*
+ * Can plansource's generic plan be shared with other backends?
+ *
+ * Statements whose parameters are resolved by parser hooks (PL/iSQL
+ * variables, for instance) may analyze differently under the same text, so
+ * only plain statements with explicit parameter types qualify.
+ */
+bool
+SharedPlanCacheUsable(CachedPlanSource *plansource)
+{
+	return SharedPlanCache != NULL &&
+		!plansource->is_oneshot &&
+		plansource->raw_parse_tree != NULL &&
+		plansource->parserSetup == NULL &&
+		plansource->query_string != NULL;
+}
+
+/*
+ * Generation counter to pass to SharedPlanCacheInsert; read it before
+ * building the plan.
+ */
+uint64
+SharedPlanCacheGeneration(void)
+{
+	return pg_atomic_read_membarrier_u64(&SharedPlanCache->generation);
+}
+
+/*
+ * The part of plansource's source string that is this statement; the whole
+ * string may hold several.
+ */
+static const char *
+spc_statement_text(CachedPlanSource *plansource, int *len)
+{
+	int			location = plansource->raw_parse_tree->stmt_location;
+
+	*len = plansource->raw_parse_tree->stmt_len;
+	return CleanQuerytext(plansource->query_string, &location, len);
+}
+
+static void
+spc_compute_key(CachedPlanSource *plansource, SharedPlanKey *key)
+{
+	struct config_generic **gucs;
+	List	   *search_path;
+	ListCell   *lc;
+	const char *query;
+	int			query_len;
+	uint64		hash;
+	int			num;
+
+	memset(key, 0, sizeof(SharedPlanKey));
+	key->dbid = MyDatabaseId;
+	key->userid = GetUserId();
+
+	query = spc_statement_text(plansource, &query_len);
+	hash = hash_bytes_extended((const unsigned char *) query, query_len, 0);
+	hash = hash_combine64(hash, (uint64) compatible_db);
+	hash = hash_combine64(hash, (uint64) plansource->cursor_options);
+	hash = hash_combine64(hash, (uint64) row_security);
+	hash = hash_combine64(hash, (uint64) SessionReplicationRole);
+	hash = hash_combine64(hash, (uint64) plansource->num_params);
+	if (plansource->num_params > 0)
+		hash = hash_combine64(hash,
+							  hash_bytes_extended((const unsigned char *) plansource->param_types,
+												  plansource->num_params * sizeof(Oid),
+												  0));
+
+	/*
+	 * search_path is among the settings, but the schemas it names may not
+	 * all exist yet; hash the schemas it resolves to as well.
+	 */
+	search_path = fetch_search_path(true);
+	foreach(lc, search_path)
+		hash = hash_combine64(hash, (uint64) lfirst_oid(lc));
+	list_free(search_path);
+
+	for (int i = 0; i < lengthof(spc_key_settings); i++)
+	{
+		const char *value = GetConfigOption(spc_key_settings[i], true, false);
+
+		if (value != NULL)
+			hash = hash_combine64(hash,
+								  hash_bytes_extended((const unsigned char *) value,
+													  strlen(value), 0));
+	}
+
+	gucs = get_explain_guc_options(&num);
+	for (int i = 0; i < num; i++)
+	{
+		char	   *value = ShowGUCOption(gucs[i], false);
+
+		hash = hash_combine64(hash,
+							  hash_bytes_extended((const unsigned char *) gucs[i]->name,
+												  strlen(gucs[i]->name), 0));
+		hash = hash_combine64(hash,
+							  hash_bytes_extended((const unsigned char *) value,
+												  strlen(value), 0));
+		pfree(value);
+	}
+	pfree(gucs);
+
+	key->hash = hash;
+}
+
+/*
+ * Look for a published generic plan for plansource.
+ *
+ * Returns the deserialized statement list in the current memory context, or
+ * NIL if there is none.  The caller must still lock the relations the plan
+ * uses, since the planner hasn't done so.
+ */
+List *
+SharedPlanCacheLookup(CachedPlanSource *plansource)
+{
+	SharedPlanKey key;
+	SharedPlanEntry *entry;
+	const char *query;
+	int			query_len;
+	char	   *data;
+	char	   *planstr;
+	List	   *result;
+	ListCell   *lc;
+
+	spc_attach();
+	spc_process_pending();
+	spc_compute_key(plansource, &key);
+
+	entry = dshash_find(spc_hash, &key, false);
+	if (entry == NULL)
+	{
+		pg_atomic_fetch_add_u64(&SharedPlanCache->misses, 1);
+		return NIL;
+	}
+
+	data = dsa_get_address(spc_area, entry->data);
+	query = spc_statement_text(plansource, &query_len);
+	if (entry->query_len != query_len ||
+		memcmp(data + SPC_QUERY_OFFSET(entry->ndeps), query, query_len) != 0)
+	{
+		dshash_release_lock(spc_hash, entry);
+		pg_atomic_fetch_add_u64(&SharedPlanCache->misses, 1);
+		return NIL;
+	}
+
+	planstr = pnstrdup(data + SPC_PLAN_OFFSET(entry->ndeps, entry->query_len),
+					   entry->plan_len);
+	pg_atomic_fetch_add_u64(&entry->hits, 1);
+	dshash_release_lock(spc_hash, entry);
+
+	pg_atomic_fetch_add_u64(&SharedPlanCache->hits, 1);
+
+	result = (List *) stringToNode(planstr);
+	pfree(planstr);
+
+	/* the statement may sit elsewhere in our source string */
+	foreach(lc, result)
+	{
+		PlannedStmt *plannedstmt = lfirst_node(PlannedStmt, lc);
+
+		plannedstmt->stmt_location = plansource->raw_parse_tree->stmt_location;
+		plannedstmt->stmt_len = plansource->raw_parse_tree->stmt_len;
+	}
+
+	return result;
+}
+
+/*
+ * Publish a freshly built generic plan for plansource.
+ *
+ * "generation" is the value SharedPlanCacheGeneration() returned before
+ * planning started.  If the area has no room left, the plan is simply not
+ * published.
+ */
+void
+SharedPlanCacheInsert(CachedPlanSource *plansource, List *stmt_list,
+					  uint64 generation)
+{
+	SharedPlanKey key;
+	SharedPlanEntry *entry;
+	SharedPlanDepKey *deps;
+	int			ndeps = 0;
+	int			maxdeps = 0;
+	ListCell   *lc;
+	const char *query;
+	int			query_len;
+	char	   *planstr;
+	Size		plan_len;
+	Size		total;
+	dsa_pointer dp;
+	char	   *data;
+	bool		found;
+
+	foreach(lc, stmt_list)
+	{
+		PlannedStmt *plannedstmt = lfirst_node(PlannedStmt, lc);
+
+		/* utility statements aren't planned, transient plans can't be kept */
+		if (plannedstmt->commandType == CMD_UTILITY ||
+			plannedstmt->transientPlan)
+			return;
+
+		maxdeps += list_length(plannedstmt->relationOids) +
+			list_length(plannedstmt->invalItems);
+	}
+
+	/* collect the distinct objects the plan depends on */
+	deps = palloc(Max(maxdeps, 1) * sizeof(SharedPlanDepKey));
+	foreach(lc, stmt_list)
+	{
+		PlannedStmt *plannedstmt = lfirst_node(PlannedStmt, lc);
+		ListCell   *lc2;
+
+		foreach(lc2, plannedstmt->relationOids)
+		{
+			SharedPlanDepKey dep;
+
+			memset(&dep, 0, sizeof(dep));
+			dep.cacheid = SPC_DEP_RELATION;
+			dep.value = (uint32) lfirst_oid(lc2);
+			for (int i = 0; i <= ndeps; i++)
+			{
+				if (i == ndeps)
+				{
+					deps[ndeps++] = dep;
+					break;
+				}
+				if (memcmp(&deps[i], &dep, sizeof(dep)) == 0)
+					break;
+			}
+		}
+		foreach(lc2, plannedstmt->invalItems)
+		{
+			PlanInvalItem *item = lfirst_node(PlanInvalItem, lc2);
+			SharedPlanDepKey dep;
+
+			memset(&dep, 0, sizeof(dep));
+			dep.cacheid = item->cacheId;
+			dep.value = item->hashValue;
+			for (int i = 0; i <= ndeps; i++)
+			{
+				if (i == ndeps)
+				{
+					deps[ndeps++] = dep;
+					break;
+				}
+				if (memcmp(&deps[i], &dep, sizeof(dep)) == 0)
+					break;
+			}
+		}
+	}
+
+	spc_attach();
+	spc_process_pending();
+	spc_compute_key(plansource, &key);
+
+	query = spc_statement_text(plansource, &query_len);
+	planstr = nodeToString(stmt_list);
+	plan_len = strlen(planstr);
+	total = SPC_PLAN_OFFSET(ndeps, query_len) + plan_len + 1;
+
+	dp = dsa_allocate_extended(spc_area, total, DSA_ALLOC_NO_OOM);
+	if (!DsaPointerIsValid(dp))
+	{
+		/* the cache is full */
+		pfree(planstr);
+		pfree(deps);
+		return;
+	}
+
+	data = dsa_get_address(spc_area, dp);
+	memcpy(data, deps, ndeps * sizeof(SharedPlanDepKey));
+	memcpy(data + SPC_QUERY_OFFSET(ndeps), query, query_len);
+	data[SPC_QUERY_OFFSET(ndeps) + query_len] = '\0';
+	memcpy(data + SPC_PLAN_OFFSET(ndeps, query_len), planstr, plan_len + 1);
+	pfree(planstr);
+
+	entry = dshash_find_or_insert_extended(spc_hash, &key, &found,
+										   DSHASH_INSERT_NO_OOM);
+	if (entry == NULL || found)
+	{
+		/* the cache is full, or someone else published it first */
+		if (entry != NULL)
+			dshash_release_lock(spc_hash, entry);
+		dsa_free(spc_area, dp);
+		pfree(deps);
+		return;
+	}
+	entry->data = dp;
+	entry->ndeps = ndeps;
+	entry->query_len = query_len;
+	entry->plan_len = plan_len;
+	pg_atomic_init_u64(&entry->hits, 0);
+	dshash_release_lock(spc_hash, entry);
+
+	pg_atomic_fetch_add_u32(&SharedPlanCache->nentries, 1);
+	pg_atomic_fetch_add_u64(&SharedPlanCache->inserts, 1);
+
+	/*
+	 * Make the plan findable from its dependencies.  That is done after the
+	 * entry exists, so that spc_remove_all, which clears the dependencies
+	 * first, can't leave a plan behind without them.  If there's no room
+	 * for all of them, the plan can't be invalidated reliably; withdraw it.
+	 *
+	 * Likewise, if any invalidation was processed while we planned, our
+	 * plan may already be stale and the backend that processed it may not
+	 * have found our entry.
+	 */
+	for (int i = 0; i < ndeps; i++)
+	{
+		if (!spc_link_dep(&deps[i], &key))
+		{
+			spc_remove_plan(&key, dp);
+			pfree(deps);
+			return;
+		}
+	}
+	pfree(deps);
+
+	if (SharedPlanCacheGeneration() != generation)
+		spc_remove_plan(&key, dp);
+}
+
+/*
+ * Record that the plan with the given key depends on "dep".  Returns false
+ * if there's no room left to do so.
+ */
+static bool
+spc_link_dep(SharedPlanDepKey *dep, SharedPlanKey *key)
+{
+	SharedPlanDepEntry *entry;
+	SharedPlanKey *plans;
+	bool		found;
+
+	entry = dshash_find_or_insert_extended(spc_dep_hash, dep, &found,
+										   DSHASH_INSERT_NO_OOM);
+	if (entry == NULL)
+		return false;
+	if (!found)
+	{
+		entry->plans = InvalidDsaPointer;
+		entry->nplans = 0;
+		entry->maxplans = 0;
+	}
+
+	if (entry->nplans >= entry->maxplans)
+	{
+		int			newmax = Max(entry->maxplans * 2, 4);
+		dsa_pointer newplans;
+
+		newplans = dsa_allocate_extended(spc_area,
+										 newmax * sizeof(SharedPlanKey),
+										 DSA_ALLOC_NO_OOM);
+		if (!DsaPointerIsValid(newplans))
+		{
+			if (entry->nplans == 0)
+				dshash_delete_entry(spc_dep_hash, entry);
+			else
+				dshash_release_lock(spc_dep_hash, entry);
+			return false;
+		}
+		if (entry->nplans > 0)
+		{
+			memcpy(dsa_get_address(spc_area, newplans),
+				   dsa_get_address(spc_area, entry->plans),
+				   entry->nplans * sizeof(SharedPlanKey));
+			dsa_free(spc_area, entry->plans);
+		}
+		entry->plans = newplans;
+		entry->maxplans = newmax;
+	}
+
+	plans = dsa_get_address(spc_area, entry->plans);
+	plans[entry->nplans++] = *key;
+	dshash_release_lock(spc_dep_hash, entry);
+
+	return true;
+}
+
+/*
+ * Forget that the plan with the given key depends on "dep".
+ */
+static void
+spc_unlink_dep(SharedPlanDepKey *dep, SharedPlanKey *key)
+{
+	SharedPlanDepEntry *entry;
+	SharedPlanKey *plans;
+
+	entry = dshash_find(spc_dep_hash, dep, true);
+	if (entry == NULL)
+		return;
+
+	plans = dsa_get_address(spc_area, entry->plans);
+	for (int i = 0; i < entry->nplans; i++)
+	{
+		if (memcmp(&plans[i], key, sizeof(SharedPlanKey)) == 0)
+		{
+			plans[i] = plans[--entry->nplans];
+			break;
+		}
+	}
+
+	if (entry->nplans == 0)
+	{
+		dsa_free(spc_area, entry->plans);
+		dshash_delete_entry(spc_dep_hash, entry);
+	}
+	else
+		dshash_release_lock(spc_dep_hash, entry);
+}
+
+/*
+ * Remove the plan with the given key, if it is still there.  If "expected"
+ * is valid, only remove it if its data is still that chunk, that is, if no
+ * one has replaced it in the meantime.
+ *
+ * This and spc_remove_dependents don't allocate memory, since they run
+ * after commit; see SharedPlanCacheInvalidate.
+ */
+static void
+spc_remove_plan(SharedPlanKey *key, dsa_pointer expected)
+{
+	SharedPlanEntry *entry;
+	SharedPlanDepKey *deps;
+	dsa_pointer data;
+	int			ndeps;
+
+	entry = dshash_find(spc_hash, key, true);
+	if (entry == NULL)
+		return;
+	if (DsaPointerIsValid(expected) && entry->data != expected)
+	{
+		dshash_release_lock(spc_hash, entry);
+		return;
+	}
+
+	/* once the entry is gone, its data is ours */
+	data = entry->data;
+	ndeps = entry->ndeps;
+	dshash_delete_entry(spc_hash, entry);
+	pg_atomic_fetch_sub_u32(&SharedPlanCache->nentries, 1);
+	pg_atomic_fetch_add_u64(&SharedPlanCache->removals, 1);
+
+	deps = dsa_get_address(spc_area, data);
+	for (int i = 0; i < ndeps; i++)
+		spc_unlink_dep(&deps[i], key);
+	dsa_free(spc_area, data);
+}
+
+/*
+ * Remove all plans depending on "dep".
+ *
+ * The plans are taken off the dependency's list one at a time, since the
+ * list can't stay locked while spc_remove_plan locks the other dependencies
+ * of each plan.
+ */
+static void
+spc_remove_dependents(SharedPlanDepKey *dep)
+{
+	for (;;)
+	{
+		SharedPlanDepEntry *entry;
+		SharedPlanKey key;
+
+		entry = dshash_find(spc_dep_hash, dep, true);
+		if (entry == NULL)
+			return;
+
+		Assert(entry->nplans > 0);
+		key = ((SharedPlanKey *) dsa_get_address(spc_area, entry->plans))[--entry->nplans];
+		if (entry->nplans == 0)
+		{
+			dsa_free(spc_area, entry->plans);
+			dshash_delete_entry(spc_dep_hash, entry);
+		}
+		else
+			dshash_release_lock(spc_dep_hash, entry);
+
+		spc_remove_plan(&key, InvalidDsaPointer);
+	}
+}
+
+/*
+ * Remove all plans.  The dependencies go first; see SharedPlanCacheInsert.
+ */
+static void
+spc_remove_all(void)
+{
+	dshash_seq_status status;
+	SharedPlanDepEntry *dep;
+	SharedPlanEntry *entry;
+
+	dshash_seq_init(&status, spc_dep_hash, true);
+	while ((dep = dshash_seq_next(&status)) != NULL)
+	{
+		dsa_free(spc_area, dep->plans);
+		dshash_delete_current(&status);
+	}
+	dshash_seq_term(&status);
+
+	dshash_seq_init(&status, spc_hash, true);
+	while ((entry = dshash_seq_next(&status)) != NULL)
+	{
+		dsa_free(spc_area, entry->data);
+		dshash_delete_current(&status);
+		pg_atomic_fetch_sub_u32(&SharedPlanCache->nentries, 1);
+		pg_atomic_fetch_add_u64(&SharedPlanCache->removals, 1);
+	}
+	dshash_seq_term(&status);
+}
+
+/*
+ * Remember an invalidation, to be applied by spc_process_pending.
+ *
+ * This runs from invalidation callbacks, possibly right after commit, so it
+ * must not touch the DSA area or allocate memory.
+ */
+static void
+spc_queue_removal(int cacheid, uint32 value, bool all)
+{
+	if (SharedPlanCache == NULL)
+		return;
+
+	/* must come before the entries are removed, see SharedPlanCacheInsert */
+	pg_atomic_fetch_add_u64(&SharedPlanCache->generation, 1);
+
+	spc_register_exit();
+
+	if (all)
+		spc_pending_all = true;
+	if (spc_pending_all)
+		return;
+
+	for (int i = 0; i < spc_npending; i++)
+	{
+		if (spc_pending[i].cacheid == cacheid && spc_pending[i].value == value)
+			return;
+	}
+	if (spc_npending >= SPC_MAX_PENDING)
+	{
+		spc_pending_all = true;
+		return;
+	}
+	memset(&spc_pending[spc_npending], 0, sizeof(SharedPlanDepKey));
+	spc_pending[spc_npending].cacheid = cacheid;
+	spc_pending[spc_npending].value = value;
+	spc_npending++;
+}
+
+/*
+ * Apply the invalidations remembered by spc_queue_removal.
+ */
+static void
+spc_process_pending(void)
+{
+	if (spc_npending == 0 && !spc_pending_all)
+		return;
+
+	spc_attach();
+
+	if (spc_pending_all)
+	{
+		spc_pending_all = false;
+		spc_npending = 0;
+		spc_remove_all();
+		return;
+	}
+
+	while (spc_npending > 0)
+	{
+		SharedPlanDepKey dep = spc_pending[--spc_npending];
+
+		spc_remove_dependents(&dep);
+	}
+}
+
+/*
+ * Invalidation entry points, called from the plan cache's callbacks.
+ */
+void
+SharedPlanCacheInvalidateRelation(Oid relid)
+{
+	spc_queue_removal(SPC_DEP_RELATION, (uint32) relid, !OidIsValid(relid));
+}
+
+void
+SharedPlanCacheInvalidateObject(int cacheid, uint32 hashvalue)
+{
+	/* a zero hash value means all entries of the catcache */
+	spc_queue_removal(cacheid, hashvalue, hashvalue == 0);
+}
+
+void
+SharedPlanCacheReset(void)
+{
+	spc_queue_removal(0, 0, true);
+}
+
+/*
+ * Attach to the shared area ahead of SharedPlanCacheInvalidate, which runs
+ * after commit or in a critical section and so must not allocate memory.
+ */
+void
+SharedPlanCachePrepareInvalidate(void)
+{
+	if (SharedPlanCache != NULL)
+		spc_attach();
+}
+
+/*
+ * Remove the plans made stale by invalidation messages about to be sent.
+ *
+ * This mirrors what the plan cache's callbacks do with the messages, but
+ * acts on the shared entries right away.  It doesn't allocate memory, so it
+ * can run after commit or in a critical section;
+ * SharedPlanCachePrepareInvalidate must have been called first.
+ */
+void
+SharedPlanCacheInvalidate(const SharedInvalidationMessage *msgs, int n)
+{
+	bool		all = false;
+
+	if (SharedPlanCache == NULL || n == 0)
+		return;
+
+	Assert(spc_hash != NULL);
+
+	/* must come before the entries are removed, see SharedPlanCacheInsert */
+	pg_atomic_fetch_add_u64(&SharedPlanCache->generation, 1);
+
+	for (int i = 0; i < n && !all; i++)
+	{
+		const SharedInvalidationMessage *msg = &msgs[i];
+		SharedPlanDepKey dep;
+
+		memset(&dep, 0, sizeof(dep));
+		if (msg->id >= 0)
+		{
+			switch (msg->cc.id)
+			{
+				case PROCOID:
+				case TYPEOID:
+				case PKGOID:
+					dep.cacheid = msg->cc.id;
+					dep.value = msg->cc.hashValue;
+					break;
+				case PKGBODYPKGOID:
+					/* see PlanCachePackageBodyCallback */
+					all = true;
+					continue;
+				case NAMESPACEOID:
+				case OPEROID:
+				case AMOPOPID:
+				case FOREIGNSERVEROID:
+				case FOREIGNDATAWRAPPEROID:
+					all = true;
+					continue;
+				default:
+					continue;
+			}
+		}
+		else if (msg->id == SHAREDINVALRELCACHE_ID)
+		{
+			if (!OidIsValid(msg->rc.relId))
+			{
+				all = true;
+				continue;
+			}
+			dep.cacheid = SPC_DEP_RELATION;
+			dep.value = (uint32) msg->rc.relId;
+		}
+		else if (msg->id == SHAREDINVALCATALOG_ID)
+		{
+			/* a whole catalog was reset; don't bother finding out which */
+			all = true;
+			continue;
+		}
+		else
+			continue;
+
+		spc_remove_dependents(&dep);
+	}
+
+	if (all)
+		spc_remove_all();
+}
+
+/*
+ * SQL-callable function reporting the cache's activity
+ */
+Datum
+pg_shared_plan_cache_stats(PG_FUNCTION_ARGS)
+{
+#define PG_SHARED_PLAN_CACHE_STATS_COLS	5
+	TupleDesc	tupdesc;
+	Datum		values[PG_SHARED_PLAN_CACHE_STATS_COLS] = {0};
+	bool		nulls[PG_SHARED_PLAN_CACHE_STATS_COLS] = {0};
+
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	if (SharedPlanCache == NULL)
+	{
+		for (int i = 0; i < PG_SHARED_PLAN_CACHE_STATS_COLS; i++)
+			values[i] = Int64GetDatum(0);
+	}
+	else
+	{
+		values[0] = Int64GetDatum((int64) pg_atomic_read_u32(&SharedPlanCache->nentries));
+		values[1] = Int64GetDatum((int64) pg_atomic_read_u64(&SharedPlanCache->hits));
+		values[2] = Int64GetDatum((int64) pg_atomic_read_u64(&SharedPlanCache->misses));
+		values[3] = Int64GetDatum((int64) pg_atomic_read_u64(&SharedPlanCache->inserts));
+		values[4] = Int64GetDatum((int64) pg_atomic_read_u64(&SharedPlanCache->removals));
+	}
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
@@ -0,0 +1,608 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedtsdict.c
+ *	  Cross-backend store of loaded text search dictionaries.
+ *
+ * Loading a large Ispell or Hunspell dictionary takes a noticeable time and
+ * a lot of memory, and every backend that uses the dictionary normally does
+ * it again and keeps its own copy.  When shared_ts_dictionary_size is set,
+ * the first backend to load a dictionary of a template that supports it
+ * copies the result into shared memory, and other backends of the same
+ * database use that copy read-only instead of loading the dictionary
+ * themselves.  See ts_cache.c for the templates that can be shared.
+ *
+ * A published dictionary is identified by its OID and the xmin of its
+ * pg_ts_dict row, so ALTER TEXT SEARCH DICTIONARY, which is also how
+ * sessions are told to reread a dictionary's files, makes backends load and
+ * publish it anew.  The first backend that finds a version other than the
+ * one its catalog snapshot shows removes the old one.  Published
+ * dictionaries are reference counted by the backends' dictionary caches, and
+ * the memory of a removed one is freed once nobody uses it anymore.
+ *
+ * The shared memory is a fixed-size DSA area created in place in the main
+ * shared memory segment, so it never grows beyond shared_ts_dictionary_size.
+ * As that segment is mapped at the same address in every backend, so is the
+ * area, and the copied dictionaries keep using plain pointers.  When the
+ * area is full, dictionaries no backend is using are removed to make room;
+ * if that doesn't help, the dictionary is not published.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/cache/sharedtsdict.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "storage/ipc.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/builtins.h"
+#include "utils/dsa.h"
+#include "utils/memutils.h"
+#include "utils/sharedtsdict.h"
+
+
+/* GUC parameter: size of the shared area in kB, 0 disables sharing */
+int			shared_ts_dictionary_size = 0;
+
+/* smallest area we bother to create */
+#define SHARED_TS_DICT_MIN_SIZE		(1024 * 1024)
+
+/* maximum number of published dictionaries */
+#define SHARED_TS_DICT_SLOTS		64
+
+/* dictionaries are copied into chunks of this size */
+#define SHARED_TS_DICT_CHUNK_SIZE	(64 * 1024)
+
+/* header of a chunk, linking all chunks of one dictionary */
+typedef struct SharedTSDictChunk
+{
+	dsa_pointer next;
+} SharedTSDictChunk;
+
+#define SHARED_TS_DICT_CHUNK_HDRSZ	MAXALIGN(sizeof(SharedTSDictChunk))
+
+struct SharedTSDictArena
+{
+	dsa_pointer chunks;			/* list of chunks allocated so far */
+	char	   *firstfree;		/* free space in the current chunk */
+	Size		avail;
+	Size		size;			/* total size of all chunks */
+	bool		failed;			/* did the area run out of space? */
+	MemoryContext fallbackCxt;	/* where the copy continues if so */
+};
+
+typedef struct SharedTSDictSlot
+{
+	bool		inuse;
+	bool		dead;			/* removed, waiting for refcount to drop */
+	Oid			dbId;
+	Oid			dictId;
+	TransactionId xmin;			/* xmin of the pg_ts_dict row */
+	uint32		refcount;		/* number of backends using the copy */
+	uint64		lastused;
+	void	   *image;			/* the copy returned by the copy function */
+	dsa_pointer chunks;
+	Size		size;
+} SharedTSDictSlot;
+
+typedef struct SharedTSDictCtl
+{
+	LWLock		lock;			/* protects everything below */
+	void	   *raw_dsa_area;
+	uint64		clock;			/* source of lastused values */
+	uint64		hits;
+	uint64		misses;
+	uint64		inserts;
+	uint64		removals;
+	SharedTSDictSlot slots[SHARED_TS_DICT_SLOTS];
+} SharedTSDictCtl;
+
+static SharedTSDictCtl *SharedTSDict = NULL;
+
+/* this backend's attachment, set up on first use */
+static dsa_area *std_area = NULL;
+
+static Size shared_ts_dictionary_area_size(void);
+static void std_attach(void);
+static void std_detach(int code, Datum arg);
+static void std_free_chunks(dsa_pointer dp);
+static SharedTSDictSlot *std_find_slot(Oid dictId);
+static void std_remove_slot(SharedTSDictSlot *slot);
+static bool std_remove_unused(void);
+static void *std_copy(SharedTSDictArena *arena, SharedTSDictCopyFn copy,
+					  void *dictData);
+static void std_discard(SharedTSDictArena *arena);
+
+
+static Size
+shared_ts_dictionary_area_size(void)
+{
+	Size		sz;
+
+	sz = mul_size((Size) shared_ts_dictionary_size, 1024);
+	sz = Max(sz, SHARED_TS_DICT_MIN_SIZE);
+	return MAXALIGN(sz);
+}
+
+/*
+ * Report shared memory space needed by SharedTSDictShmemInit
+ */
+Size
+SharedTSDictShmemSize(void)
+{
+	Size		sz;
+
+	if (shared_ts_dictionary_size <= 0)
+		return 0;
+
+	sz = MAXALIGN(sizeof(SharedTSDictCtl));
+	sz = add_size(sz, shared_ts_dictionary_area_size());
+	return sz;
+}
+
+/*
+ * Allocate and initialize the shared dictionary store, if enabled
+ */
+void
+SharedTSDictShmemInit(void)
+{
+	bool		found;
+
+	if (shared_ts_dictionary_size <= 0)
+		return;
+
+	SharedTSDict = (SharedTSDictCtl *)
+		ShmemInitStruct("Shared Text Search Dictionaries",
+						SharedTSDictShmemSize(), &found);
+
+	if (!IsUnderPostmaster)
+	{
+		SharedTSDictCtl *ctl = SharedTSDict;
+		dsa_area   *dsa;
+
+		Assert(!found);
+
+		memset(ctl, 0, sizeof(SharedTSDictCtl));
+		LWLockInitialize(&ctl->lock, LWTRANCHE_SHARED_TS_DICTIONARY);
+
+		ctl->raw_dsa_area = (char *) ctl + MAXALIGN(sizeof(SharedTSDictCtl));
+		dsa = dsa_create_in_place(ctl->raw_dsa_area,
+								  shared_ts_dictionary_area_size(),
+								  LWTRANCHE_SHARED_TS_DICTIONARY_DSA, NULL);
+		dsa_pin(dsa);
+
+		/*
+		 * Never grow into dynamic shared memory segments, which could be
+		 * mapped at different addresses in different backends.
+		 */
+		dsa_set_size_limit(dsa, shared_ts_dictionary_area_size());
+
+		/* postmaster will never access the area again */
+		dsa_detach(dsa);
+	}
+	else
+		Assert(found);
+}
+
+static void
+std_attach(void)
+{
+	MemoryContext oldcontext;
+
+	if (std_area != NULL)
+		return;
+
+	oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+	std_area = dsa_attach_in_place(SharedTSDict->raw_dsa_area, NULL);
+	dsa_pin_mapping(std_area);
+	MemoryContextSwitchTo(oldcontext);
+
+	before_shmem_exit(std_detach, (Datum) 0);
+}
+
+static void
+std_detach(int code, Datum arg)
+{
+	dsa_detach(std_area);
+	std_area = NULL;
+
+	/* dsa_detach() doesn't drop the reference of an in-place area */
+	dsa_release_in_place(SharedTSDict->raw_dsa_area);
+}
+
+/*
+ * Is sharing of text search dictionaries configured?
+ */
+bool
+SharedTSDictEnabled(void)
+{
+	return SharedTSDict != NULL;
+}
+
+static void
+std_free_chunks(dsa_pointer dp)
+{
+	while (DsaPointerIsValid(dp))
+	{
+		SharedTSDictChunk *chunk = dsa_get_address(std_area, dp);
+		dsa_pointer next = chunk->next;
+
+		dsa_free(std_area, dp);
+		dp = next;
+	}
+}
+
+/* Find the live slot of a dictionary of our database; caller holds lock */
+static SharedTSDictSlot *
+std_find_slot(Oid dictId)
+{
+	for (int i = 0; i < SHARED_TS_DICT_SLOTS; i++)
+	{
+		SharedTSDictSlot *slot = &SharedTSDict->slots[i];
+
+		if (slot->inuse && !slot->dead &&
+			slot->dbId == MyDatabaseId && slot->dictId == dictId)
+			return slot;
+	}
+	return NULL;
+}
+
+/* Remove a published dictionary; caller holds lock exclusively */
+static void
+std_remove_slot(SharedTSDictSlot *slot)
+{
+	Assert(slot->inuse && !slot->dead);
+
+	SharedTSDict->removals++;
+	if (slot->refcount > 0)
+		slot->dead = true;
+	else
+	{
+		std_free_chunks(slot->chunks);
+		memset(slot, 0, sizeof(SharedTSDictSlot));
+	}
+}
+
+/*
+ * Remove all published dictionaries no backend is using.  Returns true if
+ * there were any.
+ */
+static bool
+std_remove_unused(void)
+{
+	bool		removed = false;
+
+	LWLockAcquire(&SharedTSDict->lock, LW_EXCLUSIVE);
+	for (int i = 0; i < SHARED_TS_DICT_SLOTS; i++)
+	{
+		SharedTSDictSlot *slot = &SharedTSDict->slots[i];
+
+		if (slot->inuse && !slot->dead && slot->refcount == 0)
+		{
+			std_remove_slot(slot);
+			removed = true;
+		}
+	}
+	LWLockRelease(&SharedTSDict->lock);
+
+	return removed;
+}
+
+/*
+ * Look for a published copy of a dictionary.
+ *
+ * "xmin" is that of the dictionary's pg_ts_dict row.  On success, *image is
+ * set to the copy, and a reference is returned that keeps it alive until
+ * passed to SharedTSDictRelease.  Returns NULL if there is no such copy.
+ */
+void *
+SharedTSDictLookup(Oid dictId, TransactionId xmin, void **image)
+{
+	SharedTSDictSlot *slot;
+	SharedTSDictSlot *result = NULL;
+
+	std_attach();
+
+	LWLockAcquire(&SharedTSDict->lock, LW_EXCLUSIVE);
+	slot = std_find_slot(dictId);
+	if (slot != NULL && slot->xmin == xmin)
+	{
+		slot->refcount++;
+		slot->lastused = ++SharedTSDict->clock;
+		*image = slot->image;
+		result = slot;
+		SharedTSDict->hits++;
+	}
+	else
+	{
+		/* a different version of the dictionary is no longer of use */
+		if (slot != NULL)
+			std_remove_slot(slot);
+		SharedTSDict->misses++;
+	}
+	LWLockRelease(&SharedTSDict->lock);
+
+	return result;
+}
+
+/*
+ * Copy a dictionary into the arena, discarding the copy if that fails.
+ */
+static void *
+std_copy(SharedTSDictArena *arena, SharedTSDictCopyFn copy, void *dictData)
+{
+	void	   *result;
+
+	memset(arena, 0, sizeof(SharedTSDictArena));
+	arena->chunks = InvalidDsaPointer;
+
+	PG_TRY();
+	{
+		result = copy(dictData, arena);
+	}
+	PG_CATCH();
+	{
+		std_discard(arena);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	return result;
+}
+
+/* Free whatever the arena has allocated */
+static void
+std_discard(SharedTSDictArena *arena)
+{
+	std_free_chunks(arena->chunks);
+	arena->chunks = InvalidDsaPointer;
+	if (arena->fallbackCxt)
+		MemoryContextDelete(arena->fallbackCxt);
+	arena->fallbackCxt = NULL;
+}
+
+/*
+ * Publish a dictionary just loaded by this backend.
+ *
+ * "copy" is the template's function to copy "dictData" into shared memory.
+ * On success, *image is set to the published copy and a reference to it is
+ * returned as for SharedTSDictLookup; the copy may be one published by
+ * another backend in the meantime.  Returns NULL if the dictionary could not
+ * be published.
+ */
+void *
+SharedTSDictPublish(Oid dictId, TransactionId xmin, SharedTSDictCopyFn copy,
+					void *dictData, void **image)
+{
+	SharedTSDictArena arena;
+	SharedTSDictSlot *slot;
+	void	   *result;
+
+	std_attach();
+
+	result = std_copy(&arena, copy, dictData);
+	if (arena.failed)
+	{
+		/* make room, and try once more */
+		std_discard(&arena);
+		if (!std_remove_unused())
+			return NULL;
+
+		result = std_copy(&arena, copy, dictData);
+		if (arena.failed)
+		{
+			std_discard(&arena);
+			return NULL;
+		}
+	}
+
+	LWLockAcquire(&SharedTSDict->lock, LW_EXCLUSIVE);
+
+	slot = std_find_slot(dictId);
+	if (slot != NULL && slot->xmin == xmin)
+	{
+		/* someone else published it first, use theirs */
+		slot->refcount++;
+		slot->lastused = ++SharedTSDict->clock;
+		*image = slot->image;
+		LWLockRelease(&SharedTSDict->lock);
+
+		std_discard(&arena);
+		return slot;
+	}
+	if (slot != NULL)
+		std_remove_slot(slot);
+
+	/* find a free slot, or else the least recently used unused one */
+	slot = NULL;
+	for (int i = 0; i < SHARED_TS_DICT_SLOTS; i++)
+	{
+		SharedTSDictSlot *cur = &SharedTSDict->slots[i];
+
+		if (!cur->inuse)
+		{
+			slot = cur;
+			break;
+		}
+		if (!cur->dead && cur->refcount == 0 &&
+			(slot == NULL || cur->lastused < slot->lastused))
+			slot = cur;
+	}
+	if (slot == NULL)
+	{
+		LWLockRelease(&SharedTSDict->lock);
+
+		std_discard(&arena);
+		return NULL;
+	}
+	if (slot->inuse)
+		std_remove_slot(slot);
+
+	slot->inuse = true;
+	slot->dead = false;
+	slot->dbId = MyDatabaseId;
+	slot->dictId = dictId;
+	slot->xmin = xmin;
+	slot->refcount = 1;
+	slot->lastused = ++SharedTSDict->clock;
+	slot->image = result;
+	slot->chunks = arena.chunks;
+	slot->size = arena.size;
+	SharedTSDict->inserts++;
+
+	LWLockRelease(&SharedTSDict->lock);
+
+	*image = result;
+	return slot;
+}
+
+/*
+ * Drop a reference returned by SharedTSDictLookup or SharedTSDictPublish.
+ */
+void
+SharedTSDictRelease(void *ref)
+{
+	SharedTSDictSlot *slot = (SharedTSDictSlot *) ref;
+
+	LWLockAcquire(&SharedTSDict->lock, LW_EXCLUSIVE);
+	Assert(slot->inuse && slot->refcount > 0);
+	slot->refcount--;
+	if (slot->dead && slot->refcount == 0)
+	{
+		std_free_chunks(slot->chunks);
+		memset(slot, 0, sizeof(SharedTSDictSlot));
+	}
+	LWLockRelease(&SharedTSDict->lock);
+}
+
+/*
+ * Allocate zeroed memory for a dictionary being copied into shared memory.
+ *
+ * Like the compact allocator of spell.c, this carves small requests out of
+ * bigger chunks and never frees them individually.  If the area runs out of
+ * space, the rest of the copy is made in local memory, so that the copy
+ * functions needn't check for failure; the copy is thrown away afterwards.
+ */
+void *
+SharedTSDictAlloc(SharedTSDictArena *arena, Size size)
+{
+	char	   *result;
+
+	size = MAXALIGN(size);
+
+	if (size > arena->avail && !arena->failed)
+	{
+		/* big requests get a chunk of their own */
+		bool		dedicated = (size > SHARED_TS_DICT_CHUNK_SIZE / 4);
+		Size		chunksize;
+		dsa_pointer dp;
+
+		if (dedicated)
+			chunksize = SHARED_TS_DICT_CHUNK_HDRSZ + size;
+		else
+			chunksize = SHARED_TS_DICT_CHUNK_SIZE;
+
+		dp = dsa_allocate_extended(std_area, chunksize,
+								   DSA_ALLOC_NO_OOM | DSA_ALLOC_ZERO |
+								   DSA_ALLOC_HUGE);
+		if (DsaPointerIsValid(dp))
+		{
+			SharedTSDictChunk *chunk = dsa_get_address(std_area, dp);
+
+			Assert(ShmemAddrIsValid(chunk));
+
+			chunk->next = arena->chunks;
+			arena->chunks = dp;
+			arena->size += chunksize;
+
+			if (dedicated)
+				return (char *) chunk + SHARED_TS_DICT_CHUNK_HDRSZ;
+
+			arena->firstfree = (char *) chunk + SHARED_TS_DICT_CHUNK_HDRSZ;
+			arena->avail = chunksize - SHARED_TS_DICT_CHUNK_HDRSZ;
+		}
+		else
+		{
+			arena->failed = true;
+			arena->fallbackCxt =
+				AllocSetContextCreate(CurrentMemoryContext,
+									  "text search dictionary copy",
+									  ALLOCSET_DEFAULT_SIZES);
+		}
+	}
+
+	if (arena->failed)
+		return MemoryContextAllocZero(arena->fallbackCxt, size);
+
+	result = arena->firstfree;
+	arena->firstfree += size;
+	arena->avail -= size;
+
+	return result;
+}
+
+/*
+ * Copy a string into the arena
+ */
+char *
+SharedTSDictStrdup(SharedTSDictArena *arena, const char *str)
+{
+	Size		len = strlen(str) + 1;
+	char	   *result = SharedTSDictAlloc(arena, len);
+
+	memcpy(result, str, len);
+	return result;
+}
+
+/*
+ * SQL-callable function reporting the store's activity
+ */
+Datum
+pg_shared_ts_dictionary_stats(PG_FUNCTION_ARGS)
+{
+#define PG_SHARED_TS_DICTIONARY_STATS_COLS	6
+	TupleDesc	tupdesc;
+	Datum		values[PG_SHARED_TS_DICTIONARY_STATS_COLS] = {0};
+	bool		nulls[PG_SHARED_TS_DICTIONARY_STATS_COLS] = {0};
+	int64		entries = 0;
+	int64		bytes = 0;
+
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	if (SharedTSDict == NULL)
+	{
+		for (int i = 0; i < PG_SHARED_TS_DICTIONARY_STATS_COLS; i++)
+			values[i] = Int64GetDatum(0);
+	}
+	else
+	{
+		LWLockAcquire(&SharedTSDict->lock, LW_SHARED);
+		for (int i = 0; i < SHARED_TS_DICT_SLOTS; i++)
+		{
+			SharedTSDictSlot *slot = &SharedTSDict->slots[i];
+
+			if (slot->inuse)
+			{
+				if (!slot->dead)
+					entries++;
+				bytes += slot->size;
+			}
+		}
+		values[0] = Int64GetDatum(entries);
+		values[1] = Int64GetDatum(bytes);
+		values[2] = Int64GetDatum((int64) SharedTSDict->hits);
+		values[3] = Int64GetDatum((int64) SharedTSDict->misses);
+		values[4] = Int64GetDatum((int64) SharedTSDict->inserts);
+		values[5] = Int64GetDatum((int64) SharedTSDict->removals);
+		LWLockRelease(&SharedTSDict->lock);
+	}
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
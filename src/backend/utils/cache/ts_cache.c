@@ -39,6 +39,7 @@
 #include "commands/defrem.h"
 #include "miscadmin.h"
 #include "nodes/miscnodes.h"
+#include "storage/ipc.h"
 #include "tsearch/ts_cache.h"
 #include "utils/builtins.h"
 #include "utils/catcache.h"
@@ -48,6 +49,7 @@
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/regproc.h"
+#include "utils/sharedtsdict.h"
 #include "utils/syscache.h"
 
 
@@ -70,6 +72,24 @@ static TSDictionaryCacheEntry *lastUsedDictionary = NULL;
 static HTAB *TSConfigCacheHash = NULL;
 static TSConfigCacheEntry *lastUsedConfig = NULL;
 
+/*
+ * Templates whose dictionaries can be kept in shared memory when
+ * shared_ts_dictionary_size is set, see sharedtsdict.c.  The thesaurus
+ * template is not among them because its lexize method modifies the
+ * dictionary.
+ */
+typedef struct TSSharedTemplate
+{
+	Oid			initOid;
+	SharedTSDictCopyFn copy;
+	SharedTSDictAttachFn attach;
+} TSSharedTemplate;
+
+static const TSSharedTemplate TSSharedTemplates[] = {
+	{F_DISPELL_INIT, dispell_copy_shared, dispell_attach_shared},
+	{F_DSYNONYM_INIT, dsynonym_copy_shared, dsynonym_attach_shared},
+};
+
 /*
  * GUC default_text_search_config, and a cache of the current config's OID
  */
@@ -201,6 +221,75 @@ lookup_ts_parser_cache(Oid prsId)
 	return entry;
 }
 
+/*
+ * Drop this backend's references to shared dictionaries at exit
+ */
+static void
+ReleaseSharedTSDictionaries(int code, Datum arg)
+{
+	HASH_SEQ_STATUS status;
+	TSDictionaryCacheEntry *entry;
+
+	hash_seq_init(&status, TSDictionaryCacheHash);
+	while ((entry = (TSDictionaryCacheEntry *) hash_seq_search(&status)) != NULL)
+	{
+		if (entry->sharedRef)
+		{
+			SharedTSDictRelease(entry->sharedRef);
+			entry->sharedRef = NULL;
+		}
+	}
+}
+
+/*
+ * Initialize a dictionary of a template that supports sharing: use the copy
+ * in shared memory if there is one, else load the dictionary and try to
+ * publish it.  Called in the dictionary's private memory context.
+ */
+static void *
+init_shared_dictionary(TSDictionaryCacheEntry *entry,
+					   const TSSharedTemplate *shtmpl, List *dictoptions,
+					   TransactionId xmin)
+{
+	static bool release_registered = false;
+	MemoryContext buildCtx;
+	void	   *dictData;
+	void	   *image;
+
+	entry->sharedRef = SharedTSDictLookup(entry->dictId, xmin, &image);
+	if (entry->sharedRef == NULL)
+	{
+		/*
+		 * Load the dictionary in a child context, which can go away once the
+		 * dictionary has been copied to shared memory.
+		 */
+		buildCtx = AllocSetContextCreate(entry->dictCtx,
+										 "TS dictionary build",
+										 ALLOCSET_DEFAULT_SIZES);
+		MemoryContextSwitchTo(buildCtx);
+		dictData = DatumGetPointer(OidFunctionCall1(shtmpl->initOid,
+													PointerGetDatum(dictoptions)));
+		MemoryContextSwitchTo(entry->dictCtx);
+
+		entry->sharedRef = SharedTSDictPublish(entry->dictId, xmin,
+											   shtmpl->copy, dictData,
+											   &image);
+		if (entry->sharedRef == NULL)
+			return dictData;
+
+		MemoryContextDelete(buildCtx);
+	}
+
+	/* must come after the store's own exit callback, so register late */
+	if (!release_registered)
+	{
+		before_shmem_exit(ReleaseSharedTSDictionaries, (Datum) 0);
+		release_registered = true;
+	}
+
+	return shtmpl->attach(image);
+}
+
 /*
  * Fetch dictionary cache entry
  */
@@ -298,6 +387,11 @@ lookup_ts_dictionary_cache(Oid dictId)
 		}
 		else
 		{
+			/* Drop the old version's shared copy, if it used one */
+			if (entry->sharedRef)
+				SharedTSDictRelease(entry->sharedRef);
+			entry->sharedRef = NULL;
+
 			/* Clear the existing entry's private context */
 			saveCtx = entry->dictCtx;
 			/* Don't let context's ident pointer dangle while we reset it */
@@ -318,6 +412,8 @@ lookup_ts_dictionary_cache(Oid dictId)
 			Datum		opt;
 			bool		isnull;
 			MemoryContext oldcontext;
+			const TSSharedTemplate *shtmpl = NULL;
+			TransactionId xmin = HeapTupleHeaderGetRawXmin(tpdict->t_data);
 
 			/*
 			 * Init method runs in dictionary's private memory context, and we
@@ -333,9 +429,27 @@ lookup_ts_dictionary_cache(Oid dictId)
 			else
 				dictoptions = deserialize_deflist(opt);
 
-			entry->dictData =
-				DatumGetPointer(OidFunctionCall1(template->tmplinit,
-												 PointerGetDatum(dictoptions)));
+			/*
+			 * Dictionaries changed by our own transaction must not be shared
+			 * yet.
+			 */
+			if (SharedTSDictEnabled() &&
+				!TransactionIdIsCurrentTransactionId(xmin))
+			{
+				for (int i = 0; i < lengthof(TSSharedTemplates); i++)
+				{
+					if (TSSharedTemplates[i].initOid == template->tmplinit)
+						shtmpl = &TSSharedTemplates[i];
+				}
+			}
+
+			if (shtmpl)
+				entry->dictData = init_shared_dictionary(entry, shtmpl,
+														 dictoptions, xmin);
+			else
+				entry->dictData =
+					DatumGetPointer(OidFunctionCall1(template->tmplinit,
+													 PointerGetDatum(dictoptions)));
 
 			MemoryContextSwitchTo(oldcontext);
 		}
@@ -67,6 +67,8 @@
 #include "parser/parse_merge.h"
 #include "parser/parser.h"
 #include "pgstat.h"
+#include "postmaster/ash.h"
+#include "postmaster/awr.h"
 #include "postmaster/autovacuum.h"
 #include "postmaster/bgworker_internals.h"
 #include "postmaster/bgwriter.h"
@@ -76,6 +78,7 @@
 #include "postmaster/walsummarizer.h"
 #include "postmaster/walwriter.h"
 #include "replication/logicallauncher.h"
+#include "replication/logicalreadworker.h"
 #include "replication/slot.h"
 #include "replication/slotsync.h"
 #include "replication/syncrep.h"
@@ -98,11 +101,15 @@
 #include "utils/guc_hooks.h"
 #include "utils/guc_tables.h"
 #include "utils/inval.h"
+#include "utils/membroker.h"
 #include "utils/memutils.h"
 #include "utils/pg_locale.h"
 #include "utils/plancache.h"
 #include "utils/ps_status.h"
 #include "utils/rls.h"
+#include "utils/sharedcatcache.h"
+#include "utils/sharedplancache.h"
+#include "utils/sharedtsdict.h"
 #include "utils/xml.h"
 #include "utils/ora_compatible.h"
 
@@ -445,6 +452,18 @@ static const struct config_enum_entry debug_logical_replication_streaming_option
 	{NULL, 0, false}
 };
 
+static const struct config_enum_entry logical_decoding_spill_compression_options[] = {
+	{"pglz", REORDER_BUFFER_SPILL_COMPRESSION_PGLZ, false},
+#ifdef USE_LZ4
+	{"lz4", REORDER_BUFFER_SPILL_COMPRESSION_LZ4, false},
+#endif
+#ifdef USE_ZSTD
+	{"zstd", REORDER_BUFFER_SPILL_COMPRESSION_ZSTD, false},
+#endif
+	{"off", REORDER_BUFFER_SPILL_COMPRESSION_NONE, false},
+	{NULL, 0, false}
+};
+
 StaticAssertDecl(lengthof(ssl_protocol_versions_info) == (PG_TLS1_3_VERSION + 2),
 				 "array length mismatch");
 
@@ -985,6 +1004,16 @@ struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_parallel_dml", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of parallel scans for UPDATE and DELETE."),
+			NULL,
+			GUC_EXPLAIN
+		},
+		&enable_parallel_dml,
+		false,
+		NULL, NULL, NULL
+	},
 	{
 		{"enable_parallel_hash", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of parallel hash plans."),
@@ -1121,6 +1150,15 @@ struct config_bool ConfigureNamesBool[] =
 		false,
 		NULL, NULL, NULL
 	},
+	{
+		{"logical_decoding_read_worker", PGC_USERSET, REPLICATION_SENDING,
+			gettext_noop("Reads WAL for logical decoding in a separate background worker."),
+			NULL
+		},
+		&logical_decoding_read_worker,
+		false,
+		NULL, NULL, NULL
+	},
 	{
 		{"ssl", PGC_SIGHUP, CONN_AUTH_SSL,
 			gettext_noop("Enables SSL connections."),
@@ -2390,6 +2428,39 @@ struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"shared_plan_cache_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the amount of shared memory used to share generic plans between sessions."),
+			gettext_noop("0 disables the shared plan cache."),
+			GUC_UNIT_KB
+		},
+		&shared_plan_cache_size,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"shared_catalog_cache_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the amount of shared memory used to share catalog cache entries between sessions."),
+			gettext_noop("0 disables the shared catalog cache."),
+			GUC_UNIT_KB
+		},
+		&shared_catalog_cache_size,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"shared_ts_dictionary_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the amount of shared memory used to share text search dictionaries between sessions."),
+			gettext_noop("0 disables sharing of text search dictionaries."),
+			GUC_UNIT_KB
+		},
+		&shared_ts_dictionary_size,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
 	/*
 	 * We sometimes multiply the number of shared buffers by two without
 	 * checking for overflow, so we mustn't allow more than INT_MAX / 2.
@@ -2604,6 +2675,19 @@ struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"work_mem_target", PGC_SIGHUP, RESOURCES_MEM,
+			gettext_noop("Sets the memory to be shared by the query workspaces of all sessions."),
+			gettext_noop("When set, sorts, hash tables and materializations are "
+						 "granted memory out of this total instead of using "
+						 "\"work_mem\". 0 disables the limit."),
+			GUC_UNIT_KB
+		},
+		&work_mem_target,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
 	/*
 	 * Dynamic shared memory has a higher overhead than local memory contexts,
 	 * so when testing low-memory scenarios that could use shared memory, the
@@ -3405,6 +3489,31 @@ struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"max_parallel_copy_workers_per_table",
+			PGC_SIGHUP,
+			REPLICATION_SUBSCRIBERS,
+			gettext_noop("Maximum number of workers helping to copy a table during table synchronization."),
+			NULL,
+		},
+		&max_parallel_copy_workers_per_table,
+		0, 0, MAX_PARALLEL_WORKER_LIMIT,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"min_parallel_copy_table_size",
+			PGC_SIGHUP,
+			REPLICATION_SUBSCRIBERS,
+			gettext_noop("Sets the minimum size of a table copied by several workers during table synchronization."),
+			NULL,
+			GUC_UNIT_BLOCKS,
+		},
+		&min_parallel_copy_table_size,
+		(1024 * 1024 * 1024) / BLCKSZ, 0, INT_MAX / 3,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"max_active_replication_origins",
 			PGC_POSTMASTER,
@@ -3799,6 +3908,50 @@ struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"active_session_history_size", PGC_POSTMASTER, STATS_MONITORING,
+			gettext_noop("Sets the amount of shared memory used to keep active session history samples."),
+			gettext_noop("0 disables the active session history sampler."),
+			GUC_UNIT_KB
+		},
+		&active_session_history_size,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"active_session_history_interval", PGC_SIGHUP, STATS_MONITORING,
+			gettext_noop("Sets the time between active session history samples."),
+			NULL,
+			GUC_UNIT_MS
+		},
+		&active_session_history_interval,
+		1000, 10, 3600000,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"workload_repository_interval", PGC_SIGHUP, STATS_MONITORING,
+			gettext_noop("Sets the time between workload repository snapshots."),
+			NULL,
+			GUC_UNIT_MIN
+		},
+		&workload_repository_interval,
+		60, 1, INT_MAX / SECS_PER_MINUTE,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"workload_repository_retention", PGC_SIGHUP, STATS_MONITORING,
+			gettext_noop("Sets the time workload repository snapshots are kept."),
+			gettext_noop("0 keeps snapshots until they are deleted manually."),
+			GUC_UNIT_MIN
+		},
+		&workload_repository_retention,
+		8 * 24 * 60, 0, INT_MAX / SECS_PER_MINUTE,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gin_pending_list_limit", PGC_USERSET, CLIENT_CONN_STATEMENT,
 			gettext_noop("Sets the maximum size of the pending list for GIN index."),
@@ -4929,6 +5082,17 @@ struct config_string ConfigureNamesString[] =
 		check_cluster_name, NULL, NULL
 	},
 
+	{
+		{"workload_repository_database", PGC_POSTMASTER, STATS_MONITORING,
+			gettext_noop("Sets the database in which workload repository snapshots are taken periodically."),
+			gettext_noop("An empty string disables periodic snapshots."),
+			GUC_IS_NAME
+		},
+		&workload_repository_database,
+		"",
+		NULL, NULL, NULL
+	},
+
 	{
 		{"wal_consistency_checking", PGC_SUSET, DEVELOPER_OPTIONS,
 			gettext_noop("Sets the WAL resource managers for which WAL consistency checks are done."),
@@ -5447,6 +5611,16 @@ struct config_enum ConfigureNamesEnum[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"logical_decoding_spill_compression", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Compresses changes that logical decoding spills to disk using the specified method."),
+			NULL
+		},
+		&logical_decoding_spill_compression,
+		REORDER_BUFFER_SPILL_COMPRESSION_NONE, logical_decoding_spill_compression_options,
+		NULL, NULL, NULL
+	},
+
 #define IVY_GUC_ENUM_PARAMS
 #include "ivy_guc.c"
 #undef IVY_GUC_ENUM_PARAMS
@@ -0,0 +1,384 @@
+/*-------------------------------------------------------------------------
+ *
+ * membroker.c
+ *	  Instance-wide broker of executor work memory
+ *
+ * work_mem and hash_mem_multiplier limit each sort, hash table and
+ * tuplestore of each backend separately, so the memory used by the whole
+ * instance grows with the number of concurrent queries: a work_mem that is
+ * safe for 300 concurrent reporting queries is far too small for a single
+ * one.  When work_mem_target is set, the Sort, Material, Agg and Hash nodes
+ * instead ask the memory broker for a grant when they start, and use it in
+ * place of work_mem.
+ *
+ * The broker hands out memory from work_mem_target.  An operation is
+ * granted a share of the memory not already granted, divided among the
+ * operations currently holding grants, so grants shrink as the instance
+ * gets busier and the operations spill to disk earlier, and grow again as
+ * memory is released.  When memory is plentiful an operation can get more
+ * than it asked for, up to MEMBROKER_MAX_FRACTION of the target, so that a
+ * lone big query isn't held back by a work_mem sized for a busy instance.
+ * Every grant is at least MEMBROKER_MIN_GRANT, so the instance can go a
+ * little over the target when it is saturated.
+ *
+ * Grants are normally returned when the node is shut down.  Grants still
+ * held when the (sub)transaction that acquired them aborts, because the
+ * query failed, are returned by AtEOSubXact_MemoryBroker and
+ * AtEOXact_MemoryBroker; each backend keeps a list of its grants with the
+ * transaction nesting level that acquired them for that purpose.  A grant
+ * is identified by a handle unique within the backend, so that a node
+ * shutting down after its grant was returned that way can't return another
+ * one.
+ *
+ * For the pg_memory_grants view, each backend also records its grants and,
+ * from the memory context accounting, how much memory it had allocated.
+ * Adding that up walks all of the backend's memory contexts, so it is only
+ * done when a grant is acquired or released, and at most once every
+ * MEMBROKER_SAMPLE_INTERVAL.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/mmgr/membroker.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/xact.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "storage/proc.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/membroker.h"
+#include "utils/memutils.h"
+#include "utils/timestamp.h"
+
+/* smallest grant, in kB; the same as tuplesort's minimum */
+#define MEMBROKER_MIN_GRANT		64
+
+/* largest grant, as a fraction of work_mem_target */
+#define MEMBROKER_MAX_FRACTION	0.05
+
+/* time between samples of the memory allocated by a backend, in ms */
+#define MEMBROKER_SAMPLE_INTERVAL	1000
+
+/* GUC parameter */
+int			work_mem_target = 0;
+
+typedef struct MemoryBrokerSlot
+{
+	int			pid;			/* 0 if the backend holds no grants */
+	int			ngrants;
+	uint64		granted_kb;
+	Size		allocated;		/* as of the last sample */
+} MemoryBrokerSlot;
+
+typedef struct MemoryBrokerState
+{
+	slock_t		mutex;			/* protects everything below */
+	int			ngrants;		/* grants outstanding in the instance */
+	uint64		granted_kb;		/* memory granted in the instance */
+	MemoryBrokerSlot slots[FLEXIBLE_ARRAY_MEMBER];	/* one per backend */
+} MemoryBrokerState;
+
+/* a grant held by this backend */
+typedef struct MemoryBrokerGrant
+{
+	MemoryBrokerHandle handle;
+	int			grant_kb;
+	int			nestLevel;		/* transaction nesting level that got it */
+} MemoryBrokerGrant;
+
+static MemoryBrokerState *MemoryBroker = NULL;
+
+/* this backend's grants, and its share of the totals above */
+static MemoryBrokerGrant *MyGrantList = NULL;
+static int	MyGrantListSize = 0;
+static int	MyGrants = 0;
+static uint64 MyGrantedKB = 0;
+static MemoryBrokerHandle MyLastHandle = InvalidMemoryBrokerHandle;
+
+/* the memory allocated by this backend, and when it was last added up */
+static Size MyAllocated = 0;
+static TimestampTz MyAllocatedTime = 0;
+
+static void memory_broker_sample_allocated(void);
+static void memory_broker_update_slot(void);
+static void memory_broker_release_level(int nestLevel);
+
+
+/*
+ * Report shared memory space needed by MemoryBrokerShmemInit
+ */
+Size
+MemoryBrokerShmemSize(void)
+{
+	return add_size(offsetof(MemoryBrokerState, slots),
+					mul_size(MaxBackends, sizeof(MemoryBrokerSlot)));
+}
+
+/*
+ * Allocate and initialize the broker's shared state
+ */
+void
+MemoryBrokerShmemInit(void)
+{
+	bool		found;
+
+	MemoryBroker = (MemoryBrokerState *)
+		ShmemInitStruct("Memory Broker", MemoryBrokerShmemSize(), &found);
+
+	if (!found)
+	{
+		SpinLockInit(&MemoryBroker->mutex);
+		MemoryBroker->ngrants = 0;
+		MemoryBroker->granted_kb = 0;
+		memset(MemoryBroker->slots, 0, mul_size(MaxBackends,
+												sizeof(MemoryBrokerSlot)));
+	}
+}
+
+/*
+ * Add up the memory allocated by this backend, unless that was done less
+ * than MEMBROKER_SAMPLE_INTERVAL ago.  Called before taking the spinlock.
+ */
+static void
+memory_broker_sample_allocated(void)
+{
+	TimestampTz now = GetCurrentTimestamp();
+
+	if (MyAllocatedTime != 0 &&
+		!TimestampDifferenceExceeds(MyAllocatedTime, now,
+									MEMBROKER_SAMPLE_INTERVAL))
+		return;
+
+	MyAllocated = MemoryContextMemAllocated(TopMemoryContext, true);
+	MyAllocatedTime = now;
+}
+
+/*
+ * Publish this backend's grants in its slot.  Caller holds the mutex.
+ */
+static void
+memory_broker_update_slot(void)
+{
+	MemoryBrokerSlot *slot;
+
+	/* only regular backends have a slot */
+	if (MyProcNumber < 0 || MyProcNumber >= MaxBackends)
+		return;
+
+	slot = &MemoryBroker->slots[MyProcNumber];
+	slot->pid = MyGrants > 0 ? MyProcPid : 0;
+	slot->ngrants = MyGrants;
+	slot->granted_kb = MyGrantedKB;
+	slot->allocated = MyAllocated;
+}
+
+/*
+ * Ask for wanted_kb of work memory.
+ *
+ * Returns the amount granted, in kB, which the caller should use instead
+ * of work_mem, and sets *handle to the grant's handle, which the caller
+ * should pass to MemoryBrokerRelease when done.  If the broker is disabled,
+ * returns 0 and sets *handle to InvalidMemoryBrokerHandle, in which case the
+ * caller should stick to its own limit.
+ */
+int
+MemoryBrokerAcquire(int wanted_kb, MemoryBrokerHandle *handle)
+{
+	uint64		target = (uint64) work_mem_target;
+	uint64		free_kb;
+	uint64		grant;
+
+	*handle = InvalidMemoryBrokerHandle;
+
+	if (target == 0 || MemoryBroker == NULL)
+		return 0;
+
+	/* make room to remember the grant before taking the spinlock */
+	if (MyGrants >= MyGrantListSize)
+	{
+		int			newsize = Max(MyGrantListSize * 2, 8);
+
+		if (MyGrantList == NULL)
+			MyGrantList = MemoryContextAlloc(TopMemoryContext,
+											 newsize * sizeof(MemoryBrokerGrant));
+		else
+			MyGrantList = repalloc(MyGrantList,
+								   newsize * sizeof(MemoryBrokerGrant));
+		MyGrantListSize = newsize;
+	}
+
+	memory_broker_sample_allocated();
+
+	SpinLockAcquire(&MemoryBroker->mutex);
+
+	free_kb = target > MemoryBroker->granted_kb ?
+		target - MemoryBroker->granted_kb : 0;
+	grant = free_kb / (MemoryBroker->ngrants + 1);
+	grant = Min(grant, Max((uint64) wanted_kb,
+						   (uint64) (target * MEMBROKER_MAX_FRACTION)));
+	grant = Max(grant, MEMBROKER_MIN_GRANT);
+	grant = Min(grant, MAX_KILOBYTES);
+
+	MemoryBroker->ngrants++;
+	MemoryBroker->granted_kb += grant;
+	MyGrantList[MyGrants].handle = ++MyLastHandle;
+	MyGrantList[MyGrants].grant_kb = (int) grant;
+	MyGrantList[MyGrants].nestLevel = GetCurrentTransactionNestLevel();
+	MyGrants++;
+	MyGrantedKB += grant;
+	memory_broker_update_slot();
+
+	SpinLockRelease(&MemoryBroker->mutex);
+
+	*handle = MyLastHandle;
+	return (int) grant;
+}
+
+/*
+ * Return a grant obtained from MemoryBrokerAcquire.  An invalid handle is
+ * ignored, and so is the handle of a grant already returned at the end of
+ * the (sub)transaction.
+ */
+void
+MemoryBrokerRelease(MemoryBrokerHandle handle)
+{
+	int			grant_kb;
+	int			i;
+
+	if (handle == InvalidMemoryBrokerHandle || MemoryBroker == NULL)
+		return;
+
+	for (i = MyGrants - 1; i >= 0; i--)
+	{
+		if (MyGrantList[i].handle == handle)
+			break;
+	}
+	if (i < 0)
+		return;
+
+	grant_kb = MyGrantList[i].grant_kb;
+
+	memory_broker_sample_allocated();
+
+	SpinLockAcquire(&MemoryBroker->mutex);
+
+	MemoryBroker->ngrants--;
+	MemoryBroker->granted_kb -= grant_kb;
+	MyGrantList[i] = MyGrantList[--MyGrants];
+	MyGrantedKB -= grant_kb;
+	memory_broker_update_slot();
+
+	SpinLockRelease(&MemoryBroker->mutex);
+}
+
+/*
+ * Return the grants acquired at nesting level nestLevel or deeper.
+ */
+static void
+memory_broker_release_level(int nestLevel)
+{
+	int			ngrants = 0;
+	uint64		granted_kb = 0;
+	int			i = 0;
+
+	while (i < MyGrants)
+	{
+		if (MyGrantList[i].nestLevel >= nestLevel)
+		{
+			ngrants++;
+			granted_kb += MyGrantList[i].grant_kb;
+			MyGrantList[i] = MyGrantList[--MyGrants];
+		}
+		else
+			i++;
+	}
+	if (ngrants == 0)
+		return;
+
+	SpinLockAcquire(&MemoryBroker->mutex);
+	MemoryBroker->ngrants -= ngrants;
+	MemoryBroker->granted_kb -= granted_kb;
+	MyGrantedKB -= granted_kb;
+	memory_broker_update_slot();
+	SpinLockRelease(&MemoryBroker->mutex);
+}
+
+/*
+ * Return the grants of the nodes that weren't shut down, because their
+ * query failed, at end of transaction.
+ */
+void
+AtEOXact_MemoryBroker(bool isCommit)
+{
+	if (MyGrants == 0)
+		return;
+
+	memory_broker_release_level(0);
+}
+
+/*
+ * At subtransaction abort, return the grants of the nodes that the
+ * subtransaction started and didn't shut down, so that queries failing
+ * inside exception blocks don't hold memory until the top transaction
+ * ends.  At commit, hand them over to the parent.
+ */
+void
+AtEOSubXact_MemoryBroker(bool isCommit, int nestDepth)
+{
+	if (MyGrants == 0)
+		return;
+
+	if (isCommit)
+	{
+		for (int i = 0; i < MyGrants; i++)
+		{
+			if (MyGrantList[i].nestLevel >= nestDepth)
+				MyGrantList[i].nestLevel = nestDepth - 1;
+		}
+	}
+	else
+		memory_broker_release_level(nestDepth);
+}
+
+/*
+ * Returns the backends currently holding memory grants
+ */
+Datum
+pg_get_memory_grants(PG_FUNCTION_ARGS)
+{
+#define PG_GET_MEMORY_GRANTS_COLS	4
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	for (int i = 0; i < MaxBackends; i++)
+	{
+		MemoryBrokerSlot slot;
+		Datum		values[PG_GET_MEMORY_GRANTS_COLS] = {0};
+		bool		nulls[PG_GET_MEMORY_GRANTS_COLS] = {0};
+
+		SpinLockAcquire(&MemoryBroker->mutex);
+		slot = MemoryBroker->slots[i];
+		SpinLockRelease(&MemoryBroker->mutex);
+
+		if (slot.pid == 0)
+			continue;
+
+		values[0] = Int32GetDatum(slot.pid);
+		values[1] = Int32GetDatum(slot.ngrants);
+		values[2] = Int64GetDatum((int64) slot.granted_kb * 1024);
+		values[3] = Int64GetDatum((int64) slot.allocated);
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc,
+							 values, nulls);
+	}
+
+	return (Datum) 0;
+}
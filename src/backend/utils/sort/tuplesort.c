@@ -104,6 +104,7 @@
 #include "commands/tablespace.h"
 #include "miscadmin.h"
 #include "pg_trace.h"
+#include "port/pg_bitutils.h"
 #include "storage/shmem.h"
 #include "utils/guc.h"
 #include "utils/memutils.h"
@@ -619,6 +620,236 @@ qsort_tuple_int32_compare(SortTuple *a, SortTuple *b, Tuplesortstate *state)
 #define ST_DEFINE
 #include "lib/sort_template.h"
 
+/*
+ * Radix sort for SortTuples whose leading datum1 has one of the specialized
+ * comparators above.  Those comparators order datum1 the same way as an
+ * unsigned integer derived from it (see radix_sort_key()), so we can
+ * distribute the tuples into 256 buckets by one byte of that integer at a
+ * time, starting at the most significant byte that differs between any two
+ * tuples.  This is an in-place MSD radix sort ("American flag sort"), which
+ * needs no extra memory beyond the bucket counts.
+ *
+ * Buckets smaller than RADIX_SORT_THRESHOLD, and buckets whose datum1 values
+ * are all equal, are finished with the matching specialized qsort, which
+ * takes care of breaking ties on abbreviated keys and on further sort keys.
+ */
+#define RADIX_SORT_THRESHOLD 64
+
+typedef enum RadixSortKind
+{
+	RADIX_SORT_UNSIGNED,
+	RADIX_SORT_SIGNED,
+	RADIX_SORT_INT32,
+} RadixSortKind;
+
+/*
+ * Map a non-null datum1 to an unsigned integer with the same ordering as the
+ * comparator, taking DESC into account.
+ */
+static pg_attribute_always_inline uint64
+radix_sort_key(Datum datum, RadixSortKind kind, bool reverse)
+{
+	uint64		key;
+
+	switch (kind)
+	{
+		case RADIX_SORT_UNSIGNED:
+			key = (uint64) datum;
+			break;
+#if SIZEOF_DATUM >= 8
+		case RADIX_SORT_SIGNED:
+			key = (uint64) DatumGetInt64(datum) ^ (UINT64CONST(1) << 63);
+			break;
+#endif
+		case RADIX_SORT_INT32:
+		default:
+			key = (uint32) DatumGetInt32(datum) ^ (UINT64CONST(1) << 31);
+			break;
+	}
+
+	return reverse ? ~key : key;
+}
+
+/*
+ * Sort a run of tuples with the specialized qsort matching kind.
+ */
+static void
+radix_sort_fallback(SortTuple *tuples, size_t n, RadixSortKind kind,
+					Tuplesortstate *state)
+{
+	switch (kind)
+	{
+		case RADIX_SORT_UNSIGNED:
+			qsort_tuple_unsigned(tuples, n, state);
+			break;
+#if SIZEOF_DATUM >= 8
+		case RADIX_SORT_SIGNED:
+			qsort_tuple_signed(tuples, n, state);
+			break;
+#endif
+		case RADIX_SORT_INT32:
+			qsort_tuple_int32(tuples, n, state);
+			break;
+		default:
+			elog(ERROR, "unexpected radix sort kind: %d", (int) kind);
+	}
+}
+
+/*
+ * Sort non-null tuples on the byte of their key selected by level (0 is the
+ * least significant byte), then recurse into each bucket on the next byte.
+ */
+static void
+radix_sort_level(SortTuple *tuples, size_t n, int level, RadixSortKind kind,
+				 Tuplesortstate *state)
+{
+	bool		reverse = state->base.sortKeys[0].ssup_reverse;
+	int			shift = level * BITS_PER_BYTE;
+	size_t		counts[256] = {0};
+	size_t		next[256];
+	size_t		ends[256];
+	size_t		offset;
+
+	CHECK_FOR_INTERRUPTS();
+
+	for (size_t i = 0; i < n; i++)
+		counts[(radix_sort_key(tuples[i].datum1, kind, reverse) >> shift) & 0xFF]++;
+
+	offset = 0;
+	for (int b = 0; b < 256; b++)
+	{
+		next[b] = offset;
+		offset += counts[b];
+		ends[b] = offset;
+	}
+
+	/*
+	 * Move every tuple into its bucket.  Each swap puts at least one tuple
+	 * into its final bucket, so this takes at most n swaps.
+	 */
+	for (int b = 0; b < 256; b++)
+	{
+		while (next[b] < ends[b])
+		{
+			SortTuple	tup = tuples[next[b]];
+			int			d;
+
+			d = (radix_sort_key(tup.datum1, kind, reverse) >> shift) & 0xFF;
+			while (d != b)
+			{
+				SortTuple	tmp = tuples[next[d]];
+
+				tuples[next[d]++] = tup;
+				tup = tmp;
+				d = (radix_sort_key(tup.datum1, kind, reverse) >> shift) & 0xFF;
+			}
+			tuples[next[b]++] = tup;
+		}
+	}
+
+	/* Now sort each bucket on its own */
+	offset = 0;
+	for (int b = 0; b < 256; b++)
+	{
+		SortTuple  *bucket = tuples + offset;
+		size_t		count = counts[b];
+
+		offset += count;
+		if (count <= 1)
+			continue;
+
+		if (level > 0 && count >= RADIX_SORT_THRESHOLD)
+			radix_sort_level(bucket, count, level - 1, kind, state);
+		else if (level > 0 || state->base.onlyKey == NULL)
+			radix_sort_fallback(bucket, count, kind, state);
+	}
+}
+
+/*
+ * Radix sort all memtuples.  NULLs are moved to the front or back first, as
+ * they don't have a meaningful datum1.
+ */
+static void
+radix_sort_tuple(Tuplesortstate *state, RadixSortKind kind)
+{
+	SortTuple  *tuples = state->memtuples;
+	size_t		n = state->memtupcount;
+	SortSupport sortKey = &state->base.sortKeys[0];
+	size_t		nnulls = 0;
+	SortTuple  *notnull;
+	uint64		key_or = 0;
+	uint64		key_and = PG_UINT64_MAX;
+	uint64		diff;
+
+	/* Partition NULLs to the side they sort on */
+	if (sortKey->ssup_nulls_first)
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			if (tuples[i].isnull1)
+			{
+				SortTuple	tmp = tuples[nnulls];
+
+				tuples[nnulls++] = tuples[i];
+				tuples[i] = tmp;
+			}
+		}
+		notnull = tuples + nnulls;
+		if (nnulls > 1 && state->base.onlyKey == NULL)
+			radix_sort_fallback(tuples, nnulls, kind, state);
+	}
+	else
+	{
+		size_t		last = n;
+
+		for (size_t i = n; i > 0; i--)
+		{
+			if (tuples[i - 1].isnull1)
+			{
+				SortTuple	tmp = tuples[--last];
+
+				tuples[last] = tuples[i - 1];
+				tuples[i - 1] = tmp;
+			}
+		}
+		nnulls = n - last;
+		notnull = tuples;
+		if (nnulls > 1 && state->base.onlyKey == NULL)
+			radix_sort_fallback(tuples + last, nnulls, kind, state);
+	}
+	n -= nnulls;
+
+	if (n <= 1)
+		return;
+
+	/*
+	 * Skip the leading bytes that are the same in all keys.  That's common
+	 * for small integers in wide types, and with abbreviated keys that share
+	 * a prefix.
+	 */
+	for (size_t i = 0; i < n; i++)
+	{
+		uint64		key = radix_sort_key(notnull[i].datum1, kind,
+										 sortKey->ssup_reverse);
+
+		key_or |= key;
+		key_and &= key;
+	}
+	diff = key_or ^ key_and;
+
+	if (diff == 0)
+	{
+		/* all keys are equal, only ties are left to break */
+		if (state->base.onlyKey == NULL)
+			radix_sort_fallback(notnull, n, kind, state);
+	}
+	else if (n < RADIX_SORT_THRESHOLD)
+		radix_sort_fallback(notnull, n, kind, state);
+	else
+		radix_sort_level(notnull, n, pg_leftmost_one_pos64(diff) / BITS_PER_BYTE,
+						 kind, state);
+}
+
 /*
  *		tuplesort_begin_xxx
  *
@@ -2670,7 +2901,9 @@ sort_bounded_heap(Tuplesortstate *state)
 /*
  * Sort all memtuples using specialized qsort() routines.
  *
- * Quicksort is used for small in-memory sorts, and external sort runs.
+ * Quicksort is used for small in-memory sorts, and external sort runs.  When
+ * the leading datum1 has a specialized comparator, a radix sort is used for
+ * all but the smallest inputs.
  */
 static void
 tuplesort_sort_memtuples(Tuplesortstate *state)
@@ -2687,25 +2920,34 @@ tuplesort_sort_memtuples(Tuplesortstate *state)
 		{
 			if (state->base.sortKeys[0].comparator == ssup_datum_unsigned_cmp)
 			{
-				qsort_tuple_unsigned(state->memtuples,
-									 state->memtupcount,
-									 state);
+				if (state->memtupcount >= RADIX_SORT_THRESHOLD)
+					radix_sort_tuple(state, RADIX_SORT_UNSIGNED);
+				else
+					qsort_tuple_unsigned(state->memtuples,
+										 state->memtupcount,
+										 state);
 				return;
 			}
 #if SIZEOF_DATUM >= 8
 			else if (state->base.sortKeys[0].comparator == ssup_datum_signed_cmp)
 			{
-				qsort_tuple_signed(state->memtuples,
-								   state->memtupcount,
-								   state);
+				if (state->memtupcount >= RADIX_SORT_THRESHOLD)
+					radix_sort_tuple(state, RADIX_SORT_SIGNED);
+				else
+					qsort_tuple_signed(state->memtuples,
+									   state->memtupcount,
+									   state);
 				return;
 			}
 #endif
 			else if (state->base.sortKeys[0].comparator == ssup_datum_int32_cmp)
 			{
-				qsort_tuple_int32(state->memtuples,
-								  state->memtupcount,
-								  state);
+				if (state->memtupcount >= RADIX_SORT_THRESHOLD)
+					radix_sort_tuple(state, RADIX_SORT_INT32);
+				else
+					qsort_tuple_int32(state->memtuples,
+									  state->memtupcount,
+									  state);
 				return;
 			}
 		}
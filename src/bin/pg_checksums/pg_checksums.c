@@ -23,6 +23,7 @@
 #include "common/controldata_utils.h"
 #include "common/file_utils.h"
 #include "common/logging.h"
+#include "common/pagecompress.h"
 #include "common/relpath.h"
 #include "fe_utils/option_utils.h"
 #include "getopt_long.h"
@@ -218,6 +219,22 @@ scan_file(const char *fn, int segmentno)
 		 */
 		current_size += r;
 
+		/*
+		 * Pages stored compressed carry the checksum of the page itself.
+		 * When enabling checksums, such a page is written back expanded; the
+		 * server compresses it again the next time it writes it.
+		 */
+		if (page_is_compressed(buf.data) && !page_decompress(buf.data))
+		{
+			if (mode == PG_MODE_ENABLE)
+				pg_fatal("could not decompress block %u in file \"%s\"",
+						 blockno, fn);
+			pg_log_error("could not decompress block %u in file \"%s\"",
+						 blockno, fn);
+			badblocks++;
+			continue;
+		}
+
 		/* New pages have no checksum yet */
 		if (PageIsNew(buf.data))
 			continue;
@@ -7094,6 +7094,7 @@ getTables(Archive *fout, int *numTables)
 	int			i_relacl;
 	int			i_acldefault;
 	int			i_ispartition;
+	int			i_is_matview_log;
 
 	/*
 	 * Find all the tables and table-like objects.
@@ -7210,10 +7211,29 @@ getTables(Archive *fout, int *numTables)
 
 	if (fout->remoteVersion >= 100000)
 		appendPQExpBufferStr(query,
-							 "c.relispartition AS ispartition ");
+							 "c.relispartition AS ispartition, ");
 	else
 		appendPQExpBufferStr(query,
-							 "false AS ispartition ");
+							 "false AS ispartition, ");
+
+	/*
+	 * Change logs of materialized views are tables that depend automatically
+	 * on the view.
+	 */
+	if (fout->remoteVersion >= 180000)
+		appendPQExpBufferStr(query,
+							 "(c.relkind = " CppAsString2(RELKIND_RELATION) " AND "
+							 "EXISTS (SELECT 1 FROM pg_depend md "
+							 "JOIN pg_class mv ON (mv.oid = md.refobjid) "
+							 "WHERE md.classid = 'pg_class'::regclass AND "
+							 "md.objid = c.oid AND md.objsubid = 0 AND "
+							 "md.refclassid = 'pg_class'::regclass AND "
+							 "md.deptype = 'a' AND "
+							 "mv.relkind = " CppAsString2(RELKIND_MATVIEW) ")) "
+							 "AS is_matview_log ");
+	else
+		appendPQExpBufferStr(query,
+							 "false AS is_matview_log ");
 
 	/*
 	 * Left join to pg_depend to pick up dependency info linking sequences to
@@ -7326,6 +7346,7 @@ getTables(Archive *fout, int *numTables)
 	i_relacl = PQfnumber(res, "relacl");
 	i_acldefault = PQfnumber(res, "acldefault");
 	i_ispartition = PQfnumber(res, "ispartition");
+	i_is_matview_log = PQfnumber(res, "is_matview_log");
 
 	if (dopt->lockWaitTimeout)
 	{
@@ -7417,6 +7438,14 @@ getTables(Archive *fout, int *numTables)
 		 */
 		if (tblinfo[i].relkind == RELKIND_COMPOSITE_TYPE)
 			tblinfo[i].dobj.dump = DUMP_COMPONENT_NONE;
+		else if (strcmp(PQgetvalue(res, i, i_is_matview_log), "t") == 0)
+		{
+			/*
+			 * The refresh that populates the materialized view creates its
+			 * change logs and their triggers again, so don't dump them.
+			 */
+			tblinfo[i].dobj.dump = DUMP_COMPONENT_NONE;
+		}
 		else
 			selectDumpableTable(&tblinfo[i], fout);
 
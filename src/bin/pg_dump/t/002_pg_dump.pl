@@ -3102,6 +3102,26 @@ my %tests = (
 		},
 	},
 
+	'CREATE MATERIALIZED VIEW matview_fast' => {
+		create_order => 20,
+		create_sql   => 'CREATE MATERIALIZED VIEW
+						   dump_test.matview_fast WITH (fast_refresh = demand) AS
+						   SELECT col1 FROM dump_test.test_table;',
+		regexp => qr/^
+			\QCREATE MATERIALIZED VIEW dump_test.matview_fast\E
+			\n\QWITH (fast_refresh=demand) AS\E
+			\n\s+\QSELECT col1\E
+			\n\s+\QFROM dump_test.test_table\E
+			\n\s+\QWITH NO DATA;\E
+			/xm,
+		like =>
+		  { %full_runs, %dump_test_schema_runs, section_pre_data => 1, },
+		unlike => {
+			exclude_dump_test_schema => 1,
+			only_dump_measurement    => 1,
+		},
+	},
+
 	'CREATE POLICY p1 ON test_table' => {
 		create_order => 22,
 		create_sql   => 'CREATE POLICY p1 ON dump_test.test_table
@@ -4723,6 +4743,12 @@ my %tests = (
 		},
 	},
 
+	# The refresh of matview_fast creates its change log again
+	'matview_fast change log' => {
+		regexp => qr/pg_mlog_/m,
+		like => {},
+	},
+
 	'REFRESH MATERIALIZED VIEW matview_second' => {
 		regexp => qr/^
 			\QREFRESH MATERIALIZED VIEW dump_test.matview;\E
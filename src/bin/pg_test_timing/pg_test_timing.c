@@ -32,6 +32,13 @@ main(int argc, char *argv[])
 
 	handle_args(argc, argv);
 
+	pg_initialize_timing();
+	if (pg_instr_use_tsc)
+		printf(_("Using clock source %s (%.3f MHz).\n"),
+			   pg_timing_clock_source(), 1000.0 / pg_instr_ns_per_tick);
+	else
+		printf(_("Using clock source %s.\n"), pg_timing_clock_source());
+
 	loop_count = test_timing(test_duration);
 
 	output(loop_count);
@@ -2224,10 +2224,11 @@ check_old_cluster_subscription_state(void)
 	 * already dropped. These states are supported for pg_upgrade. The other
 	 * states listed below are not supported:
 	 *
-	 * a) SUBREL_STATE_DATASYNC: A relation upgraded while in this state would
-	 * retain a replication slot, which could not be dropped by the sync
-	 * worker spawned after the upgrade because the subscription ID used for
-	 * the slot name won't match anymore.
+	 * a) SUBREL_STATE_DATASYNC and SUBREL_STATE_PARALLELCOPY: A relation
+	 * upgraded while in one of these states would retain a replication slot,
+	 * which could not be dropped by the sync worker spawned after the upgrade
+	 * because the subscription ID used for the slot name won't match
+	 * anymore.
 	 *
 	 * b) SUBREL_STATE_SYNCDONE: A relation upgraded while in this state would
 	 * retain the replication origin when there is a failure in tablesync
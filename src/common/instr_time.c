@@ -0,0 +1,195 @@
+/*-------------------------------------------------------------------------
+ *
+ * instr_time.c
+ *	  Choice and calibration of the interval timing clock
+ *
+ * On x86-64 Linux, instr_time reads the CPU's time stamp counter directly
+ * when that is known to be reliable, which is several times cheaper than
+ * calling clock_gettime().  That matters for EXPLAIN ANALYZE, which reads
+ * the clock twice per row and node, and for track_io_timing.
+ *
+ * The TSC is only used if the CPU says it ticks at a constant rate
+ * regardless of frequency scaling and sleep states ("invariant TSC"), and
+ * the kernel has chosen it as its own clock source.  The kernel checks that
+ * the TSCs of all CPUs are in sync and switches away from the TSC if it
+ * misbehaves, so we don't second-guess it; see the clock source discussion
+ * in the pg_test_timing documentation.  Otherwise, clock_gettime() is used.
+ *
+ * pg_initialize_timing() must be called once at process start, before any
+ * time is measured; until then, clock_gettime() is used.  The server only
+ * calls it in the postmaster, and child processes forked afterwards inherit
+ * the result.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *	  src/common/instr_time.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "c.h"
+
+#include "portability/instr_time.h"
+
+#ifdef PG_INSTR_TSC
+#include <cpuid.h>
+#endif
+
+/* how long to measure the TSC against clock_gettime() */
+#define TSC_CALIBRATION_USEC	10000
+
+/* readings of both clocks to take, keeping the most closely spaced pair */
+#define TSC_CALIBRATION_TRIES	5
+
+/* TSC state; with use_tsc false, instr_time ticks are nanoseconds */
+bool		pg_instr_use_tsc = false;
+double		pg_instr_ns_per_tick = 1.0;
+
+#ifdef PG_INSTR_TSC
+static bool tsc_is_invariant(void);
+static bool tsc_is_kernel_clocksource(void);
+static void tsc_read_clocks(uint64 *tsc, int64 *ns);
+#endif
+
+
+/*
+ * Decide which clock instr_time uses, and calibrate the TSC if it is chosen.
+ */
+void
+pg_initialize_timing(void)
+{
+#ifdef PG_INSTR_TSC
+	uint64		tsc_start,
+				tsc_end;
+	int64		ns_start,
+				ns_end;
+
+	pg_instr_use_tsc = false;
+	pg_instr_ns_per_tick = 1.0;
+
+	if (!tsc_is_invariant() || !tsc_is_kernel_clocksource())
+		return;
+
+	/*
+	 * The kernel knows the TSC frequency, but doesn't export it, and the
+	 * frequency advertised by CPUID is nominal or missing on many CPUs and
+	 * hypervisors.  So measure it against clock_gettime(), which the kernel
+	 * derives from the same counter.  10ms is enough for the error to be a
+	 * few parts per million.
+	 */
+	tsc_read_clocks(&tsc_start, &ns_start);
+	pg_usleep(TSC_CALIBRATION_USEC);
+	tsc_read_clocks(&tsc_end, &ns_end);
+
+	/* give up on anything implausible, like a TSC slower than 100MHz */
+	if (tsc_end <= tsc_start || ns_end <= ns_start ||
+		(double) (tsc_end - tsc_start) / (ns_end - ns_start) < 0.1)
+		return;
+
+	pg_instr_ns_per_tick = (double) (ns_end - ns_start) / (tsc_end - tsc_start);
+	pg_instr_use_tsc = true;
+#endif
+}
+
+/*
+ * Describe the clock chosen by pg_initialize_timing(), for pg_test_timing.
+ */
+const char *
+pg_timing_clock_source(void)
+{
+	return pg_instr_use_tsc ? "tsc" : "clock_gettime";
+}
+
+#ifdef PG_INSTR_TSC
+
+/*
+ * Does the CPU have an invariant TSC and the RDTSCP instruction?
+ */
+static bool
+tsc_is_invariant(void)
+{
+	unsigned int eax,
+				ebx,
+				ecx,
+				edx;
+
+	if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 ||
+		eax < 0x80000007)
+		return false;
+
+	/* RDTSCP is EDX bit 27 of leaf 0x80000001 */
+	if (__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) == 0 ||
+		(edx & (1 << 27)) == 0)
+		return false;
+
+	/* invariant TSC is EDX bit 8 of leaf 0x80000007 */
+	if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0 ||
+		(edx & (1 << 8)) == 0)
+		return false;
+
+	return true;
+}
+
+/*
+ * Is the TSC the kernel's current clock source?
+ */
+static bool
+tsc_is_kernel_clocksource(void)
+{
+	FILE	   *fp;
+	char		buf[32];
+	bool		result = false;
+
+	fp = fopen("/sys/devices/system/clocksource/clocksource0/current_clocksource", "r");
+	if (fp == NULL)
+		return false;
+
+	if (fgets(buf, sizeof(buf), fp) != NULL)
+		result = (strcmp(buf, "tsc\n") == 0);
+
+	fclose(fp);
+
+	return result;
+}
+
+/*
+ * Read the TSC and clock_gettime() as close together in time as we can.
+ *
+ * The TSC is read on both sides of clock_gettime(), and the pair with the
+ * smallest gap wins, so that an interrupt or a preemption between the reads
+ * doesn't skew the calibration.
+ */
+static void
+tsc_read_clocks(uint64 *tsc, int64 *ns)
+{
+	uint64		best_gap = PG_UINT64_MAX;
+
+	for (int i = 0; i < TSC_CALIBRATION_TRIES; i++)
+	{
+		unsigned int aux;
+		uint64		before;
+		uint64		after;
+		instr_time	now;
+
+		before = __rdtscp(&aux);
+		now = pg_clock_gettime_ns();
+		after = __rdtscp(&aux);
+
+		if (after > before && after - before < best_gap)
+		{
+			best_gap = after - before;
+			*tsc = before + (after - before) / 2;
+			*ns = now.ticks;
+		}
+	}
+
+	/* the TSC didn't move forward; make the caller give up */
+	if (best_gap == PG_UINT64_MAX)
+	{
+		*tsc = 0;
+		*ns = 0;
+	}
+}
+
+#endif							/* PG_INSTR_TSC */
@@ -19,7 +19,9 @@
 
 #include "common/jsonapi.h"
 #include "mb/pg_wchar.h"
+#include "port/pg_bitutils.h"
 #include "port/pg_lfind.h"
+#include "port/simd.h"
 
 #ifdef JSONAPI_USE_PQEXPBUFFER
 #include "pqexpbuffer.h"
@@ -271,6 +273,8 @@ static td_entry td_parser_table[JSON_NUM_NONTERMINALS][JSON_NUM_TERMINALS] =
 /* the GOAL production. Not stored in the table, but will be the initial contents of the prediction stack */
 static char JSON_PROD_GOAL[] = {JSON_TOKEN_END, JSON_NT_JSON, 0};
 
+static inline const char *json_skip_blanks(const char *s, const char *end);
+static inline const char *json_scan_plain_string(const char *s, const char *end);
 static inline JsonParseErrorType json_lex_string(JsonLexContext *lex);
 static inline JsonParseErrorType json_lex_number(JsonLexContext *lex, const char *s,
 												 bool *num_err, size_t *total_len);
@@ -1800,13 +1804,17 @@ json_lex(JsonLexContext *lex)
 		/* end of partial token processing */
 	}
 
-	/* Skip leading whitespace. */
+	/*
+	 * Skip leading whitespace.  In pretty-printed input a newline is usually
+	 * followed by a run of indentation, which we skip a vector at a time.
+	 */
 	while (s < end && (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r'))
 	{
 		if (*s++ == '\n')
 		{
 			++lex->line_number;
 			lex->line_start = s;
+			s = json_skip_blanks(s, end);
 		}
 	}
 	lex->token_start = s;
@@ -1949,6 +1957,78 @@ json_lex(JsonLexContext *lex)
 		return JSON_SUCCESS;
 }
 
+/*
+ * Return the first byte at or after s that is not a space, tab or carriage
+ * return.  Only whole vectors are examined, so if they are all blanks the
+ * first unexamined byte is returned instead; the caller's scalar loop deals
+ * with the rest.  Newlines are never skipped, since the caller counts them.
+ */
+static inline const char *
+json_skip_blanks(const char *s, const char *end)
+{
+#ifndef USE_NO_SIMD
+	const Vector8 spaces = vector8_broadcast(' ');
+	const Vector8 tabs = vector8_broadcast('\t');
+	const Vector8 returns = vector8_broadcast('\r');
+
+	while (end - s >= (ptrdiff_t) sizeof(Vector8))
+	{
+		Vector8		chunk;
+		uint32		mask;
+
+		vector8_load(&chunk, (const uint8 *) s);
+		mask = vector8_highbit_mask(vector8_or(vector8_eq(chunk, spaces),
+											   vector8_or(vector8_eq(chunk, tabs),
+														  vector8_eq(chunk, returns))));
+		/* bits of mask are now set for blanks; look for the first non-blank */
+		mask = ~mask & ((UINT64CONST(1) << sizeof(Vector8)) - 1);
+		if (mask != 0)
+			return s + pg_rightmost_one_pos32(mask);
+		s += sizeof(Vector8);
+	}
+#endif							/* ! USE_NO_SIMD */
+
+	return s;
+}
+
+/*
+ * Return the first byte at or after s that ends a run of string contents
+ * needing no processing: a quote, a backslash, or a control character.  As
+ * with json_skip_blanks, only whole vectors before end are examined.
+ */
+static inline const char *
+json_scan_plain_string(const char *s, const char *end)
+{
+#ifndef USE_NO_SIMD
+	const Vector8 quotes = vector8_broadcast('"');
+	const Vector8 backslashes = vector8_broadcast('\\');
+	const Vector8 controls = vector8_broadcast(31);
+
+	while (end - s > (ptrdiff_t) sizeof(Vector8))
+	{
+		Vector8		chunk;
+		uint32		mask;
+
+		vector8_load(&chunk, (const uint8 *) s);
+		mask = vector8_highbit_mask(vector8_or(vector8_or(vector8_eq(chunk, quotes),
+														  vector8_eq(chunk, backslashes)),
+											   vector8_eq(vector8_min(chunk, controls),
+														  chunk)));
+		if (mask != 0)
+			return s + pg_rightmost_one_pos32(mask);
+		s += sizeof(Vector8);
+	}
+#else
+	while (s < end - sizeof(Vector8) &&
+		   !pg_lfind8('\\', (uint8 *) s, sizeof(Vector8)) &&
+		   !pg_lfind8('"', (uint8 *) s, sizeof(Vector8)) &&
+		   !pg_lfind8_le(31, (uint8 *) s, sizeof(Vector8)))
+		s += sizeof(Vector8);
+#endif							/* ! USE_NO_SIMD */
+
+	return s;
+}
+
 /*
  * The next token in the input stream is known to be a string; lex it.
  *
@@ -2166,11 +2246,7 @@ json_lex_string(JsonLexContext *lex)
 			 * Skip to the first byte that requires special handling, so we
 			 * can batch calls to jsonapi_appendBinaryStringInfo.
 			 */
-			while (p < end - sizeof(Vector8) &&
-				   !pg_lfind8('\\', (uint8 *) p, sizeof(Vector8)) &&
-				   !pg_lfind8('"', (uint8 *) p, sizeof(Vector8)) &&
-				   !pg_lfind8_le(31, (uint8 *) p, sizeof(Vector8)))
-				p += sizeof(Vector8);
+			p = json_scan_plain_string(p, end);
 
 			for (; p < end; p++)
 			{
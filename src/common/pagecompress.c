@@ -0,0 +1,181 @@
+/*-------------------------------------------------------------------------
+ *
+ * pagecompress.c
+ *	  Compression of relation pages for storage
+ *
+ * The storage manager compresses pages with page_compress() as it writes
+ * them, and page_decompress() restores them as they are read.  Frontend
+ * tools that read relation files directly use page_decompress() too.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * IDENTIFICATION
+ *		  src/common/pagecompress.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef FRONTEND
+#include "postgres.h"
+#else
+#include "postgres_fe.h"
+#endif
+
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+
+#include "common/pagecompress.h"
+#include "common/pg_lzcompress.h"
+#include "storage/bufpage.h"
+
+#define PAGE_COMPRESS_HDRSZ		sizeof(PageCompressHeader)
+
+/* Does the range hold only zeros? */
+static bool
+hole_is_zero(const char *ptr, int len)
+{
+	for (int i = 0; i < len; i++)
+	{
+		if (ptr[i] != 0)
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Compress a page into dest, which must have room for BLCKSZ bytes.
+ *
+ * Returns the size of the image to store, a multiple of PAGE_COMPRESS_ALIGN,
+ * or 0 if the page should be stored as is because compression would not
+ * save any space.
+ */
+int
+page_compress(const char *page, int method, char *dest)
+{
+	const PageHeaderData *phdr = (const PageHeaderData *) page;
+	PGAlignedBlock raw;
+	int			lower = phdr->pd_lower;
+	int			upper = phdr->pd_upper;
+	int			rawlen;
+	int			maxlen = BLCKSZ - PAGE_COMPRESS_ALIGN - PAGE_COMPRESS_HDRSZ;
+	int			len = -1;
+	int			size;
+	PageCompressHeader *chdr = (PageCompressHeader *) dest;
+
+	/* Pages no larger than the allocation unit can't shrink */
+	if (maxlen <= 0)
+		return 0;
+
+	/* Leave new pages alone, they are rewritten soon anyway */
+	if (upper == 0)
+		return 0;
+
+	/*
+	 * Compress the page without its hole, if the header looks sane.  The
+	 * hole is restored as zeros, so it's kept if it holds anything else, or
+	 * the page would no longer match its checksum.
+	 */
+	if (lower < SizeOfPageHeaderData || lower > upper || upper > BLCKSZ ||
+		!hole_is_zero(page + lower, upper - lower))
+		lower = upper = BLCKSZ;
+	memcpy(raw.data, page, lower);
+	memcpy(raw.data + lower, page + upper, BLCKSZ - upper);
+	rawlen = BLCKSZ - (upper - lower);
+
+	switch (method)
+	{
+		case PAGE_COMPRESSION_PGLZ:
+			{
+				char		out[PGLZ_MAX_OUTPUT(BLCKSZ)];
+
+				len = pglz_compress(raw.data, rawlen, out,
+									PGLZ_strategy_default);
+				if (len >= 0 && len <= maxlen)
+					memcpy(dest + PAGE_COMPRESS_HDRSZ, out, len);
+				else
+					len = -1;
+			}
+			break;
+		case PAGE_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			len = LZ4_compress_default(raw.data, dest + PAGE_COMPRESS_HDRSZ,
+									   rawlen, maxlen);
+			if (len == 0)
+				len = -1;
+#endif
+			break;
+		default:
+			break;
+	}
+
+	if (len < 0)
+		return 0;
+
+	chdr->magic = PAGE_COMPRESS_MAGIC;
+	chdr->method = method;
+	chdr->unused = 0;
+	chdr->length = len;
+
+	size = TYPEALIGN(PAGE_COMPRESS_ALIGN, PAGE_COMPRESS_HDRSZ + len);
+	memset(dest + PAGE_COMPRESS_HDRSZ + len, 0,
+		   size - PAGE_COMPRESS_HDRSZ - len);
+
+	return size;
+}
+
+/*
+ * Restore a page in place from its compressed image.  Does nothing if the
+ * page isn't compressed.  Returns false if the image is corrupt, in which
+ * case the page is left unchanged.
+ */
+bool
+page_decompress(char *image)
+{
+	PageCompressHeader chdr;
+	PGAlignedBlock raw;
+	int			rawlen = -1;
+	int			lower;
+	int			hole;
+
+	if (!page_is_compressed(image))
+		return true;
+
+	memcpy(&chdr, image, PAGE_COMPRESS_HDRSZ);
+	if (chdr.length > BLCKSZ - PAGE_COMPRESS_HDRSZ)
+		return false;
+
+	switch (chdr.method)
+	{
+		case PAGE_COMPRESSION_PGLZ:
+			rawlen = pglz_decompress(image + PAGE_COMPRESS_HDRSZ, chdr.length,
+									 raw.data, BLCKSZ, false);
+			break;
+		case PAGE_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			rawlen = LZ4_decompress_safe(image + PAGE_COMPRESS_HDRSZ, raw.data,
+										 chdr.length, BLCKSZ);
+#endif
+			break;
+		default:
+			break;
+	}
+
+	if (rawlen < (int) SizeOfPageHeaderData)
+		return false;
+
+	/* Put the hole back */
+	lower = ((PageHeader) raw.data)->pd_lower;
+	hole = BLCKSZ - rawlen;
+	if (hole > 0 &&
+		(lower > rawlen || ((PageHeader) raw.data)->pd_upper != lower + hole))
+		return false;
+	if (hole == 0)
+		lower = rawlen;
+
+	memcpy(image, raw.data, lower);
+	memset(image + lower, 0, hole);
+	memcpy(image + lower + hole, raw.data + lower, rawlen - lower);
+
+	return true;
+}
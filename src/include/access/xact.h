@@ -530,7 +530,9 @@ extern void ParseAbortRecord(uint8 info, xl_xact_abort *xlrec, xl_xact_parsed_ab
 extern void ParsePrepareRecord(uint8 info, xl_xact_prepare *xlrec, xl_xact_parsed_prepare *parsed);
 
 extern void EnterParallelMode(void);
+extern void EnterParallelModeForDML(void);
 extern void ExitParallelMode(void);
 extern bool IsInParallelMode(void);
+extern bool IsParallelDMLLeader(void);
 
 #endif							/* XACT_H */
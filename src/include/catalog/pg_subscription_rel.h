@@ -62,6 +62,8 @@ MAKE_SYSCACHE(SUBSCRIPTIONRELMAP, pg_subscription_rel_srrelid_srsubid_index, 64)
 #define SUBREL_STATE_INIT		'i' /* initializing (sublsn NULL) */
 #define SUBREL_STATE_DATASYNC	'd' /* data is being synchronized (sublsn
 									 * NULL) */
+#define SUBREL_STATE_PARALLELCOPY 'p'	/* data is being copied by several
+										 * workers (sublsn NULL) */
 #define SUBREL_STATE_FINISHEDCOPY 'f'	/* tablesync copy phase is completed
 										 * (sublsn NULL) */
 #define SUBREL_STATE_SYNCDONE	's' /* synchronization finished in front of
@@ -14,6 +14,7 @@
 #ifndef COPY_H
 #define COPY_H
 
+#include "common/compression.h"
 #include "nodes/execnodes.h"
 #include "nodes/parsenodes.h"
 #include "parser/parse_node.h"
@@ -87,6 +88,7 @@ typedef struct CopyFormatOptions
 	CopyLogVerbosityChoice log_verbosity;	/* verbosity of logged messages */
 	int64		reject_limit;	/* maximum tolerable number of errors */
 	List	   *convert_select; /* list of column names (can be NIL) */
+	pg_compress_specification compression;	/* COPY TO file compression */
 } CopyFormatOptions;
 
 /* These are private in commands/copy[from|to].c */
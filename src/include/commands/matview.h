@@ -33,4 +33,11 @@ extern DestReceiver *CreateTransientRelDestReceiver(Oid transientoid);
 
 extern bool MatViewIncrementalMaintenanceIsEnabled(void);
 
+/* in matviewlog.c */
+extern bool MatViewFastRefresh(Relation matviewRel, Query *query, Oid relowner,
+							   int save_sec_context, uint64 *processed);
+extern bool MatViewPrepareLogs(Relation matviewRel, Query *query, bool skipData);
+extern void PreCommit_MatViewRefresh(void);
+extern bool MatViewRefreshPending(void);
+
 #endif							/* MATVIEW_H */
@@ -0,0 +1,54 @@
+/*-------------------------------------------------------------------------
+ *
+ * pagecompress.h
+ *	  Compression of relation pages for storage
+ *
+ * A page whose PD_COMPRESSION bits are set is written to its slot of the
+ * relation file as a compressed image, if that saves at least one
+ * PAGE_COMPRESS_ALIGN unit, and the rest of the slot is deallocated.  The
+ * block numbers and the size of the file are unchanged; only the space the
+ * file system allocates for it shrinks.  Pages are always decompressed when
+ * they are read into shared buffers, so nothing above the storage manager
+ * sees compressed images.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * src/include/common/pagecompress.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef PAGECOMPRESS_H
+#define PAGECOMPRESS_H
+
+/*
+ * A compressed image starts with this header instead of a page header.  The
+ * magic number is where the high half of pd_lsn would be, which no real page
+ * reaches.  The image is a compressed copy of the page without the hole
+ * between pd_lower and pd_upper.
+ */
+typedef struct PageCompressHeader
+{
+	uint32		magic;			/* PAGE_COMPRESS_MAGIC */
+	uint8		method;			/* PAGE_COMPRESSION_xxx */
+	uint8		unused;
+	uint16		length;			/* length of the compressed data */
+} PageCompressHeader;
+
+#define PAGE_COMPRESS_MAGIC		0xFFFFC0DE
+
+/*
+ * Compressed images are padded to a multiple of this, the allocation unit of
+ * common file systems, since only whole units can be deallocated.
+ */
+#define PAGE_COMPRESS_ALIGN		4096
+
+static inline bool
+page_is_compressed(const char *image)
+{
+	return ((const PageCompressHeader *) image)->magic == PAGE_COMPRESS_MAGIC;
+}
+
+extern int	page_compress(const char *page, int method, char *dest);
+extern bool page_decompress(char *image);
+
+#endif							/* PAGECOMPRESS_H */
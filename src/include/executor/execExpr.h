@@ -200,6 +200,8 @@ typedef enum ExprEvalOp
 	EEOP_SQLVALUEFUNCTION,
 	EEOP_CURRENTOFEXPR,
 	EEOP_NEXTVALUEEXPR,
+	EEOP_ROWNUM,
+	EEOP_ROWNUM_INCREMENT,
 	EEOP_RETURNINGEXPR,
 	EEOP_ARRAYEXPR,
 	EEOP_ARRAYCOERCE,
@@ -485,6 +487,12 @@ typedef struct ExprEvalStep
 			Oid			seqtypid;
 		}			nextvalueexpr;
 
+		/* for EEOP_ROWNUM and EEOP_ROWNUM_INCREMENT */
+		struct
+		{
+			int64	   *counter;	/* rows emitted so far by the plan node */
+		}			rownum;
+
 		/* for EEOP_ARRAYEXPR */
 		struct
 		{
@@ -884,6 +892,8 @@ extern void ExecEvalCoerceViaIOSafe(ExprState *state, ExprEvalStep *op);
 extern void ExecEvalSQLValueFunction(ExprState *state, ExprEvalStep *op);
 extern void ExecEvalCurrentOfExpr(ExprState *state, ExprEvalStep *op);
 extern void ExecEvalNextValueExpr(ExprState *state, ExprEvalStep *op);
+extern void ExecEvalRownum(ExprState *state, ExprEvalStep *op);
+extern void ExecEvalRownumIncrement(ExprState *state, ExprEvalStep *op);
 extern void ExecEvalRowNull(ExprState *state, ExprEvalStep *op,
 							ExprContext *econtext);
 extern void ExecEvalRowNotNull(ExprState *state, ExprEvalStep *op,
@@ -344,6 +344,8 @@ typedef struct HashJoinTableData
 	Size		spaceUsed;		/* memory space currently used by tuples */
 	Size		spaceAllowed;	/* upper limit for space used */
 	Size		spacePeak;		/* peak space used */
+	int			mem_grant;		/* kB granted by the memory broker, or 0 */
+	MemoryBrokerHandle mem_grant_handle;	/* handle of that grant */
 	Size		spaceUsedSkew;	/* skew hash table's current space usage */
 	Size		spaceAllowedSkew;	/* upper limit for skew hashtable */
 
@@ -26,6 +26,9 @@ typedef dsa_pointer dshash_table_handle;
 /* Sentinel value to use for invalid dshash_table handles. */
 #define DSHASH_HANDLE_INVALID ((dshash_table_handle) InvalidDsaPointer)
 
+/* Flags for dshash_find_or_insert_extended. */
+#define DSHASH_INSERT_NO_OOM	0x01	/* return NULL if out of memory */
+
 /* The type for hash values. */
 typedef uint32 dshash_hash;
 
@@ -97,6 +100,9 @@ extern void *dshash_find(dshash_table *hash_table,
 						 const void *key, bool exclusive);
 extern void *dshash_find_or_insert(dshash_table *hash_table,
 								   const void *key, bool *found);
+extern void *dshash_find_or_insert_extended(dshash_table *hash_table,
+											const void *key, bool *found,
+											int flags);
 extern bool dshash_delete_key(dshash_table *hash_table, const void *key);
 extern void dshash_delete_entry(dshash_table *hash_table, void *entry);
 extern void dshash_release_lock(dshash_table *hash_table, void *entry);
@@ -41,6 +41,7 @@
 #include "partitioning/partdefs.h"
 #include "storage/condition_variable.h"
 #include "utils/hsearch.h"
+#include "utils/membroker.h"
 #include "utils/queryenvironment.h"
 #include "utils/reltrigger.h"
 #include "utils/sharedtuplestore.h"
@@ -1194,6 +1195,7 @@ typedef struct PlanState
 	TupleTableSlot *ps_ResultTupleSlot; /* slot for my result tuples */
 	ExprContext *ps_ExprContext;	/* node's expression-evaluation context */
 	ProjectionInfo *ps_ProjInfo;	/* info for doing tuple projection */
+	int64		ps_rownum;		/* rows numbered so far, if plan uses ROWNUM */
 
 	bool		async_capable;	/* true if node is async-capable */
 
@@ -2288,6 +2290,8 @@ typedef struct MaterialState
 	int			eflags;			/* capability flags to pass to tuplestore */
 	bool		eof_underlying; /* reached end of underlying plan? */
 	Tuplestorestate *tuplestorestate;
+	int			mem_grant;		/* kB granted by the memory broker, or 0 */
+	MemoryBrokerHandle mem_grant_handle;	/* handle of that grant */
 } MaterialState;
 
 struct MemoizeEntry;
@@ -2398,6 +2402,8 @@ typedef struct SortState
 	bool		bounded_Done;	/* value of bounded we did the sort with */
 	int64		bound_Done;		/* value of bound we did the sort with */
 	void	   *tuplesortstate; /* private state of tuplesort.c */
+	int			mem_grant;		/* kB granted by the memory broker, or 0 */
+	MemoryBrokerHandle mem_grant_handle;	/* handle of that grant */
 	bool		am_worker;		/* are we a worker? */
 	bool		datumSort;		/* Datum sort instead of tuple sort? */
 	SharedSortInfo *shared_info;	/* one entry per worker */
@@ -2576,6 +2582,8 @@ typedef struct AggState
 									 * and we must not create new groups */
 	Size		hash_mem_limit; /* limit before spilling hash table */
 	uint64		hash_ngroups_limit; /* limit before spilling hash table */
+	int			hash_mem_grant; /* kB granted by the memory broker, or 0 */
+	MemoryBrokerHandle hash_mem_grant_handle;	/* handle of that grant */
 	int			hash_planned_partitions;	/* number of partitions planned
 											 * for first pass */
 	double		hashentrysize;	/* estimate revised during execution */
@@ -171,6 +171,8 @@ typedef struct Query
 	bool		hasGroupRTE pg_node_attr(query_jumble_ignore);
 	/* is a RETURN statement */
 	bool		isReturn pg_node_attr(query_jumble_ignore);
+	/* has ROWNUM pseudo-column references */
+	bool		hasRownum pg_node_attr(query_jumble_ignore);
 
 	List	   *cteList;		/* WITH list (of CommonTableExpr's) */
 
@@ -246,6 +248,9 @@ typedef struct Query
 	/* a list of WithCheckOption's (added during rewrite) */
 	List	   *withCheckOptions pg_node_attr(query_jumble_ignore);
 
+	/* optimizer hints given in an Oracle-style hint comment, or NULL */
+	char	   *hints pg_node_attr(query_jumble_ignore);
+
 	/*
 	 * The following two fields identify the portion of the source text string
 	 * containing this query.  They are typically only populated in top-level
@@ -2130,6 +2135,7 @@ typedef struct InsertStmt
 	ReturningClause *returningClause;	/* RETURNING clause */
 	WithClause *withClause;		/* WITH clause */
 	OverridingKind override;	/* OVERRIDING clause */
+	char	   *hints;			/* optimizer hint comment text, or NULL */
 } InsertStmt;
 
 /* ----------------------
@@ -2144,6 +2150,7 @@ typedef struct DeleteStmt
 	Node	   *whereClause;	/* qualifications */
 	ReturningClause *returningClause;	/* RETURNING clause */
 	WithClause *withClause;		/* WITH clause */
+	char	   *hints;			/* optimizer hint comment text, or NULL */
 } DeleteStmt;
 
 /* ----------------------
@@ -2159,6 +2166,7 @@ typedef struct UpdateStmt
 	List	   *fromClause;		/* optional from clause for more tables */
 	ReturningClause *returningClause;	/* RETURNING clause */
 	WithClause *withClause;		/* WITH clause */
+	char	   *hints;			/* optimizer hint comment text, or NULL */
 } UpdateStmt;
 
 /* ----------------------
@@ -2174,6 +2182,7 @@ typedef struct MergeStmt
 	List	   *mergeWhenClauses;	/* list of MergeWhenClause(es) */
 	ReturningClause *returningClause;	/* RETURNING clause */
 	WithClause *withClause;		/* WITH clause */
+	char	   *hints;			/* optimizer hint comment text, or NULL */
 } MergeStmt;
 
 /* ----------------------
@@ -2214,6 +2223,7 @@ typedef struct SelectStmt
 	bool		groupDistinct;	/* Is this GROUP BY DISTINCT? */
 	Node	   *havingClause;	/* HAVING conditional-expression */
 	List	   *windowClause;	/* WINDOW window_name AS (...), ... */
+	char	   *hints;			/* optimizer hint comment text, or NULL */
 
 	/*
 	 * In a "leaf" node representing a VALUES list, the above fields are all
@@ -177,6 +177,9 @@ typedef struct PlannerGlobal
 	/* worst PROPARALLEL hazard level */
 	char		maxParallelHazard;
 
+	/* optimizer hints of all query levels, as OraHint nodes */
+	List	   *hints;
+
 	/* partition descriptors */
 	PartitionDirectory partition_directory pg_node_attr(read_write_ignore);
 } PlannerGlobal;
@@ -583,6 +586,9 @@ struct PlannerInfo
 
 	/* PartitionPruneInfos added in this query's plan. */
 	List	   *partPruneInfos;
+
+	/* optimizer hints applying to this query level, as OraHint nodes */
+	List	   *hints;
 };
 
 
@@ -3365,6 +3371,7 @@ typedef struct SemiAntiJoinFactors
  * sjinfo is extra info about special joins for selectivity estimation
  * semifactors is as shown above (only valid for SEMI/ANTI/inner_unique joins)
  * param_source_rels are OK targets for parameterization of result paths
+ * hint_disabled is a mask of join methods ruled out by optimizer hints
  */
 typedef struct JoinPathExtraData
 {
@@ -3374,6 +3381,7 @@ typedef struct JoinPathExtraData
 	SpecialJoinInfo *sjinfo;
 	SemiAntiJoinFactors semifactors;
 	Relids		param_source_rels;
+	int			hint_disabled;
 } JoinPathExtraData;
 
 /*
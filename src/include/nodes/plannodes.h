@@ -128,6 +128,9 @@ typedef struct PlannedStmt
 	/* type OIDs for PARAM_EXEC Params */
 	List	   *paramExecTypes;
 
+	/* optimizer hints given in the query, as OraHint nodes */
+	List	   *hints;
+
 	/* non-null if this is utility stmt */
 	Node	   *utilityStmt;
 
@@ -1747,6 +1750,46 @@ typedef struct PlanInvalItem
 	uint32		hashValue;
 } PlanInvalItem;
 
+/*
+ * Optimizer hints
+ *
+ * Hints are written in Oracle style, as a comment whose opening delimiter
+ * is directly followed by a plus sign, placed immediately after the SELECT,
+ * INSERT, UPDATE, DELETE or MERGE keyword (Oracle-compatible parser only).
+ * The raw comment text is carried in Query.hints; the planner splits it into
+ * OraHint nodes and records whether the finished plan follows each one, so
+ * that EXPLAIN can report hints that were silently ignored.
+ */
+typedef enum OraHintKind
+{
+	ORA_HINT_INVALID,			/* unknown name or malformed hint */
+	ORA_HINT_FULL,
+	ORA_HINT_INDEX,
+	ORA_HINT_NO_INDEX,
+	ORA_HINT_USE_NL,
+	ORA_HINT_USE_HASH,
+	ORA_HINT_USE_MERGE,
+	ORA_HINT_LEADING,
+	ORA_HINT_PARALLEL,
+	ORA_HINT_NO_PARALLEL,
+	ORA_HINT_CARDINALITY,
+	ORA_HINT_NO_MERGE,
+} OraHintKind;
+
+typedef struct OraHint
+{
+	pg_node_attr(no_equal, no_query_jumble)
+
+	NodeTag		type;
+	OraHintKind kind;
+	/* hint as written, for display */
+	char	   *text;
+	/* arguments, as String nodes; unquoted identifiers are downcased */
+	List	   *args;
+	/* set if the plan follows the hint */
+	bool		used;
+} OraHint;
+
 /*
  * MonotonicFunction
  *
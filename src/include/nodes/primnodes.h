@@ -2147,6 +2147,20 @@ typedef struct NextValueExpr
 	Oid			typeId;
 } NextValueExpr;
 
+/*
+ * RownumExpr - the Oracle ROWNUM pseudo-column
+ *
+ * ROWNUM is the ordinal number (an int8) of the current row among the rows
+ * its query block has produced so far.  Rows are numbered as they pass the
+ * query block's WHERE clause, before any sorting or aggregation.
+ */
+typedef struct RownumExpr
+{
+	Expr		xpr;
+	/* token location, or -1 if unknown */
+	ParseLoc	location;
+} RownumExpr;
+
 /*
  * InferenceElem - an element of a unique index inference specification
  *
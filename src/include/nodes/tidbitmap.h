@@ -23,6 +23,7 @@
 #define TIDBITMAP_H
 
 #include "access/htup_details.h"
+#include "nodes/bitmapset.h"
 #include "storage/itemptr.h"
 #include "utils/dsa.h"
 
@@ -88,6 +89,9 @@ extern void tbm_free_shared_area(dsa_area *dsa, dsa_pointer dp);
 extern void tbm_add_tuples(TIDBitmap *tbm,
 						   const ItemPointer tids, int ntids,
 						   bool recheck);
+extern void tbm_add_page_words(TIDBitmap *tbm, BlockNumber pageno,
+							   const bitmapword *words, int nwords,
+							   bool recheck);
 extern void tbm_add_page(TIDBitmap *tbm, BlockNumber pageno);
 
 extern void tbm_union(TIDBitmap *a, const TIDBitmap *b);
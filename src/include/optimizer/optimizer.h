@@ -144,6 +144,7 @@ extern bool contain_mutable_functions_after_planning(Expr *expr);
 extern bool contain_volatile_functions(Node *clause);
 extern bool contain_volatile_functions_after_planning(Expr *expr);
 extern bool contain_volatile_functions_not_nextval(Node *clause);
+extern bool contain_rownum(Node *clause);
 
 extern Node *eval_const_expressions(PlannerInfo *root, Node *node);
 
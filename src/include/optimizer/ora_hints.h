@@ -0,0 +1,39 @@
+/*-------------------------------------------------------------------------
+ *
+ * ora_hints.h
+ *	  prototypes for ora_hints.c.
+ *
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * src/include/optimizer/ora_hints.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef ORA_HINTS_H
+#define ORA_HINTS_H
+
+#include "nodes/pathnodes.h"
+#include "nodes/plannodes.h"
+
+/* Join methods that can be ruled out by hints, see JoinPathExtraData */
+#define ORA_HINT_DISABLE_NESTLOOP	0x01
+#define ORA_HINT_DISABLE_MERGEJOIN	0x02
+#define ORA_HINT_DISABLE_HASHJOIN	0x04
+#define ORA_HINT_DISABLE_ALL_JOINS	\
+	(ORA_HINT_DISABLE_NESTLOOP | ORA_HINT_DISABLE_MERGEJOIN | \
+	 ORA_HINT_DISABLE_HASHJOIN)
+
+extern List *ora_hints_parse(const char *str);
+extern void ora_hints_register(PlannerInfo *root);
+extern bool ora_hints_block_pullup(PlannerInfo *root, Query *subquery,
+								   RangeTblEntry *rte);
+extern void ora_hints_adjust_rel_size(PlannerInfo *root, RelOptInfo *rel);
+extern int	ora_hints_seqscan_disabled(PlannerInfo *root, RelOptInfo *rel);
+extern int	ora_hints_indexscan_disabled(PlannerInfo *root, RelOptInfo *rel,
+										 IndexOptInfo *index);
+extern int	ora_hints_join_disabled(PlannerInfo *root, RelOptInfo *outerrel,
+									RelOptInfo *innerrel);
+extern void ora_hints_check_plan(PlannerInfo *root, Plan *plan);
+
+#endif							/* ORA_HINTS_H */
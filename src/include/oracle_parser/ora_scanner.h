@@ -114,8 +114,25 @@ typedef struct ora_core_yy_extra_type
 	/* state variables for literal-lexing warnings */
 	bool		warn_on_first_escape;
 	bool		saw_non_ascii;
+
+	/*
+	 * Optimizer hint comments ("slash-star-plus") directly following SELECT,
+	 * INSERT, UPDATE, DELETE or MERGE are collected into hint_comments when
+	 * capture_hints is set; otherwise they are ignored like any comment.
+	 */
+	bool		capture_hints;
+	int			hint_start;		/* offset of current hint's text, or -1 */
+	int			hint_keyword;	/* offset of the keyword it belongs to */
+	List	   *hint_comments;	/* list of OraHintComment */
 } ora_core_yy_extra_type;
 
+/* An optimizer hint comment and the location of the keyword it follows */
+typedef struct OraHintComment
+{
+	int			keyword_location;
+	char	   *text;
+} OraHintComment;
+
 /*
  * The type of yyscanner is opaque outside scan.l.
  */
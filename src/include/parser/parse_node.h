@@ -245,6 +245,7 @@ struct ParseState
 	bool		p_hasTargetSRFs;
 	bool		p_hasSubLinks;
 	bool		p_hasModifyingCTE;
+	bool		p_hasRownum;
 
 	Node	   *p_last_srf;		/* most recent set-returning func/op found */
 
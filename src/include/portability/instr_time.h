@@ -5,8 +5,10 @@
  *
  * This file provides an abstraction layer to hide portability issues in
  * interval timing.  On Unix we use clock_gettime(), and on Windows we use
- * QueryPerformanceCounter().  These macros also give some breathing room to
- * use other high-precision-timing APIs.
+ * QueryPerformanceCounter().  On x86-64 Linux, the CPU's time stamp counter
+ * is read directly instead, if pg_initialize_timing() found it reliable.
+ * These macros also give some breathing room to use other
+ * high-precision-timing APIs.
  *
  * The basic data type is instr_time, which all callers should treat as an
  * opaque typedef.  instr_time can store either an absolute time (of
@@ -19,6 +21,10 @@
  *
  * INSTR_TIME_SET_CURRENT(t)		set t to current time
  *
+ * INSTR_TIME_SET_CURRENT_FAST(t)	set t to current time, possibly without
+ *									waiting for preceding instructions to
+ *									finish; for timing code that runs often
+ *
  * INSTR_TIME_SET_CURRENT_LAZY(t)	set t to current time if t is zero,
  *									evaluates to whether t changed
  *
@@ -44,6 +50,10 @@
  * running sum in instr_time form (ie, use INSTR_TIME_ADD or
  * INSTR_TIME_ACCUM_DIFF) and convert to a result format only at the end.
  *
+ * pg_initialize_timing() must be called at process start before any of
+ * these are used, or they fall back to clock_gettime().  In the server, only
+ * the postmaster calls it.
+ *
  * Beware of multiple evaluations of the macro arguments.
  *
  *
@@ -79,6 +89,14 @@ typedef struct instr_time
 #define NS_PER_US	INT64CONST(1000)
 
 
+/* clock chosen by pg_initialize_timing(), see src/common/instr_time.c */
+extern PGDLLIMPORT bool pg_instr_use_tsc;
+extern PGDLLIMPORT double pg_instr_ns_per_tick;
+
+extern void pg_initialize_timing(void);
+extern const char *pg_timing_clock_source(void);
+
+
 #ifndef WIN32
 
 
@@ -119,11 +137,66 @@ pg_clock_gettime_ns(void)
 	return now;
 }
 
+/*
+ * On x86-64 Linux, read the time stamp counter if pg_initialize_timing()
+ * decided it's reliable; ticks are then TSC cycles rather than nanoseconds.
+ * RDTSCP waits for all preceding instructions to finish before reading the
+ * counter, plain RDTSC doesn't, which makes it a little cheaper.
+ */
+#if defined(__x86_64__) && defined(__linux__) && defined(HAVE__GET_CPUID)
+#define PG_INSTR_TSC 1
+#include <x86intrin.h>
+#endif
+
+static inline instr_time
+pg_get_ticks(void)
+{
+#ifdef PG_INSTR_TSC
+	if (likely(pg_instr_use_tsc))
+	{
+		instr_time	now;
+		unsigned int aux;
+
+		now.ticks = __rdtscp(&aux);
+		return now;
+	}
+#endif
+	return pg_clock_gettime_ns();
+}
+
+static inline instr_time
+pg_get_ticks_fast(void)
+{
+#ifdef PG_INSTR_TSC
+	if (likely(pg_instr_use_tsc))
+	{
+		instr_time	now;
+
+		now.ticks = __rdtsc();
+		return now;
+	}
+#endif
+	return pg_clock_gettime_ns();
+}
+
+static inline int64
+pg_ticks_to_ns(int64 ticks)
+{
+#ifdef PG_INSTR_TSC
+	if (pg_instr_use_tsc)
+		return (int64) (ticks * pg_instr_ns_per_tick);
+#endif
+	return ticks;
+}
+
 #define INSTR_TIME_SET_CURRENT(t) \
-	((t) = pg_clock_gettime_ns())
+	((t) = pg_get_ticks())
+
+#define INSTR_TIME_SET_CURRENT_FAST(t) \
+	((t) = pg_get_ticks_fast())
 
 #define INSTR_TIME_GET_NANOSEC(t) \
-	((int64) (t).ticks)
+	pg_ticks_to_ns((t).ticks)
 
 
 #else							/* WIN32 */
@@ -156,6 +229,9 @@ GetTimerFrequency(void)
 #define INSTR_TIME_SET_CURRENT(t) \
 	((t) = pg_query_performance_counter())
 
+#define INSTR_TIME_SET_CURRENT_FAST(t) \
+	INSTR_TIME_SET_CURRENT(t)
+
 #define INSTR_TIME_GET_NANOSEC(t) \
 	((int64) ((t).ticks * ((double) NS_PER_S / GetTimerFrequency())))
 
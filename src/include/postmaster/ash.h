@@ -0,0 +1,25 @@
+/*-------------------------------------------------------------------------
+ *
+ * ash.h
+ *	  Exports from postmaster/ash.c, the active session history sampler.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * src/include/postmaster/ash.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef ASH_H
+#define ASH_H
+
+/* GUC parameters */
+extern PGDLLIMPORT int active_session_history_size;
+extern PGDLLIMPORT int active_session_history_interval;
+
+extern Size AshShmemSize(void);
+extern void AshShmemInit(void);
+extern void AshRegister(void);
+
+extern void AshSamplerMain(Datum main_arg);
+
+#endif							/* ASH_H */
@@ -0,0 +1,24 @@
+/*-------------------------------------------------------------------------
+ *
+ * awr.h
+ *	  Exports from postmaster/awr.c, the workload repository.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * src/include/postmaster/awr.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef AWR_H
+#define AWR_H
+
+/* GUC parameters */
+extern PGDLLIMPORT char *workload_repository_database;
+extern PGDLLIMPORT int workload_repository_interval;
+extern PGDLLIMPORT int workload_repository_retention;
+
+extern void AwrRegister(void);
+
+extern void AwrWorkerMain(Datum main_arg);
+
+#endif							/* AWR_H */
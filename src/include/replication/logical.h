@@ -112,6 +112,9 @@ typedef struct LogicalDecodingContext
 
 	/* Do we need to process any change in fast_forward mode? */
 	bool		processing_required;
+
+	/* Background worker reading WAL for us, if any */
+	struct LogicalReadWorker *read_worker;
 } LogicalDecodingContext;
 
 
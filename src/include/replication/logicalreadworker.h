@@ -0,0 +1,35 @@
+/*-------------------------------------------------------------------------
+ *
+ * logicalreadworker.h
+ *	  Reading WAL for logical decoding in a background worker
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * src/include/replication/logicalreadworker.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef LOGICALREADWORKER_H
+#define LOGICALREADWORKER_H
+
+#include "replication/logical.h"
+
+/*
+ * Callback used to hold back records until they may be decoded, such as
+ * WalSndWaitForWal().  Returns the position up to which WAL may be decoded,
+ * which can be less than the requested one if we're shutting down.
+ */
+typedef XLogRecPtr (*LogicalReadWorkerWaitCB) (XLogRecPtr loc);
+
+/* GUC variable */
+extern PGDLLIMPORT bool logical_decoding_read_worker;
+
+extern void LogicalReadWorkerStart(LogicalDecodingContext *ctx,
+								   LogicalReadWorkerWaitCB wait_for_wal);
+extern void LogicalReadWorkerStop(LogicalDecodingContext *ctx);
+extern XLogRecord *LogicalDecodingReadRecord(LogicalDecodingContext *ctx,
+											 char **errormsg);
+
+extern void LogicalReadWorkerMain(Datum main_arg);
+
+#endif							/* LOGICALREADWORKER_H */
@@ -14,8 +14,21 @@
 
 #include "access/attmap.h"
 #include "catalog/index.h"
+#include "fmgr.h"
 #include "replication/logicalproto.h"
 
+/*
+ * Input functions of a replicated local attribute, looked up once when the
+ * relation map entry is validated rather than for every value applied.
+ */
+typedef struct LogicalRepAttrIO
+{
+	Oid			typioparam;
+	FmgrInfo	input;			/* text input function */
+	FmgrInfo	receive;		/* binary receive function; fn_oid is
+								 * InvalidOid if the type has none */
+} LogicalRepAttrIO;
+
 typedef struct LogicalRepRelMapEntry
 {
 	LogicalRepRelation remoterel;	/* key is remoterel.remoteid */
@@ -31,6 +44,7 @@ typedef struct LogicalRepRelMapEntry
 	Oid			localreloid;	/* local relation id */
 	Relation	localrel;		/* relcache entry (NULL when closed) */
 	AttrMap    *attrmap;		/* map of local attributes to remote ones */
+	LogicalRepAttrIO *attrio;	/* input functions of local attributes */
 	bool		updatable;		/* Can apply updates/deletes? */
 	Oid			localindexoid;	/* which index to use, or InvalidOid if none */
 
@@ -26,6 +26,7 @@
 /* GUC variables */
 extern PGDLLIMPORT int logical_decoding_work_mem;
 extern PGDLLIMPORT int debug_logical_replication_streaming;
+extern PGDLLIMPORT int logical_decoding_spill_compression;
 
 /* possible values for debug_logical_replication_streaming */
 typedef enum
@@ -34,6 +35,15 @@ typedef enum
 	DEBUG_LOGICAL_REP_STREAMING_IMMEDIATE,
 }			DebugLogicalRepStreamingMode;
 
+/* possible values for logical_decoding_spill_compression */
+typedef enum
+{
+	REORDER_BUFFER_SPILL_COMPRESSION_NONE,
+	REORDER_BUFFER_SPILL_COMPRESSION_PGLZ,
+	REORDER_BUFFER_SPILL_COMPRESSION_LZ4,
+	REORDER_BUFFER_SPILL_COMPRESSION_ZSTD,
+}			ReorderBufferSpillCompression;
+
 /*
  * Types of the change passed to a 'change' callback.
  *
@@ -668,6 +678,11 @@ struct ReorderBuffer
 	char	   *outbuf;
 	Size		outbufsize;
 
+	/* block of changes being spilled, and buffer to compress it */
+	char	   *spillbuf;
+	Size		spilllen;
+	char	   *compressbuf;
+
 	/* memory accounting */
 	Size		size;
 
@@ -684,6 +699,8 @@ struct ReorderBuffer
 	int64		spillTxns;		/* number of transactions spilled to disk */
 	int64		spillCount;		/* spill-to-disk invocation counter */
 	int64		spillBytes;		/* amount of data spilled to disk */
+	int64		spillDiskBytes; /* amount of data written when spilling */
+	int64		spillWriteTime; /* time spent spilling data, in usec */
 
 	/* Statistics about transactions streamed to the decoding output plugin */
 	int64		streamTxns;		/* number of transactions streamed */
@@ -32,6 +32,7 @@ typedef enum LogicalRepWorkerType
 	WORKERTYPE_TABLESYNC,
 	WORKERTYPE_APPLY,
 	WORKERTYPE_PARALLEL_APPLY,
+	WORKERTYPE_TABLESYNC_COPY,
 } LogicalRepWorkerType;
 
 typedef struct LogicalRepWorker
@@ -66,6 +67,17 @@ typedef struct LogicalRepWorker
 	XLogRecPtr	relstate_lsn;
 	slock_t		relmutex;
 
+	/*
+	 * Progress of a table copy split into block ranges, see tablesync.c.
+	 * Protected by relmutex.  copy_ranges_total is 0 when the worker is not
+	 * taking part in such a copy.
+	 */
+	BlockNumber copy_range_start;
+	BlockNumber copy_range_end;
+	int			copy_ranges_done;
+	int			copy_ranges_total;
+	uint64		copy_tuples;
+
 	/*
 	 * Used to create the changes and subxact files for the streaming
 	 * transactions.  Upon the arrival of the first streaming transaction or
@@ -79,6 +91,7 @@ typedef struct LogicalRepWorker
 
 	/*
 	 * PID of leader apply worker if this slot is used for a parallel apply
+	 * worker, PID of the tablesync worker if it is used for a table copy
 	 * worker, InvalidPid otherwise.
 	 */
 	pid_t		leader_pid;
@@ -330,6 +343,8 @@ extern void pa_xact_finish(ParallelApplyWorkerInfo *winfo,
 									   (worker)->type == WORKERTYPE_PARALLEL_APPLY)
 #define isTablesyncWorker(worker) ((worker)->in_use && \
 								   (worker)->type == WORKERTYPE_TABLESYNC)
+#define isTableCopyWorker(worker) ((worker)->in_use && \
+								   (worker)->type == WORKERTYPE_TABLESYNC_COPY)
 
 static inline bool
 am_tablesync_worker(void)
@@ -337,6 +352,12 @@ am_tablesync_worker(void)
 	return isTablesyncWorker(MyLogicalRepWorker);
 }
 
+static inline bool
+am_table_copy_worker(void)
+{
+	return isTableCopyWorker(MyLogicalRepWorker);
+}
+
 static inline bool
 am_leader_apply_worker(void)
 {
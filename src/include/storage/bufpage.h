@@ -184,13 +184,27 @@ typedef PageHeaderData *PageHeader;
  * PD_PAGE_FULL is set if an UPDATE doesn't find enough free space in the
  * page for its new tuple version; this suggests that a prune is needed.
  * Again, this is just a hint.
+ *
+ * The PD_COMPRESSION bits ask the storage manager to store the page
+ * compressed with the given method when it is written out (see
+ * common/pagecompress.h).  They are set from the page_compression option of
+ * the table whenever a tuple is added to the page, and are just a hint too:
+ * a page that lacks them is merely stored uncompressed.
  */
 #define PD_HAS_FREE_LINES	0x0001	/* are there any unused line pointers? */
 #define PD_PAGE_FULL		0x0002	/* not enough free space for new tuple? */
 #define PD_ALL_VISIBLE		0x0004	/* all tuples on page are visible to
 									 * everyone */
+#define PD_COMPRESSION		0x0018	/* page compression method */
+
+#define PD_VALID_FLAG_BITS	0x001F	/* OR of all valid pd_flags bits */
+
+#define PD_COMPRESSION_SHIFT	3
 
-#define PD_VALID_FLAG_BITS	0x0007	/* OR of all valid pd_flags bits */
+/* Page compression methods, stored in the PD_COMPRESSION bits */
+#define PAGE_COMPRESSION_NONE	0
+#define PAGE_COMPRESSION_PGLZ	1
+#define PAGE_COMPRESSION_LZ4	2
 
 /*
  * Page layout version number 0 is for pre-7.3 Postgres releases.
@@ -442,6 +456,20 @@ PageClearAllVisible(Page page)
 	((PageHeader) page)->pd_flags &= ~PD_ALL_VISIBLE;
 }
 
+static inline int
+PageGetCompression(const PageData *page)
+{
+	return (((const PageHeaderData *) page)->pd_flags & PD_COMPRESSION) >>
+		PD_COMPRESSION_SHIFT;
+}
+static inline void
+PageSetCompression(Page page, int method)
+{
+	((PageHeader) page)->pd_flags &= ~PD_COMPRESSION;
+	((PageHeader) page)->pd_flags |= (method << PD_COMPRESSION_SHIFT) &
+		PD_COMPRESSION;
+}
+
 /*
  * These two require "access/transam.h", so left as macros.
  */
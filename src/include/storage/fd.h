@@ -115,6 +115,7 @@ extern int	FileStartReadV(struct PgAioHandle *ioh, File file, int iovcnt, off_t
 extern int	FileSync(File file, uint32 wait_event_info);
 extern int	FileZero(File file, off_t offset, off_t amount, uint32 wait_event_info);
 extern int	FileFallocate(File file, off_t offset, off_t amount, uint32 wait_event_info);
+extern int	FilePunchHole(File file, off_t offset, off_t amount, uint32 wait_event_info);
 
 extern off_t FileSize(File file);
 extern int	FileTruncate(File file, off_t offset, uint32 wait_event_info);
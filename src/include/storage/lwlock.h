@@ -221,6 +221,13 @@ typedef enum BuiltinTrancheIds
 	LWTRANCHE_XACT_SLRU,
 	LWTRANCHE_PARALLEL_VACUUM_DSA,
 	LWTRANCHE_AIO_URING_COMPLETION,
+	LWTRANCHE_SHARED_PLAN_CACHE_DSA,
+	LWTRANCHE_SHARED_PLAN_CACHE_HASH,
+	LWTRANCHE_SHARED_CATALOG_CACHE_DSA,
+	LWTRANCHE_SHARED_CATALOG_CACHE_HASH,
+	LWTRANCHE_SHARED_TS_DICTIONARY_DSA,
+	LWTRANCHE_SHARED_TS_DICTIONARY,
+	LWTRANCHE_ACTIVE_SESSION_HISTORY,
 	LWTRANCHE_FIRST_USER_DEFINED,
 }			BuiltinTrancheIds;
 
@@ -17,6 +17,7 @@
 #include "regex/regex.h"
 #include "tsearch/dicts/regis.h"
 #include "tsearch/ts_public.h"
+#include "utils/sharedtsdict.h"
 
 /*
  * SPNode and SPNodeData are used to represent prefix tree (Trie) to store
@@ -100,9 +101,14 @@ typedef struct aff_struct
 		/*
 		 * Arrays of AFFIX are moved and sorted.  We'll use a pointer to
 		 * regex_t to keep this struct small, and avoid assuming that regex_t
-		 * is movable.
+		 * is movable.  The mask is kept as well, because a dictionary in
+		 * shared memory has no regex_t of its own; see NIAttachShared().
 		 */
-		regex_t    *pregex;
+		struct
+		{
+			regex_t    *pregex;
+			const char *mask;
+		}			regex;
 		Regis		regis;
 	}			reg;
 } AFFIX;
@@ -187,6 +193,12 @@ typedef struct
 	int			naffixes;
 	AFFIX	   *Affix;
 
+	/*
+	 * If the dictionary lives in shared memory, this backend's compiled
+	 * regexes of its affixes, indexed like Affix.
+	 */
+	regex_t   **AffixRegex;
+
 	AffixNode  *Suffix;
 	AffixNode  *Prefix;
 
@@ -238,4 +250,8 @@ extern void NISortDictionary(IspellDict *Conf);
 extern void NISortAffixes(IspellDict *Conf);
 extern void NIFinishBuild(IspellDict *Conf);
 
+extern void NICopyShared(IspellDict *dst, const IspellDict *src,
+						 SharedTSDictArena *arena);
+extern void NIAttachShared(IspellDict *Conf);
+
 #endif
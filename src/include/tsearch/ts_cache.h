@@ -60,6 +60,8 @@ typedef struct TSDictionaryCacheEntry
 
 	MemoryContext dictCtx;		/* memory context to store private data */
 	void	   *dictData;
+
+	void	   *sharedRef;		/* reference to a copy in shared memory */
 } TSDictionaryCacheEntry;
 
 typedef struct
@@ -332,6 +332,8 @@ extern const char *pgstat_get_crashed_backend_activity(int pid, char *buffer,
 extern int64 pgstat_get_my_query_id(void);
 extern int64 pgstat_get_my_plan_id(void);
 extern BackendType pgstat_get_backend_type_by_proc_number(ProcNumber procNumber);
+extern bool pgstat_read_backend_status(ProcNumber procNumber,
+									   PgBackendStatus *result);
 
 
 /* ----------
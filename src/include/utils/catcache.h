@@ -132,7 +132,13 @@ typedef struct catctup
 	struct catclist *c_list;	/* containing CatCList, or NULL if none */
 
 	CatCache   *my_cache;		/* link to owning catcache */
-	/* properly aligned tuple data follows, unless a negative entry */
+
+	/*
+	 * If not NULL, the tuple data lives in the shared catalog cache rather
+	 * than following this struct, and this is our reference to it.
+	 */
+	void	   *shared_ref;
+	/* properly aligned tuple data follows, unless a negative or shared entry */
 } CatCTup;
 
 
@@ -27,6 +27,7 @@ typedef void (*RelSyncCallbackFunction) (Datum arg, Oid relid);
 
 extern void AcceptInvalidationMessages(void);
 
+extern void PreCommit_Inval(void);
 extern void AtEOXact_Inval(bool isCommit);
 
 extern void PreInplace_Inval(void);
@@ -0,0 +1,43 @@
+/*-------------------------------------------------------------------------
+ *
+ * membroker.h
+ *	  Instance-wide broker of executor work memory.
+ *
+ * See membroker.c for comments.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * src/include/utils/membroker.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef MEMBROKER_H
+#define MEMBROKER_H
+
+/* identifies a grant within the backend holding it */
+typedef uint64 MemoryBrokerHandle;
+
+#define InvalidMemoryBrokerHandle	((MemoryBrokerHandle) 0)
+
+/* GUC parameter */
+extern PGDLLIMPORT int work_mem_target;
+
+extern Size MemoryBrokerShmemSize(void);
+extern void MemoryBrokerShmemInit(void);
+
+extern int	MemoryBrokerAcquire(int wanted_kb, MemoryBrokerHandle *handle);
+extern void MemoryBrokerRelease(MemoryBrokerHandle handle);
+extern void AtEOXact_MemoryBroker(bool isCommit);
+extern void AtEOSubXact_MemoryBroker(bool isCommit, int nestDepth);
+
+/*
+ * The memory limit, in kB, of an operation holding grant_kb from
+ * MemoryBrokerAcquire, whose own limit is limit_kb.
+ */
+static inline int
+MemoryBrokerLimit(int grant_kb, int limit_kb)
+{
+	return grant_kb > 0 ? grant_kb : limit_kb;
+}
+
+#endif							/* MEMBROKER_H */
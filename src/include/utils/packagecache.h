@@ -106,6 +106,9 @@ extern PackageCacheItem *PackageHandle(Oid objectid, bool is_body);
 extern void FreePackageCache(PackageCacheKey *key);
 extern PackageCacheItem *PackageCacheDelete(PackageCacheKey *key);
 extern void PackageCacheInsert(PackageCacheKey *key, PackageCacheItem *item);
+extern void PackageCacheSetBodyHash(PackageCacheItem *item, Oid bodyoid);
+extern void PackageCacheMarkUpdated(Oid pkgoid, bool is_body);
+extern void PackageCacheReportCompile(Oid pkgoid, double elapsed_ms);
 extern PGDLLIMPORT MemoryContext PackageCacheContext;
 
 extern void ResetPackageCaches(void);
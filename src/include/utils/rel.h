@@ -338,6 +338,14 @@ typedef enum StdRdOptIndexCleanup
 	STDRD_OPTION_VACUUM_INDEX_CLEANUP_ON,
 } StdRdOptIndexCleanup;
 
+/* StdRdOptions->fast_refresh values */
+typedef enum StdRdOptFastRefresh
+{
+	STDRD_OPTION_FAST_REFRESH_OFF = 0,
+	STDRD_OPTION_FAST_REFRESH_DEMAND,
+	STDRD_OPTION_FAST_REFRESH_COMMIT,
+} StdRdOptFastRefresh;
+
 typedef struct StdRdOptions
 {
 	int32		vl_len_;		/* varlena header (do not touch directly!) */
@@ -345,6 +353,9 @@ typedef struct StdRdOptions
 	int			toast_tuple_target; /* target for tuple toasting */
 	AutoVacOpts autovacuum;		/* autovacuum-related options */
 	bool		user_catalog_table; /* use as an additional catalog relation */
+	bool		index_organized;	/* keep rows in primary key order */
+	int			page_compression;	/* PAGE_COMPRESSION_xxx of new pages */
+	StdRdOptFastRefresh fast_refresh;	/* how a matview is kept up to date */
 	int			parallel_workers;	/* max number of parallel workers */
 	StdRdOptIndexCleanup vacuum_index_cleanup;	/* controls index vacuuming */
 	bool		vacuum_truncate;	/* enables vacuum to truncate a relation */
@@ -401,6 +412,39 @@ typedef struct StdRdOptions
 	  (relation)->rd_rel->relkind == RELKIND_MATVIEW) ? \
 	 ((StdRdOptions *) (relation)->rd_options)->user_catalog_table : false)
 
+/*
+ * RelationIsIndexOrganized
+ *		Returns whether inserts and rewrites of the relation should place
+ *		tuples in primary key order.  Note multiple eval of argument!
+ */
+#define RelationIsIndexOrganized(relation)	\
+	((relation)->rd_options && \
+	 (relation)->rd_rel->relkind == RELKIND_RELATION ? \
+	 ((StdRdOptions *) (relation)->rd_options)->index_organized : false)
+
+/*
+ * RelationGetPageCompression
+ *		Returns the PAGE_COMPRESSION_xxx method the relation's pages should
+ *		be stored with.  Note multiple eval of argument!
+ */
+#define RelationGetPageCompression(relation) \
+	((relation)->rd_options && \
+	 ((relation)->rd_rel->relkind == RELKIND_RELATION || \
+	  (relation)->rd_rel->relkind == RELKIND_MATVIEW) ? \
+	 ((StdRdOptions *) (relation)->rd_options)->page_compression : \
+	 PAGE_COMPRESSION_NONE)
+
+/*
+ * RelationGetFastRefresh
+ *		Returns how a materialized view is refreshed from the changes logged
+ *		on its base tables.  Note multiple eval of argument!
+ */
+#define RelationGetFastRefresh(relation) \
+	((relation)->rd_options && \
+	 (relation)->rd_rel->relkind == RELKIND_MATVIEW ? \
+	 ((StdRdOptions *) (relation)->rd_options)->fast_refresh : \
+	 STDRD_OPTION_FAST_REFRESH_OFF)
+
 /*
  * RelationGetParallelWorkers
  *		Returns the relation's parallel_workers reloption setting.
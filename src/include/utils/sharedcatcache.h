@@ -0,0 +1,44 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedcatcache.h
+ *	  Cross-backend cache of catalog tuples.
+ *
+ * See sharedcatcache.c for comments.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * src/include/utils/sharedcatcache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SHAREDCATCACHE_H
+#define SHAREDCATCACHE_H
+
+#include "access/htup.h"
+#include "storage/sinval.h"
+
+/* GUC parameter */
+extern PGDLLIMPORT int shared_catalog_cache_size;
+
+/* does a tuple in the shared cache have the keys being searched for? */
+typedef bool (*SharedCatCacheMatchFn) (HeapTuple tuple, void *arg);
+
+extern Size SharedCatCacheShmemSize(void);
+extern void SharedCatCacheShmemInit(void);
+
+extern bool SharedCatCacheEnabled(void);
+extern uint64 SharedCatCacheGeneration(uint32 hashValue);
+extern void *SharedCatCacheLookup(int cacheId, Oid dbId, uint32 hashValue,
+								  SharedCatCacheMatchFn match, void *arg,
+								  HeapTuple tuple);
+extern void SharedCatCacheInsert(int cacheId, Oid reloid, Oid dbId,
+								 uint32 hashValue, HeapTuple tuple,
+								 SharedCatCacheMatchFn match, void *arg,
+								 uint64 generation);
+extern void SharedCatCacheRelease(void *ref);
+
+extern void SharedCatCachePrepareInvalidate(void);
+extern void SharedCatCacheInvalidate(const SharedInvalidationMessage *msgs,
+									 int n);
+
+#endif							/* SHAREDCATCACHE_H */
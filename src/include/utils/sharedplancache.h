@@ -0,0 +1,41 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedplancache.h
+ *	  Cross-backend cache of generic plans.
+ *
+ * See sharedplancache.c for comments.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * src/include/utils/sharedplancache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SHAREDPLANCACHE_H
+#define SHAREDPLANCACHE_H
+
+#include "nodes/pg_list.h"
+#include "storage/sinval.h"
+#include "utils/plancache.h"
+
+/* GUC parameter */
+extern PGDLLIMPORT int shared_plan_cache_size;
+
+extern Size SharedPlanCacheShmemSize(void);
+extern void SharedPlanCacheShmemInit(void);
+
+extern bool SharedPlanCacheUsable(CachedPlanSource *plansource);
+extern uint64 SharedPlanCacheGeneration(void);
+extern List *SharedPlanCacheLookup(CachedPlanSource *plansource);
+extern void SharedPlanCacheInsert(CachedPlanSource *plansource,
+								  List *stmt_list, uint64 generation);
+
+extern void SharedPlanCacheInvalidateRelation(Oid relid);
+extern void SharedPlanCacheInvalidateObject(int cacheid, uint32 hashvalue);
+extern void SharedPlanCacheReset(void);
+
+extern void SharedPlanCachePrepareInvalidate(void);
+extern void SharedPlanCacheInvalidate(const SharedInvalidationMessage *msgs,
+									  int n);
+
+#endif							/* SHAREDPLANCACHE_H */
@@ -0,0 +1,51 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedtsdict.h
+ *	  Cross-backend store of loaded text search dictionaries.
+ *
+ * See sharedtsdict.c for comments.
+ *
+ * Portions Copyright (c) 2023-2025, IvorySQL Global Development Team
+ *
+ * src/include/utils/sharedtsdict.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SHAREDTSDICT_H
+#define SHAREDTSDICT_H
+
+/* GUC parameter */
+extern PGDLLIMPORT int shared_ts_dictionary_size;
+
+/* allocator used while copying a dictionary into shared memory */
+typedef struct SharedTSDictArena SharedTSDictArena;
+
+/*
+ * Template support for sharing.  The copy function copies a dictionary built
+ * by the template's init method into the arena and returns the copy; the
+ * attach function turns such a copy into the dictData the template's lexize
+ * method expects, allocating any private state in CurrentMemoryContext.
+ */
+typedef void *(*SharedTSDictCopyFn) (void *dictData, SharedTSDictArena *arena);
+typedef void *(*SharedTSDictAttachFn) (void *image);
+
+extern Size SharedTSDictShmemSize(void);
+extern void SharedTSDictShmemInit(void);
+
+extern bool SharedTSDictEnabled(void);
+extern void *SharedTSDictLookup(Oid dictId, TransactionId xmin, void **image);
+extern void *SharedTSDictPublish(Oid dictId, TransactionId xmin,
+								 SharedTSDictCopyFn copy, void *dictData,
+								 void **image);
+extern void SharedTSDictRelease(void *ref);
+
+extern void *SharedTSDictAlloc(SharedTSDictArena *arena, Size size);
+extern char *SharedTSDictStrdup(SharedTSDictArena *arena, const char *str);
+
+/* shareable built-in templates, in tsearch/dict_*.c */
+extern void *dispell_copy_shared(void *dictData, SharedTSDictArena *arena);
+extern void *dispell_attach_shared(void *image);
+extern void *dsynonym_copy_shared(void *dictData, SharedTSDictArena *arena);
+extern void *dsynonym_attach_shared(void *image);
+
+#endif							/* SHAREDTSDICT_H */
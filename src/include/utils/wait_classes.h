@@ -26,4 +26,7 @@
 #define PG_WAIT_IO					0x0A000000U
 #define PG_WAIT_INJECTIONPOINT		0x0B000000U
 
+/* Extracts the class from a wait_event_info value */
+#define WAIT_EVENT_CLASS_MASK		0xFF000000
+
 #endif							/* WAIT_CLASSES_H */
@@ -0,0 +1,53 @@
+--
+-- Oracle-style optimizer hints
+--
+CREATE TABLE hint_a (id int PRIMARY KEY, val int);
+CREATE TABLE hint_b (id int PRIMARY KEY, a_id int);
+INSERT INTO hint_a SELECT i, i % 100 FROM generate_series(1, 10000) i;
+INSERT INTO hint_b SELECT i, i % 1000 + 1 FROM generate_series(1, 10000) i;
+ANALYZE hint_a;
+ANALYZE hint_b;
+
+-- access path hints
+EXPLAIN (COSTS OFF) SELECT * FROM hint_a WHERE id = 42;
+EXPLAIN (COSTS OFF) SELECT /*+ FULL(hint_a) */ * FROM hint_a WHERE id = 42;
+EXPLAIN (COSTS OFF) SELECT /*+ full(a) */ * FROM hint_a a WHERE id = 42;
+EXPLAIN (COSTS OFF) SELECT /*+ INDEX(a hint_a_pkey) */ * FROM hint_a a WHERE id > 0;
+EXPLAIN (COSTS OFF) SELECT /*+ NO_INDEX(a) */ * FROM hint_a a WHERE id = 42;
+-- a hint the plan can't follow is reported as not used
+EXPLAIN (COSTS OFF) SELECT /*+ INDEX(a) */ * FROM hint_a a WHERE val = 5;
+
+-- hints naming unknown tables, unknown hints, and misplaced hint comments
+EXPLAIN (COSTS OFF) SELECT /*+ FULL(nosuch) */ * FROM hint_a WHERE id = 42;
+EXPLAIN (COSTS OFF) SELECT /*+ FULL(hint_a) BOGUS(x) PARALLEL(hint_a 0) */ * FROM hint_a WHERE id = 42;
+EXPLAIN (COSTS OFF) SELECT * /*+ FULL(hint_a) */ FROM hint_a WHERE id = 42;
+EXPLAIN (COSTS OFF) SELECT /* FULL(hint_a) */ * FROM hint_a WHERE id = 42;
+
+-- join order and join method hints
+EXPLAIN (COSTS OFF)
+SELECT /*+ LEADING(a b) USE_NL(b) */ a.val, b.a_id
+  FROM hint_a a, hint_b b WHERE a.id = b.id;
+EXPLAIN (COSTS OFF)
+SELECT /*+ LEADING(b a) USE_HASH(a) */ a.val, b.a_id
+  FROM hint_a a, hint_b b WHERE a.id = b.id;
+
+-- size estimates
+EXPLAIN (COSTS OFF) SELECT /*+ CARDINALITY(a 5) */ * FROM hint_a a WHERE val = 5;
+
+-- subquery merging
+EXPLAIN (COSTS OFF) SELECT v.id + v.val FROM (SELECT id, val FROM hint_a WHERE id < 10) v;
+EXPLAIN (COSTS OFF)
+SELECT /*+ NO_MERGE(v) */ v.id + v.val FROM (SELECT id, val FROM hint_a WHERE id < 10) v;
+
+-- hints inside views are kept, and apply once the view is merged
+CREATE VIEW hint_v AS SELECT /*+ FULL(hint_a) */ id FROM hint_a;
+SELECT pg_get_viewdef('hint_v');
+EXPLAIN (COSTS OFF) SELECT * FROM hint_v WHERE id = 42;
+
+-- DML
+EXPLAIN (COSTS OFF) UPDATE /*+ FULL(hint_a) */ hint_a SET val = 0 WHERE id = 1;
+EXPLAIN (COSTS OFF) DELETE /*+ FULL(hint_b) */ FROM hint_b WHERE id = 1;
+
+DROP VIEW hint_v;
+DROP TABLE hint_a;
+DROP TABLE hint_b;
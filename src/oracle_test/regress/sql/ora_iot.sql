@@ -0,0 +1,47 @@
+--
+-- Index-organized tables (ORGANIZATION INDEX)
+--
+CREATE TABLE iot_t (id int PRIMARY KEY, val text) ORGANIZATION INDEX;
+SELECT reloptions FROM pg_class WHERE relname = 'iot_t';
+DROP TABLE iot_t;
+
+-- a primary key is required
+CREATE TABLE iot_nopk (id int, val text) ORGANIZATION INDEX;
+CREATE TABLE iot_bad (id int PRIMARY KEY) ORGANIZATION columnar;
+
+-- ORGANIZATION HEAP is the default
+CREATE TABLE iot_heap (id int PRIMARY KEY, val text) ORGANIZATION HEAP WITH (fillfactor = 50);
+SELECT reloptions FROM pg_class WHERE relname = 'iot_heap';
+
+-- rows are placed next to their primary key neighbors, within fillfactor
+CREATE TABLE iot_t (id int PRIMARY KEY, val text) ORGANIZATION INDEX WITH (fillfactor = 50);
+SELECT reloptions FROM pg_class WHERE relname = 'iot_t';
+-- six rows leave room for one more on the first page, but not for a wide one
+INSERT INTO iot_t SELECT i * 10, repeat('x', 500) FROM generate_series(1, 6) i;
+INSERT INTO iot_heap SELECT i * 10, repeat('x', 500) FROM generate_series(1, 6) i;
+INSERT INTO iot_t VALUES (1000, repeat('x', 1500));
+INSERT INTO iot_heap VALUES (1000, repeat('x', 1500));
+INSERT INTO iot_t VALUES (15, repeat('x', 500));
+INSERT INTO iot_heap VALUES (15, repeat('x', 500));
+SELECT (a.ctid::text::point)[0] = (b.ctid::text::point)[0] AS same_page
+  FROM iot_t a, iot_t b WHERE a.id = 15 AND b.id = 10;
+SELECT (a.ctid::text::point)[0] = (b.ctid::text::point)[0] AS same_page
+  FROM iot_heap a, iot_heap b WHERE a.id = 15 AND b.id = 10;
+
+-- the space reserved by fillfactor is not used
+INSERT INTO iot_t VALUES (25, repeat('x', 500));
+SELECT (a.ctid::text::point)[0] = (b.ctid::text::point)[0] AS same_page
+  FROM iot_t a, iot_t b WHERE a.id = 25 AND b.id = 20;
+
+-- CLUSTER and VACUUM FULL rewrite the table in primary key order
+DELETE FROM iot_t WHERE id > 100;
+CLUSTER iot_t;
+SELECT array_agg(id ORDER BY ctid) FROM iot_t;
+INSERT INTO iot_t VALUES (5, 'a'), (1, 'b');
+VACUUM FULL iot_t;
+SELECT array_agg(id ORDER BY ctid) FROM iot_t;
+
+ALTER TABLE iot_t SET (index_organized = false);
+SELECT reloptions FROM pg_class WHERE relname = 'iot_t';
+
+DROP TABLE iot_t, iot_heap;
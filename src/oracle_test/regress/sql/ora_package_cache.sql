@@ -0,0 +1,57 @@
+--
+-- Package cache: recompiling a package after what it depends on changes
+--
+CREATE TABLE pc_t (id integer, val integer);
+
+CREATE OR REPLACE PACKAGE pc_pkg IS
+  var1 pc_t.val%TYPE;
+  FUNCTION show_val(v numeric) RETURN varchar;
+END;
+/
+CREATE OR REPLACE PACKAGE BODY pc_pkg IS
+  FUNCTION show_val(v numeric) RETURN varchar AS
+  BEGIN
+    var1 := v;
+    RETURN var1;
+  END;
+END;
+/
+SELECT pc_pkg.show_val(2.5) FROM dual;
+CREATE TEMP TABLE pc_base AS
+  SELECT invalidations, compiles FROM pg_package_cache_stats
+   WHERE packagename = 'pc_pkg';
+
+-- changing the column behind var1's %TYPE invalidates the cached package
+ALTER TABLE pc_t ALTER COLUMN val TYPE numeric;
+SELECT s.valid, s.invalidations > b.invalidations AS invalidated
+  FROM pg_package_cache_stats s, pc_base b
+ WHERE s.packagename = 'pc_pkg';
+
+-- the package is recompiled with var1 numeric, dropping its old state
+SELECT pc_pkg.show_val(2.5) FROM dual;  -- error, state discarded
+SELECT pc_pkg.show_val(2.5) FROM dual;
+SELECT s.valid, s.compiles > b.compiles AS recompiled
+  FROM pg_package_cache_stats s, pc_base b
+ WHERE s.packagename = 'pc_pkg';
+UPDATE pc_base SET (invalidations, compiles) =
+  (SELECT invalidations, compiles FROM pg_package_cache_stats
+    WHERE packagename = 'pc_pkg');
+
+-- replacing the body invalidates the cached package through its body's
+-- syscache entry
+CREATE OR REPLACE PACKAGE BODY pc_pkg IS
+  FUNCTION show_val(v numeric) RETURN varchar AS
+  BEGIN
+    var1 := v + 1;
+    RETURN var1;
+  END;
+END;
+/
+SELECT s.valid, s.invalidations > b.invalidations AS invalidated,
+       s.compiles > b.compiles AS recompiled
+  FROM pg_package_cache_stats s, pc_base b
+ WHERE s.packagename = 'pc_pkg';
+SELECT pc_pkg.show_val(2.5) FROM dual;
+
+DROP PACKAGE pc_pkg;
+DROP TABLE pc_t;
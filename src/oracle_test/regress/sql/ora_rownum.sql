@@ -0,0 +1,63 @@
+--
+-- ROWNUM pseudo-column
+--
+CREATE TABLE rn_t (id int PRIMARY KEY, val int);
+INSERT INTO rn_t SELECT i, (i * 7) % 100 FROM generate_series(1, 1000) i;
+ANALYZE rn_t;
+
+-- numbering of an ordered inline view
+SELECT ROWNUM AS rn, id FROM (SELECT id FROM rn_t ORDER BY id DESC) s WHERE ROWNUM <= 3;
+
+-- caps on ROWNUM become a LIMIT
+EXPLAIN (COSTS OFF)
+SELECT id FROM (SELECT id, val FROM rn_t ORDER BY val) s WHERE ROWNUM <= 5;
+SELECT id FROM (SELECT id FROM rn_t ORDER BY id) s WHERE ROWNUM < 3;
+SELECT id FROM (SELECT id FROM rn_t ORDER BY id) s WHERE 2 >= ROWNUM;
+SELECT id FROM (SELECT id FROM rn_t ORDER BY id) s WHERE ROWNUM = 1;
+SELECT id FROM (SELECT id FROM rn_t ORDER BY id) s WHERE ROWNUM = 2;
+SELECT id FROM (SELECT id FROM rn_t ORDER BY id) s WHERE ROWNUM <= 0;
+PREPARE rn_q(int) AS
+  SELECT id FROM (SELECT id FROM rn_t ORDER BY id) s WHERE ROWNUM <= $1;
+EXECUTE rn_q(2);
+EXECUTE rn_q(-1);
+DEALLOCATE rn_q;
+
+-- top-N pagination
+EXPLAIN (COSTS OFF)
+SELECT id, rn FROM
+  (SELECT s.id, ROWNUM AS rn FROM (SELECT id FROM rn_t ORDER BY val, id) s
+    WHERE ROWNUM <= 6) p
+ WHERE rn > 3;
+SELECT id, rn FROM
+  (SELECT s.id, ROWNUM AS rn FROM (SELECT id FROM rn_t ORDER BY val, id) s
+    WHERE ROWNUM <= 6) p
+ WHERE rn > 3;
+
+-- other uses are evaluated as rows are produced
+EXPLAIN (COSTS OFF) SELECT count(*) FROM rn_t WHERE ROWNUM <= 10;
+SELECT count(*) FROM rn_t WHERE ROWNUM <= 10;
+SELECT count(*) FROM rn_t WHERE ROWNUM > 1;
+SELECT count(*) FROM rn_t a, rn_t b WHERE a.id = b.id AND ROWNUM <= 5;
+
+-- views
+CREATE VIEW rn_v AS SELECT id FROM rn_t WHERE ROWNUM <= 2;
+SELECT pg_get_viewdef('rn_v'::regclass);
+DROP VIEW rn_v;
+
+-- not allowed everywhere
+SELECT count(*) FROM rn_t GROUP BY ROWNUM;
+
+DROP TABLE rn_t;
+
+-- partitioned tables are numbered as a whole, not per partition
+CREATE TABLE rn_p (id int, val int) PARTITION BY RANGE (id);
+CREATE TABLE rn_p1 PARTITION OF rn_p FOR VALUES FROM (1) TO (4);
+CREATE TABLE rn_p2 PARTITION OF rn_p FOR VALUES FROM (4) TO (7);
+INSERT INTO rn_p SELECT i, 0 FROM generate_series(1, 6) i;
+SELECT ROWNUM AS rn, id FROM rn_p;
+PREPARE rn_pq(int) AS SELECT id FROM rn_p WHERE ROWNUM < $1;
+EXECUTE rn_pq(5);
+DEALLOCATE rn_pq;
+UPDATE rn_p SET val = ROWNUM;
+SELECT id, val FROM rn_p ORDER BY id;
+DROP TABLE rn_p;
@@ -46,6 +46,7 @@
 #include "access/genam.h"
 #include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
+#include "portability/instr_time.h"
 
 
 PLiSQL_package *plisql_compile_packageitem;
@@ -839,8 +840,7 @@ package_body_doCompile(HeapTuple pkgbodyTup,
 	body_source = TextDatumGetCString(pkgbodydatum);
 	scanner = plisql_scanner_init(body_source);
 
-	item->body_hash_value = GetSysCacheHashValue1(PKGBODYOID,
-									ObjectIdGetDatum(bodyStruct->oid));
+	PackageCacheSetBodyHash(item, bodyStruct->oid);
 	psource = (PLiSQL_package *) item->source;
 	function = &psource->source;
 
@@ -1407,8 +1407,14 @@ plisql_package_compile(Oid pkgoid,
 	if (!package_valid)
 	{
 		PLiSQL_package *newpsource;
+		instr_time	start_time;
+		instr_time	duration;
 
+		INSTR_TIME_SET_CURRENT(start_time);
 		item = package_doCompile(pkgTup, forValidator);
+		INSTR_TIME_SET_CURRENT(duration);
+		INSTR_TIME_SUBTRACT(duration, start_time);
+		PackageCacheReportCompile(pkgoid, INSTR_TIME_GET_MILLISEC(duration));
 		newpsource = (PLiSQL_package *) item->source;
 
 		/*
@@ -1447,6 +1453,8 @@ plisql_package_body_compile(Oid bodyoid,
 	bool	package_valid = true;
 	bool	package_body_valid = true;
 	PLiSQL_package *newpsource;
+	instr_time	start_time;
+	instr_time	duration;
 
 	/*
 	 * Lookup the pg_package_body tuple by Oid
@@ -1483,6 +1491,8 @@ plisql_package_body_compile(Oid bodyoid,
 		package_valid = false;
 	}
 
+	INSTR_TIME_SET_CURRENT(start_time);
+
 	if (!package_body_valid || !package_valid)
 	{
 		bool	hasbody = false;
@@ -1525,6 +1535,10 @@ plisql_package_body_compile(Oid bodyoid,
 
 	package_body_doCompile(pkgbodyTup, item, forValidator);
 
+	INSTR_TIME_SET_CURRENT(duration);
+	INSTR_TIME_SUBTRACT(duration, start_time);
+	PackageCacheReportCompile(pkgoid, INSTR_TIME_GET_MILLISEC(duration));
+
 	/* if we rebuild body, we should re init */
 	newpsource = (PLiSQL_package *) item->source;
 	if (newpsource->status == PLISQL_PACKAGE_INIT ||
@@ -0,0 +1,123 @@
+# Copyright (c) 2023-2025, IvorySQL Global Development Team
+
+# Test the shared plan cache: reuse of a generic plan by another session,
+# removal after DDL by the committing session, and keys that tell statements
+# and settings apart.
+
+use strict;
+use warnings FATAL => 'all';
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+$node->append_conf('postgresql.conf', "shared_plan_cache_size = 1MB");
+$node->start;
+
+$node->safe_psql(
+	'postgres', q{
+CREATE TABLE spc_t (a int);
+INSERT INTO spc_t SELECT generate_series(1, 100);
+CREATE VIEW spc_v AS SELECT a FROM spc_t WHERE a <= 10;
+});
+
+my $generic = 'SET plan_cache_mode = force_generic_plan;';
+
+sub stats
+{
+	return $node->safe_psql('postgres',
+		'SELECT hits, removals FROM pg_shared_plan_cache_stats()');
+}
+
+sub run_view_query
+{
+	return $node->safe_psql(
+		'postgres', qq{
+$generic
+PREPARE q AS SELECT count(*) FROM spc_v;
+EXECUTE q;
+});
+}
+
+# The first session publishes the plan, the second one uses it.
+is(run_view_query(), '10', 'first session plans the statement');
+my ($hits_before) = split /\|/, stats();
+is(run_view_query(), '10', 'second session gets the same result');
+my ($hits_after) = split /\|/, stats();
+cmp_ok($hits_after, '>', $hits_before, 'second session reused the plan');
+
+# Redefining the view must remove the published plan.
+my (undef, $removals_before) = split /\|/, stats();
+$node->safe_psql('postgres',
+	'CREATE OR REPLACE VIEW spc_v AS SELECT a FROM spc_t WHERE a <= 20;');
+is(run_view_query(), '20', 'plan is rebuilt after the view changes');
+my (undef, $removals_after) = split /\|/, stats();
+cmp_ok($removals_after, '>', $removals_before,
+	'published plan was removed after DDL');
+
+# The session dropping a table removes the plans using it as it commits, so
+# a new session after the table is created again doesn't find them.
+$node->safe_psql(
+	'postgres', q{
+CREATE TABLE spc_d (a int);
+INSERT INTO spc_d SELECT generate_series(1, 5);
+});
+my $count_d = qq{
+$generic
+PREPARE c AS SELECT count(*) FROM spc_d;
+EXECUTE c;
+};
+is($node->safe_psql('postgres', $count_d), '5', 'plan on the table published');
+(undef, $removals_before) = split /\|/, stats();
+$removals_after = $node->safe_psql(
+	'postgres', q{
+DROP TABLE spc_d;
+SELECT removals FROM pg_shared_plan_cache_stats();
+});
+cmp_ok($removals_after, '>', $removals_before,
+	'dropping session removed the plan at commit');
+$node->safe_psql(
+	'postgres', q{
+CREATE TABLE spc_d (b text, a int);
+INSERT INTO spc_d SELECT 'x', generate_series(1, 7);
+});
+is($node->safe_psql('postgres', $count_d),
+	'7', 'new session uses the table created again');
+
+# Statements sharing one source string must not share a plan.
+for my $round (1 .. 2)
+{
+	my $result = $node->safe_psql(
+		'postgres', qq{
+$generic
+PREPARE s1(int) AS SELECT \$1 + 1 \\; PREPARE s2(int) AS SELECT \$1 + 2;
+EXECUTE s1(0);
+EXECUTE s2(0);
+});
+	is($result, "1\n2",
+		"statements of one query string keep their own plans, round $round");
+}
+
+# Settings that change how literals are parsed are part of the key.
+my $mdy = $node->safe_psql(
+	'postgres', qq{
+$generic
+SET DateStyle = 'ISO, MDY';
+PREPARE d AS SELECT '01/02/2024'::date::text;
+EXECUTE d;
+});
+is($mdy, '2024-01-02', 'date parsed as MDY');
+my $dmy = $node->safe_psql(
+	'postgres', qq{
+$generic
+SET DateStyle = 'ISO, DMY';
+PREPARE d AS SELECT '01/02/2024'::date::text;
+EXECUTE d;
+});
+is($dmy, '2024-02-01', 'plan built under MDY is not used under DMY');
+
+$node->stop;
+
+done_testing();
@@ -0,0 +1,101 @@
+# Copyright (c) 2023-2025, IvorySQL Global Development Team
+
+# Test the work memory broker: the size of a grant, that grants are
+# returned when a query finishes or fails inside a subtransaction, and that a
+# grant returned that way doesn't take another one along when its node is
+# shut down.
+
+use strict;
+use warnings FATAL => 'all';
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+$node->append_conf(
+	'postgresql.conf', qq{
+work_mem_target = 10MB
+work_mem = 4MB
+autovacuum = off
+});
+$node->start;
+
+# A lone sort asks for work_mem and gets it, since it is more than 5% of
+# the target and less than the memory still free.
+my $granted = $node->safe_psql(
+	'postgres', q{
+SELECT (SELECT granted_bytes FROM pg_memory_grants
+         WHERE pid = pg_backend_pid())
+  FROM (SELECT x FROM generate_series(1, 10) x ORDER BY x) s
+ LIMIT 1;
+});
+is($granted, 4096 * 1024, 'sort was granted work_mem');
+
+is($node->safe_psql('postgres', 'SELECT count(*) FROM pg_memory_grants'),
+	'0', 'grant was returned when the query finished');
+
+# Queries failing inside exception blocks give their grants back when the
+# subtransaction aborts, not only at the end of the transaction.
+$node->safe_psql(
+	'postgres', q{
+CREATE FUNCTION grants_after_failures() RETURNS bigint
+LANGUAGE plpgsql AS $$
+BEGIN
+  FOR i IN 1..5 LOOP
+    BEGIN
+      PERFORM x / (x - 5)
+         FROM (SELECT x FROM generate_series(1, 10) x ORDER BY x) s;
+    EXCEPTION WHEN division_by_zero THEN
+      NULL;
+    END;
+  END LOOP;
+  RETURN (SELECT count(*) FROM pg_memory_grants);
+END
+$$;
+});
+is($node->safe_psql('postgres', 'SELECT grants_after_failures()'),
+	'0', 'grants of failed queries are returned at subtransaction abort');
+
+my (undef, $stdout, $stderr) = $node->psql(
+	'postgres', q{
+BEGIN;
+SAVEPOINT s;
+SELECT x / (x - 5) FROM (SELECT x FROM generate_series(1, 10) x ORDER BY x) s;
+ROLLBACK TO s;
+SELECT count(*) FROM pg_memory_grants;
+COMMIT;
+},
+	on_error_stop => 0);
+like($stderr, qr/division by zero/, 'query failed inside the savepoint');
+is($stdout, '0', 'grant is returned by ROLLBACK TO SAVEPOINT');
+
+# c1's sort gets its grant in the savepoint, which returns it, but the
+# cursor stays open.  Closing it must not return c0's grant, which is the
+# same size: both ask for less than 5% of the target and get that much.
+my $grants = q{SELECT coalesce((SELECT grants FROM pg_memory_grants
+                         WHERE pid = pg_backend_pid()), 0);};
+my $result = $node->safe_psql(
+	'postgres', qq{
+BEGIN;
+SET LOCAL work_mem = '256kB';
+DECLARE c0 CURSOR FOR SELECT x FROM generate_series(1, 10) x ORDER BY x;
+DECLARE c1 CURSOR FOR SELECT x FROM generate_series(1, 10) x ORDER BY x;
+FETCH 1 FROM c0;
+SAVEPOINT s;
+FETCH 1 FROM c1;
+ROLLBACK TO s;
+$grants
+CLOSE c1;
+$grants
+CLOSE c0;
+$grants
+COMMIT;
+});
+is($result, "1\n1\n1\n1\n0",
+	'closing a cursor whose grant was returned leaves other grants alone');
+
+$node->stop;
+
+done_testing();
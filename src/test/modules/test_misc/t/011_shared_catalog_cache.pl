@@ -0,0 +1,161 @@
+# Copyright (c) 2023-2025, IvorySQL Global Development Team
+
+# Test the shared catalog cache: use of a tuple published by another session,
+# removal of stale tuples by committing and prepared transactions, a full
+# area, and a standby following DDL on the primary.
+
+use strict;
+use warnings FATAL => 'all';
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('primary');
+$node->init(allows_streaming => 1);
+$node->append_conf(
+	'postgresql.conf', qq{
+shared_catalog_cache_size = 1MB
+max_prepared_transactions = 2
+autovacuum = off
+});
+$node->start;
+
+$node->safe_psql(
+	'postgres', q{
+CREATE TABLE scc_warm (a int);
+CREATE TABLE scc_t (a int);
+CREATE FUNCTION scc_f() RETURNS int LANGUAGE sql AS 'SELECT 1';
+});
+
+my $stats = 'SELECT hits, misses, inserts FROM pg_shared_catalog_cache_stats()';
+
+# Look up scc_t by its qualified name, with everything else the lookup needs
+# already in the session's own cache, and report the cache's activity before
+# and after.
+sub lookup_scc_t
+{
+	my $result = $node->safe_psql(
+		'postgres', qq{
+SELECT 'public.scc_warm'::regclass;
+$stats;
+SELECT 'public.scc_t'::regclass;
+$stats;
+});
+	my (undef, $before, undef, $after) = split /\n/, $result;
+	return ([ split /\|/, $before ], [ split /\|/, $after ]);
+}
+
+# The first session reads the tuple from the catalog and publishes it, the
+# second one finds it published.
+my ($before, $after) = lookup_scc_t();
+cmp_ok($after->[1], '>', $before->[1], 'first session missed');
+cmp_ok($after->[2], '>', $before->[2], 'first session published the tuple');
+($before, $after) = lookup_scc_t();
+cmp_ok($after->[0], '>', $before->[0], 'second session hit');
+is($after->[1], $before->[1], 'second session did not miss');
+
+# Committed changes remove the tuples they make stale
+is($node->safe_psql('postgres', 'SELECT scc_f()'), '1', 'function published');
+my ($removals) = $node->safe_psql('postgres',
+	'SELECT removals FROM pg_shared_catalog_cache_stats()');
+$node->safe_psql(
+	'postgres', q{
+ALTER TABLE scc_t RENAME TO scc_t2;
+CREATE OR REPLACE FUNCTION scc_f() RETURNS int LANGUAGE sql AS 'SELECT 2';
+});
+cmp_ok(
+	$node->safe_psql(
+		'postgres', 'SELECT removals FROM pg_shared_catalog_cache_stats()'),
+	'>', $removals, 'stale tuples were removed');
+is( $node->safe_psql(
+		'postgres',
+		q{SELECT to_regclass('public.scc_t') IS NULL,
+		         to_regclass('public.scc_t2') IS NOT NULL}),
+	't|t',
+	'renamed table is seen under its new name only');
+is($node->safe_psql('postgres', 'SELECT scc_f()'),
+	'2', 'replaced function is seen');
+
+# So do prepared transactions, when they are committed
+$node->safe_psql(
+	'postgres', q{
+BEGIN;
+CREATE OR REPLACE FUNCTION scc_f() RETURNS int LANGUAGE sql AS 'SELECT 3';
+PREPARE TRANSACTION 'scc';
+});
+is($node->safe_psql('postgres', 'SELECT scc_f()'),
+	'2', 'prepared change is not seen yet');
+$node->safe_psql('postgres', "COMMIT PREPARED 'scc'");
+is($node->safe_psql('postgres', 'SELECT scc_f()'),
+	'3', 'change of prepared transaction is seen once committed');
+
+# Fill the area: the function bodies don't compress, so they are toasted
+# out of line, and the catalog cache keeps the tuples detoasted.  Each takes
+# about 50kB then, and 40 of them don't fit in 1MB.  Tuples that don't fit
+# are just not published.
+my $nbig = 40;
+my $body = 'SELECT 1 -- '
+  . join('', map { sprintf('%08x', int(rand(2**32))) } 1 .. 6250);
+$node->safe_psql(
+	'postgres',
+	join('',
+		map {
+			"CREATE FUNCTION scc_big_$_() RETURNS int LANGUAGE sql AS \$\$$body\$\$;\n"
+		} 1 .. $nbig));
+my $call_all =
+  'SELECT ' . join(' + ', map { "scc_big_$_()" } 1 .. $nbig);
+
+my ($inserts) = $node->safe_psql('postgres',
+	'SELECT inserts FROM pg_shared_catalog_cache_stats()');
+is($node->safe_psql('postgres', $call_all),
+	$nbig, 'functions can be called with the area full');
+cmp_ok(
+	$node->safe_psql(
+		'postgres', 'SELECT inserts FROM pg_shared_catalog_cache_stats()'),
+	'<', $inserts + $nbig, 'not all functions were published');
+is($node->safe_psql('postgres', $call_all),
+	$nbig, 'functions can still be called from another session');
+
+$node->safe_psql('postgres',
+	q{CREATE OR REPLACE FUNCTION scc_big_1() RETURNS int LANGUAGE sql AS 'SELECT 2'}
+);
+is($node->safe_psql('postgres', $call_all),
+	$nbig + 1, 'change is seen with the area full');
+ok(!$node->log_contains(qr/out of (shared )?memory/),
+	'a full area raised no error');
+
+# A standby doesn't use the shared cache, and sees DDL replayed from the
+# primary.
+$node->backup('backup');
+my $standby = PostgreSQL::Test::Cluster->new('standby');
+$standby->init_from_backup($node, 'backup', has_streaming => 1);
+$standby->start;
+
+is($standby->safe_psql('postgres', 'SELECT scc_f()'),
+	'3', 'standby sees the function');
+$node->safe_psql(
+	'postgres', q{
+ALTER TABLE scc_t2 RENAME TO scc_t3;
+CREATE OR REPLACE FUNCTION scc_f() RETURNS int LANGUAGE sql AS 'SELECT 4';
+});
+$node->wait_for_catchup($standby);
+
+is($standby->safe_psql('postgres', 'SELECT scc_f()'),
+	'4', 'standby sees the replaced function');
+is( $standby->safe_psql(
+		'postgres',
+		q{SELECT to_regclass('public.scc_t2') IS NULL,
+		         to_regclass('public.scc_t3') IS NOT NULL}),
+	't|t',
+	'standby sees the renamed table under its new name only');
+is( $standby->safe_psql(
+		'postgres',
+		'SELECT hits + misses + inserts FROM pg_shared_catalog_cache_stats()'),
+	'0',
+	'standby did not use the shared cache');
+
+$standby->stop;
+$node->stop;
+
+done_testing();
@@ -0,0 +1,108 @@
+# Copyright (c) 2023-2025, IvorySQL Global Development Team
+
+# Test the sharing of text search dictionaries: Ispell, Hunspell and synonym
+# dictionaries published by one session and used by another, and published
+# anew after ALTER TEXT SEARCH DICTIONARY.
+
+use strict;
+use warnings FATAL => 'all';
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+$node->append_conf('postgresql.conf', 'shared_ts_dictionary_size = 4MB');
+$node->start;
+
+$node->safe_psql(
+	'postgres', q{
+CREATE TEXT SEARCH DICTIONARY ispell (
+	Template = ispell, DictFile = ispell_sample, AffFile = ispell_sample);
+CREATE TEXT SEARCH DICTIONARY hunspell (
+	Template = ispell, DictFile = ispell_sample, AffFile = hunspell_sample);
+CREATE TEXT SEARCH DICTIONARY hunspell_long (
+	Template = ispell, DictFile = hunspell_sample_long,
+	AffFile = hunspell_sample_long);
+CREATE TEXT SEARCH DICTIONARY synonym (
+	Template = synonym, Synonyms = synonym_sample);
+});
+
+# The conditions of hunspell_sample_long's affixes of 'skies' and 'booked'
+# aren't simple enough for the regis matcher, so those words go through the
+# regexes each backend compiles when it attaches to a shared copy.
+my $lexize = q{
+SELECT d::text || ' ' || w || ' ' || coalesce(ts_lexize(d, w)::text, 'NULL')
+  FROM (VALUES (1, 'ispell'::regdictionary, 'skies'),
+               (2, 'ispell', 'rebookings'), (3, 'ispell', 'footballklubber'),
+               (4, 'hunspell', 'unbook'), (5, 'hunspell', 'footballyklubber'),
+               (6, 'hunspell_long', 'skies'), (7, 'hunspell_long', 'booked'),
+               (8, 'hunspell_long', 'ballsklubber'),
+               (9, 'synonym', 'PoStGrEs'), (10, 'synonym', 'indices'))
+       AS t(n, d, w)
+ ORDER BY n;
+};
+my $expected = join("\n",
+	'ispell skies {sky}',
+	'ispell rebookings {booking,book}',
+	'ispell footballklubber {footballklubber,foot,ball,klubber,football,klubber}',
+	'hunspell unbook {book}',
+	'hunspell footballyklubber {foot,ball,klubber}',
+	'hunspell_long skies {sky}',
+	'hunspell_long booked {book}',
+	'hunspell_long ballsklubber {ball,klubber}',
+	'synonym PoStGrEs {pgsql}',
+	'synonym indices {index}');
+
+my $stats =
+  'SELECT entries, hits, inserts, removals FROM pg_shared_ts_dictionary_stats()';
+
+sub stats
+{
+	return split /\|/, $node->safe_psql('postgres', $stats);
+}
+
+# The first session loads the dictionaries and publishes them
+is($node->safe_psql('postgres', $lexize),
+	$expected, 'first session lexizes');
+my ($entries, $hits, $inserts, $removals) = stats();
+is($entries, '4', 'dictionaries were published');
+is($inserts, '4', 'each dictionary was published once');
+
+# The second one uses the published copies
+is($node->safe_psql('postgres', $lexize),
+	$expected, 'second session lexizes the same with the shared copies');
+my ($entries2, $hits2, $inserts2) = stats();
+cmp_ok($hits2, '>=', $hits + 4, 'second session used the shared copies');
+is($inserts2, $inserts, 'second session published nothing');
+
+# ALTER TEXT SEARCH DICTIONARY replaces the published copy
+$node->safe_psql('postgres',
+	'ALTER TEXT SEARCH DICTIONARY synonym (CaseSensitive = 1)');
+$node->safe_psql('postgres',
+	'ALTER TEXT SEARCH DICTIONARY hunspell_long (DictFile = hunspell_sample_long)'
+);
+my $altered = q{
+SELECT coalesce(ts_lexize('synonym', 'PoStGrEs')::text, 'NULL'),
+       ts_lexize('synonym', 'postgres'),
+       ts_lexize('hunspell_long', 'skies'),
+       ts_lexize('hunspell_long', 'booked');
+};
+my $expected_altered = 'NULL|{pgsql}|{sky}|{book}';
+is($node->safe_psql('postgres', $altered),
+	$expected_altered, 'session after ALTER sees the altered dictionary');
+my ($entries3, $hits3, $inserts3, $removals3) = stats();
+is($entries3, '4', 'altered dictionaries replaced their old copies');
+is($inserts3, $inserts + 2, 'altered dictionaries were published anew');
+cmp_ok($removals3, '>=', $removals + 2, 'old copies were removed');
+
+is($node->safe_psql('postgres', $altered),
+	$expected_altered, 'another session uses the republished copies');
+my (undef, $hits4, $inserts4) = stats();
+cmp_ok($hits4, '>=', $hits3 + 2, 'republished copies were used');
+is($inserts4, $inserts3, 'nothing was published again');
+
+$node->stop;
+
+done_testing();
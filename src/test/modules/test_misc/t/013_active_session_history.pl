@@ -0,0 +1,88 @@
+# Copyright (c) 2023-2025, IvorySQL Global Development Team
+
+# Test the active session history sampler: a session running on CPU and a
+# session waiting for a lock are both recorded, with what they were doing.
+
+use strict;
+use warnings FATAL => 'all';
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+$node->append_conf(
+	'postgresql.conf', qq{
+active_session_history_size = 1MB
+active_session_history_interval = 50ms
+});
+$node->start;
+
+$node->safe_psql('postgres', 'CREATE TABLE ash_t (a int)');
+
+# A session busy on CPU for two seconds, never waiting
+my $running_pid = $node->safe_psql(
+	'postgres', q{
+SELECT pg_backend_pid();
+DO $$
+DECLARE
+  stop timestamptz := clock_timestamp() + interval '2 s';
+BEGIN
+  WHILE clock_timestamp() < stop LOOP
+  END LOOP;
+END
+$$;
+});
+
+is( $node->safe_psql(
+		'postgres', qq{
+SELECT count(*) > 0, bool_and(on_cpu), bool_and(state = 'active'),
+       min(backend_type), min(datname), min(usename) = current_user
+  FROM pg_active_session_history
+ WHERE pid = $running_pid;
+}),
+	't|t|t|client backend|postgres|t',
+	'running session was sampled on CPU');
+
+# A session waiting two seconds for a lock held by another one
+my $holder = $node->background_psql('postgres');
+$holder->query_safe('BEGIN; LOCK TABLE ash_t;');
+
+my ($ret, $waiting_pid, $stderr) = $node->psql(
+	'postgres', q{
+SET lock_timeout = '2s';
+SELECT pg_backend_pid();
+LOCK TABLE ash_t;
+});
+like($stderr, qr/canceling statement due to lock timeout/,
+	'waiting session timed out');
+
+$holder->query_safe('COMMIT;');
+$holder->quit;
+
+is( $node->safe_psql(
+		'postgres', qq{
+SELECT count(*) > 0, bool_or(NOT on_cpu),
+       count(*) FILTER (WHERE wait_event_type = 'Lock'
+                          AND wait_event = 'relation') > 0
+  FROM pg_active_session_history
+ WHERE pid = $waiting_pid AND state = 'active';
+}),
+	't|t|t',
+	'waiting session was sampled waiting for the lock');
+
+# Samples come out oldest first
+is( $node->safe_psql(
+		'postgres', q{
+SELECT bool_and(sample_time >= prev)
+  FROM (SELECT sample_time,
+               lag(sample_time) OVER () AS prev
+          FROM pg_get_active_session_history()) s;
+}),
+	't',
+	'samples are ordered by time');
+
+$node->stop;
+
+done_testing();
@@ -37,6 +37,7 @@
 #include "optimizer/plancat.h"
 #include "parser/parse_coerce.h"
 #include "port/atomics.h"
+#include "portability/instr_time.h"
 #include "postmaster/postmaster.h"	/* for MAX_BACKENDS */
 #include "storage/spin.h"
 #include "utils/array.h"
@@ -715,6 +716,66 @@ test_atomic_ops(PG_FUNCTION_ARGS)
 	PG_RETURN_BOOL(true);
 }
 
+/*
+ * Sanity checks for instr_time: the conversion of ticks to time units, and
+ * an interval measured with whichever clock the server chose.
+ */
+PG_FUNCTION_INFO_V1(test_instr_time);
+Datum
+test_instr_time(PG_FUNCTION_ARGS)
+{
+#ifndef WIN32
+	bool		save_use_tsc = pg_instr_use_tsc;
+	double		save_ns_per_tick = pg_instr_ns_per_tick;
+	instr_time	t;
+	instr_time	start;
+	instr_time	end;
+	instr_time	outer_start;
+	instr_time	outer_end;
+	int64		inner_ns;
+	int64		outer_ns;
+
+	/* with the TSC in use, ticks are scaled by the calibrated period */
+	pg_instr_use_tsc = true;
+	pg_instr_ns_per_tick = 0.25;
+	t.ticks = 4000000;
+#ifdef PG_INSTR_TSC
+	if (INSTR_TIME_GET_NANOSEC(t) != 1000000 ||
+		INSTR_TIME_GET_MICROSEC(t) != 1000 ||
+		INSTR_TIME_GET_MILLISEC(t) != 1.0)
+		elog(ERROR, "wrong conversion of TSC ticks: " INT64_FORMAT " ns",
+			 INSTR_TIME_GET_NANOSEC(t));
+#else
+	/* elsewhere, ticks are always nanoseconds */
+	if (INSTR_TIME_GET_NANOSEC(t) != 4000000)
+		elog(ERROR, "wrong conversion of ticks: " INT64_FORMAT " ns",
+			 INSTR_TIME_GET_NANOSEC(t));
+#endif
+	pg_instr_use_tsc = save_use_tsc;
+	pg_instr_ns_per_tick = save_ns_per_tick;
+
+	/*
+	 * An interval measured with instr_time can't be longer than one
+	 * enclosing it measured with clock_gettime(), give or take calibration
+	 * error, and must not be negative.
+	 */
+	outer_start = pg_clock_gettime_ns();
+	INSTR_TIME_SET_CURRENT(start);
+	pg_usleep(10000);
+	INSTR_TIME_SET_CURRENT(end);
+	outer_end = pg_clock_gettime_ns();
+
+	INSTR_TIME_SUBTRACT(end, start);
+	inner_ns = INSTR_TIME_GET_NANOSEC(end);
+	outer_ns = outer_end.ticks - outer_start.ticks;
+	if (inner_ns < 0 || inner_ns > outer_ns + outer_ns / 100)
+		elog(ERROR, "instr_time measured " INT64_FORMAT " ns within " INT64_FORMAT " ns",
+			 inner_ns, outer_ns);
+#endif
+
+	PG_RETURN_BOOL(true);
+}
+
 PG_FUNCTION_INFO_V1(test_fdw_handler);
 Datum
 test_fdw_handler(PG_FUNCTION_ARGS)
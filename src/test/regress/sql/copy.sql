@@ -375,3 +375,26 @@ COPY copytest_mv(id) TO stdout WITH (header);
 REFRESH MATERIALIZED VIEW copytest_mv;
 COPY copytest_mv(id) TO stdout WITH (header);
 DROP MATERIALIZED VIEW copytest_mv;
+
+-- Long lines and fields, so that the vectorized scans in COPY FROM find
+-- delimiters, escapes, quotes and newlines at assorted offsets
+CREATE TEMP TABLE copy_long (a text, b text);
+COPY copy_long FROM stdin;
+abcdefghijklmnopqrstuvwxyz0123456789	short
+abcdefghijklmnop\tqrstuvwxyz\\0123456789\n	x
+0123456789abcde	0123456789abcdef0123456789abcdef\N
+\N	abcdefghijklmnopqrstuvwxyz0123456789abcdef
+\.
+COPY copy_long TO stdout;
+TRUNCATE copy_long;
+COPY copy_long FROM stdin (FORMAT csv);
+"abcdefghijklmnopqrstuvwxyz","a ""quoted"" value that is long enough"
+"a value with a newline
+in the middle, and a comma",plain value without any quotes at all
+,""
+\.
+COPY copy_long FROM stdin (FORMAT csv, ESCAPE '\');
+"0123456789abcdef\"quoted\"0123456789\\x",y
+\.
+COPY copy_long TO stdout (FORMAT csv);
+DROP TABLE copy_long;
@@ -90,6 +90,11 @@ COPY x to stdout (format BINARY, on_error unsupported);
 COPY x from stdin (log_verbosity unsupported);
 COPY x from stdin with (reject_limit 1);
 COPY x from stdin with (on_error ignore, reject_limit 0);
+COPY x to stdout (compression 'unsupported');
+COPY x from stdin (compression 'gzip');
+COPY x to stdout (compression_detail 'level=1');
+COPY x to stdout (compression 'none', compression_detail 'level=1');
+COPY x to stdout (compression 'none', compression 'none');
 
 -- too many columns in column list: should fail
 COPY x (a, b, c, d, e, d, c) from stdin;
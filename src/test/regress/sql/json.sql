@@ -88,6 +88,13 @@ SELECT '{
 		"averyveryveryveryveryveryveryveryveryverylongfieldname":}'::json;
 -- ERROR missing value for last field
 
+-- long runs of indentation and string contents
+SELECT ('{' || E'\n' || repeat(' ', 40) || '"a": "' || repeat('x', 40) ||
+		E'\\"y",\n' || repeat(' ', 30) || '"b":}')::json;
+SELECT ('"' || repeat('x', 35) || E'\x01"')::json;
+SELECT ('"' || repeat('ab', 20) || E'\\n' || repeat('c', 20) || '"')::jsonb =
+	to_jsonb(repeat('ab', 20) || E'\n' || repeat('c', 20));
+
 -- test non-error-throwing input
 select pg_input_is_valid('{"a":true}', 'json');
 select pg_input_is_valid('{"a":true', 'json');
@@ -25,6 +25,7 @@ SELECT '0'::jsonb;				-- OK
 SELECT '01'::jsonb;				-- ERROR, not valid according to JSON spec
 SELECT '0.1'::jsonb;				-- OK
 SELECT '9223372036854775808'::jsonb;	-- OK, even though it's too large for int8
+SELECT '[999999999999999999, -999999999999999999, 1000000000000000000, -0]'::jsonb;	-- OK
 SELECT '1e100'::jsonb;			-- OK
 SELECT '1.3e100'::jsonb;			-- OK
 SELECT '1f2'::jsonb;				-- ERROR
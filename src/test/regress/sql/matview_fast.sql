@@ -0,0 +1,77 @@
+--
+-- Fast refresh of materialized views from change logs
+--
+CREATE TABLE mvf_custs (cust int, region text);
+CREATE TABLE mvf_orders (id int, cust int, amount numeric);
+INSERT INTO mvf_custs VALUES (1, 'east'), (2, 'west'), (3, 'east');
+INSERT INTO mvf_orders VALUES (1, 1, 10), (2, 1, 20), (3, 2, 5), (4, 3, NULL);
+
+-- a join, a join with aggregates, and min/max, which recomputes groups
+CREATE MATERIALIZED VIEW mvf_join WITH (fast_refresh = demand) AS
+  SELECT o.id, c.region, o.amount
+  FROM mvf_orders o JOIN mvf_custs c ON o.cust = c.cust;
+CREATE MATERIALIZED VIEW mvf_region WITH (fast_refresh = demand) AS
+  SELECT c.region, count(*) AS n, count(o.amount) AS na, sum(o.amount) AS total
+  FROM mvf_orders o JOIN mvf_custs c ON o.cust = c.cust
+  GROUP BY c.region;
+CREATE MATERIALIZED VIEW mvf_minmax WITH (fast_refresh = demand) AS
+  SELECT cust, min(amount) AS lo, max(amount) AS hi
+  FROM mvf_orders GROUP BY cust;
+-- not supported, so no change logs
+CREATE MATERIALIZED VIEW mvf_distinct WITH (fast_refresh = demand) AS
+  SELECT DISTINCT cust FROM mvf_orders;
+SELECT count(*) FROM pg_class WHERE relname LIKE 'pg\_mlog\_%';
+SELECT count(*) FROM pg_trigger
+  WHERE tgrelid IN ('mvf_orders'::regclass, 'mvf_custs'::regclass);
+
+-- changes to both sides of the join
+INSERT INTO mvf_orders VALUES (5, 2, 7), (6, 4, 100);
+UPDATE mvf_orders SET amount = 30 WHERE id = 2;
+DELETE FROM mvf_orders WHERE id = 3;
+INSERT INTO mvf_custs VALUES (4, 'north');
+-- nothing changes before the refresh
+SELECT * FROM mvf_region ORDER BY region;
+REFRESH MATERIALIZED VIEW mvf_join;
+REFRESH MATERIALIZED VIEW mvf_region;
+REFRESH MATERIALIZED VIEW mvf_minmax;
+SELECT * FROM mvf_join ORDER BY id;
+SELECT * FROM mvf_region ORDER BY region;
+SELECT * FROM mvf_minmax ORDER BY cust;
+
+-- a group that loses all its rows goes away
+DELETE FROM mvf_orders WHERE cust = 4;
+REFRESH MATERIALIZED VIEW mvf_region;
+SELECT * FROM mvf_region ORDER BY region;
+
+-- refresh at commit
+ALTER MATERIALIZED VIEW mvf_region SET (fast_refresh = commit);
+BEGIN;
+INSERT INTO mvf_orders VALUES (7, 2, 3);
+SELECT * FROM mvf_region ORDER BY region;
+COMMIT;
+SELECT * FROM mvf_region ORDER BY region;
+
+-- TRUNCATE makes the next refresh recompute the view
+TRUNCATE mvf_orders;
+INSERT INTO mvf_orders VALUES (8, 1, 1);
+REFRESH MATERIALIZED VIEW mvf_minmax;
+SELECT * FROM mvf_minmax ORDER BY cust;
+SELECT * FROM mvf_region ORDER BY region;
+
+-- WITH NO DATA drops the change logs, and the next refresh creates them
+REFRESH MATERIALIZED VIEW mvf_join WITH NO DATA;
+SELECT count(*) FROM pg_class WHERE relname LIKE 'pg\_mlog\_%';
+REFRESH MATERIALIZED VIEW mvf_join;
+SELECT count(*) FROM pg_class WHERE relname LIKE 'pg\_mlog\_%';
+SELECT * FROM mvf_join ORDER BY id;
+
+-- turning fast refresh off drops them at the next refresh
+ALTER MATERIALIZED VIEW mvf_minmax SET (fast_refresh = off);
+REFRESH MATERIALIZED VIEW mvf_minmax;
+SELECT count(*) FROM pg_class WHERE relname LIKE 'pg\_mlog\_%';
+
+DROP MATERIALIZED VIEW mvf_join, mvf_region, mvf_minmax, mvf_distinct;
+SELECT count(*) FROM pg_class WHERE relname LIKE 'pg\_mlog\_%';
+SELECT count(*) FROM pg_trigger
+  WHERE tgrelid IN ('mvf_orders'::regclass, 'mvf_custs'::regclass);
+DROP TABLE mvf_orders, mvf_custs;
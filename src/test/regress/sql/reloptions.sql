@@ -137,3 +137,22 @@ SELECT reloptions FROM pg_class WHERE oid = 'reloptions_test_idx'::regclass;
 CREATE INDEX reloptions_test_idx3 ON reloptions_test (s);
 ALTER INDEX reloptions_test_idx3 SET (fillfactor=40);
 SELECT reloptions FROM pg_class WHERE oid = 'reloptions_test_idx3'::regclass;
+
+-- Page compression
+CREATE TABLE reloptions_test3 (i int, t text) WITH (page_compression=pglz);
+SELECT reloptions FROM pg_class WHERE oid = 'reloptions_test3'::regclass;
+INSERT INTO reloptions_test3
+	SELECT i, repeat('compressible ', 10) FROM generate_series(1, 1000) i;
+CHECKPOINT;
+SELECT count(*), sum(i), count(DISTINCT t) FROM reloptions_test3;
+VACUUM FULL reloptions_test3;
+SELECT count(*), sum(i), count(DISTINCT t) FROM reloptions_test3;
+ALTER TABLE reloptions_test3 SET (page_compression=none);
+SELECT reloptions FROM pg_class WHERE oid = 'reloptions_test3'::regclass;
+ALTER TABLE reloptions_test3 RESET (page_compression);
+SELECT reloptions FROM pg_class WHERE oid = 'reloptions_test3'::regclass;
+-- Not for TOAST tables or indexes
+ALTER TABLE reloptions_test3 SET (toast.page_compression=pglz);
+CREATE INDEX reloptions_test3_idx ON reloptions_test3 (i)
+	WITH (page_compression=pglz);
+DROP TABLE reloptions_test3;
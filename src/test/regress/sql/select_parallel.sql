@@ -582,6 +582,66 @@ DELETE FROM parallel_hang WHERE 380 <= i AND i <= 420;
 
 ROLLBACK;
 
+-- parallel UPDATE and DELETE: workers scan, the leader modifies
+set parallel_setup_cost = 0;
+set parallel_tuple_cost = 0;
+set min_parallel_table_scan_size = 0;
+set max_parallel_workers_per_gather = 2;
+set enable_parallel_dml = on;
+
+create table pdml_tab (a int, b int) with (parallel_workers = 2);
+insert into pdml_tab select i, i % 10 from generate_series(1, 1000) i;
+analyze pdml_tab;
+
+explain (costs off)
+  update pdml_tab set b = b + 1 where a % 7 = 0;
+update pdml_tab set b = b + 1 where a % 7 = 0;
+explain (costs off)
+  delete from pdml_tab where a % 5 = 0;
+delete from pdml_tab where a % 5 = 0;
+select count(*), sum(b) from pdml_tab;
+
+-- once the transaction has written, the plan runs without workers
+begin;
+insert into pdml_tab values (0, 0);
+explain (analyze, timing off, summary off, costs off, buffers off)
+  update pdml_tab set b = b + 1 where a % 7 = 0;
+select count(*), sum(b) from pdml_tab;
+rollback;
+
+-- a parallel-unsafe BEFORE trigger on the target prevents parallelism
+create function pdml_trig() returns trigger language plpgsql as
+  $$begin new.b := new.b * 2; return new; end$$;
+create trigger pdml_before before update on pdml_tab
+  for each row execute function pdml_trig();
+explain (costs off)
+  update pdml_tab set b = b + 1 where a % 7 = 0;
+-- but a parallel-restricted one runs in the leader only
+alter function pdml_trig() parallel restricted;
+explain (costs off)
+  update pdml_tab set b = b + 1 where a % 7 = 0;
+drop table pdml_tab;
+drop function pdml_trig();
+
+-- partitioned target, including rows moved into a pruned partition
+create table pdml_part (a int, b int) partition by range (a);
+create table pdml_part_a partition of pdml_part for values from (1) to (301);
+create table pdml_part_b partition of pdml_part for values from (301) to (1001);
+insert into pdml_part select i, i % 10 from generate_series(1, 1000) i;
+analyze pdml_part;
+explain (costs off)
+  update pdml_part set b = b + 1 where a % 7 = 0;
+update pdml_part set b = b + 1 where a % 7 = 0;
+update pdml_part set a = a + 700 where a % 100 = 0 and a <= 300;
+select tableoid::regclass, count(*), sum(b) from pdml_part group by 1 order by 1;
+drop table pdml_part;
+
+reset enable_parallel_dml;
+reset max_parallel_workers_per_gather;
+reset min_parallel_table_scan_size;
+reset parallel_tuple_cost;
+reset parallel_setup_cost;
+
 -- Check parallel worker stats
 select pg_stat_force_next_flush();
 select parallel_workers_to_launch > :'parallel_workers_to_launch_before'  AS wrk_to_launch,
@@ -305,3 +305,49 @@ EXPLAIN (COSTS OFF) :qry;
 :qry;
 
 COMMIT;
+
+----
+-- test radix sort of leading keys with specialized comparators
+----
+
+CREATE TEMP TABLE radix_sort (id int, i4 int4, i8 int8, t text);
+INSERT INTO radix_sort
+  SELECT g, (g * 7919) % 2003 - 1000,
+    (g::int8 * 1000000007) % 99999999977 - 50000000000,
+    ((g * 37) % 10007)::text
+  FROM generate_series(1, 10000) g;
+INSERT INTO radix_sort VALUES (10001, NULL, NULL, NULL), (10002, NULL, NULL, NULL);
+
+-- int4 with duplicates, ties broken on a second key
+SELECT count(*) FROM
+  (SELECT i4, id, lag(i4) OVER w AS prev_i4, lag(id) OVER w AS prev_id
+   FROM radix_sort WINDOW w AS (ORDER BY i4, id)) s
+  WHERE (prev_i4, prev_id) > (i4, id);
+SELECT i4, id FROM radix_sort ORDER BY i4, id OFFSET 9996;
+SELECT i4, id FROM radix_sort ORDER BY i4 DESC NULLS FIRST, id OFFSET 9996;
+
+-- int8 with negative values
+SELECT count(*) FROM
+  (SELECT i8, lag(i8) OVER (ORDER BY i8) AS prev FROM radix_sort) s
+  WHERE prev > i8;
+SELECT i8 FROM radix_sort ORDER BY i8 OFFSET 9996;
+SELECT i8 FROM radix_sort ORDER BY i8 DESC OFFSET 9996;
+
+-- small values in a wide type
+SELECT count(*) FROM
+  (SELECT v, lag(v) OVER (ORDER BY v) AS prev
+   FROM (SELECT (id % 300)::int8 AS v FROM radix_sort) v) s
+  WHERE prev > v;
+
+-- abbreviated keys
+SELECT count(*) FROM
+  (SELECT t, lag(t) OVER (ORDER BY t COLLATE "C") AS prev FROM radix_sort) s
+  WHERE prev > t COLLATE "C";
+SELECT t FROM radix_sort ORDER BY t COLLATE "C" OFFSET 9996;
+
+-- Datum sorts
+SELECT percentile_disc(array[0, 0.5, 1]) WITHIN GROUP (ORDER BY i4),
+       percentile_disc(array[0, 0.5, 1]) WITHIN GROUP (ORDER BY i8)
+  FROM radix_sort;
+
+DROP TABLE radix_sort;
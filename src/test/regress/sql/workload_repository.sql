@@ -0,0 +1,46 @@
+--
+-- Workload repository snapshots and reports
+--
+
+SELECT pg_awr_create_snapshot() AS snap1 \gset
+
+CREATE TABLE awr_test (a int);
+INSERT INTO awr_test SELECT generate_series(1, 100);
+DELETE FROM awr_test WHERE a <= 10;
+SELECT pg_stat_force_next_flush();
+
+SELECT pg_awr_create_snapshot() AS snap2 \gset
+SELECT :snap2 > :snap1 AS ok;
+
+-- the table didn't exist at the first snapshot, so all of its activity counts
+SELECT relname, n_tup_ins, n_tup_del
+  FROM pg_awr.report_tables(:snap1, :snap2) WHERE relname = 'awr_test';
+-- the repository's own tables are not recorded
+SELECT count(*) FROM pg_awr.stat_tables WHERE schemaname = 'pg_awr';
+
+SELECT xact_commit > 0 AS ok, tup_inserted >= 100 AS ok
+  FROM pg_awr.report_database(:snap1, :snap2)
+ WHERE datname = current_database();
+SELECT wal_records > 0 AS ok, wal_bytes > 0 AS ok
+  FROM pg_awr.report_wal(:snap1, :snap2);
+SELECT count(*) > 0 AS ok FROM pg_awr.report_io(:snap1, :snap2)
+ WHERE backend_type = 'client backend';
+
+-- a reset counter counts from zero
+SELECT pg_awr.delta(150::int8, 100::int8), pg_awr.delta(30::int8, 100::int8),
+       pg_awr.delta(30::int8, NULL);
+
+-- purging deletes the data of the snapshots too
+SELECT pg_awr_purge_snapshots('0') >= 2 AS ok;
+SELECT count(*) FROM pg_awr.snapshots WHERE snap_id IN (:snap1, :snap2);
+SELECT count(*) FROM pg_awr.stat_io WHERE snap_id IN (:snap1, :snap2);
+
+-- only superusers can take snapshots by default
+CREATE ROLE regress_awr_user;
+SET ROLE regress_awr_user;
+SELECT pg_awr_create_snapshot();
+SELECT count(*) FROM pg_awr.snapshots;
+RESET ROLE;
+DROP ROLE regress_awr_user;
+
+DROP TABLE awr_test;
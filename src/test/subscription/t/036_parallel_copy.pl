@@ -0,0 +1,105 @@
+# Copyright (c) 2023-2025, IvorySQL Global Development Team
+
+# Test the parallel copy of a large table during the initial table
+# synchronization, including a copy that fails and is restarted.
+
+use strict;
+use warnings FATAL => 'all';
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node_publisher = PostgreSQL::Test::Cluster->new('publisher');
+$node_publisher->init(allows_streaming => 'logical');
+$node_publisher->start;
+
+my $node_subscriber = PostgreSQL::Test::Cluster->new('subscriber');
+$node_subscriber->init;
+$node_subscriber->append_conf(
+	'postgresql.conf', qq{
+max_logical_replication_workers = 6
+max_sync_workers_per_subscription = 4
+max_parallel_copy_workers_per_table = 2
+min_parallel_copy_table_size = 1MB
+wal_retrieve_retry_interval = 100ms
+log_min_messages = debug1
+});
+$node_subscriber->start;
+
+# About 4MB, well above min_parallel_copy_table_size
+$node_publisher->safe_psql(
+	'postgres', q{
+CREATE TABLE tab_copy (i int PRIMARY KEY, t text);
+INSERT INTO tab_copy
+  SELECT i, repeat(md5(i::text), 3) FROM generate_series(1, 30000) i;
+CREATE PUBLICATION pub FOR TABLE tab_copy;
+});
+
+# Copying one row in the middle of the table fails as long as copy_fail has
+# a row.  The trigger fires in whichever worker copies that row.
+$node_subscriber->safe_psql(
+	'postgres', q{
+CREATE TABLE tab_copy (i int PRIMARY KEY, t text);
+CREATE TABLE copy_fail (flag bool);
+INSERT INTO copy_fail VALUES (true);
+CREATE FUNCTION copy_fail_trigger() RETURNS trigger
+LANGUAGE plpgsql AS $$
+BEGIN
+  IF NEW.i = 15000 AND EXISTS (SELECT FROM public.copy_fail) THEN
+    RAISE EXCEPTION 'injected copy failure';
+  END IF;
+  RETURN NEW;
+END
+$$;
+CREATE TRIGGER copy_fail BEFORE INSERT ON tab_copy
+  FOR EACH ROW EXECUTE FUNCTION copy_fail_trigger();
+ALTER TABLE tab_copy ENABLE ALWAYS TRIGGER copy_fail;
+});
+
+my $log_offset = -s $node_subscriber->logfile;
+my $publisher_connstr = $node_publisher->connstr . ' dbname=postgres';
+$node_subscriber->safe_psql('postgres',
+	"CREATE SUBSCRIPTION sub CONNECTION '$publisher_connstr' PUBLICATION pub"
+);
+
+# The first attempts fail, and leave the table in the parallel copy state
+$node_subscriber->wait_for_log(qr/injected copy failure/, $log_offset);
+$node_subscriber->poll_query_until('postgres',
+	"SELECT srsubstate = 'p' FROM pg_subscription_rel WHERE srrelid = 'tab_copy'::regclass"
+) or die "Timed out while waiting for the parallel copy state";
+
+# Let the next attempt succeed
+$log_offset = -s $node_subscriber->logfile;
+$node_subscriber->safe_psql('postgres', 'DELETE FROM copy_fail');
+$node_subscriber->wait_for_subscription_sync($node_publisher, 'sub');
+
+ok( $node_subscriber->log_contains(
+		qr/table "public.tab_copy" copied in 12 ranges by \d+ table copy workers and us/,
+		$log_offset),
+	'table was copied in block ranges');
+
+my $query =
+  q{SELECT count(*), md5(string_agg(i || t, ',' ORDER BY i)) FROM tab_copy};
+my $expected = $node_publisher->safe_psql('postgres', $query);
+is($node_subscriber->safe_psql('postgres', $query),
+	$expected, 'rows were copied once after the restart');
+
+is( $node_subscriber->safe_psql(
+		'postgres', 'SELECT count(*) FROM pg_stat_subscription_copy'),
+	'0',
+	'no copy in progress after the synchronization');
+
+# Changes made after the copy are replicated as usual
+$node_publisher->safe_psql('postgres',
+	q{INSERT INTO tab_copy SELECT i, 'new' FROM generate_series(30001, 30100) i;
+	  DELETE FROM tab_copy WHERE i % 1000 = 0});
+$node_publisher->wait_for_catchup('sub');
+$expected = $node_publisher->safe_psql('postgres', $query);
+is($node_subscriber->safe_psql('postgres', $query),
+	$expected, 'changes after the copy are replicated');
+
+$node_subscriber->stop;
+$node_publisher->stop;
+
+done_testing();